@@ -0,0 +1,73 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "pcmkernels.h"
+
+#include <QTest>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+/**
+ * Microbenchmark for the PCM kernels fed by the capture path. Not part of the
+ * test suite; build the pcmkernels_bench target and run it by hand when
+ * touching the kernels.
+ */
+class BenchPcmKernels : public QObject
+{
+    Q_OBJECT
+private slots:
+    void benchApplyGain();
+    void benchSumOfSquares();
+
+private:
+    static std::vector<int16_t> makeFrame();
+};
+
+/**
+ * @brief Builds a frame of noise the size the capture path hands to the kernels:
+ * 20ms of stereo audio at 48kHz.
+ */
+std::vector<int16_t> BenchPcmKernels::makeFrame()
+{
+    constexpr size_t samples = 48000 / 1000 * 20 * 2;
+
+    std::mt19937 rng{12345};
+    std::uniform_int_distribution<int32_t> dist{std::numeric_limits<int16_t>::min(),
+                                                std::numeric_limits<int16_t>::max()};
+
+    std::vector<int16_t> frame(samples);
+    for (auto& sample : frame) {
+        sample = static_cast<int16_t>(dist(rng));
+    }
+
+    return frame;
+}
+
+void BenchPcmKernels::benchApplyGain()
+{
+    auto frame = makeFrame();
+
+    // ~6dB of amplification, so the clipping path is exercised too
+    QBENCHMARK
+    {
+        PcmKernels::applyGain(frame.data(), frame.size(), 2.0f);
+    }
+}
+
+void BenchPcmKernels::benchSumOfSquares()
+{
+    const auto frame = makeFrame();
+
+    volatile uint64_t sink = 0;
+    QBENCHMARK
+    {
+        sink = PcmKernels::sumOfSquares(frame.data(), frame.size());
+    }
+    std::ignore = sink;
+}
+
+QTEST_GUILESS_MAIN(BenchPcmKernels)
+#include "pcmkernels_bench.moc"
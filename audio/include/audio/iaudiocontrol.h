@@ -78,6 +78,13 @@
  * @brief set the input threshold
  *
  * @param[in] percent the new input threshold percentage
+ *
+ * @fn void IAudioControl::startLatencyProbe()
+ * @brief start a loopback latency measurement
+ *
+ * Plays a short tone burst on the output device and listens for it on the
+ * input device; the result arrives via latencyProbeResult(). Only useful
+ * when the microphone can physically hear the speakers.
  */
 
 class IAudioSink;
@@ -115,6 +122,22 @@ public:
     virtual std::unique_ptr<IAudioSink> makeSink() = 0;
     virtual std::unique_ptr<IAudioSource> makeSource() = 0;
 
+    virtual void startLatencyProbe() = 0;
+
+signals:
+    /**
+     * @brief Emitted when the set of available devices changed (hotplug).
+     */
+    void deviceListsChanged();
+
+    /**
+     * @brief Result of a startLatencyProbe() run.
+     *
+     * @param roundTripMs mean capture-to-playback round trip, or -1 on failure
+     * @param jitterMs spread between the fastest and slowest round trip
+     */
+    void latencyProbeResult(qreal roundTripMs, qreal jitterMs);
+
 protected:
     // Public default audio settings
     // Sample rate for Tox calls and sounds
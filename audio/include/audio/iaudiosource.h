@@ -7,25 +7,45 @@
 
 #include <QObject>
 
+#include <cstddef>
+#include <cstdint>
+
 /**
- * @fn void Audio::frameAvailable(const int16_t *pcm, size_t sample_count, uint8_t channels,
- * uint32_t sampling_rate);
+ * @fn void IAudioSource::framesQueued();
  *
- * When there are input subscribers, we regularly emit captured audio frames with this signal
- * Always connect with a blocking queued connection lambda, else the behaviour is undefined
+ * When there are input subscribers, captured frames are placed in a per-source
+ * queue and this signal announces that the queue became non-empty. Connect
+ * with a queued connection and drain the queue with peekFrame()/dropFrame();
+ * only a single consumer thread may drain a given source.
  */
 
 class IAudioSource : public QObject
 {
     Q_OBJECT
 public:
+    /**
+     * @brief A captured audio frame as handed to the consumer of a source.
+     *
+     * The pcm pointer stays valid until dropFrame() is called on the source
+     * that handed it out.
+     */
+    struct PcmFrame
+    {
+        const int16_t* pcm;
+        size_t sampleCount;
+        uint8_t channels;
+        uint32_t samplingRate;
+    };
+
     virtual ~IAudioSource() = default;
 
     virtual operator bool() const = 0;
 
+    virtual bool peekFrame(PcmFrame& frame) const = 0;
+    virtual void dropFrame() = 0;
+
 signals:
-    void frameAvailable(const int16_t* pcm, size_t sample_count, uint8_t channels,
-                        uint32_t sampling_rate);
+    void framesQueued();
     void volumeAvailable(qreal value);
     void invalidated();
 };
@@ -6,8 +6,19 @@
 #include "audio/src/backend/alsource.h"
 #include "audio/src/backend/openal.h"
 
+#include <QDebug>
+
+#include <algorithm>
+
 /**
  * @brief Emits audio frames captured by an input device or other audio source.
+ *
+ * Captured frames travel through a fixed-size single-producer single-consumer
+ * ring of preallocated buffers: the capture thread copies each frame into the
+ * next free slot without taking a lock or allocating, and the consumer drains
+ * the ring on its own thread after a coalesced framesQueued() doorbell. A full
+ * ring drops the newest frame on the producer side, so a stalled consumer
+ * costs bounded memory and never blocks capture.
  */
 
 /**
@@ -28,6 +39,10 @@ AlSource::~AlSource()
         audio.destroySource(*this);
         killed = true;
     }
+
+    if (const auto dropped = droppedFrames.load()) {
+        qDebug() << "Dropped" << dropped << "captured audio frames the consumer never drained";
+    }
 }
 
 AlSource::operator bool() const
@@ -36,6 +51,97 @@ AlSource::operator bool() const
     return !killed;
 }
 
+/**
+ * @brief Copies a captured frame into the ring, called on the capture thread.
+ *
+ * Lock- and allocation-free in the steady state; the slot buffers grow only
+ * on the first frames after the input device is (re)initialized.
+ *
+ * @param pcm interleaved samples of the captured frame.
+ * @param sampleCount number of samples per channel.
+ * @param channels number of interleaved channels.
+ * @param samplingRate sampling rate of the frame.
+ */
+void AlSource::pushFrame(const int16_t* pcm, size_t sampleCount, uint8_t channels,
+                         uint32_t samplingRate)
+{
+    const size_t write = ringWritePos.load(std::memory_order_relaxed);
+    const size_t read = ringReadPos.load(std::memory_order_acquire);
+
+    if (write - read >= frameRing.size()) {
+        // The consumer is a full ring behind; dropping the newest frame keeps
+        // the already-captured audio intact and the capture thread moving
+        ++droppedFrames;
+        return;
+    }
+
+    RingSlot& slot = frameRing[write % frameRing.size()];
+    const size_t totalSamples = sampleCount * channels;
+
+    if (slot.pcm.size() < totalSamples) {
+        slot.pcm.resize(totalSamples);
+    }
+
+    std::copy_n(pcm, totalSamples, slot.pcm.data());
+    slot.sampleCount = sampleCount;
+    slot.channels = channels;
+    slot.samplingRate = samplingRate;
+
+    ringWritePos.store(write + 1, std::memory_order_release);
+
+    // Ring the doorbell only if no drain is already on its way, so a slow
+    // consumer cannot pile up queued events
+    if (!queuedSignalPending.exchange(true)) {
+        emit framesQueued();
+    }
+}
+
+/**
+ * @brief Hands out the oldest queued frame without consuming it.
+ *
+ * Called on the consumer thread. The returned pcm pointer stays valid until
+ * the next dropFrame() call.
+ *
+ * @param frame receives the frame on success.
+ * @return true if a frame was available, false if the ring is empty.
+ */
+bool AlSource::peekFrame(PcmFrame& frame) const
+{
+    // Clear the doorbell before looking: a frame pushed right after this at
+    // worst rings again while a drain is already running
+    queuedSignalPending = false;
+
+    const size_t read = ringReadPos.load(std::memory_order_relaxed);
+    const size_t write = ringWritePos.load(std::memory_order_acquire);
+
+    if (read == write) {
+        return false;
+    }
+
+    const RingSlot& slot = frameRing[read % frameRing.size()];
+    frame.pcm = slot.pcm.data();
+    frame.sampleCount = slot.sampleCount;
+    frame.channels = slot.channels;
+    frame.samplingRate = slot.samplingRate;
+
+    return true;
+}
+
+/**
+ * @brief Consumes the oldest queued frame, returning its slot to the producer.
+ */
+void AlSource::dropFrame()
+{
+    const size_t read = ringReadPos.load(std::memory_order_relaxed);
+    const size_t write = ringWritePos.load(std::memory_order_acquire);
+
+    if (read == write) {
+        return;
+    }
+
+    ringReadPos.store(read + 1, std::memory_order_release);
+}
+
 void AlSource::kill()
 {
     killLock.lock();
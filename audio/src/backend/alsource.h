@@ -9,6 +9,11 @@
 #include <QMutex>
 #include <QObject>
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
 class OpenAL;
 class AlSource : public IAudioSource
 {
@@ -23,10 +28,41 @@ public:
 
     operator bool() const;
 
+    // IAudioSource interface, the consumer side of the frame ring
+    bool peekFrame(PcmFrame& frame) const override;
+    void dropFrame() override;
+
+    // The producer side, called by OpenAL on the capture thread
+    void pushFrame(const int16_t* pcm, size_t sampleCount, uint8_t channels, uint32_t samplingRate);
+
     void kill();
 
 private:
+    /**
+     * @brief One preallocated frame of the capture ring.
+     */
+    struct RingSlot
+    {
+        std::vector<int16_t> pcm;
+        size_t sampleCount = 0;
+        uint8_t channels = 0;
+        uint32_t samplingRate = 0;
+    };
+
+    // Ring depth in frames; at 20ms per frame this buffers 160ms of lag
+    // between the capture thread and the consumer before frames are dropped
+    static constexpr size_t frameRingSize = 8;
+
     OpenAL& audio;
     bool killed = false;
     mutable QRecursiveMutex killLock;
+
+    // Single-producer single-consumer: the capture thread advances the write
+    // position, the draining thread the read position. Slots between read and
+    // write belong to the consumer, the rest to the producer.
+    std::array<RingSlot, frameRingSize> frameRing;
+    std::atomic<size_t> ringReadPos{0};
+    std::atomic<size_t> ringWritePos{0};
+    mutable std::atomic_bool queuedSignalPending{false};
+    std::atomic<uint64_t> droppedFrames{0};
 };
@@ -5,7 +5,11 @@
 
 #include "openal.h"
 
+#include "pcmkernels.h"
+
 #include "audio/iaudiosettings.h"
+#include "util/perfzone.h"
+#include "util/threadplacement.h"
 
 #include <QDebug>
 #include <QFile>
@@ -14,9 +18,11 @@
 #include <QPointer>
 #include <QThread>
 #include <QWaitCondition>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtMath>
 
 #include <cassert>
+#include <utility>
 
 #if defined(QT_STATIC)
 extern "C"
@@ -33,16 +39,6 @@ extern "C"
 #endif
 
 namespace {
-void applyGain(int16_t* buffer, uint32_t bufferSize, qreal gainFactor)
-{
-    for (quint32 i = 0; i < bufferSize; ++i) {
-        // gain amplification with clipping to 16-bit boundaries
-        buffer[i] =
-            qBound<int16_t>(std::numeric_limits<int16_t>::min(), qRound(buffer[i] * gainFactor),
-                            std::numeric_limits<int16_t>::max());
-    }
-}
-
 /**
  * @class OpenAL
  * @brief Provides the OpenAL audio backend
@@ -56,6 +52,21 @@ void applyGain(int16_t* buffer, uint32_t bufferSize, qreal gainFactor)
 
 constexpr unsigned int BUFFER_COUNT = 16;
 constexpr uint32_t AUDIO_CHANNELS = 2;
+// Upper bound for the adaptive prebuffer watermark; beyond this the added
+// latency hurts more than another underrun would
+constexpr uint32_t MAX_PREBUFFER_FRAMES = 6;
+
+// Loopback latency probe: number of tone bursts to average over, burst
+// length and frequency, per-round timeout for when the tone is never heard
+// (muted speakers), and the pause between rounds
+constexpr int PROBE_ROUNDS = 5;
+constexpr int PROBE_TONE_MS = 10;
+constexpr int PROBE_TONE_HZ = 1000;
+constexpr int PROBE_TIMEOUT_MS = 1000;
+constexpr int PROBE_INTERVAL_MS = 250;
+// Minimum ratio of tone-bin power to total frame energy to count as a hit;
+// broadband room noise spreads over hundreds of bins and stays far below it
+constexpr float PROBE_DETECT_RATIO = 0.25f;
 
 namespace logcat {
 #if defined(QT_STATIC)
@@ -102,6 +113,7 @@ OpenAL::OpenAL(IAudioSettings& _settings)
     audioThread->setObjectName("qTox Audio");
     QObject::connect(audioThread, &QThread::finished, &voiceTimer, &QTimer::stop);
     QObject::connect(audioThread, &QThread::finished, &captureTimer, &QTimer::stop);
+    QObject::connect(audioThread, &QThread::finished, &probeTimer, &QTimer::stop);
     QObject::connect(audioThread, &QThread::finished, audioThread, &QThread::deleteLater);
 
     moveToThread(audioThread);
@@ -126,13 +138,31 @@ OpenAL::OpenAL(IAudioSettings& _settings)
     connect(audioThread, &QThread::started, &cleanupTimer,
             static_cast<void (QTimer::*)(void)>(&QTimer::start));
 
-    audioThread->start();
+    deviceEnumTimer.setInterval(5000);
+    deviceEnumTimer.setSingleShot(false);
+    deviceEnumTimer.moveToThread(audioThread);
+    connect(&deviceEnumTimer, &QTimer::timeout, this, &OpenAL::pollDeviceNames);
+    // Warm the cache right away so the first settings open doesn't block
+    connect(audioThread, &QThread::started, this, &OpenAL::pollDeviceNames);
+    connect(audioThread, &QThread::started, &deviceEnumTimer,
+            static_cast<void (QTimer::*)(void)>(&QTimer::start));
+
+    probeTimer.setSingleShot(true);
+    probeTimer.moveToThread(audioThread);
+    connect(&probeTimer, &QTimer::timeout, this, &OpenAL::beginProbeRound);
+
+    QObject::connect(audioThread, &QThread::started, this,
+                     [] { ThreadPlacement::registerCurrentThread(QStringLiteral("Audio")); });
+    // Audio is the most jitter-sensitive loop in the process; time-critical
+    // keeps capture ticks on schedule when the machine is loaded
+    audioThread->start(QThread::TimeCriticalPriority);
 }
 
 OpenAL::~OpenAL()
 {
     audioThread->exit();
     audioThread->wait();
+    deviceEnumFuture.waitForFinished();
     cleanupInput();
     cleanupOutput();
 }
@@ -304,6 +334,20 @@ void OpenAL::destroySink(AlSink& sink)
         qCWarning(logcat::audio) << "Trying to delete invalid audio source" << sid;
     }
 
+    const auto playbackIt = sinkPlayback.find(sid);
+    if (playbackIt != sinkPlayback.end()) {
+        SinkPlayback& playback = playbackIt->second;
+        if (!playback.freeBuffers.empty()) {
+            alDeleteBuffers(static_cast<ALsizei>(playback.freeBuffers.size()),
+                            playback.freeBuffers.data());
+        }
+        if (playback.underruns > 0) {
+            qCDebug(logcat::audio) << "Audio source" << sid << "had" << playback.underruns
+                                   << "playback underruns over its lifetime";
+        }
+        sinkPlayback.erase(playbackIt);
+    }
+
     if (sinks.empty() && soundSinks.empty()) {
         cleanupOutput();
     }
@@ -457,50 +501,64 @@ bool OpenAL::initOutput(const QString& deviceName)
     alListenerf(AL_GAIN, settings.getOutVolume() * 0.01f);
     checkAlError();
 
+    // restore the prebuffer watermark a latency probe measured for this
+    // device pair; unprobed pairs fall back to the fixed default
+    defaultQueuedTarget = probedQueuedTargets.value(probeDeviceKey(), 2);
+
     outputInitialized = true;
     return true;
 }
 
 /**
- * @brief Play a 48kHz mono 16bit PCM sound
+ * @brief Returns the cached AL buffer holding a sound, uploading it on first use.
+ * @return The buffer id, or 0 if the sound file could not be read.
+ *
+ * Must be called with audioLock held and the output context current.
  */
-void OpenAL::playMono16Sound(AlSink& sink, const IAudioSink::Sound& sound)
+ALuint OpenAL::getSoundBuffer(const IAudioSink::Sound& sound)
 {
-    const uint sourceId = sink.getSourceId();
+    const auto it = soundBuffers.constFind(sound);
+    if (it != soundBuffers.constEnd()) {
+        return *it;
+    }
+
     QFile sndFile(IAudioSink::getSound(sound));
     if (!sndFile.exists()) {
         qCDebug(logcat::audio) << "Trying to open non-existent sound file";
-        return;
+        return 0;
     }
 
     sndFile.open(QIODevice::ReadOnly);
     const QByteArray data{sndFile.readAll()};
     if (data.isEmpty()) {
         qCDebug(logcat::audio) << "Sound file contained no data";
-        return;
+        return 0;
     }
 
-    QMutexLocker<QRecursiveMutex> locker(&audioLock);
+    ALuint bufid = 0;
+    alGenBuffers(1, &bufid);
+    alBufferData(bufid, AL_FORMAT_MONO16, data.constData(), data.size(), AUDIO_SAMPLE_RATE);
+    soundBuffers.insert(sound, bufid);
+    return bufid;
+}
 
-    // interrupt possibly playing sound, we don't buffer here
-    alSourceStop(sourceId);
+/**
+ * @brief Play a 48kHz mono 16bit PCM sound
+ */
+void OpenAL::playMono16Sound(AlSink& sink, const IAudioSink::Sound& sound)
+{
+    const uint sourceId = sink.getSourceId();
 
-    ALint processed = 0;
-    alGetSourcei(sourceId, AL_BUFFERS_PROCESSED, &processed);
-    alSourcei(sourceId, AL_LOOPING, AL_FALSE);
+    QMutexLocker<QRecursiveMutex> locker(&audioLock);
 
-    ALuint bufid;
-    if (processed == 0) {
-        // create new buffer
-        alGenBuffers(1, &bufid);
-    } else {
-        // we only reserve space for one buffer
-        assert(processed == 1);
-        // unqueue all processed buffers
-        alSourceUnqueueBuffers(sourceId, processed, &bufid);
+    const ALuint bufid = getSoundBuffer(sound);
+    if (bufid == 0) {
+        return;
     }
 
-    alBufferData(bufid, AL_FORMAT_MONO16, data.constData(), data.size(), AUDIO_SAMPLE_RATE);
+    // interrupt possibly playing sound, we don't queue here
+    alSourceStop(sourceId);
+    alSourcei(sourceId, AL_LOOPING, AL_FALSE);
     alSourcei(sourceId, AL_BUFFER, bufid);
     alSourcePlay(sourceId);
     soundSinks.insert(&sink);
@@ -535,33 +593,65 @@ void OpenAL::playAudioBuffer(uint sourceId, const int16_t* data, int samples, un
     if (!(alOutDev && outputInitialized))
         return;
 
-    ALuint bufids[BUFFER_COUNT];
+    auto playbackIt = sinkPlayback.find(sourceId);
+    if (playbackIt == sinkPlayback.end()) {
+        // fresh sinks start from the probed watermark for this device pair
+        playbackIt = sinkPlayback.emplace(sourceId, SinkPlayback{}).first;
+        playbackIt->second.queuedTarget = defaultQueuedTarget;
+    }
+    SinkPlayback& playback = playbackIt->second;
+
     ALint processed = 0, queued = 0;
     alGetSourcei(sourceId, AL_BUFFERS_PROCESSED, &processed);
     alGetSourcei(sourceId, AL_BUFFERS_QUEUED, &queued);
     alSourcei(sourceId, AL_LOOPING, AL_FALSE);
 
-    if (processed == 0) {
-        if (static_cast<ALuint>(queued) >= BUFFER_COUNT) {
-            // reached limit, drop audio
-            return;
+    // return played-out buffers to the pool instead of deleting them
+    if (processed > 0) {
+        const size_t poolSize = playback.freeBuffers.size();
+        playback.freeBuffers.resize(poolSize + processed);
+        alSourceUnqueueBuffers(sourceId, processed, playback.freeBuffers.data() + poolSize);
+        queued -= processed;
+    }
+
+    ALint state = 0;
+    alGetSourcei(sourceId, AL_SOURCE_STATE, &state);
+
+    // A stopped source outside of prebuffering ran dry; raise the watermark
+    // so the next start has more margin against the same hiccup
+    if (!playback.prebuffering && state == AL_STOPPED) {
+        ++playback.underruns;
+        playback.prebuffering = true;
+        if (playback.queuedTarget < MAX_PREBUFFER_FRAMES) {
+            ++playback.queuedTarget;
         }
-        // create new buffer if none got free and we're below the limit
-        alGenBuffers(1, bufids);
+        qCDebug(logcat::audio) << "Playback underrun on source" << sourceId << "- total"
+                               << playback.underruns << ", prebuffering" << playback.queuedTarget
+                               << "frames";
+    }
+
+    ALuint bufid;
+    if (!playback.freeBuffers.empty()) {
+        bufid = playback.freeBuffers.back();
+        playback.freeBuffers.pop_back();
+    } else if (playback.allocatedBuffers < BUFFER_COUNT) {
+        // grow the pool until the source owns its full complement of buffers
+        alGenBuffers(1, &bufid);
+        ++playback.allocatedBuffers;
     } else {
-        // unqueue all processed buffers
-        alSourceUnqueueBuffers(sourceId, processed, bufids);
-        // delete all but the first buffer, reuse first for new data
-        alDeleteBuffers(processed - 1, bufids + 1);
+        // everything this source owns is still queued, drop audio
+        return;
     }
 
-    alBufferData(bufids[0], (channels == 1) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16, data,
+    alBufferData(bufid, (channels == 1) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16, data,
                  samples * 2 * channels, sampleRate);
-    alSourceQueueBuffers(sourceId, 1, bufids);
+    alSourceQueueBuffers(sourceId, 1, &bufid);
+    ++queued;
 
-    ALint state;
-    alGetSourcei(sourceId, AL_SOURCE_STATE, &state);
-    if (state != AL_PLAYING) {
+    // hold a stopped source until the low watermark is queued, so one
+    // scheduler hiccup does not immediately drain it dry again
+    if (state != AL_PLAYING && static_cast<uint32_t>(queued) >= playback.queuedTarget) {
+        playback.prebuffering = false;
         alSourcePlay(sourceId);
     }
 }
@@ -592,6 +682,15 @@ void OpenAL::cleanupOutput()
 {
     outputInitialized = false;
 
+    // pooled buffers die with the output context
+    sinkPlayback.clear();
+
+    // so do the cached notification sound buffers
+    for (ALuint bufid : std::as_const(soundBuffers)) {
+        alDeleteBuffers(1, &bufid);
+    }
+    soundBuffers.clear();
+
     if (alOutDev) {
         if (!alcMakeContextCurrent(nullptr)) {
             qWarning("Failed to clear audio context");
@@ -620,13 +719,11 @@ qreal OpenAL::getVolume()
 {
     const quint32 samples = AUDIO_FRAME_SAMPLE_COUNT_TOTAL;
     const qreal rootTwo = 1.414213562; // sqrt(2), but sqrt is not constexpr
-    // calculate volume as the root mean squared of amplitudes in the sample
-    qreal sumOfSquares = 0;
-    for (quint32 i = 0; i < samples; i++) {
-        auto sample = static_cast<qreal>(inputBuffer[i]) / std::numeric_limits<int16_t>::max();
-        sumOfSquares += std::pow(sample, 2);
-    }
-    const qreal rms = std::sqrt(sumOfSquares / samples);
+    // calculate volume as the root mean squared of amplitudes in the sample;
+    // the kernel sums raw squares, normalization happens once out here
+    const quint64 sumOfSquares = PcmKernels::sumOfSquares(inputBuffer, samples);
+    const qreal maxAmplitude = std::numeric_limits<int16_t>::max();
+    const qreal rms = std::sqrt(static_cast<qreal>(sumOfSquares) / samples) / maxAmplitude;
     // our calculated normalized volume could possibly be above 1 because our RMS assumes a sinusoidal wave
     const qreal normalizedVolume = std::min(rms * rootTwo, 1.0);
     return normalizedVolume;
@@ -653,7 +750,12 @@ void OpenAL::doInput()
 
     captureSamples(alInDev, inputBuffer, AUDIO_FRAME_SAMPLE_COUNT_PER_CHANNEL);
 
-    applyGain(inputBuffer, AUDIO_FRAME_SAMPLE_COUNT_TOTAL, gainFactor);
+    PcmKernels::applyGain(inputBuffer, AUDIO_FRAME_SAMPLE_COUNT_TOTAL,
+                          static_cast<float>(gainFactor));
+
+    if (probeListening) {
+        detectProbeTone();
+    }
 
     auto volume = getVolume();
     if (volume >= inputThreshold) {
@@ -671,10 +773,11 @@ void OpenAL::doInput()
         return;
     }
 
-    // NOTE(sudden6): this loop probably doesn't scale too well with many sources
+    // Each source gets its own copy in a preallocated ring slot, so the
+    // consumers read stable data while inputBuffer is already being refilled
     for (auto source : sources) {
-        emit source->frameAvailable(inputBuffer, AUDIO_FRAME_SAMPLE_COUNT_PER_CHANNEL,
-                                    inputChannels, AUDIO_SAMPLE_RATE);
+        source->pushFrame(inputBuffer, AUDIO_FRAME_SAMPLE_COUNT_PER_CHANNEL, inputChannels,
+                          AUDIO_SAMPLE_RATE);
     }
 }
 
@@ -688,12 +791,15 @@ void OpenAL::doOutput()
  */
 void OpenAL::doAudio()
 {
+    PERF_ZONE(openal_do_audio);
+
     QMutexLocker<QRecursiveMutex> lock(&audioLock);
 
     // Output section does nothing
 
-    // Input section
-    if (alInDev && !sources.empty()) {
+    // Input section; a running latency probe needs frames even with no
+    // subscribed sources
+    if (alInDev && (!sources.empty() || probeListening)) {
         doInput();
     }
 }
@@ -712,7 +818,7 @@ bool OpenAL::isOutputReady() const
     return alOutDev && outputInitialized;
 }
 
-QStringList OpenAL::outDeviceNames()
+QStringList OpenAL::enumerateOutDevices()
 {
     QStringList list;
     const ALchar* pDeviceList = (alcIsExtensionPresent(nullptr, "ALC_ENUMERATE_ALL_EXT") != AL_FALSE)
@@ -730,7 +836,7 @@ QStringList OpenAL::outDeviceNames()
     return list;
 }
 
-QStringList OpenAL::inDeviceNames()
+QStringList OpenAL::enumerateInDevices()
 {
     QStringList list;
     const ALchar* pDeviceList = alcGetString(nullptr, ALC_CAPTURE_DEVICE_SPECIFIER);
@@ -747,6 +853,221 @@ QStringList OpenAL::inDeviceNames()
     return list;
 }
 
+/**
+ * @brief Re-enumerates the devices and updates the cache.
+ *
+ * On the poll path this runs in a worker thread without audioLock held while
+ * talking to OpenAL, so a slow platform enumeration never stalls capture or
+ * playback; only the first cold-cache query pays the cost synchronously.
+ */
+void OpenAL::refreshDeviceNames()
+{
+    const QStringList outNames = enumerateOutDevices();
+    const QStringList inNames = enumerateInDevices();
+
+    bool changed = false;
+    {
+        QMutexLocker<QRecursiveMutex> locker(&audioLock);
+        changed = deviceNamesCached
+                  && (outNames != cachedOutDeviceNames || inNames != cachedInDeviceNames);
+        cachedOutDeviceNames = outNames;
+        cachedInDeviceNames = inNames;
+        deviceNamesCached = true;
+    }
+
+    if (changed) {
+        qCDebug(logcat::audio) << "Audio device lists changed";
+        emit deviceListsChanged();
+    }
+}
+
+/**
+ * @brief Kicks a background cache refresh unless one is still running.
+ */
+void OpenAL::pollDeviceNames()
+{
+    if (!deviceEnumFuture.isRunning()) {
+        deviceEnumFuture = QtConcurrent::run([this] { refreshDeviceNames(); });
+    }
+}
+
+QStringList OpenAL::outDeviceNames()
+{
+    QMutexLocker<QRecursiveMutex> locker(&audioLock);
+    if (!deviceNamesCached) {
+        // Cold cache: pay the enumeration cost once, synchronously
+        refreshDeviceNames();
+    }
+    return cachedOutDeviceNames;
+}
+
+QStringList OpenAL::inDeviceNames()
+{
+    QMutexLocker<QRecursiveMutex> locker(&audioLock);
+    if (!deviceNamesCached) {
+        refreshDeviceNames();
+    }
+    return cachedInDeviceNames;
+}
+
+QString OpenAL::probeDeviceKey() const
+{
+    return settings.getInDev() + QLatin1Char('|') + settings.getOutDev();
+}
+
+/**
+ * @brief Start a loopback latency measurement.
+ *
+ * Plays a series of short tone bursts and times how long each takes to come
+ * back in through the capture device. The mean round trip and the spread
+ * between rounds go out through latencyProbeResult(), and the spread also
+ * sizes the playback prebuffer watermark for this device pair, replacing the
+ * fixed default that so far had to cover every setup blind.
+ */
+void OpenAL::startLatencyProbe()
+{
+    if (QThread::currentThread() != audioThread) {
+        // the probe's timers live on the audio thread, run there
+        QMetaObject::invokeMethod(this, &OpenAL::startLatencyProbe);
+        return;
+    }
+
+    QMutexLocker<QRecursiveMutex> locker(&audioLock);
+
+    if (probeActive) {
+        qCDebug(logcat::audio) << "Latency probe already running";
+        return;
+    }
+
+    if (!autoInitInput() || !autoInitOutput()) {
+        qCWarning(logcat::audio) << "Latency probe needs both audio devices open";
+        emit latencyProbeResult(-1, -1);
+        return;
+    }
+
+    // 10ms 1kHz burst under a raised-cosine envelope; short enough that the
+    // tail of the tone can't blur round trips below one frame duration
+    const size_t toneSamples = AUDIO_SAMPLE_RATE * PROBE_TONE_MS / 1000;
+    std::vector<int16_t> tone(toneSamples);
+    const float pi = static_cast<float>(M_PI);
+    for (size_t i = 0; i < toneSamples; ++i) {
+        const float envelope = 0.5f - 0.5f * std::cos(2.0f * pi * i / toneSamples);
+        const float phase = 2.0f * pi * PROBE_TONE_HZ * i / AUDIO_SAMPLE_RATE;
+        tone[i] = static_cast<int16_t>(std::sin(phase) * envelope * 0.8f
+                                       * std::numeric_limits<int16_t>::max());
+    }
+
+    alGenSources(1, &probeSource);
+    alGenBuffers(1, &probeBuffer);
+    alBufferData(probeBuffer, AL_FORMAT_MONO16, tone.data(),
+                 static_cast<ALsizei>(tone.size() * 2), AUDIO_SAMPLE_RATE);
+    alSourcei(probeSource, AL_BUFFER, probeBuffer);
+    checkAlError();
+
+    probeActive = true;
+    probeRoundsLeft = PROBE_ROUNDS;
+    probeRoundTripsMs.clear();
+    beginProbeRound();
+}
+
+/**
+ * @brief Plays the next probe burst, or reports once all rounds have run.
+ *
+ * Also fires on probeTimer's timeout, abandoning a round whose tone never
+ * came back — muted speakers, covered microphone — instead of hanging.
+ */
+void OpenAL::beginProbeRound()
+{
+    QMutexLocker<QRecursiveMutex> locker(&audioLock);
+
+    probeListening = false;
+    if (probeRoundsLeft == 0) {
+        finishLatencyProbe();
+        return;
+    }
+    --probeRoundsLeft;
+
+    alSourceStop(probeSource);
+    alSourcePlay(probeSource);
+    probeClock.start();
+    probeListening = true;
+    probeTimer.start(PROBE_TIMEOUT_MS);
+}
+
+/**
+ * @brief Checks the captured frame for the probe tone, called from doInput().
+ *
+ * Compares a single Goertzel bin at the tone frequency against the frame's
+ * mean squared energy; the ratio makes detection independent of input gain
+ * and absolute loopback volume.
+ */
+void OpenAL::detectProbeTone()
+{
+    const float tonePower =
+        PcmKernels::goertzelPower(inputBuffer, AUDIO_FRAME_SAMPLE_COUNT_TOTAL, inputChannels,
+                                  static_cast<float>(PROBE_TONE_HZ) / AUDIO_SAMPLE_RATE);
+    const uint64_t sum = PcmKernels::sumOfSquares(inputBuffer, AUDIO_FRAME_SAMPLE_COUNT_TOTAL);
+    const float meanSquare = static_cast<float>(sum) / AUDIO_FRAME_SAMPLE_COUNT_TOTAL;
+
+    // near-silence carries no tone; also keeps the ratio well-defined
+    if (meanSquare < 1.0f || tonePower < meanSquare * PROBE_DETECT_RATIO) {
+        return;
+    }
+
+    probeRoundTripsMs.push_back(static_cast<qreal>(probeClock.nsecsElapsed()) / 1e6);
+    probeListening = false;
+    probeTimer.start(PROBE_INTERVAL_MS);
+}
+
+/**
+ * @brief Tears down the probe, derives the prebuffer watermark and reports.
+ */
+void OpenAL::finishLatencyProbe()
+{
+    probeTimer.stop();
+    alDeleteSources(1, &probeSource);
+    alDeleteBuffers(1, &probeBuffer);
+    probeSource = 0;
+    probeBuffer = 0;
+    probeActive = false;
+
+    // release devices the probe opened just for itself
+    if (sources.empty()) {
+        cleanupInput();
+    }
+    if (sinks.empty() && soundSinks.empty()) {
+        cleanupOutput();
+    }
+
+    if (probeRoundTripsMs.empty()) {
+        qCWarning(logcat::audio) << "Latency probe heard none of its bursts";
+        emit latencyProbeResult(-1, -1);
+        return;
+    }
+
+    qreal sum = 0;
+    qreal minTrip = probeRoundTripsMs.front();
+    qreal maxTrip = probeRoundTripsMs.front();
+    for (const qreal trip : probeRoundTripsMs) {
+        sum += trip;
+        minTrip = std::min(minTrip, trip);
+        maxTrip = std::max(maxTrip, trip);
+    }
+    const qreal roundTripMs = sum / probeRoundTripsMs.size();
+    const qreal jitterMs = maxTrip - minTrip;
+
+    // Enough prebuffered frames to ride out the measured jitter; future
+    // sinks on this device pair start from here instead of the fixed default
+    defaultQueuedTarget = qBound<uint32_t>(
+        2, 2 + static_cast<uint32_t>(jitterMs / AUDIO_FRAME_DURATION), MAX_PREBUFFER_FRAMES);
+    probedQueuedTargets[probeDeviceKey()] = defaultQueuedTarget;
+
+    qCDebug(logcat::audio) << "Latency probe:" << roundTripMs << "ms round trip over"
+                           << probeRoundTripsMs.size() << "rounds," << jitterMs
+                           << "ms jitter; prebuffering" << defaultQueuedTarget << "frames";
+    emit latencyProbeResult(roundTripMs, jitterMs);
+}
+
 /**
  * @brief Free all buffers that finished playing on a source
  * @param sourceId where to remove the buffers from
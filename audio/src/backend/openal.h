@@ -11,11 +11,16 @@
 #include "audio/iaudiocontrol.h"
 
 #include <memory>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <atomic>
 #include <cmath>
 
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QHash>
 #include <QMutex>
 #include <QObject>
 #include <QTimer>
@@ -83,6 +88,8 @@ public:
 
     void playAudioBuffer(uint sourceId, const int16_t* data, int samples, unsigned channels,
                          int sampleRate);
+
+    void startLatencyProbe();
 signals:
     void startActive(qreal msec);
 
@@ -111,9 +118,20 @@ private:
 
     void cleanupBuffers(uint sourceId);
     void cleanupSound();
+    ALuint getSoundBuffer(const IAudioSink::Sound& sound);
 
     qreal getVolume();
 
+    static QStringList enumerateOutDevices();
+    static QStringList enumerateInDevices();
+    void refreshDeviceNames();
+    void pollDeviceNames();
+
+    void beginProbeRound();
+    void detectProbeTone();
+    void finishLatencyProbe();
+    QString probeDeviceKey() const;
+
 protected:
     IAudioSettings& settings;
     QThread* audioThread;
@@ -125,16 +143,65 @@ protected:
     QTimer captureTimer;
     QTimer cleanupTimer;
 
+    // Cached device enumerations. Enumeration can block for hundreds of ms
+    // on some platforms (WASAPI), so the settings UI and call setup read the
+    // cache while a background poll keeps it fresh; there is no portable
+    // OpenAL hotplug notification to subscribe to instead.
+    QTimer deviceEnumTimer;
+    QFuture<void> deviceEnumFuture;
+    QStringList cachedOutDeviceNames;
+    QStringList cachedInDeviceNames;
+    bool deviceNamesCached = false;
+
     ALCdevice* alOutDev = nullptr;
     ALCcontext* alOutContext = nullptr;
 
     bool outputInitialized = false;
 
+    /**
+     * @brief Per-sink playback state: pooled AL buffers and watermark bookkeeping.
+     *
+     * Buffers whose frames finished playing go back into freeBuffers instead
+     * of being deleted, so steady playback reuses the same BUFFER_COUNT
+     * objects. queuedTarget is the low watermark of queued frames required
+     * before (re)starting the source; every underrun raises it by one frame,
+     * trading a little latency for resilience against scheduler hiccups.
+     */
+    struct SinkPlayback
+    {
+        std::vector<ALuint> freeBuffers;
+        uint32_t allocatedBuffers = 0;
+        uint32_t queuedTarget = 2;
+        bool prebuffering = true;
+        quint64 underruns = 0;
+    };
+
     // Qt containers need copy operators, so use stdlib containers
+    std::unordered_map<ALuint, SinkPlayback> sinkPlayback;
     std::unordered_set<AlSink*> sinks;
     std::unordered_set<AlSink*> soundSinks;
     std::unordered_set<AlSource*> sources;
 
+    // Notification sound PCM uploaded to an AL buffer once per sound on
+    // first play; replaying a ping then just points a source at the cached
+    // buffer instead of re-reading the file and re-uploading the data.
+    // Buffers belong to the output context, so the cache dies with it.
+    QHash<IAudioSink::Sound, ALuint> soundBuffers;
+
+    // Loopback latency probe state; only ever touched on the audio thread.
+    // probedQueuedTargets remembers the prebuffer size derived from a probe
+    // per input/output device pair for the rest of the session.
+    QTimer probeTimer;
+    ALuint probeSource = 0;
+    ALuint probeBuffer = 0;
+    bool probeActive = false;
+    bool probeListening = false;
+    int probeRoundsLeft = 0;
+    QElapsedTimer probeClock;
+    std::vector<qreal> probeRoundTripsMs;
+    uint32_t defaultQueuedTarget = 2;
+    QHash<QString, uint32_t> probedQueuedTargets;
+
     int inputChannels = 0;
     qreal gain = 0;
     qreal gainFactor = 1;
@@ -0,0 +1,106 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "pcmkernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/**
+ * @namespace PcmKernels
+ * @brief Per-sample loops over PCM buffers, shaped so compilers auto-vectorize
+ * them.
+ *
+ * These run on every captured frame, so they must not dominate the audio
+ * thread when many sources are active. Instead of hand-written intrinsics the
+ * loops avoid everything that blocks vectorization — per-sample branches,
+ * function calls and double-precision rounding — and let the compiler emit
+ * SSE2 or NEON for the target at hand.
+ */
+
+namespace PcmKernels {
+/**
+ * @brief Amplifies 16-bit samples by a gain factor, clipping at the 16-bit range.
+ *
+ * Rounds half away from zero like qRound(), but via a branch-free copysign so
+ * the loop stays vectorizable.
+ *
+ * @param buffer samples to scale in place.
+ * @param samples number of samples in the buffer.
+ * @param factor linear gain factor to apply.
+ */
+void applyGain(int16_t* buffer, size_t samples, float factor)
+{
+    constexpr auto sampleMax = static_cast<float>(std::numeric_limits<int16_t>::max());
+    constexpr auto sampleMin = static_cast<float>(std::numeric_limits<int16_t>::min());
+
+    for (size_t i = 0; i < samples; ++i) {
+        float scaled = static_cast<float>(buffer[i]) * factor;
+        scaled = std::min(scaled, sampleMax);
+        scaled = std::max(scaled, sampleMin);
+        buffer[i] = static_cast<int16_t>(scaled + std::copysign(0.5f, scaled));
+    }
+}
+
+/**
+ * @brief Sums the squared sample values of a buffer, as used for RMS volume.
+ *
+ * Pure integer multiply-accumulate; normalizing against the 16-bit range is
+ * left to the caller so the loop carries no per-sample division.
+ *
+ * @param buffer samples to sum over.
+ * @param samples number of samples in the buffer.
+ * @return the sum of the squared sample values.
+ */
+uint64_t sumOfSquares(const int16_t* buffer, size_t samples)
+{
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < samples; ++i) {
+        const int32_t sample = buffer[i];
+        sum += static_cast<uint32_t>(sample * sample);
+    }
+
+    return sum;
+}
+
+/**
+ * @brief Power of a single frequency in a buffer, via the Goertzel recurrence.
+ *
+ * Cheaper than an FFT when only one bin is of interest, as in the loopback
+ * latency probe looking for its own tone. The recurrence carries a loop
+ * dependency, so unlike the kernels above this one doesn't vectorize; it
+ * runs only while a probe is listening.
+ *
+ * @param buffer interleaved samples to scan.
+ * @param samples number of samples to consume from the buffer.
+ * @param stride distance between consumed samples, i.e. the channel count
+ *        when picking one channel out of interleaved PCM.
+ * @param normalizedFreq target frequency divided by the sample rate.
+ * @return mean squared magnitude of the bin, comparable to the mean of
+ *         squared sample values.
+ */
+float goertzelPower(const int16_t* buffer, size_t samples, size_t stride, float normalizedFreq)
+{
+    const size_t count = samples / stride;
+    if (count == 0) {
+        return 0.0f;
+    }
+
+    const float coeff = 2.0f * std::cos(2.0f * static_cast<float>(M_PI) * normalizedFreq);
+    float s1 = 0.0f;
+    float s2 = 0.0f;
+
+    for (size_t i = 0; i < count; ++i) {
+        const float s0 = static_cast<float>(buffer[i * stride]) + coeff * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+
+    const float power = s1 * s1 + s2 * s2 - coeff * s1 * s2;
+    // Scale so the result compares against mean squared energy
+    return 2.0f * power / (static_cast<float>(count) * count);
+}
+} // namespace PcmKernels
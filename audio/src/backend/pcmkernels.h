@@ -0,0 +1,14 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace PcmKernels {
+void applyGain(int16_t* buffer, size_t samples, float factor);
+uint64_t sumOfSquares(const int16_t* buffer, size_t samples);
+float goertzelPower(const int16_t* buffer, size_t samples, size_t stride, float normalizedFreq);
+} // namespace PcmKernels
@@ -30,6 +30,22 @@ function(auto_test subsystem module extra_res extra_libs)
     ENVIRONMENT "QT_QPA_PLATFORM=offscreen")
 endfunction()
 
+# Benchmarks are built alongside the tests but not registered with ctest,
+# since their runtime is only meaningful on a quiet machine. Run the binary
+# manually; pass -csv for machine-readable results to diff across releases.
+function(auto_benchmark subsystem module)
+  add_executable(bench_${module}
+    test/${subsystem}/${module}_bench.cpp)
+  target_link_libraries(bench_${module}
+    ${PROJECT_NAME}_static
+    ${CHECK_LIBRARIES}
+    Qt6::Test)
+  if(QT_FEATURE_static)
+    target_link_libraries(bench_${module}
+      Qt6::QOffscreenIntegrationPlugin)
+  endif()
+endfunction()
+
 add_subdirectory(test/mock)
 add_subdirectory(test/dbutility)
 
@@ -39,17 +55,20 @@ auto_test(core core "${${PROJECT_NAME}_RESOURCES}" "mock_library")
 auto_test(core chatid "" "")
 auto_test(core toxid "" "")
 auto_test(core toxstring "" "")
+auto_test(core coremetrics "" "")
 auto_test(core fileprogress "" "")
 auto_test(chatlog textformatter "" "")
 auto_test(net bsu "${${PROJECT_NAME}_RESOURCES}" "") # needs nodes list
 auto_test(chatlog chatlinestorage "" "")
 auto_test(persistence paths "" "")
+auto_test(persistence rawdatabase "" "")
 auto_test(persistence dbschema "" "dbutility_library")
 auto_test(persistence/dbupgrade dbTo11 "" "dbutility_library")
 auto_test(persistence offlinemsgengine "" "")
 if("EmojiOne" IN_LIST SMILEY_PACKS)
   auto_test(persistence smileypack "${SMILEY_RESOURCES}" "") # needs emojione
 endif()
+auto_test(model chatstatistics "" "")
 auto_test(model friendlistmanager "" "")
 auto_test(model friendmessagedispatcher "" "")
 auto_test(model conferencemessagedispatcher "" "mock_library")
@@ -71,3 +90,6 @@ endif()
 if (UNIX)
   auto_test(platform posixsignalnotifier "" "")
 endif()
+
+auto_benchmark(bench hotpaths)
+auto_benchmark(bench messagingpipeline)
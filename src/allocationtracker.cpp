@@ -0,0 +1,136 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "allocationtracker.h"
+
+#include <QStringBuilder>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <tuple>
+
+namespace {
+constexpr std::array<const char*, AllocationTracker::subsystemCount> subsystemNames = {
+    "untagged",
+    "chat render",
+    "video convert",
+    "database",
+};
+
+// Value-initialized so the counters are usable before main(), since the
+// operator new hook fires during static initialization too
+std::array<std::atomic<uint64_t>, AllocationTracker::subsystemCount> allocationCounts{};
+std::array<std::atomic<uint64_t>, AllocationTracker::subsystemCount> allocationBytes{};
+
+thread_local AllocationTracker::Subsystem currentSubsystem = AllocationTracker::Subsystem::Untagged;
+} // namespace
+
+AllocationTracker::Scope::Scope(Subsystem subsystem)
+    : previous{currentSubsystem}
+{
+    currentSubsystem = subsystem;
+}
+
+AllocationTracker::Scope::~Scope()
+{
+    currentSubsystem = previous;
+}
+
+void AllocationTracker::record(std::size_t size) noexcept
+{
+    const auto index = static_cast<std::size_t>(currentSubsystem);
+    allocationCounts[index].fetch_add(1, std::memory_order_relaxed);
+    allocationBytes[index].fetch_add(size, std::memory_order_relaxed);
+}
+
+AllocationTracker::Snapshot AllocationTracker::snapshot()
+{
+    Snapshot snap;
+    for (std::size_t i = 0; i < subsystemCount; ++i) {
+        snap.allocations[i] = allocationCounts[i].load(std::memory_order_relaxed);
+        snap.bytes[i] = allocationBytes[i].load(std::memory_order_relaxed);
+    }
+    return snap;
+}
+
+void AllocationTracker::reset()
+{
+    for (std::size_t i = 0; i < subsystemCount; ++i) {
+        allocationCounts[i].store(0, std::memory_order_relaxed);
+        allocationBytes[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+bool AllocationTracker::isEnabled()
+{
+#ifdef ALLOCATION_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+QString AllocationTracker::Snapshot::toString() const
+{
+    QString text;
+    if (!AllocationTracker::isEnabled()) {
+        text += QStringLiteral("Allocation tracking is disabled in this build.\n"
+                               "Rebuild with -DALLOCATION_TRACKING=ON to enable it.\n\n");
+    }
+
+    text += QStringLiteral("Allocations by subsystem:\n");
+    for (std::size_t i = 0; i < AllocationTracker::subsystemCount; ++i) {
+        text += QStringLiteral("  %1: %2 allocations, %3 bytes\n")
+                    .arg(QLatin1String{subsystemNames[i]})
+                    .arg(allocations[i])
+                    .arg(bytes[i]);
+    }
+    return text;
+}
+
+#ifdef ALLOCATION_TRACKING
+// Global hooks attributing every allocation to the active subsystem scope.
+// Only compiled into instrumented builds; release builds keep the default
+// allocator untouched.
+void* operator new(std::size_t size)
+{
+    AllocationTracker::record(size);
+    if (void* ptr = std::malloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size)
+{
+    AllocationTracker::record(size);
+    if (void* ptr = std::malloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t size) noexcept
+{
+    std::ignore = size;
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t size) noexcept
+{
+    std::ignore = size;
+    std::free(ptr);
+}
+#endif
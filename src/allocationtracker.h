@@ -0,0 +1,69 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include <QString>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Opt-in allocation instrumentation for hot paths.
+ *
+ * When built with -DALLOCATION_TRACKING=ON, global operator new is hooked and
+ * every allocation is attributed to the subsystem whose Scope marker is active
+ * on the current thread. Markers sit in chat rendering, video frame conversion
+ * and database execution; the counters are shown live in the debug pane and
+ * can be dumped to a file, so allocations-per-message or per-frame is a
+ * tracked number instead of a guess.
+ *
+ * Without the build flag the scopes still compile (they only flip a
+ * thread-local), but no allocations are recorded and the counters stay zero.
+ */
+class AllocationTracker
+{
+public:
+    enum class Subsystem
+    {
+        Untagged,
+        ChatRender,
+        VideoConvert,
+        Database,
+        Count,
+    };
+
+    static constexpr auto subsystemCount = static_cast<std::size_t>(Subsystem::Count);
+
+    struct Snapshot
+    {
+        std::array<uint64_t, subsystemCount> allocations{};
+        std::array<uint64_t, subsystemCount> bytes{};
+
+        QString toString() const;
+    };
+
+    /**
+     * @brief Tags all allocations on the current thread for its lifetime.
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(Subsystem subsystem);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Subsystem previous;
+    };
+
+    // Called from the operator new hook; must not allocate
+    static void record(std::size_t size) noexcept;
+    static Snapshot snapshot();
+    static void reset();
+    static bool isEnabled();
+};
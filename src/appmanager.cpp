@@ -5,17 +5,25 @@
 
 #include "appmanager.h"
 
+#include "src/asynclogsink.h"
+#include "src/chatlog/pixmapcache.h"
+#include "src/core/toxpk.h"
 #include "src/ipc.h"
+#include "src/memoryusagetracker.h"
 #include "src/net/toxuri.h"
 #include "src/nexus.h"
+#include "src/persistence/history.h"
 #include "src/persistence/profile.h"
 #include "src/persistence/settings.h"
 #include "src/persistence/toxsave.h"
+#include "src/startuptracer.h"
 #include "src/version.h"
 #include "src/video/camerasource.h"
+#include "src/video/videoframe.h"
 #include "src/widget/tool/messageboxmanager.h"
 #include "src/widget/translator.h"
 #include "src/widget/widget.h"
+#include "src/workerpool.h"
 
 #if defined(Q_OS_UNIX)
 #include "src/platform/posixsignalnotifier.h"
@@ -24,18 +32,16 @@
 #include <QApplication>
 #include <QCommandLineParser>
 #include <QDir>
+#include <QFile>
 #include <QFontDatabase>
+#include <QFuture>
 #include <QMessageBox>
 #include <QObject>
+#include <QtConcurrent/QtConcurrentRun>
 
 namespace {
-// logMessageHandler and associated data must be static due to qInstallMessageHandler's
+// logMessageHandler must be static due to qInstallMessageHandler's
 // inability to register a void* to get back to a class
-#ifdef LOG_TO_FILE
-QAtomicPointer<FILE> logFileFile = nullptr;
-QList<QByteArray>* logBuffer = new QList<QByteArray>(); // Store log messages until log file opened
-QMutex* logBufferMutex = new QMutex();
-#endif
 
 constexpr std::string_view sourceRootPath()
 {
@@ -75,13 +81,6 @@ QString canonicalLogFilePath(const char* filename)
     return file;
 }
 
-// Replace the user's home with "~" to prevent leaking the user's username in log messages.
-QString canonicalLogMessage(QString msg)
-{
-    // Replace the user's home with "~" to prevent leaking the user's username in log messages.
-    return msg.replace(QDir::homePath(), QStringLiteral("~"));
-}
-
 void logMessageHandler(QtMsgType type, const QMessageLogContext& ctxt, const QString& msg)
 {
     // Silence qWarning spam due to bug in QTextBrowser (trying to open a file for base64 images)
@@ -112,63 +111,9 @@ void logMessageHandler(QtMsgType type, const QMessageLogContext& ctxt, const QSt
         return;
     }
 
-    // Time should be in UTC to save user privacy on log sharing
-    QTime time = QDateTime::currentDateTime().toUTC().time();
-    QString logPrefix =
-        QStringLiteral("[%1 UTC] (%2) %3:%4 : ")
-            .arg(time.toString("HH:mm:ss.zzz"), category, file, QString::number(ctxt.line));
-    switch (type) {
-    case QtDebugMsg:
-        logPrefix += "Debug";
-        break;
-    case QtInfoMsg:
-        logPrefix += "Info";
-        break;
-    case QtWarningMsg:
-        logPrefix += "Warning";
-        break;
-    case QtCriticalMsg:
-        logPrefix += "Critical";
-        break;
-    case QtFatalMsg:
-        logPrefix += "Fatal";
-        break;
-    default:
-        break;
-    }
-
-    QString logMsg;
-    for (const auto& line : msg.split('\n')) {
-        logMsg += logPrefix + ": " + canonicalLogMessage(line) + "\n";
-    }
-
-    const QByteArray LogMsgBytes = logMsg.toUtf8();
-    fwrite(LogMsgBytes.constData(), 1, LogMsgBytes.size(), stderr);
-
-#ifdef LOG_TO_FILE
-    FILE* logFilePtr = logFileFile.loadRelaxed(); // atomically load the file pointer
-    if (!logFilePtr) {
-        logBufferMutex->lock();
-        if (logBuffer)
-            logBuffer->append(LogMsgBytes);
-
-        logBufferMutex->unlock();
-    } else {
-        logBufferMutex->lock();
-        if (logBuffer) {
-            // empty logBuffer to file
-            foreach (QByteArray bufferedMsg, *logBuffer)
-                fwrite(bufferedMsg.constData(), 1, bufferedMsg.size(), logFilePtr);
-
-            delete logBuffer; // no longer needed
-            logBuffer = nullptr;
-        }
-        logBufferMutex->unlock();
-
-        fwrite(LogMsgBytes.constData(), 1, LogMsgBytes.size(), logFilePtr);
-        fflush(logFilePtr);
-    }
-#endif
+    // Formatting, rate limiting and I/O happen on the sink's drain thread so
+    // a logging burst never stalls the Core/AV threads on disk writes.
+    AsyncLogSink::instance().enqueue(type, category.toUtf8(), file.toUtf8(), ctxt.line, msg);
 }
 
 bool toxURIEventHandler(const QByteArray& eventData, void* userData)
@@ -185,6 +130,51 @@ bool toxURIEventHandler(const QByteArray& eventData, void* userData)
     uriDialog->handleToxURI(QString::fromUtf8(eventData));
     return true;
 }
+
+/**
+ * @brief Headless chat history export, for --export-chat-history.
+ *
+ * Streams the chat to disk through History::exportChat without constructing
+ * any GUI, so it works on machines without a display server.
+ */
+int exportChatHistory(Profile& profile, const QString& publicKey, const QString& outputPath)
+{
+    if (publicKey.length() != ToxPk::numHexChars) {
+        qCritical() << "--export-chat-history expects a" << ToxPk::numHexChars
+                    << "character hex public key";
+        return EXIT_FAILURE;
+    }
+    const ToxPk chatPk{publicKey};
+
+    History* history = profile.getHistory();
+    if (history == nullptr || !history->isValid()) {
+        qCritical() << "Chat history is disabled or unavailable for this profile";
+        return EXIT_FAILURE;
+    }
+    if (!history->historyExists(chatPk)) {
+        qCritical() << "No chat history found for" << publicKey;
+        return EXIT_FAILURE;
+    }
+
+    const QString path = outputPath.isEmpty() ? publicKey + ".json" : outputPath;
+    const auto format = path.endsWith(QStringLiteral(".csv"), Qt::CaseInsensitive)
+                            ? History::ExportFormat::csv
+                            : History::ExportFormat::json;
+
+    QFile output{path};
+    if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCritical() << "Failed to open" << path << "for writing:" << output.errorString();
+        return EXIT_FAILURE;
+    }
+
+    if (!history->exportChat(chatPk, output, format)) {
+        qCritical() << "Failed to export chat history for" << publicKey;
+        return EXIT_FAILURE;
+    }
+
+    qInfo() << "Exported chat history to" << path;
+    return EXIT_SUCCESS;
+}
 } // namespace
 
 AppManager::AppManager(int& argc, char** argv)
@@ -197,6 +187,9 @@ AppManager::AppManager(int& argc, char** argv)
 
 void AppManager::preConstructionInitialization()
 {
+    // Anchor the startup clock before QApplication construction so the trace
+    // covers the whole cold start
+    StartupTracer::instance();
     qInstallMessageHandler(logMessageHandler);
 }
 
@@ -214,18 +207,53 @@ int AppManager::run()
     qapp->setDesktopFileName("io.github.TokTok.qTox");
     qapp->setApplicationVersion("\nGit commit: " + QString(GIT_VERSION));
 
-    // Install Unicode 6.1 supporting font
-    // Keep this as close to the beginning of `main()` as possible, otherwise
-    // on systems that have poor support for Unicode qTox will look bad.
-    if (QFontDatabase::addApplicationFont("://font/DejaVuSans.ttf") == -1) {
-        qWarning() << "Couldn't load font";
+    // Font registration and translation loading are pure resource parsing, so
+    // they run as parallel tasks overlapped with the serial startup work
+    // (argument parsing, IPC, log setup, profile load) and are joined right
+    // before the first visible UI. QFontDatabase is thread-safe in Qt 6, and
+    // Translator::load() defers the install to the GUI thread.
+    QFuture<int> fontFuture;
+    QFuture<Translator::Preload> translationFuture;
+    {
+        StartupTracer::Scope scope{"preloadKickoff"};
+        // Install Unicode 6.1 supporting font
+        // Keep this as close to the beginning of `main()` as possible, otherwise
+        // on systems that have poor support for Unicode qTox will look bad.
+        fontFuture = QtConcurrent::run(
+            [] { return QFontDatabase::addApplicationFont("://font/DejaVuSans.ttf"); });
+
+        // We need to init the resources in the translations_library explicitly,
+        // on this thread, before the task reads from them.
+        // See https://doc.qt.io/qt-5/resources.html#using-resources-in-a-library
+        Q_INIT_RESOURCE(translations);
+        translationFuture = QtConcurrent::run(
+            [locale = settings->getTranslation()] { return Translator::load(locale); });
     }
 
-    QString locale = settings->getTranslation();
-    // We need to init the resources in the translations_library explicitly.
-    // See https://doc.qt.io/qt-5/resources.html#using-resources-in-a-library
-    Q_INIT_RESOURCE(translations);
-    Translator::translate(locale);
+    bool preloadsJoined = false;
+    const auto joinStartupPreloads = [&] {
+        if (preloadsJoined) {
+            return;
+        }
+        preloadsJoined = true;
+        StartupTracer::Scope scope{"preloadJoin"};
+        Translator::apply(translationFuture.result());
+        if (fontFuture.result() == -1) {
+            qWarning() << "Couldn't load font";
+        }
+    };
+
+    // The parser captures tr() strings at construction, but the only
+    // user-visible text that early is --help/--version output, so only those
+    // runs wait for the translators
+    {
+        const QStringList arguments = qapp->arguments();
+        if (arguments.contains(QStringLiteral("-h")) || arguments.contains(QStringLiteral("--help"))
+            || arguments.contains(QStringLiteral("-v"))
+            || arguments.contains(QStringLiteral("--version"))) {
+            joinStartupPreloads();
+        }
+    }
 
     // Process arguments
     QCommandLineParser parser;
@@ -255,6 +283,15 @@ int AppManager::run()
                                                       << "proxy",
                                         tr("Sets proxy settings. Default is NONE."),
                                         tr("(SOCKS5/HTTP/NONE):(ADDRESS):(PORT)")));
+    parser.addOption(QCommandLineOption("export-chat-history",
+                                        tr("Exports the chat history with the given contact to a "
+                                           "file and exits, without starting the GUI. Requires an "
+                                           "unencrypted profile, selected with -p."),
+                                        tr("public key")));
+    parser.addOption(QCommandLineOption("export-file",
+                                        tr("Output file for --export-chat-history. The format is "
+                                           "chosen by extension, .json (default) or .csv."),
+                                        tr("path")));
     parser.process(*qapp);
 
     if (ipc->isAttached()) {
@@ -264,43 +301,70 @@ int AppManager::run()
                       "functionality.";
     }
 
+    // Apply the persisted performance knobs to their process-wide consumers
+    // and keep them applied on change, so tuning from the Advanced settings
+    // tab takes effect without a restart. Consumers with a settings reference
+    // (History, ChatWidget) read their knobs on each use instead.
+    PixmapCache::getInstance().setBudget(qsizetype{settings->getImageCacheBudgetMiB()} << 20);
+    WorkerPool::instance().setInteractiveThreadCount(settings->getInteractivePoolThreads());
+    WorkerPool::instance().setBackgroundThreadCount(settings->getBackgroundPoolThreads());
+    settings->connectTo_imageCacheBudgetChanged(this, [](int budgetMiB) {
+        PixmapCache::getInstance().setBudget(qsizetype{budgetMiB} << 20);
+    });
+    settings->connectTo_interactivePoolThreadsChanged(this, [](int threads) {
+        WorkerPool::instance().setInteractiveThreadCount(threads);
+    });
+    settings->connectTo_backgroundPoolThreadsChanged(this, [](int threads) {
+        WorkerPool::instance().setBackgroundThreadCount(threads);
+    });
+
+    // The frame pool is all statics, so it has no constructor of its own to
+    // register from; the instance-owning caches register themselves
+    MemoryUsageTracker::instance().registerSource(this, QStringLiteral("Video frame pool"),
+                                                  &VideoFrame::pooledBufferBytes,
+                                                  &VideoFrame::trimFramePool);
+
 #ifdef LOG_TO_FILE
-    QString logFileDir = settings->getPaths().getAppCacheDirPath();
-    QDir(logFileDir).mkpath(".");
+    {
+        StartupTracer::Scope scope{"logFile"};
+        QString logFileDir = settings->getPaths().getAppCacheDirPath();
+        QDir(logFileDir).mkpath(".");
 
-    QString logfile = logFileDir + "qtox.log";
-    FILE* mainLogFilePtr = fopen(logfile.toLocal8Bit().constData(), "a");
+        QString logfile = logFileDir + "qtox.log";
+        FILE* mainLogFilePtr = fopen(logfile.toLocal8Bit().constData(), "a");
 
-    // Trim log file if over 1MB
-    if (QFileInfo(logfile).size() > 1000000) {
-        qDebug() << "Log file over 1MB, rotating...";
+        // Trim log file if over 1MB
+        if (QFileInfo(logfile).size() > 1000000) {
+            qDebug() << "Log file over 1MB, rotating...";
 
-        // close old logfile (need for windows)
-        if (mainLogFilePtr)
-            fclose(mainLogFilePtr);
+            // close old logfile (need for windows)
+            if (mainLogFilePtr)
+                fclose(mainLogFilePtr);
 
-        QDir dir(logFileDir);
+            QDir dir(logFileDir);
 
-        // Check if log.1 already exists, and if so, delete it
-        if (dir.remove(logFileDir + "qtox.log.1"))
-            qDebug() << "Removed old log successfully";
-        else
-            qWarning() << "Unable to remove old log file";
+            // Check if log.1 already exists, and if so, delete it
+            if (dir.remove(logFileDir + "qtox.log.1"))
+                qDebug() << "Removed old log successfully";
+            else
+                qWarning() << "Unable to remove old log file";
 
-        if (!dir.rename(logFileDir + "qtox.log", logFileDir + "qtox.log.1"))
-            qCritical() << "Unable to move logs";
+            if (!dir.rename(logFileDir + "qtox.log", logFileDir + "qtox.log.1"))
+                qCritical() << "Unable to move logs";
 
-        // open a new logfile
-        mainLogFilePtr = fopen(logfile.toLocal8Bit().constData(), "a");
-    }
+            // open a new logfile
+            mainLogFilePtr = fopen(logfile.toLocal8Bit().constData(), "a");
+        }
 
-    if (!mainLogFilePtr) {
-        qCritical() << "Couldn't open logfile" << logfile;
-    } else {
-        qDebug() << "Logging to" << logfile;
-    }
+        if (!mainLogFilePtr) {
+            qCritical() << "Couldn't open logfile" << logfile;
+        } else {
+            qDebug() << "Logging to" << logfile;
+        }
 
-    logFileFile.storeRelaxed(mainLogFilePtr); // atomically set the logFile
+        // The sink takes ownership and closes the file on shutdown.
+        AsyncLogSink::instance().setLogFile(mainLogFilePtr);
+    }
 #endif
 
     // Windows platform plugins DLL hell fix
@@ -332,6 +396,12 @@ int AppManager::run()
         profileName = settings->getCurrentProfile();
     }
 
+    // Headless tooling must run in this process, never hand off to a running
+    // instance
+    if (parser.isSet("export-chat-history")) {
+        doIpc = false;
+    }
+
     if (parser.positionalArguments().empty()) {
         eventType = "activate";
     } else {
@@ -350,6 +420,8 @@ int AppManager::run()
     }
 
     if (doIpc && !ipc->isCurrentOwner()) {
+        // This can block for up to two seconds waiting on the other instance
+        StartupTracer::Scope scope{"ipcEvent"};
         time_t event = ipc->postEvent(eventType, firstParam.toUtf8(), ipcDest);
         // If someone else processed it, we're done here, no need to actually start qTox
         if (ipc->waitUntilAccepted(event, 2)) {
@@ -372,21 +444,40 @@ int AppManager::run()
     // TODO(kriby): Consider moving application initializing variables into a globalSettings object
     //  note: Because Settings is shouldering global settings as well as model specific ones it
     //  cannot be integrated into a central model object yet
-    cameraSource = std::unique_ptr<CameraSource>(new CameraSource{*settings});
-    nexus = std::unique_ptr<Nexus>(new Nexus{*settings, *messageBoxManager, *cameraSource, *ipc});
+    {
+        StartupTracer::Scope scope{"nexusInit"};
+        cameraSource = std::unique_ptr<CameraSource>(new CameraSource{*settings});
+        nexus = std::unique_ptr<Nexus>(new Nexus{*settings, *messageBoxManager, *cameraSource, *ipc});
+    }
     // Autologin
     // TODO (kriby): Shift responsibility of linking views to model objects from nexus
     // Further: generate view instances separately (loginScreen, mainGUI, audio)
     Profile* profile = nullptr;
-    if (autoLogin && Profile::exists(profileName, settings->getPaths())
-        && !Profile::isEncrypted(profileName, settings->getPaths())) {
+    const bool attemptAutoLogin = autoLogin && Profile::exists(profileName, settings->getPaths())
+                                  && !Profile::isEncrypted(profileName, settings->getPaths());
+    if (attemptAutoLogin) {
         profile = Profile::loadProfile(profileName, QString(), *settings, &parser, *cameraSource,
                                        *messageBoxManager);
-        if (!profile) {
-            QMessageBox::information(nullptr, tr("Error"), tr("Failed to load profile automatically."));
+    }
+
+    // The profile load above was the last piece of startup work overlapping the
+    // preload tasks; everything from here on shows translated UI
+    joinStartupPreloads();
+
+    if (attemptAutoLogin && !profile) {
+        QMessageBox::information(nullptr, tr("Error"), tr("Failed to load profile automatically."));
+    }
+    if (parser.isSet("export-chat-history")) {
+        if (profile == nullptr) {
+            qCritical() << "--export-chat-history needs an unencrypted profile, selected with -p";
+            return EXIT_FAILURE;
         }
+        return exportChatHistory(*profile, parser.value("export-chat-history"),
+                                 parser.value("export-file"));
     }
+
     if (profile) {
+        StartupTracer::Scope scope{"nexusBootstrap"};
         nexus->bootstrapWithProfile(profile);
     } else {
         nexus->setParser(&parser);
@@ -415,6 +506,9 @@ int AppManager::run()
 
     connect(qapp.get(), &QApplication::aboutToQuit, this, &AppManager::cleanup);
 
+    StartupTracer::instance().flush(settings->getPaths().getAppCacheDirPath()
+                                    + QStringLiteral("qtox-startup-trace.json"));
+
     return qapp->exec();
 }
 
@@ -434,11 +528,7 @@ void AppManager::cleanup()
 
     qDebug() << "Cleanup success";
 
-#ifdef LOG_TO_FILE
-    FILE* f = logFileFile.loadRelaxed();
-    if (f != nullptr) {
-        fclose(f);
-        logFileFile.storeRelaxed(nullptr); // atomically disable logging to file
-    }
-#endif
+    // Drains queued records and closes the log file; later qDebug calls fall
+    // back to synchronous stderr writes.
+    AsyncLogSink::instance().shutdown();
 }
@@ -0,0 +1,282 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "asynclogsink.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QHash>
+#include <QList>
+
+#include <chrono>
+
+namespace {
+// Power of two so the slot index is a mask instead of a modulo.
+constexpr size_t ringSize = 2048;
+constexpr size_t ringMask = ringSize - 1;
+
+// A single category flooding faster than this is truncated per window so a
+// toxcore burst can't fill the ring and starve everyone else's records.
+constexpr int maxPerCategoryPerSecond = 250;
+
+// Replace the user's home with "~" to prevent leaking the user's username in log messages.
+QString canonicalLogMessage(QString msg)
+{
+    return msg.replace(QDir::homePath(), QStringLiteral("~"));
+}
+
+QByteArray formatRecord(QtMsgType type, const QByteArray& category, const QByteArray& file,
+                        int line, const QString& msg, qint64 timeMsUtc)
+{
+    // Time should be in UTC to save user privacy on log sharing
+    const QTime time = QDateTime::fromMSecsSinceEpoch(timeMsUtc).toUTC().time();
+    QString logPrefix = QStringLiteral("[%1 UTC] (%2) %3:%4 : ")
+                            .arg(time.toString("HH:mm:ss.zzz"), QString::fromUtf8(category),
+                                 QString::fromUtf8(file), QString::number(line));
+    switch (type) {
+    case QtDebugMsg:
+        logPrefix += "Debug";
+        break;
+    case QtInfoMsg:
+        logPrefix += "Info";
+        break;
+    case QtWarningMsg:
+        logPrefix += "Warning";
+        break;
+    case QtCriticalMsg:
+        logPrefix += "Critical";
+        break;
+    case QtFatalMsg:
+        logPrefix += "Fatal";
+        break;
+    default:
+        break;
+    }
+
+    QString logMsg;
+    for (const auto& msgLine : msg.split('\n')) {
+        logMsg += logPrefix + ": " + canonicalLogMessage(msgLine) + "\n";
+    }
+    return logMsg.toUtf8();
+}
+} // namespace
+
+struct AsyncLogSink::Slot
+{
+    std::atomic<size_t> seq{0};
+    QtMsgType type{QtDebugMsg};
+    QByteArray category;
+    QByteArray file;
+    int line{0};
+    QString msg;
+    qint64 timeMsUtc{0};
+};
+
+AsyncLogSink::AsyncLogSink()
+    : ring{new Slot[ringSize]}
+{
+    for (size_t i = 0; i < ringSize; ++i) {
+        ring[i].seq.store(i, std::memory_order_relaxed);
+    }
+    drainThread = std::thread{[this] { drainLoop(); }};
+}
+
+AsyncLogSink::~AsyncLogSink()
+{
+    shutdown();
+}
+
+AsyncLogSink& AsyncLogSink::instance()
+{
+    static AsyncLogSink sink;
+    return sink;
+}
+
+void AsyncLogSink::enqueue(QtMsgType type, const QByteArray& category, const QByteArray& file,
+                           int line, const QString& msg)
+{
+    const qint64 timeMsUtc = QDateTime::currentMSecsSinceEpoch();
+
+    if (!running.load(std::memory_order_acquire)) {
+        // Drain thread is gone (late shutdown logging); degrade to the old
+        // synchronous behavior rather than losing the message.
+        writeRecord(type, category, file, line, msg, timeMsUtc);
+        return;
+    }
+
+    // Bounded MPMC enqueue (Vyukov): claim a slot by CAS on enqueuePos, then
+    // publish it by bumping the slot's sequence number. Never blocks; a full
+    // ring drops the record and the drain thread reports the drop count.
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = ring[pos & ringMask];
+        const size_t seq = slot.seq.load(std::memory_order_acquire);
+        const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.type = type;
+                slot.category = category;
+                slot.file = file;
+                slot.line = line;
+                slot.msg = msg;
+                slot.timeMsUtc = timeMsUtc;
+                slot.seq.store(pos + 1, std::memory_order_release);
+                break;
+            }
+        } else if (diff < 0) {
+            droppedFull.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    if (type == QtFatalMsg) {
+        // Qt aborts as soon as the handler returns, so make sure the record
+        // (and everything queued before it) actually reaches disk.
+        flushSync();
+    }
+}
+
+void AsyncLogSink::setLogFile(FILE* file)
+{
+    logFile.storeRelease(file);
+}
+
+void AsyncLogSink::shutdown()
+{
+    bool wasRunning = true;
+    if (!running.compare_exchange_strong(wasRunning, false)) {
+        return;
+    }
+    if (drainThread.joinable()) {
+        drainThread.join();
+    }
+    FILE* file = logFile.fetchAndStoreOrdered(nullptr);
+    if (file != nullptr) {
+        fclose(file);
+    }
+}
+
+void AsyncLogSink::drainLoop()
+{
+    struct RateWindow
+    {
+        qint64 startMs{0};
+        int count{0};
+        int suppressed{0};
+    };
+    QHash<QByteArray, RateWindow> rates;
+
+    const auto drainOne = [&]() -> bool {
+        const size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Slot& slot = ring[pos & ringMask];
+        const size_t seq = slot.seq.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) != 0) {
+            return false; // ring empty
+        }
+        const QtMsgType type = slot.type;
+        const QByteArray category = std::move(slot.category);
+        const QByteArray file = std::move(slot.file);
+        const int line = slot.line;
+        const QString msg = std::move(slot.msg);
+        const qint64 timeMsUtc = slot.timeMsUtc;
+        slot.seq.store(pos + ringSize, std::memory_order_release);
+        dequeuePos.store(pos + 1, std::memory_order_relaxed);
+
+        RateWindow& window = rates[category];
+        if (timeMsUtc - window.startMs >= 1000) {
+            if (window.suppressed > 0) {
+                writeRecord(QtInfoMsg, category, QByteArrayLiteral("asynclogsink.cpp"), 0,
+                            QStringLiteral("rate limit: suppressed %1 messages in the last second")
+                                .arg(window.suppressed),
+                            timeMsUtc);
+            }
+            window = RateWindow{timeMsUtc, 0, 0};
+        }
+        // Critical and fatal records are exempt from the limit.
+        if (++window.count > maxPerCategoryPerSecond && type != QtCriticalMsg
+            && type != QtFatalMsg) {
+            ++window.suppressed;
+            return true;
+        }
+
+        writeRecord(type, category, file, line, msg, timeMsUtc);
+        return true;
+    };
+
+    for (;;) {
+        bool wroteAny = false;
+        while (drainOne()) {
+            wroteAny = true;
+        }
+
+        const uint64_t dropped = droppedFull.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0) {
+            writeRecord(QtWarningMsg, QByteArrayLiteral("default"),
+                        QByteArrayLiteral("asynclogsink.cpp"), 0,
+                        QStringLiteral("log ring full: dropped %1 records").arg(dropped),
+                        QDateTime::currentMSecsSinceEpoch());
+            wroteAny = true;
+        }
+
+        if (!wroteAny) {
+            if (!running.load(std::memory_order_acquire)) {
+                return; // drained everything queued before shutdown
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+}
+
+void AsyncLogSink::flushSync()
+{
+    // Wait (bounded) for the drain thread to catch up to everything queued so
+    // far, then force the file write out.
+    const size_t target = enqueuePos.load(std::memory_order_acquire);
+    for (int i = 0; i < 2000; ++i) {
+        if (dequeuePos.load(std::memory_order_acquire) >= target) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    FILE* file = logFile.loadAcquire();
+    if (file != nullptr) {
+        fflush(file);
+    }
+}
+
+void AsyncLogSink::writeRecord(QtMsgType type, const QByteArray& category, const QByteArray& file,
+                               int line, const QString& msg, qint64 timeMsUtc)
+{
+    writeLine(formatRecord(type, category, file, line, msg, timeMsUtc));
+}
+
+void AsyncLogSink::writeLine(const QByteArray& line)
+{
+    fwrite(line.constData(), 1, line.size(), stderr);
+
+    // Lines logged before the log file is opened are kept until it shows up,
+    // like the old logBuffer in the message handler did.
+    static QList<QByteArray>* backlog = new QList<QByteArray>();
+
+    FILE* file = logFile.loadAcquire();
+    if (file == nullptr) {
+        if (backlog != nullptr && running.load(std::memory_order_acquire)) {
+            backlog->append(line);
+        }
+        return;
+    }
+
+    if (backlog != nullptr) {
+        for (const QByteArray& buffered : *backlog) {
+            fwrite(buffered.constData(), 1, buffered.size(), file);
+        }
+        delete backlog;
+        backlog = nullptr;
+    }
+
+    fwrite(line.constData(), 1, line.size(), file);
+    fflush(file);
+}
@@ -0,0 +1,74 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include <QAtomicPointer>
+#include <QByteArray>
+#include <QString>
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+/**
+ * @brief Asynchronous sink behind the Qt message handler.
+ *
+ * The message handler used to format and fwrite every line synchronously,
+ * so a burst of toxcore logging could stall the Core or AV thread on disk
+ * I/O. enqueue() instead copies the raw fields into a slot of a bounded
+ * lock-free ring (Vyukov MPMC) and returns; a dedicated drain thread does
+ * the timestamp formatting, per-category rate limiting and the actual
+ * writes to stderr and the log file. QString/QByteArray copies are
+ * implicitly shared, so the producer cost is a few atomic operations.
+ *
+ * When the ring is full the record is dropped and counted; the drain
+ * thread reports drops instead of ever blocking a producer.
+ */
+class AsyncLogSink
+{
+public:
+    static AsyncLogSink& instance();
+
+    /**
+     * @brief Queues one log record; safe to call from any thread.
+     *
+     * Fatal records additionally drain the ring and flush synchronously,
+     * because Qt aborts as soon as the message handler returns.
+     */
+    void enqueue(QtMsgType type, const QByteArray& category, const QByteArray& file, int line,
+                 const QString& msg);
+
+    /**
+     * @brief Sets the log file; records queued before this are replayed into it.
+     */
+    void setLogFile(FILE* file);
+
+    /**
+     * @brief Drains remaining records and stops the thread. enqueue() after
+     * this falls back to a synchronous stderr write.
+     */
+    void shutdown();
+
+private:
+    AsyncLogSink();
+    ~AsyncLogSink();
+
+    struct Slot;
+
+    void drainLoop();
+    void flushSync();
+    void writeRecord(QtMsgType type, const QByteArray& category, const QByteArray& file, int line,
+                     const QString& msg, qint64 timeMsUtc);
+    void writeLine(const QByteArray& line);
+
+    std::unique_ptr<Slot[]> ring;
+    std::atomic<size_t> enqueuePos{0};
+    std::atomic<size_t> dequeuePos{0};
+    std::atomic<uint64_t> droppedFull{0};
+    std::atomic<bool> running{true};
+    QAtomicPointer<FILE> logFile{nullptr};
+    std::thread drainThread;
+};
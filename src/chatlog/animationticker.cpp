@@ -0,0 +1,57 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "animationticker.h"
+
+#include "src/widget/framegovernor.h"
+
+/**
+ * @brief Shared frame clock for animated chat content.
+ *
+ * Every Spinner and NotificationIcon used to run its own timer, so dozens of
+ * pending file transfers woke the event loop independently at animation rate.
+ * Instead they all connect to tick() and request the next frame from their
+ * paint() via scheduleFrame(). The timer is single-shot: if nothing is painted
+ * (window hidden, lines scrolled out of the viewport), no frame gets scheduled
+ * and the ticker stops on its own.
+ */
+AnimationTicker::AnimationTicker()
+{
+    timer.setInterval(1000 / framerate);
+    timer.setSingleShot(true);
+
+    connect(&timer, &QTimer::timeout, this, &AnimationTicker::tick);
+
+    // Belt and braces on top of the paint-driven stop: while no window is on
+    // screen, ignore frame requests outright
+    connect(&FrameGovernor::getInstance(), &FrameGovernor::appVisibleChanged, this,
+            &AnimationTicker::onAppVisibleChanged);
+}
+
+void AnimationTicker::onAppVisibleChanged(bool visible)
+{
+    paused = !visible;
+    if (paused) {
+        timer.stop();
+    }
+}
+
+/**
+ * @brief Requests a tick() one frame interval from now, at most one per frame.
+ */
+void AnimationTicker::scheduleFrame()
+{
+    if (!paused && !timer.isActive()) {
+        timer.start();
+    }
+}
+
+/**
+ * @brief Returns the singleton instance.
+ */
+AnimationTicker& AnimationTicker::getInstance()
+{
+    static AnimationTicker instance;
+    return instance;
+}
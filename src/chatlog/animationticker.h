@@ -0,0 +1,33 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+
+class AnimationTicker : public QObject
+{
+    Q_OBJECT
+public:
+    static AnimationTicker& getInstance();
+
+    void scheduleFrame();
+
+signals:
+    void tick();
+
+private slots:
+    void onAppVisibleChanged(bool visible);
+
+private:
+    AnimationTicker();
+    AnimationTicker(AnimationTicker&) = delete;
+    AnimationTicker& operator=(const AnimationTicker&) = delete;
+
+    static constexpr int framerate = 30; // 30Hz
+
+    QTimer timer;
+    bool paused = false;
+};
@@ -66,6 +66,18 @@ void ChatLine::addToScene(QGraphicsScene* scene)
         scene->addItem(c);
 }
 
+/**
+ * @brief Whether the line's content items currently live in a scene.
+ *
+ * Lines keep their cached geometry (bbox, layout) when taken out of the
+ * scene, so the scene trimmer can demote far-offscreen lines and put them
+ * back without a relayout.
+ */
+bool ChatLine::isInScene() const
+{
+    return !content.isEmpty() && content.first()->scene() != nullptr;
+}
+
 void ChatLine::setVisible(bool visible)
 {
     for (ChatLineContent* c : content)
@@ -86,12 +98,14 @@ void ChatLine::selectionFocusChanged(bool focusIn)
 
 void ChatLine::fontChanged(const QFont& font)
 {
+    invalidateLayout();
     for (ChatLineContent* c : content)
         c->fontChanged(font);
 }
 
 void ChatLine::reloadTheme()
 {
+    invalidateLayout();
     for (ChatLineContent* c : content) {
         c->reloadTheme();
     }
@@ -139,6 +153,7 @@ void ChatLine::replaceContent(int col, ChatLineContent* lineContent)
         if (scene)
             scene->addItem(content[col]);
 
+        invalidateLayout();
         layout(width, bbox.topLeft());
         content[col]->visibilityChanged(isVisible);
         content[col]->update();
@@ -150,35 +165,29 @@ void ChatLine::layout(qreal w, QPointF scenePos)
     if (!content.size())
         return;
 
-    width = w;
-    bbox.setTopLeft(scenePos);
-
-    qreal fixedWidth = (content.size() - 1) * columnSpacing;
-    qreal varWidth = 0.0; // used for normalization
-
-    for (int i = 0; i < format.size(); ++i) {
-        if (format[i].policy == ColumnFormat::FixedSize)
-            fixedWidth += format[i].size;
-        else
-            varWidth += format[i].size;
+    // If nothing but the vertical position changed since the last full pass,
+    // column widths and the content's internal text layouts are still valid
+    // and we only need to translate the line. This turns the repeated
+    // relayouts done after inserts and during resize ticks from O(text) into
+    // O(columns) for every line whose width is unchanged.
+    if (haveValidLayout && w == width && scenePos.x() == bbox.left()) {
+        const qreal deltaY = scenePos.y() - bbox.top();
+        if (deltaY != 0.0)
+            moveBy(deltaY);
+        return;
     }
 
-    if (varWidth == 0.0)
-        varWidth = 1.0;
+    width = w;
+    bbox.setTopLeft(scenePos);
 
-    qreal leftover = qMax(0.0, width - fixedWidth);
+    const QVector<qreal> widths = columnWidths(w);
 
     qreal maxVOffset = 0.0;
     qreal xOffset = 0.0;
     QVector<qreal> xPos(content.size());
 
     for (int i = 0; i < content.size(); ++i) {
-        // calculate the effective width of the current column
-        qreal contentWidth;
-        if (format[i].policy == ColumnFormat::FixedSize)
-            contentWidth = format[i].size;
-        else
-            contentWidth = format[i].size / varWidth * leftover;
+        const qreal contentWidth = widths[i];
 
         // set the width of the current column
         content[i]->setWidth(contentWidth);
@@ -214,6 +223,52 @@ void ChatLine::layout(qreal w, QPointF scenePos)
     }
 
     updateBBox();
+    haveValidLayout = true;
+}
+
+/**
+ * @brief Computes the effective width of every column for a given line width.
+ *
+ * This is the same distribution layout() applies, factored out so callers
+ * (like the parallel text-layout warm-up) can know each content's width
+ * before the real layout pass runs.
+ */
+QVector<qreal> ChatLine::columnWidths(qreal lineWidth) const
+{
+    qreal fixedWidth = (content.size() - 1) * columnSpacing;
+    qreal varWidth = 0.0; // used for normalization
+
+    for (int i = 0; i < format.size(); ++i) {
+        if (format[i].policy == ColumnFormat::FixedSize)
+            fixedWidth += format[i].size;
+        else
+            varWidth += format[i].size;
+    }
+
+    if (varWidth == 0.0)
+        varWidth = 1.0;
+
+    qreal leftover = qMax(0.0, lineWidth - fixedWidth);
+
+    QVector<qreal> widths(content.size());
+    for (int i = 0; i < content.size(); ++i) {
+        if (format[i].policy == ColumnFormat::FixedSize)
+            widths[i] = format[i].size;
+        else
+            widths[i] = format[i].size / varWidth * leftover;
+    }
+    return widths;
+}
+
+/**
+ * @brief Forces the next layout() call to do a full pass.
+ *
+ * Must be called whenever content geometry may have changed behind our back
+ * (content replacement, font or theme changes).
+ */
+void ChatLine::invalidateLayout()
+{
+    haveValidLayout = false;
 }
 
 void ChatLine::moveBy(qreal deltaY)
@@ -58,9 +58,11 @@ public:
 
     void replaceContent(int col, ChatLineContent* lineContent);
     void layout(qreal width, QPointF scenePos);
+    void invalidateLayout();
     void moveBy(qreal deltaY);
     void removeFromScene();
     void addToScene(QGraphicsScene* scene);
+    bool isInScene() const;
     void setVisible(bool visible);
     void selectionCleared();
     void selectionFocusChanged(bool focusIn);
@@ -68,6 +70,7 @@ public:
     void reloadTheme();
 
     int getColumnCount();
+    QVector<qreal> columnWidths(qreal lineWidth) const;
 
     ChatLineContent* getContent(int col) const;
     ChatLineContent* getContent(QPointF scenePos) const;
@@ -95,4 +98,8 @@ private:
     qreal columnSpacing = 15.0;
     QRectF bbox;
     bool isVisible = false;
+    // True while column widths and content layouts from the last full layout()
+    // pass are still valid, letting repeat layouts at the same width degrade
+    // to a cheap vertical translation
+    bool haveValidLayout = false;
 };
@@ -7,6 +7,13 @@
 
 #include <QDebug>
 
+namespace {
+// Upper bound on the number of evicted lines we keep around for reuse.
+// Matches the rendered window size so scrolling one window back is always a
+// pool hit without more than doubling the peak number of live lines
+constexpr size_t maxRecycledLines = 300;
+} // namespace
+
 ChatLineStorage::iterator ChatLineStorage::insertChatMessage(ChatLogIdx idx, QDateTime timestamp,
                                                              ChatLine::Ptr line)
 {
@@ -21,6 +28,7 @@ ChatLineStorage::iterator ChatLineStorage::insertChatMessage(ChatLogIdx idx, QDa
     insertionPoint = adjustItForDate(insertionPoint, timestamp);
 
     insertionPoint = lines.insert(insertionPoint, line);
+    ++storageRevision;
 
     // All indexes after the insertion have to be incremented by one
     incrementLinePosAfter(linePosIncrementIt);
@@ -55,6 +63,7 @@ ChatLineStorage::iterator ChatLineStorage::insertDateLine(QDateTime timestamp, C
     insertionPoint = adjustItForDate(insertionPoint, timestamp);
 
     insertionPoint = lines.insert(insertionPoint, line);
+    ++storageRevision;
 
     // All indexes after the insertion have to be incremented by one
     incrementLinePosAfter(idxMapIt);
@@ -110,11 +119,20 @@ ChatLineStorage::iterator ChatLineStorage::erase(iterator it)
         }
 
         if (infoIterator != idxInfoMap.end()) {
+            // Only pool lines that map exactly to an indexed message.
+            // equivalentInfoIterator returns the next indexed entry for date
+            // lines and we must not hand those back as chat messages later
+            auto linePos = static_cast<size_t>(std::distance(lines.begin(), it));
+            if (infoIterator->second.linePos == linePos) {
+                recycleLine(infoIterator->first, *it);
+            }
+
             infoIterator = idxInfoMap.erase(infoIterator);
             decrementLinePosAfter(infoIterator);
         }
 
         it = lines.erase(it);
+        ++storageRevision;
 
         if (it > lines.begin()) {
             prevIt = std::prev(it);
@@ -126,6 +144,38 @@ ChatLineStorage::iterator ChatLineStorage::erase(iterator it)
     return it;
 }
 
+ChatLine::Ptr ChatLineStorage::takeRecycledLine(ChatLogIdx idx)
+{
+    auto it = recycledLines.find(idx);
+    if (it == recycledLines.end()) {
+        return ChatLine::Ptr();
+    }
+
+    auto line = std::move(it->second);
+    recycledLines.erase(it);
+
+    return line;
+}
+
+void ChatLineStorage::recycleLine(ChatLogIdx idx, ChatLine::Ptr line)
+{
+    recycledLines[idx] = std::move(line);
+
+    // The window slides contiguously, so of the two ends of the pool the one
+    // farther from the line we just evicted is the least likely to be
+    // scrolled back into view
+    while (recycledLines.size() > maxRecycledLines) {
+        auto first = recycledLines.begin();
+        auto last = std::prev(recycledLines.end());
+
+        if (idx - first->first > last->first - idx) {
+            recycledLines.erase(first);
+        } else {
+            recycledLines.erase(last);
+        }
+    }
+}
+
 ChatLineStorage::iterator ChatLineStorage::equivalentLineIterator(IdxInfoMap_t::iterator it)
 {
     if (it == idxInfoMap.end()) {
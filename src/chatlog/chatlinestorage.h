@@ -7,6 +7,7 @@
 
 #include "src/chatlog/chatline.h"
 #include "src/model/ichatlog.h"
+#include "util/flatmap.h"
 
 #include <QDateTime>
 
@@ -46,7 +47,10 @@ class ChatLineStorage
     };
     using Lines_t = std::vector<ChatLine::Ptr>;
     using DateLineMap_t = std::map<ChatLine::Ptr, QDateTime>;
-    using IdxInfoMap_t = std::map<ChatLogIdx, IdxInfo>;
+    // Flat map keeps the per-frame visibility and layout walks, which look up
+    // every rendered index, on one contiguous allocation. The rendered window
+    // is small so insertion shifts are cheap
+    using IdxInfoMap_t = FlatMap<ChatLogIdx, IdxInfo>;
 
 public:
     // Types to conform with other containers
@@ -61,6 +65,8 @@ public:
     iterator insertChatMessage(ChatLogIdx idx, QDateTime timestamp, ChatLine::Ptr line);
     iterator insertDateLine(QDateTime timestamp, ChatLine::Ptr line);
 
+    ChatLine::Ptr takeRecycledLine(ChatLogIdx idx);
+
     ChatLogIdx firstIdx() const
     {
         return idxInfoMap.begin()->first;
@@ -115,10 +121,21 @@ public:
         return !idxInfoMap.empty();
     }
 
+    /**
+     * Bumped whenever lines are inserted or removed. Lets users know whether
+     * row indexes they cached are still talking about the same lines
+     */
+    uint64_t revision() const
+    {
+        return storageRevision;
+    }
+
     void clear()
     {
         idxInfoMap.clear();
         dateMap.clear();
+        recycledLines.clear();
+        ++storageRevision;
         return lines.clear();
     }
 
@@ -146,8 +163,16 @@ private:
     void incrementLinePosAfter(IdxInfoMap_t::iterator it);
     void decrementLinePosAfter(IdxInfoMap_t::iterator it);
     bool shouldRemovePreviousLine(iterator prevIt, iterator it);
+    void recycleLine(ChatLogIdx idx, ChatLine::Ptr line);
 
     std::vector<ChatLine::Ptr> lines;
+    uint64_t storageRevision = 0;
     std::map<ChatLine::Ptr, QDateTime> dateMap;
     IdxInfoMap_t idxInfoMap;
+    // Bounded pool of indexed lines that were evicted as the rendered window
+    // slid past them. Re-rendering the same index takes the line back from
+    // here instead of rebuilding the whole QGraphicsItem tree. Keeping the
+    // same ChatLine::Ptr alive also preserves selection pointers when
+    // scrolling back over a loading boundary
+    FlatMap<ChatLogIdx, ChatLine::Ptr> recycledLines;
 };
@@ -18,8 +18,10 @@
 
 #include <QCryptographicHash>
 #include <QDebug>
+#include <QRegularExpression>
 
 #include "src/persistence/history.h"
+#include "src/persistence/messagerendercache.h"
 #include "src/persistence/settings.h"
 #include "src/persistence/smileypack.h"
 
@@ -43,43 +45,64 @@ ChatMessage::Ptr ChatMessage::createChatMessage(const QString& sender, const QSt
                                                 Style& style, bool colorizeName)
 {
     ChatMessage::Ptr msg = ChatMessage::Ptr(new ChatMessage(documentCache, settings, style));
+    const auto chatSettings = settings.getChatViewSnapshot();
 
-    QString text = rawMessage.toHtmlEscaped();
     QString senderText = sender;
 
     auto textType = Text::NORMAL;
-    // smileys
-    if (settings.getUseEmoticons())
-        text = smileyPack.smileyfied(text);
-
-    // quotes (green text)
-    text = detectQuotes(text, type);
-    text = TextFormatter::highlightURI(text);
-
-    // text styling
-    Settings::StyleType styleType = settings.getStylePreference();
-    if (styleType != Settings::StyleType::NONE) {
-        text = TextFormatter::applyMarkdown(text, styleType == Settings::StyleType::WITH_CHARS);
-    }
-
-
-    switch (type) {
-    case NORMAL:
-        text = wrapDiv(text, "msg");
-        break;
-    case ACTION:
+    if (type == ACTION) {
         textType = Text::ACTION;
         senderText = "*";
-        text = wrapDiv(QString("%1 %2").arg(sender.toHtmlEscaped(), text), "action");
         msg->setAsAction();
-        break;
-    case ALERT:
-        text = wrapDiv(text, "alert");
-        break;
+    }
+
+    // The formatted HTML is a pure function of these inputs (smileys resolve
+    // their image at render time, so the pack itself is not one of them);
+    // warm messages skip the whole formatter chain
+    QByteArray keyData = rawMessage.toUtf8();
+    keyData += '\0';
+    keyData += sender.toUtf8();
+    keyData += static_cast<char>(type);
+    keyData += chatSettings->useEmoticons ? '\1' : '\0';
+    keyData += static_cast<char>(chatSettings->stylePreference);
+    const QByteArray renderKey = QCryptographicHash::hash(keyData, QCryptographicHash::Sha256);
+
+    QString text = MessageRenderCache::instance().lookup(renderKey);
+    if (text.isNull()) {
+        text = rawMessage.toHtmlEscaped();
+
+        // smileys
+        if (chatSettings->useEmoticons)
+            text = smileyPack.smileyfied(text);
+
+        // quotes (green text)
+        text = detectQuotes(text, type);
+        text = TextFormatter::highlightURI(text);
+
+        // text styling
+        Settings::StyleType styleType = chatSettings->stylePreference;
+        if (styleType != Settings::StyleType::NONE) {
+            text = TextFormatter::applyMarkdown(text, styleType == Settings::StyleType::WITH_CHARS);
+        }
+
+
+        switch (type) {
+        case NORMAL:
+            text = wrapDiv(text, "msg");
+            break;
+        case ACTION:
+            text = wrapDiv(QString("%1 %2").arg(sender.toHtmlEscaped(), text), "action");
+            break;
+        case ALERT:
+            text = wrapDiv(text, "alert");
+            break;
+        }
+
+        MessageRenderCache::instance().store(renderKey, text);
     }
 
     // Note: Eliding cannot be enabled for RichText items. (QTBUG-17207)
-    QFont baseFont = settings.getChatMessageFont();
+    QFont baseFont = chatSettings->chatMessageFont;
     QFont authorFont = baseFont;
     if (isMe)
         authorFont.setBold(true);
@@ -100,8 +123,11 @@ ChatMessage::Ptr ChatMessage::createChatMessage(const QString& sender, const QSt
         }
     }
 
-    msg->addColumn(new Text(documentCache, settings, style, color, senderText, authorFont, true,
-                            sender, textType),
+    auto* authorText =
+        new Text(documentCache, settings, style, color, senderText, authorFont, true, sender, textType);
+    // Fixed-width row chrome; scrolling blits the cached rasterization
+    authorText->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+    msg->addColumn(authorText,
                    ColumnFormat(NAME_COL_WIDTH, ColumnFormat::FixedSize, ColumnFormat::Right));
     msg->addColumn(new Text(documentCache, settings, style, text, baseFont, false,
                             ((type == ACTION) && isMe) ? QString("%1 %2").arg(sender, rawMessage)
@@ -110,7 +136,7 @@ ChatMessage::Ptr ChatMessage::createChatMessage(const QString& sender, const QSt
 
     switch (state) {
     case MessageState::complete:
-        msg->addColumn(new Timestamp(date, settings.getTimestampFormat(), baseFont, documentCache,
+        msg->addColumn(new Timestamp(date, chatSettings->timestampFormat, baseFont, documentCache,
                                      settings, style),
                        ColumnFormat(TIME_COL_WIDTH, ColumnFormat::FixedSize, ColumnFormat::Right));
         break;
@@ -148,13 +174,14 @@ ChatMessage::Ptr ChatMessage::createChatInfoMessage(const QString& rawMessage,
         break;
     }
 
-    QFont baseFont = settings.getChatMessageFont();
+    const auto chatSettings = settings.getChatViewSnapshot();
+    QFont baseFont = chatSettings->chatMessageFont;
 
     msg->addColumn(new Image(QSize(18, 18), img),
                    ColumnFormat(NAME_COL_WIDTH, ColumnFormat::FixedSize, ColumnFormat::Right));
     msg->addColumn(new Text(documentCache, settings, style, "<b>" + text + "</b>", baseFont, false, text),
                    ColumnFormat(1.0, ColumnFormat::VariableSize, ColumnFormat::Left));
-    msg->addColumn(new Timestamp(date, settings.getTimestampFormat(), baseFont, documentCache,
+    msg->addColumn(new Timestamp(date, chatSettings->timestampFormat, baseFont, documentCache,
                                  settings, style),
                    ColumnFormat(TIME_COL_WIDTH, ColumnFormat::FixedSize, ColumnFormat::Right));
 
@@ -169,19 +196,23 @@ ChatMessage::Ptr ChatMessage::createFileTransferMessage(const QString& sender, C
 {
     ChatMessage::Ptr msg = ChatMessage::Ptr(new ChatMessage(documentCache, settings, style));
 
-    QFont baseFont = settings.getChatMessageFont();
+    const auto chatSettings = settings.getChatViewSnapshot();
+    QFont baseFont = chatSettings->chatMessageFont;
     QFont authorFont = baseFont;
     if (isMe) {
         authorFont.setBold(true);
     }
 
-    msg->addColumn(new Text(documentCache, settings, style, sender, authorFont, true),
+    auto* authorText = new Text(documentCache, settings, style, sender, authorFont, true);
+    // Fixed-width row chrome; scrolling blits the cached rasterization
+    authorText->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+    msg->addColumn(authorText,
                    ColumnFormat(NAME_COL_WIDTH, ColumnFormat::FixedSize, ColumnFormat::Right));
     msg->addColumn(new ChatLineContentProxy(new FileTransferWidget(nullptr, coreFile, file, settings,
                                                                    style, messageBoxManager),
                                             320, 0.6f),
                    ColumnFormat(1.0, ColumnFormat::VariableSize));
-    msg->addColumn(new Timestamp(date, settings.getTimestampFormat(), baseFont, documentCache,
+    msg->addColumn(new Timestamp(date, chatSettings->timestampFormat, baseFont, documentCache,
                                  settings, style),
                    ColumnFormat(TIME_COL_WIDTH, ColumnFormat::FixedSize, ColumnFormat::Right));
 
@@ -237,11 +268,11 @@ ChatMessage::Ptr ChatMessage::createBusyNotification(DocumentCache& documentCach
 
 void ChatMessage::markAsDelivered(const QDateTime& time)
 {
-    QFont baseFont = settings.getChatMessageFont();
+    const auto chatSettings = settings.getChatViewSnapshot();
 
     // remove the spinner and replace it by $time
-    replaceContent(2, new Timestamp(time, settings.getTimestampFormat(), baseFont, documentCache,
-                                    settings, style));
+    replaceContent(2, new Timestamp(time, chatSettings->timestampFormat,
+                                    chatSettings->chatMessageFont, documentCache, settings, style));
 }
 
 void ChatMessage::markAsBroken()
@@ -284,6 +315,11 @@ void ChatMessage::hideDate()
 
 QString ChatMessage::detectQuotes(const QString& str, MessageType type)
 {
+    // Compiled once; building a QRegularExpression per line made quote
+    // detection the most expensive part of formatting long messages
+    static const QRegularExpression quoteRegex{
+        QRegularExpression::anchoredPattern(QStringLiteral("^(&gt;|＞).*"))};
+
     // detect text quotes
     QStringList messageLines = str.split("\n");
     QString quotedText;
@@ -291,9 +327,7 @@ QString ChatMessage::detectQuotes(const QString& str, MessageType type)
         // don't quote first line in action message. This makes co-existence of
         // quotes and action messages possible, since only first line can cause
         // problems in case where there is quote in it used.
-        if (QRegularExpression(QRegularExpression::anchoredPattern("^(&gt;|＞).*"))
-                .match(messageLines[i])
-                .hasMatch()) {
+        if (quoteRegex.match(messageLines[i]).hasMatch()) {
             if (i > 0 || type != ACTION)
                 quotedText += "<span class=quote>" + messageLines[i] + " </span>";
             else
@@ -9,21 +9,31 @@
 #include "chatmessage.h"
 #include "content/filetransferwidget.h"
 #include "content/text.h"
+#include "documentcache.h"
+#include "src/allocationtracker.h"
 #include "src/chatlog/chatlinestorage.h"
 #include "src/core/core.h"
+#include "src/model/sendlatencymetrics.h"
 #include "src/persistence/settings.h"
+#include "src/widget/framegovernor.h"
 #include "src/widget/style.h"
 #include "src/widget/translator.h"
+#include "util/perfzone.h"
+#include "src/workerpool.h"
 #include <iostream>
 
 #include <QAction>
 #include <QApplication>
 #include <QClipboard>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QMouseEvent>
+#include <QPainter>
 #include <QScrollBar>
+#include <QSet>
 #include <QShortcut>
 #include <QTimer>
+#include <QtConcurrent/QtConcurrentMap>
 
 #include <algorithm>
 #include <cassert>
@@ -37,6 +47,17 @@ int constexpr maxWindowSize = 300;
 // Amount of messages to purge when removing messages
 int constexpr windowChunkSize = 100;
 
+// Scene-trimmer tuning: once scrolling has been idle for sceneTrimDelayMs,
+// lines further than sceneTrimKeepViewports viewport heights from the visible
+// rect are taken out of the scene (their cached geometry survives, so
+// scrolling math is unaffected); they re-enter the scene once they come
+// within sceneRehydrateViewports of the viewport. Demotion is batched so a
+// single tick never stalls the GUI thread on scene re-indexing.
+qreal constexpr sceneTrimKeepViewports = 2.0;
+qreal constexpr sceneRehydrateViewports = 1.0;
+int constexpr sceneTrimDelayMs = 2000;
+int constexpr sceneTrimBatchSize = 100;
+
 template <class T>
 T clamp(T x, T min, T max)
 {
@@ -51,7 +72,7 @@ ChatMessage::Ptr createDateMessage(QDateTime timestamp, DocumentCache& documentC
                                    Settings& settings, Style& style)
 {
     const auto date = timestamp.date();
-    auto dateText = date.toString(settings.getDateFormat());
+    auto dateText = date.toString(settings.getChatViewSnapshot()->dateFormat);
     return ChatMessage::createChatInfoMessage(dateText, ChatMessage::INFO, QDateTime(),
                                               documentCache, settings, style);
 }
@@ -228,10 +249,6 @@ ChatWidget::ChatWidget(IChatLog& chatLog_, const Core& core_, DocumentCache& doc
     setContextMenuPolicy(Qt::CustomContextMenu);
     setBackgroundBrush(QBrush(style.getColor(Style::ColorPalette::GroundBase), Qt::SolidPattern));
 
-    // The selection rect for multi-line selection
-    selGraphItem = scene->addRect(0, 0, 0, 0, selectionRectColor.darker(120), selectionRectColor);
-    selGraphItem->setZValue(-1.0); // behind all other items
-
     // copy action (ie. Ctrl+C)
     copyAction = new QAction(this);
     copyAction->setIcon(QIcon::fromTheme("edit-copy"));
@@ -266,12 +283,29 @@ ChatWidget::ChatWidget(IChatLog& chatLog_, const Core& core_, DocumentCache& doc
     workerTimer->setInterval(5);
     connect(workerTimer, &QTimer::timeout, this, &ChatWidget::onWorkerTimeout);
 
+    // Trims far-offscreen lines out of the scene once scrolling settles
+    sceneTrimTimer = new QTimer(this);
+    sceneTrimTimer->setSingleShot(true);
+    sceneTrimTimer->setInterval(sceneTrimDelayMs);
+    connect(sceneTrimTimer, &QTimer::timeout, this, &ChatWidget::onSceneTrimTimeout);
+
+    // Finishing a relayout can wait until someone can actually see the result
+    connect(&FrameGovernor::getInstance(), &FrameGovernor::appVisibleChanged, this,
+            &ChatWidget::onAppVisibleChanged);
+
     // This timer is used to detect multiple clicks
     multiClickTimer = new QTimer(this);
     multiClickTimer->setSingleShot(true);
     multiClickTimer->setInterval(QApplication::doubleClickInterval());
     connect(multiClickTimer, &QTimer::timeout, this, &ChatWidget::onMultiClickTimeout);
 
+    // Coalesces bursts of itemUpdated notifications (e.g. a conference
+    // backlog on join) into one render pass per event loop turn
+    updateFlushTimer = new QTimer(this);
+    updateFlushTimer->setSingleShot(true);
+    updateFlushTimer->setInterval(0);
+    connect(updateFlushTimer, &QTimer::timeout, this, &ChatWidget::flushMessageUpdates);
+
     // selection
     connect(this, &ChatWidget::selectionChanged, this, [this]() {
         copyAction->setEnabled(hasTextToBeCopied());
@@ -312,8 +346,12 @@ void ChatWidget::clearSelection()
     if (selectionMode == SelectionMode::None)
         return;
 
-    forEachLineIn(selFirstRow, selLastRow, *chatLineStorage,
-                  [&](ChatLine::Ptr& line) { line->selectionCleared(); });
+    // Only the clicked row ever materializes per-content selection state
+    // (selectionStarted/selectionMouseMove and friends all target it); the
+    // multi-selection highlight is just the overlay rect. Clearing only that
+    // row keeps select-all and its teardown independent of the chat size.
+    if (selClickedRow)
+        selClickedRow->selectionCleared();
 
     selFirstRow.reset();
     selLastRow.reset();
@@ -338,6 +376,9 @@ void ChatWidget::updateSceneRect()
 
 void ChatWidget::layout(int start, int end, qreal width)
 {
+    PERF_ZONE(chatwidget_layout);
+    AllocationTracker::Scope allocScope{AllocationTracker::Subsystem::ChatRender};
+
     if (chatLineStorage->empty())
         return;
 
@@ -359,6 +400,65 @@ void ChatWidget::layout(int start, int end, qreal width)
     }
 }
 
+/**
+ * @brief Fans a batch's QTextDocument layouts out across the thread pool.
+ *
+ * Opening a chat lays out hundreds of lines serially through
+ * Text::regenerate on the GUI thread; this pre-computes those layouts on
+ * QThreadPool workers and parks the finished documents in the DocumentCache,
+ * so the serial layout pass that follows gets cache hits and the chat-open
+ * render time scales down with the core count. Texts that pull in image
+ * resources (smileys) are skipped and lay out serially as before, since
+ * pixmap creation is GUI-thread only.
+ */
+void ChatWidget::warmUpTextLayouts(const std::map<ChatLogIdx, ChatLine::Ptr>& chatLines, qreal width)
+{
+    struct Job
+    {
+        Text* text;
+        QTextDocument* doc;
+        qreal width;
+        QByteArray key;
+    };
+
+    std::vector<Job> jobs;
+    for (const auto& chatLine : chatLines) {
+        const auto& l = chatLine.second;
+        const QVector<qreal> widths = l->columnWidths(width);
+        for (int col = 0; col < l->getColumnCount(); ++col) {
+            auto* textContent = dynamic_cast<Text*>(l->getContent(col));
+            if (!textContent || !textContent->supportsBackgroundLayout())
+                continue;
+
+            // ChatLineContent::setWidth takes a float, so replicate its
+            // narrowing here or the cache key won't match regenerate()'s
+            const qreal colWidth = static_cast<qreal>(static_cast<float>(widths[col]));
+            QByteArray key = textContent->backgroundLayoutKey(colWidth);
+            if (documentCache.containsLaidOut(key))
+                continue;
+
+            jobs.push_back(Job{textContent, nullptr, colWidth, std::move(key)});
+        }
+    }
+
+    // Small batches (single incoming messages) aren't worth the pool
+    // round-trip; they stay on the serial path.
+    constexpr size_t minJobsForWarmUp = 16;
+    if (jobs.size() < minJobsForWarmUp)
+        return;
+
+    // Documents are created and later adopted on the GUI thread; workers only
+    // touch them while they're unparented and unshared.
+    for (Job& job : jobs)
+        job.doc = documentCache.pop();
+
+    QtConcurrent::blockingMap(&WorkerPool::instance().interactive(), jobs,
+                              [](Job& job) { job.text->backgroundLayout(*job.doc, job.width); });
+
+    for (Job& job : jobs)
+        documentCache.pushLaidOut(job.key, job.doc);
+}
+
 void ChatWidget::mousePressEvent(QMouseEvent* ev)
 {
     QGraphicsView::mousePressEvent(ev);
@@ -445,7 +545,6 @@ void ChatWidget::mouseMoveEvent(QMouseEvent* ev)
                     selectionMode = SelectionMode::Precise;
 
                     content->selectionMouseMove(scenePos);
-                    selGraphItem->hide();
                 } else if (col != selClickedCol) {
                     selectionMode = SelectionMode::Multi;
 
@@ -499,7 +598,7 @@ bool ChatWidget::isOverSelection(QPointF scenePos) const
         if (content)
             return content->isOverSelection(scenePos);
     } else if (selectionMode == SelectionMode::Multi) {
-        if (selGraphItem->rect().contains(scenePos))
+        if (multiSelectionRect.contains(scenePos))
             return true;
     }
 
@@ -546,10 +645,16 @@ void ChatWidget::insertChatlines(std::map<ChatLogIdx, ChatLine::Ptr> chatLines)
         // rendering. This will be changed when we call updateVisibility
         // later
         l->visibilityChanged(false);
+
+        SendLatencyMetrics::recordRendered(idx);
     }
 
     scene->setItemIndexMethod(oldIndexMeth);
 
+    // Lay the batch's text documents out across the thread pool before the
+    // serial layout pass; regenerate() then pulls them from the document cache
+    warmUpTextLayouts(chatLines, useableWidth());
+
     // If all insertions are at the bottom we can get away with only rendering
     // the updated lines, otherwise we need to go through the resize workflow to
     // re-layout everything asynchronously.
@@ -577,6 +682,58 @@ void ChatWidget::insertChatlines(std::map<ChatLogIdx, ChatLine::Ptr> chatLines)
     }
 }
 
+/**
+ * @brief Suspends per-mutation relayout until the matching thawSceneUpdates().
+ *
+ * Bulk mutations like a rendered-window shift remove one span of lines and
+ * insert another, and each step used to run its own full layout pass. Between
+ * freeze and thaw those passes are deferred; the final thaw performs a single
+ * layout and scene update over the combined result. Freezes nest, only the
+ * outermost thaw flushes.
+ */
+void ChatWidget::freezeSceneUpdates()
+{
+    if (++sceneUpdateFreezeDepth == 1) {
+        frozenLayoutPending = false;
+    }
+}
+
+void ChatWidget::thawSceneUpdates()
+{
+    assert(sceneUpdateFreezeDepth > 0);
+    if (--sceneUpdateFreezeDepth > 0 || !frozenLayoutPending) {
+        return;
+    }
+    frozenLayoutPending = false;
+
+    if (workerTimer->isActive()) {
+        // The batch kicked off the resize worker, which re-lays out the whole
+        // storage and restores the scroll position itself
+        return;
+    }
+
+    // Deferred removals leave the retained lines at stale positions, so
+    // normalize everything in one pass. Anchor the viewport across the
+    // relayout the same way the resize worker does
+    const bool stb = stickToBottom();
+    ChatLine::Ptr anchorLine;
+    if (!stb && !visibleLines.empty()) {
+        anchorLine = visibleLines.first();
+    }
+
+    layout(0, chatLineStorage->size(), useableWidth());
+    updateSceneRect();
+
+    if (stb) {
+        scrollToBottom();
+    } else if (anchorLine) {
+        scrollToLine(anchorLine);
+    }
+
+    checkVisibility();
+    updateMultiSelectionRect();
+}
+
 bool ChatWidget::stickToBottom() const
 {
     return verticalScrollBar()->value() == verticalScrollBar()->maximum();
@@ -656,22 +813,44 @@ QString ChatWidget::getSelectedText() const
         return selClickedRow->content[selClickedCol]->getSelectedText();
     } else if (selectionMode == SelectionMode::Multi) {
         // build a nicely formatted message
-        QString out;
-
+        struct Row
+        {
+            QString timestamp;
+            QString author;
+            QString msg;
+        };
+
+        // Gather the parts first so the output buffer can be sized up front;
+        // copying a select-all then costs one allocation instead of
+        // reallocating as the string grows
+        QVector<Row> rows;
+        qsizetype outSize = 0;
         forEachLineIn(selFirstRow, selLastRow, *chatLineStorage, [&](ChatLine::Ptr& line) {
             if (line->content[1]->getText().isEmpty())
                 return;
 
-            QString timestamp =
-                line->content[2]->getText().isEmpty() ? tr("pending") : line->content[2]->getText();
-            QString author = line->content[0]->getText();
-            QString msg = line->content[1]->getText();
+            Row row{line->content[2]->getText().isEmpty() ? tr("pending")
+                                                          : line->content[2]->getText(),
+                    line->content[0]->getText(), line->content[1]->getText()};
 
-            out += QString(out.isEmpty() ? QStringLiteral("[%2] %1: %3")
-                                         : QStringLiteral("\n[%2] %1: %3"))
-                       .arg(author, timestamp, msg);
+            // "\n[" + timestamp + "] " + author + ": " + msg
+            outSize += row.timestamp.size() + row.author.size() + row.msg.size() + 6;
+            rows.append(std::move(row));
         });
 
+        QString out;
+        out.reserve(outSize);
+        for (const Row& row : rows) {
+            if (!out.isEmpty())
+                out += QLatin1Char('\n');
+            out += QLatin1Char('[');
+            out += row.timestamp;
+            out += QLatin1String("] ");
+            out += row.author;
+            out += QLatin1String(": ");
+            out += row.msg;
+        }
+
         return out;
     }
 
@@ -715,8 +894,12 @@ void ChatWidget::clear()
 
     visibleLines.clear();
 
-    checkVisibility();
-    updateSceneRect();
+    if (sceneUpdateFreezeDepth > 0) {
+        frozenLayoutPending = true;
+    } else {
+        checkVisibility();
+        updateSceneRect();
+    }
 }
 
 void ChatWidget::copySelectedText(bool toSelectionBuffer) const
@@ -745,6 +928,8 @@ void ChatWidget::setTypingNotificationName(const QString& displayName)
     Text* text = static_cast<Text*>(typingNotification->getContent(1));
     QString typingDiv = "<div class=typing>%1</div>";
     text->setText(typingDiv.arg(tr("%1 is typing").arg(displayName)));
+    // setText changes geometry without going through replaceContent
+    typingNotification->invalidateLayout();
 
     updateTypingNotification();
 }
@@ -782,11 +967,10 @@ void ChatWidget::fontChanged(const QFont& font)
 
 void ChatWidget::reloadTheme()
 {
-    setStyleSheet(style.getStylesheet("chatArea/chatArea.qss", settings));
+    style.setStylesheet(this, "chatArea/chatArea.qss", settings);
     setBackgroundBrush(QBrush(style.getColor(Style::ColorPalette::GroundBase), Qt::SolidPattern));
     selectionRectColor = style.getColor(Style::ColorPalette::SelectText);
-    selGraphItem->setBrush(QBrush(selectionRectColor));
-    selGraphItem->setPen(QPen(selectionRectColor.darker(120)));
+    scene->invalidate(multiSelectionRect, QGraphicsScene::BackgroundLayer);
     setTypingNotification();
 
     for (ChatLine::Ptr l : *chatLineStorage) {
@@ -836,14 +1020,54 @@ void ChatWidget::startSearch(const QString& phrase, const ParameterSearch& param
 
 void ChatWidget::onSearchUp(const QString& phrase, const ParameterSearch& parameter)
 {
-    auto result = chatLog.searchBackward(searchPos, phrase, parameter);
-    handleSearchResult(result, SearchDirection::Up);
+    beginIncrementalSearch(phrase, parameter, SearchDirection::Up);
 }
 
 void ChatWidget::onSearchDown(const QString& phrase, const ParameterSearch& parameter)
 {
-    auto result = chatLog.searchForward(searchPos, phrase, parameter);
-    handleSearchResult(result, SearchDirection::Down);
+    beginIncrementalSearch(phrase, parameter, SearchDirection::Down);
+}
+
+/**
+ * @brief Kicks off a time-sliced search so scanning a huge log doesn't freeze
+ * the UI. The scan runs in bounded chunks on the event loop; a newer search or
+ * removeSearchPhrase invalidates any chunks still queued.
+ */
+void ChatWidget::beginIncrementalSearch(const QString& phrase, const ParameterSearch& parameter,
+                                        SearchDirection direction)
+{
+    ++searchGeneration;
+    activeSearch.phrase = phrase;
+    activeSearch.parameter = parameter;
+    activeSearch.direction = direction;
+    activeSearch.pos = searchPos;
+    stepActiveSearch();
+}
+
+void ChatWidget::stepActiveSearch()
+{
+    // Keep each chunk small enough that a step stays well under a frame
+    constexpr size_t searchChunkSize = 500;
+
+    const auto result =
+        activeSearch.direction == SearchDirection::Up
+            ? chatLog.searchBackwardChunked(activeSearch.pos, activeSearch.phrase,
+                                            activeSearch.parameter, searchChunkSize)
+            : chatLog.searchForwardChunked(activeSearch.pos, activeSearch.phrase,
+                                           activeSearch.parameter, searchChunkSize);
+
+    if (!result.found && !result.completed) {
+        activeSearch.pos = result.pos;
+        const auto generation = searchGeneration;
+        QTimer::singleShot(0, this, [this, generation] {
+            if (generation == searchGeneration) {
+                stepActiveSearch();
+            }
+        });
+        return;
+    }
+
+    handleSearchResult(result, activeSearch.direction);
 }
 
 void ChatWidget::handleSearchResult(SearchResult result, SearchDirection direction)
@@ -892,6 +1116,24 @@ void ChatWidget::checkVisibility()
     if (chatLineStorage->empty())
         return;
 
+    // Put demoted lines near the viewport back into the scene before the
+    // visible set is computed, so they are paintable by the time they scroll
+    // in. The rehydrate margin is smaller than the trimmer's keep margin,
+    // which keeps the two from fighting over the same lines.
+    const qreal rehydrateMargin = getVisibleRect().height() * sceneRehydrateViewports;
+    const auto rehydrateBegin =
+        std::lower_bound(chatLineStorage->begin(), chatLineStorage->end(),
+                         getVisibleRect().top() - rehydrateMargin, ChatLine::lessThanBSRectBottom);
+    const auto rehydrateEnd =
+        std::lower_bound(rehydrateBegin, chatLineStorage->end(),
+                         getVisibleRect().bottom() + rehydrateMargin, ChatLine::lessThanBSRectTop);
+    for (auto it = rehydrateBegin; it != rehydrateEnd; ++it) {
+        if (!(*it)->isInScene())
+            (*it)->addToScene(scene);
+    }
+
+    sceneTrimTimer->start(sceneTrimDelayMs);
+
     // find first visible line
     auto lowerBound = std::lower_bound(chatLineStorage->begin(), chatLineStorage->end(),
                                        getVisibleRect().top(), ChatLine::lessThanBSRectBottom);
@@ -903,22 +1145,50 @@ void ChatWidget::checkVisibility()
     const ChatLine::Ptr lastLineBeforeVisible =
         lowerBound == chatLineStorage->begin() ? ChatLine::Ptr() : *std::prev(lowerBound);
 
-    // set visibility
-    QList<ChatLine::Ptr> newVisibleLines;
-    for (auto itr = lowerBound; itr != upperBound; ++itr) {
-        newVisibleLines.append(*itr);
+    const auto newFirstRow = static_cast<size_t>(std::distance(chatLineStorage->begin(), lowerBound));
+    const auto newEndRow = static_cast<size_t>(std::distance(chatLineStorage->begin(), upperBound));
+
+    if (chatLineStorage->revision() == visibleRowRevision) {
+        // The visible set is a contiguous row range, so a scroll tick only
+        // changes the lines that crossed a viewport edge; flip exactly those
+        // instead of diffing the whole visible set
+        if (newFirstRow != visibleFirstRow || newEndRow != visibleEndRow
+            || static_cast<size_t>(visibleLines.size()) != newEndRow - newFirstRow) {
+            for (size_t i = visibleFirstRow; i < visibleEndRow; ++i) {
+                if (i < newFirstRow || i >= newEndRow)
+                    (*chatLineStorage)[i]->visibilityChanged(false);
+            }
+            for (size_t i = newFirstRow; i < newEndRow; ++i) {
+                if (i < visibleFirstRow || i >= visibleEndRow)
+                    (*chatLineStorage)[i]->visibilityChanged(true);
+            }
+            visibleLines = QList<ChatLine::Ptr>(lowerBound, upperBound);
+        }
+    } else {
+        // Lines were inserted or removed since the last pass; the cached row
+        // range no longer names the same lines, diff by identity instead
+        QSet<const ChatLine*> wasVisible;
+        wasVisible.reserve(visibleLines.size());
+        for (const ChatLine::Ptr& line : visibleLines)
+            wasVisible.insert(line.get());
+
+        for (auto itr = lowerBound; itr != upperBound; ++itr) {
+            if (!wasVisible.remove(itr->get()))
+                (*itr)->visibilityChanged(true);
+        }
 
-        if (!visibleLines.contains(*itr))
-            (*itr)->visibilityChanged(true);
+        // these lines are no longer visible
+        for (const ChatLine::Ptr& line : visibleLines) {
+            if (wasVisible.contains(line.get()))
+                line->visibilityChanged(false);
+        }
 
-        visibleLines.removeOne(*itr);
+        visibleLines = QList<ChatLine::Ptr>(lowerBound, upperBound);
     }
 
-    // these lines are no longer visible
-    for (ChatLine::Ptr line : visibleLines)
-        line->visibilityChanged(false);
-
-    visibleLines = newVisibleLines;
+    visibleFirstRow = newFirstRow;
+    visibleEndRow = newEndRow;
+    visibleRowRevision = chatLineStorage->revision();
 
     if (!visibleLines.isEmpty()) {
         emit firstVisibleLineChanged(lastLineBeforeVisible, visibleLines.at(0));
@@ -950,18 +1220,38 @@ void ChatWidget::resizeEvent(QResizeEvent* ev)
 
 void ChatWidget::updateMultiSelectionRect()
 {
+    QRectF selBBox;
     if (selectionMode == SelectionMode::Multi && selFirstRow && selLastRow) {
-        QRectF selBBox;
         selBBox = selBBox.united(selFirstRow->sceneBoundingRect());
         selBBox = selBBox.united(selLastRow->sceneBoundingRect());
+    }
 
-        if (selGraphItem->rect() != selBBox)
-            scene->invalidate(selGraphItem->rect());
+    if (selBBox != multiSelectionRect) {
+        // The highlight lives in the background pass, so growing or shrinking
+        // it is a pure repaint of the affected region; no scene item changes
+        scene->invalidate(multiSelectionRect.united(selBBox), QGraphicsScene::BackgroundLayer);
+        multiSelectionRect = selBBox;
+    }
+}
 
-        selGraphItem->setRect(selBBox);
-        selGraphItem->show();
-    } else {
-        selGraphItem->hide();
+/**
+ * @brief Paints the multi-line selection highlight under the chat content.
+ *
+ * The highlight used to be a zValue -1 scene rect that was resized on every
+ * drag tick, which meant BSP tree updates and item invalidation while
+ * selecting across thousands of lines. Drawing it as part of the background
+ * pass keeps the stacking order (behind the text) and makes drag-selection a
+ * repaint-only operation.
+ */
+void ChatWidget::drawBackground(QPainter* painter, const QRectF& rect)
+{
+    QGraphicsView::drawBackground(painter, rect);
+
+    if (selectionMode == SelectionMode::Multi && multiSelectionRect.intersects(rect)) {
+        const QColor fill = hasFocus() ? selectionRectColor : selectionRectColor.lighter(120);
+        painter->setPen(QPen(selectionRectColor.darker(120)));
+        painter->setBrush(fill);
+        painter->drawRect(multiSelectionRect);
     }
 }
 
@@ -1018,7 +1308,12 @@ void ChatWidget::removeLines(ChatLogIdx begin, ChatLogIdx end)
     // probably be smarter and try to only re-render anything under what we
     // removed, but with the sliding window there doesn't seem to be much need
     if (chatLineStorage->hasIndexedMessage() && begin <= chatLineStorage->lastIdx()) {
-        layout(0, chatLineStorage->size(), useableWidth());
+        if (sceneUpdateFreezeDepth > 0) {
+            // A batch is in flight; the thaw at its end runs one combined pass
+            frozenLayoutPending = true;
+        } else {
+            layout(0, chatLineStorage->size(), useableWidth());
+        }
     }
 }
 
@@ -1052,12 +1347,18 @@ void ChatWidget::onSelectionTimerTimeout()
 
 void ChatWidget::onWorkerTimeout()
 {
-    // Fairly arbitrary but
-    // large values will make the UI unresponsive
-    const int stepSize = 50;
+    // Lay out lines until we've used up roughly half a frame, so cheap
+    // translations get batched together while heavy text relayouts still
+    // yield back to the event loop quickly enough to keep the UI responsive
+    constexpr qint64 frameBudgetMs = 8;
+    constexpr int stepSize = 50;
 
-    layout(workerLastIndex, workerLastIndex + stepSize, useableWidth());
-    workerLastIndex += stepSize;
+    QElapsedTimer budget;
+    budget.start();
+    do {
+        layout(workerLastIndex, workerLastIndex + stepSize, useableWidth());
+        workerLastIndex += stepSize;
+    } while (workerLastIndex < chatLineStorage->size() && budget.elapsed() < frameBudgetMs);
 
     // done?
     if (workerLastIndex >= chatLineStorage->size()) {
@@ -1088,6 +1389,60 @@ void ChatWidget::onWorkerTimeout()
     }
 }
 
+/**
+ * @brief Demotes far-offscreen lines to size-only placeholders.
+ *
+ * A rendered line keeps three QGraphicsItems in the scene although at most a
+ * couple of dozen lines are ever visible; every scene event still walks the
+ * full item index. Once scrolling has settled, lines outside the keep margin
+ * are taken out of the scene. Their ChatLine survives with its cached bbox
+ * and layout, so the scroll geometry and the line storage are untouched, and
+ * checkVisibility() puts them back before they reach the viewport.
+ */
+void ChatWidget::onSceneTrimTimeout()
+{
+    if (chatLineStorage->empty())
+        return;
+
+    const qreal keepMargin = getVisibleRect().height() * sceneTrimKeepViewports;
+    const auto keepBegin =
+        std::lower_bound(chatLineStorage->begin(), chatLineStorage->end(),
+                         getVisibleRect().top() - keepMargin, ChatLine::lessThanBSRectBottom);
+    const auto keepEnd =
+        std::lower_bound(keepBegin, chatLineStorage->end(),
+                         getVisibleRect().bottom() + keepMargin, ChatLine::lessThanBSRectTop);
+
+    int demoted = 0;
+    const auto demoteRange = [&demoted](auto begin, auto end) {
+        for (auto it = begin; it != end && demoted < sceneTrimBatchSize; ++it) {
+            if ((*it)->isInScene()) {
+                (*it)->removeFromScene();
+                ++demoted;
+            }
+        }
+    };
+    demoteRange(chatLineStorage->begin(), keepBegin);
+    demoteRange(keepEnd, chatLineStorage->end());
+
+    // A full batch means there is probably more to trim; continue on the next
+    // event loop pass instead of holding this one
+    if (demoted == sceneTrimBatchSize)
+        sceneTrimTimer->start(0);
+}
+
+void ChatWidget::onAppVisibleChanged(bool visible)
+{
+    // Suspend a running relayout while no window is on screen; it picks up
+    // where it left off once something becomes visible again
+    if (!visible && workerTimer->isActive()) {
+        workerTimer->stop();
+        workerPaused = true;
+    } else if (visible && workerPaused) {
+        workerPaused = false;
+        workerTimer->start();
+    }
+}
+
 void ChatWidget::onMultiClickTimeout()
 {
     clickCount = 0;
@@ -1095,25 +1450,59 @@ void ChatWidget::onMultiClickTimeout()
 
 void ChatWidget::onMessageUpdated(ChatLogIdx idx)
 {
-    if (shouldRenderMessage(idx)) {
-        renderMessage(idx);
-    }
+    pendingMessageUpdates.insert(idx);
+    updateFlushTimer->start();
 }
 
-void ChatWidget::renderMessage(ChatLogIdx idx)
+/**
+ * @brief Renders all queued item updates in contiguous spans.
+ *
+ * Each span goes through renderMessages() as one insertChatlines() call and
+ * one layout pass, so a burst of N backlog messages costs one relayout
+ * instead of N.
+ */
+void ChatWidget::flushMessageUpdates()
 {
-    renderMessages(idx, idx + 1);
+    if (pendingMessageUpdates.empty()) {
+        return;
+    }
+
+    const auto pending = std::move(pendingMessageUpdates);
+    pendingMessageUpdates = {};
+
+    auto spanBegin = *pending.begin();
+    auto prev = spanBegin;
+    for (auto it = std::next(pending.begin()); it != pending.end(); ++it) {
+        if (*it != prev + 1) {
+            if (shouldRenderSpan(spanBegin, prev + 1)) {
+                renderMessages(spanBegin, prev + 1);
+            }
+            spanBegin = *it;
+        }
+        prev = *it;
+    }
+
+    if (shouldRenderSpan(spanBegin, prev + 1)) {
+        renderMessages(spanBegin, prev + 1);
+    }
 }
 
 void ChatWidget::renderMessages(ChatLogIdx begin, ChatLogIdx end)
 {
+    AllocationTracker::Scope allocScope{AllocationTracker::Subsystem::ChatRender};
+
     auto linesToRender = std::map<ChatLogIdx, ChatLine::Ptr>();
 
     for (auto i = begin; i < end; ++i) {
         bool alreadyRendered = chatLineStorage->contains(i);
         bool prevIdxRendered = i != begin || chatLineStorage->contains(i - 1);
 
-        auto chatMessage = alreadyRendered ? (*chatLineStorage)[i] : ChatLine::Ptr();
+        // Prefer a previously evicted line over constructing a new one. The
+        // render functions treat a recycled line like an already rendered one
+        // and only refresh its mutable state (delivery marks, transfer
+        // progress)
+        auto chatMessage =
+            alreadyRendered ? (*chatLineStorage)[i] : chatLineStorage->takeRecycledLine(i);
         renderItem(chatLog.at(i), needsToHideName(i, prevIdxRendered), colorizeNames, chatMessage);
 
         if (!alreadyRendered) {
@@ -1151,6 +1540,11 @@ void ChatWidget::setRenderedWindowStart(ChatLogIdx begin)
     // the selXXXRow members will now be pointing to the wrong ChatLine::Ptr!
     // Please be sure to test selection logic when scrolling around loading
     // boundaries if changing this logic.
+    //
+    // The removal and insertion are one logical mutation; without the freeze
+    // the removal runs a full relayout that the render pass immediately
+    // repeats over the same lines
+    freezeSceneUpdates();
     if (begin < currentEnd && begin > currentStart) {
         // Remove leading lines
         removeLines(currentStart, begin);
@@ -1163,6 +1557,7 @@ void ChatWidget::setRenderedWindowStart(ChatLogIdx begin)
         removeLines(currentStart, currentEnd);
         renderMessages(begin, end);
     }
+    thawSceneUpdates();
 }
 
 void ChatWidget::setRenderedWindowEnd(ChatLogIdx end)
@@ -1217,6 +1612,8 @@ void ChatWidget::onScrollValueChanged(int value)
         return;
     }
 
+    prefetchScrollback(value);
+
     if (value == verticalScrollBar()->minimum()) {
         auto idx =
             clampedAdd(chatLineStorage->firstIdx(), -static_cast<int>(windowChunkSize), chatLog);
@@ -1258,6 +1655,56 @@ void ChatWidget::onScrollValueChanged(int value)
     }
 }
 
+/**
+ * @brief Stages the next scrollback chunk into the chat log ahead of need.
+ *
+ * More history is normally loaded only once the scrollbar hits its minimum, so
+ * fast upward scrolling stalls at every window boundary while the database
+ * round-trip completes. Watching the scroll velocity lets us pull the next
+ * chunk while the user is still short of the edge: the load is deferred to the
+ * event loop so the current scroll tick stays smooth, and by the time the
+ * rendered window shifts the messages are already cached in the chat log.
+ */
+void ChatWidget::prefetchScrollback(int scrollValue)
+{
+    const int delta = scrollValue - lastScrollValue;
+    const qint64 elapsedMs = scrollVelocityTimer.isValid() ? scrollVelocityTimer.restart() : -1;
+    if (elapsedMs < 0) {
+        scrollVelocityTimer.start();
+    }
+    lastScrollValue = scrollValue;
+
+    if (delta >= 0 || elapsedMs <= 0) {
+        // Not moving towards older history. Newer messages never need a
+        // database load since history only ever precedes the session cache
+        return;
+    }
+
+    // Only prefetch once the edge is within reach at the current velocity
+    const qint64 prefetchLeadMs = settings.getScrollbackPrefetchLeadMs();
+    const qreal velocity = static_cast<qreal>(-delta) / elapsedMs;
+    const int distanceToTop = scrollValue - verticalScrollBar()->minimum();
+    if (velocity * prefetchLeadMs < distanceToTop) {
+        return;
+    }
+
+    const auto idx =
+        clampedAdd(chatLineStorage->firstIdx(), -static_cast<int>(windowChunkSize), chatLog);
+    if (idx == chatLineStorage->firstIdx() || idx == prefetchedWindowStart) {
+        return;
+    }
+    prefetchedWindowStart = idx;
+
+    QMetaObject::invokeMethod(
+        this,
+        [this, idx] {
+            // at() faults the chunk from the database into the chat log's
+            // session cache; the eventual window shift then renders from RAM
+            std::ignore = chatLog.at(idx);
+        },
+        Qt::QueuedConnection);
+}
+
 void ChatWidget::handleMultiClickEvent()
 {
     // Ignore single or double clicks
@@ -1315,7 +1762,8 @@ void ChatWidget::focusInEvent(QFocusEvent* ev)
     QGraphicsView::focusInEvent(ev);
 
     if (selectionMode != SelectionMode::None) {
-        selGraphItem->setBrush(QBrush(selectionRectColor));
+        // The background-pass highlight picks its brush from hasFocus()
+        scene->invalidate(multiSelectionRect, QGraphicsScene::BackgroundLayer);
 
         auto endIt = chatLineStorage->find(selLastRow);
         // Increase by one since this selLastRow is inclusive, not exclusive
@@ -1334,7 +1782,7 @@ void ChatWidget::focusOutEvent(QFocusEvent* ev)
     QGraphicsView::focusOutEvent(ev);
 
     if (selectionMode != SelectionMode::None) {
-        selGraphItem->setBrush(QBrush(selectionRectColor.lighter(120)));
+        scene->invalidate(multiSelectionRect, QGraphicsScene::BackgroundLayer);
 
         auto endIt = chatLineStorage->find(selLastRow);
         // Increase by one since this selLastRow is inclusive, not exclusive
@@ -1474,11 +1922,23 @@ bool ChatWidget::needsToHideName(ChatLogIdx idx, bool prevIdxRendered) const
     return currentItem.getSender() == prevItem.getSender() && messagesTimeDiff < repNameAfter;
 }
 
-bool ChatWidget::shouldRenderMessage(ChatLogIdx idx) const
+bool ChatWidget::shouldRenderSpan(ChatLogIdx begin, ChatLogIdx end) const
 {
-    return chatLineStorage->contains(idx)
-           || (chatLineStorage->contains(idx - 1) && idx + 1 == chatLog.getNextIdx())
-           || chatLineStorage->empty();
+    if (chatLineStorage->empty()) {
+        return true;
+    }
+
+    // Updates to already rendered messages always re-render
+    for (auto i = begin; i < end; ++i) {
+        if (chatLineStorage->contains(i)) {
+            return true;
+        }
+    }
+
+    // A span of new messages only renders if it extends the rendered tail to
+    // the end of the log, the span generalization of the old single-message
+    // append rule
+    return chatLineStorage->contains(begin - 1) && end == chatLog.getNextIdx();
 }
 
 void ChatWidget::disableSearchText()
@@ -1494,6 +1954,8 @@ void ChatWidget::disableSearchText()
 
 void ChatWidget::removeSearchPhrase()
 {
+    // Invalidate any queued search chunks
+    ++searchGeneration;
     disableSearchText();
 }
 
@@ -6,9 +6,12 @@
 #pragma once
 
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QGraphicsView>
 #include <QMargins>
 
+#include <set>
+
 #include "chatline.h"
 #include "chatmessage.h"
 #include "src/model/ichatlog.h"
@@ -44,6 +47,8 @@ public:
     void scrollToLine(ChatLine::Ptr line);
     void selectAll();
     void fontChanged(const QFont& font);
+    void freezeSceneUpdates();
+    void thawSceneUpdates();
 
     QString getSelectedText() const;
 
@@ -78,10 +83,12 @@ public slots:
 private slots:
     void onSelectionTimerTimeout();
     void onWorkerTimeout();
+    void onSceneTrimTimeout();
     void onMultiClickTimeout();
+    void onAppVisibleChanged(bool visible);
 
     void onMessageUpdated(ChatLogIdx idx);
-    void renderMessage(ChatLogIdx idx);
+    void flushMessageUpdates();
     void renderMessages(ChatLogIdx begin, ChatLogIdx end);
 
     void setRenderedWindowStart(ChatLogIdx begin);
@@ -96,6 +103,7 @@ protected:
     ChatLineContent* getContentFromPos(QPointF scenePos) const;
 
     void layout(int start, int end, qreal width);
+    void warmUpTextLayouts(const std::map<ChatLogIdx, ChatLine::Ptr>& chatLines, qreal width);
     bool isOverSelection(QPointF scenePos) const;
     bool stickToBottom() const;
 
@@ -117,6 +125,7 @@ protected:
     void focusInEvent(QFocusEvent* ev) final;
     void focusOutEvent(QFocusEvent* ev) final;
     void wheelEvent(QWheelEvent* event) final;
+    void drawBackground(QPainter* painter, const QRectF& rect) final;
 
     void updateMultiSelectionRect();
     void updateTypingNotification();
@@ -143,8 +152,12 @@ private:
     void renderFile(QString displayName, ToxFile file, bool isSelf, QDateTime timestamp,
                     ChatLine::Ptr& chatMessage);
     bool needsToHideName(ChatLogIdx idx, bool prevIdxRendered) const;
-    bool shouldRenderMessage(ChatLogIdx idx) const;
+    bool shouldRenderSpan(ChatLogIdx begin, ChatLogIdx end) const;
     void disableSearchText();
+    void beginIncrementalSearch(const QString& phrase, const ParameterSearch& parameter,
+                                SearchDirection direction);
+    void stepActiveSearch();
+    void prefetchScrollback(int scrollValue);
 
 private:
     enum class SelectionMode
@@ -166,6 +179,12 @@ private:
     QGraphicsScene* scene = nullptr;
     QGraphicsScene* busyScene = nullptr;
     QList<ChatLine::Ptr> visibleLines;
+    // Row range behind visibleLines, valid while the storage revision matches.
+    // Lets a scroll tick flip visibility only for lines that crossed the
+    // viewport edge instead of diffing the whole visible set
+    size_t visibleFirstRow = 0;
+    size_t visibleEndRow = 0;
+    uint64_t visibleRowRevision = 0;
     ChatLine::Ptr typingNotification;
     ChatLine::Ptr busyNotification;
 
@@ -184,10 +203,17 @@ private:
     QColor selectionRectColor;
     SelectionMode selectionMode = SelectionMode::None;
     QPointF clickPos;
-    QGraphicsRectItem* selGraphItem = nullptr;
+    // Multi-selection highlight extents in scene coordinates. Painted as part
+    // of the background pass rather than by a scene item, so drag-selection
+    // only triggers repaints and never mutates the scene
+    QRectF multiSelectionRect;
     QTimer* selectionTimer = nullptr;
     QTimer* workerTimer = nullptr;
+    QTimer* sceneTrimTimer = nullptr;
     QTimer* multiClickTimer = nullptr;
+    QTimer* updateFlushTimer = nullptr;
+    // Item updates queued since the last flush; rendered as contiguous spans
+    std::set<ChatLogIdx> pendingMessageUpdates;
     AutoScrollDirection selectionScrollDir = AutoScrollDirection::NoDirection;
     int clickCount = 0;
     QPoint lastClickPos;
@@ -196,6 +222,7 @@ private:
     // worker vars
     size_t workerLastIndex = 0;
     bool workerStb = false;
+    bool workerPaused = false;
     ChatLine::Ptr workerAnchorLine;
 
     // layout
@@ -205,9 +232,30 @@ private:
     IChatLog& chatLog;
     bool colorizeNames = false;
     SearchPos searchPos;
+    // State of the currently running time-sliced search. Bumping
+    // searchGeneration cancels any chunks still queued on the event loop.
+    struct
+    {
+        QString phrase;
+        ParameterSearch parameter;
+        SearchDirection direction{SearchDirection::Up};
+        SearchPos pos;
+    } activeSearch;
+    uint64_t searchGeneration{0};
     const Core& core;
     bool scrollMonitoringEnabled = true;
 
+    // Freeze/thaw state for bulk mutations; while the depth is non-zero,
+    // per-mutation relayouts are deferred into one pass on the final thaw
+    int sceneUpdateFreezeDepth = 0;
+    bool frozenLayoutPending = false;
+
+    // Scrollback prefetch state; tracks scroll velocity so the next history
+    // chunk can be staged before the window edge is reached
+    QElapsedTimer scrollVelocityTimer;
+    int lastScrollValue = 0;
+    ChatLogIdx prefetchedWindowStart{0};
+
     std::unique_ptr<ChatLineStorage> chatLineStorage;
 
     std::vector<std::function<void(void)>> renderCompletionFns;
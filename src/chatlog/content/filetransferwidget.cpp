@@ -109,7 +109,7 @@ bool FileTransferWidget::tryRemoveFile(const QString& filepath)
     return writable;
 }
 
-void FileTransferWidget::onFileTransferUpdate(ToxFile file)
+void FileTransferWidget::onFileTransferUpdate(const ToxFile& file)
 {
     updateWidget(file);
 }
@@ -32,7 +32,7 @@ public:
                        Style& style, IMessageBoxManager& messageBoxManager);
     virtual ~FileTransferWidget();
     bool isActive() const;
-    void onFileTransferUpdate(ToxFile file);
+    void onFileTransferUpdate(const ToxFile& file);
 
 protected:
     void updateWidgetColor(const ToxFile& file);
@@ -5,23 +5,21 @@
 
 #include "notificationicon.h"
 #include "src/widget/style.h"
+#include "../animationticker.h"
 #include "../pixmapcache.h"
 
 #include <QGraphicsScene>
 #include <QPainter>
-#include <QTimer>
 
 NotificationIcon::NotificationIcon(Settings& settings, Style& style, QSize Size)
     : size(Size)
 {
     pmap = PixmapCache::getInstance().get(style.getImagePath("chatArea/typing.svg", settings), size);
 
-    // Timer for the animation, if the Widget is not redrawn, no paint events will
-    // arrive and the timer will not be restarted, so this stops automatically
-    updateTimer.setInterval(1000 / framerate);
-    updateTimer.setSingleShot(true);
-
-    connect(&updateTimer, &QTimer::timeout, this, &NotificationIcon::updateGradient);
+    // The pulse advances from the shared ticker; it only runs while some
+    // animated content keeps requesting frames from its paint()
+    connect(&AnimationTicker::getInstance(), &AnimationTicker::tick, this,
+            &NotificationIcon::updateGradient);
 }
 
 QRectF NotificationIcon::boundingRect() const
@@ -39,9 +37,7 @@ void NotificationIcon::paint(QPainter* painter, const QStyleOptionGraphicsItem*
     painter->fillRect(QRect(0, 0, size.width(), size.height()), grad);
     painter->drawPixmap(0, 0, size.width(), size.height(), pmap);
 
-    if (!updateTimer.isActive()) {
-        updateTimer.start();
-    }
+    AnimationTicker::getInstance().scheduleFrame();
 
     std::ignore = option;
     std::ignore = widget;
@@ -9,7 +9,6 @@
 
 #include <QLinearGradient>
 #include <QPixmap>
-#include <QTimer>
 
 class Settings;
 class Style;
@@ -29,12 +28,9 @@ private slots:
     void updateGradient();
 
 private:
-    static constexpr int framerate = 30; // 30Hz
-
     QSize size;
     QPixmap pmap;
     QLinearGradient grad;
-    QTimer updateTimer;
 
     qreal dotWidth = 0.2;
     qreal alpha = 0.0;
@@ -4,37 +4,33 @@
  */
 
 #include "spinner.h"
+#include "../animationticker.h"
 #include "../pixmapcache.h"
 
 #include <QDebug>
+#include <QEasingCurve>
 #include <QGraphicsScene>
 #include <QPainter>
 #include <QTime>
-#include <QVariantAnimation>
 
 #include <math.h>
 
+namespace {
+// Duration of the fade-in when the spinner first appears
+constexpr int blendDurationMs = 350;
+} // namespace
+
 Spinner::Spinner(const QString& img, QSize Size, qreal speed)
     : size(Size)
     , rotSpeed(speed)
 {
     pmap = PixmapCache::getInstance().get(img, size);
 
-    // Timer for the animation, if the Widget is not redrawn, no paint events will
-    // arrive and the timer will not be restarted, so this stops automatically
-    timer.setInterval(1000 / framerate);
-    timer.setSingleShot(true);
-
-    blendAnimation = new QVariantAnimation(this);
-    blendAnimation->setStartValue(0.0);
-    blendAnimation->setEndValue(1.0);
-    blendAnimation->setDuration(350);
-    blendAnimation->setEasingCurve(QEasingCurve::InCubic);
-    blendAnimation->start(QAbstractAnimation::DeleteWhenStopped);
-    connect(blendAnimation, &QVariantAnimation::valueChanged, this,
-            [this](const QVariant& val) { alpha = val.toDouble(); });
-
-    QObject::connect(&timer, &QTimer::timeout, this, &Spinner::timeout);
+    blendClock.start();
+
+    // All spinners advance from the shared ticker; it only runs while some
+    // animated content keeps requesting frames from its paint()
+    connect(&AnimationTicker::getInstance(), &AnimationTicker::tick, this, &Spinner::onTick);
 }
 
 QRectF Spinner::boundingRect() const
@@ -53,9 +49,7 @@ void Spinner::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, Q
     painter->setRenderHint(QPainter::SmoothPixmapTransform);
     painter->drawPixmap(0, 0, pmap);
 
-    if (!timer.isActive()) {
-        timer.start(); // update bounding rectangle for next frame
-    }
+    AnimationTicker::getInstance().scheduleFrame();
 
     std::ignore = option;
     std::ignore = widget;
@@ -71,14 +65,19 @@ qreal Spinner::getAscent() const
     return 0.0;
 }
 
-void Spinner::timeout()
+void Spinner::onTick()
 {
     // Use global time, so the animations are synced
     float angle = QTime::currentTime().msecsSinceStartOfDay() / 1000.0f * rotSpeed;
     // limit to the range [0.0 - 360.0]
     curRot = remainderf(angle, 360.0f);
 
-    if (scene()) {
+    alpha = QEasingCurve(QEasingCurve::InCubic)
+                .valueForProgress(qMin(blendClock.elapsed() / qreal(blendDurationMs), 1.0));
+
+    // Skip the frame entirely for lines outside the viewport; they repaint
+    // with current state once they scroll back in
+    if (scene() && isVisible()) {
         scene()->invalidate(sceneBoundingRect());
     }
 }
@@ -7,11 +7,9 @@
 
 #include "../chatlinecontent.h"
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QPixmap>
-#include <QTimer>
-
-class QVariantAnimation;
 
 class Spinner : public ChatLineContent
 {
@@ -25,15 +23,13 @@ public:
     qreal getAscent() const override;
 
 private slots:
-    void timeout();
+    void onTick();
 
 private:
-    static constexpr int framerate = 30; // 30Hz
     QSize size;
     QPixmap pmap;
     float rotSpeed;
     float curRot;
-    QTimer timer;
     qreal alpha = 0.0;
-    QVariantAnimation* blendAnimation;
+    QElapsedTimer blendClock;
 };
@@ -46,7 +46,7 @@ Text::Text(DocumentCache& documentCache_, Settings& settings_, Style& style_, co
 Text::~Text()
 {
     if (doc)
-        documentCache.push(doc);
+        freeResources();
 }
 
 void Text::setText(const QString& txt)
@@ -311,32 +311,54 @@ QString Text::getLinkAt(QPointF scenePos) const
 
 void Text::regenerate()
 {
-    if (!doc) {
-        doc = documentCache.pop();
-        dirty = true;
+    // Offscreen lines only need their geometry. A clean one already has it,
+    // and a dirty one whose string was measured before - timestamps repeat a
+    // handful of formats thousands of times - takes it from the shared
+    // measurement cache, skipping the document build entirely
+    if (!doc && !keepInMemory) {
+        if (!dirty) {
+            return;
+        }
+        if (const auto* measurement = documentCache.findMeasurement(makeMeasurementKey(width))) {
+            ascent = measurement->ascent;
+            if (size != measurement->size)
+                prepareGeometryChange();
+            size = measurement->size;
+            docCacheKey = makeDocCacheKey(width);
+            dirty = false;
+            return;
+        }
     }
 
-    if (dirty) {
-        doc->setDefaultFont(defFont);
+    if (!doc) {
+        // A clean document we released earlier - or one pre-built by the
+        // parallel warm-up - may be interned under our current key; taking
+        // it back skips the HTML parse and layout below entirely
+        const QByteArray key = dirty ? makeDocCacheKey(width) : docCacheKey;
+        if (!key.isEmpty()) {
+            doc = documentCache.popLaidOut(key);
+        }
+
+        if (doc) {
+            docCacheKey = key;
+            dirty = false;
 
-        if (elide) {
-            QFontMetrics metrics = QFontMetrics(defFont);
-            QString elidedText = metrics.elidedText(text, Qt::ElideRight, qRound(width));
+            if (doc->firstBlock().layout()->lineCount() > 0)
+                ascent = doc->firstBlock().layout()->lineAt(0).ascent();
 
-            doc->setPlainText(elidedText);
+            if (size != idealSize())
+                prepareGeometryChange();
+
+            size = idealSize();
+            documentCache.storeMeasurement(makeMeasurementKey(width), size, ascent);
         } else {
-            doc->setDefaultStyleSheet(defStyleSheet);
-            doc->setHtml(text);
+            doc = documentCache.pop();
+            dirty = true;
         }
+    }
 
-        // wrap mode
-        QTextOption opt;
-        opt.setWrapMode(elide ? QTextOption::NoWrap : QTextOption::WrapAtWordBoundaryOrAnywhere);
-        doc->setDefaultTextOption(opt);
-
-        // width
-        doc->setTextWidth(width);
-        doc->documentLayout()->update();
+    if (dirty) {
+        applyLayout(*doc, width);
 
         // update ascent
         if (doc->firstBlock().layout()->lineCount() > 0)
@@ -349,7 +371,9 @@ void Text::regenerate()
         // get the new width and height
         size = idealSize();
 
+        docCacheKey = makeDocCacheKey(width);
         dirty = false;
+        documentCache.storeMeasurement(makeMeasurementKey(width), size, ascent);
     }
 
     // if we are not visible -> free mem
@@ -357,9 +381,78 @@ void Text::regenerate()
         freeResources();
 }
 
+/**
+ * @brief Runs the expensive part of regenerate() against a target document.
+ *
+ * Shared between the regular GUI-thread layout and backgroundLayout();
+ * reads only fields that are fixed after construction (text, font,
+ * stylesheet, elide mode), so it is safe to call from a pool thread as long
+ * as the target document is not in use anywhere else.
+ */
+void Text::applyLayout(QTextDocument& target, qreal targetWidth) const
+{
+    target.setDefaultFont(defFont);
+
+    if (elide) {
+        QFontMetrics metrics = QFontMetrics(defFont);
+        QString elidedText = metrics.elidedText(text, Qt::ElideRight, qRound(targetWidth));
+
+        target.setPlainText(elidedText);
+    } else {
+        target.setDefaultStyleSheet(defStyleSheet);
+        target.setHtml(text);
+    }
+
+    // wrap mode
+    QTextOption opt;
+    opt.setWrapMode(elide ? QTextOption::NoWrap : QTextOption::WrapAtWordBoundaryOrAnywhere);
+    target.setDefaultTextOption(opt);
+
+    // width
+    target.setTextWidth(targetWidth);
+    target.documentLayout()->update();
+}
+
+/**
+ * @brief Whether this text's layout may be computed off the GUI thread.
+ *
+ * Documents whose HTML pulls in image resources (smileys) are excluded:
+ * CustomTextDocument::loadResource builds QPixmaps, which is only legal on
+ * the GUI thread. Those lines lay out serially as before.
+ */
+bool Text::supportsBackgroundLayout() const
+{
+    return !text.contains(QStringLiteral("<img"), Qt::CaseInsensitive);
+}
+
+/**
+ * @brief Key the warm-up result must be cached under to be found by regenerate().
+ */
+QByteArray Text::backgroundLayoutKey(qreal w) const
+{
+    return makeDocCacheKey(w);
+}
+
+/**
+ * @brief Lays this text out into a fresh, unparented document.
+ *
+ * Called from QThreadPool workers during the initial history render; the
+ * caller hands the document to DocumentCache::pushLaidOut on the GUI thread
+ * so the following regenerate() pass finds it.
+ */
+void Text::backgroundLayout(QTextDocument& target, qreal w) const
+{
+    applyLayout(target, w);
+}
+
 void Text::freeResources()
 {
-    documentCache.push(doc);
+    if (!dirty && !docCacheKey.isEmpty()) {
+        documentCache.pushLaidOut(docCacheKey, doc);
+    } else {
+        documentCache.push(doc);
+    }
+
     doc = nullptr;
 }
 
@@ -460,11 +553,48 @@ void Text::selectText(QTextCursor& cursor, const std::pair<int, int>& point)
         format.setBackground(QBrush(style.getColor(Style::ColorPalette::SearchHighlighted)));
         cursor.mergeCharFormat(format);
 
+        // The document no longer matches what was generated from the key;
+        // keep it out of the shared cache until the next full rebuild
+        docCacheKey.clear();
+
         regenerate();
         update();
     }
 }
 
+/**
+ * @brief Key for the shared measurement cache.
+ *
+ * Same inputs as the document cache key, plus the measuring class: subclasses
+ * like Timestamp derive a different idealSize() from the same document, so
+ * their measurements must not collide.
+ */
+QByteArray Text::makeMeasurementKey(qreal forWidth) const
+{
+    QByteArray key = makeDocCacheKey(forWidth);
+    key += '\n';
+    key += metaObject()->className();
+    return key;
+}
+
+QByteArray Text::makeDocCacheKey(qreal forWidth) const
+{
+    // Everything that feeds into regenerate()'s layout has to be part of the
+    // key. The stylesheet doubles as the style revision: it changes whenever
+    // the theme or font settings do
+    QByteArray key;
+    key += elide ? '1' : '0';
+    key += defFont.key().toUtf8();
+    key += '\n';
+    key += QByteArray::number(forWidth);
+    key += '\n';
+    key += defStyleSheet.toUtf8();
+    key += '\n';
+    key += text.toUtf8();
+
+    return key;
+}
+
 QColor Text::textColor() const
 {
     QColor c = style.getColor(Style::ColorPalette::MainText);
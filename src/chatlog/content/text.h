@@ -65,6 +65,12 @@ public:
     QString getText() const final;
     QString getLinkAt(QPointF scenePos) const;
 
+    // Parallel layout warm-up: lays out the expensive parts off the GUI
+    // thread into a fresh document so the later regenerate() is a cache hit
+    bool supportsBackgroundLayout() const;
+    QByteArray backgroundLayoutKey(qreal w) const;
+    void backgroundLayout(QTextDocument& target, qreal w) const;
+
 protected:
     // dynamic resource management
     void regenerate();
@@ -85,10 +91,16 @@ protected:
 private:
     void selectText(QTextCursor& cursor, const std::pair<int, int>& point);
     QColor textColor() const;
+    QByteArray makeDocCacheKey(qreal forWidth) const;
+    QByteArray makeMeasurementKey(qreal forWidth) const;
+    void applyLayout(QTextDocument& target, qreal targetWidth) const;
 
     QString text;
     QString rawText;
     QString selectedText;
+    // Key the current document was laid out under. Empty if the document was
+    // mutated after layout (e.g. search highlighting) and must not be shared
+    QByteArray docCacheKey;
     bool keepInMemory = false;
     bool elide = false;
     bool dirty = false;
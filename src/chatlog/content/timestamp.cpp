@@ -11,6 +11,12 @@ Timestamp::Timestamp(const QDateTime& time_, const QString& format, const QFont&
            time_.toString(format))
 {
     time = time_;
+
+    // The gutter never changes while scrolling, so let the scene blit a
+    // cached rasterization instead of re-rendering the text document every
+    // paint. The cache invalidates itself on update(), which covers width
+    // and style changes
+    setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 }
 
 QDateTime Timestamp::getTime()
@@ -4,12 +4,12 @@
  */
 
 #include "customtextdocument.h"
+#include "src/chatlog/pixmapcache.h"
 #include "src/persistence/settings.h"
 #include "src/persistence/smileypack.h"
 #include "src/widget/style.h"
 
 #include <QDebug>
-#include <QIcon>
 #include <QUrl>
 
 CustomTextDocument::CustomTextDocument(SmileyPack& smileyPack_, Settings& settings_, QObject* parent)
@@ -27,9 +27,13 @@ QVariant CustomTextDocument::loadResource(int type, const QUrl& name)
         QSize size = QSize(settings.getEmojiFontPointSize(), settings.getEmojiFontPointSize());
         QString fileName = QUrl::fromPercentEncoding(name.toEncoded()).mid(4).toHtmlEscaped();
 
-        std::shared_ptr<QIcon> icon = smileyPack.getAsIcon(fileName);
-        emoticonIcons.append(icon);
-        return icon->pixmap(size);
+        // Every document showing the same emoticon shares one pixmap this way,
+        // instead of each pinning its own QIcon
+        const QString iconPath = smileyPack.getIconPath(fileName);
+        if (!iconPath.isEmpty()) {
+            return PixmapCache::getInstance().get(iconPath, size);
+        }
+        return QPixmap();
     }
 
     return QTextDocument::loadResource(type, name);
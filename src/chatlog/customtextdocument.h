@@ -5,12 +5,8 @@
 
 #pragma once
 
-#include <QList>
 #include <QTextDocument>
 
-#include <memory>
-
-class QIcon;
 class SmileyPack;
 class Settings;
 
@@ -24,7 +20,6 @@ protected:
     virtual QVariant loadResource(int type, const QUrl& name);
 
 private:
-    QList<std::shared_ptr<QIcon>> emoticonIcons;
     SmileyPack& smileyPack;
     Settings& settings;
 };
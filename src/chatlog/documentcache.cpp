@@ -6,13 +6,20 @@
 #include "documentcache.h"
 #include "customtextdocument.h"
 
+#include "src/memoryusagetracker.h"
+
 DocumentCache::DocumentCache(SmileyPack& smileyPack_, Settings& settings_)
     : smileyPack{smileyPack_}
     , settings{settings_}
 {
+    MemoryUsageTracker::instance().registerSource(
+        this, QStringLiteral("Document cache"), [this] { return approximateBytes(); },
+        [this] { trim(); });
 }
 DocumentCache::~DocumentCache()
 {
+    MemoryUsageTracker::instance().unregisterSource(this);
+
     while (!documents.isEmpty())
         delete documents.pop();
 }
@@ -32,3 +39,84 @@ void DocumentCache::push(QTextDocument* doc)
         documents.push(doc);
     }
 }
+
+/**
+ * @brief Takes a previously laid-out document out of the keyed cache.
+ * @return The document, or nullptr if nothing is cached under the key.
+ *
+ * Ownership transfers to the caller; return it with pushLaidOut() or push().
+ */
+QTextDocument* DocumentCache::popLaidOut(const QByteArray& key)
+{
+    return laidOutDocuments.take(key);
+}
+
+/**
+ * @brief Hands a fully laid-out document back for later reuse under the key
+ * it was built from. The cache takes ownership and evicts least recently
+ * used documents once it holds too much text.
+ */
+void DocumentCache::pushLaidOut(const QByteArray& key, QTextDocument* doc)
+{
+    if (!doc) {
+        return;
+    }
+
+    laidOutDocuments.insert(key, doc, qMax(doc->characterCount(), 1));
+}
+
+/**
+ * @brief Whether a laid-out document is already cached under the key.
+ *
+ * Lets the layout warm-up skip work that a previous render already paid for.
+ */
+bool DocumentCache::containsLaidOut(const QByteArray& key) const
+{
+    return laidOutDocuments.contains(key);
+}
+
+/**
+ * @brief Looks up the geometry a previous layout computed for the key.
+ * @return The cached measurement, or nullptr; only valid until the next
+ * storeMeasurement() call.
+ */
+const DocumentCache::Measurement* DocumentCache::findMeasurement(const QByteArray& key) const
+{
+    return measurements.object(key);
+}
+
+/**
+ * @brief Remembers the geometry a layout produced, so later sizing passes of
+ * the same string can skip the document build.
+ */
+void DocumentCache::storeMeasurement(const QByteArray& key, QSizeF size, qreal ascent)
+{
+    measurements.insert(key, new Measurement{size, ascent});
+}
+
+/**
+ * @brief Rough byte footprint of the cached layouts.
+ *
+ * Document cost is counted in characters, so UTF-16 text alone is twice
+ * that; the layout structures on top are not accounted, making this a
+ * floor, not a measurement.
+ */
+quint64 DocumentCache::approximateBytes() const
+{
+    return quint64(laidOutDocuments.totalCost()) * 2
+           + quint64(measurements.totalCost()) * sizeof(Measurement);
+}
+
+/**
+ * @brief Releases every cached document, measurement and pooled spare.
+ *
+ * Rendering rebuilds what it needs, so this only trades CPU on the next
+ * paint for memory now.
+ */
+void DocumentCache::trim()
+{
+    laidOutDocuments.clear();
+    measurements.clear();
+    while (!documents.isEmpty())
+        delete documents.pop();
+}
@@ -5,6 +5,9 @@
 
 #pragma once
 
+#include <QByteArray>
+#include <QCache>
+#include <QSizeF>
 #include <QStack>
 
 class QTextDocument;
@@ -22,8 +25,33 @@ public:
     QTextDocument* pop();
     void push(QTextDocument* doc);
 
+    QTextDocument* popLaidOut(const QByteArray& key);
+    void pushLaidOut(const QByteArray& key, QTextDocument* doc);
+    bool containsLaidOut(const QByteArray& key) const;
+
+    struct Measurement
+    {
+        QSizeF size;
+        qreal ascent;
+    };
+    const Measurement* findMeasurement(const QByteArray& key) const;
+    void storeMeasurement(const QByteArray& key, QSizeF size, qreal ascent);
+
+    quint64 approximateBytes() const;
+    void trim();
+
 private:
     QStack<QTextDocument*> documents;
+    // LRU of fully laid-out documents keyed by content, width and style.
+    // Checking one out transfers ownership so two Text instances can never
+    // mutate the same document. Cost is measured in characters, bounding the
+    // cache to roughly a million characters worth of layouts
+    QCache<QByteArray, QTextDocument> laidOutDocuments{1 << 20};
+    // Geometry of previously laid-out strings, keyed like the document cache
+    // plus the measuring class. Entries are a couple dozen bytes, so this is
+    // bounded by count; it lets offscreen lines repeating the same string -
+    // timestamps above all - size themselves without building a document
+    QCache<QByteArray, Measurement> measurements{4096};
     SmileyPack& smileyPack;
     Settings& settings;
 };
@@ -5,19 +5,77 @@
 
 #include "pixmapcache.h"
 
+#include "src/memoryusagetracker.h"
+
+#include <QImageReader>
+#include <QStringBuilder>
+
+PixmapCache::PixmapCache()
+{
+    // The singleton lives until process exit, so no unregister is needed
+    MemoryUsageTracker::instance().registerSource(
+        this, QStringLiteral("Pixmap cache"), [this] { return quint64(cache.totalCost()); },
+        [this] { trim(); });
+}
+
 QPixmap PixmapCache::get(const QString& filename, QSize size)
 {
-    auto itr = cache.find(filename);
+    const QString key = filename % QLatin1Char('@') % QString::number(size.width())
+                        % QLatin1Char('x') % QString::number(size.height());
+
+    if (const QPixmap* cached = cache.object(key)) {
+        return *cached;
+    }
 
-    if (itr == cache.end()) {
-        QIcon icon;
-        icon.addFile(filename);
+    QImageReader reader(filename);
 
-        cache.insert(filename, icon);
-        return icon.pixmap(size);
+    // Decode straight to the displayed size instead of loading the source
+    // resolution and scaling afterwards, so what we keep alive is proportional
+    // to what is on screen. Raster sources are never upscaled past their
+    // native resolution; vector formats report a default size but rasterize
+    // cleanly at any target
+    const QSize sourceSize = reader.size();
+    if (sourceSize.isValid()) {
+        const QByteArray format = reader.format();
+        const bool scalable = format == "svg" || format == "svgz";
+        if (scalable || sourceSize.width() > size.width() || sourceSize.height() > size.height()) {
+            reader.setScaledSize(sourceSize.scaled(size, Qt::KeepAspectRatio));
+        }
     }
 
-    return itr.value().pixmap(size);
+    const QPixmap pixmap = QPixmap::fromImage(reader.read());
+
+    // QCache takes ownership and may evict immediately if the entry alone
+    // exceeds the budget; the copy we hand back is unaffected either way
+    const qsizetype cost = static_cast<qsizetype>(pixmap.width()) * pixmap.height()
+                           * qMax(pixmap.depth() / 8, 1);
+    cache.insert(key, new QPixmap(pixmap), cost);
+
+    return pixmap;
+}
+
+/**
+ * @brief Re-budgets the cache at runtime; shrinking evicts LRU entries now.
+ */
+void PixmapCache::setBudget(qsizetype bytes)
+{
+    cache.setMaxCost(bytes);
+}
+
+/**
+ * @brief Bytes of decoded pixmap data currently held.
+ */
+qsizetype PixmapCache::totalCost() const
+{
+    return cache.totalCost();
+}
+
+/**
+ * @brief Drops every cached pixmap; entries re-decode on next display.
+ */
+void PixmapCache::trim()
+{
+    cache.clear();
 }
 
 /**
@@ -5,21 +5,27 @@
 
 #pragma once
 
-#include <QHash>
-#include <QIcon>
+#include <QCache>
 #include <QPixmap>
 
 class PixmapCache
 {
 public:
     QPixmap get(const QString& filename, QSize size);
+    void setBudget(qsizetype bytes);
+    qsizetype totalCost() const;
+    void trim();
     static PixmapCache& getInstance();
 
 protected:
-    PixmapCache() {}
+    PixmapCache();
     PixmapCache(PixmapCache&) = delete;
     PixmapCache& operator=(const PixmapCache&) = delete;
 
 private:
-    QHash<QString, QIcon> cache;
+    // LRU of decoded pixmaps keyed by filename and target size. Cost is
+    // measured in pixmap bytes, so a chat full of pasted screenshots holds at
+    // most this budget of image data instead of every source at full
+    // resolution
+    QCache<QString, QPixmap> cache{32 << 20};
 };
@@ -42,21 +42,69 @@ const QString MULTILINE_CODE = QStringLiteral("(?<=^|\\s)"
                                               "```"
                                               "(?=$|\\s)");
 
-#define REGEXP_WRAPPER_PAIR(pattern, wrapper)                                     \
-    {QRegularExpression(pattern, QRegularExpression::UseUnicodePropertiesOption), \
+// Bitmask of formatting characters seen in a message. A single scan for
+// these decides which of the markdown regular expressions can match at all,
+// so the usual plain message never pays for a regex pass
+enum FormattingTrigger : uint
+{
+    asteriskSeen = 1 << 0,
+    slashSeen = 1 << 1,
+    underscoreSeen = 1 << 2,
+    tildeSeen = 1 << 3,
+    backtickSeen = 1 << 4,
+};
+
+uint scanFormattingTriggers(const QString& message)
+{
+    uint seen = 0;
+    for (const QChar c : message) {
+        switch (c.unicode()) {
+        case '*':
+            seen |= asteriskSeen;
+            break;
+        case '/':
+            seen |= slashSeen;
+            break;
+        case '_':
+            seen |= underscoreSeen;
+            break;
+        case '~':
+            seen |= tildeSeen;
+            break;
+        case '`':
+            seen |= backtickSeen;
+            break;
+        default:
+            break;
+        }
+    }
+    return seen;
+}
+
+struct MarkdownPattern
+{
+    uint trigger;
+    QRegularExpression regex;
+    QString wrapper;
+};
+
+#define REGEXP_WRAPPER_PAIR(trigger, pattern, wrapper)                                     \
+    {trigger, QRegularExpression(pattern, QRegularExpression::UseUnicodePropertiesOption), \
      QStringLiteral(wrapper)}
 
-const QPair<QRegularExpression, QString> REGEX_TO_WRAPPER[]{
-    REGEXP_WRAPPER_PAIR(SINGLE_SLASH_PATTERN, "<i>%1</i>"),
-    REGEXP_WRAPPER_PAIR(SINGLE_SIGN_PATTERN.arg('*'), "<b>%1</b>"),
-    REGEXP_WRAPPER_PAIR(SINGLE_SIGN_PATTERN.arg('_'), "<u>%1</u>"),
-    REGEXP_WRAPPER_PAIR(SINGLE_SIGN_PATTERN.arg('~'), "<s>%1</s>"),
-    REGEXP_WRAPPER_PAIR(SINGLE_SIGN_PATTERN.arg('`'), "<font color=#595959><code>%1</code></font>"),
-    REGEXP_WRAPPER_PAIR(DOUBLE_SIGN_PATTERN.arg('*'), "<b>%1</b>"),
-    REGEXP_WRAPPER_PAIR(DOUBLE_SIGN_PATTERN.arg('/'), "<i>%1</i>"),
-    REGEXP_WRAPPER_PAIR(DOUBLE_SIGN_PATTERN.arg('_'), "<u>%1</u>"),
-    REGEXP_WRAPPER_PAIR(DOUBLE_SIGN_PATTERN.arg('~'), "<s>%1</s>"),
-    REGEXP_WRAPPER_PAIR(MULTILINE_CODE, "<font color=#595959><code>%1</code></font>"),
+const MarkdownPattern REGEX_TO_WRAPPER[]{
+    REGEXP_WRAPPER_PAIR(slashSeen, SINGLE_SLASH_PATTERN, "<i>%1</i>"),
+    REGEXP_WRAPPER_PAIR(asteriskSeen, SINGLE_SIGN_PATTERN.arg('*'), "<b>%1</b>"),
+    REGEXP_WRAPPER_PAIR(underscoreSeen, SINGLE_SIGN_PATTERN.arg('_'), "<u>%1</u>"),
+    REGEXP_WRAPPER_PAIR(tildeSeen, SINGLE_SIGN_PATTERN.arg('~'), "<s>%1</s>"),
+    REGEXP_WRAPPER_PAIR(backtickSeen, SINGLE_SIGN_PATTERN.arg('`'),
+                        "<font color=#595959><code>%1</code></font>"),
+    REGEXP_WRAPPER_PAIR(asteriskSeen, DOUBLE_SIGN_PATTERN.arg('*'), "<b>%1</b>"),
+    REGEXP_WRAPPER_PAIR(slashSeen, DOUBLE_SIGN_PATTERN.arg('/'), "<i>%1</i>"),
+    REGEXP_WRAPPER_PAIR(underscoreSeen, DOUBLE_SIGN_PATTERN.arg('_'), "<u>%1</u>"),
+    REGEXP_WRAPPER_PAIR(tildeSeen, DOUBLE_SIGN_PATTERN.arg('~'), "<s>%1</s>"),
+    REGEXP_WRAPPER_PAIR(backtickSeen, MULTILINE_CODE,
+                        "<font color=#595959><code>%1</code></font>"),
 };
 
 #undef REGEXP_WRAPPER_PAIR
@@ -64,20 +112,34 @@ const QPair<QRegularExpression, QString> REGEX_TO_WRAPPER[]{
 const QString HREF_WRAPPER = QStringLiteral(R"(<a href="%1">%1</a>)");
 const QString WWW_WRAPPER = QStringLiteral(R"(<a href="http://%1">%1</a>)");
 
-const QVector<QRegularExpression> WWW_WORD_PATTERN = {
-    QRegularExpression(QStringLiteral(R"((?<=^|\s)\S*((www\.)\S+))"))};
+struct UriPattern
+{
+    // Cheap literal that has to occur in the message for the regex to
+    // possibly match, checked before the regex is run
+    QLatin1String needle;
+    QRegularExpression regex;
+};
+
+const QVector<UriPattern> WWW_WORD_PATTERN = {
+    {QLatin1String("www."), QRegularExpression(QStringLiteral(R"((?<=^|\s)\S*((www\.)\S+))"))}};
 
-const QVector<QRegularExpression> URI_WORD_PATTERNS = {
+const QVector<UriPattern> URI_WORD_PATTERNS = {
     // Note: This does not match only strictly valid URLs, but we broaden search to any string following scheme to
     // allow UTF-8 "IRI"s instead of ASCII-only URLs
-    QRegularExpression(QStringLiteral(R"((?<=^|\s)\S*((((http[s]?)|ftp)://)\S+))")),
-    QRegularExpression(QStringLiteral(R"((?<=^|\s)\S*((file|smb)://([\S| ]*)))")),
-    QRegularExpression(QStringLiteral(R"((?<=^|\s)\S*(tox:[a-zA-Z\d]{76}))")),
-    QRegularExpression(QStringLiteral(R"((?<=^|\s)\S*(mailto:\S+@\S+\.\S+))")),
-    QRegularExpression(QStringLiteral(
-        R"((?<=^|\s)\S*(magnet:[?]((xt(.\d)?=urn:)|(mt=)|(kt=)|(tr=)|(dn=)|(xl=)|(xs=)|(as=)|(x.))[\S| ]+))")),
-    QRegularExpression(QStringLiteral(R"((?<=^|\s)\S*(gemini://\S+))")),
-    QRegularExpression(QStringLiteral(R"((?<=^|\s)\S*(ed2k://\|file\|\S+))")),
+    {QLatin1String("://"),
+     QRegularExpression(QStringLiteral(R"((?<=^|\s)\S*((((http[s]?)|ftp)://)\S+))"))},
+    {QLatin1String("://"),
+     QRegularExpression(QStringLiteral(R"((?<=^|\s)\S*((file|smb)://([\S| ]*)))"))},
+    {QLatin1String("tox:"), QRegularExpression(QStringLiteral(R"((?<=^|\s)\S*(tox:[a-zA-Z\d]{76}))"))},
+    {QLatin1String("mailto:"),
+     QRegularExpression(QStringLiteral(R"((?<=^|\s)\S*(mailto:\S+@\S+\.\S+))"))},
+    {QLatin1String("magnet:"),
+     QRegularExpression(QStringLiteral(
+         R"((?<=^|\s)\S*(magnet:[?]((xt(.\d)?=urn:)|(mt=)|(kt=)|(tr=)|(dn=)|(xl=)|(xs=)|(as=)|(x.))[\S| ]+))"))},
+    {QLatin1String("gemini://"),
+     QRegularExpression(QStringLiteral(R"((?<=^|\s)\S*(gemini://\S+))"))},
+    {QLatin1String("ed2k://"),
+     QRegularExpression(QStringLiteral(R"((?<=^|\s)\S*(ed2k://\|file\|\S+))"))},
 };
 
 
@@ -152,14 +214,18 @@ MatchingUri stripSurroundingChars(const QStringView wrappedUri, const int startO
  * @note done separately from URI since the link must have a scheme added to be valid
  * @return Copy of message with highlighted URLs
  */
-QString highlight(const QString& message, const QVector<QRegularExpression>& patterns,
+QString highlight(const QString& message, const QVector<UriPattern>& patterns,
                   const QString& wrapper)
 {
     QString result = message;
-    for (const QRegularExpression& exp : patterns) {
+    for (const UriPattern& pattern : patterns) {
+        if (!result.contains(pattern.needle)) {
+            continue;
+        }
+
         const int startLength = result.length();
         int offset = 0;
-        QRegularExpressionMatchIterator iter = exp.globalMatch(result);
+        QRegularExpressionMatchIterator iter = pattern.regex.globalMatch(result);
         while (iter.hasNext()) {
             const QRegularExpressionMatch match = iter.next();
             const int uriWithWrapMatch{0};
@@ -212,6 +278,55 @@ QString TextFormatter::highlightURI(const QString& message)
     return result;
 }
 
+/**
+ * @brief Collects the web URLs contained in a message, as the highlighter sees them.
+ *
+ * Runs the same word patterns and surrounding-character stripping as
+ * highlightURI, so exactly the strings rendered as clickable web links come
+ * back, each one once. Scheme-less www links get the same http:// prefix the
+ * highlighter links them with. Non-web schemes (tox:, mailto:, magnet:, ...)
+ * are skipped since callers use this to fetch link metadata.
+ */
+QStringList TextFormatter::extractHttpUris(const QString& message)
+{
+    QStringList uris;
+
+    const auto collect = [&uris, &message](const QVector<UriPattern>& patterns,
+                                           const QString& prefix) {
+        for (const UriPattern& pattern : patterns) {
+            if (!message.contains(pattern.needle)) {
+                continue;
+            }
+
+            QRegularExpressionMatchIterator iter = pattern.regex.globalMatch(message);
+            while (iter.hasNext()) {
+                const QRegularExpressionMatch match = iter.next();
+                const int uriWithWrapMatch{0};
+                const int uriWithoutWrapMatch{1};
+                MatchingUri matchUri =
+                    stripSurroundingChars(match.capturedView(uriWithWrapMatch),
+                                          match.capturedStart(uriWithoutWrapMatch)
+                                              - match.capturedStart(uriWithWrapMatch));
+                if (!matchUri.valid) {
+                    continue;
+                }
+
+                const QString uri =
+                    prefix + match.captured(uriWithoutWrapMatch).left(matchUri.length);
+                if ((uri.startsWith(QLatin1String("http://"))
+                     || uri.startsWith(QLatin1String("https://")))
+                    && !uris.contains(uri)) {
+                    uris += uri;
+                }
+            }
+        }
+    };
+
+    collect(URI_WORD_PATTERNS, {});
+    collect(WWW_WORD_PATTERN, QStringLiteral("http://"));
+    return uris;
+}
+
 /**
  * @brief Applies markdown to passed message string
  * @param message Formatting string
@@ -221,9 +336,18 @@ QString TextFormatter::highlightURI(const QString& message)
  */
 QString TextFormatter::applyMarkdown(const QString& message, bool showFormattingSymbols)
 {
+    const uint triggersSeen = scanFormattingTriggers(message);
+    if (triggersSeen == 0) {
+        return message;
+    }
+
     QString result = message;
-    for (const QPair<QRegularExpression, QString>& pair : REGEX_TO_WRAPPER) {
-        QRegularExpressionMatchIterator iter = pair.first.globalMatch(result);
+    for (const MarkdownPattern& pattern : REGEX_TO_WRAPPER) {
+        if (!(triggersSeen & pattern.trigger)) {
+            continue;
+        }
+
+        QRegularExpressionMatchIterator iter = pattern.regex.globalMatch(result);
         int offset = 0;
         while (iter.hasNext()) {
             const QRegularExpressionMatch match = iter.next();
@@ -233,7 +357,7 @@ QString TextFormatter::applyMarkdown(const QString& message, bool showFormatting
             }
 
             const int length = match.capturedLength();
-            const QString wrappedText = pair.second.arg(captured);
+            const QString wrappedText = pattern.wrapper.arg(captured);
             const int startPos = match.capturedStart() + offset;
             result.replace(startPos, length, wrappedText);
             offset += wrappedText.length() - length;
@@ -6,9 +6,12 @@
 #pragma once
 
 #include <QString>
+#include <QStringList>
 
 namespace TextFormatter {
 QString highlightURI(const QString& message);
 
+QStringList extractHttpUris(const QString& message);
+
 QString applyMarkdown(const QString& message, bool showFormattingSymbols);
 } // namespace TextFormatter
@@ -23,6 +23,7 @@ Conference* ConferenceList::addConference(Core& core, int conferenceNum,
                                                selfName, core, core, friendList);
     conferenceList[conferenceId] = newConference;
     id2key[conferenceNum] = conferenceId;
+    orderedConferences.append(newConference);
     return newConference;
 }
 
@@ -44,18 +45,14 @@ void ConferenceList::removeConference(const ConferenceId& conferenceId, bool /*f
 {
     auto g_it = conferenceList.find(conferenceId);
     if (g_it != conferenceList.end()) {
+        orderedConferences.removeOne(g_it.value());
         conferenceList.erase(g_it);
     }
 }
 
-QList<Conference*> ConferenceList::getAllConferences()
+const QList<Conference*>& ConferenceList::getAllConferences() const
 {
-    QList<Conference*> res;
-
-    for (auto it : conferenceList)
-        res.append(it);
-
-    return res;
+    return orderedConferences;
 }
 
 void ConferenceList::clear()
@@ -63,4 +60,5 @@ void ConferenceList::clear()
     for (auto conferenceptr : conferenceList)
         delete conferenceptr;
     conferenceList.clear();
+    orderedConferences.clear();
 }
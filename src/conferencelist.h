@@ -7,6 +7,8 @@
 
 #include "src/core/conferenceid.h"
 
+#include <QList>
+
 class Core;
 template <class A, class B>
 class QHash;
@@ -25,10 +27,15 @@ public:
     Conference* findConference(const ConferenceId& conferenceId);
     const ConferenceId& id2Key(uint32_t conferenceNum);
     void removeConference(const ConferenceId& conferenceId, bool fake = false);
-    QList<Conference*> getAllConferences();
+    const QList<Conference*>& getAllConferences() const;
     void clear();
 
 private:
     QHash<const ConferenceId, Conference*> conferenceList;
     QHash<uint32_t, ConferenceId> id2key;
+    // Kept in sync with conferenceList so bulk readers iterate a stable,
+    // insertion-ordered list without rebuilding one from the hash per call;
+    // callers mutating the list while iterating must take their own
+    // (implicitly shared) copy first
+    QList<Conference*> orderedConferences;
 };
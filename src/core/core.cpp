@@ -17,6 +17,7 @@
 #include "src/model/ibootstraplistgenerator.h"
 #include "src/model/status.h"
 #include "src/persistence/profile.h"
+#include "util/perfzone.h"
 #include "util/strongtype.h"
 #include "util/toxcoreerrorparser.h"
 
@@ -31,25 +32,12 @@
 
 #include <algorithm>
 #include <cassert>
-#include <chrono>
 #include <memory>
-#include <random>
 
 const QString Core::TOX_EXT = ".tox";
 
 #define ASSERT_CORE_THREAD assert(QThread::currentThread() == coreThread.get())
 
-namespace {
-
-QList<DhtServer> shuffleBootstrapNodes(QList<DhtServer> bootstrapNodes)
-{
-    std::mt19937 rng(std::chrono::high_resolution_clock::now().time_since_epoch().count());
-    std::shuffle(bootstrapNodes.begin(), bootstrapNodes.end(), rng);
-    return bootstrapNodes;
-}
-
-} // namespace
-
 Core::Core(QThread* coreThread_, IBootstrapListGenerator& bootstrapListGenerator_,
            const ICoreSettings& settings_)
     : tox(nullptr)
@@ -298,16 +286,28 @@ QRecursiveMutex& Core::getCoreLoopLock() const
     return coreLoopLock;
 }
 
+const CoreMetrics& Core::getMetrics() const
+{
+    return metrics;
+}
+
 /**
  * @brief Processes toxcore events and ensure we stay connected, called by its own timer
  */
 void Core::process()
 {
+    PERF_ZONE(core_process);
+
     QMutexLocker<QRecursiveMutex> ml{&coreLoopLock};
 
     ASSERT_CORE_THREAD;
 
+    QElapsedTimer iterationTimer;
+    iterationTimer.start();
     tox_iterate(tox.get(), this);
+    metrics.recordIteration(iterationTimer.nsecsElapsed() / 1000);
+
+    flushPendingStateChanges();
 
 #ifdef DEBUG
     // we want to see the debug messages immediately
@@ -350,8 +350,28 @@ bool Core::checkConnection()
         break;
     }
 
+    if (selfConnection != lastConnectionMode) {
+        // Flapping between modes approximates DHT churn; toxcore doesn't
+        // expose its node table
+        auto mode = CoreMetrics::ConnectionMode::None;
+        if (selfConnection == TOX_CONNECTION_TCP) {
+            mode = CoreMetrics::ConnectionMode::Tcp;
+        } else if (selfConnection == TOX_CONNECTION_UDP) {
+            mode = CoreMetrics::ConnectionMode::Udp;
+        }
+        metrics.countConnectionChange(mode);
+        lastConnectionMode = selfConnection;
+    }
+
     if (toxConnected && !isConnected) {
         qDebug() << "Connected to" << connectionName;
+        if (bootstrapTimer.isValid()) {
+            // Credit the whole burst; we can't tell which node got us online
+            bootstrapListGenerator.reportBootstrapSuccess(pendingBootstrapNodes,
+                                                          static_cast<int>(bootstrapTimer.elapsed()));
+            bootstrapTimer.invalidate();
+            pendingBootstrapNodes.clear();
+        }
         emit connected();
     } else if (!toxConnected && isConnected) {
         qDebug() << "Disconnected from the DHT";
@@ -362,6 +382,48 @@ bool Core::checkConnection()
     return toxConnected;
 }
 
+/**
+ * @brief Emits the friend state changes accumulated during this iteration.
+ *
+ * The typing and status callbacks only record the latest state per friend,
+ * so a flapping connection collapses to at most one change per friend per
+ * tick, and the GUI fan-out receives the whole batch as one queued event.
+ * The per-friend signals stay for consumers that track individual
+ * transitions, like CoreFile cancelling transfers of an offline friend.
+ */
+void Core::flushPendingStateChanges()
+{
+    ASSERT_CORE_THREAD;
+
+    if (!pendingStatusChanges.isEmpty()) {
+        for (auto it = pendingStatusChanges.cbegin(); it != pendingStatusChanges.cend(); ++it) {
+            emit friendStatusChanged(it.key(), it.value());
+        }
+        emit friendStatusesChanged(pendingStatusChanges);
+        pendingStatusChanges.clear();
+    }
+
+    if (!pendingTypingChanges.isEmpty()) {
+        for (auto it = pendingTypingChanges.cbegin(); it != pendingTypingChanges.cend(); ++it) {
+            emit friendTypingChanged(it.key(), it.value());
+        }
+        emit friendTypingStatesChanged(pendingTypingChanges);
+        pendingTypingChanges.clear();
+    }
+
+    if (!pendingReceipts.isEmpty()) {
+        // The per-receipt signal stays available but has no connected
+        // consumers in-tree, so emitting it inside the loop costs nothing
+        for (auto it = pendingReceipts.cbegin(); it != pendingReceipts.cend(); ++it) {
+            for (const ReceiptNum receipt : it.value()) {
+                emit receiptReceived(it.key(), receipt);
+            }
+        }
+        emit receiptsReceived(pendingReceipts);
+        pendingReceipts.clear();
+    }
+}
+
 /**
  * @brief Connects us to the Tox network
  */
@@ -370,17 +432,20 @@ void Core::bootstrapDht()
     ASSERT_CORE_THREAD;
 
 
-    const auto shuffledBootstrapNodes =
-        shuffleBootstrapNodes(bootstrapListGenerator.getBootstrapNodes());
-    if (shuffledBootstrapNodes.empty()) {
+    // The generator ranks previously fast nodes first and shuffles the rest
+    const auto bootstrapNodes = bootstrapListGenerator.getBootstrapNodes();
+    if (bootstrapNodes.empty()) {
         qWarning() << "No bootstrap node list";
         return;
     }
 
-    // i think the more we bootstrap, the more we jitter because the more we overwrite nodes
-    auto numNewNodes = 2;
-    for (int i = 0; i < numNewNodes && i < shuffledBootstrapNodes.size(); ++i) {
-        const auto& dhtServer = shuffledBootstrapNodes.at(i);
+    // We only land here while disconnected, so racing a few attempts doesn't
+    // jitter an established DHT position and cuts cold start on slow nodes
+    auto numNewNodes = 4;
+    pendingBootstrapNodes.clear();
+    bootstrapTimer.start();
+    for (int i = 0; i < numNewNodes && i < bootstrapNodes.size(); ++i) {
+        const auto& dhtServer = bootstrapNodes.at(i);
         QByteArray address;
         if (!dhtServer.ipv4.isEmpty()) {
             address = dhtServer.ipv4.toLatin1();
@@ -393,6 +458,7 @@ void Core::bootstrapDht()
 
         ToxPk pk{dhtServer.publicKey};
         qDebug() << "Connecting to bootstrap node" << pk.toString();
+        pendingBootstrapNodes.append(pk);
         const uint8_t* pkPtr = pk.getData();
 
         Tox_Err_Bootstrap error;
@@ -413,8 +479,9 @@ void Core::onFriendRequest(Tox* tox, const uint8_t* cFriendPk, const uint8_t* cM
                            size_t cMessageSize, void* core)
 {
     std::ignore = tox;
+    static_cast<Core*>(core)->metrics.countCallback(CoreMetrics::Callback::FriendRequest);
     ToxPk friendPk(cFriendPk);
-    QString requestMessage = ToxString(cMessage, cMessageSize).getQString();
+    QString requestMessage = ToxString::toQString(cMessage, cMessageSize);
     emit static_cast<Core*>(core)->friendRequestReceived(friendPk, requestMessage);
 }
 
@@ -422,8 +489,9 @@ void Core::onFriendMessage(Tox* tox, uint32_t friendId, Tox_Message_Type type,
                            const uint8_t* cMessage, size_t cMessageSize, void* core)
 {
     std::ignore = tox;
+    static_cast<Core*>(core)->metrics.countCallback(CoreMetrics::Callback::FriendMessage);
     bool isAction = (type == TOX_MESSAGE_TYPE_ACTION);
-    QString msg = ToxString(cMessage, cMessageSize).getQString();
+    QString msg = ToxString::toQString(cMessage, cMessageSize);
     emit static_cast<Core*>(core)->friendMessageReceived(friendId, msg, isAction);
 }
 
@@ -431,7 +499,8 @@ void Core::onFriendNameChange(Tox* tox, uint32_t friendId, const uint8_t* cName,
                               void* core)
 {
     std::ignore = tox;
-    QString newName = ToxString(cName, cNameSize).getQString();
+    static_cast<Core*>(core)->metrics.countCallback(CoreMetrics::Callback::FriendName);
+    QString newName = ToxString::toQString(cName, cNameSize);
     // no saveRequest, this callback is called on every connection, not just on name change
     emit static_cast<Core*>(core)->friendUsernameChanged(friendId, newName);
 }
@@ -439,14 +508,16 @@ void Core::onFriendNameChange(Tox* tox, uint32_t friendId, const uint8_t* cName,
 void Core::onFriendTypingChange(Tox* tox, uint32_t friendId, bool isTyping, void* core)
 {
     std::ignore = tox;
-    emit static_cast<Core*>(core)->friendTypingChanged(friendId, isTyping);
+    static_cast<Core*>(core)->metrics.countCallback(CoreMetrics::Callback::FriendTyping);
+    static_cast<Core*>(core)->pendingTypingChanges[friendId] = isTyping;
 }
 
 void Core::onStatusMessageChanged(Tox* tox, uint32_t friendId, const uint8_t* cMessage,
                                   size_t cMessageSize, void* core)
 {
     std::ignore = tox;
-    QString message = ToxString(cMessage, cMessageSize).getQString();
+    static_cast<Core*>(core)->metrics.countCallback(CoreMetrics::Callback::StatusMessage);
+    QString message = ToxString::toQString(cMessage, cMessageSize);
     // no saveRequest, this callback is called on every connection, not just on name change
     emit static_cast<Core*>(core)->friendStatusMessageChanged(friendId, message);
 }
@@ -454,6 +525,7 @@ void Core::onStatusMessageChanged(Tox* tox, uint32_t friendId, const uint8_t* cM
 void Core::onUserStatusChanged(Tox* tox, uint32_t friendId, Tox_User_Status userstatus, void* core)
 {
     std::ignore = tox;
+    static_cast<Core*>(core)->metrics.countCallback(CoreMetrics::Callback::UserStatus);
     Status::Status status;
     switch (userstatus) {
     case TOX_USER_STATUS_AWAY:
@@ -470,13 +542,14 @@ void Core::onUserStatusChanged(Tox* tox, uint32_t friendId, Tox_User_Status user
     }
 
     // no saveRequest, this callback is called on every connection, not just on name change
-    emit static_cast<Core*>(core)->friendStatusChanged(friendId, status);
+    static_cast<Core*>(core)->pendingStatusChanges[friendId] = status;
 }
 
 void Core::onConnectionStatusChanged(Tox* tox, uint32_t friendId, Tox_Connection status, void* vCore)
 {
     std::ignore = tox;
     Core* core = static_cast<Core*>(vCore);
+    core->metrics.countCallback(CoreMetrics::Callback::FriendConnectionStatus);
     Status::Status friendStatus = Status::Status::Offline;
     switch (status) {
     case TOX_CONNECTION_NONE:
@@ -499,7 +572,7 @@ void Core::onConnectionStatusChanged(Tox* tox, uint32_t friendId, Tox_Connection
     // Ignore Online because it will be emitted from onUserStatusChanged
     bool isOffline = friendStatus == Status::Status::Offline;
     if (isOffline) {
-        emit core->friendStatusChanged(friendId, friendStatus);
+        core->pendingStatusChanges[friendId] = friendStatus;
         core->checkLastOnline(friendId);
     }
 }
@@ -509,6 +582,7 @@ void Core::onConferenceInvite(Tox* tox, uint32_t friendId, Tox_Conference_Type t
 {
     std::ignore = tox;
     Core* core = static_cast<Core*>(vCore);
+    core->metrics.countCallback(CoreMetrics::Callback::ConferenceInvite);
     const QByteArray data(reinterpret_cast<const char*>(cookie), length);
     const ConferenceInvite inviteInfo(friendId, type, data);
     switch (type) {
@@ -532,8 +606,9 @@ void Core::onConferenceMessage(Tox* tox, uint32_t conferenceId, uint32_t peerId,
 {
     std::ignore = tox;
     Core* core = static_cast<Core*>(vCore);
+    core->metrics.countCallback(CoreMetrics::Callback::ConferenceMessage);
     bool isAction = type == TOX_MESSAGE_TYPE_ACTION;
-    QString message = ToxString(cMessage, length).getQString();
+    QString message = ToxString::toQString(cMessage, length);
     emit core->conferenceMessageReceived(conferenceId, peerId, message, isAction);
 }
 
@@ -541,6 +616,7 @@ void Core::onConferencePeerListChange(Tox* tox, uint32_t conferenceId, void* vCo
 {
     std::ignore = tox;
     const auto core = static_cast<Core*>(vCore);
+    core->metrics.countCallback(CoreMetrics::Callback::ConferencePeerListChange);
     qDebug("Conference %d peerlist changed", conferenceId);
     // no saveRequest, this callback is called on every connection to conference peer, not just on brand new peers
     emit core->conferencePeerlistChanged(conferenceId);
@@ -550,9 +626,10 @@ void Core::onConferencePeerNameChange(Tox* tox, uint32_t conferenceId, uint32_t
                                       const uint8_t* name, size_t length, void* vCore)
 {
     std::ignore = tox;
-    const auto newName = ToxString(name, length).getQString();
+    const auto newName = ToxString::toQString(name, length);
     qDebug().nospace() << "Conference " << conferenceId << ", peer " << peerId << ", name " << newName;
     auto* core = static_cast<Core*>(vCore);
+    core->metrics.countCallback(CoreMetrics::Callback::ConferencePeerName);
     auto peerPk = core->getConferencePeerPk(conferenceId, peerId);
     emit core->conferencePeerNameChanged(conferenceId, peerPk, newName);
 }
@@ -562,20 +639,22 @@ void Core::onConferenceTitleChange(Tox* tox, uint32_t conferenceId, uint32_t pee
 {
     std::ignore = tox;
     Core* core = static_cast<Core*>(vCore);
+    core->metrics.countCallback(CoreMetrics::Callback::ConferenceTitle);
     QString author;
     // from tox.h: "If peer_number == UINT32_MAX, then author is unknown (e.g. initial joining the conference)."
     if (peerId != std::numeric_limits<uint32_t>::max()) {
         author = core->getConferencePeerName(conferenceId, peerId);
     }
     emit core->saveRequest();
-    emit core->conferenceTitleChanged(conferenceId, author, ToxString(cTitle, length).getQString());
+    emit core->conferenceTitleChanged(conferenceId, author, ToxString::toQString(cTitle, length));
 }
 
 
 void Core::onReadReceiptCallback(Tox* tox, uint32_t friendId, uint32_t receipt, void* core)
 {
     std::ignore = tox;
-    emit static_cast<Core*>(core)->receiptReceived(friendId, ReceiptNum{receipt});
+    static_cast<Core*>(core)->metrics.countCallback(CoreMetrics::Callback::ReadReceipt);
+    static_cast<Core*>(core)->pendingReceipts[friendId].append(ReceiptNum{receipt});
 }
 
 void Core::acceptFriendRequest(const ToxPk& friendPk)
@@ -651,16 +730,16 @@ void Core::requestFriendship(const ToxId& friendId, const QString& message)
 bool Core::sendMessageWithType(uint32_t friendId, const QString& message, Tox_Message_Type type,
                                ReceiptNum& receipt)
 {
-    int size = message.toUtf8().size();
-    auto maxSize = static_cast<int>(getMaxMessageSize());
-    if (size > maxSize) {
+    // Encode once; the size check reuses the bytes that go out on the wire
+    ToxString cMessage(message.toUtf8());
+    auto maxSize = getMaxMessageSize();
+    if (cMessage.size() > maxSize) {
         assert(false);
-        qCritical() << "Core::sendMessageWithType called with message of size:" << size
+        qCritical() << "Core::sendMessageWithType called with message of size:" << cMessage.size()
                     << "when max is:" << maxSize << ". Ignoring.";
         return false;
     }
 
-    ToxString cMessage(message);
     Tox_Err_Friend_Send_Message error;
     receipt = ReceiptNum{tox_friend_send_message(tox.get(), friendId, type, cMessage.data(),
                                                  cMessage.size(), &error)};
@@ -697,15 +776,14 @@ void Core::sendConferenceMessageWithType(int conferenceId, const QString& messag
 {
     QMutexLocker<QRecursiveMutex> ml{&coreLoopLock};
 
-    int size = message.toUtf8().size();
-    auto maxSize = static_cast<int>(getMaxMessageSize());
-    if (size > maxSize) {
-        qCritical() << "Core::sendMessageWithType called with message of size:" << size
+    ToxString cMsg(message.toUtf8());
+    auto maxSize = getMaxMessageSize();
+    if (cMsg.size() > maxSize) {
+        qCritical() << "Core::sendMessageWithType called with message of size:" << cMsg.size()
                     << "when max is:" << maxSize << ". Ignoring.";
         return;
     }
 
-    ToxString cMsg(message);
     Tox_Err_Conference_Send_Message error;
     tox_conference_send_message(tox.get(), conferenceId, type, cMsg.data(), cMsg.size(), &error);
     if (!PARSE_ERR(error)) {
@@ -728,6 +806,17 @@ void Core::sendConferenceAction(int conferenceId, const QString& message)
     sendConferenceMessageWithType(conferenceId, message, TOX_MESSAGE_TYPE_ACTION);
 }
 
+void Core::sendConferenceMessageBatch(int conferenceId, bool isAction, const QStringList& parts)
+{
+    // Take the core lock once for the whole batch instead of once per part
+    QMutexLocker<QRecursiveMutex> ml{&coreLoopLock};
+
+    const auto type = isAction ? TOX_MESSAGE_TYPE_ACTION : TOX_MESSAGE_TYPE_NORMAL;
+    for (const QString& part : parts) {
+        sendConferenceMessageWithType(conferenceId, part, type);
+    }
+}
+
 void Core::changeConferenceTitle(uint32_t conferenceId, const QString& title)
 {
     QMutexLocker<QRecursiveMutex> ml{&coreLoopLock};
@@ -794,7 +883,7 @@ QString Core::getUsername() const
     }
     std::vector<uint8_t> nameBuf(size);
     tox_self_get_name(tox.get(), nameBuf.data());
-    return ToxString(nameBuf.data(), size).getQString();
+    return ToxString::toQString(nameBuf.data(), size);
 }
 
 void Core::setUsername(const QString& username)
@@ -876,7 +965,7 @@ QString Core::getStatusMessage() const
     }
     std::vector<uint8_t> nameBuf(size);
     tox_self_get_status_message(tox.get(), nameBuf.data());
-    return ToxString(nameBuf.data(), size).getQString();
+    return ToxString::toQString(nameBuf.data(), size);
 }
 
 /**
@@ -976,7 +1065,7 @@ void Core::loadFriends()
             std::vector<uint8_t> messageData(statusMessageSize);
             tox_friend_get_status_message(tox.get(), ids[i], messageData.data(), &queryError);
             QString friendStatusMessage =
-                ToxString(messageData.data(), statusMessageSize).getQString();
+                ToxString::toQString(messageData.data(), statusMessageSize);
             emit friendStatusMessageChanged(ids[i], friendStatusMessage);
         }
         checkLastOnline(ids[i]);
@@ -1006,7 +1095,7 @@ void Core::loadConferences()
             std::vector<uint8_t> nameBuf(titleSize);
             tox_conference_get_title(tox.get(), conferenceNumber, nameBuf.data(), &error);
             if (PARSE_ERR(error)) {
-                name = ToxString(nameBuf.data(), titleSize).getQString();
+                name = ToxString::toQString(nameBuf.data(), titleSize);
             } else {
                 name = defaultName;
             }
@@ -1096,7 +1185,7 @@ QString Core::getConferencePeerName(int conferenceId, int peerId) const
         return QString{};
     }
 
-    return ToxString(nameBuf.data(), length).getQString();
+    return ToxString::toQString(nameBuf.data(), length);
 }
 
 /**
@@ -1144,7 +1233,7 @@ QStringList Core::getConferencePeerNames(int conferenceId) const
         std::vector<uint8_t> nameBuf(length);
         tox_conference_peer_get_name(tox.get(), conferenceId, i, nameBuf.data(), &error);
         if (PARSE_ERR(error)) {
-            names.append(ToxString(nameBuf.data(), length).getQString());
+            names.append(ToxString::toQString(nameBuf.data(), length));
         } else {
             names.append(QString());
         }
@@ -1317,7 +1406,7 @@ QString Core::getFriendUsername(uint32_t friendNumber) const
     if (!PARSE_ERR(error)) {
         return QString();
     }
-    return ToxString(nameBuf.data(), nameSize).getQString();
+    return ToxString::toQString(nameBuf.data(), nameSize);
 }
 
 uint64_t Core::getMaxMessageSize() const
@@ -1359,7 +1448,7 @@ QString Core::getPeerName(const ToxPk& id) const
         return {};
     }
 
-    return ToxString(nameBuf.data(), nameSize).getQString();
+    return ToxString::toQString(nameBuf.data(), nameSize);
 }
 
 /**
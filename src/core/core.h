@@ -7,6 +7,7 @@
 #pragma once
 
 #include "conferenceid.h"
+#include "coremetrics.h"
 #include "icoreconferencemessagesender.h"
 #include "icoreconferencequery.h"
 #include "icorefriendmessagesender.h"
@@ -20,6 +21,8 @@
 #include "util/strongtype.h"
 #include <tox/tox.h>
 
+#include <QElapsedTimer>
+#include <QHash>
 #include <QMutex>
 #include <QObject>
 #include <QThread>
@@ -66,6 +69,7 @@ public:
     CoreFile* getCoreFile() const;
     Tox* getTox() const;
     QRecursiveMutex& getCoreLoopLock() const;
+    const CoreMetrics& getMetrics() const;
 
     ~Core();
 
@@ -116,6 +120,8 @@ public slots:
     bool sendMessage(uint32_t friendId, const QString& message, ReceiptNum& receipt) override;
     void sendConferenceMessage(int conferenceId, const QString& message) override;
     void sendConferenceAction(int conferenceId, const QString& message) override;
+    void sendConferenceMessageBatch(int conferenceId, bool isAction,
+                                    const QStringList& parts) override;
     void changeConferenceTitle(uint32_t conferenceId, const QString& title);
     bool sendAction(uint32_t friendId, const QString& action, ReceiptNum& receipt) override;
     void sendTyping(uint32_t friendId, bool typing);
@@ -160,6 +166,13 @@ signals:
     void friendUsernameChanged(uint32_t friendId, const QString& username);
     void friendTypingChanged(uint32_t friendId, bool isTyping);
 
+    // Per-tick batches of friendStatusChanged/friendTypingChanged, coalesced
+    // newest-wins per friend on the core thread. GUI consumers subscribe to
+    // these so a reconnect storm crosses the thread boundary as one queued
+    // event per tick instead of one per callback.
+    void friendStatusesChanged(const QHash<uint32_t, Status::Status>& statuses);
+    void friendTypingStatesChanged(const QHash<uint32_t, bool>& typingStates);
+
     void friendRemoved(uint32_t friendId);
     void friendLastSeenChanged(uint32_t friendId, const QDateTime& dateTime);
 
@@ -173,12 +186,12 @@ signals:
     void conferencePeerNameChanged(uint32_t conferencenumber, const ToxPk& peerPk,
                                    const QString& newName);
     void conferenceTitleChanged(uint32_t conferencenumber, const QString& author, const QString& title);
-    void conferencePeerAudioPlaying(uint32_t conferencenumber, ToxPk peerPk);
     void conferenceSentFailed(uint32_t conferenceId);
     void conferenceJoined(uint32_t conferencenumber, ConferenceId conferenceId);
     void actionSentResult(uint32_t friendId, const QString& action, int success);
 
     void receiptReceived(uint32_t friendId, ReceiptNum receipt);
+    void receiptsReceived(const QHash<uint32_t, QList<ReceiptNum>>& receipts);
 
     void failedToRemoveFriend(uint32_t friendId);
 
@@ -223,6 +236,7 @@ private:
     void bootstrapDht();
 
     void checkLastOnline(uint32_t friendId);
+    void flushPendingStateChanges();
 
     QString getFriendRequestErrorMessage(const ToxId& friendId, const QString& message) const;
     static void registerCallbacks(Tox* tox);
@@ -258,8 +272,24 @@ private:
     mutable QRecursiveMutex coreLoopLock;
 
     std::unique_ptr<QThread> coreThread;
-    const IBootstrapListGenerator& bootstrapListGenerator;
+    IBootstrapListGenerator& bootstrapListGenerator;
     const ICoreSettings& settings;
+    // Event loop counters, written from the core thread and sampled by the
+    // debug UI
+    CoreMetrics metrics;
     bool isConnected = false;
+    Tox_Connection lastConnectionMode = TOX_CONNECTION_NONE;
     int tolerance = CORE_DISCONNECT_TOLERANCE;
+    // Friend state changes accumulated during one tox_iterate(), newest
+    // wins; process() flushes them into the batched signals
+    QHash<uint32_t, Status::Status> pendingStatusChanges;
+    QHash<uint32_t, bool> pendingTypingChanges;
+    // Unlike the state maps, every receipt matters, so these accumulate
+    // rather than overwrite; a reconnect confirming thousands of messages
+    // then costs one queued event instead of one per receipt
+    QHash<uint32_t, QList<ReceiptNum>> pendingReceipts;
+    // Nodes of the bootstrap attempt in flight and when it started, used to
+    // credit them with the observed connect time once we get online
+    QList<ToxPk> pendingBootstrapNodes;
+    QElapsedTimer bootstrapTimer;
 };
@@ -13,17 +13,22 @@
 #include "src/video/corevideosource.h"
 #include "src/video/videoframe.h"
 #include "util/algorithm.h"
+#include "util/threadplacement.h"
 #include "util/toxcoreerrorparser.h"
 
 #include <QCoreApplication>
 #include <QDebug>
+#include <QStringList>
 #include <QThread>
 #include <QTimer>
 #include <QtConcurrent/QtConcurrentRun>
 
 #include <tox/toxav.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdlib>
 
 /**
  * @fn void CoreAV::avInvite(uint32_t friendId, bool video)
@@ -85,7 +90,21 @@ CoreAV::CoreAV(std::unique_ptr<ToxAV, ToxAVDeleter> toxav_, QRecursiveMutex& tox
 
     connect(iterateTimer, &QTimer::timeout, this, &CoreAV::process);
     connect(coreAvThread.get(), &QThread::finished, iterateTimer, &QTimer::stop);
+    connect(coreAvThread.get(), &QThread::started, this,
+            [] { ThreadPlacement::registerCurrentThread(QStringLiteral("CoreAV")); });
     connect(coreAvThread.get(), &QThread::started, this, &CoreAV::process);
+
+#if TOXAV_VERSION_IS_API_COMPATIBLE(0, 2, 13)
+    videoIterateTimer = new QTimer{this};
+    assert(videoIterateTimer);
+    videoIterateTimer->setSingleShot(true);
+
+    connect(videoIterateTimer, &QTimer::timeout, this, &CoreAV::processVideo);
+    connect(coreAvThread.get(), &QThread::finished, videoIterateTimer, &QTimer::stop);
+    connect(coreAvThread.get(), &QThread::started, this, &CoreAV::processVideo);
+#endif
+
+    statsReportTimer.start();
 }
 
 void CoreAV::connectCallbacks()
@@ -169,14 +188,108 @@ CoreAV::~CoreAV()
  */
 void CoreAV::start()
 {
-    coreAvThread->start();
+    // Elevated so a busy GUI or worker pool doesn't delay call iteration;
+    // a scheduler hint only, no core pinning (see ThreadPlacement)
+    coreAvThread->start(QThread::HighPriority);
 }
 
 void CoreAV::process()
 {
     assert(QThread::currentThread() == coreAvThread.get());
+
+    QElapsedTimer timer;
+    timer.start();
+
+#if TOXAV_VERSION_IS_API_COMPATIBLE(0, 2, 13)
+    toxav_audio_iterate(toxav.get());
+    const qint64 interval = toxav_audio_iteration_interval(toxav.get());
+#else
     toxav_iterate(toxav.get());
-    iterateTimer->start(toxav_iteration_interval(toxav.get()));
+    const qint64 interval = toxav_iteration_interval(toxav.get());
+#endif
+
+    audioIterationStats.record(timer.elapsed(), interval);
+    maybeReportIterationStats();
+    iterateTimer->start(static_cast<int>(interval));
+}
+
+#if TOXAV_VERSION_IS_API_COMPATIBLE(0, 2, 13)
+void CoreAV::processVideo()
+{
+    assert(QThread::currentThread() == coreAvThread.get());
+
+    QElapsedTimer timer;
+    timer.start();
+
+    toxav_video_iterate(toxav.get());
+    const qint64 interval = toxav_video_iteration_interval(toxav.get());
+
+    videoIterationStats.record(timer.elapsed(), interval);
+    videoIterateTimer->start(static_cast<int>(interval));
+}
+#endif
+
+void CoreAV::IterationStats::record(qint64 elapsedMs, qint64 budgetMs)
+{
+    size_t bucket = 0;
+    while (bucket < bucketBoundsMs.size() && elapsedMs > bucketBoundsMs[bucket]) {
+        ++bucket;
+    }
+    ++buckets[bucket];
+
+    ++iterations;
+    if (elapsedMs > budgetMs) {
+        ++overruns;
+    }
+    worstMs = qMax(worstMs, elapsedMs);
+}
+
+QString CoreAV::IterationStats::summary() const
+{
+    QStringList parts;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        const QString bound = i < bucketBoundsMs.size()
+                                  ? QStringLiteral("<=%1ms").arg(bucketBoundsMs[i])
+                                  : QStringLiteral(">%1ms").arg(bucketBoundsMs.back());
+        parts += QStringLiteral("%1: %2").arg(bound).arg(buckets[i]);
+    }
+
+    return QStringLiteral("%1 iterations, %2 over budget, worst %3ms (%4)")
+        .arg(iterations)
+        .arg(overruns)
+        .arg(worstMs)
+        .arg(parts.join(QStringLiteral(", ")));
+}
+
+/**
+ * @brief Logs the iteration histograms every 30 seconds while a call is active.
+ *
+ * The summaries land in the log file and so in the debug log window; watching
+ * the overrun count there is how to tell whether the iteration loop keeps up
+ * with many concurrent calls.
+ */
+void CoreAV::maybeReportIterationStats()
+{
+    constexpr qint64 reportIntervalMs = 30 * 1000;
+
+    if (statsReportTimer.elapsed() < reportIntervalMs) {
+        return;
+    }
+    statsReportTimer.restart();
+
+    if (isAnyCallActive()) {
+        qDebug().noquote() << "toxav audio iteration:" << audioIterationStats.summary();
+#if TOXAV_VERSION_IS_API_COMPATIBLE(0, 2, 13)
+        qDebug().noquote() << "toxav video iteration:" << videoIterationStats.summary();
+#endif
+    }
+
+    // Each report covers only its own window, so a transient hiccup does not
+    // taint the histogram forever
+    audioIterationStats = {};
+#if TOXAV_VERSION_IS_API_COMPATIBLE(0, 2, 13)
+    videoIterationStats = {};
+#endif
 }
 
 /**
@@ -251,6 +364,7 @@ bool CoreAV::answerCall(uint32_t friendNum, bool video)
     const uint32_t videoBitrate = video ? VIDEO_DEFAULT_BITRATE : 0;
     if (toxav_answer(toxav.get(), friendNum, audioSettings.getAudioBitrate(), videoBitrate, &err)) {
         it->second->setActive(true);
+        it->second->setVideoBitrate(videoBitrate);
         return true;
     } else {
         qWarning() << "Failed to answer call with error" << err;
@@ -285,6 +399,7 @@ bool CoreAV::startCall(uint32_t friendNum, bool video)
     assert(audio != nullptr);
     ToxFriendCallPtr call =
         ToxFriendCallPtr(new ToxFriendCall(friendNum, video, *this, *audio, cameraSource));
+    call->setVideoBitrate(videoBitrate);
     // Call object must be owned by this thread or there will be locking problems with Audio
     call->moveToThread(thread());
     assert(call != nullptr);
@@ -332,7 +447,7 @@ void CoreAV::timeoutCall(uint32_t friendNum)
  * @return False only on error, but not if there's nothing to send.
  */
 bool CoreAV::sendCallAudio(uint32_t callId, const int16_t* pcm, size_t samples, uint8_t chans,
-                           uint32_t rate) const
+                           uint32_t rate)
 {
     QReadLocker locker{&callsLock};
 
@@ -341,7 +456,7 @@ bool CoreAV::sendCallAudio(uint32_t callId, const int16_t* pcm, size_t samples,
         return false;
     }
 
-    const ToxFriendCall& call = *it->second;
+    ToxFriendCall& call = *it->second;
 
     if (call.getMuteMic() || !call.isActive()
         || !(call.getState() & TOXAV_FRIEND_CALL_STATE_ACCEPTING_A)) {
@@ -365,9 +480,28 @@ bool CoreAV::sendCallAudio(uint32_t callId, const int16_t* pcm, size_t samples,
         qDebug() << "toxav_audio_send_frame error: Lock busy, dropping frame";
     }
 
+    maybeSampleCallQuality(callId, call);
+
     return true;
 }
 
+/**
+ * @brief Emits a periodic quality sample for the connection quality log.
+ *
+ * Piggybacks on the audio send path, which runs steadily for the whole call,
+ * so the sampling needs no timer of its own and stops with the call.
+ */
+void CoreAV::maybeSampleCallQuality(uint32_t callId, ToxFriendCall& call)
+{
+    if (call.msSinceQualitySample() < QUALITY_SAMPLE_INTERVAL_MS) {
+        return;
+    }
+
+    call.restartQualitySampleTimer();
+    emit callQualitySampled(callId, call.getRecommendedAudioBitrate(), call.getVideoBitrate(),
+                            static_cast<quint32>(call.takeDroppedFrameSample()));
+}
+
 void CoreAV::sendCallVideo(uint32_t callId, std::shared_ptr<VideoFrame> vframe)
 {
     QWriteLocker locker{&callsLock};
@@ -381,8 +515,21 @@ void CoreAV::sendCallVideo(uint32_t callId, std::shared_ptr<VideoFrame> vframe)
 
     ToxFriendCall& call = *it->second;
 
-    if (!call.getVideoEnabled() || !call.isActive()
-        || !(call.getState() & TOXAV_FRIEND_CALL_STATE_ACCEPTING_V)) {
+    if (!call.getVideoEnabled()) {
+        return;
+    }
+
+    if (!call.isActive()) {
+        // The call is still ringing but the camera is already capturing.
+        // Convert the frame and drop the result: this primes the thread-local
+        // scaler context and the shared buffer pool for the send geometry, so
+        // the first frame after accept converts at steady-state speed instead
+        // of paying scaler setup and a multi-megabyte allocation
+        std::ignore = vframe->toToxYUVFrame();
+        return;
+    }
+
+    if (!(call.getState() & TOXAV_FRIEND_CALL_STATE_ACCEPTING_V)) {
         return;
     }
 
@@ -395,6 +542,9 @@ void CoreAV::sendCallVideo(uint32_t callId, std::shared_ptr<VideoFrame> vframe)
             return;
         }
         call.setNullVideoBitrate(false);
+        call.setVideoBitrate(VIDEO_DEFAULT_BITRATE);
+    } else {
+        adaptVideoBitrate(callId, call);
     }
 
     auto [frame, frameLocker] = vframe->toToxYUVFrame();
@@ -423,6 +573,46 @@ void CoreAV::sendCallVideo(uint32_t callId, std::shared_ptr<VideoFrame> vframe)
     }
 }
 
+/**
+ * @brief Steps the outgoing video bitrate of a call before a frame is sent.
+ *
+ * Follows the recommendation recorded by the congestion callback, and when
+ * the link has stayed quiet for a probe interval, steps a lowered bitrate
+ * back up toward the default so a transient dip doesn't pin the call at a
+ * bad quality for its whole duration.
+ */
+void CoreAV::adaptVideoBitrate(uint32_t callId, ToxFriendCall& call)
+{
+    uint32_t current = call.getVideoBitrate();
+    if (current == 0) {
+        // Never adjusted since toxav_call/toxav_answer set the default
+        current = VIDEO_DEFAULT_BITRATE;
+    }
+
+    uint32_t target = current;
+    const uint32_t recommended = call.takeRecommendedVideoBitrate();
+    if (recommended != 0) {
+        target = recommended;
+    } else if (current < VIDEO_DEFAULT_BITRATE
+               && call.msSinceVideoBitrateChange() >= VIDEO_BITRATE_PROBE_INTERVAL_MS) {
+        target = qMin(current + VIDEO_BITRATE_PROBE_STEP, VIDEO_DEFAULT_BITRATE);
+    }
+
+    if (target == current) {
+        return;
+    }
+
+    QMutexLocker<QRecursiveMutex> coreLocker{&coreLock};
+    Toxav_Err_Bit_Rate_Set err;
+    toxav_video_set_bit_rate(toxav.get(), callId, target, &err);
+    if (!PARSE_ERR(err)) {
+        return;
+    }
+
+    qDebug() << "Video bitrate with" << callId << "stepped from" << current << "to" << target;
+    call.setVideoBitrate(target);
+}
+
 /**
  * @brief Toggles the mute state of the call's input (microphone).
  * @param f The friend assigned to the call
@@ -489,7 +679,32 @@ void CoreAV::conferenceCallCallback(void* tox, uint32_t conference, uint32_t pee
         return;
     }
 
-    emit c->conferencePeerAudioPlaying(conference, peerPk);
+    /*
+     * One pass over the PCM for the speaking indicators: a plain
+     * multiply-accumulate over int16 samples that the compiler vectorizes.
+     * The result lands in a snapshot the conference form drains at its own
+     * cadence, replacing the queued cross-thread signal this used to emit
+     * per decoded frame.
+     */
+    const size_t totalSamples = static_cast<size_t>(samples) * channels;
+    if (totalSamples > 0) {
+        int64_t sumOfSquares = 0;
+        int32_t peakAmplitude = 0;
+        for (size_t i = 0; i < totalSamples; ++i) {
+            const int32_t sample = data[i];
+            sumOfSquares += sample * sample;
+            peakAmplitude = std::max(peakAmplitude, std::abs(sample));
+        }
+
+        const float rms =
+            std::sqrt(static_cast<float>(sumOfSquares) / totalSamples) / -INT16_MIN;
+        const float peakLevel = static_cast<float>(peakAmplitude) / -INT16_MIN;
+
+        QMutexLocker<QMutex> levelLocker{&cav->conferenceAudioLevelsLock};
+        PeerAudioLevel& level = cav->conferenceAudioLevels[static_cast<int>(conference)][peerPk];
+        level.rms = std::max(level.rms, rms);
+        level.peak = std::max(level.peak, peakLevel);
+    }
 
     auto it = cav->conferenceCalls.find(conference);
     if (it == cav->conferenceCalls.end()) {
@@ -585,6 +800,20 @@ void CoreAV::leaveConferenceCall(int conferenceNum)
     qDebug() << "Leaving conference call" << conferenceNum;
 
     conferenceCalls.erase(conferenceNum);
+
+    QMutexLocker<QMutex> levelLocker{&conferenceAudioLevelsLock};
+    conferenceAudioLevels.remove(conferenceNum);
+}
+
+/**
+ * @brief Drains the speaking levels recorded for a conference since the last poll.
+ * @param conferenceNum the conference number to drain levels for.
+ * @return per-peer levels covering the audio decoded since the previous call.
+ */
+QHash<ToxPk, CoreAV::PeerAudioLevel> CoreAV::takeConferenceAudioLevels(int conferenceNum)
+{
+    QMutexLocker<QMutex> locker{&conferenceAudioLevelsLock};
+    return conferenceAudioLevels.take(conferenceNum);
 }
 
 bool CoreAV::sendConferenceCallAudio(int conferenceNum, const int16_t* pcm, size_t samples,
@@ -837,24 +1066,51 @@ void CoreAV::bitrateCallback(ToxAV* toxav, uint32_t friendNum, uint32_t audioRat
              << "- ignoring it";
 }
 
-// This is only a dummy implementation for now
+/**
+ * @brief Records toxav's congestion feedback for the outgoing audio stream.
+ *
+ * The audio stream keeps sending at the configured bitrate — Opus at call
+ * rates is cheap enough — but the recommendation is the closest thing toxav
+ * exposes to a link quality measure, so it is kept for the quality samples.
+ */
 void CoreAV::audioBitrateCallback(ToxAV* toxav, uint32_t friendNum, uint32_t rate, void* vSelf)
 {
     CoreAV* self = static_cast<CoreAV*>(vSelf);
-    std::ignore = self;
     std::ignore = toxav;
 
-    qDebug() << "Recommended audio bitrate with" << friendNum << "is now" << rate << "- ignoring it";
+    QReadLocker locker{&self->callsLock};
+    auto it = self->calls.find(friendNum);
+    if (it == self->calls.end()) {
+        return;
+    }
+
+    it->second->setRecommendedAudioBitrate(rate);
+    qDebug() << "Recommended audio bitrate with" << friendNum << "is now" << rate;
 }
 
-// This is only a dummy implementation for now
+/**
+ * @brief Records toxav's congestion feedback for the outgoing video stream.
+ *
+ * toxav lowers its recommendation when packets start queuing on the link.
+ * The clamped value is only recorded here; adaptVideoBitrate() applies it on
+ * the next frame send, which already takes the locks toxav_video_set_bit_rate
+ * needs, so nothing has to lock inside this callback.
+ */
 void CoreAV::videoBitrateCallback(ToxAV* toxav, uint32_t friendNum, uint32_t rate, void* vSelf)
 {
     CoreAV* self = static_cast<CoreAV*>(vSelf);
-    std::ignore = self;
     std::ignore = toxav;
 
-    qDebug() << "Recommended video bitrate with" << friendNum << "is now" << rate << "- ignoring it";
+    QReadLocker locker{&self->callsLock};
+    auto it = self->calls.find(friendNum);
+    if (it == self->calls.end()) {
+        return;
+    }
+
+    const uint32_t clamped = qBound(VIDEO_MIN_BITRATE, rate, VIDEO_DEFAULT_BITRATE);
+    it->second->setRecommendedVideoBitrate(clamped);
+    qDebug() << "Recommended video bitrate with" << friendNum << "is now" << rate << "- targeting"
+             << clamped;
 }
 
 void CoreAV::audioFrameCallback(ToxAV* toxAV, uint32_t friendNum, const int16_t* pcm,
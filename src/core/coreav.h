@@ -8,9 +8,12 @@
 
 #include "src/core/toxcall.h"
 
+#include <QElapsedTimer>
+#include <QHash>
 #include <QMutex>
 #include <QObject>
 #include <QReadWriteLock>
+#include <array>
 #include <atomic>
 #include <memory>
 #include <tox/toxav.h>
@@ -49,7 +52,7 @@ public:
     bool isCallActive(const Conference* c) const;
     bool isCallVideoEnabled(const Friend* f) const;
     bool sendCallAudio(uint32_t callId, const int16_t* pcm, size_t samples, uint8_t chans,
-                       uint32_t rate) const;
+                       uint32_t rate);
     void sendCallVideo(uint32_t callId, std::shared_ptr<VideoFrame> frame);
     bool sendConferenceCallAudio(int conferenceNum, const int16_t* pcm, size_t samples,
                                  uint8_t chans, uint32_t rate) const;
@@ -74,6 +77,18 @@ public:
     void invalidateConferenceCallPeerSource(const Conference& conference, ToxPk peerPk);
     bool isAnyCallActive() const;
 
+    /**
+     * @brief Speaking level of one conference peer, as linear fractions of
+     * full scale in [0, 1].
+     */
+    struct PeerAudioLevel
+    {
+        float rms = 0.f;
+        float peak = 0.f;
+    };
+
+    QHash<ToxPk, PeerAudioLevel> takeConferenceAudioLevels(int conferenceNum);
+
 public slots:
     bool startCall(uint32_t friendNum, bool video);
     bool answerCall(uint32_t friendNum, bool video);
@@ -85,6 +100,14 @@ signals:
     void avInvite(uint32_t friendId, bool video);
     void avStart(uint32_t friendId, bool video);
     void avEnd(uint32_t friendId, bool error = false);
+    /**
+     * @brief Periodic per-call quality reading for the connection quality log.
+     *
+     * Bitrates are in kbit/s; droppedFrames counts outgoing video frames
+     * dropped since the previous sample.
+     */
+    void callQualitySampled(uint32_t friendId, quint32 audioBitrate, quint32 videoBitrate,
+                            quint32 droppedFrames);
 
 private slots:
     static void callCallback(ToxAV* toxAV, uint32_t friendNum, bool audio, bool video, void* self);
@@ -109,6 +132,12 @@ private:
     void connectCallbacks();
 
     void process();
+#if TOXAV_VERSION_IS_API_COMPATIBLE(0, 2, 13)
+    void processVideo();
+#endif
+    void adaptVideoBitrate(uint32_t callId, ToxFriendCall& call);
+    void maybeSampleCallQuality(uint32_t callId, ToxFriendCall& call);
+    void maybeReportIterationStats();
     static void audioFrameCallback(ToxAV* toxAV, uint32_t friendNum, const int16_t* pcm,
                                    size_t sampleCount, uint8_t channels, uint32_t samplingRate,
                                    void* self);
@@ -118,6 +147,32 @@ private:
 
 private:
     static constexpr uint32_t VIDEO_DEFAULT_BITRATE = 2500;
+    // Floor for congestion-driven downgrades, and how the bitrate recovers:
+    // one step up per probe interval without negative feedback
+    static constexpr uint32_t VIDEO_MIN_BITRATE = 200;
+    static constexpr uint32_t VIDEO_BITRATE_PROBE_STEP = 300;
+    static constexpr qint64 VIDEO_BITRATE_PROBE_INTERVAL_MS = 5000;
+    // Cadence of callQualitySampled() emissions per call
+    static constexpr qint64 QUALITY_SAMPLE_INTERVAL_MS = 2000;
+
+    /**
+     * @brief Running histogram of iteration durations against their budget.
+     *
+     * The budget is the interval toxav asked to be iterated at; an iteration
+     * that takes longer than it delays every following one.
+     */
+    struct IterationStats
+    {
+        void record(qint64 elapsedMs, qint64 budgetMs);
+        QString summary() const;
+
+        // Bucket upper bounds in milliseconds; the last bucket is open-ended
+        static constexpr std::array<qint64, 6> bucketBoundsMs{1, 2, 5, 10, 25, 50};
+        std::array<quint64, bucketBoundsMs.size() + 1> buckets{};
+        quint64 iterations = 0;
+        quint64 overruns = 0;
+        qint64 worstMs = 0;
+    };
 
 private:
     // atomic because potentially accessed by different threads
@@ -125,6 +180,14 @@ private:
     std::unique_ptr<ToxAV, ToxAVDeleter> toxav;
     std::unique_ptr<QThread> coreAvThread;
     QTimer* iterateTimer = nullptr;
+#if TOXAV_VERSION_IS_API_COMPATIBLE(0, 2, 13)
+    // Video iteration runs on its own timer so that audio, which is far more
+    // jitter-sensitive, never waits behind video decoding work
+    QTimer* videoIterateTimer = nullptr;
+    IterationStats videoIterationStats;
+#endif
+    IterationStats audioIterationStats;
+    QElapsedTimer statsReportTimer;
     using ToxFriendCallPtr = std::unique_ptr<ToxFriendCall>;
     /**
      * @brief Maps friend IDs to ToxFriendCall.
@@ -143,6 +206,12 @@ private:
     // protect 'calls' and 'conferenceCalls'
     mutable QReadWriteLock callsLock{QReadWriteLock::Recursive};
 
+    // Speaking levels accumulated per decoded conference frame and drained by
+    // the conference form at its own cadence. The lock only ever guards a
+    // hash update or a take(), so the audio path never waits on the GUI
+    QHash<int, QHash<ToxPk, PeerAudioLevel>> conferenceAudioLevels;
+    mutable QMutex conferenceAudioLevelsLock;
+
     /**
      * @brief needed to synchronize with the Core thread, some toxav_* functions
      *        must not execute at the same time as tox_iterate()
@@ -206,6 +206,7 @@ void CoreFile::cancelFileSend(uint32_t friendId, uint32_t fileId)
         return;
     }
     file->status = ToxFile::CANCELED;
+    file->finishHashing();
     emit fileTransferCancelled(*file);
     removeFile(friendId, fileId);
 }
@@ -225,6 +226,7 @@ void CoreFile::cancelFileRecv(uint32_t friendId, uint32_t fileId)
         return;
     }
     file->status = ToxFile::CANCELED;
+    file->finishHashing();
     emit fileTransferCancelled(*file);
     removeFile(friendId, fileId);
 }
@@ -244,6 +246,7 @@ void CoreFile::rejectFileRecvRequest(uint32_t friendId, uint32_t fileId)
         return;
     }
     file->status = ToxFile::CANCELED;
+    file->finishHashing();
     emit fileTransferCancelled(*file);
     removeFile(friendId, fileId);
 }
@@ -303,7 +306,11 @@ void CoreFile::removeFile(uint32_t friendId, uint32_t fileId)
         qWarning() << "removeFile: No such file in queue";
         return;
     }
-    fileMap[key].file->close();
+    ToxFile& file = fileMap[key];
+    if (file.direction == ToxFile::RECEIVING && !file.flushWrites()) {
+        qWarning() << "removeFile: Failed to flush staged data to" << file.fileName;
+    }
+    file.file->close();
     fileMap.remove(key);
 }
 
@@ -466,6 +473,7 @@ void CoreFile::onFileDataCallback(Tox* tox, uint32_t friendId, uint32_t fileId,
     if (!length) {
         file->status = ToxFile::FINISHED;
         if (file->fileKind != TOX_FILE_KIND_AVATAR) {
+            file->finishHashing();
             emit coreFile->fileTransferFinished(*file);
         }
         coreFile->removeFile(friendId, fileId);
@@ -480,11 +488,11 @@ void CoreFile::onFileDataCallback(Tox* tox, uint32_t friendId, uint32_t fileId,
         nread = chunk.size();
         memcpy(data.get(), chunk.data(), nread);
     } else {
-        file->file->seek(pos);
-        nread = file->file->read(reinterpret_cast<char*>(data.get()), length);
+        nread = file->readChunk(pos, data.get(), length);
         if (nread <= 0) {
             qWarning("onFileDataCallback: Failed to read from file");
             file->status = ToxFile::CANCELED;
+            file->finishHashing();
             emit coreFile->fileTransferCancelled(*file);
             Tox_Err_File_Send_Chunk err;
             tox_file_send_chunk(tox, friendId, fileId, pos, nullptr, 0, &err);
@@ -493,12 +501,7 @@ void CoreFile::onFileDataCallback(Tox* tox, uint32_t friendId, uint32_t fileId,
             return;
         }
         file->progress.addSample(file->progress.getBytesSent() + length);
-#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
-        file->hashGenerator->addData(QByteArrayView{data.get(), static_cast<qsizetype>(length)});
-#else
-        file->hashGenerator->addData(
-            QByteArray{reinterpret_cast<const char*>(data.get()), static_cast<qsizetype>(length)});
-#endif
+        // Hashing happens per staging block inside readChunk, off this thread
     }
 
     Tox_Err_File_Send_Chunk err;
@@ -506,7 +509,9 @@ void CoreFile::onFileDataCallback(Tox* tox, uint32_t friendId, uint32_t fileId,
     if (!PARSE_ERR(err)) {
         return;
     }
-    if (file->fileKind != TOX_FILE_KIND_AVATAR) {
+    // Coalesce per-chunk progress into rate-capped updates; the terminal
+    // signals above always carry the final state
+    if (file->fileKind != TOX_FILE_KIND_AVATAR && file->progress.claimUpdate()) {
         emit coreFile->fileTransferInfo(*file);
     }
 }
@@ -529,6 +534,7 @@ void CoreFile::onFileRecvChunkCallback(Tox* tox, uint32_t friendId, uint32_t fil
         qWarning("onFileRecvChunkCallback: Received a chunk out-of-order, aborting transfer");
         if (file->fileKind != TOX_FILE_KIND_AVATAR) {
             file->status = ToxFile::CANCELED;
+            file->finishHashing();
             emit coreFile->fileTransferCancelled(*file);
         }
         Tox_Err_File_Control err;
@@ -548,6 +554,7 @@ void CoreFile::onFileRecvChunkCallback(Tox* tox, uint32_t friendId, uint32_t fil
                 emit core->friendAvatarChanged(core->getFriendPublicKey(friendId), file->avatarData);
             }
         } else {
+            file->finishHashing();
             emit coreFile->fileTransferFinished(*file);
         }
         coreFile->removeFile(friendId, fileId);
@@ -556,18 +563,21 @@ void CoreFile::onFileRecvChunkCallback(Tox* tox, uint32_t friendId, uint32_t fil
 
     if (file->fileKind == TOX_FILE_KIND_AVATAR) {
         file->avatarData.append(reinterpret_cast<const char*>(data), length);
-    } else {
-        file->file->write(reinterpret_cast<const char*>(data), length);
-    }
-    file->progress.addSample(file->progress.getBytesSent() + length);
+        // Avatars are small and their hash is never read back; not worth the
+        // pool round-trip
 #if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
-    file->hashGenerator->addData(QByteArrayView{data, static_cast<qsizetype>(length)});
+        file->hashGenerator->addData(QByteArrayView{data, static_cast<qsizetype>(length)});
 #else
-    file->hashGenerator->addData(
-        QByteArray{reinterpret_cast<const char*>(data), static_cast<qsizetype>(length)});
+        file->hashGenerator->addData(
+            QByteArray{reinterpret_cast<const char*>(data), static_cast<qsizetype>(length)});
 #endif
+    } else {
+        // Hashing rides the staging blocks inside stageWrite, off this thread
+        file->stageWrite(position, data, length);
+    }
+    file->progress.addSample(file->progress.getBytesSent() + length);
 
-    if (file->fileKind != TOX_FILE_KIND_AVATAR) {
+    if (file->fileKind != TOX_FILE_KIND_AVATAR && file->progress.claimUpdate()) {
         emit coreFile->fileTransferInfo(*file);
     }
 }
@@ -587,6 +597,7 @@ void CoreFile::onConnectionStatusChanged(uint32_t friendId, Status::Status state
         if (key >> 32 != friendId)
             continue;
         fileMap[key].status = status;
+        fileMap[key].finishHashing();
         emit fileTransferBrokenUnbroken(fileMap[key], isOffline);
         removeFile(friendId, fileMap[key].fileNum);
     }
@@ -47,15 +47,19 @@ public:
     unsigned corefileIterationInterval();
 
 signals:
-    void fileSendStarted(ToxFile file);
-    void fileReceiveRequested(ToxFile file);
-    void fileTransferAccepted(ToxFile file);
-    void fileTransferCancelled(ToxFile file);
-    void fileTransferFinished(ToxFile file);
-    void fileTransferPaused(ToxFile file);
-    void fileTransferInfo(ToxFile file);
-    void fileTransferRemotePausedUnpaused(ToxFile file, bool paused);
-    void fileTransferBrokenUnbroken(ToxFile file, bool broken);
+    // ToxFile goes out by reference: the queued connections these feed copy
+    // the payload once into the event, instead of once at the emit, once into
+    // the event and once more into every by-value slot. fileTransferInfo in
+    // particular fires per progress tick of every running transfer.
+    void fileSendStarted(const ToxFile& file);
+    void fileReceiveRequested(const ToxFile& file);
+    void fileTransferAccepted(const ToxFile& file);
+    void fileTransferCancelled(const ToxFile& file);
+    void fileTransferFinished(const ToxFile& file);
+    void fileTransferPaused(const ToxFile& file);
+    void fileTransferInfo(const ToxFile& file);
+    void fileTransferRemotePausedUnpaused(const ToxFile& file, bool paused);
+    void fileTransferBrokenUnbroken(const ToxFile& file, bool broken);
     void fileNameChanged(const ToxPk& friendPk);
     void fileSendFailed(uint32_t friendId, const QString& fname);
 
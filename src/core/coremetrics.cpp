@@ -0,0 +1,141 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "coremetrics.h"
+
+#include <QStringBuilder>
+#include <QTextStream>
+
+#include <algorithm>
+
+namespace {
+constexpr std::array<const char*, static_cast<size_t>(CoreMetrics::Callback::Count)> callbackNames = {
+    "friend_request",
+    "friend_message",
+    "friend_name",
+    "friend_typing",
+    "friend_status_message",
+    "friend_status",
+    "friend_connection_status",
+    "friend_read_receipt",
+    "conference_invite",
+    "conference_message",
+    "conference_peer_list_changed",
+    "conference_peer_name",
+    "conference_title",
+};
+
+constexpr std::array<const char*, static_cast<size_t>(CoreMetrics::ConnectionMode::Count)> modeNames = {
+    "none",
+    "tcp",
+    "udp",
+};
+
+QString formatUs(int64_t us)
+{
+    if (us < 0) {
+        return QStringLiteral("n/a");
+    }
+    if (us >= 1000) {
+        return QString::number(us / 1000.0, 'g', 3) % QStringLiteral(" ms");
+    }
+    return QString::number(us) % QStringLiteral(" us");
+}
+} // namespace
+
+int64_t CoreMetrics::Snapshot::iterationPercentileUs(int percentile) const
+{
+    if (iterations == 0) {
+        return -1;
+    }
+
+    const uint64_t rank = (iterations * percentile + 99) / 100;
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < iterationBoundsUs.size(); ++i) {
+        cumulative += iterationBuckets[i];
+        if (cumulative >= rank) {
+            return iterationBoundsUs[i];
+        }
+    }
+    // The percentile falls in the open-ended overflow bucket
+    return -1;
+}
+
+QString CoreMetrics::Snapshot::toString() const
+{
+    QString out;
+    QTextStream stream(&out);
+
+    stream << "tox_iterate: " << iterations << " iterations";
+    if (iterations > 0) {
+        stream << ", mean " << formatUs(iterationTotalUs / iterations);
+        stream << ", p50 <= " << formatUs(iterationPercentileUs(50));
+        stream << ", p90 <= " << formatUs(iterationPercentileUs(90));
+        stream << ", p99 <= " << formatUs(iterationPercentileUs(99));
+    }
+    stream << "\n";
+
+    for (size_t i = 0; i < iterationBuckets.size(); ++i) {
+        if (iterationBuckets[i] == 0) {
+            continue;
+        }
+        QString bound;
+        if (i < iterationBoundsUs.size()) {
+            bound = QStringLiteral("<= ") % formatUs(iterationBoundsUs[i]);
+        } else {
+            bound = QStringLiteral("> ") % formatUs(iterationBoundsUs.back());
+        }
+        stream << "  " << bound << ": " << iterationBuckets[i] << "\n";
+    }
+
+    stream << "callbacks:\n";
+    for (size_t i = 0; i < callbackCounts.size(); ++i) {
+        stream << "  " << callbackNames[i] << ": " << callbackCounts[i] << "\n";
+    }
+
+    stream << "connection changes:\n";
+    for (size_t i = 0; i < connectionChanges.size(); ++i) {
+        stream << "  to " << modeNames[i] << ": " << connectionChanges[i] << "\n";
+    }
+
+    return out;
+}
+
+void CoreMetrics::recordIteration(int64_t durationUs)
+{
+    iterations.fetch_add(1, std::memory_order_relaxed);
+    iterationTotalUs.fetch_add(static_cast<uint64_t>(durationUs), std::memory_order_relaxed);
+
+    const auto bound =
+        std::lower_bound(iterationBoundsUs.begin(), iterationBoundsUs.end(), durationUs);
+    const auto bucket = static_cast<size_t>(bound - iterationBoundsUs.begin());
+    iterationBuckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void CoreMetrics::countCallback(Callback callback)
+{
+    callbackCounts[static_cast<size_t>(callback)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void CoreMetrics::countConnectionChange(ConnectionMode newMode)
+{
+    connectionChanges[static_cast<size_t>(newMode)].fetch_add(1, std::memory_order_relaxed);
+}
+
+CoreMetrics::Snapshot CoreMetrics::snapshot() const
+{
+    Snapshot snap;
+    snap.iterations = iterations.load(std::memory_order_relaxed);
+    snap.iterationTotalUs = iterationTotalUs.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < iterationBuckets.size(); ++i) {
+        snap.iterationBuckets[i] = iterationBuckets[i].load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < callbackCounts.size(); ++i) {
+        snap.callbackCounts[i] = callbackCounts[i].load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < connectionChanges.size(); ++i) {
+        snap.connectionChanges[i] = connectionChanges[i].load(std::memory_order_relaxed);
+    }
+    return snap;
+}
@@ -0,0 +1,85 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include <QString>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Always-on counters for the toxcore event loop.
+ *
+ * Core records every tox_iterate duration, every toxcore callback and every
+ * self connection mode change here. Writers only do relaxed atomic increments
+ * so the core loop pays no lock or allocation; readers (the debug UI) pull a
+ * plain-value Snapshot from any thread.
+ */
+class CoreMetrics
+{
+public:
+    enum class Callback
+    {
+        FriendRequest,
+        FriendMessage,
+        FriendName,
+        FriendTyping,
+        StatusMessage,
+        UserStatus,
+        FriendConnectionStatus,
+        ReadReceipt,
+        ConferenceInvite,
+        ConferenceMessage,
+        ConferencePeerListChange,
+        ConferencePeerName,
+        ConferenceTitle,
+        Count,
+    };
+
+    enum class ConnectionMode
+    {
+        None,
+        Tcp,
+        Udp,
+        Count,
+    };
+
+    // Upper bounds of the iteration duration histogram buckets, plus one
+    // overflow bucket. Spans the idle tick (~1ms) up to pathological stalls.
+    static constexpr std::array<int64_t, 11> iterationBoundsUs = {
+        50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000,
+    };
+    static constexpr size_t iterationBucketCount = iterationBoundsUs.size() + 1;
+
+    struct Snapshot
+    {
+        uint64_t iterations = 0;
+        uint64_t iterationTotalUs = 0;
+        std::array<uint64_t, iterationBucketCount> iterationBuckets{};
+        std::array<uint64_t, static_cast<size_t>(Callback::Count)> callbackCounts{};
+        std::array<uint64_t, static_cast<size_t>(ConnectionMode::Count)> connectionChanges{};
+
+        /**
+         * @brief Upper bound of the bucket the given percentile falls in.
+         * @return Duration in µs, or -1 with no samples or in the overflow bucket.
+         */
+        int64_t iterationPercentileUs(int percentile) const;
+        QString toString() const;
+    };
+
+    void recordIteration(int64_t durationUs);
+    void countCallback(Callback callback);
+    void countConnectionChange(ConnectionMode newMode);
+
+    Snapshot snapshot() const;
+
+private:
+    std::atomic<uint64_t> iterations{0};
+    std::atomic<uint64_t> iterationTotalUs{0};
+    std::array<std::atomic<uint64_t>, iterationBucketCount> iterationBuckets{};
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(Callback::Count)> callbackCounts{};
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(ConnectionMode::Count)> connectionChanges{};
+};
@@ -6,3 +6,22 @@
 #include "icoreconferencemessagesender.h"
 
 ICoreConferenceMessageSender::~ICoreConferenceMessageSender() = default;
+
+/**
+ * @brief Sends the split parts of one logical message in a single submission.
+ *
+ * The default just loops over the per-part entry points; implementations that
+ * pay per-call overhead (e.g. a lock around the tox instance) can override
+ * this to pay it once per batch.
+ */
+void ICoreConferenceMessageSender::sendConferenceMessageBatch(int conferenceId, bool isAction,
+                                                              const QStringList& parts)
+{
+    for (const QString& part : parts) {
+        if (isAction) {
+            sendConferenceAction(conferenceId, part);
+        } else {
+            sendConferenceMessage(conferenceId, part);
+        }
+    }
+}
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <QString>
+#include <QStringList>
 
 class ICoreConferenceMessageSender
 {
@@ -19,4 +20,6 @@ public:
 
     virtual void sendConferenceAction(int conferenceId, const QString& message) = 0;
     virtual void sendConferenceMessage(int conferenceId, const QString& message) = 0;
+    virtual void sendConferenceMessageBatch(int conferenceId, bool isAction,
+                                            const QStringList& parts);
 };
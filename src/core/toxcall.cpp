@@ -13,6 +13,9 @@
 #include <QTimer>
 #include <QtConcurrent/QtConcurrent>
 
+#include <algorithm>
+#include <limits>
+
 /**
  * @var uint32_t ToxCall::callId
  * @brief Could be a friendNum or conferenceNum, must uniquely identify the call. Do not modify!
@@ -30,8 +33,9 @@
  * @var TOXAV_FRIEND_CALL_STATE ToxFriendCall::state
  * @brief State of the peer (not ours!)
  *
- * @var QMap ToxConferenceCall::peers
- * @brief Keeps sources for users in conference calls.
+ * @var std::map ToxConferenceCall::missedWindows
+ * @brief Peers expected to contribute to each mix window, with a counter of
+ * consecutive missed windows used to expire peers that went quiet.
  */
 
 ToxCall::ToxCall(bool VideoEnabled_, CoreAV& av_, IAudioControl& audio_)
@@ -111,10 +115,14 @@ ToxFriendCall::ToxFriendCall(uint32_t friendNum, bool VideoEnabled, CoreAV& av_,
     , friendId{friendNum}
     , cameraSource{cameraSource_}
 {
-    connect(audioSource.get(), &IAudioSource::frameAvailable, &av_,
-            [&av_, friendNum](const int16_t* pcm, size_t samples, uint8_t chans, uint32_t rate) {
-                av_.sendCallAudio(friendNum, pcm, samples, chans, rate);
-            });
+    connect(audioSource.get(), &IAudioSource::framesQueued, this, [this]() {
+        IAudioSource::PcmFrame frame;
+        while (audioSource && audioSource->peekFrame(frame)) {
+            av->sendCallAudio(friendId, frame.pcm, frame.sampleCount, frame.channels,
+                              frame.samplingRate);
+            audioSource->dropFrame();
+        }
+    });
 
     audioSourceInvalid = connect(audioSource.get(), &IAudioSource::invalidated, this,
                                  &ToxFriendCall::onAudioSourceInvalidated);
@@ -131,25 +139,72 @@ ToxFriendCall::ToxFriendCall(uint32_t friendNum, bool VideoEnabled, CoreAV& av_,
             cameraSource.setupDefault();
         }
         cameraSource.subscribe();
-        videoInConn = QObject::connect(&cameraSource, &VideoSource::frameAvailable, &av_,
-                                       [&av_, friendNum](std::shared_ptr<VideoFrame> frame) {
-                                           av_.sendCallVideo(friendNum, frame);
-                                       });
+        // The mailbox store must run on the capturing thread itself, before
+        // any queuing, so frames cannot accumulate in the event loop
+        videoInConn = QObject::connect(
+            &cameraSource, &VideoSource::frameAvailable, this,
+            [this](std::shared_ptr<VideoFrame> frame) { queueOutgoingFrame(std::move(frame)); },
+            Qt::DirectConnection);
         if (!videoInConn) {
             qDebug() << "Video connection not working";
         }
+        connect(this, &ToxFriendCall::outgoingFrameQueued, this, &ToxFriendCall::sendQueuedFrame,
+                Qt::QueuedConnection);
     }
 }
 
 ToxFriendCall::~ToxFriendCall()
 {
     if (videoEnabled) {
+        // Stop the capturing thread from delivering into the mailbox before
+        // any member is torn down; the base class disconnect runs too late
+        QObject::disconnect(videoInConn);
         cameraSource.unsubscribe();
+
+        if (const auto dropped = droppedOutgoingFrames.load()) {
+            qDebug() << "Replaced" << dropped << "outgoing video frames before they were sent";
+        }
     }
     QObject::disconnect(audioSinkInvalid);
     QObject::disconnect(audioSourceInvalid);
 }
 
+/**
+ * @brief Stores the newest captured frame for sending, dropping any unsent older one.
+ *
+ * Runs on the thread that captured the frame. At most one send is queued to
+ * the CoreAV thread at a time, so a 4K screen share cannot flood the event
+ * loop that also runs toxav iteration.
+ */
+void ToxFriendCall::queueOutgoingFrame(std::shared_ptr<VideoFrame> frame)
+{
+    const auto previous = pendingOutgoingFrame.exchange(std::move(frame));
+
+    if (previous != nullptr) {
+        ++droppedOutgoingFrames;
+    }
+
+    if (!outgoingSendPending.exchange(true)) {
+        emit outgoingFrameQueued();
+    }
+}
+
+/**
+ * @brief Takes the newest frame out of the mailbox and sends it.
+ *
+ * Runs on this object's thread via the queued outgoingFrameQueued connection.
+ */
+void ToxFriendCall::sendQueuedFrame()
+{
+    // Clear the flag before emptying the mailbox: a frame stored in between
+    // queues another send and at worst finds the mailbox empty
+    outgoingSendPending = false;
+
+    if (auto frame = pendingOutgoingFrame.exchange(nullptr)) {
+        av->sendCallVideo(friendId, std::move(frame));
+    }
+}
+
 void ToxFriendCall::onAudioSourceInvalidated()
 {
     auto newSrc = audio.makeSource();
@@ -157,10 +212,14 @@ void ToxFriendCall::onAudioSourceInvalidated()
         qWarning() << "Failed to create a new audio source";
         return;
     }
-    connect(newSrc.get(), &IAudioSource::frameAvailable, this,
-            [this](const int16_t* pcm, size_t samples, uint8_t chans, uint32_t rate) {
-                av->sendCallAudio(friendId, pcm, samples, chans, rate);
-            });
+    connect(newSrc.get(), &IAudioSource::framesQueued, this, [this]() {
+        IAudioSource::PcmFrame frame;
+        while (audioSource && audioSource->peekFrame(frame)) {
+            av->sendCallAudio(friendId, frame.pcm, frame.sampleCount, frame.channels,
+                              frame.samplingRate);
+            audioSource->dropFrame();
+        }
+    });
     audioSource = std::move(newSrc);
 
     connect(audioSource.get(), &IAudioSource::invalidated, this,
@@ -184,6 +243,81 @@ TOXAV_FRIEND_CALL_STATE ToxFriendCall::getState() const
     return state;
 }
 
+/**
+ * @brief The outgoing video bitrate currently set in toxav, in kbit/s.
+ * 0 means the call-start default was never adjusted.
+ */
+uint32_t ToxFriendCall::getVideoBitrate() const
+{
+    return videoBitrate;
+}
+
+void ToxFriendCall::setVideoBitrate(uint32_t rate)
+{
+    videoBitrate = rate;
+    videoBitrateChangeTimer.start();
+}
+
+/**
+ * @brief Records toxav's latest congestion recommendation for the send path.
+ */
+void ToxFriendCall::setRecommendedVideoBitrate(uint32_t rate)
+{
+    recommendedVideoBitrate = rate;
+}
+
+/**
+ * @brief Returns and clears the pending bitrate recommendation, 0 if none.
+ */
+uint32_t ToxFriendCall::takeRecommendedVideoBitrate()
+{
+    const uint32_t rate = recommendedVideoBitrate;
+    recommendedVideoBitrate = 0;
+    return rate;
+}
+
+/**
+ * @brief Milliseconds since the outgoing video bitrate last changed.
+ */
+qint64 ToxFriendCall::msSinceVideoBitrateChange() const
+{
+    return videoBitrateChangeTimer.isValid() ? videoBitrateChangeTimer.elapsed() : 0;
+}
+
+uint32_t ToxFriendCall::getRecommendedAudioBitrate() const
+{
+    return recommendedAudioBitrate.load(std::memory_order_relaxed);
+}
+
+void ToxFriendCall::setRecommendedAudioBitrate(uint32_t rate)
+{
+    recommendedAudioBitrate.store(rate, std::memory_order_relaxed);
+}
+
+qint64 ToxFriendCall::msSinceQualitySample() const
+{
+    // An invalid timer means no sample went out yet; report a huge elapsed
+    // time so the first sample is taken right away
+    return qualitySampleTimer.isValid() ? qualitySampleTimer.elapsed()
+                                        : std::numeric_limits<qint64>::max();
+}
+
+void ToxFriendCall::restartQualitySampleTimer()
+{
+    qualitySampleTimer.restart();
+}
+
+/**
+ * @brief Returns the outgoing frames dropped since the previous call.
+ */
+uint64_t ToxFriendCall::takeDroppedFrameSample()
+{
+    const uint64_t total = droppedOutgoingFrames.load(std::memory_order_relaxed);
+    const uint64_t delta = total - sampledDroppedFrames;
+    sampledDroppedFrames = total;
+    return delta;
+}
+
 void ToxFriendCall::setState(const TOXAV_FRIEND_CALL_STATE& value)
 {
     state = value;
@@ -207,23 +341,30 @@ ToxConferenceCall::ToxConferenceCall(const Conference& conference_, CoreAV& av_,
     }
 
     // register audio
-    connect(audioSource.get(), &IAudioSource::frameAvailable, this,
-            [this](const int16_t* pcm, size_t samples, uint8_t chans, uint32_t rate) {
-                if (conference.getPeersCount() <= 1) {
-                    return;
-                }
-
-                av->sendConferenceCallAudio(conference.getId(), pcm, samples, chans, rate);
-            });
+    connect(audioSource.get(), &IAudioSource::framesQueued, this, [this]() {
+        IAudioSource::PcmFrame frame;
+        while (audioSource && audioSource->peekFrame(frame)) {
+            if (conference.getPeersCount() > 1) {
+                av->sendConferenceCallAudio(conference.getId(), frame.pcm, frame.sampleCount,
+                                            frame.channels, frame.samplingRate);
+            }
+            audioSource->dropFrame();
+        }
+    });
 
     connect(audioSource.get(), &IAudioSource::invalidated, this,
             &ToxConferenceCall::onAudioSourceInvalidated);
+
+    // One sink for the whole conference; peer streams are mixed before playback
+    sink = audio.makeSink();
+    if (sink) {
+        sinkInvalid = sink->connectTo_invalidated(this, [this]() { onAudioSinkInvalidated(); });
+    }
 }
 
 ToxConferenceCall::~ToxConferenceCall()
 {
-    // disconnect all Qt connections
-    clearPeers();
+    QObject::disconnect(sinkInvalid);
 }
 
 void ToxConferenceCall::onAudioSourceInvalidated()
@@ -233,14 +374,16 @@ void ToxConferenceCall::onAudioSourceInvalidated()
         qWarning() << "Failed to create a new audio source";
         return;
     }
-    connect(newSrc.get(), &IAudioSource::frameAvailable, this,
-            [this](const int16_t* pcm, size_t samples, uint8_t chans, uint32_t rate) {
-                if (conference.getPeersCount() <= 1) {
-                    return;
-                }
-
-                av->sendConferenceCallAudio(conference.getId(), pcm, samples, chans, rate);
-            });
+    connect(newSrc.get(), &IAudioSource::framesQueued, this, [this]() {
+        IAudioSource::PcmFrame frame;
+        while (audioSource && audioSource->peekFrame(frame)) {
+            if (conference.getPeersCount() > 1) {
+                av->sendConferenceCallAudio(conference.getId(), frame.pcm, frame.sampleCount,
+                                            frame.channels, frame.samplingRate);
+            }
+            audioSource->dropFrame();
+        }
+    });
 
     audioSource = std::move(newSrc);
 
@@ -249,64 +392,96 @@ void ToxConferenceCall::onAudioSourceInvalidated()
 }
 
 
-void ToxConferenceCall::onAudioSinkInvalidated(ToxPk peerId)
+void ToxConferenceCall::onAudioSinkInvalidated()
 {
-    removePeer(peerId);
-    addPeer(peerId);
+    auto newSink = audio.makeSink();
+
+    if (newSink) {
+        sinkInvalid = newSink->connectTo_invalidated(this, [this]() { onAudioSinkInvalidated(); });
+    }
+
+    sink = std::move(newSink);
 }
 
 void ToxConferenceCall::removePeer(ToxPk peerId)
 {
-    const auto& source = peers.find(peerId);
-    if (source == peers.cend()) {
-        qDebug() << "Peer:" << peerId.toString() << "does not have a source, can't remove";
-        return;
-    }
-
-    peers.erase(source);
-    QObject::disconnect(sinkInvalid[peerId]);
-    sinkInvalid.erase(peerId);
+    peersInWindow.erase(peerId);
+    missedWindows.erase(peerId);
 }
 
-void ToxConferenceCall::addPeer(ToxPk peerId)
+/**
+ * @brief Mixes one decoded peer frame into the current window.
+ *
+ * Frames are accumulated into a shared 32 bit buffer and flushed to the single
+ * conference sink once every expected peer contributed, or when a peer wraps
+ * around to its next frame. The sink therefore sees one stream and one lock
+ * acquisition per window instead of one per peer frame. Muting individual
+ * peers still happens upstream in the conference audio callback, before a
+ * frame reaches the mixer.
+ */
+void ToxConferenceCall::playAudioBuffer(const ToxPk& peer, const int16_t* data, int samples,
+                                        unsigned channels, int sampleRate)
 {
-    std::unique_ptr<IAudioSink> newSink = audio.makeSink();
+    if (sink == nullptr) {
+        return;
+    }
 
-    QMetaObject::Connection con;
+    // A format change or a second frame from the same peer means the current
+    // window is over
+    const bool formatChanged = windowSamples != 0
+                               && (windowChannels != channels || windowSampleRate != sampleRate);
+    if (formatChanged || peersInWindow.count(peer) != 0) {
+        flushMixWindow();
+    }
 
-    if (newSink) {
-        con = newSink->connectTo_invalidated(this,
-                                             [this, peerId]() { onAudioSinkInvalidated(peerId); });
+    if (windowSamples == 0) {
+        windowSamples = samples;
+        windowChannels = channels;
+        windowSampleRate = sampleRate;
+        mixBuffer.assign(static_cast<size_t>(samples) * channels, 0);
     }
 
-    peers.emplace(peerId, std::move(newSink));
-    sinkInvalid.insert({peerId, con});
-}
+    const auto sampleCount = std::min(static_cast<size_t>(samples) * channels, mixBuffer.size());
+    for (size_t i = 0; i < sampleCount; ++i) {
+        mixBuffer[i] += data[i];
+    }
+    peersInWindow.insert(peer);
+    missedWindows[peer] = 0;
 
-bool ToxConferenceCall::havePeer(ToxPk peerId)
-{
-    const auto& source = peers.find(peerId);
-    return source != peers.cend();
+    // Flush as soon as every expected peer contributed, so mixing adds no
+    // latency beyond arrival jitter
+    if (peersInWindow.size() >= missedWindows.size()) {
+        flushMixWindow();
+    }
 }
 
-void ToxConferenceCall::clearPeers()
+void ToxConferenceCall::flushMixWindow()
 {
-    peers.clear();
-    for (auto con : sinkInvalid) {
-        QObject::disconnect(con.second);
+    if (windowSamples == 0) {
+        return;
     }
 
-    sinkInvalid.clear();
-}
-
-void ToxConferenceCall::playAudioBuffer(const ToxPk& peer, const int16_t* data, int samples,
-                                        unsigned channels, int sampleRate)
-{
-    if (!havePeer(peer)) {
-        addPeer(peer);
+    playBuffer.resize(mixBuffer.size());
+    for (size_t i = 0; i < mixBuffer.size(); ++i) {
+        playBuffer[i] =
+            static_cast<int16_t>(std::clamp(mixBuffer[i], static_cast<int32_t>(INT16_MIN),
+                                            static_cast<int32_t>(INT16_MAX)));
+    }
+    if (sink) {
+        sink->playAudioBuffer(playBuffer.data(), windowSamples, windowChannels, windowSampleRate);
     }
-    const auto& source = peers.find(peer);
-    if (source->second) {
-        source->second->playAudioBuffer(data, samples, channels, sampleRate);
+
+    // Expire peers that stopped contributing so they don't hold up future
+    // windows
+    constexpr int maxMissedWindows = 5;
+    for (auto it = missedWindows.begin(); it != missedWindows.end();) {
+        if (peersInWindow.count(it->first) == 0 && ++it->second > maxMissedWindows) {
+            it = missedWindows.erase(it);
+        } else {
+            ++it;
+        }
     }
+
+    peersInWindow.clear();
+    windowSamples = 0;
 }
@@ -11,12 +11,17 @@
 #include "src/core/toxpk.h"
 #include <tox/toxav.h>
 
+#include <QElapsedTimer>
 #include <QMap>
 #include <QMetaObject>
 #include <QtGlobal>
 
+#include <atomic>
 #include <cstdint>
+#include <map>
 #include <memory>
+#include <set>
+#include <vector>
 
 class QTimer;
 class AudioFilterer;
@@ -24,6 +29,7 @@ class CoreVideoSource;
 class CoreAV;
 class Conference;
 class CameraSource;
+class VideoFrame;
 
 class ToxCall : public QObject
 {
@@ -87,19 +93,59 @@ public:
     TOXAV_FRIEND_CALL_STATE getState() const;
     void setState(const TOXAV_FRIEND_CALL_STATE& value);
 
+    uint32_t getVideoBitrate() const;
+    void setVideoBitrate(uint32_t rate);
+    void setRecommendedVideoBitrate(uint32_t rate);
+    uint32_t takeRecommendedVideoBitrate();
+    qint64 msSinceVideoBitrateChange() const;
+
+    uint32_t getRecommendedAudioBitrate() const;
+    void setRecommendedAudioBitrate(uint32_t rate);
+    qint64 msSinceQualitySample() const;
+    void restartQualitySampleTimer();
+    uint64_t takeDroppedFrameSample();
+
     void playAudioBuffer(const int16_t* data, int samples, unsigned channels, int sampleRate) const;
 
+signals:
+    void outgoingFrameQueued();
+
 private slots:
     void onAudioSourceInvalidated();
     void onAudioSinkInvalidated();
+    void sendQueuedFrame();
 
 private:
+    void queueOutgoingFrame(std::shared_ptr<VideoFrame> frame);
+
     QMetaObject::Connection audioSourceInvalid;
     QMetaObject::Connection audioSinkInvalid;
     TOXAV_FRIEND_CALL_STATE state{TOXAV_FRIEND_CALL_STATE_NONE};
     std::unique_ptr<IAudioSink> sink;
     uint32_t friendId;
     CameraSource& cameraSource;
+
+    // Outgoing video bitrate state for CoreAV's feedback controller, all
+    // touched on the CoreAV thread only: the rate currently set in toxav,
+    // the latest congestion recommendation, and when the rate last changed
+    uint32_t videoBitrate{0};
+    uint32_t recommendedVideoBitrate{0};
+    QElapsedTimer videoBitrateChangeTimer;
+
+    // Connection quality sampling state for CoreAV's periodic quality log
+    // feed. The recommendation is written by the toxav callback on the CoreAV
+    // thread but read from the audio send path, hence atomic; the sample
+    // timer and dropped-frame bookmark are only touched on the send path
+    std::atomic<uint32_t> recommendedAudioBitrate{0};
+    QElapsedTimer qualitySampleTimer;
+    uint64_t sampledDroppedFrames{0};
+
+    // Latest-frame mailbox for outgoing video: at most one frame waits for the
+    // CoreAV thread at a time and a newer frame replaces an unsent older one,
+    // so a lagging send cannot pile converted frames up in the event loop
+    std::atomic<std::shared_ptr<VideoFrame>> pendingOutgoingFrame;
+    std::atomic_bool outgoingSendPending{false};
+    std::atomic<std::uint64_t> droppedOutgoingFrames{0};
 };
 
 class ToxConferenceCall : public ToxCall
@@ -118,15 +164,26 @@ public:
                          int sampleRate);
 
 private:
-    void addPeer(ToxPk peerId);
-    bool havePeer(ToxPk peerId);
-    void clearPeers();
+    void flushMixWindow();
 
-    std::map<ToxPk, std::unique_ptr<IAudioSink>> peers;
-    std::map<ToxPk, QMetaObject::Connection> sinkInvalid;
+    // Decoded peer PCM is mixed on the CoreAV thread into a single sink
+    // stream, so sink count and audio lock traffic don't scale with the
+    // number of participants. The buffers are reused across mix windows.
+    std::unique_ptr<IAudioSink> sink;
+    QMetaObject::Connection sinkInvalid;
+    std::vector<int32_t> mixBuffer;
+    std::vector<int16_t> playBuffer;
+    std::set<ToxPk> peersInWindow;
+    // Peers expected to contribute to each mix window, with a counter of
+    // consecutive misses; a peer that goes quiet is dropped after a few
+    // windows so it no longer delays the flush
+    std::map<ToxPk, int> missedWindows;
+    int windowSamples = 0;
+    unsigned windowChannels = 0;
+    int windowSampleRate = 0;
     const Conference& conference;
 
 private slots:
     void onAudioSourceInvalidated();
-    void onAudioSinkInvalidated(ToxPk peerId);
+    void onAudioSinkInvalidated();
 };
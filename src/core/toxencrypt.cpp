@@ -7,11 +7,54 @@
 #include <tox/toxencryptsave.h>
 
 #include <QByteArray>
+#include <QCryptographicHash>
 #include <QDebug>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QString>
 #include <memory>
+#include <utility>
 
 namespace {
+// Key derivation is deliberately slow (it stretches the password), so cache the
+// derived keys for the current session keyed by a digest of the password plus
+// the salt. The same profile password is stretched once per salt instead of
+// once per consumer, and re-login with the same credentials is instant.
+// Plaintext passwords are never stored; only their SHA-256 digest is.
+QMutex derivedKeyCacheMutex;
+QHash<QByteArray, std::shared_ptr<Tox_Pass_Key>> derivedKeyCache;
+constexpr int maxCachedKeys = 8;
+
+QByteArray derivedKeyCacheKey(const QByteArray& pass, const uint8_t* salt)
+{
+    QCryptographicHash hash{QCryptographicHash::Sha256};
+    hash.addData(pass);
+    hash.addData(QByteArrayView{reinterpret_cast<const char*>(salt), TOX_PASS_SALT_LENGTH});
+    return hash.result();
+}
+
+std::shared_ptr<Tox_Pass_Key> lookupDerivedKey(const QByteArray& cacheKey)
+{
+    const QMutexLocker<QMutex> locker{&derivedKeyCacheMutex};
+    return derivedKeyCache.value(cacheKey);
+}
+
+void storeDerivedKey(const QByteArray& cacheKey, const std::shared_ptr<Tox_Pass_Key>& key)
+{
+    const QMutexLocker<QMutex> locker{&derivedKeyCacheMutex};
+    if (derivedKeyCache.size() >= maxCachedKeys) {
+        // Failed login attempts each derive a distinct key; don't let them pile up.
+        derivedKeyCache.clear();
+    }
+    derivedKeyCache.insert(cacheKey, key);
+}
+
+std::shared_ptr<Tox_Pass_Key> wrapPassKey(Tox_Pass_Key* key)
+{
+    return std::shared_ptr<Tox_Pass_Key>{key, tox_pass_key_free};
+}
+
 /**
  * @brief Gets the error string for Tox_Err_Key_Derivation errors.
  * @param error The error number.
@@ -114,19 +157,17 @@ QString getSaltError(Tox_Err_Get_Salt error)
  */
 
 /**
- * @brief Frees the passKey before destruction.
+ * @brief Releases this object's reference to the passKey; the key itself is
+ *        freed once the last ToxEncrypt and the session cache let go of it.
  */
-ToxEncrypt::~ToxEncrypt()
-{
-    tox_pass_key_free(passKey);
-}
+ToxEncrypt::~ToxEncrypt() = default;
 
 /**
  * @brief Constructs a ToxEncrypt object from a Tox_Pass_Key.
  * @param key Derived key to use for encryption and decryption.
  */
-ToxEncrypt::ToxEncrypt(Tox_Pass_Key* key)
-    : passKey{key}
+ToxEncrypt::ToxEncrypt(std::shared_ptr<Tox_Pass_Key> key)
+    : passKey{std::move(key)}
 {
 }
 
@@ -225,7 +266,8 @@ QByteArray ToxEncrypt::decryptPass(const QString& password, const QByteArray& ci
  * @return A std::unique_ptr containing a ToxEncrypt object on success, or an
  *         or an empty std::unique_ptr on failure.
  *
- *  Derives a key from the password and a new random salt.
+ *  Derives a key from the password and a new random salt. The random salt
+ *  makes the result unique per call, so it is never cached.
  */
 std::unique_ptr<ToxEncrypt> ToxEncrypt::makeToxEncrypt(const QString& password)
 {
@@ -241,7 +283,7 @@ std::unique_ptr<ToxEncrypt> ToxEncrypt::makeToxEncrypt(const QString& password)
         return std::unique_ptr<ToxEncrypt>{};
     }
 
-    return std::unique_ptr<ToxEncrypt>(new ToxEncrypt(passKey));
+    return std::unique_ptr<ToxEncrypt>(new ToxEncrypt(wrapPassKey(passKey)));
 }
 
 /**
@@ -251,7 +293,9 @@ std::unique_ptr<ToxEncrypt> ToxEncrypt::makeToxEncrypt(const QString& password)
  * @return A std::unique_ptr containing a ToxEncrypt object on success, or an
  *         or an empty std::unique_ptr on failure.
  *
- *  Derives a key from the password and the salt read from toxSave.
+ *  Derives a key from the password and the salt read from toxSave, reusing a
+ *  previously derived key from the session cache when one exists for this
+ *  password and salt.
  */
 std::unique_ptr<ToxEncrypt> ToxEncrypt::makeToxEncrypt(const QString& password, const QByteArray& toxSave)
 {
@@ -270,6 +314,11 @@ std::unique_ptr<ToxEncrypt> ToxEncrypt::makeToxEncrypt(const QString& password,
     }
 
     QByteArray pass = password.toUtf8();
+    const QByteArray cacheKey = derivedKeyCacheKey(pass, salt);
+    if (auto cachedKey = lookupDerivedKey(cacheKey)) {
+        return std::unique_ptr<ToxEncrypt>(new ToxEncrypt(std::move(cachedKey)));
+    }
+
     Tox_Err_Key_Derivation keyError;
     Tox_Pass_Key* const passKey =
         tox_pass_key_derive_with_salt(reinterpret_cast<const uint8_t*>(pass.constData()),
@@ -281,7 +330,9 @@ std::unique_ptr<ToxEncrypt> ToxEncrypt::makeToxEncrypt(const QString& password,
         return std::unique_ptr<ToxEncrypt>{};
     }
 
-    return std::unique_ptr<ToxEncrypt>(new ToxEncrypt(passKey));
+    auto sharedKey = wrapPassKey(passKey);
+    storeDerivedKey(cacheKey, sharedKey);
+    return std::unique_ptr<ToxEncrypt>(new ToxEncrypt(std::move(sharedKey)));
 }
 
 /**
@@ -298,7 +349,7 @@ QByteArray ToxEncrypt::encrypt(const QByteArray& plaintext) const
 
     QByteArray ciphertext(plaintext.length() + TOX_PASS_ENCRYPTION_EXTRA_LENGTH, 0x00);
     Tox_Err_Encryption error;
-    tox_pass_key_encrypt(passKey, reinterpret_cast<const uint8_t*>(plaintext.constData()),
+    tox_pass_key_encrypt(passKey.get(), reinterpret_cast<const uint8_t*>(plaintext.constData()),
                          static_cast<size_t>(plaintext.size()),
                          reinterpret_cast<uint8_t*>(ciphertext.data()), &error);
 
@@ -325,7 +376,7 @@ QByteArray ToxEncrypt::decrypt(const QByteArray& ciphertext) const
 
     QByteArray plaintext(ciphertext.length() - TOX_PASS_ENCRYPTION_EXTRA_LENGTH, 0x00);
     Tox_Err_Decryption error;
-    tox_pass_key_decrypt(passKey, reinterpret_cast<const uint8_t*>(ciphertext.constData()),
+    tox_pass_key_decrypt(passKey.get(), reinterpret_cast<const uint8_t*>(ciphertext.constData()),
                          static_cast<size_t>(ciphertext.size()),
                          reinterpret_cast<uint8_t*>(plaintext.data()), &error);
 
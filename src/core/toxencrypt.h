@@ -31,8 +31,10 @@ public:
     QByteArray decrypt(const QByteArray& ciphertext) const;
 
 private:
-    explicit ToxEncrypt(Tox_Pass_Key* key);
+    explicit ToxEncrypt(std::shared_ptr<Tox_Pass_Key> key);
 
 private:
-    Tox_Pass_Key* passKey = nullptr;
+    // Shared so that the session-wide derivation cache and every ToxEncrypt
+    // made from the same password and salt reuse one stretched key
+    std::shared_ptr<Tox_Pass_Key> passKey;
 };
@@ -4,10 +4,14 @@
  */
 
 #include "src/core/toxfile.h"
+#include "src/workerpool.h"
 #include <QFile>
 #include <QRegularExpression>
 #include <tox/tox.h>
 
+#include <algorithm>
+#include <cstring>
+
 #define TOX_HEX_ID_LENGTH 2 * TOX_ADDRESS_SIZE
 
 /**
@@ -68,3 +72,101 @@ bool ToxFile::open(bool write)
 {
     return write ? file->open(QIODevice::ReadWrite) : file->open(QIODevice::ReadOnly);
 }
+
+/**
+ * @brief Reads a chunk for sending, refilling the staging buffer as needed.
+ * @param pos File offset the chunk starts at.
+ * @param dest Destination for the chunk data.
+ * @param length Requested chunk length.
+ * @return Bytes copied (may be short at EOF), or <= 0 on read failure.
+ */
+int64_t ToxFile::readChunk(uint64_t pos, uint8_t* dest, size_t length)
+{
+    const uint64_t bufferedEnd = ioBufferPos + static_cast<uint64_t>(ioBuffer.size());
+    if (pos < ioBufferPos || pos + length > bufferedEnd) {
+        if (!file->seek(pos)) {
+            return -1;
+        }
+        ioBuffer = file->read(std::max(ioBlockSize, static_cast<qint64>(length)));
+        ioBufferPos = pos;
+
+        // Hash the freshly read bytes we haven't covered yet; retransmit
+        // refills can overlap already-hashed ranges
+        const uint64_t refilledEnd = ioBufferPos + static_cast<uint64_t>(ioBuffer.size());
+        if (hashedPos >= ioBufferPos && hashedPos < refilledEnd) {
+            enqueueHashData(ioBuffer.mid(hashedPos - ioBufferPos));
+            hashedPos = refilledEnd;
+        }
+    }
+
+    const uint64_t available =
+        std::min<uint64_t>(length, ioBufferPos + static_cast<uint64_t>(ioBuffer.size()) - pos);
+    memcpy(dest, ioBuffer.constData() + (pos - ioBufferPos), available);
+    return static_cast<int64_t>(available);
+}
+
+/**
+ * @brief Appends a received chunk to the staging buffer, flushing full blocks.
+ * @note The caller guarantees chunks arrive in order (out-of-order transfers
+ * are aborted before getting here).
+ */
+void ToxFile::stageWrite(uint64_t pos, const uint8_t* data, size_t length)
+{
+    if (ioBuffer.isEmpty()) {
+        ioBufferPos = pos;
+    }
+    ioBuffer.append(reinterpret_cast<const char*>(data), length);
+    if (ioBuffer.size() >= ioBlockSize) {
+        enqueueHashData(ioBuffer);
+        flushWrites();
+    }
+}
+
+/**
+ * @brief Writes out any staged received data.
+ * @return False if the write failed or came up short.
+ */
+bool ToxFile::flushWrites()
+{
+    if (ioBuffer.isEmpty()) {
+        return true;
+    }
+
+    const bool ok = file->seek(ioBufferPos) && file->write(ioBuffer) == ioBuffer.size();
+    ioBufferPos += ioBuffer.size();
+    ioBuffer.clear();
+    return ok;
+}
+
+/**
+ * @brief Chains a block of content into the hash on the thread pool.
+ *
+ * Blocks are hashed in order because each one is appended as a continuation
+ * of the previous future.
+ */
+void ToxFile::enqueueHashData(QByteArray data)
+{
+    auto generator = hashGenerator;
+    const auto hashBlock = [generator, block = std::move(data)] { generator->addData(block); };
+    if (hashFuture.isValid()) {
+        hashFuture = hashFuture.then(&WorkerPool::instance().background(), hashBlock);
+    } else {
+        hashFuture = WorkerPool::instance().runBackground(hashBlock);
+    }
+}
+
+/**
+ * @brief Hashes any staged tail and waits for the hash chain to drain.
+ *
+ * Must be called before emitting a terminal transfer status, since its
+ * receivers read hashGenerator's result.
+ */
+void ToxFile::finishHashing()
+{
+    if (direction == RECEIVING && !ioBuffer.isEmpty()) {
+        enqueueHashData(ioBuffer);
+    }
+    if (hashFuture.isValid()) {
+        hashFuture.waitForFinished();
+    }
+}
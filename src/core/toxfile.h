@@ -8,7 +8,9 @@
 #include "src/core/toxfilepause.h"
 #include "src/core/toxfileprogress.h"
 
+#include <QByteArray>
 #include <QCryptographicHash>
+#include <QFuture>
 #include <QString>
 #include <memory>
 
@@ -47,6 +49,12 @@ struct ToxFile
     void setFilePath(QString path);
     bool open(bool write);
 
+    int64_t readChunk(uint64_t pos, uint8_t* dest, size_t length);
+    void stageWrite(uint64_t pos, const uint8_t* data, size_t length);
+    bool flushWrites();
+    void enqueueHashData(QByteArray data);
+    void finishHashing();
+
     uint8_t fileKind;
     uint32_t fileNum;
     uint32_t friendId;
@@ -61,4 +69,26 @@ struct ToxFile
         std::make_shared<QCryptographicHash>(QCryptographicHash::Sha256);
     ToxFilePause pauseStatus;
     ToxFileProgress progress;
+
+    /**
+     * Sequential I/O staging, used from the tox_iterate thread. Outgoing
+     * chunk requests are served out of ioBuffer, which readChunk() refills a
+     * block at a time; incoming chunks coalesce in it until stageWrite()
+     * flushes a full block. Either way the per-chunk seek+read/write
+     * syscalls that stalled the iterate loop become one syscall per block.
+     */
+    static constexpr qint64 ioBlockSize = 1024 * 1024;
+    QByteArray ioBuffer;
+    uint64_t ioBufferPos = 0;
+
+    /**
+     * Content hashing rides the staging blocks instead of the ~1 KiB tox
+     * chunks and runs on the thread pool, serialized through hashFuture so
+     * blocks reach the generator in order. Terminal paths call
+     * finishHashing() before emitting, so nobody reads hashGenerator while
+     * the chain is still running. hashedPos tracks how far into the file the
+     * sending side has hashed, since retransmit refills may overlap.
+     */
+    QFuture<void> hashFuture;
+    uint64_t hashedPos = 0;
 };
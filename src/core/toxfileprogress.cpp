@@ -7,14 +7,20 @@
 
 #include <limits>
 
-ToxFileProgress::ToxFileProgress(uint64_t filesize_, int samplePeriodMs_)
+ToxFileProgress::ToxFileProgress(uint64_t filesize_, int samplePeriodMs_, int updateIntervalMs_)
     : filesize(filesize_)
     , samplePeriodMs(samplePeriodMs_)
+    , updateIntervalMs(updateIntervalMs_)
 {
     if (samplePeriodMs_ < 0) {
         qWarning("Invalid sample rate, healing to 1000ms");
         samplePeriodMs = 1000;
     }
+
+    if (updateIntervalMs_ < 0) {
+        qWarning("Invalid update interval, healing to 100ms");
+        updateIntervalMs = 100;
+    }
 }
 
 QTime ToxFileProgress::lastSampleTime() const
@@ -65,6 +71,23 @@ bool ToxFileProgress::addSample(uint64_t bytesSent, QTime now)
     return true;
 }
 
+/**
+ * @brief Rate-caps progress notifications, decoupling them from the chunk rate
+ * @return True at most once per updateIntervalMs; the caller should only emit
+ * a progress update when it gets true. A clock jump backwards grants an update
+ * immediately rather than stalling for up to a day
+ */
+bool ToxFileProgress::claimUpdate(QTime now)
+{
+    if (lastUpdateTime.isValid() && lastUpdateTime <= now
+        && lastUpdateTime.msecsTo(now) < updateIntervalMs) {
+        return false;
+    }
+
+    lastUpdateTime = now;
+    return true;
+}
+
 void ToxFileProgress::resetSpeed()
 {
     for (auto& sample : samples) {
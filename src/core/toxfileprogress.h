@@ -12,10 +12,11 @@
 class ToxFileProgress
 {
 public:
-    ToxFileProgress(uint64_t filesize_, int samplePeriodMs_ = 4000);
+    ToxFileProgress(uint64_t filesize_, int samplePeriodMs_ = 4000, int updateIntervalMs_ = 100);
 
     QTime lastSampleTime() const;
     bool addSample(uint64_t bytesSent, QTime now = QTime::currentTime());
+    bool claimUpdate(QTime now = QTime::currentTime());
     void resetSpeed();
 
     uint64_t getBytesSent() const;
@@ -31,6 +32,8 @@ private:
     // Should never be modified, but do not want to lose assignment operators
     uint64_t filesize;
     int samplePeriodMs;
+    int updateIntervalMs;
+    QTime lastUpdateTime;
 
     struct Sample
     {
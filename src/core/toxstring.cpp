@@ -8,8 +8,46 @@
 #include <QByteArray>
 #include <QString>
 
+#include <atomic>
 #include <cassert>
 #include <climits>
+#include <utility>
+
+namespace {
+/**
+ * @brief Whether a code point survives sanitation.
+ *
+ * Cf (Other_Format) is to allow skin-color modifiers for emojis.
+ */
+bool isAllowed(char32_t c)
+{
+    return QChar::isPrint(c) || QChar::category(c) == QChar::Category::Other_Format;
+}
+
+/**
+ * @brief Scans a decoded string for code points that sanitation would strip.
+ */
+bool needsSanitation(const QString& decoded)
+{
+    for (qsizetype i = 0; i < decoded.size(); ++i) {
+        const QChar c = decoded.at(i);
+        char32_t codepoint = c.unicode();
+        if (c.isHighSurrogate() && i + 1 < decoded.size() && decoded.at(i + 1).isLowSurrogate()) {
+            codepoint = QChar::surrogateToUcs4(c, decoded.at(i + 1));
+            ++i;
+        }
+        if (!isAllowed(codepoint)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// How often the sanitation slow path ran and how much it stripped; shown in
+// the debug pane to spot peers flooding us with garbage
+std::atomic<uint64_t> sanitizedStrings{0};
+std::atomic<uint64_t> strippedCodepoints{0};
+} // namespace
 
 /**
  * @class ToxString
@@ -34,6 +72,15 @@ ToxString::ToxString(const QByteArray& text)
 {
 }
 
+/**
+ * @brief Creates a ToxString by taking over an existing byte buffer.
+ * @param text Input text, moved from.
+ */
+ToxString::ToxString(QByteArray&& text)
+    : string(std::move(text))
+{
+}
+
 /**
  * @brief Creates a ToxString from the representation used by c-toxcore.
  * @param text Pointer to the beginning of the text.
@@ -68,15 +115,37 @@ size_t ToxString::size() const
  *
  * Removes any non-printable characters from the string. This is a defense-in-depth measure to
  * prevent some potential security issues caused by bugs in client code or one of its dependencies.
+ *
+ * The common case - a message with nothing to strip - returns the decoded string after a single
+ * scan, without the UTF-32 round trip and its allocations that stripping requires.
  */
 QString ToxString::getQString() const
 {
-    const auto tainted = QString::fromUtf8(string).toStdU32String();
+    return toQString(data(), size());
+}
+
+/**
+ * @brief Decodes a c-toxcore buffer straight to a sanitized QString.
+ *
+ * Equivalent to ToxString(text, length).getQString() without materializing
+ * the intermediate QByteArray copy. The toxcore callbacks run this for every
+ * incoming message, name and status text, so under load the skipped
+ * allocation adds up on the Core thread.
+ */
+QString ToxString::toQString(const uint8_t* text, size_t length)
+{
+    assert(length <= INT_MAX);
+    const QString decoded = QString::fromUtf8(reinterpret_cast<const char*>(text), length);
+    if (!needsSanitation(decoded)) {
+        return decoded;
+    }
+
+    const auto tainted = decoded.toStdU32String();
     std::u32string cleaned;
-    std::copy_if(tainted.cbegin(), tainted.cend(), std::back_inserter(cleaned), [](char32_t c) {
-        // Cf (Other_Format) is to allow skin-color modifiers for emojis.
-        return QChar::isPrint(c) || QChar::category(c) == QChar::Category::Other_Format;
-    });
+    std::copy_if(tainted.cbegin(), tainted.cend(), std::back_inserter(cleaned),
+                 [](char32_t c) { return isAllowed(c); });
+    ++sanitizedStrings;
+    strippedCodepoints += tainted.size() - cleaned.size();
     return QString::fromStdU32String(cleaned);
 }
 
@@ -91,3 +160,13 @@ const QByteArray& ToxString::getBytes() const
 {
     return string;
 }
+
+uint64_t ToxString::totalSanitizedStrings()
+{
+    return sanitizedStrings.load();
+}
+
+uint64_t ToxString::totalStrippedCodepoints()
+{
+    return strippedCodepoints.load();
+}
@@ -15,6 +15,7 @@ class ToxString
 public:
     explicit ToxString(const QString& text);
     explicit ToxString(const QByteArray& text);
+    explicit ToxString(QByteArray&& text);
     ToxString(const uint8_t* text, size_t length);
 
     const uint8_t* data() const;
@@ -22,6 +23,12 @@ public:
     QString getQString() const;
     const QByteArray& getBytes() const;
 
+    static QString toQString(const uint8_t* text, size_t length);
+
+    // Sanitation counters summed over all conversions, for the debug pane
+    static uint64_t totalSanitizedStrings();
+    static uint64_t totalStrippedCodepoints();
+
 private:
     QByteArray string;
 };
@@ -0,0 +1,159 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "eventqueuemonitor.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMetaObject>
+#include <QTimer>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace {
+// How often a probe event is posted at low priority. Its queue wait bounds
+// the delay any input event would have seen behind the same backlog.
+constexpr int probeIntervalMs = 250;
+
+// Exponential-ish bucket bounds; the summary prints which bucket a
+// percentile falls into, which is plenty for spotting regressions.
+constexpr std::array<qint64, 8> bucketBoundsMs{1, 2, 5, 10, 25, 50, 100, 250};
+
+std::array<quint64, bucketBoundsMs.size() + 1> buckets{};
+quint64 totalProbes = 0;
+qint64 worstProbeMs = 0;
+
+// Queued signal deliveries per receiver class. Bounded in case dynamically
+// generated class names ever show up as receivers.
+QHash<QByteArray, quint64> metaCallCounts;
+constexpr int maxTrackedClasses = 256;
+
+quint64 totalEvents = 0;
+
+qint64 nowMs()
+{
+    static QElapsedTimer clock;
+    if (!clock.isValid()) {
+        clock.start();
+    }
+    return clock.elapsed();
+}
+
+qint64 percentileBoundMs(double percentile)
+{
+    const quint64 target = static_cast<quint64>(totalProbes * percentile);
+    quint64 seen = 0;
+    for (size_t i = 0; i < bucketBoundsMs.size(); ++i) {
+        seen += buckets[i];
+        if (seen > target) {
+            return bucketBoundsMs[i];
+        }
+    }
+    return worstProbeMs;
+}
+
+const QEvent::Type probeEventType = static_cast<QEvent::Type>(QEvent::registerEventType());
+
+class ProbeEvent : public QEvent
+{
+public:
+    ProbeEvent()
+        : QEvent(probeEventType)
+        , postedMs(nowMs())
+    {
+    }
+
+    qint64 postedMs;
+};
+} // namespace
+
+EventQueueMonitor& EventQueueMonitor::instance()
+{
+    static EventQueueMonitor monitor;
+    return monitor;
+}
+
+/**
+ * @brief Installs the application-wide filter and starts the probe timer.
+ */
+void EventQueueMonitor::install()
+{
+    qApp->installEventFilter(this);
+
+    auto* probeTimer = new QTimer(this);
+    probeTimer->setInterval(probeIntervalMs);
+    connect(probeTimer, &QTimer::timeout, this, [this] {
+        // Low priority puts the probe behind every already-queued event, so
+        // its wait is an upper bound on the current backlog
+        QCoreApplication::postEvent(this, new ProbeEvent, Qt::LowEventPriority);
+    });
+    probeTimer->start();
+}
+
+bool EventQueueMonitor::eventFilter(QObject* watched, QEvent* event)
+{
+    ++totalEvents;
+
+    if (event->type() == QEvent::MetaCall) {
+        if (metaCallCounts.size() >= maxTrackedClasses) {
+            metaCallCounts.clear();
+        }
+        ++metaCallCounts[QByteArray(watched->metaObject()->className())];
+    }
+
+    return false;
+}
+
+void EventQueueMonitor::customEvent(QEvent* event)
+{
+    if (event->type() != probeEventType) {
+        return;
+    }
+
+    const qint64 waitedMs = nowMs() - static_cast<ProbeEvent*>(event)->postedMs;
+    ++totalProbes;
+    worstProbeMs = qMax(worstProbeMs, waitedMs);
+
+    size_t bucket = 0;
+    while (bucket < bucketBoundsMs.size() && waitedMs > bucketBoundsMs[bucket]) {
+        ++bucket;
+    }
+    ++buckets[bucket];
+}
+
+/**
+ * @brief One-paragraph rundown of queue health for the debug pane.
+ */
+QString EventQueueMonitor::summary()
+{
+    if (totalProbes == 0) {
+        return QStringLiteral("Event queue: no probes recorded\n");
+    }
+
+    QString out =
+        QStringLiteral("Event queue: %1 events seen, probe wait p50 <= %2 ms, p90 <= %3 ms, "
+                       "p99 <= %4 ms, worst %5 ms\n")
+            .arg(totalEvents)
+            .arg(percentileBoundMs(0.50))
+            .arg(percentileBoundMs(0.90))
+            .arg(percentileBoundMs(0.99))
+            .arg(worstProbeMs);
+
+    std::vector<std::pair<QByteArray, quint64>> top(metaCallCounts.keyValueBegin(),
+                                                    metaCallCounts.keyValueEnd());
+    const size_t shown = std::min<size_t>(top.size(), 5);
+    std::partial_sort(top.begin(), top.begin() + shown, top.end(),
+                      [](const auto& a, const auto& b) { return a.second > b.second; });
+
+    for (size_t i = 0; i < shown; ++i) {
+        out += QStringLiteral("  queued signals -> %1: %2\n")
+                   .arg(QString::fromLatin1(top[i].first))
+                   .arg(top[i].second);
+    }
+
+    return out;
+}
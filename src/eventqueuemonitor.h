@@ -0,0 +1,37 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QString>
+
+/**
+ * @brief Samples the GUI event queue for the debug pane.
+ *
+ * Installed application-wide from Nexus at startup. Counts queued signal
+ * deliveries (MetaCall events) per receiver class and measures how long a
+ * low-priority probe event sits in the queue, so floods of low-value queued
+ * events that delay input handling show up as a name and a number instead of
+ * a hunch.
+ *
+ * Application event filters only run for objects on the main thread and the
+ * debug pane reads from there too, so no locking is needed.
+ */
+class EventQueueMonitor : public QObject
+{
+    Q_OBJECT
+public:
+    static EventQueueMonitor& instance();
+
+    void install();
+    static QString summary();
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+    void customEvent(QEvent* event) override;
+
+private:
+    EventQueueMonitor() = default;
+};
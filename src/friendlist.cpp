@@ -23,6 +23,7 @@ Friend* FriendList::addFriend(uint32_t friendId, const ToxPk& friendPk, Settings
     Friend* newFriend = new Friend(friendId, friendPk, alias);
     friendList[friendPk] = newFriend;
     id2key[friendId] = friendPk;
+    orderedFriends.append(newFriend);
 
     return newFriend;
 }
@@ -48,6 +49,7 @@ void FriendList::removeFriend(const ToxPk& friendPk, Settings& settings, bool fa
     if (f_it != friendList.end()) {
         if (!fake)
             settings.removeFriendSettings(f_it.value()->getPublicKey());
+        orderedFriends.removeOne(f_it.value());
         friendList.erase(f_it);
     }
 }
@@ -57,11 +59,12 @@ void FriendList::clear()
     for (auto friendPtr : friendList)
         delete friendPtr;
     friendList.clear();
+    orderedFriends.clear();
 }
 
-QList<Friend*> FriendList::getAllFriends()
+const QList<Friend*>& FriendList::getAllFriends() const
 {
-    return friendList.values();
+    return orderedFriends;
 }
 
 QString FriendList::decideNickname(const ToxPk& friendPk, const QString& origName)
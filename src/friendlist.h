@@ -8,9 +8,8 @@
 #include <cstdint>
 
 #include <QHash>
+#include <QList>
 
-template <class T>
-class QList;
 class Friend;
 class QByteArray;
 class QString;
@@ -23,7 +22,7 @@ public:
     Friend* addFriend(uint32_t friendId, const ToxPk& friendPk, Settings& settings);
     Friend* findFriend(const ToxPk& friendPk);
     const ToxPk& id2Key(uint32_t friendId);
-    QList<Friend*> getAllFriends();
+    const QList<Friend*>& getAllFriends() const;
     void removeFriend(const ToxPk& friendPk, Settings& settings, bool fake = false);
     void clear();
     QString decideNickname(const ToxPk& friendPk, const QString& origName);
@@ -31,4 +30,8 @@ public:
 private:
     QHash<ToxPk, Friend*> friendList;
     QHash<uint32_t, ToxPk> id2key;
+    // Kept in sync with friendList so iteration doesn't rebuild a values()
+    // list on every call; callers mutating the roster while iterating must
+    // take their own (implicitly shared) copy first
+    QList<Friend*> orderedFriends;
 };
@@ -6,6 +6,7 @@
 #include "src/ipc.h"
 #include <QCoreApplication>
 #include <QDebug>
+#include <QLocalSocket>
 #include <QThread>
 
 #include <chrono>
@@ -39,6 +40,16 @@ QString getIpcKey()
     }
     return QString("qtox-" IPC_PROTOCOL_VERSION "-") + QString::fromUtf8(user);
 }
+
+QString getNotifySocketName(uint32_t dest)
+{
+    if (dest == 0) {
+        return getIpcKey() + QStringLiteral("-global");
+    }
+    return getIpcKey() + QStringLiteral("-") + QString::number(dest);
+}
+
+const int NOTIFY_CONNECT_TIMEOUT_MS = 250;
 #endif
 } // namespace
 
@@ -53,6 +64,13 @@ QString getIpcKey()
 /**
  * @class IPC
  * @brief Inter-process communication
+ *
+ * Events live in a shared memory segment; delivery is notification-based.
+ * Each instance listens on a local socket named after its profile id, and the
+ * owner additionally listens on a global one. Posting an event writes it to
+ * shared memory and then connects to the destination's socket as a wakeup, so
+ * activation is immediate and an idle owner never polls. Secondary instances
+ * keep a slow watchdog timer only to take over ownership if the owner dies.
  */
 
 IPC::IPC(uint32_t profileId_)
@@ -63,9 +81,13 @@ IPC::IPC(uint32_t profileId_)
 {
     qRegisterMetaType<IPCEventHandler>("IPCEventHandler");
 
-    timer.setInterval(EVENT_TIMER_MS);
-    timer.setSingleShot(true);
-    connect(&timer, &QTimer::timeout, this, &IPC::processEvents);
+    ownershipTimer.setInterval(OWNERSHIP_TIMEOUT_S * 1000);
+    ownershipTimer.setSingleShot(true);
+    connect(&ownershipTimer, &QTimer::timeout, this, &IPC::processEvents);
+#ifndef ANDROID
+    connect(&globalNotifier, &QLocalServer::newConnection, this, &IPC::onNotification);
+    connect(&profileNotifier, &QLocalServer::newConnection, this, &IPC::onNotification);
+#endif
 
     // The first started instance gets to manage the shared memory by taking ownership
     // Every time it processes events it updates the global shared timestamp "lastProcessed"
@@ -100,6 +122,10 @@ IPC::IPC(uint32_t profileId_)
                  << globalMemory.error();
         return; // We won't be able to do any IPC without being attached, let's get outta here
     }
+
+    if (profileId != 0) {
+        listenNotifier(profileNotifier, profileId);
+    }
 #endif
 
     processEvents();
@@ -168,6 +194,10 @@ time_t IPC::postEvent(const QString& name, const QByteArray& data, uint32_t dest
     }
 
     globalMemory.unlock();
+
+    if (result != 0) {
+        notifyEvent(dest);
+    }
     return result;
 #endif
 }
@@ -242,7 +272,9 @@ bool IPC::waitUntilAccepted(time_t postTime, int32_t timeout /*=-1*/)
         }
 
         qApp->processEvents();
-        QThread::msleep(0);
+        // Acceptance is notified through the shared memory only, so check at a
+        // coarse interval rather than spinning
+        QThread::msleep(10);
     }
     return result;
 }
@@ -258,7 +290,17 @@ bool IPC::isAttached() const
 
 void IPC::setProfileId(uint32_t profileId_)
 {
+    if (profileId == profileId_) {
+        return;
+    }
+
     profileId = profileId_;
+#ifndef ANDROID
+    profileNotifier.close();
+    if (profileId != 0) {
+        listenNotifier(profileNotifier, profileId);
+    }
+#endif
 }
 
 /**
@@ -305,11 +347,10 @@ bool IPC::runEventHandler(IPCEventHandler handler, const QByteArray& arg, void*
 void IPC::processEvents()
 {
 #ifdef ANDROID
-    timer.start();
     return;
 #else
     if (!globalMemory.lock()) {
-        timer.start();
+        ownershipTimer.start();
         return;
     }
 
@@ -332,6 +373,8 @@ void IPC::processEvents()
         // Non-main instance is limited to events destined for specific profile it runs
     }
 
+    const bool owner = mem->globalId == globalId;
+
     const std::lock_guard<std::mutex> lock(eventHandlersMutex);
     while (IPCEvent* evt = fetchEvent()) {
         QString name = QString::fromUtf8(evt->name);
@@ -357,7 +400,85 @@ void IPC::processEvents()
     }
 
     globalMemory.unlock();
-    timer.start();
+
+    if (owner) {
+        // The owner is woken by posters through the notification socket, so it
+        // doesn't need to poll. A stale socket file from a crashed owner is
+        // taken over together with the shared memory ownership.
+        listenNotifier(globalNotifier, 0);
+        ownershipTimer.stop();
+    } else {
+        // Secondary instances only wake up to check whether the owner died
+        ownershipTimer.start();
+    }
+#endif
+}
+
+/**
+ * @brief Drains pending wakeup connections and processes the events behind them.
+ *
+ * The connection itself is the notification; it carries no payload.
+ */
+void IPC::onNotification()
+{
+#ifndef ANDROID
+    for (QLocalServer* server : {&globalNotifier, &profileNotifier}) {
+        while (QLocalSocket* socket = server->nextPendingConnection()) {
+            socket->deleteLater();
+        }
+    }
+    processEvents();
+#endif
+}
+
+/**
+ * @brief Wakes the instance responsible for an event that was just posted.
+ *
+ * If nobody listens yet the event simply stays in shared memory; whoever takes
+ * ownership next will process it from its watchdog pass.
+ */
+void IPC::notifyEvent(uint32_t dest)
+{
+#ifdef ANDROID
+    std::ignore = dest;
+#else
+    QLocalSocket socket;
+    socket.connectToServer(getNotifySocketName(dest));
+    if (!socket.waitForConnected(NOTIFY_CONNECT_TIMEOUT_MS)) {
+        qDebug() << "No notification listener for dest" << dest;
+        return;
+    }
+    socket.disconnectFromServer();
+#endif
+}
+
+/**
+ * @brief Starts listening for event notifications on the socket for @a dest.
+ * @return True if the server is listening when we return, false on error.
+ */
+bool IPC::listenNotifier(QLocalServer& server, uint32_t dest)
+{
+#ifdef ANDROID
+    std::ignore = server;
+    std::ignore = dest;
+    return false;
+#else
+    if (server.isListening()) {
+        return true;
+    }
+
+    const QString name = getNotifySocketName(dest);
+    if (!server.listen(name)) {
+        // Listening fails on the socket file left behind by a crashed
+        // instance; our claim to it is the shared memory ownership
+        QLocalServer::removeServer(name);
+        if (!server.listen(name)) {
+            qWarning() << "Failed to listen on notification socket" << name << ":"
+                       << server.errorString();
+            return false;
+        }
+    }
+    return true;
 #endif
 }
 
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <QLocalServer>
 #include <QMap>
 #include <QObject>
 #include <QSharedMemory>
@@ -16,14 +17,15 @@
 
 using IPCEventHandler = std::function<bool(const QByteArray&, void*)>;
 
-#define IPC_PROTOCOL_VERSION "2"
+// Version 3: event delivery is notification-based; older instances that only
+// write the shared memory would never wake a version 3 owner.
+#define IPC_PROTOCOL_VERSION "3"
 
 class IPC : public QObject
 {
     Q_OBJECT
 
 protected:
-    static const int EVENT_TIMER_MS = 1000;
     static const int EVENT_GC_TIMEOUT = 5;
     static const int EVENT_QUEUE_SIZE = 32;
     static const int OWNERSHIP_TIMEOUT_S = 5;
@@ -69,6 +71,9 @@ private:
     bool runEventHandler(IPCEventHandler handler, const QByteArray& arg, void* userData);
     IPCEvent* fetchEvent();
     void processEvents();
+    void onNotification();
+    void notifyEvent(uint32_t dest);
+    bool listenNotifier(QLocalServer& server, uint32_t dest);
     bool isCurrentOwnerNoLock();
 
 private:
@@ -77,11 +82,13 @@ private:
         IPCEventHandler handler;
         void* userData;
     };
-    QTimer timer;
+    QTimer ownershipTimer;
     uint64_t globalId;
     uint32_t profileId;
 #ifndef ANDROID
     QSharedMemory globalMemory;
+    QLocalServer globalNotifier;
+    QLocalServer profileNotifier;
 #endif
     mutable std::mutex eventHandlersMutex;
     QMap<QString, Callback> eventHandlers;
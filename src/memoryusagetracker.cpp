@@ -0,0 +1,114 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "memoryusagetracker.h"
+
+#include <QMutexLocker>
+#include <QTextStream>
+
+#include <algorithm>
+
+MemoryUsageTracker& MemoryUsageTracker::instance()
+{
+    static MemoryUsageTracker tracker;
+    return tracker;
+}
+
+/**
+ * @brief Registers one accounting source.
+ * @param owner Opaque tag used to unregister; usually the cache's this pointer.
+ * @param name Subsystem row shown in the dashboard; sources sharing a name sum up.
+ * @param usedBytes Returns the source's current resident bytes; called on the
+ * sampling thread, so it must be safe to invoke from there.
+ * @param trim Optional eviction hook invoked by "trim caches".
+ */
+void MemoryUsageTracker::registerSource(const void* owner, const QString& name,
+                                        std::function<quint64()> usedBytes,
+                                        std::function<void()> trim)
+{
+    QMutexLocker locker{&mutex};
+    sources.append({owner, name, std::move(usedBytes), std::move(trim)});
+}
+
+void MemoryUsageTracker::unregisterSource(const void* owner)
+{
+    QMutexLocker locker{&mutex};
+    sources.removeIf([owner](const Source& source) { return source.owner == owner; });
+}
+
+/**
+ * @brief Polls every source and returns one row per subsystem name.
+ *
+ * Also advances the per-name high-water marks, so sampling regularly (the
+ * debug pane refreshes once a second while visible) is what gives the marks
+ * their resolution.
+ */
+QList<MemoryUsageTracker::Sample> MemoryUsageTracker::sample()
+{
+    QMutexLocker locker{&mutex};
+
+    QList<Sample> samples;
+    for (const Source& source : sources) {
+        const quint64 bytes = source.usedBytes ? source.usedBytes() : 0;
+        const auto existing =
+            std::find_if(samples.begin(), samples.end(),
+                         [&source](const Sample& sample) { return sample.name == source.name; });
+        if (existing != samples.end()) {
+            existing->bytes += bytes;
+            existing->trimmable = existing->trimmable || static_cast<bool>(source.trim);
+        } else {
+            samples.append({source.name, bytes, 0, static_cast<bool>(source.trim)});
+        }
+    }
+
+    for (Sample& sample : samples) {
+        quint64& mark = highWater[sample.name];
+        mark = qMax(mark, sample.bytes);
+        sample.highWaterBytes = mark;
+    }
+
+    return samples;
+}
+
+/**
+ * @brief Invokes every registered trim callback.
+ *
+ * The callbacks run outside the registry lock, so a trim that ends up
+ * re-entering the tracker (e.g. by destroying a registered object) cannot
+ * deadlock.
+ */
+void MemoryUsageTracker::trimAll()
+{
+    QVector<std::function<void()>> trims;
+    {
+        QMutexLocker locker{&mutex};
+        for (const Source& source : sources) {
+            if (source.trim) {
+                trims.append(source.trim);
+            }
+        }
+    }
+
+    for (const auto& trim : trims) {
+        trim();
+    }
+}
+
+QString MemoryUsageTracker::toString(const QList<Sample>& samples)
+{
+    QString result;
+    QTextStream stream{&result};
+
+    quint64 totalBytes = 0;
+    stream << "Subsystem memory usage (bytes / high water):\n";
+    for (const Sample& sample : samples) {
+        stream << "  " << sample.name << ": " << sample.bytes << " / " << sample.highWaterBytes
+               << (sample.trimmable ? "" : " (not trimmable)") << "\n";
+        totalBytes += sample.bytes;
+    }
+    stream << "Total accounted: " << totalBytes << " bytes\n";
+    stream << "\nCounts cover registered caches and pools only, not every allocation.\n";
+
+    return result;
+}
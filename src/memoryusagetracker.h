@@ -0,0 +1,64 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+/**
+ * @brief Central registry of per-subsystem memory accounting.
+ *
+ * Long-lived caches and pools register a byte-counting callback (and
+ * optionally a trim callback) here; the debug pane samples them all to show
+ * where resident memory lives, with high-water marks per subsystem so a
+ * week-old session's RSS creep can be attributed after the fact. Sources
+ * sharing a name are summed into one row, so every open chat view can
+ * report under "Chat scenes" without the dashboard churning.
+ *
+ * Registration and sampling may happen on different threads; the byte
+ * callbacks must therefore be safe to invoke from the sampling thread.
+ */
+class MemoryUsageTracker
+{
+public:
+    struct Sample
+    {
+        QString name;
+        quint64 bytes;
+        quint64 highWaterBytes;
+        bool trimmable;
+    };
+
+    static MemoryUsageTracker& instance();
+
+    void registerSource(const void* owner, const QString& name,
+                        std::function<quint64()> usedBytes, std::function<void()> trim = {});
+    void unregisterSource(const void* owner);
+
+    QList<Sample> sample();
+    void trimAll();
+
+    static QString toString(const QList<Sample>& samples);
+
+private:
+    struct Source
+    {
+        const void* owner;
+        QString name;
+        std::function<quint64()> usedBytes;
+        std::function<void()> trim;
+    };
+
+    QVector<Source> sources;
+    // High-water marks outlive their sources, so a cache that was torn down
+    // still shows what it peaked at
+    QHash<QString, quint64> highWater;
+    QMutex mutex;
+};
@@ -130,3 +130,13 @@ bool AboutFriend::isHistoryExistence()
 
     return false;
 }
+
+QList<ConnectionQualityLog::Sample> AboutFriend::getConnectionQuality() const
+{
+    ConnectionQualityLog* const log = profile.getConnectionQualityLog();
+    if (log) {
+        return log->getSamples(f->getPublicKey());
+    }
+
+    return {};
+}
@@ -43,6 +43,8 @@ public:
     bool clearHistory() override;
     bool isHistoryExistence() override;
 
+    QList<ConnectionQualityLog::Sample> getConnectionQuality() const override;
+
     SIGNAL_IMPL(AboutFriend, nameChanged, const QString&)
     SIGNAL_IMPL(AboutFriend, statusChanged, const QString&)
     SIGNAL_IMPL(AboutFriend, publicKeyChanged, const QString&)
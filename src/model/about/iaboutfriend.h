@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include "src/persistence/connectionqualitylog.h"
 #include "src/persistence/ifriendsettings.h"
 #include "util/interface.h"
 
@@ -41,6 +42,8 @@ public:
     virtual bool clearHistory() = 0;
     virtual bool isHistoryExistence() = 0;
 
+    virtual QList<ConnectionQualityLog::Sample> getConnectionQuality() const = 0;
+
     /* signals */
     DECLARE_SIGNAL(nameChanged, const QString&);
     DECLARE_SIGNAL(statusChanged, const QString&);
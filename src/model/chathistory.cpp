@@ -8,6 +8,8 @@
 #include "src/persistence/settings.h"
 #include "src/widget/form/chatform.h"
 
+#include <limits>
+
 namespace {
 /**
  * @brief Determines if the given idx needs to be loaded from history
@@ -42,6 +44,11 @@ ChatLogIdx findFirstMessage(const SessionChatLog& sessionChatLog)
  * @param[in/out] content
  * @return True if was an action
  */
+// Upper bound on items kept in the session window of a chat. Older items are
+// evicted once they are safely in the database and transparently reloaded on
+// access, so day-long sessions in busy conferences don't grow without bound.
+constexpr size_t maxSessionChatLogSize = 512;
+
 bool handleActionPrefix(QString& content)
 {
     // Unfortunately due to legacy reasons we have to continue
@@ -109,6 +116,12 @@ const ChatLogItem& ChatHistory::at(ChatLogIdx idx) const
 
 SearchResult ChatHistory::searchForward(SearchPos startIdx, const QString& phrase,
                                         const ParameterSearch& parameter) const
+{
+    return searchForwardChunked(startIdx, phrase, parameter, std::numeric_limits<size_t>::max());
+}
+
+SearchResult ChatHistory::searchForwardChunked(SearchPos startIdx, const QString& phrase,
+                                               const ParameterSearch& parameter, size_t maxItems) const
 {
     if (startIdx.logIdx >= getNextIdx()) {
         SearchResult res;
@@ -120,15 +133,23 @@ SearchResult ChatHistory::searchForward(SearchPos startIdx, const QString& phras
         ensureIdxInSessionChatLog(startIdx.logIdx);
     }
 
-    return sessionChatLog.searchForward(startIdx, phrase, parameter);
+    return sessionChatLog.searchForwardChunked(startIdx, phrase, parameter, maxItems);
 }
 
 SearchResult ChatHistory::searchBackward(SearchPos startIdx, const QString& phrase,
                                          const ParameterSearch& parameter) const
 {
-    auto res = sessionChatLog.searchBackward(startIdx, phrase, parameter);
+    return searchBackwardChunked(startIdx, phrase, parameter, std::numeric_limits<size_t>::max());
+}
+
+SearchResult ChatHistory::searchBackwardChunked(SearchPos startIdx, const QString& phrase,
+                                                const ParameterSearch& parameter, size_t maxItems) const
+{
+    auto res = sessionChatLog.searchBackwardChunked(startIdx, phrase, parameter, maxItems);
 
-    if (res.found || !canUseHistory()) {
+    // Only fall back to the database once the session chat log has actually
+    // been exhausted, not when a chunked scan merely ran out of budget
+    if (res.found || !res.completed || !canUseHistory()) {
         return res;
     }
 
@@ -201,8 +222,32 @@ void ChatHistory::addSystemMessage(const SystemMessage& message)
     }
 
     sessionChatLog.addSystemMessage(message);
+    trimSessionChatLog();
 }
 
+/**
+ * @brief Returns this chat's activity statistics, backfilling them from the
+ * database on first access.
+ *
+ * Messages recorded live all carry timestamps at or after the engine's
+ * creation time, so bounding the backfill query to rows older than that
+ * keeps the two sources disjoint. The aggregation is one indexed GROUP BY,
+ * not a message load, so first access from the debug pane stays cheap even
+ * for years-old conferences.
+ */
+const ChatStatistics& ChatHistory::getStatistics()
+{
+    if (!statisticsBackfilled && canUseHistory()) {
+        const auto activity =
+            history->getChatActivityByHour(chat.getPersistentId(), statistics.createdAt());
+        for (const auto& hour : activity) {
+            statistics.seedHour(hour.hourSinceEpoch, hour.messageCount, hour.byteCount);
+        }
+        statisticsBackfilled = true;
+    }
+
+    return statistics;
+}
 
 void ChatHistory::onFileUpdated(const ToxPk& sender, const ToxFile& file)
 {
@@ -238,6 +283,7 @@ void ChatHistory::onFileUpdated(const ToxPk& sender, const ToxFile& file)
     }
 
     sessionChatLog.onFileUpdated(sender, file);
+    trimSessionChatLog();
 }
 
 void ChatHistory::onFileTransferRemotePausedUnpaused(const ToxPk& sender, const ToxFile& file,
@@ -264,7 +310,9 @@ void ChatHistory::onMessageReceived(const ToxPk& sender, const Message& message)
         history->addNewMessage(chatId, content, sender, message.timestamp, true, displayName);
     }
 
+    statistics.recordMessage(message.timestamp, message.content.toUtf8().size());
     sessionChatLog.onMessageReceived(sender, message);
+    trimSessionChatLog();
 }
 
 void ChatHistory::onMessageSent(DispatchedMessageId id, const Message& message)
@@ -286,7 +334,9 @@ void ChatHistory::onMessageSent(DispatchedMessageId id, const Message& message)
                                onInsertion);
     }
 
+    statistics.recordMessage(message.timestamp, message.content.toUtf8().size());
     sessionChatLog.onMessageSent(id, message);
+    trimSessionChatLog();
 }
 
 void ChatHistory::onMessageComplete(DispatchedMessageId id)
@@ -341,70 +391,75 @@ void ChatHistory::loadHistoryIntoSessionChatLog(ChatLogIdx start) const
     // We know that both history and us have a start index of 0 so the type
     // conversion should be safe
     assert(getFirstIdx() == ChatLogIdx(0));
-    auto messages = history->getMessagesForChat(chat.getPersistentId(), start.get(), end.get());
-
-    assert(messages.size() == static_cast<int>(end.get() - start.get()));
     ChatLogIdx nextIdx = start;
 
-    for (const auto& message : messages) {
-        // Note that message.id is _not_ a valid conversion here since it is a
-        // global id not a per-chat id like the ChatLogIdx
-        auto currentIdx = nextIdx++;
-        switch (message.content.getType()) {
-        case HistMessageContentType::file: {
-            const auto date = message.timestamp;
-            const auto file = message.content.asFile();
-            const auto chatLogFile = ChatLogFile{date, file};
-            sessionChatLog.insertFileAtIdx(currentIdx, message.sender, message.dispName, chatLogFile);
-            break;
-        }
-        case HistMessageContentType::message: {
-            auto messageContent = message.content.asMessage();
-
-            auto isAction = handleActionPrefix(messageContent);
-
-            // It's okay to skip the message processor here. The processor is
-            // meant to convert between boundaries of our internal
-            // representation. We already had to go through the processor before
-            // we hit IMessageDispatcher's signals which history listens for.
-            // Items added to history have already been sent so we know they already
-            // reflect what was sent/received.
-            auto processedMessage = Message{isAction, messageContent, message.timestamp, {}};
-
-            auto dispatchedMessageIt =
-                std::find_if(dispatchedMessageRowIdMap.begin(), dispatchedMessageRowIdMap.end(),
-                             [&](RowId dispatchedId) { return dispatchedId == message.id; });
-
-            assert((message.state != MessageState::pending
-                    && dispatchedMessageIt == dispatchedMessageRowIdMap.end())
-                   || (message.state == MessageState::pending
-                       && dispatchedMessageIt != dispatchedMessageRowIdMap.end()));
-
-            auto chatLogMessage = ChatLogMessage{message.state, processedMessage};
-            switch (message.state) {
-            case MessageState::complete:
-                sessionChatLog.insertCompleteMessageAtIdx(currentIdx, message.sender,
-                                                          message.dispName, chatLogMessage);
-                break;
-            case MessageState::pending:
-                sessionChatLog.insertIncompleteMessageAtIdx(currentIdx, message.sender,
-                                                            message.dispName, chatLogMessage,
-                                                            dispatchedMessageIt.key());
-                break;
-            case MessageState::broken:
-                sessionChatLog.insertBrokenMessageAtIdx(currentIdx, message.sender,
-                                                        message.dispName, chatLogMessage);
-                break;
+    // Stream the range out of the database page by page so opening a chat with
+    // years of history never materializes more than one page at a time
+    history->streamMessagesForChat(
+        chat.getPersistentId(), start.get(), end.get(),
+        [&](QList<History::HistMessage> messages) {
+            for (const auto& message : messages) {
+                // Note that message.id is _not_ a valid conversion here since it is a
+                // global id not a per-chat id like the ChatLogIdx
+                auto currentIdx = nextIdx++;
+                switch (message.content.getType()) {
+                case HistMessageContentType::file: {
+                    const auto date = message.timestamp;
+                    const auto file = message.content.asFile();
+                    const auto chatLogFile = ChatLogFile{date, file};
+                    sessionChatLog.insertFileAtIdx(currentIdx, message.sender, message.dispName,
+                                                   chatLogFile);
+                    break;
+                }
+                case HistMessageContentType::message: {
+                    auto messageContent = message.content.asMessage();
+
+                    auto isAction = handleActionPrefix(messageContent);
+
+                    // It's okay to skip the message processor here. The processor is
+                    // meant to convert between boundaries of our internal
+                    // representation. We already had to go through the processor before
+                    // we hit IMessageDispatcher's signals which history listens for.
+                    // Items added to history have already been sent so we know they already
+                    // reflect what was sent/received.
+                    auto processedMessage = Message{isAction, messageContent, message.timestamp, {}};
+
+                    auto dispatchedMessageIt =
+                        std::find_if(dispatchedMessageRowIdMap.begin(),
+                                     dispatchedMessageRowIdMap.end(),
+                                     [&](RowId dispatchedId) { return dispatchedId == message.id; });
+
+                    assert((message.state != MessageState::pending
+                            && dispatchedMessageIt == dispatchedMessageRowIdMap.end())
+                           || (message.state == MessageState::pending
+                               && dispatchedMessageIt != dispatchedMessageRowIdMap.end()));
+
+                    auto chatLogMessage = ChatLogMessage{message.state, processedMessage};
+                    switch (message.state) {
+                    case MessageState::complete:
+                        sessionChatLog.insertCompleteMessageAtIdx(currentIdx, message.sender,
+                                                                  message.dispName, chatLogMessage);
+                        break;
+                    case MessageState::pending:
+                        sessionChatLog.insertIncompleteMessageAtIdx(currentIdx, message.sender,
+                                                                    message.dispName, chatLogMessage,
+                                                                    dispatchedMessageIt.key());
+                        break;
+                    case MessageState::broken:
+                        sessionChatLog.insertBrokenMessageAtIdx(currentIdx, message.sender,
+                                                                message.dispName, chatLogMessage);
+                        break;
+                    }
+                    break;
+                }
+                case HistMessageContentType::system: {
+                    const auto& systemMessage = message.content.asSystemMessage();
+                    sessionChatLog.insertSystemMessageAtIdx(currentIdx, systemMessage);
+                    break;
+                }
+                }
             }
-            break;
-        }
-        case HistMessageContentType::system: {
-            const auto& systemMessage = message.content.asSystemMessage();
-            sessionChatLog.insertSystemMessageAtIdx(currentIdx, systemMessage);
-            break;
-        }
-        }
-    }
+        });
 
     assert(nextIdx == end);
 }
@@ -490,6 +545,21 @@ bool ChatHistory::canUseHistory() const
     return history && settings.getEnableLogging();
 }
 
+/**
+ * @brief Bounds the in-memory session window after an insertion
+ *
+ * Evicted items are below sessionChatLog's first index, so any later access
+ * through at() or the search functions reloads them from the database via
+ * ensureIdxInSessionChatLog(). Without history to reload from, everything is
+ * kept.
+ */
+void ChatHistory::trimSessionChatLog()
+{
+    if (canUseHistory()) {
+        sessionChatLog.trimOldestItems(maxSessionChatLogSize);
+    }
+}
+
 /**
  * @brief Gets the initial chat log index for a sessionChatLog with 0 items loaded from history.
  * Needed to keep history indexes in sync with chat log indexes
@@ -8,6 +8,7 @@
 #include "ichatlog.h"
 #include "sessionchatlog.h"
 #include "src/model/brokenmessagereason.h"
+#include "src/model/chatstatistics.h"
 #include "src/persistence/history.h"
 
 #include <QSet>
@@ -28,10 +29,17 @@ public:
                                const ParameterSearch& parameter) const override;
     SearchResult searchBackward(SearchPos startIdx, const QString& phrase,
                                 const ParameterSearch& parameter) const override;
+    SearchResult searchForwardChunked(SearchPos startIdx, const QString& phrase,
+                                      const ParameterSearch& parameter,
+                                      size_t maxItems) const override;
+    SearchResult searchBackwardChunked(SearchPos startIdx, const QString& phrase,
+                                       const ParameterSearch& parameter,
+                                       size_t maxItems) const override;
     ChatLogIdx getFirstIdx() const override;
     ChatLogIdx getNextIdx() const override;
     std::vector<DateChatLogIdxPair> getDateIdxs(const QDate& startDate, size_t maxDates) const override;
     void addSystemMessage(const SystemMessage& message) override;
+    const ChatStatistics& getStatistics();
 
 public slots:
     void onFileUpdated(const ToxPk& sender, const ToxFile& file);
@@ -53,6 +61,7 @@ private:
     void completeMessage(DispatchedMessageId id);
     void breakMessage(DispatchedMessageId id, BrokenMessageReason reason);
     bool canUseHistory() const;
+    void trimSessionChatLog();
     ChatLogIdx getInitialChatLogIdx() const;
 
     Chat& chat;
@@ -71,4 +80,9 @@ private:
     // If a message is inserted into history before it gets a completion
     // callback it will end up in this map
     QMap<DispatchedMessageId, RowId> dispatchedMessageRowIdMap;
+
+    // Activity aggregates fed live by the message slots; pre-existing
+    // history is merged in by the first getStatistics() call
+    ChatStatistics statistics;
+    bool statisticsBackfilled = false;
 };
@@ -0,0 +1,132 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "chatstatistics.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+qint64 toHourSinceEpoch(const QDateTime& timestamp)
+{
+    return timestamp.toSecsSinceEpoch() / 3600;
+}
+} // namespace
+
+ChatStatistics::ChatStatistics()
+    : creationTime{QDateTime::currentDateTimeUtc()}
+{
+}
+
+/**
+ * @brief Folds one live message into the aggregates.
+ * @param timestamp Message timestamp, as stored in the chat log.
+ * @param bytes Size of the message body in bytes.
+ */
+void ChatStatistics::recordMessage(const QDateTime& timestamp, size_t bytes)
+{
+    const qint64 hour = toHourSinceEpoch(timestamp);
+    if (hour < 0) {
+        return;
+    }
+
+    HourBucket& bucket = ring[hour % ringHours];
+    if (bucket.hourSinceEpoch != hour) {
+        bucket = HourBucket{hour, 0, 0};
+    }
+    ++bucket.messages;
+    bucket.bytes += bytes;
+
+    ++perHourOfDay[hour % 24];
+    ++totalMessageCount;
+    totalByteCount += bytes;
+}
+
+/**
+ * @brief Merges one hour of pre-existing history into the aggregates.
+ *
+ * Intended for a single backfill pass over rows older than createdAt();
+ * seeding an hour that live recording already owns would double count.
+ */
+void ChatStatistics::seedHour(qint64 hourSinceEpoch, quint32 messages, quint64 bytes)
+{
+    if (hourSinceEpoch < 0 || messages == 0) {
+        return;
+    }
+
+    perHourOfDay[hourSinceEpoch % 24] += messages;
+    totalMessageCount += messages;
+    totalByteCount += bytes;
+
+    HourBucket& bucket = ring[hourSinceEpoch % ringHours];
+    if (bucket.hourSinceEpoch == hourSinceEpoch) {
+        bucket.messages += messages;
+        bucket.bytes += bytes;
+    } else if (bucket.hourSinceEpoch < hourSinceEpoch) {
+        // Empty slot or one holding an hour the ring has already outgrown
+        bucket = HourBucket{hourSinceEpoch, messages, bytes};
+    }
+}
+
+QDateTime ChatStatistics::createdAt() const
+{
+    return creationTime;
+}
+
+quint64 ChatStatistics::totalMessages() const
+{
+    return totalMessageCount;
+}
+
+quint64 ChatStatistics::totalBytes() const
+{
+    return totalByteCount;
+}
+
+/**
+ * @brief Returns the aggregate for one hour, or a zero bucket if the hour
+ * has aged out of the ring.
+ */
+ChatStatistics::HourBucket ChatStatistics::hourBucket(qint64 hourSinceEpoch) const
+{
+    if (hourSinceEpoch < 0) {
+        return {};
+    }
+
+    const HourBucket& bucket = ring[hourSinceEpoch % ringHours];
+    if (bucket.hourSinceEpoch != hourSinceEpoch) {
+        return {};
+    }
+    return bucket;
+}
+
+const std::array<quint32, 24>& ChatStatistics::messagesByHourOfDay() const
+{
+    return perHourOfDay;
+}
+
+/**
+ * @brief UTC hour of day with the most messages over the chat's lifetime.
+ */
+int ChatStatistics::peakHourOfDay() const
+{
+    const auto peak = std::max_element(perHourOfDay.begin(), perHourOfDay.end());
+    return static_cast<int>(std::distance(perHourOfDay.begin(), peak));
+}
+
+/**
+ * @brief Average message rate over the ring window ending at @a now.
+ */
+double ChatStatistics::messagesPerHour(const QDateTime& now) const
+{
+    const qint64 nowHour = toHourSinceEpoch(now);
+    quint64 recentMessages = 0;
+    for (const HourBucket& bucket : ring) {
+        if (bucket.hourSinceEpoch > nowHour - static_cast<qint64>(ringHours)
+            && bucket.hourSinceEpoch <= nowHour) {
+            recentMessages += bucket.messages;
+        }
+    }
+    return static_cast<double>(recentMessages) / ringHours;
+}
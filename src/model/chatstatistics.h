@@ -0,0 +1,61 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include <QDateTime>
+
+#include <array>
+#include <cstddef>
+
+/**
+ * @brief Incremental per-chat activity statistics for the debug tooling.
+ *
+ * Keeps a ring of hourly aggregates (message count and body bytes) for the
+ * most recent two days, an hour-of-day histogram and lifetime totals. Live
+ * messages are folded in as they pass through ChatHistory, so reading the
+ * statistics never touches the database; older history can be merged in
+ * once via seedHour() from a single aggregated SQL query.
+ *
+ * All updates happen on the GUI thread, so the state needs no locking.
+ */
+class ChatStatistics
+{
+public:
+    // Two days of hourly buckets; enough to eyeball a noisy conference
+    // without the ring growing with chat age
+    static constexpr size_t ringHours = 48;
+
+    struct HourBucket
+    {
+        qint64 hourSinceEpoch = -1;
+        quint32 messages = 0;
+        quint64 bytes = 0;
+    };
+
+    ChatStatistics();
+
+    void recordMessage(const QDateTime& timestamp, size_t bytes);
+    void seedHour(qint64 hourSinceEpoch, quint32 messages, quint64 bytes);
+
+    QDateTime createdAt() const;
+    quint64 totalMessages() const;
+    quint64 totalBytes() const;
+    HourBucket hourBucket(qint64 hourSinceEpoch) const;
+    const std::array<quint32, 24>& messagesByHourOfDay() const;
+    int peakHourOfDay() const;
+    double messagesPerHour(const QDateTime& now = QDateTime::currentDateTimeUtc()) const;
+
+private:
+    // Slotted by hourSinceEpoch % ringHours; a bucket is overwritten when a
+    // newer hour lands in its slot, so stale hours age out without upkeep
+    std::array<HourBucket, ringHours> ring;
+    // Message counts per UTC hour of day, for the "peak hours" readout
+    std::array<quint32, 24> perHourOfDay{};
+    quint64 totalMessageCount = 0;
+    quint64 totalByteCount = 0;
+    // Backfill merges only rows older than this, so rows recorded live are
+    // never counted twice
+    QDateTime creationTime;
+};
@@ -16,6 +16,14 @@
 
 namespace {
 const int MAX_CONFERENCE_TITLE_LENGTH = 128;
+
+// toxcore fires a peer list change per connecting peer; coalescing a short
+// burst into one regeneration keeps the UI from relayouting per peer
+const int PEER_LIST_COALESCE_MS = 250;
+
+// How long peers restored from the state cache may stay in the list without
+// toxcore confirming them; long enough for a normal reconnect sync
+const qint64 CACHED_PEER_GRACE_MS = 60 * 1000;
 } // namespace
 
 Conference::Conference(int conferenceId_, const ConferenceId persistentConferenceId,
@@ -36,6 +44,9 @@ Conference::Conference(int conferenceId_, const ConferenceId persistentConferenc
     // on naming is appropriate
     hasNewMessages = false;
     userWasMentioned = false;
+    peerListUpdateTimer.setSingleShot(true);
+    peerListUpdateTimer.setInterval(PEER_LIST_COALESCE_MS);
+    connect(&peerListUpdateTimer, &QTimer::timeout, this, &Conference::regeneratePeerList);
     regeneratePeerList();
 }
 
@@ -95,9 +106,19 @@ void Conference::regeneratePeerList()
         } else {
             peerDisplayNames[pk] = friendList.decideNickname(pk, peers[i]);
         }
+        unconfirmedPeers.remove(pk);
     }
     for (const auto& pk : oldPeerNames.keys()) {
         if (!peerDisplayNames.contains(pk)) {
+            // Peers restored from the state cache stay listed until toxcore
+            // has had a fair chance to confirm them; the early peer lists of
+            // a reconnect sync only contain whoever has connected so far
+            if (unconfirmedPeers.contains(pk) && cacheSeedTimer.isValid()
+                && cacheSeedTimer.elapsed() < CACHED_PEER_GRACE_MS) {
+                peerDisplayNames.insert(pk, oldPeerNames.value(pk));
+                continue;
+            }
+            unconfirmedPeers.remove(pk);
             emit userLeft(pk, oldPeerNames.value(pk));
         }
     }
@@ -111,8 +132,47 @@ void Conference::regeneratePeerList()
             emit peerNameChanged(pk, oldPeerNames.value(pk), peerDisplayNames.value(pk));
         }
     }
-    if (oldPeerNames.size() != nPeers) {
-        emit numPeersChanged(nPeers);
+    if (oldPeerNames.size() != peerDisplayNames.size()) {
+        emit numPeersChanged(peerDisplayNames.size());
+    }
+}
+
+/**
+ * @brief Coalesces a burst of peer list change events into one regeneration.
+ *
+ * toxcore reports a peer list change for every single peer connection, which
+ * during a (re)join means one full peer list diff and relayout per joining
+ * peer. Deferring the regeneration slightly batches them.
+ */
+void Conference::schedulePeerListRegeneration()
+{
+    if (!peerListUpdateTimer.isActive()) {
+        peerListUpdateTimer.start();
+    }
+}
+
+/**
+ * @brief Pre-populates the peer list from the conference state cache.
+ *
+ * Called once right after construction, before any UI is built on top of
+ * this conference, so restored windows show the last-known peers instead of
+ * filling in one peer at a time. Seeded peers are reconciled against the
+ * live peer list as toxcore syncs and dropped if they are not confirmed
+ * within a grace period.
+ */
+void Conference::seedCachedPeers(const QMap<ToxPk, QString>& cachedPeers)
+{
+    for (auto it = cachedPeers.cbegin(); it != cachedPeers.cend(); ++it) {
+        if (it.key() == idHandler.getSelfPublicKey() || peerDisplayNames.contains(it.key())) {
+            continue;
+        }
+        peerDisplayNames.insert(it.key(), friendList.decideNickname(it.key(), it.value()));
+        unconfirmedPeers.insert(it.key());
+    }
+
+    if (!unconfirmedPeers.isEmpty()) {
+        cacheSeedTimer.start();
+        emit numPeersChanged(peerDisplayNames.size());
     }
 }
 
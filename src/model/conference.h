@@ -13,9 +13,12 @@
 #include "src/core/icoreidhandler.h"
 #include "src/core/toxpk.h"
 
+#include <QElapsedTimer>
 #include <QMap>
 #include <QObject>
+#include <QSet>
 #include <QStringList>
+#include <QTimer>
 
 class FriendList;
 
@@ -31,6 +34,8 @@ public:
     const ConferenceId& getPersistentId() const override;
     int getPeersCount() const;
     void regeneratePeerList();
+    void schedulePeerListRegeneration();
+    void seedCachedPeers(const QMap<ToxPk, QString>& cachedPeers);
     const QMap<ToxPk, QString>& getPeerList() const;
     bool peerHasNickname(ToxPk pk);
 
@@ -64,6 +69,9 @@ private:
     QString selfName;
     QString title;
     QMap<ToxPk, QString> peerDisplayNames;
+    QSet<ToxPk> unconfirmedPeers;
+    QElapsedTimer cacheSeedTimer;
+    QTimer peerListUpdateTimer;
     bool hasNewMessages;
     bool userWasMentioned;
     int toxConferenceNum;
@@ -8,6 +8,13 @@
 
 #include <QtCore>
 
+namespace {
+// Dispatch counters for the debug pane. All dispatchers run on the GUI
+// thread, so plain integers suffice
+quint64 dispatchedMessages = 0;
+quint64 dispatchedParts = 0;
+} // namespace
+
 ConferenceMessageDispatcher::ConferenceMessageDispatcher(Conference& g_, MessageProcessor processor_,
                                                          ICoreIdHandler& idHandler_,
                                                          ICoreConferenceMessageSender& messageSender_,
@@ -27,16 +34,25 @@ ConferenceMessageDispatcher::sendMessage(bool isAction, const QString& content)
     const auto firstMessageId = nextMessageId;
     auto lastMessageId = firstMessageId;
 
-    for (const auto& message : processor.processOutgoingMessage(isAction, content)) {
+    const auto messages = processor.processOutgoingMessage(isAction, content);
+
+    // Submit all split parts as one batch so the sender pays its per-call
+    // overhead once per logical message rather than once per part
+    if (conference.getPeersCount() != 1 && !messages.empty()) {
+        QStringList parts;
+        parts.reserve(static_cast<qsizetype>(messages.size()));
+        for (const auto& message : messages) {
+            parts += message.content;
+        }
+        messageSender.sendConferenceMessageBatch(conference.getId(), isAction, parts);
+    }
+
+    dispatchedMessages++;
+    dispatchedParts += messages.size();
+
+    for (const auto& message : messages) {
         auto messageId = nextMessageId++;
         lastMessageId = messageId;
-        if (conference.getPeersCount() != 1) {
-            if (message.isAction) {
-                messageSender.sendConferenceAction(conference.getId(), message.content);
-            } else {
-                messageSender.sendConferenceMessage(conference.getId(), message.content);
-            }
-        }
 
         // Emit both signals since we do not have receipts for conferences
         //
@@ -51,6 +67,22 @@ ConferenceMessageDispatcher::sendMessage(bool isAction, const QString& content)
     return std::make_pair(firstMessageId, lastMessageId);
 }
 
+/**
+ * @brief Number of logical messages sent through conference dispatchers
+ */
+quint64 ConferenceMessageDispatcher::totalDispatchedMessages()
+{
+    return dispatchedMessages;
+}
+
+/**
+ * @brief Number of split parts those messages were submitted as
+ */
+quint64 ConferenceMessageDispatcher::totalDispatchedParts()
+{
+    return dispatchedParts;
+}
+
 /**
  * @brief Processes and dispatches received message from toxcore
  * @param[in] sender
@@ -31,6 +31,9 @@ public:
 
     void onMessageReceived(const ToxPk& sender, bool isAction, const QString& content);
 
+    static quint64 totalDispatchedMessages();
+    static quint64 totalDispatchedParts();
+
 private:
     Conference& conference;
     MessageProcessor processor;
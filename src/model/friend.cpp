@@ -170,3 +170,18 @@ Status::Status Friend::getStatus() const
 {
     return friendStatus;
 }
+
+/**
+ * @brief Updates the cached last-activity timestamp. The caller is responsible
+ *        for persisting it through Settings; this copy only feeds the roster's
+ *        activity sort.
+ */
+void Friend::setLastActivity(const QDateTime& time)
+{
+    lastActivity = time;
+}
+
+const QDateTime& Friend::getLastActivity() const
+{
+    return lastActivity;
+}
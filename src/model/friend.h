@@ -9,6 +9,7 @@
 #include "src/core/chatid.h"
 #include "src/core/toxpk.h"
 #include "src/model/status.h"
+#include <QDateTime>
 #include <QObject>
 #include <QString>
 
@@ -40,6 +41,9 @@ public:
     void setStatus(Status::Status s);
     Status::Status getStatus() const;
 
+    void setLastActivity(const QDateTime& time);
+    const QDateTime& getLastActivity() const;
+
 signals:
     void nameChanged(const ToxPk& friendId, const QString& name);
     void aliasChanged(const ToxPk& friendId, QString alias);
@@ -53,6 +57,9 @@ private:
     QString userAlias;
     QString statusMessage;
     ToxPk friendPk;
+    // In-memory copy of the persisted activity timestamp, so activity-sorting
+    // the roster doesn't take the Settings lock per friend
+    QDateTime lastActivity;
     uint32_t friendId;
     bool hasNewEvents;
     Status::Status friendStatus;
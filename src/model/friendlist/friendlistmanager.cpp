@@ -6,6 +6,74 @@
 #include "friendlistmanager.h"
 #include "src/widget/genericchatroomwidget.h"
 
+#include <algorithm>
+
+namespace {
+// Decorate-sort-undecorate: the orderings need uppercased names and activity
+// timestamps, which cost a virtual call plus string work (or a settings
+// lookup) per evaluation. Computed once per item and sort, or once per
+// comparison on the O(log n) binary-insert path.
+struct SortKey
+{
+    bool isConference;
+    bool isOnline;
+    QString upperName;
+    QDateTime lastActivity;
+};
+
+SortKey makeSortKey(const IFriendListItem& item)
+{
+    return {item.isConference(), item.isOnline(), item.getNameItem().toUpper(),
+            item.getLastActivity()};
+}
+
+bool lessByName(const SortKey& a, const SortKey& b, bool conferencesOnTop)
+{
+    if (a.isConference && !b.isConference) {
+        if (conferencesOnTop) {
+            return true;
+        }
+        return !b.isOnline;
+    }
+
+    if (!a.isConference && b.isConference) {
+        if (conferencesOnTop) {
+            return false;
+        }
+        return a.isOnline;
+    }
+
+    if (a.isOnline != b.isOnline) {
+        return a.isOnline;
+    }
+
+    return a.upperName < b.upperName;
+}
+
+bool lessByActivity(const SortKey& a, const SortKey& b)
+{
+    if (a.isConference || b.isConference) {
+        if (a.isConference && !b.isConference) {
+            return true;
+        }
+
+        if (!a.isConference && b.isConference) {
+            return false;
+        }
+        return a.upperName < b.upperName;
+    }
+
+    if (a.lastActivity.date() == b.lastActivity.date()) {
+        if (a.isOnline != b.isOnline) {
+            return a.isOnline;
+        }
+        return a.upperName < b.upperName;
+    }
+
+    return a.lastActivity > b.lastActivity;
+}
+} // namespace
+
 FriendListManager::FriendListManager(int countContacts_, QObject* parent)
     : QObject(parent)
 {
@@ -34,24 +102,50 @@ bool FriendListManager::getConferencesOnTop() const
 
 void FriendListManager::addFriendListItem(IFriendListItem* item)
 {
+    IFriendListItemPtr ptr;
     if (item->isConference() && item->getWidget() != nullptr) {
-        items.push_back(IFriendListItemPtr(item, [](IFriendListItem* conferenceItem) {
+        ptr = IFriendListItemPtr(item, [](IFriendListItem* conferenceItem) {
             conferenceItem->getWidget()->deleteLater();
-        }));
+        });
     } else {
-        items.push_back(IFriendListItemPtr(item));
+        ptr = IFriendListItemPtr(item);
     }
 
-    if (countContacts <= items.size()) {
-        countContacts = 0;
-        setSortRequired();
+    if (countContacts > 0 || needSort) {
+        // Startup fill or a full resort is pending anyway; order it later
+        items.push_back(std::move(ptr));
+        if (countContacts > 0) {
+            if (countContacts <= items.size()) {
+                countContacts = 0;
+                setSortRequired();
+            }
+        } else {
+            setSortRequired();
+        }
+        return;
     }
+
+    // The list is already ordered, so place the newcomer with a binary search
+    // instead of flagging an O(n log n) resort of the whole roster
+    const SortKey key = makeSortKey(*item);
+    const auto pos =
+        std::lower_bound(items.begin(), items.end(), key,
+                         [this](const IFriendListItemPtr& a, const SortKey& b) {
+                             return byName ? lessByName(makeSortKey(*a), b, conferencesOnTop)
+                                           : lessByActivity(makeSortKey(*a), b);
+                         });
+    items.insert(pos, std::move(ptr));
+    membersChanged = true;
+    emit itemsChanged();
 }
 
 void FriendListManager::removeFriendListItem(IFriendListItem* item)
 {
+    // Removal preserves the relative order of everything else, so the view
+    // only needs repositioning, not a resort
     removeAll(item);
-    setSortRequired();
+    membersChanged = true;
+    emit itemsChanged();
 }
 
 void FriendListManager::sortByName()
@@ -127,32 +221,37 @@ void FriendListManager::updatePositions()
 {
     positionsChanged = true;
 
-    if (byName) {
-        auto sortName = [&](const IFriendListItemPtr& a, const IFriendListItemPtr& b) {
-            return cmpByName(a, b);
-        };
-        if (!needSort) {
-            if (std::is_sorted(items.begin(), items.end(), sortName)) {
-                positionsChanged = false;
-                return;
-            }
-        }
-        std::sort(items.begin(), items.end(), sortName);
+    struct KeyedItem
+    {
+        SortKey key;
+        IFriendListItemPtr item;
+    };
 
-    } else {
-        auto sortActivity = [&](const IFriendListItemPtr& a, const IFriendListItemPtr& b) {
-            return cmpByActivity(a, b);
-        };
-        if (!needSort) {
-            if (std::is_sorted(items.begin(), items.end(), sortActivity)) {
-                positionsChanged = false;
-                return;
-            }
-        }
-        std::sort(items.begin(), items.end(), sortActivity);
+    QVector<KeyedItem> keyed;
+    keyed.reserve(items.size());
+    for (const IFriendListItemPtr& item : items) {
+        keyed.push_back({makeSortKey(*item), item});
+    }
+
+    const auto less = [this](const KeyedItem& a, const KeyedItem& b) {
+        return byName ? lessByName(a.key, b.key, conferencesOnTop) : lessByActivity(a.key, b.key);
+    };
+
+    if (!needSort && std::is_sorted(keyed.begin(), keyed.end(), less)) {
+        // Binary inserts and removals keep the order intact, but membership
+        // changes still require the view to reposition its widgets
+        positionsChanged = membersChanged;
+        membersChanged = false;
+        return;
+    }
+    std::sort(keyed.begin(), keyed.end(), less);
+
+    for (int i = 0; i < keyed.size(); ++i) {
+        items[i] = keyed[i].item;
     }
 
     needSort = false;
+    membersChanged = false;
 }
 
 void FriendListManager::setSortRequired()
@@ -176,58 +275,3 @@ void FriendListManager::removeAll(IFriendListItem* item)
     }
 }
 
-bool FriendListManager::cmpByName(const IFriendListItemPtr& a, const IFriendListItemPtr& b)
-{
-    if (a->isConference() && !b->isConference()) {
-        if (conferencesOnTop) {
-            return true;
-        }
-        return !b->isOnline();
-    }
-
-    if (!a->isConference() && b->isConference()) {
-        if (conferencesOnTop) {
-            return false;
-        }
-        return a->isOnline();
-    }
-
-    if (a->isOnline() && !b->isOnline()) {
-        return true;
-    }
-
-    if (!a->isOnline() && b->isOnline()) {
-        return false;
-    }
-
-    return a->getNameItem().toUpper() < b->getNameItem().toUpper();
-}
-
-bool FriendListManager::cmpByActivity(const IFriendListItemPtr& a, const IFriendListItemPtr& b)
-{
-    if (a->isConference() || b->isConference()) {
-        if (a->isConference() && !b->isConference()) {
-            return true;
-        }
-
-        if (!a->isConference() && b->isConference()) {
-            return false;
-        }
-        return a->getNameItem().toUpper() < b->getNameItem().toUpper();
-    }
-
-    QDateTime dateA = a->getLastActivity();
-    QDateTime dateB = b->getLastActivity();
-    if (dateA.date() == dateB.date()) {
-        if (a->isOnline() && !b->isOnline()) {
-            return true;
-        }
-
-        if (!a->isOnline() && b->isOnline()) {
-            return false;
-        }
-        return a->getNameItem().toUpper() < b->getNameItem().toUpper();
-    }
-
-    return a->getLastActivity() > b->getLastActivity();
-}
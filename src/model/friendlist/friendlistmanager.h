@@ -52,14 +52,15 @@ private:
     } filterParams;
 
     void removeAll(IFriendListItem* item);
-    bool cmpByName(const IFriendListItemPtr& itemA, const IFriendListItemPtr& itemB);
-    bool cmpByActivity(const IFriendListItemPtr& itemA, const IFriendListItemPtr& itemB);
 
     bool byName = true;
     bool hideCircles = false;
     bool conferencesOnTop = true;
     bool positionsChanged = false;
     bool needSort = false;
+    // Items were inserted or removed since the last updatePositions(); the
+    // order may still hold, but the view needs to reposition widgets
+    bool membersChanged = false;
     QVector<IFriendListItemPtr> items;
     // At startup, while the size of items is less than countContacts, the view will not be processed to improve performance
     int countContacts = 0;
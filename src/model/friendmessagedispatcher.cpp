@@ -7,6 +7,16 @@
 #include "src/model/status.h"
 #include "src/persistence/settings.h"
 
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+
+namespace {
+// Cross-dispatcher queue depth gauges surfaced in the debug pane
+std::atomic_size_t interactiveQueueGauge{0};
+std::atomic_size_t resendQueueGauge{0};
+} // namespace
+
 FriendMessageDispatcher::FriendMessageDispatcher(Friend& f_, MessageProcessor processor_,
                                                  ICoreFriendMessageSender& messageSender_)
     : f(f_)
@@ -15,10 +25,26 @@ FriendMessageDispatcher::FriendMessageDispatcher(Friend& f_, MessageProcessor pr
 {
     connect(&f, &Friend::onlineOfflineChanged, this,
             &FriendMessageDispatcher::onFriendOnlineOfflineChanged);
+
+    sendTimer.setInterval(resendIntervalMs);
+    connect(&sendTimer, &QTimer::timeout, this, &FriendMessageDispatcher::sendNextBatch);
+}
+
+FriendMessageDispatcher::~FriendMessageDispatcher()
+{
+    interactiveQueueGauge -= interactiveQueue.size();
+    resendQueueGauge -= resendQueue.size();
 }
 
 /**
  * @see IMessageDispatcher::sendMessage
+ *
+ * The splits are echoed via messageSent and queued on the interactive lane
+ * without touching core; the first drain happens on the next event-loop turn.
+ * Handing to core means taking the core loop lock, which the core thread can
+ * hold for a while (e.g. while pumping file chunks), so doing it here would
+ * stall the caller and delay the local echo of the message being painted.
+ * Delivery state is reconciled afterwards through the completion callbacks.
  */
 std::pair<DispatchedMessageId, DispatchedMessageId>
 FriendMessageDispatcher::sendMessage(bool isAction, const QString& content)
@@ -30,10 +56,20 @@ FriendMessageDispatcher::sendMessage(bool isAction, const QString& content)
         lastId = messageId;
 
         auto onOfflineMsgComplete = getCompletionFn(messageId);
-        sendProcessedMessage(message, onOfflineMsgComplete);
+        if (!Status::isOnline(f.getStatus())) {
+            offlineMsgEngine.addUnsentMessage(message, std::move(onOfflineMsgComplete));
+        } else {
+            interactiveQueue.push_back({message, std::move(onOfflineMsgComplete)});
+            ++interactiveQueueGauge;
+        }
 
         emit messageSent(messageId, message);
     }
+
+    if (!interactiveQueue.empty()) {
+        QMetaObject::invokeMethod(this, &FriendMessageDispatcher::sendNextBatch,
+                                  Qt::QueuedConnection);
+    }
     return std::make_pair(firstId, lastId);
 }
 
@@ -65,9 +101,56 @@ void FriendMessageDispatcher::onFriendOnlineOfflineChanged(const ToxPk& friendPk
     std::ignore = friendPk;
     if (isOnline) {
         auto messagesToResend = offlineMsgEngine.removeAllMessages();
-        for (const auto& message : messagesToResend) {
-            sendProcessedMessage(message.message, message.callback);
+        resendQueueGauge += messagesToResend.size();
+        resendQueue.insert(resendQueue.end(), std::make_move_iterator(messagesToResend.begin()),
+                           std::make_move_iterator(messagesToResend.end()));
+
+        // First batch goes out right away; the timer paces the rest
+        sendNextBatch();
+    } else {
+        sendTimer.stop();
+        for (auto& message : interactiveQueue) {
+            offlineMsgEngine.addUnsentMessage(message.message, std::move(message.callback));
+        }
+        for (auto& message : resendQueue) {
+            offlineMsgEngine.addUnsentMessage(message.message, std::move(message.callback));
         }
+        interactiveQueueGauge -= interactiveQueue.size();
+        resendQueueGauge -= resendQueue.size();
+        interactiveQueue.clear();
+        resendQueue.clear();
+    }
+}
+
+/**
+ * @brief Sends the next burst of queued messages, interactive lane first.
+ *
+ * Each lane keeps its messages in chronological order so the peer's chat log
+ * matches ours; the rate cap alone keeps a large backlog from monopolizing
+ * toxcore's bandwidth, and fresh typed messages aren't stuck behind it.
+ */
+void FriendMessageDispatcher::sendNextBatch()
+{
+    size_t budget = resendBatchSize;
+    while (budget > 0 && !interactiveQueue.empty()) {
+        auto message = std::move(interactiveQueue.front());
+        interactiveQueue.pop_front();
+        --interactiveQueueGauge;
+        --budget;
+        sendProcessedMessage(message.message, std::move(message.callback));
+    }
+    while (budget > 0 && !resendQueue.empty()) {
+        auto message = std::move(resendQueue.front());
+        resendQueue.pop_front();
+        --resendQueueGauge;
+        --budget;
+        sendProcessedMessage(message.message, std::move(message.callback));
+    }
+
+    if (interactiveQueue.empty() && resendQueue.empty()) {
+        sendTimer.stop();
+    } else if (!sendTimer.isActive()) {
+        sendTimer.start();
     }
 }
 
@@ -76,19 +159,34 @@ void FriendMessageDispatcher::onFriendOnlineOfflineChanged(const ToxPk& friendPk
  */
 void FriendMessageDispatcher::clearOutgoingMessages()
 {
+    sendTimer.stop();
+    interactiveQueueGauge -= interactiveQueue.size();
+    resendQueueGauge -= resendQueue.size();
+    interactiveQueue.clear();
+    resendQueue.clear();
     offlineMsgEngine.removeAllMessages();
 }
 
+size_t FriendMessageDispatcher::totalInteractiveQueueDepth()
+{
+    return interactiveQueueGauge.load();
+}
+
+size_t FriendMessageDispatcher::totalResendQueueDepth()
+{
+    return resendQueueGauge.load();
+}
+
 
 void FriendMessageDispatcher::sendProcessedMessage(const Message& message,
                                                    OfflineMsgEngine::CompletionFn onOfflineMsgComplete)
 {
     if (!Status::isOnline(f.getStatus())) {
-        offlineMsgEngine.addUnsentMessage(message, onOfflineMsgComplete);
+        offlineMsgEngine.addUnsentMessage(message, std::move(onOfflineMsgComplete));
         return;
     }
 
-    sendCoreProcessedMessage(message, onOfflineMsgComplete);
+    sendCoreProcessedMessage(message, std::move(onOfflineMsgComplete));
 }
 
 
@@ -105,9 +203,9 @@ void FriendMessageDispatcher::sendCoreProcessedMessage(const Message& message,
     const auto messageSent = sendFn(messageSender, friendId, message.content, receipt);
 
     if (messageSent) {
-        offlineMsgEngine.addSentCoreMessage(receipt, message, onOfflineMsgComplete);
+        offlineMsgEngine.addSentCoreMessage(receipt, message, std::move(onOfflineMsgComplete));
     } else {
-        offlineMsgEngine.addUnsentMessage(message, onOfflineMsgComplete);
+        offlineMsgEngine.addUnsentMessage(message, std::move(onOfflineMsgComplete));
     }
 }
 
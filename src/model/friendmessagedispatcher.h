@@ -13,8 +13,10 @@
 
 #include <QObject>
 #include <QString>
+#include <QTimer>
 
 #include <cstdint>
+#include <deque>
 
 class FriendMessageDispatcher : public IMessageDispatcher
 {
@@ -22,6 +24,7 @@ class FriendMessageDispatcher : public IMessageDispatcher
 public:
     FriendMessageDispatcher(Friend& f, MessageProcessor processor,
                             ICoreFriendMessageSender& messageSender);
+    ~FriendMessageDispatcher() override;
 
     std::pair<DispatchedMessageId, DispatchedMessageId> sendMessage(bool isAction,
                                                                     const QString& content) override;
@@ -29,8 +32,20 @@ public:
     void onMessageReceived(bool isAction, const QString& content);
     void onReceiptReceived(ReceiptNum receipt);
     void clearOutgoingMessages();
+
+    // Queued messages go out in bursts of resendBatchSize, one burst per
+    // resendIntervalMs, so catching up doesn't starve other toxcore traffic.
+    // The interactive lane is drained before the offline-resend lane.
+    static constexpr int resendIntervalMs = 250;
+    static constexpr size_t resendBatchSize = 64;
+
+    // Queue depths summed over all dispatchers, for the debug pane
+    static size_t totalInteractiveQueueDepth();
+    static size_t totalResendQueueDepth();
+
 private slots:
     void onFriendOnlineOfflineChanged(const ToxPk& friendPk, bool isOnline);
+    void sendNextBatch();
 
 private:
     void sendProcessedMessage(const Message& message,
@@ -45,4 +60,7 @@ private:
     ICoreFriendMessageSender& messageSender;
     OfflineMsgEngine offlineMsgEngine;
     MessageProcessor processor;
+    std::deque<OfflineMsgEngine::RemovedMessage> interactiveQueue;
+    std::deque<OfflineMsgEngine::RemovedMessage> resendQueue;
+    QTimer sendTimer;
 };
@@ -6,7 +6,11 @@
 #pragma once
 
 #include <QList>
+
+#include <tuple>
+
 struct DhtServer;
+class ToxPk;
 
 class IBootstrapListGenerator
 {
@@ -19,4 +23,15 @@ public:
     IBootstrapListGenerator& operator=(IBootstrapListGenerator&&) = default;
 
     virtual QList<DhtServer> getBootstrapNodes() const = 0;
+
+    /**
+     * @brief Reports that a bootstrap attempt against the given nodes reached
+     * the network after rttMs. Implementations may use this to rank the lists
+     * they hand out; the default ignores it.
+     */
+    virtual void reportBootstrapSuccess(const QList<ToxPk>& nodePks, int rttMs)
+    {
+        std::ignore = nodePks;
+        std::ignore = rttMs;
+    }
 };
@@ -55,6 +55,9 @@ struct SearchPos
 struct SearchResult
 {
     bool found{false};
+    // False if a chunked search ran out of budget before reaching the end of
+    // the range. pos then holds where to resume from.
+    bool completed{true};
     SearchPos pos;
     size_t start{0};
     size_t len{0};
@@ -97,6 +100,38 @@ public:
     virtual SearchResult searchBackward(SearchPos startIdx, const QString& phrase,
                                         const ParameterSearch& parameter) const = 0;
 
+    /**
+     * @brief Like searchForward, but gives up after examining maxItems items so
+     * callers can time-slice long scans and keep the UI responsive. When the
+     * budget runs out the result has completed == false and pos set to the
+     * position to resume from.
+     * @param[in] startIdx inclusive start idx
+     * @param[in] phrase phrase to find (may be modified by parameter)
+     * @param[in] parameter search parameters
+     * @param[in] maxItems maximum number of items to examine in this call
+     */
+    virtual SearchResult searchForwardChunked(SearchPos startIdx, const QString& phrase,
+                                              const ParameterSearch& parameter, size_t maxItems) const
+    {
+        std::ignore = maxItems;
+        return searchForward(startIdx, phrase, parameter);
+    }
+
+    /**
+     * @brief Like searchBackward, but gives up after examining maxItems items.
+     * See searchForwardChunked.
+     * @param[in] startIdx inclusive start idx
+     * @param[in] phrase phrase to find (may be modified by parameter)
+     * @param[in] parameter search parameters
+     * @param[in] maxItems maximum number of items to examine in this call
+     */
+    virtual SearchResult searchBackwardChunked(SearchPos startIdx, const QString& phrase,
+                                               const ParameterSearch& parameter, size_t maxItems) const
+    {
+        std::ignore = maxItems;
+        return searchBackward(startIdx, phrase, parameter);
+    }
+
     /**
      * @brief The underlying chat log instance may not want to start at 0
      * @return Current first valid index to call at() with
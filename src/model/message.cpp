@@ -13,18 +13,32 @@ namespace {
 QStringList splitMessage(const QString& message, uint64_t maxLength)
 {
     QStringList splittedMsgs;
-    QByteArray ba_message{message.toUtf8()};
-    while (static_cast<uint64_t>(ba_message.size()) > maxLength) {
-        int splitPos = ba_message.lastIndexOf('\n', maxLength - 1);
+    const QByteArray ba_message{message.toUtf8()};
 
-        if (splitPos <= 0) {
-            splitPos = ba_message.lastIndexOf(' ', maxLength - 1);
+    // Common case: the message fits in one piece, return it as-is instead of
+    // decoding the bytes we just encoded
+    if (static_cast<uint64_t>(ba_message.size()) <= maxLength) {
+        splittedMsgs.append(message);
+        return splittedMsgs;
+    }
+
+    // One pass over the UTF-8 buffer: each boundary is found at an offset
+    // into it and the chunk decoded straight from there. Copying the
+    // remainder into a fresh byte array per chunk made a megabyte paste
+    // quadratic in its chunk count.
+    qsizetype start = 0;
+    while (static_cast<uint64_t>(ba_message.size() - start) > maxLength) {
+        const qsizetype windowEnd = start + static_cast<qsizetype>(maxLength) - 1;
+        qsizetype splitPos = ba_message.lastIndexOf('\n', windowEnd);
+
+        if (splitPos <= start) {
+            splitPos = ba_message.lastIndexOf(' ', windowEnd);
         }
 
-        if (splitPos <= 0) {
+        if (splitPos <= start) {
             constexpr uint8_t firstOfMultiByteMask = 0xC0;
             constexpr uint8_t multiByteMask = 0x80;
-            splitPos = maxLength;
+            splitPos = start + static_cast<qsizetype>(maxLength);
             // don't split a utf8 character
             if ((ba_message[splitPos] & multiByteMask) == multiByteMask) {
                 while ((ba_message[splitPos] & firstOfMultiByteMask) != firstOfMultiByteMask) {
@@ -33,11 +47,11 @@ QStringList splitMessage(const QString& message, uint64_t maxLength)
             }
             --splitPos;
         }
-        splittedMsgs.append(QString::fromUtf8(ba_message.left(splitPos + 1)));
-        ba_message = ba_message.mid(splitPos + 1);
+        splittedMsgs.append(QString::fromUtf8(ba_message.constData() + start, splitPos + 1 - start));
+        start = splitPos + 1;
     }
 
-    splittedMsgs.append(QString::fromUtf8(ba_message));
+    splittedMsgs.append(QString::fromUtf8(ba_message.constData() + start, ba_message.size() - start));
     return splittedMsgs;
 }
 } // namespace
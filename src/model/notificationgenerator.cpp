@@ -72,41 +72,53 @@ QString generateTitle(const QHash<const Friend*, size_t>& friendNotifications,
 
 QString generateContent(const QHash<const Friend*, size_t>& friendNotifications,
                         const QHash<const Conference*, size_t>& conferenceNotifications,
-                        QString lastMessage, const ToxPk& sender)
+                        QString lastMessage, const ToxPk& sender, QString& nameListCache,
+                        size_t& nameListCacheChats)
 {
     assert(friendNotifications.size() > 0 || conferenceNotifications.size() > 0);
 
     auto numChats = getNumChats(friendNotifications, conferenceNotifications);
     if (numChats > 1) {
-        // Copy all names into a vector to simplify formatting logic between
-        // multiple lists
-        std::vector<QString> displayNames;
-        displayNames.reserve(numChats);
-
-        for (auto it = friendNotifications.begin(); it != friendNotifications.end(); ++it) {
-            displayNames.push_back(it.key()->getDisplayedName());
-        }
-
-        for (auto it = conferenceNotifications.begin(); it != conferenceNotifications.end(); ++it) {
-            displayNames.push_back(it.key()->getDisplayedName());
-        }
-
-        assert(displayNames.size() > 0);
-
-        // Lexicographically sort all display names to ensure consistent formatting
-        QCollator collator;
-        std::sort(displayNames.begin(), displayNames.end(),
-                  [&](const QString& a, const QString& b) { return collator.compare(a, b) < 1; });
-
-        auto it = displayNames.begin();
-
-        QString ret = *it;
-
-        while (++it != displayNames.end()) {
-            ret += ", " + *it;
+        // The sorted name list only depends on which chats are aggregated, and
+        // chats are only ever added until the notification is activated, so a
+        // burst of messages reuses the list built when the last chat joined
+        // instead of re-running collation per message
+        if (numChats != nameListCacheChats) {
+            // Copy all names into a vector to simplify formatting logic between
+            // multiple lists
+            std::vector<QString> displayNames;
+            displayNames.reserve(numChats);
+
+            for (auto it = friendNotifications.begin(); it != friendNotifications.end(); ++it) {
+                displayNames.push_back(it.key()->getDisplayedName());
+            }
+
+            for (auto it = conferenceNotifications.begin(); it != conferenceNotifications.end();
+                 ++it) {
+                displayNames.push_back(it.key()->getDisplayedName());
+            }
+
+            assert(displayNames.size() > 0);
+
+            // Lexicographically sort all display names to ensure consistent formatting
+            QCollator collator;
+            std::sort(displayNames.begin(), displayNames.end(), [&](const QString& a, const QString& b) {
+                return collator.compare(a, b) < 1;
+            });
+
+            auto it = displayNames.begin();
+
+            QString ret = *it;
+
+            while (++it != displayNames.end()) {
+                ret += ", " + *it;
+            }
+
+            nameListCache = ret;
+            nameListCacheChats = numChats;
         }
 
-        return ret;
+        return nameListCache;
     } else if (conferenceNotifications.size() == 1) {
         auto it = conferenceNotifications.begin();
         if (it == conferenceNotifications.end()) {
@@ -145,8 +157,8 @@ NotificationData NotificationGenerator::friendMessageNotification(const Friend*
     }
 
     ret.title = generateTitle(friendNotifications, conferenceNotifications, f);
-    ret.message =
-        generateContent(friendNotifications, conferenceNotifications, message, f->getPublicKey());
+    ret.message = generateContent(friendNotifications, conferenceNotifications, message,
+                                  f->getPublicKey(), nameListCache, nameListCacheChats);
     ret.pixmap = getSenderAvatar(profile, f->getPublicKey());
 
     return ret;
@@ -166,7 +178,8 @@ NotificationData NotificationGenerator::conferenceMessageNotification(const Conf
     }
 
     ret.title = generateTitle(friendNotifications, conferenceNotifications, c);
-    ret.message = generateContent(friendNotifications, conferenceNotifications, message, sender);
+    ret.message = generateContent(friendNotifications, conferenceNotifications, message, sender,
+                                  nameListCache, nameListCacheChats);
     ret.pixmap = getSenderAvatar(profile, sender);
 
     return ret;
@@ -190,8 +203,10 @@ NotificationData NotificationGenerator::fileTransferNotification(const Friend* f
 
     if (numChats > 1 || numMessages > 1) {
         ret.title = generateTitle(friendNotifications, conferenceNotifications, f);
-        ret.message = generateContent(friendNotifications, conferenceNotifications,
-                                      tr("Incoming file transfer"), f->getPublicKey());
+        ret.message =
+            generateContent(friendNotifications, conferenceNotifications,
+                            tr("Incoming file transfer"), f->getPublicKey(), nameListCache,
+                            nameListCacheChats);
     } else {
         //: e.g. Bob - file transfer
         ret.title = tr("%1 - file transfer").arg(f->getDisplayedName());
@@ -239,4 +254,6 @@ void NotificationGenerator::onNotificationActivated()
 {
     friendNotifications = {};
     conferenceNotifications = {};
+    nameListCache = {};
+    nameListCacheChats = 0;
 }
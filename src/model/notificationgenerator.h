@@ -48,4 +48,9 @@ private:
     Profile* profile;
     QHash<const Friend*, size_t> friendNotifications;
     QHash<const Conference*, size_t> conferenceNotifications;
+    // Sorted multi-chat name list, rebuilt only when another chat joins the
+    // aggregation window; a message burst reuses it instead of collating on
+    // every event
+    QString nameListCache;
+    size_t nameListCacheChats = 0;
 };
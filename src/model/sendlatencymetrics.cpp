@@ -0,0 +1,108 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "sendlatencymetrics.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+
+#include <array>
+
+namespace {
+// Histogram bucket upper bounds in milliseconds; the last bucket is
+// open-ended. Percentiles are reported as the bound of the bucket the
+// percentile falls into, which is plenty for spotting regressions.
+constexpr std::array<qint64, 8> bucketBoundsMs{1, 2, 5, 10, 25, 50, 100, 250};
+
+// In-flight sends: dispatch time keyed first by message ID, then re-keyed by
+// chat log index once SessionChatLog assigns one. Bounded below in case a
+// send never reaches the render stage (e.g. the chat view was closed).
+QHash<size_t, qint64> pendingByMessageId;
+QHash<size_t, qint64> pendingByChatLogIdx;
+constexpr int maxPendingEntries = 64;
+
+std::array<quint64, bucketBoundsMs.size() + 1> buckets{};
+quint64 totalSends = 0;
+qint64 worstMs = 0;
+
+qint64 nowMs()
+{
+    static QElapsedTimer clock;
+    if (!clock.isValid()) {
+        clock.start();
+    }
+    return clock.elapsed();
+}
+
+qint64 percentileBoundMs(double percentile)
+{
+    const quint64 target = static_cast<quint64>(totalSends * percentile);
+    quint64 seen = 0;
+    for (size_t i = 0; i < bucketBoundsMs.size(); ++i) {
+        seen += buckets[i];
+        if (seen > target) {
+            return bucketBoundsMs[i];
+        }
+    }
+    return worstMs;
+}
+} // namespace
+
+void SendLatencyMetrics::recordDispatch(DispatchedMessageId id)
+{
+    if (pendingByMessageId.size() >= maxPendingEntries) {
+        pendingByMessageId.clear();
+    }
+    pendingByMessageId[id.get()] = nowMs();
+}
+
+void SendLatencyMetrics::recordInserted(DispatchedMessageId id, ChatLogIdx idx)
+{
+    const auto it = pendingByMessageId.constFind(id.get());
+    if (it == pendingByMessageId.constEnd()) {
+        return;
+    }
+
+    if (pendingByChatLogIdx.size() >= maxPendingEntries) {
+        pendingByChatLogIdx.clear();
+    }
+    pendingByChatLogIdx[idx.get()] = *it;
+    pendingByMessageId.erase(it);
+}
+
+void SendLatencyMetrics::recordRendered(ChatLogIdx idx)
+{
+    const auto it = pendingByChatLogIdx.constFind(idx.get());
+    if (it == pendingByChatLogIdx.constEnd()) {
+        // rendering history or received messages, not one of our sends
+        return;
+    }
+
+    const qint64 elapsed = nowMs() - *it;
+    pendingByChatLogIdx.erase(it);
+
+    size_t bucket = 0;
+    while (bucket < bucketBoundsMs.size() && elapsed > bucketBoundsMs[bucket]) {
+        ++bucket;
+    }
+    ++buckets[bucket];
+    ++totalSends;
+    worstMs = std::max(worstMs, elapsed);
+}
+
+QString SendLatencyMetrics::summary()
+{
+    if (totalSends == 0) {
+        return QStringLiteral("Send-to-render latency: no sends recorded\n");
+    }
+
+    return QStringLiteral(
+               "Send-to-render latency: %1 sends, p50 <= %2 ms, p90 <= %3 ms, p99 <= %4 ms, "
+               "worst %5 ms\n")
+        .arg(totalSends)
+        .arg(percentileBoundMs(0.50))
+        .arg(percentileBoundMs(0.90))
+        .arg(percentileBoundMs(0.99))
+        .arg(worstMs);
+}
@@ -0,0 +1,30 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include "src/model/ichatlog.h"
+#include "src/model/imessagedispatcher.h"
+
+#include <QString>
+
+/**
+ * @brief Tracks how long a sent message takes from enter press to rendering.
+ *
+ * Stitches three points of the send path together: the dispatch in
+ * GenericChatForm, the chat log insert in SessionChatLog (which maps the
+ * dispatched message ID to a chat log index), and the moment ChatWidget adds
+ * the line to its scene. The aggregate percentiles show up in the debug pane,
+ * so a UI latency regression is a number in a bug report instead of a vibe.
+ *
+ * All three points run on the GUI thread, so the state needs no locking.
+ */
+class SendLatencyMetrics
+{
+public:
+    static void recordDispatch(DispatchedMessageId id);
+    static void recordInserted(DispatchedMessageId id, ChatLogIdx idx);
+    static void recordRendered(ChatLogIdx idx);
+    static QString summary();
+};
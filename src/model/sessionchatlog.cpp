@@ -6,9 +6,11 @@
 #include "sessionchatlog.h"
 #include "src/conferencelist.h"
 #include "src/friendlist.h"
+#include "src/model/sendlatencymetrics.h"
 
 #include <QDebug>
 #include <QtGlobal>
+#include <limits>
 #include <mutex>
 
 namespace {
@@ -152,6 +154,13 @@ const ChatLogItem& SessionChatLog::at(ChatLogIdx idx) const
 
 SearchResult SessionChatLog::searchForward(SearchPos startPos, const QString& phrase,
                                            const ParameterSearch& parameter) const
+{
+    return searchForwardChunked(startPos, phrase, parameter, std::numeric_limits<size_t>::max());
+}
+
+SearchResult SessionChatLog::searchForwardChunked(SearchPos startPos, const QString& phrase,
+                                                  const ParameterSearch& parameter,
+                                                  size_t maxItems) const
 {
     if (startPos.logIdx >= getNextIdx()) {
         SearchResult res;
@@ -163,10 +172,21 @@ SearchResult SessionChatLog::searchForward(SearchPos startPos, const QString& ph
 
     auto regexp = getRegexpForPhrase(phrase, parameter.filter);
 
+    size_t itemsExamined = 0;
     for (auto it = items.find(currentPos.logIdx); it != items.end(); ++it) {
         const auto& key = it->first;
         const auto& item = it->second;
 
+        if (itemsExamined++ >= maxItems) {
+            // Budget exhausted, report where to resume from
+            SearchResult res;
+            res.found = false;
+            res.completed = false;
+            res.pos.logIdx = key;
+            res.pos.numMatches = currentPos.numMatches;
+            return res;
+        }
+
         if (item.getContentType() != ChatLogItem::ContentType::message) {
             continue;
         }
@@ -206,6 +226,13 @@ SearchResult SessionChatLog::searchForward(SearchPos startPos, const QString& ph
 
 SearchResult SessionChatLog::searchBackward(SearchPos startPos, const QString& phrase,
                                             const ParameterSearch& parameter) const
+{
+    return searchBackwardChunked(startPos, phrase, parameter, std::numeric_limits<size_t>::max());
+}
+
+SearchResult SessionChatLog::searchBackwardChunked(SearchPos startPos, const QString& phrase,
+                                                   const ParameterSearch& parameter,
+                                                   size_t maxItems) const
 {
     auto currentPos = startPos;
     auto regexp = getRegexpForPhrase(phrase, parameter.filter);
@@ -226,10 +253,21 @@ SearchResult SessionChatLog::searchBackward(SearchPos startPos, const QString& p
     auto rStartIt = std::reverse_iterator<decltype(startIt)>(std::next(startIt));
     auto rEnd = std::reverse_iterator<decltype(startIt)>(items.begin());
 
+    size_t itemsExamined = 0;
     for (auto it = rStartIt; it != rEnd; ++it) {
         const auto& key = it->first;
         const auto& item = it->second;
 
+        if (itemsExamined++ >= maxItems) {
+            // Budget exhausted, report where to resume from
+            SearchResult res;
+            res.found = false;
+            res.completed = false;
+            res.pos.logIdx = key;
+            res.pos.numMatches = currentPos.numMatches;
+            return res;
+        }
+
         if (item.getContentType() != ChatLogItem::ContentType::message) {
             continue;
         }
@@ -368,6 +406,51 @@ void SessionChatLog::insertSystemMessageAtIdx(ChatLogIdx idx, SystemMessage mess
     items.emplace(idx, std::move(item));
 }
 
+/**
+ * @brief Erases the oldest items until at most maxSize remain
+ *
+ * Only a contiguous prefix is evicted so the [getFirstIdx(), getNextIdx())
+ * window stays dense. Eviction stops early at the first undelivered message
+ * or active file transfer since those are updated in place once their state
+ * settles.
+ *
+ * @note The caller is responsible for only trimming when the evicted range
+ * can be reloaded from persistent history
+ */
+void SessionChatLog::trimOldestItems(size_t maxSize)
+{
+    while (items.size() > maxSize) {
+        const auto it = items.begin();
+        const auto idx = it->first;
+        const auto& item = it->second;
+
+        if (item.getContentType() == ChatLogItem::ContentType::message
+            && item.getContentAsMessage().state == MessageState::pending) {
+            break;
+        }
+
+        const bool isActiveTransfer =
+            std::find_if(currentFileTransfers.begin(), currentFileTransfers.end(),
+                         [&](const CurrentFileTransfer& transfer) { return transfer.idx == idx; })
+            != currentFileTransfers.end();
+        if (isActiveTransfer) {
+            break;
+        }
+
+        // Drop any stale dispatch mapping so a late lookup can't land on the
+        // evicted index
+        for (auto outIt = outgoingMessages.begin(); outIt != outgoingMessages.end();) {
+            if (*outIt == idx) {
+                outIt = outgoingMessages.erase(outIt);
+            } else {
+                ++outIt;
+            }
+        }
+
+        items.erase(it);
+    }
+}
+
 /**
  * @brief Inserts message data into the chat log buffer
  * @note Owner of SessionChatLog is in charge of attaching this to the appropriate IMessageDispatcher
@@ -400,6 +483,7 @@ void SessionChatLog::onMessageSent(DispatchedMessageId id, const Message& messag
     items.emplace(messageIdx, ChatLogItem(selfPk, selfName, chatLogMessage));
 
     outgoingMessages.insert(id, messageIdx);
+    SendLatencyMetrics::recordInserted(id, messageIdx);
 
     emit itemUpdated(messageIdx);
 }
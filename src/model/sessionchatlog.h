@@ -30,6 +30,12 @@ public:
                                const ParameterSearch& parameter) const override;
     SearchResult searchBackward(SearchPos startPos, const QString& phrase,
                                 const ParameterSearch& parameter) const override;
+    SearchResult searchForwardChunked(SearchPos startPos, const QString& phrase,
+                                      const ParameterSearch& parameter,
+                                      size_t maxItems) const override;
+    SearchResult searchBackwardChunked(SearchPos startPos, const QString& phrase,
+                                       const ParameterSearch& parameter,
+                                       size_t maxItems) const override;
     ChatLogIdx getFirstIdx() const override;
     ChatLogIdx getNextIdx() const override;
     std::vector<DateChatLogIdxPair> getDateIdxs(const QDate& startDate, size_t maxDates) const override;
@@ -44,6 +50,7 @@ public:
     void insertFileAtIdx(ChatLogIdx idx, const ToxPk& sender, QString senderName,
                          const ChatLogFile& file);
     void insertSystemMessageAtIdx(ChatLogIdx idx, SystemMessage message);
+    void trimOldestItems(size_t maxSize);
 
 public slots:
     void onMessageReceived(const ToxPk& sender, const Message& message);
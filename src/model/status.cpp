@@ -11,6 +11,7 @@
 #include <QString>
 
 #include <cassert>
+#include <iterator>
 
 namespace Status {
 QString getTitle(Status status)
@@ -52,13 +53,47 @@ QString getAssetSuffix(Status status)
 
 QString getIconPath(Status status, bool event)
 {
-    const QString eventSuffix = event ? QStringLiteral("_notification") : QString();
-    const QString statusSuffix = getAssetSuffix(status);
-    if (status == Status::Blocked) {
-        return ":/img/status/" + statusSuffix + ".svg";
-    } else {
-        return ":/img/status/" + statusSuffix + eventSuffix + ".svg";
+    // Status changes are the friend list's most frequent repaint trigger, so
+    // the paths are interned once instead of concatenated per call; returning
+    // one is a refcount bump on the static data
+    static const QString paths[][2] = {
+        {QStringLiteral(":/img/status/online.svg"),
+         QStringLiteral(":/img/status/online_notification.svg")},
+        {QStringLiteral(":/img/status/away.svg"),
+         QStringLiteral(":/img/status/away_notification.svg")},
+        {QStringLiteral(":/img/status/busy.svg"),
+         QStringLiteral(":/img/status/busy_notification.svg")},
+        {QStringLiteral(":/img/status/offline.svg"),
+         QStringLiteral(":/img/status/offline_notification.svg")},
+        // Blocked has no notification variant
+        {QStringLiteral(":/img/status/blocked.svg"), QStringLiteral(":/img/status/blocked.svg")},
+    };
+
+    const auto index = static_cast<size_t>(status);
+    assert(index < std::size(paths));
+    return paths[index][event ? 1 : 0];
+}
+
+/**
+ * @brief Returns the decoded icon for a status, rendering each variant at most once.
+ *
+ * The status pixmaps used to be re-rendered from SVG on every repaint; the
+ * handful of variants is small enough to just keep decoded for the process
+ * lifetime, the same trade PixmapCache makes for chat images.
+ */
+QPixmap getIconPixmap(Status status, bool event)
+{
+    static QPixmap pixmaps[5][2];
+    static_assert(std::size(pixmaps) == static_cast<size_t>(Status::Blocked) + 1,
+                  "pixmap table must cover every status");
+
+    const auto index = static_cast<size_t>(status);
+    assert(index < std::size(pixmaps));
+    QPixmap& pixmap = pixmaps[index][event ? 1 : 0];
+    if (pixmap.isNull()) {
+        pixmap = QPixmap(getIconPath(status, event));
     }
+    return pixmap;
 }
 
 bool isOnline(Status status)
@@ -20,6 +20,7 @@ enum class Status
 };
 
 QString getIconPath(Status status, bool event = false);
+QPixmap getIconPixmap(Status status, bool event = false);
 QString getTitle(Status status);
 QString getAssetSuffix(Status status);
 bool isOnline(Status status);
@@ -8,20 +8,42 @@
 #include "src/core/core.h"
 #include "src/core/corefile.h"
 #include "src/model/status.h"
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QDebug>
 #include <QObject>
 
 /**
  * @class AvatarBroadcaster
  *
- * Takes care of broadcasting avatar changes to our friends in a smart way
- * Cache a copy of our current avatar and friends who have received it
- * so we don't spam avatar transfers to a friend who already has it.
+ * Takes care of broadcasting avatar changes to our friends in a smart way.
+ * Tracks the hash of the avatar each friend last received, so reconnect storms
+ * after resuming from sleep cause no traffic when nothing changed. Sends are
+ * paced in small batches and backed off per friend, so a fresh avatar doesn't
+ * start hundreds of transfers at once competing with real file transfers.
  */
 
+namespace {
+// How many avatar transfers a pacing tick may start, and how far apart the
+// ticks are
+const int BATCH_SIZE = 8;
+const int BATCH_INTERVAL_MS = 500;
+// Repeated sends to the same friend double this delay per attempt, up to
+// BACKOFF_BASE_MS << BACKOFF_MAX_EXPONENT; a friend quiet past the reset
+// window starts over
+const int BACKOFF_BASE_MS = 30 * 1000;
+const int BACKOFF_MAX_EXPONENT = 5;
+const int BACKOFF_RESET_MS = 10 * 60 * 1000;
+} // namespace
+
 AvatarBroadcaster::AvatarBroadcaster(Core& _core)
     : core{_core}
 {
+    // Hash the initial empty avatar too, so "no avatar" is still announced
+    // once per friend; a friend's null record never matches a real hash
+    avatarHash = QCryptographicHash::hash(avatarData, QCryptographicHash::Sha256);
+    batchTimer.setInterval(BATCH_INTERVAL_MS);
+    connect(&batchTimer, &QTimer::timeout, this, &AvatarBroadcaster::sendNextBatch);
 }
 
 /**
@@ -35,31 +57,47 @@ void AvatarBroadcaster::setAvatar(QByteArray data)
     }
 
     avatarData = data;
-    friendsSentTo.clear();
+    avatarHash = QCryptographicHash::hash(data, QCryptographicHash::Sha256);
 
-    QVector<uint32_t> friends = core.getFriendList();
+    // Per-friend records are kept: sendAvatarTo compares against the new hash,
+    // and the backoff keeps rapid avatar changes from hammering a friend
+    const QVector<uint32_t> friends = core.getFriendList();
     for (uint32_t friendId : friends) {
-        sendAvatarTo(friendId);
+        queueAvatarSend(friendId);
     }
+    sendNextBatch();
 }
 
 /**
- * @brief Send our current avatar to this friend, if not already sent
+ * @brief Send our current avatar to this friend, if they don't have it already.
  * @param friendId Id of friend to send avatar.
  */
 void AvatarBroadcaster::sendAvatarTo(uint32_t friendId)
 {
-    if (friendsSentTo.contains(friendId) && friendsSentTo[friendId]) {
+    if (!core.isFriendOnline(friendId)) {
         return;
     }
 
-    if (!core.isFriendOnline(friendId)) {
+    SendRecord& record = sendRecords[friendId];
+    if (record.sentHash == avatarHash) {
+        return;
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (now < record.nextAttemptAt) {
         return;
     }
+    if (record.nextAttemptAt != 0 && now > record.nextAttemptAt + BACKOFF_RESET_MS) {
+        record.attempts = 0;
+    }
 
     CoreFile* coreFile = core.getCoreFile();
     coreFile->sendAvatarFile(friendId, avatarData);
-    friendsSentTo[friendId] = true;
+
+    record.sentHash = avatarHash;
+    const int exponent = qMin(record.attempts, BACKOFF_MAX_EXPONENT);
+    record.nextAttemptAt = now + (BACKOFF_BASE_MS << exponent);
+    ++record.attempts;
 }
 
 /**
@@ -70,7 +108,40 @@ void AvatarBroadcaster::enableAutoBroadcast(bool state)
 {
     disconnect(&core, nullptr, this, nullptr);
     if (state) {
-        connect(&core, &Core::friendStatusChanged, this,
-                [this](uint32_t friendId, Status::Status) { sendAvatarTo(friendId); });
+        connect(&core, &Core::friendStatusesChanged, this,
+                [this](const QHash<uint32_t, Status::Status>& statuses) {
+                    for (auto it = statuses.cbegin(); it != statuses.cend(); ++it) {
+                        queueAvatarSend(it.key());
+                    }
+                });
+    }
+}
+
+/**
+ * @brief Queue a paced avatar send to this friend.
+ *
+ * Status changes arrive in bursts when the whole friend list reconnects, so
+ * even single-friend sends go through the batch queue.
+ */
+void AvatarBroadcaster::queueAvatarSend(uint32_t friendId)
+{
+    if (sendQueue.contains(friendId)) {
+        return;
+    }
+
+    sendQueue.append(friendId);
+    if (!batchTimer.isActive()) {
+        batchTimer.start();
+    }
+}
+
+void AvatarBroadcaster::sendNextBatch()
+{
+    for (int i = 0; i < BATCH_SIZE && !sendQueue.isEmpty(); ++i) {
+        sendAvatarTo(sendQueue.takeFirst());
+    }
+
+    if (sendQueue.isEmpty()) {
+        batchTimer.stop();
     }
 }
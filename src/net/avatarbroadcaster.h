@@ -7,8 +7,10 @@
 #pragma once
 
 #include <QByteArray>
-#include <QMap>
+#include <QHash>
+#include <QList>
 #include <QObject>
+#include <QTimer>
 
 class Core;
 class AvatarBroadcaster : public QObject
@@ -22,7 +24,20 @@ public:
     void enableAutoBroadcast(bool state = true);
 
 private:
+    void queueAvatarSend(uint32_t friendId);
+    void sendNextBatch();
+
+    struct SendRecord
+    {
+        QByteArray sentHash;
+        int attempts = 0;
+        qint64 nextAttemptAt = 0;
+    };
+
     Core& core;
     QByteArray avatarData;
-    QMap<uint32_t, bool> friendsSentTo;
+    QByteArray avatarHash;
+    QHash<uint32_t, SendRecord> sendRecords;
+    QList<uint32_t> sendQueue;
+    QTimer batchTimer;
 };
@@ -9,16 +9,23 @@
 #include "src/core/toxpk.h"
 #include "src/persistence/paths.h"
 
+#include <QCryptographicHash>
+#include <QDir>
 #include <QDirIterator>
 #include <QFile>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QMutexLocker>
 #include <QNetworkAccessManager>
+#include <QNetworkDiskCache>
 #include <QNetworkReply>
 #include <QRegularExpression>
 
+#include <algorithm>
+#include <climits>
 #include <cstdint>
+#include <random>
 
 namespace NodeFields {
 const QLatin1String status_udp{"status_udp"};
@@ -40,6 +47,10 @@ const QLatin1String emptyAddress{"-"};
 const QRegularExpression ToxPkRegEx(QString("(^|\\s)[A-Fa-f0-9]{%1}($|\\s)").arg(64));
 const QLatin1String builtinNodesFile{":/conf/nodes.json"};
 
+// A node list is a few tens of kilobytes; anything larger is a broken or
+// hostile server, so the transfer is aborted mid-flight instead of buffered
+constexpr qint64 maxNodeListBytes = 1 << 20;
+
 void jsonNodeToDhtServer(const QJsonObject& node, QList<DhtServer>& outList)
 {
     // first check if the node in question has all needed fields
@@ -212,18 +223,101 @@ BootstrapNodeUpdater::BootstrapNodeUpdater(const QNetworkProxy& proxy_, Paths& p
     , paths{paths_}
 {
     createExampleBootstrapNodesFile(paths_);
+    loadRttCache();
+
+    // Persistent HTTP cache so refreshes revalidate with If-None-Match /
+    // If-Modified-Since instead of re-downloading the full nodes.json; a 304
+    // serves the stored body without another transfer
+    auto* diskCache = new QNetworkDiskCache(&nam);
+    diskCache->setCacheDirectory(
+        QDir{paths_.getAppCacheDirPath()}.filePath(QStringLiteral("bootstrapNodes")));
+    nam.setCache(diskCache);
 }
 
 QList<DhtServer> BootstrapNodeUpdater::getBootstrapNodes() const
 {
     auto userFilePath = paths.getUserNodesFilePath();
     if (QFile::exists(userFilePath)) {
-        return loadNodesFile(userFilePath);
+        return rankNodes(loadNodesFile(userFilePath));
     } else {
-        return loadNodesFile(builtinNodesFile);
+        return rankNodes(loadNodesFile(builtinNodesFile));
     }
 }
 
+/**
+ * @brief Orders the fastest known nodes to the front of the list.
+ *
+ * Only a short prefix is ranked; the rest stays shuffled so bootstrap attempts
+ * keep sampling nodes we have no measurement for instead of hammering the
+ * same ones forever.
+ */
+QList<DhtServer> BootstrapNodeUpdater::rankNodes(QList<DhtServer> nodes) const
+{
+    std::mt19937 rng(std::random_device{}());
+    std::shuffle(nodes.begin(), nodes.end(), rng);
+
+    constexpr qsizetype rankedPrefix = 2;
+    const QMutexLocker<QMutex> locker(&rttMutex);
+    std::partial_sort(nodes.begin(), nodes.begin() + qMin(rankedPrefix, nodes.size()),
+                      nodes.end(), [this](const DhtServer& a, const DhtServer& b) {
+                          return nodeRtts.value(a.publicKey.toString(), INT_MAX)
+                                 < nodeRtts.value(b.publicKey.toString(), INT_MAX);
+                      });
+    return nodes;
+}
+
+void BootstrapNodeUpdater::reportBootstrapSuccess(const QList<ToxPk>& nodePks, int rttMs)
+{
+    const QMutexLocker<QMutex> locker(&rttMutex);
+    for (const auto& pk : nodePks) {
+        const auto key = pk.toString();
+        const auto it = nodeRtts.constFind(key);
+        // Smooth towards the newest sample so one lucky connect doesn't pin
+        // a node to the top of the ranking forever
+        nodeRtts[key] = it == nodeRtts.constEnd() ? rttMs : (3 * it.value() + rttMs) / 4;
+    }
+    saveRttCache();
+}
+
+void BootstrapNodeUpdater::loadRttCache()
+{
+    QFile cacheFile{paths.getNodesRttFilePath()};
+    if (!cacheFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return;
+    }
+
+    const auto jsonDoc = QJsonDocument::fromJson(cacheFile.readAll());
+    if (!jsonDoc.isObject()) {
+        qWarning() << "Ignoring malformed node RTT cache";
+        return;
+    }
+
+    const QJsonObject rootObj = jsonDoc.object();
+    const QMutexLocker<QMutex> locker(&rttMutex);
+    for (auto it = rootObj.constBegin(); it != rootObj.constEnd(); ++it) {
+        const auto rtt = it.value().toInt(-1);
+        if (rtt >= 0) {
+            nodeRtts.insert(it.key(), rtt);
+        }
+    }
+}
+
+void BootstrapNodeUpdater::saveRttCache() const
+{
+    QJsonObject rootObj;
+    for (auto it = nodeRtts.constBegin(); it != nodeRtts.constEnd(); ++it) {
+        rootObj.insert(it.key(), it.value());
+    }
+
+    QFile cacheFile{paths.getNodesRttFilePath()};
+    if (!cacheFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "Couldn't write node RTT cache";
+        return;
+    }
+    const auto serialized = QJsonDocument{rootObj}.toJson(QJsonDocument::Indented);
+    cacheFile.write(serialized.constData(), serialized.size());
+}
+
 void BootstrapNodeUpdater::requestBootstrapNodes()
 {
     nam.setProxy(proxy);
@@ -232,7 +326,13 @@ void BootstrapNodeUpdater::requestBootstrapNodes()
     QNetworkRequest request{NodeListAddress};
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
 
-    nam.get(request);
+    QNetworkReply* reply = nam.get(request);
+    connect(reply, &QNetworkReply::downloadProgress, reply,
+            [reply](qint64 bytesReceived, qint64 bytesTotal) {
+                std::ignore = bytesTotal;
+                if (bytesReceived > maxNodeListBytes)
+                    reply->abort();
+            });
 }
 
 /**
@@ -252,14 +352,28 @@ void BootstrapNodeUpdater::onRequestComplete(QNetworkReply* reply)
         return;
     }
 
+    const QByteArray raw = reply->readAll();
+
+    // A revalidated cache hit, or a server that re-sent identical content
+    // without validators, changes nothing: hand out the last parsed list and
+    // skip the JSON work entirely
+    const bool fromCache = reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
+    const QByteArray bodyHash = QCryptographicHash::hash(raw, QCryptographicHash::Sha256);
+    if ((fromCache || bodyHash == lastNodesBodyHash) && !lastParsedNodes.isEmpty()) {
+        emit availableBootstrapNodes(lastParsedNodes);
+        return;
+    }
+
     // parse the reply JSON
-    QJsonDocument jsonDocument = QJsonDocument::fromJson(reply->readAll());
+    QJsonDocument jsonDocument = QJsonDocument::fromJson(raw);
     if (jsonDocument.isNull()) {
         emit availableBootstrapNodes({});
         return;
     }
 
     QList<DhtServer> result = jsonToNodeList(jsonDocument);
+    lastParsedNodes = result;
+    lastNodesBodyHash = bodyHash;
 
     emit availableBootstrapNodes(result);
 }
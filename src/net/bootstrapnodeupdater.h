@@ -5,7 +5,10 @@
 
 #pragma once
 
+#include <QByteArray>
+#include <QHash>
 #include <QList>
+#include <QMutex>
 #include <QNetworkAccessManager>
 #include <QNetworkProxy>
 #include <QObject>
@@ -23,6 +26,7 @@ public:
     explicit BootstrapNodeUpdater(const QNetworkProxy& proxy_, Paths& paths_,
                                   QObject* parent = nullptr);
     QList<DhtServer> getBootstrapNodes() const override;
+    void reportBootstrapSuccess(const QList<ToxPk>& nodePks, int rttMs) override;
     void requestBootstrapNodes();
     static QList<DhtServer> loadDefaultBootstrapNodes();
 
@@ -33,7 +37,19 @@ private slots:
     void onRequestComplete(QNetworkReply* reply);
 
 private:
+    QList<DhtServer> rankNodes(QList<DhtServer> nodes) const;
+    void loadRttCache();
+    void saveRttCache() const;
+
     QNetworkProxy proxy;
     QNetworkAccessManager nam;
     Paths& paths;
+    // Last successfully parsed downloaded node list and a hash of the body it
+    // came from, so revalidated or unchanged downloads skip reparsing
+    QList<DhtServer> lastParsedNodes;
+    QByteArray lastNodesBodyHash;
+    // Smoothed time-to-connected per node public key, persisted between runs
+    // so a restart or network change reconnects through known-fast nodes
+    QHash<QString, int> nodeRtts;
+    mutable QMutex rttMutex;
 };
@@ -0,0 +1,233 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "linkmetadataresolver.h"
+
+#include "src/persistence/db/rawdatabase.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QRegularExpression>
+
+/**
+ * @class LinkMetadataResolver
+ * @brief Resolves page title and description metadata for web links.
+ *
+ * Built for link previews, which must never cost the message receive path
+ * anything: resolve() only enqueues, fetches run through a bounded queue with
+ * a fixed concurrency cap, and results come back through a signal. Every
+ * verdict - including failures, so a dead link is not hammered - lands in a
+ * session cache backed by an optional RawDatabase table, so a link is fetched
+ * at most once across restarts.
+ *
+ * Callers are responsible for gating resolution behind the user's opt-in;
+ * this class never touches the network on its own.
+ */
+
+namespace {
+// Enough for two previews to load promptly without letting a link-heavy
+// history flood the network
+constexpr int maxConcurrentFetches = 2;
+// Oldest queued links are dropped beyond this; a preview that far behind the
+// scroll position is no longer worth fetching
+constexpr int maxQueuedFetches = 32;
+// Metadata lives in the document head; anything past this is body content
+constexpr qint64 maxResponseBytes = 512 * 1024;
+
+// Matches the content attribute of an og: property meta tag, either attribute
+// order. HTML-entity unescaping is handled after extraction.
+QString matchMetaContent(const QString& head, const QString& property)
+{
+    const QRegularExpression contentFirst(
+        QStringLiteral(R"(<meta[^>]+content\s*=\s*"([^"]*)"[^>]+property\s*=\s*"%1")").arg(property),
+        QRegularExpression::CaseInsensitiveOption);
+    const QRegularExpression propertyFirst(
+        QStringLiteral(R"(<meta[^>]+property\s*=\s*"%1"[^>]+content\s*=\s*"([^"]*)")").arg(property),
+        QRegularExpression::CaseInsensitiveOption);
+
+    QRegularExpressionMatch match = propertyFirst.match(head);
+    if (!match.hasMatch()) {
+        match = contentFirst.match(head);
+    }
+    return match.hasMatch() ? match.captured(1) : QString{};
+}
+
+QString unescapeEntities(QString text)
+{
+    text.replace(QLatin1String("&lt;"), QLatin1String("<"));
+    text.replace(QLatin1String("&gt;"), QLatin1String(">"));
+    text.replace(QLatin1String("&quot;"), QLatin1String("\""));
+    text.replace(QLatin1String("&#39;"), QLatin1String("'"));
+    text.replace(QLatin1String("&amp;"), QLatin1String("&"));
+    return text.simplified();
+}
+} // namespace
+
+LinkMetadataResolver::LinkMetadataResolver(std::shared_ptr<RawDatabase> cacheDb_, QObject* parent)
+    : QObject(parent)
+    , cacheDb{std::move(cacheDb_)}
+{
+    if (cacheDb) {
+        cacheDb->execLater(
+            RawDatabase::Query(QStringLiteral("CREATE TABLE IF NOT EXISTS link_metadata "
+                                              "(url TEXT PRIMARY KEY, "
+                                              "title TEXT NOT NULL, "
+                                              "description TEXT NOT NULL, "
+                                              "resolved INTEGER NOT NULL, "
+                                              "fetched_at INTEGER NOT NULL);")));
+    }
+
+    connect(&manager, &QNetworkAccessManager::finished, this,
+            &LinkMetadataResolver::onFetchFinished);
+}
+
+/**
+ * @brief Requests metadata for the given link.
+ *
+ * Emits metadataResolved() once a verdict exists; immediately for cached
+ * links, after the bounded fetch otherwise. Repeated calls for a link already
+ * queued or in flight are coalesced into one fetch.
+ */
+void LinkMetadataResolver::resolve(const QUrl& url)
+{
+    if (!url.isValid()
+        || (url.scheme() != QLatin1String("http") && url.scheme() != QLatin1String("https"))) {
+        return;
+    }
+
+    const auto cached = memoryCache.constFind(url);
+    if (cached != memoryCache.constEnd()) {
+        emit metadataResolved(url, *cached);
+        return;
+    }
+
+    if (pendingUrls.contains(url)) {
+        return;
+    }
+
+    Metadata stored;
+    if (loadFromCacheDb(url, stored)) {
+        memoryCache.insert(url, stored);
+        emit metadataResolved(url, stored);
+        return;
+    }
+
+    pendingUrls.insert(url);
+    fetchQueue.enqueue(url);
+    while (fetchQueue.size() > maxQueuedFetches) {
+        pendingUrls.remove(fetchQueue.dequeue());
+    }
+
+    startNextFetch();
+}
+
+void LinkMetadataResolver::startNextFetch()
+{
+    while (activeFetches < maxConcurrentFetches && !fetchQueue.isEmpty()) {
+        const QUrl url = fetchQueue.dequeue();
+        ++activeFetches;
+
+        QNetworkRequest request{url};
+        request.setHeader(QNetworkRequest::UserAgentHeader, QStringLiteral("qTox"));
+        request.setRawHeader("Accept", "text/html");
+        manager.get(request);
+    }
+}
+
+void LinkMetadataResolver::onFetchFinished(QNetworkReply* reply)
+{
+    reply->deleteLater();
+    --activeFetches;
+
+    // The request URL, not the final one: cache entries must match what
+    // resolve() is asked for, redirects notwithstanding
+    const QUrl url = reply->request().url();
+
+    Metadata metadata;
+    const QString contentType =
+        reply->header(QNetworkRequest::ContentTypeHeader).toString().toLower();
+    if (reply->error() == QNetworkReply::NoError
+        && contentType.contains(QLatin1String("text/html"))) {
+        metadata = parseHtmlMetadata(reply->read(maxResponseBytes));
+    }
+
+    finishResolve(url, metadata);
+    startNextFetch();
+}
+
+void LinkMetadataResolver::finishResolve(const QUrl& url, const Metadata& metadata)
+{
+    pendingUrls.remove(url);
+    memoryCache.insert(url, metadata);
+    storeInCacheDb(url, metadata);
+    emit metadataResolved(url, metadata);
+}
+
+/**
+ * @brief Pulls the page title and description out of an HTML document.
+ *
+ * Prefers OpenGraph tags, which most preview-conscious sites carry, and falls
+ * back to the title tag and description meta. A full HTML parser is
+ * deliberately avoided; untrusted remote markup goes through nothing but
+ * bounded regex matching, and a miss just means no preview.
+ */
+LinkMetadataResolver::Metadata LinkMetadataResolver::parseHtmlMetadata(const QByteArray& body)
+{
+    const QString head = QString::fromUtf8(body);
+
+    Metadata metadata;
+    metadata.title = unescapeEntities(matchMetaContent(head, QStringLiteral("og:title")));
+    metadata.description =
+        unescapeEntities(matchMetaContent(head, QStringLiteral("og:description")));
+
+    if (metadata.title.isEmpty()) {
+        const QRegularExpression titleTag(QStringLiteral(R"(<title[^>]*>([^<]+)</title>)"),
+                                          QRegularExpression::CaseInsensitiveOption);
+        metadata.title = unescapeEntities(titleTag.match(head).captured(1));
+    }
+
+    if (metadata.description.isEmpty()) {
+        const QRegularExpression descriptionMeta(
+            QStringLiteral(R"(<meta[^>]+name\s*=\s*"description"[^>]+content\s*=\s*"([^"]*)")"),
+            QRegularExpression::CaseInsensitiveOption);
+        metadata.description = unescapeEntities(descriptionMeta.match(head).captured(1));
+    }
+
+    metadata.resolved = !metadata.title.isEmpty();
+    return metadata;
+}
+
+bool LinkMetadataResolver::loadFromCacheDb(const QUrl& url, Metadata& metadata)
+{
+    if (!cacheDb) {
+        return false;
+    }
+
+    bool found = false;
+    cacheDb->execNow(RawDatabase::Query(
+        QStringLiteral("SELECT title, description, resolved FROM link_metadata WHERE url = ?;"),
+        {url.toEncoded()}, [&](const RawDatabase::Row& row) {
+            metadata.title = row.stringValue(0);
+            metadata.description = row.stringValue(1);
+            metadata.resolved = row.int64Value(2) != 0;
+            found = true;
+        }));
+    return found;
+}
+
+void LinkMetadataResolver::storeInCacheDb(const QUrl& url, const Metadata& metadata)
+{
+    if (!cacheDb) {
+        return;
+    }
+
+    cacheDb->execLater(RawDatabase::Query(
+        QStringLiteral("INSERT OR REPLACE INTO link_metadata "
+                       "(url, title, description, resolved, fetched_at) VALUES (?, ?, ?, ?, %1);")
+            .arg(QDateTime::currentMSecsSinceEpoch()),
+        {url.toEncoded(), metadata.title.toUtf8(), metadata.description.toUtf8(),
+         static_cast<qint64>(metadata.resolved ? 1 : 0)}));
+}
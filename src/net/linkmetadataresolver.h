@@ -0,0 +1,60 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QObject>
+#include <QQueue>
+#include <QSet>
+#include <QString>
+#include <QUrl>
+
+#include <memory>
+
+class RawDatabase;
+class QNetworkReply;
+
+class LinkMetadataResolver : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Metadata
+    {
+        QString title;
+        QString description;
+        // False marks a negative cache entry: the fetch failed or the page
+        // carried no usable metadata, and is not retried
+        bool resolved = false;
+    };
+
+    explicit LinkMetadataResolver(std::shared_ptr<RawDatabase> cacheDb_, QObject* parent = nullptr);
+
+    void resolve(const QUrl& url);
+
+    static Metadata parseHtmlMetadata(const QByteArray& body);
+
+signals:
+    void metadataResolved(const QUrl& url, const LinkMetadataResolver::Metadata& metadata);
+
+private slots:
+    void onFetchFinished(QNetworkReply* reply);
+
+private:
+    void startNextFetch();
+    void finishResolve(const QUrl& url, const Metadata& metadata);
+    bool loadFromCacheDb(const QUrl& url, Metadata& metadata);
+    void storeInCacheDb(const QUrl& url, const Metadata& metadata);
+
+    std::shared_ptr<RawDatabase> cacheDb;
+    QNetworkAccessManager manager;
+    // Session cache in front of the database; also holds negative entries
+    QHash<QUrl, Metadata> memoryCache;
+    QQueue<QUrl> fetchQueue;
+    // Everything queued or currently being fetched, to deduplicate requests
+    QSet<QUrl> pendingUrls;
+    int activeFetches = 0;
+};
@@ -7,12 +7,14 @@
 #include "src/persistence/settings.h"
 #include "src/version.h"
 
+#include <QDateTime>
 #include <QDebug>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QObject>
+#include <QRandomGenerator>
 #include <QRegularExpression>
 #include <QTimer>
 #include <cassert>
@@ -24,6 +26,10 @@ const QUrl versionUrl{QStringLiteral("https://api.github.com/repos/TokTok/qTox/r
 // the response to the releases/latest API call.
 const QString versionRegexString{QStringLiteral(R"(v([0-9]+)\.([0-9]+)\.([0-9]+))")};
 
+// Release metadata is a few kilobytes; cap the transfer so a misbehaving
+// server can't make the client buffer an arbitrarily large body
+constexpr qint64 maxReleaseInfoBytes = 1 << 20;
+
 struct Version
 {
     int major;
@@ -92,13 +98,13 @@ bool isCurrentVersionStable()
 } // namespace
 #endif
 
-UpdateCheck::UpdateCheck(const Settings& settings_)
+UpdateCheck::UpdateCheck(Settings& settings_)
     : settings(settings_)
 {
     qInfo() << "qTox is running version:" << GIT_DESCRIBE;
 #ifdef UPDATE_CHECK_ENABLED
     updateTimer.start(1000 * 60 * 60 * 24 /* 1 day */);
-    connect(&updateTimer, &QTimer::timeout, this, &UpdateCheck::checkForUpdate);
+    connect(&updateTimer, &QTimer::timeout, this, &UpdateCheck::fetchReleaseInfo);
     connect(&manager, &QNetworkAccessManager::finished, this, &UpdateCheck::handleResponse);
 #endif
 }
@@ -117,9 +123,78 @@ void UpdateCheck::checkForUpdate()
         return;
     }
 
+    // Reuse the persisted verdict of the previous check instantly, and push
+    // the actual fetch off the startup path with some jitter so it neither
+    // competes with other startup network activity nor has every client hit
+    // the API at the same moment after a release.
+    const bool haveCachedVerdict = announceCachedVerdict();
+    const QDateTime lastCheck = settings.getLastUpdateCheckTime();
+    if (haveCachedVerdict && lastCheck.isValid()
+        && lastCheck.secsTo(QDateTime::currentDateTime()) < 24 * 60 * 60) {
+        // Checked recently enough; the daily timer covers the next refresh
+        return;
+    }
+
+    const int floorMs = haveCachedVerdict ? 5 * 60 * 1000 : 10 * 1000;
+    const int delayMs = floorMs + QRandomGenerator::global()->bounded(60 * 1000);
+    QTimer::singleShot(delayMs, this, &UpdateCheck::fetchReleaseInfo);
+#endif
+}
+
+void UpdateCheck::fetchReleaseInfo()
+{
+#ifdef UPDATE_CHECK_ENABLED
+    if (!settings.getCheckUpdates() || !isCurrentVersionStable()) {
+        return;
+    }
+
     manager.setProxy(settings.getProxy());
     QNetworkRequest request{versionUrl};
-    manager.get(request);
+    // Conditional fetch: a 304 answer is cheap for both sides and leaves the
+    // cached verdict in place.
+    const QString etag = settings.getUpdateCheckEtag();
+    if (!etag.isEmpty()) {
+        request.setRawHeader("If-None-Match", etag.toUtf8());
+    }
+    const QString lastModified = settings.getUpdateCheckLastModified();
+    if (!lastModified.isEmpty()) {
+        request.setRawHeader("If-Modified-Since", lastModified.toUtf8());
+    }
+    QNetworkReply* reply = manager.get(request);
+    connect(reply, &QNetworkReply::downloadProgress, reply,
+            [reply](qint64 bytesReceived, qint64 bytesTotal) {
+                std::ignore = bytesTotal;
+                if (bytesReceived > maxReleaseInfoBytes)
+                    reply->abort();
+            });
+#endif
+}
+
+/**
+ * @brief Emits the verdict derived from the persisted result of the last check.
+ * @return False if nothing usable is cached yet.
+ */
+bool UpdateCheck::announceCachedVerdict()
+{
+#ifdef UPDATE_CHECK_ENABLED
+    const QString cachedTag = settings.getLastKnownUpdateTag();
+    if (!QRegularExpression(versionRegexString).match(cachedTag).hasMatch()) {
+        return false;
+    }
+
+    const auto currentVer = tagToVersion(GIT_DESCRIBE);
+    const auto availableVer = tagToVersion(cachedTag);
+
+    if (isUpdateAvailable(currentVer, availableVer)) {
+        qInfo() << "Update available to version" << cachedTag << "(cached)";
+        emit updateAvailable(cachedTag, QUrl{settings.getLastKnownUpdateLink()});
+    } else {
+        qInfo() << "qTox is up to date (cached)";
+        emit upToDate();
+    }
+    return true;
+#else
+    return false;
 #endif
 }
 
@@ -132,6 +207,16 @@ void UpdateCheck::handleResponse(QNetworkReply* reply)
     }
 
 #ifdef UPDATE_CHECK_ENABLED
+    const int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (statusCode == 304) {
+        // Not modified since the last check; the cached verdict still stands
+        qInfo() << "Update check: release info unchanged";
+        settings.setLastUpdateCheckTime(QDateTime::currentDateTime());
+        announceCachedVerdict();
+        reply->deleteLater();
+        return;
+    }
+
     if (reply->error() != QNetworkReply::NoError) {
         qWarning() << "Failed to check for update:" << reply->error();
         emit updateCheckFailed();
@@ -140,9 +225,10 @@ void UpdateCheck::handleResponse(QNetworkReply* reply)
     }
     const QByteArray result = reply->readAll();
     const QJsonDocument doc = QJsonDocument::fromJson(result);
+    // Only two fields matter; read them directly instead of converting the
+    // whole release object (changelog body, asset list, ...) to a QVariantMap
     const QJsonObject jObject = doc.object();
-    const QVariantMap mainMap = jObject.toVariantMap();
-    const QString latestVersion = mainMap["tag_name"].toString();
+    const QString latestVersion = jObject[QLatin1String("tag_name")].toString();
     if (latestVersion.isEmpty()) {
         qWarning() << "No tag name found in response:";
         emit updateCheckFailed();
@@ -150,12 +236,20 @@ void UpdateCheck::handleResponse(QNetworkReply* reply)
         return;
     }
 
+    // Persist the result so the next startup can answer from cache and later
+    // fetches can go out as conditional requests
+    settings.setUpdateCheckEtag(QString::fromUtf8(reply->rawHeader("ETag")));
+    settings.setUpdateCheckLastModified(QString::fromUtf8(reply->rawHeader("Last-Modified")));
+    settings.setLastKnownUpdateTag(latestVersion);
+    settings.setLastKnownUpdateLink(jObject[QLatin1String("html_url")].toString());
+    settings.setLastUpdateCheckTime(QDateTime::currentDateTime());
+
     const auto currentVer = tagToVersion(GIT_DESCRIBE);
     const auto availableVer = tagToVersion(latestVersion);
 
     if (isUpdateAvailable(currentVer, availableVer)) {
         qInfo() << "Update available to version" << latestVersion;
-        const QUrl link{mainMap["html_url"].toString()};
+        const QUrl link{jObject[QLatin1String("html_url")].toString()};
         emit updateAvailable(latestVersion, link);
     } else {
         qInfo() << "qTox is up to date";
@@ -20,7 +20,7 @@ class UpdateCheck : public QObject
     Q_OBJECT
 
 public:
-    explicit UpdateCheck(const Settings& settings_);
+    explicit UpdateCheck(Settings& settings_);
 
     constexpr bool canCheck() const
     {
@@ -43,7 +43,10 @@ private slots:
     void handleResponse(QNetworkReply* reply);
 
 private:
+    void fetchReleaseInfo();
+    bool announceCachedVerdict();
+
     QNetworkAccessManager manager;
     QTimer updateTimer;
-    const Settings& settings;
+    Settings& settings;
 };
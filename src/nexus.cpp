@@ -9,10 +9,12 @@
 #include "persistence/settings.h"
 #include "src/core/core.h"
 #include "src/core/coreav.h"
+#include "src/eventqueuemonitor.h"
 #include "src/ipc.h"
 #include "src/model/conferenceinvite.h"
 #include "src/model/status.h"
 #include "src/persistence/profile.h"
+#include "src/startuptracer.h"
 #include "src/widget/style.h"
 #include "src/widget/tool/messageboxmanager.h"
 #include "src/widget/widget.h"
@@ -27,6 +29,7 @@
 #include <vpx/vpx_image.h>
 
 #include <cassert>
+#include <tuple>
 
 #ifdef Q_OS_MAC
 #include <QActionGroup>
@@ -61,12 +64,28 @@ Nexus::Nexus(Settings& settings_, IMessageBoxManager& messageBoxManager_,
 
 Nexus::~Nexus()
 {
-    widget = nullptr;
+    // Flush everything a user could lose before any teardown work: if the
+    // process dies past this point the tox save and settings are on disk.
     if (profile != nullptr) {
         profile->save();
-        profile = nullptr;
     }
     emit saveGlobal();
+
+#ifdef QT_NO_DEBUG
+    // Fast exit: destroying the widget tree tears down every chat scene one
+    // item at a time and can take seconds with many open chats, while
+    // persisting nothing. Leak it and let the OS reclaim the memory; slow
+    // enough exits make users kill the process instead, which risks cutting
+    // the database flush below short. Debug builds keep the ordered teardown
+    // so leak checkers and destruction-order issues stay visible.
+    std::ignore = widget.release();
+#else
+    widget = nullptr;
+#endif
+
+    // The profile teardown stays ordered in all builds: it stops the core
+    // thread and closes the database cleanly (checkpointing the WAL)
+    profile = nullptr;
 #ifdef Q_OS_MAC
     delete globalMenuBar;
 #endif
@@ -80,10 +99,13 @@ Nexus::~Nexus()
  */
 void Nexus::start()
 {
+    StartupTracer::Scope scope{"nexusStart"};
     qDebug() << "Starting up";
 
     // Setup the environment
     qRegisterMetaType<Status::Status>("Status::Status");
+    qRegisterMetaType<QHash<uint32_t, Status::Status>>("QHash<uint32_t,Status::Status>");
+    qRegisterMetaType<QHash<uint32_t, bool>>("QHash<uint32_t,bool>");
     qRegisterMetaType<vpx_image>("vpx_image");
     qRegisterMetaType<uint8_t>("uint8_t");
     qRegisterMetaType<uint16_t>("uint16_t");
@@ -109,6 +131,8 @@ void Nexus::start()
 
     qApp->setQuitOnLastWindowClosed(false);
 
+    EventQueueMonitor::instance().install();
+
 #ifdef Q_OS_MAC
     // TODO: still needed?
     globalMenuBar = new QMenuBar();
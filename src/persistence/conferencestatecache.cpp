@@ -0,0 +1,191 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "conferencestatecache.h"
+
+#include "src/core/toxencrypt.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+
+#include <cstring>
+
+namespace {
+// Little endian ASCII "QTCS" magic, then a version byte and a flags byte
+// (bit 0: payload is encrypted)
+const char magic[] = {0x51, 0x54, 0x43, 0x53};
+constexpr char versionByte = 1;
+constexpr int headerSize = 6;
+
+// Peer churn updates the snapshot once per joining or leaving peer; one
+// write a few seconds after the burst settles is plenty
+constexpr int saveDebounceMs = 5 * 1000;
+} // namespace
+
+ConferenceStateCache::ConferenceStateCache(QString filePath_, const ToxEncrypt* passKey_)
+    : filePath{filePath_}
+    , passKey{passKey_}
+{
+    saveTimer.setSingleShot(true);
+    saveTimer.setInterval(saveDebounceMs);
+    connect(&saveTimer, &QTimer::timeout, this, &ConferenceStateCache::save);
+}
+
+ConferenceStateCache::~ConferenceStateCache()
+{
+    if (dirty) {
+        save();
+    }
+}
+
+/**
+ * @brief Reads the snapshot from disk, discarding unusable files.
+ */
+void ConferenceStateCache::load()
+{
+    states.clear();
+
+    QFile in{filePath};
+    if (!in.exists()) {
+        return;
+    }
+
+    if (!in.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open conference state cache" << filePath;
+        return;
+    }
+
+    const QByteArray data = in.readAll();
+    in.close();
+
+    if (data.size() < headerSize || memcmp(data.constData(), magic, sizeof(magic)) != 0
+        || data[4] != versionByte) {
+        qWarning() << "Discarding unrecognized conference state cache" << filePath;
+        return;
+    }
+
+    const bool wasEncrypted = (data[5] & 1) != 0;
+    if (wasEncrypted != (passKey != nullptr)) {
+        // The profile password was added or removed since the snapshot was
+        // written; it only costs us one slow conference restore
+        qDebug() << "Conference state cache encryption no longer matches the profile, discarding";
+        return;
+    }
+
+    QByteArray payload = data.mid(headerSize);
+    if (passKey != nullptr) {
+        payload = passKey->decrypt(payload);
+        if (payload.isEmpty()) {
+            qWarning() << "Failed to decrypt conference state cache" << filePath;
+            return;
+        }
+    }
+
+    QDataStream stream(payload);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    qint32 conferenceCount = 0;
+    stream >> conferenceCount;
+    for (qint32 i = 0; i < conferenceCount && stream.status() == QDataStream::Ok; ++i) {
+        QByteArray id;
+        State state;
+        qint32 peerCount = 0;
+        stream >> id >> state.title >> peerCount;
+        for (qint32 p = 0; p < peerCount && stream.status() == QDataStream::Ok; ++p) {
+            QByteArray pkBytes;
+            QString name;
+            stream >> pkBytes >> name;
+            if (pkBytes.size() == ToxPk::size) {
+                state.peers.insert(ToxPk{pkBytes}, name);
+            }
+        }
+        if (id.size() == ConferenceId::size) {
+            states.insert(id, state);
+        }
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << "Conference state cache is corrupt, discarding" << filePath;
+        states.clear();
+    }
+}
+
+/**
+ * @brief Returns the cached state for a conference, empty if none is known.
+ */
+ConferenceStateCache::State ConferenceStateCache::get(const ConferenceId& id) const
+{
+    return states.value(id.getByteArray());
+}
+
+void ConferenceStateCache::update(const ConferenceId& id, const QString& title,
+                                  const QMap<ToxPk, QString>& peers)
+{
+    State& state = states[id.getByteArray()];
+    if (state.title == title && state.peers == peers) {
+        return;
+    }
+
+    state.title = title;
+    state.peers = peers;
+    dirty = true;
+    if (!saveTimer.isActive()) {
+        saveTimer.start();
+    }
+}
+
+void ConferenceStateCache::remove(const ConferenceId& id)
+{
+    if (states.remove(id.getByteArray()) > 0) {
+        dirty = true;
+        if (!saveTimer.isActive()) {
+            saveTimer.start();
+        }
+    }
+}
+
+/**
+ * @brief Writes the whole snapshot to disk atomically.
+ */
+void ConferenceStateCache::save()
+{
+    saveTimer.stop();
+    dirty = false;
+
+    QByteArray payload;
+    {
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_0);
+
+        stream << static_cast<qint32>(states.size());
+        for (auto it = states.cbegin(); it != states.cend(); ++it) {
+            stream << it.key() << it->title << static_cast<qint32>(it->peers.size());
+            for (auto peer = it->peers.cbegin(); peer != it->peers.cend(); ++peer) {
+                stream << peer.key().getByteArray() << peer.value();
+            }
+        }
+    }
+
+    if (passKey != nullptr) {
+        payload = passKey->encrypt(payload);
+    }
+
+    QSaveFile out{filePath};
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to open conference state cache for writing" << filePath;
+        return;
+    }
+
+    out.write(magic, sizeof(magic));
+    out.write(&versionByte, 1);
+    const char flags = passKey != nullptr ? 1 : 0;
+    out.write(&flags, 1);
+    out.write(payload);
+
+    if (!out.commit()) {
+        qWarning() << "Failed to write conference state cache" << filePath;
+    }
+}
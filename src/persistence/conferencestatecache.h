@@ -0,0 +1,58 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include "src/core/conferenceid.h"
+#include "src/core/toxpk.h"
+
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+class ToxEncrypt;
+
+/**
+ * @brief Snapshot of last-known conference state for instant restore.
+ *
+ * After a restart, toxcore only syncs conference peer lists as peers
+ * reconnect, so restored conference windows start out empty and fill in one
+ * peer at a time. This cache keeps the last-known title and peer names per
+ * conference on disk; they are used to pre-populate the conference on
+ * startup and are reconciled against the live peer list as it syncs.
+ *
+ * The file is encrypted with the profile passkey when one is set, mirroring
+ * the settings file, and discarded when its encryption no longer matches
+ * the profile. Writes are debounced since peer churn can update the
+ * snapshot many times in quick succession.
+ */
+class ConferenceStateCache : public QObject
+{
+    Q_OBJECT
+public:
+    struct State
+    {
+        QString title;
+        QMap<ToxPk, QString> peers;
+    };
+
+    ConferenceStateCache(QString filePath_, const ToxEncrypt* passKey_);
+    ~ConferenceStateCache() override;
+
+    void load();
+    State get(const ConferenceId& id) const;
+    void update(const ConferenceId& id, const QString& title, const QMap<ToxPk, QString>& peers);
+    void remove(const ConferenceId& id);
+
+private:
+    void save();
+
+    QString filePath;
+    const ToxEncrypt* passKey;
+    QHash<QByteArray, State> states;
+    QTimer saveTimer;
+    bool dirty = false;
+};
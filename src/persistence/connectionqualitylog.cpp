@@ -0,0 +1,104 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "connectionqualitylog.h"
+
+#include <QDebug>
+
+/**
+ * @class ConnectionQualityLog
+ * @brief Bounded per-friend history of call quality samples.
+ *
+ * Stores the periodic samples CoreAV emits during calls into a ring table in
+ * the profile database, so "why was my call bad" can be answered after the
+ * fact instead of requiring a reproduction. Each insert trims rows older than
+ * the newest maxSamplesPerFriend for that friend, so the table stays bounded
+ * no matter how long the profile lives.
+ *
+ * The table is diagnostics data, created on demand with no migration path;
+ * it deliberately stays outside the message schema versioning so dropping or
+ * reshaping it can never hold a chat history upgrade hostage.
+ */
+
+ConnectionQualityLog::ConnectionQualityLog(std::shared_ptr<RawDatabase> db_)
+    : db{db_}
+{
+    if (!isValid()) {
+        qWarning() << "Database not open, connection quality log disabled";
+        return;
+    }
+
+    db->execNow(
+        QStringLiteral("CREATE TABLE IF NOT EXISTS connection_quality "
+                       "(id INTEGER PRIMARY KEY, peer_pk BLOB NOT NULL, "
+                       "timestamp INTEGER NOT NULL, audio_bitrate INTEGER NOT NULL, "
+                       "video_bitrate INTEGER NOT NULL, dropped_frames INTEGER NOT NULL);"));
+    db->execNow(QStringLiteral("CREATE INDEX IF NOT EXISTS connection_quality_peer_idx "
+                               "ON connection_quality (peer_pk, id);"));
+}
+
+bool ConnectionQualityLog::isValid() const
+{
+    return db && db->isOpen();
+}
+
+/**
+ * @brief Appends a sample to a friend's ring and trims rows that fell out.
+ *
+ * Queued on the database thread; sampling during a call never blocks on disk.
+ */
+void ConnectionQualityLog::addSample(const ToxPk& friendPk, const Sample& sample)
+{
+    if (!isValid()) {
+        return;
+    }
+
+    QVector<RawDatabase::Query> queries;
+    queries += RawDatabase::Query(
+        QStringLiteral("INSERT INTO connection_quality "
+                       "(peer_pk, timestamp, audio_bitrate, video_bitrate, dropped_frames) "
+                       "VALUES (?, %1, %2, %3, %4);")
+            .arg(sample.timestamp.toMSecsSinceEpoch())
+            .arg(sample.audioBitrate)
+            .arg(sample.videoBitrate)
+            .arg(sample.droppedFrames),
+        {friendPk.getByteArray()});
+    // The subselect finds the oldest row still inside the ring; everything at
+    // or before it goes. With fewer rows than the ring holds it yields NULL
+    // and the DELETE matches nothing.
+    queries += RawDatabase::Query(
+        QStringLiteral("DELETE FROM connection_quality WHERE peer_pk = ? AND id <= "
+                       "(SELECT id FROM connection_quality WHERE peer_pk = ? "
+                       "ORDER BY id DESC LIMIT 1 OFFSET %1);")
+            .arg(maxSamplesPerFriend),
+        {friendPk.getByteArray(), friendPk.getByteArray()});
+    db->execLater(queries);
+}
+
+/**
+ * @brief Loads a friend's recorded samples, oldest first.
+ */
+QList<ConnectionQualityLog::Sample> ConnectionQualityLog::getSamples(const ToxPk& friendPk)
+{
+    QList<Sample> samples;
+    if (!isValid()) {
+        return samples;
+    }
+
+    auto rowCallback = [&samples](const RawDatabase::Row& row) {
+        Sample sample;
+        sample.timestamp = QDateTime::fromMSecsSinceEpoch(row.int64Value(0));
+        sample.audioBitrate = static_cast<quint32>(row.int64Value(1));
+        sample.videoBitrate = static_cast<quint32>(row.int64Value(2));
+        sample.droppedFrames = static_cast<quint32>(row.int64Value(3));
+        samples.append(sample);
+    };
+
+    db->execNowReadOnly(
+        {QStringLiteral("SELECT timestamp, audio_bitrate, video_bitrate, dropped_frames "
+                        "FROM connection_quality WHERE peer_pk = ? ORDER BY id ASC;"),
+         {friendPk.getByteArray()},
+         std::function<void(const RawDatabase::Row&)>{rowCallback}});
+    return samples;
+}
@@ -0,0 +1,49 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include "src/core/toxpk.h"
+#include "src/persistence/db/rawdatabase.h"
+
+#include <QDateTime>
+#include <QList>
+#include <QObject>
+
+#include <memory>
+
+class ConnectionQualityLog : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief One periodic quality reading for a call with a friend.
+     *
+     * toxav exposes no round trip time, so the congestion-driven bitrate
+     * recommendations stand in as the link quality measure.
+     */
+    struct Sample
+    {
+        QDateTime timestamp;
+        /// toxav's recommended audio bitrate in kbit/s; 0 before any feedback
+        quint32 audioBitrate;
+        /// outgoing video bitrate set in toxav in kbit/s; 0 for audio-only calls
+        quint32 videoBitrate;
+        /// outgoing video frames dropped since the previous sample
+        quint32 droppedFrames;
+    };
+
+    // Ring size per friend; at the sampling cadence this covers several hours
+    // of recent calls, enough to diagnose "yesterday's call was bad"
+    static constexpr int maxSamplesPerFriend = 4096;
+
+    explicit ConnectionQualityLog(std::shared_ptr<RawDatabase> db_);
+
+    bool isValid() const;
+    void addSample(const ToxPk& friendPk, const Sample& sample);
+    QList<Sample> getSamples(const ToxPk& friendPk);
+
+private:
+    std::shared_ptr<RawDatabase> db;
+};
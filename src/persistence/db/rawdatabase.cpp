@@ -5,14 +5,67 @@
 
 #include "rawdatabase.h"
 
+#include "src/allocationtracker.h"
+#include "util/perfzone.h"
+
+#include <algorithm>
 #include <cassert>
 #include <tox/toxencryptsave.h>
 
 #include <QCoreApplication>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QHash>
 #include <QMetaObject>
 #include <QMutexLocker>
+#include <QTimer>
+
+namespace {
+// How long a coalescible transaction may sit in the queue before the worker is
+// forced to drain it, and how many transactions we merge into one BEGIN/COMMIT
+// at most, to bound both latency and memory during bulk imports.
+constexpr int coalesceFlushIntervalMs = 25;
+constexpr int maxCoalescedTransactions = 512;
+// Pages reclaimed per maintenance slice. Each slice is its own queued
+// transaction, so pending chat traffic interleaves between slices.
+constexpr int vacuumSlicePages = 512;
+// Caps the rows ANALYZE scans per index so the final maintenance step stays
+// bounded even on multi-GB histories.
+constexpr int analysisRowLimit = 1000;
+// Queries slower than this are logged together with their query plan, so a
+// missing index shows up in debug logs before users report lag.
+constexpr int64_t slowQueryThresholdUs = 100 * 1000;
+// Caps how many corruption findings integrity_check reports; a badly damaged
+// database would otherwise produce one row per broken page.
+constexpr int integrityCheckMaxFindings = 50;
+
+/**
+ * @brief Captures EXPLAIN QUERY PLAN output for the first statement of a query.
+ *
+ * Runs on the connection that just executed the query, so the plan reflects
+ * the indexes and stats that connection actually saw.
+ */
+QString explainQueryPlan(sqlite3* db, const QByteArray& query)
+{
+    const QByteArray explainQuery = QByteArrayLiteral("EXPLAIN QUERY PLAN ") + query;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, explainQuery.data(), explainQuery.size(), &stmt, nullptr)
+        != SQLITE_OK) {
+        return QStringLiteral("(no query plan available)");
+    }
+
+    QString plan;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        if (!plan.isEmpty())
+            plan += QLatin1Char('\n');
+        plan += QStringLiteral("  ")
+                + QString::fromUtf8(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)));
+    }
+    sqlite3_finalize(stmt);
+    return plan;
+}
+} // namespace
 
 
 /**
@@ -23,6 +76,10 @@
  * The queries must not contain transaction commands (BEGIN/COMMIT/...) or the behavior is
  * undefined.
  *
+ * Read-only queries can additionally run on a separate read lane via
+ * execNowReadOnly, concurrently with the worker, when WAL journal mode is
+ * available.
+ *
  * @var QMutex RawDatabase::transactionsMutex;
  * @brief Protects pendingTransactions
  */
@@ -38,8 +95,8 @@
  * @var QByteArray RawDatabase::Query::query
  * @brief UTF-8 query string
  *
- * @var QVector<QByteArray> RawDatabase::Query::blobs
- * @brief Bound data blobs
+ * @var QVector<BindValue> RawDatabase::Query::params
+ * @brief Bound parameters, each a data blob or a 64-bit integer
  *
  * @var std::function<void(int64_t)> RawDatabase::Query::insertCallback
  * @brief Called after execution with the last insert rowid
@@ -47,6 +104,10 @@
  * @var std::function<void(const QVector<QVariant>&)> RawDatabase::Query::rowCallback
  * @brief Called during execution for each row
  *
+ * @var std::function<void(const Row&)> RawDatabase::Query::typedRowCallback
+ * @brief Like rowCallback, but hands out a typed view of the row instead of
+ * boxing every column in a QVariant; takes precedence when both are set
+ *
  * @var QVector<sqlite3_stmt*> RawDatabase::Query::statements
  * @brief Statements to be compiled from the query
  */
@@ -62,6 +123,10 @@
  *
  * @var std::atomic_bool* RawDatabase::Transaction::done = nullptr;
  * @brief If not a nullptr, will be set to true when the transaction has been executed
+ *
+ * @var bool RawDatabase::Transaction::coalescible
+ * @brief If true, the worker may merge this transaction with adjacent coalescible
+ * ones into a single BEGIN/COMMIT to avoid per-transaction fsyncs
  */
 
 /**
@@ -168,6 +233,22 @@ bool RawDatabase::open(const QString& path_, const QString& hexKey)
             return false;
         }
     }
+
+    // WAL lets the read-only lane serve queries while the worker writes.
+    // Fall back to the rollback journal where WAL can't work, e.g. read-only
+    // or network filesystems; reads then share the write connection as before.
+    QString journalMode;
+    if (execNow(Query{QStringLiteral("PRAGMA journal_mode = WAL;"),
+                      [&journalMode](const QVector<QVariant>& row) {
+                          journalMode = row[0].toString();
+                      }})) {
+        walEnabled.store(journalMode.compare(QStringLiteral("wal"), Qt::CaseInsensitive) == 0,
+                         std::memory_order_release);
+    }
+    if (!walEnabled.load(std::memory_order_acquire)) {
+        qWarning() << "Failed to enable WAL journal mode, read queries will share the write "
+                      "connection";
+    }
     return true;
 }
 
@@ -184,6 +265,7 @@ bool RawDatabase::openEncryptedDatabaseAtLatestSupportedVersion(const QString& h
 
     auto highestSupportedVersion = highestSupportedParams();
     if (setCipherParameters(highestSupportedVersion)) {
+        currentCipherParams = highestSupportedVersion;
         if (testUsable()) {
             qInfo() << "Opened database with SQLCipher" << toString(highestSupportedVersion)
                     << "parameters";
@@ -242,6 +324,18 @@ bool RawDatabase::updateSavedCipherParameters(const QString& hexKey, SqlCipherPa
 }
 
 bool RawDatabase::setCipherParameters(SqlCipherParams params, const QString& database)
+{
+    qDebug() << "Setting SQLCipher" << toString(params) << "parameters";
+    return execNow(cipherParamsQuery(params, database));
+}
+
+/**
+ * @brief Builds the PRAGMA statements configuring the given SQLCipher params.
+ *
+ * Shared between the write connection and the read-only lane, which has to
+ * replay the same params on its own connection.
+ */
+QString RawDatabase::cipherParamsQuery(SqlCipherParams params, const QString& database)
 {
     QString prefix;
     if (!database.isNull()) {
@@ -281,8 +375,7 @@ bool RawDatabase::setCipherParameters(SqlCipherParams params, const QString& dat
     }
     }
 
-    qDebug() << "Setting SQLCipher" << toString(params) << "parameters";
-    return execNow(defaultParams.replace("database.", prefix));
+    return defaultParams.replace("database.", prefix);
 }
 
 RawDatabase::SqlCipherParams RawDatabase::highestSupportedParams()
@@ -368,6 +461,19 @@ void RawDatabase::close()
     // We assume we're in the ctor or dtor, so we just need to finish processing our transactions
     process();
 
+    if (const QString stats = queryStatsToString(); !stats.isEmpty())
+        qDebug().noquote() << "Query latency stats for" << path << '\n' << stats;
+
+    // Cached statements belong to this connection and must be finalized before closing
+    statementCache.clear();
+
+    // The read lane must not outlive the write connection, e.g. across a
+    // rekeying db swap
+    {
+        QMutexLocker<QMutex> locker{&readLaneMutex};
+        closeReadConnection();
+    }
+
     if (sqlite3_close(sqlite) == SQLITE_OK)
         sqlite = nullptr;
     else
@@ -437,6 +543,136 @@ bool RawDatabase::execNow(const QVector<RawDatabase::Query>& statements)
     return success.load(std::memory_order_acquire);
 }
 
+/**
+ * @brief Executes read-only queries on a dedicated connection, concurrently
+ * with the write worker.
+ * @param statement Statement to execute.
+ * @return Whether the queries were successful.
+ *
+ * Runs on the calling thread instead of queueing behind pending writes, so
+ * heavy reads (search, export, statistics) never delay the write path. Needs
+ * WAL journal mode; where that is unavailable this falls back to execNow.
+ *
+ * @warning Writes still sitting in the asynchronous queue are not visible to
+ * the read lane, so only use this where slightly stale results are acceptable.
+ */
+bool RawDatabase::execNowReadOnly(const QString& statement)
+{
+    return execNowReadOnly(Query{statement});
+}
+
+bool RawDatabase::execNowReadOnly(const Query& statement)
+{
+    return execNowReadOnly(QVector<Query>{statement});
+}
+
+bool RawDatabase::execNowReadOnly(const QVector<Query>& statements)
+{
+    if (!sqlite) {
+        qWarning() << "Trying to exec, but the database is not open";
+        return false;
+    }
+
+    {
+        QMutexLocker<QMutex> locker{&readLaneMutex};
+        if (openReadConnection()) {
+            return execDirect(readSqlite, statements);
+        }
+    }
+
+    // No read connection available, share the write lane
+    return execNow(statements);
+}
+
+/**
+ * @brief Lazily opens the read-only connection. Must hold readLaneMutex.
+ * @return True if the connection is available.
+ */
+bool RawDatabase::openReadConnection()
+{
+    if (readSqlite != nullptr) {
+        return true;
+    }
+
+    if (!walEnabled.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    if (sqlite3_open_v2(path.toUtf8().data(), &readSqlite,
+                        SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr)
+        != SQLITE_OK) {
+        qWarning() << "Failed to open read connection to" << path
+                   << "with error:" << sqlite3_errmsg(readSqlite);
+        sqlite3_close(readSqlite);
+        readSqlite = nullptr;
+        return false;
+    }
+
+    // Checkpoints briefly lock the db even under WAL, wait them out
+    sqlite3_busy_timeout(readSqlite, 5000);
+
+    // Search queries run on this connection and use our regexp functions
+    if (sqlite3_create_function(readSqlite, "regexp", 2, SQLITE_UTF8, nullptr,
+                                &RawDatabase::regexpInsensitive, nullptr, nullptr)
+        || sqlite3_create_function(readSqlite, "regexpsensitive", 2, SQLITE_UTF8, nullptr,
+                                   &RawDatabase::regexpSensitive, nullptr, nullptr)) {
+        qWarning() << "Failed to create regexp functions on the read connection";
+        closeReadConnection();
+        return false;
+    }
+
+    // Key pragmas must run outside a transaction, so one query at a time
+    if (!currentHexKey.isEmpty()
+        && (!execDirect(readSqlite, {Query{"PRAGMA key = \"x'" + currentHexKey + "'\""}})
+            || !execDirect(readSqlite, {Query{cipherParamsQuery(currentCipherParams)}})
+            || !execDirect(readSqlite, {Query{QStringLiteral("SELECT count(*) FROM sqlite_master;")}}))) {
+        qWarning() << "Failed to key the read connection";
+        closeReadConnection();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Closes the read-only connection if open. Must hold readLaneMutex.
+ */
+void RawDatabase::closeReadConnection()
+{
+    if (readSqlite == nullptr) {
+        return;
+    }
+
+    if (sqlite3_close(readSqlite) != SQLITE_OK) {
+        qWarning() << "Error closing read connection:" << sqlite3_errmsg(readSqlite);
+    }
+    readSqlite = nullptr;
+}
+
+/**
+ * @brief Compiles and executes queries on the given connection, on the calling
+ * thread, bypassing the transaction queue. Statements are finalized afterwards
+ * rather than cached, since the statement cache belongs to the worker thread.
+ */
+bool RawDatabase::execDirect(sqlite3* db, const QVector<Query>& statements)
+{
+    std::atomic_bool success{false};
+
+    Transaction trans;
+    trans.queries = statements;
+    trans.success = &success;
+    compileAndExecute(trans, db);
+
+    for (Query& query : trans.queries) {
+        for (sqlite3_stmt* stmt : query.statements) {
+            sqlite3_finalize(stmt);
+        }
+        query.statements.clear();
+    }
+
+    return success.load(std::memory_order_acquire);
+}
+
 /**
  * @brief Executes a SQL transaction asynchronously.
  * @param statement Statement to execute.
@@ -452,6 +688,36 @@ void RawDatabase::execLater(const RawDatabase::Query& statement)
 }
 
 void RawDatabase::execLater(const QVector<RawDatabase::Query>& statements)
+{
+    enqueueLater(statements, false);
+}
+
+/**
+ * @brief Executes a SQL transaction asynchronously, allowing the worker to merge
+ * it with neighbouring coalescible transactions into a single BEGIN/COMMIT.
+ * @param statement Statement to execute.
+ *
+ * Use this for high-volume writes (history import, bulk delivery updates) where
+ * per-transaction commit durability is not required. The transaction is flushed
+ * at the latest after a short deadline, or immediately when a regular
+ * transaction or a sync() gets queued behind it.
+ */
+void RawDatabase::execLaterCoalesced(const QString& statement)
+{
+    execLaterCoalesced(Query{statement});
+}
+
+void RawDatabase::execLaterCoalesced(const RawDatabase::Query& statement)
+{
+    execLaterCoalesced(QVector<Query>{statement});
+}
+
+void RawDatabase::execLaterCoalesced(const QVector<RawDatabase::Query>& statements)
+{
+    enqueueLater(statements, true);
+}
+
+void RawDatabase::enqueueLater(const QVector<RawDatabase::Query>& statements, bool coalescible)
 {
     if (!sqlite) {
         qWarning() << "Trying to exec, but the database is not open";
@@ -460,12 +726,24 @@ void RawDatabase::execLater(const QVector<RawDatabase::Query>& statements)
 
     Transaction trans;
     trans.queries = statements;
+    trans.coalescible = coalescible;
+    int backlog;
     {
         QMutexLocker<QMutex> locker{&transactionsMutex};
         pendingTransactions.enqueue(trans);
+        backlog = pendingTransactions.size();
     }
 
-    QMetaObject::invokeMethod(this, "process", Qt::QueuedConnection);
+    if (!coalescible || backlog >= maxCoalescedTransactions) {
+        QMetaObject::invokeMethod(this, "process", Qt::QueuedConnection);
+        return;
+    }
+
+    // Let more coalescible transactions pile up before draining, but bound the
+    // time any of them can wait with a flush deadline.
+    if (!coalesceFlushScheduled.exchange(true, std::memory_order_acq_rel)) {
+        QTimer::singleShot(coalesceFlushIntervalMs, this, [this] { process(); });
+    }
 }
 
 /**
@@ -476,6 +754,164 @@ void RawDatabase::sync()
     QMetaObject::invokeMethod(this, "process", Qt::BlockingQueuedConnection);
 }
 
+/**
+ * @brief Bytes sqlite currently holds across all connections in this process.
+ *
+ * Reads the global allocator counter, so the figure covers page caches,
+ * prepared statements and lookaside of every open database at once.
+ */
+quint64 RawDatabase::sqliteMemoryUsed()
+{
+    sqlite3_int64 current = 0;
+    sqlite3_int64 highWater = 0;
+    if (sqlite3_status64(SQLITE_STATUS_MEMORY_USED, &current, &highWater, 0) != SQLITE_OK) {
+        return 0;
+    }
+    return quint64(current);
+}
+
+/**
+ * @brief Asks this database to shed as much heap memory as it can.
+ *
+ * Queued onto the worker thread since sqlite connections are not safe to
+ * poke from outside it; pending transactions run first.
+ */
+void RawDatabase::releaseMemory()
+{
+    QMetaObject::invokeMethod(
+        this,
+        [this] {
+            if (sqlite) {
+                sqlite3_db_release_memory(sqlite);
+            }
+        },
+        Qt::QueuedConnection);
+}
+
+/**
+ * @brief Compacts and re-analyzes the database in slices on the worker thread.
+ *
+ * Runs incremental_vacuum in bounded slices followed by a row-limited ANALYZE,
+ * each as its own queued transaction so regular chat traffic interleaves
+ * between slices. Databases still on the default auto_vacuum mode are
+ * converted first, which requires one full VACUUM rebuild; that initial run
+ * occupies the worker for its duration, subsequent runs are incremental.
+ *
+ * @param progressCallback Invoked on the worker thread with a 0-100 percentage.
+ * @param doneCallback Invoked on the worker thread when maintenance ends.
+ */
+void RawDatabase::runMaintenance(const std::function<void(int)>& progressCallback,
+                                 const std::function<void(bool)>& doneCallback)
+{
+    if (maintenanceActive.exchange(true)) {
+        qWarning() << "Database maintenance is already running";
+        if (doneCallback) {
+            doneCallback(false);
+        }
+        return;
+    }
+
+    maintenanceProgressCallback = progressCallback;
+    maintenanceDoneCallback = doneCallback;
+    maintenanceFreelistBaseline = 0;
+
+    auto autoVacuumMode = std::make_shared<int>(0);
+    QVector<Query> queries;
+    queries += Query{QStringLiteral("PRAGMA auto_vacuum;"),
+                     [autoVacuumMode](const QVector<QVariant>& row) {
+                         *autoVacuumMode = row[0].toInt();
+                     }};
+    queries += Query{QStringLiteral("PRAGMA freelist_count;"),
+                     [this, autoVacuumMode](const QVector<QVariant>& row) {
+                         maintenanceFreelistBaseline = row[0].toLongLong();
+                         if (*autoVacuumMode == 2) {
+                             scheduleMaintenanceSlice();
+                             return;
+                         }
+                         // Switching auto_vacuum only takes effect after a full
+                         // rebuild, which also reclaims the whole freelist
+                         execLater(Query{QStringLiteral(
+                                             "PRAGMA auto_vacuum = INCREMENTAL; VACUUM;"),
+                                         {},
+                                         [this](RowId) {
+                                             if (maintenanceProgressCallback) {
+                                                 maintenanceProgressCallback(90);
+                                             }
+                                             scheduleMaintenanceAnalyze();
+                                         }});
+                     }};
+    execLater(queries);
+}
+
+void RawDatabase::scheduleMaintenanceSlice()
+{
+    // A single Query never gets wrapped in BEGIN/COMMIT, which matters here:
+    // incremental_vacuum can't run inside a transaction
+    execLater(Query{QStringLiteral("PRAGMA incremental_vacuum(%1); PRAGMA freelist_count;")
+                        .arg(vacuumSlicePages),
+                    [this](const QVector<QVariant>& row) {
+                        const int64_t remaining = row[0].toLongLong();
+                        if (maintenanceProgressCallback && maintenanceFreelistBaseline > 0) {
+                            // Vacuuming covers 0-90, the final ANALYZE the rest
+                            const int percent = static_cast<int>(
+                                90 * (maintenanceFreelistBaseline - remaining)
+                                / maintenanceFreelistBaseline);
+                            maintenanceProgressCallback(qBound(0, percent, 90));
+                        }
+                        if (remaining > 0) {
+                            scheduleMaintenanceSlice();
+                        } else {
+                            scheduleMaintenanceAnalyze();
+                        }
+                    }});
+}
+
+void RawDatabase::scheduleMaintenanceAnalyze()
+{
+    execLater(Query{QStringLiteral("PRAGMA analysis_limit = %1; ANALYZE;").arg(analysisRowLimit),
+                    {}, [this](RowId) { finishMaintenance(true); }});
+}
+
+/**
+ * @brief Runs sqlite's structural integrity check on the calling thread.
+ *
+ * Executes on the read-only connection when WAL is available, so the worker
+ * keeps processing chat traffic while the scan walks the b-trees; callers are
+ * expected to invoke this from a worker pool thread, not the GUI thread.
+ *
+ * @return Corruption findings as reported by sqlite; empty means the file
+ *         structure is sound.
+ */
+QStringList RawDatabase::checkIntegrity()
+{
+    QStringList findings;
+    const Query query{QStringLiteral("PRAGMA integrity_check(%1);").arg(integrityCheckMaxFindings),
+                      [&findings](const QVector<QVariant>& row) {
+                          const QString result = row[0].toString();
+                          if (result != QLatin1String("ok")) {
+                              findings += result;
+                          }
+                      }};
+    if (!execNowReadOnly(query)) {
+        findings += QStringLiteral("integrity_check failed to execute");
+    }
+    return findings;
+}
+
+void RawDatabase::finishMaintenance(bool success)
+{
+    if (success && maintenanceProgressCallback) {
+        maintenanceProgressCallback(100);
+    }
+    const auto done = maintenanceDoneCallback;
+    maintenanceProgressCallback = {};
+    maintenanceDoneCallback = {};
+    maintenanceActive.store(false, std::memory_order_release);
+    if (done) {
+        done(success);
+    }
+}
+
 /**
  * @brief Changes the database password, encrypting or decrypting if necessary.
  * @param password If password is empty, the database will be decrypted.
@@ -720,8 +1156,10 @@ QString RawDatabase::deriveKey(const QString& password, const QByteArray& salt)
     return QString::fromUtf8(QByteArray(reinterpret_cast<char*>(key.get()) + 32, 32).toHex());
 }
 
-void RawDatabase::compileAndExecute(Transaction& trans)
+void RawDatabase::compileAndExecute(Transaction& trans, sqlite3* db)
 {
+    AllocationTracker::Scope allocScope{AllocationTracker::Subsystem::Database};
+
     // In case we exit early, prepare to signal errors
     if (trans.success != nullptr)
         trans.success->store(false, std::memory_order_release);
@@ -732,37 +1170,55 @@ void RawDatabase::compileAndExecute(Transaction& trans)
         trans.queries.append({"COMMIT;"});
     }
 
-    // Compile queries
+    // Compile queries; the statement cache belongs to the worker's write
+    // connection, so the read lane always compiles afresh
+    const bool useCache = db == sqlite;
     for (Query& query : trans.queries) {
         assert(query.statements.isEmpty());
-        // sqlite3_prepare_v2 only compiles one statement at a time in the query,
-        // we need to loop over them all
-        int curParam = 0;
-        const char* compileTail = query.query.data();
-        do {
-            // Compile the next statement
-            sqlite3_stmt* stmt;
-            int r;
-            if ((r = sqlite3_prepare_v2(sqlite, compileTail,
-                                        query.query.size()
-                                            - static_cast<int>(compileTail - query.query.data()),
-                                        &stmt, &compileTail))
-                != SQLITE_OK) {
-                qWarning() << "Failed to prepare statement" << anonymizeQuery(query.query)
-                           << "and returned" << r;
-                qWarning("The full error is %d: %s", sqlite3_errcode(sqlite), sqlite3_errmsg(sqlite));
-                return;
-            }
-            query.statements += stmt;
 
-            // Now we can bind our params to this statement
+        QElapsedTimer queryTimer;
+        queryTimer.start();
+
+        if (CachedStatements* cached = useCache ? statementCache.take(query.query) : nullptr) {
+            // Reuse previously compiled statements, skipping the parser entirely
+            query.statements = std::move(cached->statements);
+            delete cached;
+        } else {
+            // sqlite3_prepare_v2 only compiles one statement at a time in the query,
+            // we need to loop over them all
+            const char* compileTail = query.query.data();
+            do {
+                // Compile the next statement
+                sqlite3_stmt* stmt;
+                int r;
+                if ((r = sqlite3_prepare_v2(db, compileTail,
+                                            query.query.size()
+                                                - static_cast<int>(compileTail - query.query.data()),
+                                            &stmt, &compileTail))
+                    != SQLITE_OK) {
+                    qWarning() << "Failed to prepare statement" << anonymizeQuery(query.query)
+                               << "and returned" << r;
+                    qWarning("The full error is %d: %s", sqlite3_errcode(db), sqlite3_errmsg(db));
+                    // Don't let a partially compiled statement list reach the cache
+                    for (sqlite3_stmt* compiled : query.statements)
+                        sqlite3_finalize(compiled);
+                    query.statements.clear();
+                    return;
+                }
+                query.statements += stmt;
+            } while (compileTail != query.query.data() + query.query.size());
+        }
+
+        // Now we can bind our params to the statements
+        int curParam = 0;
+        for (sqlite3_stmt* stmt : query.statements) {
             int nParams = sqlite3_bind_parameter_count(stmt);
-            if (query.blobs.size() < curParam + nParams) {
+            if (query.params.size() < curParam + nParams) {
                 qWarning() << "Not enough parameters to bind to query " << anonymizeQuery(query.query);
                 return;
             }
             for (int i = 0; i < nParams; ++i) {
-                const QByteArray& blob = query.blobs[curParam + i];
+                const BindValue& param = query.params[curParam + i];
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wold-style-cast"
 #pragma GCC diagnostic ignored "-Wzero-as-null-pointer-constant"
@@ -770,15 +1226,19 @@ void RawDatabase::compileAndExecute(Transaction& trans)
                 // system headers, so can't be fixed by us.
                 constexpr auto sqliteDataType = SQLITE_STATIC;
 #pragma GCC diagnostic pop
-                if (sqlite3_bind_blob(stmt, i + 1, blob.data(), blob.size(), sqliteDataType)
-                    != SQLITE_OK) {
+                const int bindResult =
+                    param.isInteger
+                        ? sqlite3_bind_int64(stmt, i + 1, param.integer)
+                        : sqlite3_bind_blob(stmt, i + 1, param.blob.data(), param.blob.size(),
+                                            sqliteDataType);
+                if (bindResult != SQLITE_OK) {
                     qWarning() << "Failed to bind param" << curParam + i << "to query"
                                << anonymizeQuery(query.query);
                     return;
                 }
             }
             curParam += nParams;
-        } while (compileTail != query.query.data() + query.query.size());
+        }
 
         // Execute each statement of each query of our transaction
         for (sqlite3_stmt* stmt : query.statements) {
@@ -788,7 +1248,9 @@ void RawDatabase::compileAndExecute(Transaction& trans)
                 result = sqlite3_step(stmt);
 
                 // Execute our row callback
-                if (result == SQLITE_ROW && query.rowCallback) {
+                if (result == SQLITE_ROW && query.typedRowCallback) {
+                    query.typedRowCallback(Row{stmt});
+                } else if (result == SQLITE_ROW && query.rowCallback) {
                     QVector<QVariant> row;
                     for (int i = 0; i < column_count; ++i)
                         row += extractData(stmt, i);
@@ -818,13 +1280,89 @@ void RawDatabase::compileAndExecute(Transaction& trans)
         }
 
         if (query.insertCallback)
-            query.insertCallback(RowId{sqlite3_last_insert_rowid(sqlite)});
+            query.insertCallback(RowId{sqlite3_last_insert_rowid(db)});
+
+        recordQueryTime(query, queryTimer.nsecsElapsed() / 1000, db);
     }
 
     if (trans.success != nullptr)
         trans.success->store(true, std::memory_order_release);
 }
 
+/**
+ * @brief Accounts one query execution into the per-statement latency stats.
+ *
+ * Queries over the slow threshold are logged immediately with their query
+ * plan, since by the time the aggregate stats are dumped the interesting
+ * schema state may be gone.
+ */
+void RawDatabase::recordQueryTime(const Query& query, int64_t elapsedUs, sqlite3* db)
+{
+    // The transaction wrappers we prepend ourselves only measure fsync noise
+    if (query.query == "BEGIN;" || query.query == "COMMIT;")
+        return;
+
+    const QString anonQuery = anonymizeQuery(query.query);
+
+    {
+        QMutexLocker<QMutex> locker{&queryStatsMutex};
+        QueryStats& stats = queryStats[anonQuery];
+        ++stats.count;
+        stats.totalUs += elapsedUs;
+        stats.maxUs = std::max(stats.maxUs, elapsedUs);
+        size_t bucket = 0;
+        while (bucket < queryTimeBoundsUs.size() && elapsedUs > queryTimeBoundsUs[bucket])
+            ++bucket;
+        ++stats.buckets[bucket];
+    }
+
+    if (elapsedUs >= slowQueryThresholdUs) {
+        qWarning().noquote().nospace()
+            << "Slow query (" << elapsedUs / 1000 << "ms): " << anonQuery << "\nQuery plan:\n"
+            << explainQueryPlan(db, query.query);
+    }
+}
+
+/**
+ * @brief Formats the per-statement latency stats, slowest statements first.
+ *
+ * Safe to call from any thread; dumped to the debug log when the database
+ * closes and available to debug tooling while it is open.
+ */
+QString RawDatabase::queryStatsToString() const
+{
+    QMutexLocker<QMutex> locker{&queryStatsMutex};
+
+    QVector<QPair<QString, QueryStats>> sorted;
+    sorted.reserve(queryStats.size());
+    for (auto it = queryStats.cbegin(); it != queryStats.cend(); ++it)
+        sorted.append({it.key(), it.value()});
+    std::sort(sorted.begin(), sorted.end(),
+              [](const auto& a, const auto& b) { return a.second.totalUs > b.second.totalUs; });
+
+    QString result;
+    for (const auto& [anonQuery, stats] : sorted) {
+        QString histogram;
+        for (size_t i = 0; i < stats.buckets.size(); ++i) {
+            if (!histogram.isEmpty())
+                histogram += QLatin1Char(' ');
+            const QString bound = i < queryTimeBoundsUs.size()
+                                      ? QStringLiteral("<=%1us").arg(queryTimeBoundsUs[i])
+                                      : QStringLiteral(">%1us").arg(queryTimeBoundsUs.back());
+            histogram += QStringLiteral("%1:%2").arg(bound).arg(stats.buckets[i]);
+        }
+        if (!result.isEmpty())
+            result += QLatin1Char('\n');
+        result += QStringLiteral("%1\n  count %2, avg %3us, max %4us\n  %5")
+                      .arg(anonQuery)
+                      .arg(stats.count)
+                      .arg(stats.totalUs / static_cast<int64_t>(stats.count))
+                      .arg(stats.maxUs)
+                      .arg(histogram);
+    }
+    return result;
+}
+
 /**
  * @brief Implements the actual processing of pending transactions.
  * Unqueues, compiles, binds and executes queries, then notifies of results
@@ -833,34 +1371,69 @@ void RawDatabase::compileAndExecute(Transaction& trans)
  */
 void RawDatabase::process()
 {
+    PERF_ZONE(rawdatabase_process);
+
     assert(QThread::currentThread() == workerThread.get());
 
     if (!sqlite)
         return;
 
+    coalesceFlushScheduled.store(false, std::memory_order_release);
+
     forever
     {
-        // Fetch the next transaction
-        Transaction trans;
+        // Fetch the next transaction, draining any run of coalescible
+        // transactions at the head of the queue into a single commit
+        QVector<Transaction> batch;
         {
             QMutexLocker<QMutex> locker{&transactionsMutex};
             if (pendingTransactions.isEmpty())
                 return;
-            trans = pendingTransactions.dequeue();
+            batch += pendingTransactions.dequeue();
+            while (batch.first().coalescible && batch.size() < maxCoalescedTransactions
+                   && !pendingTransactions.isEmpty() && pendingTransactions.head().coalescible) {
+                batch += pendingTransactions.dequeue();
+            }
         }
 
-        compileAndExecute(trans);
+        // Merge the batch into one transaction so SQLite only commits once
+        Transaction merged;
+        std::atomic_bool mergedSuccess{false};
+        if (batch.size() == 1) {
+            merged = std::move(batch.first());
+        } else {
+            for (Transaction& trans : batch)
+                merged.queries += std::move(trans.queries);
+            merged.success = &mergedSuccess;
+        }
 
-        // Free our statements
-        for (Query& query : trans.queries) {
-            for (sqlite3_stmt* stmt : query.statements)
-                sqlite3_finalize(stmt);
+        compileAndExecute(merged, sqlite);
+
+        // Reset our statements and return them to the cache for reuse
+        for (Query& query : merged.queries) {
+            if (query.statements.isEmpty())
+                continue;
+            for (sqlite3_stmt* stmt : query.statements) {
+                sqlite3_reset(stmt);
+                sqlite3_clear_bindings(stmt);
+            }
+            statementCache.insert(query.query, new CachedStatements{std::move(query.statements)});
             query.statements.clear();
         }
 
         // Signal transaction results
-        if (trans.done != nullptr)
-            trans.done->store(true, std::memory_order_release);
+        if (batch.size() == 1) {
+            if (merged.done != nullptr)
+                merged.done->store(true, std::memory_order_release);
+        } else {
+            const bool success = mergedSuccess.load(std::memory_order_acquire);
+            for (const Transaction& trans : batch) {
+                if (trans.success != nullptr)
+                    trans.success->store(success, std::memory_order_release);
+                if (trans.done != nullptr)
+                    trans.done->store(true, std::memory_order_release);
+            }
+        }
     }
 }
 
@@ -931,18 +1504,34 @@ void RawDatabase::regexp(sqlite3_context* ctx, int argc, sqlite3_value** argv,
                          const QRegularExpression::PatternOptions cs)
 {
     std::ignore = argc;
-    QRegularExpression regex;
-    const QString str1 = QString::fromUtf8(reinterpret_cast<const char*>(sqlite3_value_text(argv[0])));
-    const QString str2 = QString::fromUtf8(reinterpret_cast<const char*>(sqlite3_value_text(argv[1])));
-
-    regex.setPattern(str1);
-    regex.setPatternOptions(cs);
-
-    const bool b = str2.contains(regex);
-
-    if (b) {
-        sqlite3_result_int(ctx, 1);
-    } else {
-        sqlite3_result_int(ctx, 0);
+    const QString pattern =
+        QString::fromUtf8(reinterpret_cast<const char*>(sqlite3_value_text(argv[0])));
+    const QString subject =
+        QString::fromUtf8(reinterpret_cast<const char*>(sqlite3_value_text(argv[1])));
+
+    // SQLite calls back here once per candidate row, with the same pattern for
+    // the whole scan. Compiling the pattern anew per row made setup dominate
+    // regex search over large histories; cache the compiled object per thread
+    // instead (the write and read connections run on different threads, so no
+    // locking). The options are part of the key because the sensitive and
+    // insensitive variants share this cache.
+    using PatternKey = QPair<QString, uint>;
+    thread_local QHash<PatternKey, QRegularExpression> patternCache;
+    constexpr qsizetype maxCachedPatterns = 16;
+
+    const PatternKey key{pattern, static_cast<uint>(cs)};
+    auto it = patternCache.constFind(key);
+    if (it == patternCache.constEnd()) {
+        if (patternCache.size() >= maxCachedPatterns) {
+            patternCache.clear();
+        }
+        QRegularExpression regex{pattern, cs};
+        // Compile (and JIT) now rather than lazily on the first row match
+        if (!regex.isValid()) {
+            qWarning() << "Invalid search pattern" << pattern << ":" << regex.errorString();
+        }
+        it = patternCache.insert(key, regex);
     }
+
+    sqlite3_result_int(ctx, subject.contains(*it) ? 1 : 0);
 }
@@ -8,19 +8,24 @@
 #include "util/strongtype.h"
 
 #include <QByteArray>
+#include <QCache>
+#include <QHash>
 #include <QMutex>
 #include <QPair>
 #include <QQueue>
 #include <QRegularExpression>
 #include <QString>
+#include <QStringList>
 #include <QThread>
 #include <QVariant>
 #include <QVector>
 
+#include <array>
 #include <atomic>
 #include <cassert>
 #include <functional>
 #include <memory>
+#include <utility>
 
 /// The two following defines are required to use SQLCipher
 /// They are used by the sqlite3.h header
@@ -40,13 +45,93 @@ class RawDatabase : QObject
     Q_OBJECT
 
 public:
+    /**
+     * @brief Typed view of one result row, only valid inside the row callback.
+     *
+     * Decodes columns straight out of the sqlite statement into the requested
+     * type, so bulk reads skip the QVariant boxing of the generic row callback
+     * and only pay for the columns they actually touch.
+     */
+    class Row
+    {
+    public:
+        bool isNull(int col) const
+        {
+            return sqlite3_column_type(stmt, col) == SQLITE_NULL;
+        }
+        int64_t int64Value(int col) const
+        {
+            return sqlite3_column_int64(stmt, col);
+        }
+        QString stringValue(int col) const
+        {
+            const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+            return QString::fromUtf8(text, sqlite3_column_bytes(stmt, col));
+        }
+        QByteArray byteArrayValue(int col) const
+        {
+            const auto* data = static_cast<const char*>(sqlite3_column_blob(stmt, col));
+            return QByteArray(data, sqlite3_column_bytes(stmt, col));
+        }
+
+    private:
+        explicit Row(sqlite3_stmt* stmt_)
+            : stmt{stmt_}
+        {
+        }
+
+        sqlite3_stmt* stmt;
+
+        friend class RawDatabase;
+    };
+
+    /**
+     * @brief One bound parameter: a blob/text buffer or a 64-bit integer.
+     *
+     * Implicitly constructed from QByteArray or an integer, so bind lists
+     * read like the VALUES they fill in. Integer binds exist so hot paths
+     * can keep their query text canonical (no values formatted into the
+     * SQL), which is what lets the statement cache hit on every execution.
+     */
+    class BindValue
+    {
+    public:
+        BindValue(QByteArray blob_)
+            : blob{std::move(blob_)}
+        {
+        }
+        BindValue(qint64 integer_)
+            : integer{integer_}
+            , isInteger{true}
+        {
+        }
+
+    private:
+        QByteArray blob;
+        qint64 integer = 0;
+        bool isInteger = false;
+
+        friend class RawDatabase;
+    };
+
+    /**
+     * @brief One SQL statement with its bound parameters and result callbacks.
+     *
+     * Blob handling is zero-copy end to end: QByteArray's implicit sharing
+     * means passing a blob in here only bumps a reference count, and binding
+     * uses SQLITE_STATIC against the buffer this Query holds, so even
+     * multi-megabyte blobs are never duplicated. The Query (queued inside a
+     * Transaction) keeps the buffers alive until execution finishes; callers
+     * must not detach a shared blob's buffer out from under a queued query by
+     * writing through their copy.
+     */
     class Query
     {
     public:
-        Query(QString query_, QVector<QByteArray> blobs_ = {},
+        Query(QString query_, QVector<BindValue> params_ = {},
               const std::function<void(RowId)>& insertCallback_ = {})
             : query{query_.toUtf8()}
-            , blobs{blobs_}
+            , params{std::move(params_)}
             , insertCallback{insertCallback_}
         {
         }
@@ -60,20 +145,33 @@ public:
             , rowCallback{rowCallback_}
         {
         }
-        Query(QString query_, QVector<QByteArray> blobs_,
+        Query(QString query_, QVector<BindValue> params_,
               const std::function<void(const QVector<QVariant>&)>& rowCallback_)
             : query{query_.toUtf8()}
-            , blobs{blobs_}
+            , params{std::move(params_)}
             , rowCallback{rowCallback_}
         {
         }
+        Query(QString query_, const std::function<void(const Row&)>& typedRowCallback_)
+            : query{query_.toUtf8()}
+            , typedRowCallback{typedRowCallback_}
+        {
+        }
+        Query(QString query_, QVector<BindValue> params_,
+              const std::function<void(const Row&)>& typedRowCallback_)
+            : query{query_.toUtf8()}
+            , params{std::move(params_)}
+            , typedRowCallback{typedRowCallback_}
+        {
+        }
         Query() = default;
 
     private:
         QByteArray query;
-        QVector<QByteArray> blobs;
+        QVector<BindValue> params;
         std::function<void(RowId)> insertCallback;
         std::function<void(const QVector<QVariant>&)> rowCallback;
+        std::function<void(const Row&)> typedRowCallback;
         QVector<sqlite3_stmt*> statements;
 
         friend class RawDatabase;
@@ -83,13 +181,50 @@ private:
     static void regexp(sqlite3_context* ctx, int argc, sqlite3_value** argv,
                        const QRegularExpression::PatternOptions cs);
 
+    /**
+     * @brief Owns compiled statements of one query while they sit in the cache.
+     *
+     * Finalizes the statements on eviction, so the cache can be bounded without
+     * leaking sqlite resources.
+     */
+    struct CachedStatements
+    {
+        explicit CachedStatements(QVector<sqlite3_stmt*> statements_)
+            : statements{std::move(statements_)}
+        {
+        }
+        ~CachedStatements()
+        {
+            for (sqlite3_stmt* stmt : statements)
+                sqlite3_finalize(stmt);
+        }
+        QVector<sqlite3_stmt*> statements;
+    };
+
     struct Transaction
     {
         QVector<Query> queries;
+        bool coalescible = false;
         std::atomic_bool* success = nullptr;
         std::atomic_bool* done = nullptr;
     };
 
+    // Histogram bucket upper bounds for per-statement query latency, in
+    // microseconds; a final bucket catches everything above the last bound
+    static constexpr std::array<int64_t, 7> queryTimeBoundsUs = {250,   1000,   5000,  10000,
+                                                                 50000, 100000, 500000};
+
+    /**
+     * @brief Latency accounting for one statement text across all executions.
+     */
+    struct QueryStats
+    {
+        uint64_t count = 0;
+        int64_t totalUs = 0;
+        int64_t maxUs = 0;
+        std::array<uint64_t, queryTimeBoundsUs.size() + 1> buckets{};
+    };
+
 public:
     enum class SqlCipherParams
     {
@@ -111,12 +246,30 @@ public:
     bool execNow(const Query& statement);
     bool execNow(const QVector<Query>& statements);
 
+    bool execNowReadOnly(const QString& statement);
+    bool execNowReadOnly(const Query& statement);
+    bool execNowReadOnly(const QVector<Query>& statements);
+
     void execLater(const QString& statement);
     void execLater(const Query& statement);
     void execLater(const QVector<Query>& statements);
 
+    void execLaterCoalesced(const QString& statement);
+    void execLaterCoalesced(const Query& statement);
+    void execLaterCoalesced(const QVector<Query>& statements);
+
     void sync();
 
+    void runMaintenance(const std::function<void(int)>& progressCallback,
+                        const std::function<void(bool)>& doneCallback);
+
+    QStringList checkIntegrity();
+
+    QString queryStatsToString() const;
+
+    static quint64 sqliteMemoryUsed();
+    void releaseMemory();
+
     static QString toString(SqlCipherParams params)
     {
         switch (params) {
@@ -142,11 +295,20 @@ protected slots:
     void process();
 
 private:
-    void compileAndExecute(Transaction& trans);
+    void enqueueLater(const QVector<Query>& statements, bool coalescible);
+    void scheduleMaintenanceSlice();
+    void scheduleMaintenanceAnalyze();
+    void finishMaintenance(bool success);
+    void compileAndExecute(Transaction& trans, sqlite3* db);
+    void recordQueryTime(const Query& query, int64_t elapsedUs, sqlite3* db);
+    bool execDirect(sqlite3* db, const QVector<Query>& statements);
+    bool openReadConnection();
+    void closeReadConnection();
     QString anonymizeQuery(const QByteArray& query);
     bool openEncryptedDatabaseAtLatestSupportedVersion(const QString& hexKey);
     bool updateSavedCipherParameters(const QString& hexKey, SqlCipherParams newParams);
     bool setCipherParameters(SqlCipherParams params, const QString& database = {});
+    static QString cipherParamsQuery(SqlCipherParams params, const QString& database = {});
     SqlCipherParams highestSupportedParams();
     SqlCipherParams readSavedCipherParams(const QString& hexKey, SqlCipherParams newParams);
     bool setKey(const QString& hexKey);
@@ -168,6 +330,30 @@ private:
     std::unique_ptr<QThread> workerThread;
     QQueue<Transaction> pendingTransactions;
     QMutex transactionsMutex;
+    std::atomic_bool coalesceFlushScheduled{false};
+    // LRU cache of compiled statements keyed by the exact SQL byte string, so
+    // hot insert/select paths skip sqlite3_prepare_v2. Only touched by the
+    // worker thread, flushed on close().
+    QCache<QByteArray, CachedStatements> statementCache{64};
+    // Per-statement latency stats keyed by the anonymized query text. Written
+    // by whichever thread executed the query (worker or read lane) and read by
+    // the stats dump, hence the mutex.
+    QHash<QString, QueryStats> queryStats;
+    mutable QMutex queryStatsMutex;
+    // Read-only connection serving execNowReadOnly on the calling thread, so
+    // heavy reads don't queue behind writes. Lazily opened, requires WAL.
+    sqlite3* readSqlite = nullptr;
+    QMutex readLaneMutex;
+    std::atomic_bool walEnabled{false};
+    // Params the main connection was successfully opened with, replayed when
+    // opening the read connection
+    SqlCipherParams currentCipherParams = SqlCipherParams::p4_0;
+    // Maintenance state; the guard flag is shared, the rest is only touched
+    // while a single maintenance run owns it
+    std::atomic_bool maintenanceActive{false};
+    std::function<void(int)> maintenanceProgressCallback;
+    std::function<void(bool)> maintenanceDoneCallback;
+    int64_t maintenanceFreelistBaseline = 0;
     QString path;
     QByteArray currentSalt;
     QString currentHexKey;
@@ -14,8 +14,80 @@
 #include <QString>
 #include <QTranslator>
 
+#include <algorithm>
+
 namespace {
-constexpr int SCHEMA_VERSION = 11;
+constexpr int SCHEMA_VERSION = 14;
+
+void addTextMessagesFtsIndex(QVector<RawDatabase::Query>& queries)
+{
+    // External-content FTS5 index over text message content so phrase search
+    // doesn't have to full-scan the message table. Kept in sync with
+    // text_messages by triggers so deletion paths (eraseHistory,
+    // removeChatHistory) can't desync it.
+    queries += RawDatabase::Query(
+        QStringLiteral("CREATE VIRTUAL TABLE text_messages_fts USING fts5(message, "
+                       "content='text_messages', content_rowid='id');"));
+    queries += RawDatabase::Query(
+        QStringLiteral("CREATE TRIGGER text_messages_fts_insert AFTER INSERT ON text_messages "
+                       "BEGIN "
+                       "INSERT INTO text_messages_fts(rowid, message) "
+                       "VALUES (new.id, new.message); "
+                       "END;"));
+    queries += RawDatabase::Query(
+        QStringLiteral("CREATE TRIGGER text_messages_fts_delete AFTER DELETE ON text_messages "
+                       "BEGIN "
+                       "INSERT INTO text_messages_fts(text_messages_fts, rowid, message) "
+                       "VALUES ('delete', old.id, old.message); "
+                       "END;"));
+    queries += RawDatabase::Query(
+        QStringLiteral("CREATE TRIGGER text_messages_fts_update AFTER UPDATE ON text_messages "
+                       "BEGIN "
+                       "INSERT INTO text_messages_fts(text_messages_fts, rowid, message) "
+                       "VALUES ('delete', old.id, old.message); "
+                       "INSERT INTO text_messages_fts(rowid, message) "
+                       "VALUES (new.id, new.message); "
+                       "END;"));
+}
+
+void addChatDayIndex(QVector<RawDatabase::Query>& queries)
+{
+    // Day-boundary index so date navigation (calendar jump, history load
+    // dialog) resolves by lookup instead of counting every message per day.
+    // message_offset is the number of messages in the chat before the first
+    // one of that day, i.e. the per-chat index ChatHistory maps to ChatLogIdx.
+    // An insert trigger keeps it current; chat deletion only ever removes
+    // whole chats, so cascading on the anchor message is enough to clean up.
+    queries += RawDatabase::Query(
+        QStringLiteral("CREATE TABLE chat_day_index (chat_id INTEGER NOT NULL, "
+                       "day INTEGER NOT NULL, "
+                       "first_id INTEGER NOT NULL, "
+                       "message_offset INTEGER NOT NULL, "
+                       "PRIMARY KEY (chat_id, day), "
+                       "FOREIGN KEY (chat_id) REFERENCES chats(id), "
+                       "FOREIGN KEY (first_id) REFERENCES history(id) ON DELETE CASCADE);"));
+    queries += RawDatabase::Query(
+        QStringLiteral("CREATE TRIGGER chat_day_index_insert AFTER INSERT ON history "
+                       "WHEN NOT EXISTS (SELECT 1 FROM chat_day_index "
+                       "WHERE chat_id = new.chat_id "
+                       "AND day = new.timestamp / 1000 / 60 / 60 / 24) "
+                       "BEGIN "
+                       "INSERT INTO chat_day_index (chat_id, day, first_id, message_offset) "
+                       "VALUES (new.chat_id, new.timestamp / 1000 / 60 / 60 / 24, new.id, "
+                       "(SELECT COUNT(*) FROM history "
+                       "WHERE chat_id = new.chat_id AND id < new.id)); "
+                       "END;"));
+}
+
+void addChatDraftsTable(QVector<RawDatabase::Query>& queries)
+{
+    // Unsent input text per chat, written behind a debounce from the chat
+    // form so a crash loses at most the last moment of typing
+    queries += RawDatabase::Query(
+        QStringLiteral("CREATE TABLE chat_drafts (chat_id INTEGER PRIMARY KEY, "
+                       "text BLOB NOT NULL, "
+                       "FOREIGN KEY (chat_id) REFERENCES chats(id));"));
+}
 
 std::vector<DbUpgrader::BadEntry> getInvalidPeers(RawDatabase& db)
 {
@@ -190,7 +262,8 @@ void addForeignKeyToBrokenMessages(QVector<RawDatabase::Query>& queries)
  * @note On future alterations of the database all you have to do is bump the SCHEMA_VERSION
  * variable and add another case to the switch statement below. Make sure to fall through on each case.
  */
-bool DbUpgrader::dbSchemaUpgrade(std::shared_ptr<RawDatabase>& db, IMessageBoxManager& messageBoxManager)
+bool DbUpgrader::dbSchemaUpgrade(std::shared_ptr<RawDatabase>& db, IMessageBoxManager& messageBoxManager,
+                                 const ProgressCallback& progressCallback)
 {
     // If we're a new dB we can just make a new one and call it a day
     bool success = false;
@@ -236,21 +309,45 @@ bool DbUpgrader::dbSchemaUpgrade(std::shared_ptr<RawDatabase>& db, IMessageBoxMa
         return true;
     }
 
-    using DbSchemaUpgradeFn = bool (*)(RawDatabase&);
-    std::vector<DbSchemaUpgradeFn> upgradeFns = {dbSchema0to1,  dbSchema1to2,          dbSchema2to3,
-                                                 dbSchema3to4,  dbSchema4to5,          dbSchema5to6,
-                                                 dbSchema6to7,  dbSchema7to8,          dbSchema8to9,
-                                                 dbSchema9to10, DbTo11::dbSchema10to11};
+    // Dry-run estimate so the log (and any progress consumer) can tell a
+    // seconds-long bump from a multi-GB rewrite before any work starts
+    const int64_t estimatedRows = estimateUpgradeRows(*db);
+    qInfo() << "Upgrading database from schema version" << databaseSchemaVersion << "to"
+            << SCHEMA_VERSION << "- roughly" << estimatedRows << "history rows to process";
+
+    // Upgrades run as one function per schema step; the chunked ones addition-
+    // ally report their progress within the step
+    using DbSchemaUpgradeFn = std::function<bool(RawDatabase&, const std::function<void(int)>&)>;
+    const auto plain = [](bool (*fn)(RawDatabase&)) {
+        return [fn](RawDatabase& database, const std::function<void(int)>&) { return fn(database); };
+    };
+    std::vector<DbSchemaUpgradeFn> upgradeFns = {plain(dbSchema0to1),  plain(dbSchema1to2),
+                                                 plain(dbSchema2to3),  plain(dbSchema3to4),
+                                                 plain(dbSchema4to5),  plain(dbSchema5to6),
+                                                 dbSchema6to7,         plain(dbSchema7to8),
+                                                 plain(dbSchema8to9),  plain(dbSchema9to10),
+                                                 plain(DbTo11::dbSchema10to11),
+                                                 plain(dbSchema11to12), plain(dbSchema12to13),
+                                                 plain(dbSchema13to14)};
 
     assert(databaseSchemaVersion < static_cast<int>(upgradeFns.size()));
     assert(upgradeFns.size() == SCHEMA_VERSION);
 
+    const int totalSteps = static_cast<int>(upgradeFns.size() - databaseSchemaVersion);
     for (int64_t i = databaseSchemaVersion; i < static_cast<int>(upgradeFns.size()); ++i) {
         const auto newDbVersion = i + 1;
-        if (!upgradeFns[i](*db)) {
+        const int step = static_cast<int>(i - databaseSchemaVersion) + 1;
+        const auto stepProgress = [&](int percent) {
+            if (progressCallback) {
+                progressCallback(step, totalSteps, percent);
+            }
+        };
+        stepProgress(0);
+        if (!upgradeFns[i](*db, stepProgress)) {
             qCritical() << "Failed to upgrade db to schema version" << newDbVersion << " aborting";
             return false;
         }
+        stepProgress(100);
         qDebug() << "Database upgraded incrementally to schema version" << newDbVersion;
     }
 
@@ -259,6 +356,25 @@ bool DbUpgrader::dbSchemaUpgrade(std::shared_ptr<RawDatabase>& db, IMessageBoxMa
     return true;
 }
 
+/**
+ * @brief Estimates how many history rows the pending upgrades will rewrite.
+ *
+ * The history table exists under that name in every schema version and its row
+ * count tracks the bulk of any rewrite pass, so one count serves as a cheap
+ * dry-run estimate.
+ */
+int64_t DbUpgrader::estimateUpgradeRows(RawDatabase& db)
+{
+    int64_t rows = 0;
+    if (!db.execNow(RawDatabase::Query("SELECT COUNT(*) FROM history;",
+                                       [&](const QVector<QVariant>& row) {
+                                           rows = row[0].toLongLong();
+                                       }))) {
+        qWarning() << "Failed to estimate upgrade size";
+    }
+    return rows;
+}
+
 bool DbUpgrader::createCurrentSchema(RawDatabase& db)
 {
     QVector<RawDatabase::Query> queries;
@@ -324,6 +440,9 @@ bool DbUpgrader::createCurrentSchema(RawDatabase& db)
         "FOREIGN KEY (id) REFERENCES history(id));"));
     // sqlite doesn't support including the index as part of the CREATE TABLE statement, so add a second query
     queries += RawDatabase::Query("CREATE INDEX chat_id_idx on history (chat_id);");
+    addTextMessagesFtsIndex(queries);
+    addChatDayIndex(queries);
+    addChatDraftsTable(queries);
     queries += RawDatabase::Query(QStringLiteral("PRAGMA user_version = %1;").arg(SCHEMA_VERSION));
     return db.execNow(queries);
 }
@@ -478,53 +597,99 @@ bool DbUpgrader::dbSchema5to6(RawDatabase& db)
     return db.execNow(upgradeQueries);
 }
 
-bool DbUpgrader::dbSchema6to7(RawDatabase& db)
+bool DbUpgrader::dbSchema6to7(RawDatabase& db, const std::function<void(int)>& chunkProgress)
 {
-    QVector<RawDatabase::Query> upgradeQueries;
+    // This is the heaviest upgrade we have: it rewrites the entire history
+    // table. It used to run as one transaction, which locked the app for the
+    // whole rewrite and built multi-GB journals. The copies now run in id-range
+    // chunks, each its own transaction, so memory stays bounded. Everything is
+    // idempotent (IF NOT EXISTS / INSERT OR IGNORE) and user_version is only
+    // bumped in the final transaction, so an interrupted upgrade resumes where
+    // it left off on the next start.
+    QVector<RawDatabase::Query> ddlQueries;
 
     // Cannot add UNIQUE(id, message_type) to history table without creating a new one. Create a new history table
-    upgradeQueries += RawDatabase::Query(
-        "CREATE TABLE history_new (id INTEGER PRIMARY KEY, message_type CHAR(1) NOT NULL DEFAULT "
+    ddlQueries += RawDatabase::Query(
+        "CREATE TABLE IF NOT EXISTS history_new (id INTEGER PRIMARY KEY, message_type CHAR(1) NOT "
+        "NULL DEFAULT "
         "'T' CHECK (message_type in ('T','F','S')), timestamp INTEGER NOT NULL, chat_id INTEGER "
         "NOT NULL, UNIQUE (id, message_type), FOREIGN KEY (chat_id) REFERENCES peers(id))");
 
     // Create new text_messages table. We will split messages out of history and insert them into this new table
-    upgradeQueries += RawDatabase::Query(
-        "CREATE TABLE text_messages (id INTEGER PRIMARY KEY, message_type CHAR(1) NOT NULL CHECK "
+    ddlQueries += RawDatabase::Query(
+        "CREATE TABLE IF NOT EXISTS text_messages (id INTEGER PRIMARY KEY, message_type CHAR(1) "
+        "NOT NULL CHECK "
         "(message_type = 'T'), sender_alias INTEGER NOT NULL, message BLOB NOT NULL, FOREIGN KEY "
         "(id, message_type) REFERENCES history_new(id, message_type), FOREIGN KEY (sender_alias) "
         "REFERENCES aliases(id))");
 
     // Cannot add a FOREIGN KEY to the file_transfers table without creating a new one. Create a new file_transfers table
-    upgradeQueries += RawDatabase::Query(
-        "CREATE TABLE file_transfers_new (id INTEGER PRIMARY KEY, message_type CHAR(1) NOT NULL "
+    ddlQueries += RawDatabase::Query(
+        "CREATE TABLE IF NOT EXISTS file_transfers_new (id INTEGER PRIMARY KEY, message_type "
+        "CHAR(1) NOT NULL "
         "CHECK (message_type = 'F'), sender_alias INTEGER NOT NULL, file_restart_id BLOB NOT NULL, "
         "file_name BLOB NOT NULL, file_path BLOB NOT NULL, file_hash BLOB NOT NULL, file_size "
         "INTEGER NOT NULL, direction INTEGER NOT NULL, file_state INTEGER NOT NULL, FOREIGN KEY "
         "(id, message_type) REFERENCES history_new(id, message_type), FOREIGN KEY (sender_alias) "
         "REFERENCES aliases(id))");
 
-    upgradeQueries +=
-        RawDatabase::Query("INSERT INTO history_new SELECT id, 'T' AS message_type, timestamp, "
-                           "chat_id FROM history WHERE history.file_id IS NULL");
+    if (!db.execNow(ddlQueries)) {
+        return false;
+    }
 
-    upgradeQueries +=
-        RawDatabase::Query("INSERT INTO text_messages SELECT id, 'T' AS message_type, "
-                           "sender_alias, message FROM history WHERE history.file_id IS NULL");
+    int64_t maxId = 0;
+    if (!db.execNow(RawDatabase::Query("SELECT COALESCE(MAX(id), 0) FROM history;",
+                                       [&](const QVector<QVariant>& row) {
+                                           maxId = row[0].toLongLong();
+                                       }))) {
+        return false;
+    }
 
-    upgradeQueries +=
-        RawDatabase::Query("INSERT INTO history_new SELECT id, 'F' AS message_type, timestamp, "
-                           "chat_id FROM history WHERE history.file_id IS NOT NULL");
+    // Ids per copy transaction; bounds both journal size and lock hold time
+    constexpr int64_t chunkRows = 50000;
+    for (int64_t lo = 0; lo <= maxId; lo += chunkRows) {
+        const int64_t hi = lo + chunkRows;
+        const QString range = QStringLiteral(" AND history.id >= %1 AND history.id < %2").arg(lo).arg(hi);
+
+        QVector<RawDatabase::Query> chunkQueries;
+        chunkQueries += RawDatabase::Query(
+            "INSERT OR IGNORE INTO history_new SELECT id, 'T' AS message_type, timestamp, "
+            "chat_id FROM history WHERE history.file_id IS NULL"
+            + range);
+
+        chunkQueries += RawDatabase::Query(
+            "INSERT OR IGNORE INTO text_messages SELECT id, 'T' AS message_type, "
+            "sender_alias, message FROM history WHERE history.file_id IS NULL"
+            + range);
+
+        chunkQueries += RawDatabase::Query(
+            "INSERT OR IGNORE INTO history_new SELECT id, 'F' AS message_type, timestamp, "
+            "chat_id FROM history WHERE history.file_id IS NOT NULL"
+            + range);
+
+        chunkQueries += RawDatabase::Query(
+            "INSERT OR IGNORE INTO file_transfers_new (id, message_type, sender_alias, "
+            "file_restart_id, "
+            "file_name, file_path, file_hash, file_size, direction, file_state) SELECT history.id, 'F' "
+            "as message_type, history.sender_alias, file_transfers.file_restart_id, "
+            "file_transfers.file_name, file_transfers.file_path, file_transfers.file_hash, "
+            "file_transfers.file_size, file_transfers.direction, file_transfers.file_state FROM "
+            "history INNER JOIN file_transfers on history.file_id = file_transfers.id WHERE "
+            "history.file_id IS NOT NULL"
+            + range);
+
+        if (!db.execNow(chunkQueries)) {
+            return false;
+        }
 
-    upgradeQueries += RawDatabase::Query(
-        "INSERT INTO file_transfers_new (id, message_type, sender_alias, file_restart_id, "
-        "file_name, file_path, file_hash, file_size, direction, file_state) SELECT history.id, 'F' "
-        "as message_type, history.sender_alias, file_transfers.file_restart_id, "
-        "file_transfers.file_name, file_transfers.file_path, file_transfers.file_hash, "
-        "file_transfers.file_size, file_transfers.direction, file_transfers.file_state FROM "
-        "history INNER JOIN file_transfers on history.file_id = file_transfers.id WHERE "
-        "history.file_id IS NOT NULL");
+        if (chunkProgress) {
+            chunkProgress(static_cast<int>(100 * std::min(hi, maxId + 1) / (maxId + 1)));
+        }
+    }
 
+    // The small bookkeeping tables and the destructive table swap happen
+    // atomically with the version bump
+    QVector<RawDatabase::Query> upgradeQueries;
     upgradeQueries += RawDatabase::Query(
         "CREATE TABLE system_messages (id INTEGER PRIMARY KEY, message_type CHAR(1) NOT NULL CHECK "
         "(message_type = 'S'), system_message_type INTEGER NOT NULL, arg1 BLOB, arg2 BLOB, arg3 "
@@ -607,6 +772,45 @@ bool DbUpgrader::dbSchema9to10(RawDatabase& db)
     return db.execNow(upgradeQueries);
 }
 
+bool DbUpgrader::dbSchema11to12(RawDatabase& db)
+{
+    QVector<RawDatabase::Query> upgradeQueries;
+    addTextMessagesFtsIndex(upgradeQueries);
+    // Index the pre-existing message history
+    upgradeQueries += RawDatabase::Query(
+        QStringLiteral("INSERT INTO text_messages_fts(text_messages_fts) VALUES ('rebuild');"));
+    upgradeQueries += RawDatabase::Query(QStringLiteral("PRAGMA user_version = 12;"));
+    return db.execNow(upgradeQueries);
+}
+
+bool DbUpgrader::dbSchema12to13(RawDatabase& db)
+{
+    QVector<RawDatabase::Query> upgradeQueries;
+    addChatDayIndex(upgradeQueries);
+    // Index the pre-existing history. The correlated count runs once per
+    // (chat, day) pair during this upgrade only; afterwards the insert
+    // trigger pays it once per new day.
+    upgradeQueries += RawDatabase::Query(
+        QStringLiteral("INSERT INTO chat_day_index (chat_id, day, first_id, message_offset) "
+                       "SELECT chat_id, timestamp / 1000 / 60 / 60 / 24 AS day, MIN(id), 0 "
+                       "FROM history GROUP BY chat_id, day;"));
+    upgradeQueries += RawDatabase::Query(
+        QStringLiteral("UPDATE chat_day_index SET message_offset = "
+                       "(SELECT COUNT(*) FROM history "
+                       "WHERE history.chat_id = chat_day_index.chat_id "
+                       "AND history.id < chat_day_index.first_id);"));
+    upgradeQueries += RawDatabase::Query(QStringLiteral("PRAGMA user_version = 13;"));
+    return db.execNow(upgradeQueries);
+}
+
+bool DbUpgrader::dbSchema13to14(RawDatabase& db)
+{
+    QVector<RawDatabase::Query> upgradeQueries;
+    addChatDraftsTable(upgradeQueries);
+    upgradeQueries += RawDatabase::Query(QStringLiteral("PRAGMA user_version = 14;"));
+    return db.execNow(upgradeQueries);
+}
+
 void DbUpgrader::mergeDuplicatePeers(QVector<RawDatabase::Query>& upgradeQueries, RawDatabase& db,
                                      std::vector<BadEntry> badPeers)
 {
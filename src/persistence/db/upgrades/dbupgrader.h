@@ -12,7 +12,15 @@
 class RawDatabase;
 class IMessageBoxManager;
 namespace DbUpgrader {
-bool dbSchemaUpgrade(std::shared_ptr<RawDatabase>& db, IMessageBoxManager& messageBoxManager);
+// Reports upgrade progress: the schema step being applied, how many steps the
+// upgrade spans, and the percentage done within the current step.
+using ProgressCallback = std::function<void(int step, int totalSteps, int percent)>;
+
+bool dbSchemaUpgrade(std::shared_ptr<RawDatabase>& db, IMessageBoxManager& messageBoxManager,
+                     const ProgressCallback& progressCallback = {});
+
+// Dry-run estimate of how many history rows the pending upgrades will rewrite
+int64_t estimateUpgradeRows(RawDatabase& db);
 
 bool createCurrentSchema(RawDatabase& db);
 bool isNewDb(std::shared_ptr<RawDatabase>& db, bool& success);
@@ -22,11 +30,14 @@ bool dbSchema2to3(RawDatabase& db);
 bool dbSchema3to4(RawDatabase& db);
 bool dbSchema4to5(RawDatabase& db);
 bool dbSchema5to6(RawDatabase& db);
-bool dbSchema6to7(RawDatabase& db);
+bool dbSchema6to7(RawDatabase& db, const std::function<void(int)>& chunkProgress = {});
 bool dbSchema7to8(RawDatabase& db);
 bool dbSchema8to9(RawDatabase& db);
 bool dbSchema9to10(RawDatabase& db);
 // 10to11 from DbTo11::dbSchema10to11
+bool dbSchema11to12(RawDatabase& db);
+bool dbSchema12to13(RawDatabase& db);
+bool dbSchema13to14(RawDatabase& db);
 
 struct BadEntry
 {
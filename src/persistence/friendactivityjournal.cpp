@@ -0,0 +1,203 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "friendactivityjournal.h"
+
+#include "src/core/toxencrypt.h"
+
+#include <QDebug>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <cstring>
+
+namespace {
+// Little endian ASCII "QTAJ" magic, then a version byte and a flags byte
+// (bit 0: records are encrypted)
+const char magic[] = {0x51, 0x54, 0x41, 0x4A};
+constexpr char versionByte = 1;
+constexpr int headerSize = 6;
+
+// A plain record is the 32 byte public key followed by the activity time as
+// big endian milliseconds since the epoch
+constexpr int plainRecordSize = ToxPk::size + static_cast<int>(sizeof(qint64));
+
+// Compact once the journal holds both a meaningful number of records and
+// several generations of updates per friend
+constexpr int compactMinRecords = 64;
+constexpr int compactFactor = 4;
+} // namespace
+
+FriendActivityJournal::FriendActivityJournal(QString filePath_, const ToxEncrypt* passKey_)
+    : filePath{filePath_}
+    , passKey{passKey_}
+{
+}
+
+/**
+ * @brief Replays the journal into a last-wins map of activity per friend.
+ *
+ * Unrecognized or mismatched journals are discarded; a truncated tail (e.g.
+ * after a crash mid-append) drops only the partial record. Compacts the
+ * journal when it has grown well past one record per friend.
+ */
+QHash<QByteArray, QDateTime> FriendActivityJournal::load()
+{
+    QHash<QByteArray, QDateTime> entries;
+    recordCount = 0;
+
+    QFile in{filePath};
+    if (!in.exists()) {
+        return entries;
+    }
+
+    if (!in.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open activity journal" << filePath;
+        return entries;
+    }
+
+    const QByteArray data = in.readAll();
+    in.close();
+
+    if (data.size() < headerSize || memcmp(data.constData(), magic, sizeof(magic)) != 0
+        || data[4] != versionByte) {
+        qWarning() << "Discarding unrecognized activity journal" << filePath;
+        rewrite(entries);
+        return entries;
+    }
+
+    const bool wasEncrypted = (data[5] & 1) != 0;
+    if (wasEncrypted != (passKey != nullptr)) {
+        // The profile password was added or removed since the journal was
+        // written; the settings snapshot still has the last state saved there
+        qDebug() << "Activity journal encryption no longer matches the profile, discarding";
+        rewrite(entries);
+        return entries;
+    }
+
+    qsizetype pos = headerSize;
+    while (pos + 2 <= data.size()) {
+        const int len =
+            (static_cast<quint8>(data[pos]) << 8) | static_cast<quint8>(data[pos + 1]);
+        pos += 2;
+        if (len <= 0 || pos + len > data.size()) {
+            qWarning() << "Truncated record in activity journal, ignoring the tail";
+            break;
+        }
+
+        QByteArray payload = data.mid(pos, len);
+        pos += len;
+        ++recordCount;
+
+        if (passKey != nullptr) {
+            payload = passKey->decrypt(payload);
+            if (payload.isEmpty()) {
+                continue;
+            }
+        }
+
+        if (payload.size() != plainRecordSize) {
+            continue;
+        }
+
+        const QByteArray pkBytes = payload.left(ToxPk::size);
+        const qint64 msecs = qFromBigEndian<qint64>(payload.constData() + ToxPk::size);
+        entries.insert(pkBytes, QDateTime::fromMSecsSinceEpoch(msecs));
+    }
+
+    if (recordCount > compactMinRecords
+        && recordCount > entries.size() * static_cast<qsizetype>(compactFactor)) {
+        rewrite(entries);
+    }
+
+    return entries;
+}
+
+/**
+ * @brief Appends one activity record and flushes it to disk.
+ */
+void FriendActivityJournal::append(const ToxPk& pk, const QDateTime& activity)
+{
+    if (!ensureOpen()) {
+        return;
+    }
+
+    file.write(frameRecord(pk.getByteArray(), activity));
+    file.flush();
+    ++recordCount;
+}
+
+bool FriendActivityJournal::ensureOpen()
+{
+    if (file.isOpen()) {
+        return true;
+    }
+
+    file.setFileName(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "Failed to open activity journal for writing" << filePath;
+        return false;
+    }
+
+    if (file.size() == 0) {
+        file.write(headerBytes());
+    }
+
+    return true;
+}
+
+/**
+ * @brief Replaces the journal with one record per entry, atomically.
+ */
+void FriendActivityJournal::rewrite(const QHash<QByteArray, QDateTime>& entries)
+{
+    file.close();
+
+    QSaveFile out{filePath};
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to compact activity journal" << filePath;
+        return;
+    }
+
+    out.write(headerBytes());
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it) {
+        out.write(frameRecord(it.key(), it.value()));
+    }
+
+    if (out.commit()) {
+        recordCount = entries.size();
+    } else {
+        qWarning() << "Failed to write compacted activity journal" << filePath;
+    }
+}
+
+QByteArray FriendActivityJournal::headerBytes() const
+{
+    QByteArray header{magic, sizeof(magic)};
+    header += versionByte;
+    header += static_cast<char>(passKey != nullptr ? 1 : 0);
+    return header;
+}
+
+/**
+ * @brief Packs, optionally encrypts and length-prefixes one record.
+ */
+QByteArray FriendActivityJournal::frameRecord(const QByteArray& pkBytes,
+                                              const QDateTime& activity) const
+{
+    QByteArray payload = pkBytes;
+    char msecsBuf[sizeof(qint64)];
+    qToBigEndian<qint64>(activity.toMSecsSinceEpoch(), msecsBuf);
+    payload.append(msecsBuf, sizeof(msecsBuf));
+
+    if (passKey != nullptr) {
+        payload = passKey->encrypt(payload);
+    }
+
+    QByteArray framed;
+    framed += static_cast<char>((payload.size() >> 8) & 0xff);
+    framed += static_cast<char>(payload.size() & 0xff);
+    framed += payload;
+    return framed;
+}
@@ -0,0 +1,51 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include "src/core/toxpk.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QString>
+
+class ToxEncrypt;
+
+/**
+ * @brief Append-only store for friend activity timestamps.
+ *
+ * Activity updates happen for every sent and received message; persisting
+ * them through the settings machinery means rewriting the whole personal
+ * settings file for one changed timestamp. This journal instead appends one
+ * small record per update and is replayed last-wins over the settings
+ * snapshot on profile load, so frequent updates stay durable without a
+ * single settings rewrite.
+ *
+ * Records are encrypted with the profile passkey when one is set, mirroring
+ * the settings file. A journal whose encryption no longer matches the
+ * profile (password added or removed) is discarded on load; the settings
+ * snapshot still carries the last state saved there. Load-time compaction
+ * rewrites the journal as one record per friend once it has accumulated
+ * several generations of updates.
+ */
+class FriendActivityJournal
+{
+public:
+    FriendActivityJournal(QString filePath_, const ToxEncrypt* passKey_);
+
+    QHash<QByteArray, QDateTime> load();
+    void append(const ToxPk& pk, const QDateTime& activity);
+
+private:
+    bool ensureOpen();
+    void rewrite(const QHash<QByteArray, QDateTime>& entries);
+    QByteArray headerBytes() const;
+    QByteArray frameRecord(const QByteArray& pkBytes, const QDateTime& activity) const;
+
+    QString filePath;
+    const ToxEncrypt* passKey;
+    QFile file;
+    int recordCount = 0;
+};
@@ -4,7 +4,18 @@
  */
 
 #include <QDebug>
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QQueue>
+#include <QStringBuilder>
+#include <QThread>
+#include <QWaitCondition>
+#include <algorithm>
 #include <cassert>
+#include <iterator>
 
 #include <tox/tox.h>
 
@@ -14,6 +25,8 @@
 #include "db/upgrades/dbupgrader.h"
 #include "src/core/chatid.h"
 #include "src/core/toxpk.h"
+#include "src/memoryusagetracker.h"
+#include "src/workerpool.h"
 
 namespace {
 MessageState getMessageState(bool isPending, bool isBroken)
@@ -31,18 +44,376 @@ MessageState getMessageState(bool isPending, bool isBroken)
     return messageState;
 }
 
-void addAuthorIdSubQuery(QString& queryString, QVector<QByteArray>& boundParams, const ToxPk& authorPk)
+void addAuthorIdSubQuery(QString& queryString, QVector<RawDatabase::BindValue>& boundParams,
+                         const ToxPk& authorPk, const QHash<QByteArray, int64_t>& authorIds)
 {
+    // A cached author binds its numeric row id directly; the subselect only
+    // remains for senders we have never written before
+    const auto it = authorIds.constFind(authorPk.getByteArray());
+    if (it != authorIds.constEnd()) {
+        boundParams.append(*it);
+        queryString += QLatin1Char('?');
+        return;
+    }
+
     boundParams.append(authorPk.getByteArray());
     queryString += "(SELECT id FROM authors WHERE public_key = ?)";
 }
 
-void addChatIdSubQuery(QString& queryString, QVector<QByteArray>& boundParams, const ChatId& chatId)
+QByteArray aliasCacheKey(const ToxPk& authorPk, const QString& dispName)
+{
+    // The public key part is fixed-size, so appending the name is unambiguous
+    return authorPk.getByteArray() + dispName.toUtf8();
+}
+
+void addAliasIdSubQuery(QString& queryString, QVector<RawDatabase::BindValue>& boundParams,
+                        const ToxPk& authorPk, const QString& dispName,
+                        const QHash<QByteArray, int64_t>& authorIds,
+                        const QHash<QByteArray, int64_t>& aliasIds)
+{
+    // A cached (sender, name) pair binds the alias row id directly; the
+    // subselect only remains for pairs we have never written before
+    const auto it = aliasIds.constFind(aliasCacheKey(authorPk, dispName));
+    if (it != aliasIds.constEnd()) {
+        boundParams.append(*it);
+        queryString += QLatin1Char('?');
+        return;
+    }
+
+    queryString += "(SELECT id FROM aliases WHERE owner=";
+    addAuthorIdSubQuery(queryString, boundParams, authorPk, authorIds);
+    queryString += " and display_name=?)";
+    boundParams += dispName.toUtf8();
+}
+
+void addChatIdSubQuery(QString& queryString, QVector<RawDatabase::BindValue>& boundParams, const ChatId& chatId)
 {
     boundParams.append(chatId.getByteArray());
     queryString += "(SELECT id FROM chats WHERE uuid = ?)";
 }
 
+// Don't forget to update histMessageFromRow if you change the selected columns!
+QString generateMessageSelectQuery(QVector<RawDatabase::BindValue>& boundParams, const ChatId& chatId)
+{
+    QString queryString = QStringLiteral( //
+        "SELECT\n"
+        "    history.id,\n"
+        "    history.message_type,\n"
+        "    history.timestamp,\n"
+        "    faux_offline_pending.id,\n"
+        "    broken_messages.id,\n"
+        "    text_messages.message,\n"
+        "    file_transfers.file_restart_id,\n"
+        "    file_transfers.file_name,\n"
+        "    file_transfers.file_path,\n"
+        "    file_transfers.file_size,\n"
+        "    file_transfers.direction,\n"
+        "    file_transfers.file_state,\n"
+        "    authors.public_key as sender_key,\n"
+        "    aliases.display_name,\n"
+        "    system_messages.system_message_type,\n"
+        "    system_messages.arg1,\n"
+        "    system_messages.arg2,\n"
+        "    system_messages.arg3,\n"
+        "    system_messages.arg4\n"
+        "FROM history "
+        "LEFT JOIN text_messages ON history.id = text_messages.id "
+        "LEFT JOIN file_transfers ON history.id = file_transfers.id "
+        "LEFT JOIN system_messages ON system_messages.id == history.id "
+        "LEFT JOIN aliases ON text_messages.sender_alias = aliases.id OR "
+        "file_transfers.sender_alias = aliases.id "
+        "LEFT JOIN authors ON aliases.owner = authors.id "
+        "LEFT JOIN faux_offline_pending ON faux_offline_pending.id = history.id "
+        "LEFT JOIN broken_messages ON broken_messages.id = history.id "
+        "WHERE history.chat_id = ");
+    addChatIdSubQuery(queryString, boundParams, chatId);
+    return queryString;
+}
+
+/**
+ * @brief Interns a peer display name, so consecutive rows from the same sender
+ * share one QString buffer instead of each row owning its own copy.
+ *
+ * A loaded chat is dominated by a handful of senders repeating the same name
+ * millions of times; sharing cuts that to one allocation per name change.
+ * QString's implicit sharing carries the deduplication through HistMessage
+ * into ChatLogItem for free.
+ */
+QString internDisplayName(QHash<QByteArray, QString>& nameCache, const QByteArray& senderKey,
+                          QString name)
+{
+    const auto it = nameCache.constFind(senderKey);
+    if (it != nameCache.constEnd() && *it == name) {
+        return *it;
+    }
+    // New sender or a rename; later rows share this copy
+    nameCache.insert(senderKey, name);
+    return name;
+}
+
+/**
+ * @brief Decodes one row of the full message select into a HistMessage.
+ *
+ * The typed row view avoids boxing every column in a QVariant and only decodes
+ * the columns the message type actually needs.
+ */
+History::HistMessage histMessageFromRow(const RawDatabase::Row& row, const ChatId& chatId,
+                                        QHash<QByteArray, QString>& nameCache)
+{
+    // If the select statement is changed please update these constants
+    constexpr auto messageOffset = 5;
+    constexpr auto fileOffset = 6;
+    constexpr auto senderOffset = 12;
+    constexpr auto systemOffset = 14;
+
+    const auto id = RowId{row.int64Value(0)};
+    const auto messageType = row.stringValue(1);
+    const auto timestamp = QDateTime::fromMSecsSinceEpoch(row.int64Value(2));
+    const auto isPending = !row.isNull(3);
+    const auto isBroken = !row.isNull(4);
+    const auto messageState = getMessageState(isPending, isBroken);
+
+    assert(messageType.size() == 1);
+    switch (messageType[0].toLatin1()) {
+    case 'T': {
+        assert(!row.isNull(messageOffset));
+        const auto messageContent = row.stringValue(messageOffset);
+        const auto senderKey = ToxPk{row.byteArrayValue(senderOffset)};
+        const auto senderName =
+            internDisplayName(nameCache, senderKey.getByteArray(),
+                              QString::fromUtf8(row.byteArrayValue(senderOffset + 1).replace('\0', "")));
+        return History::HistMessage(id, messageState, timestamp, chatId.clone(), senderName,
+                                    senderKey, messageContent);
+    }
+    case 'F': {
+        assert(!row.isNull(fileOffset));
+        const auto fileKind = TOX_FILE_KIND_DATA;
+        const auto resumeFileId = row.byteArrayValue(fileOffset);
+        const auto fileName = row.stringValue(fileOffset + 1);
+        const auto filePath = row.stringValue(fileOffset + 2);
+        const auto filesize = row.int64Value(fileOffset + 3);
+        const auto direction = static_cast<ToxFile::FileDirection>(row.int64Value(fileOffset + 4));
+        const auto status = static_cast<ToxFile::FileStatus>(row.int64Value(fileOffset + 5));
+
+        ToxFile file(0, 0, fileName, filePath, filesize, direction);
+        file.fileKind = fileKind;
+        file.resumeFileId = resumeFileId;
+        file.status = status;
+
+        const auto senderKey = ToxPk{row.byteArrayValue(senderOffset)};
+        const auto senderName =
+            internDisplayName(nameCache, senderKey.getByteArray(),
+                              QString::fromUtf8(row.byteArrayValue(senderOffset + 1).replace('\0', "")));
+        return History::HistMessage(id, messageState, timestamp, chatId.clone(), senderName,
+                                    senderKey, file);
+    }
+    default:
+    case 'S': {
+        assert(!row.isNull(systemOffset));
+        SystemMessage systemMessage;
+        systemMessage.messageType = static_cast<SystemMessageType>(row.int64Value(systemOffset));
+        systemMessage.timestamp = timestamp;
+
+        for (size_t i = 0; i < systemMessage.args.size(); ++i) {
+            systemMessage.args[i] = QString::fromUtf8(
+                row.byteArrayValue(systemOffset + 1 + static_cast<int>(i)).replace('\0', ""));
+        }
+
+        return History::HistMessage(id, timestamp, chatId.clone(), systemMessage);
+    }
+    }
+}
+
+/**
+ * @brief Writes chunks to a device on a worker thread, so serialization and
+ * database reads overlap with disk I/O.
+ *
+ * The queue is bounded; write() blocks once the writer falls behind, keeping
+ * export memory flat no matter how large the chat is.
+ */
+class AsyncExportWriter
+{
+public:
+    explicit AsyncExportWriter(QIODevice& device_)
+        : device{device_}
+        , thread{QThread::create([this] { run(); })}
+    {
+        thread->setObjectName(QStringLiteral("qTox Chat Export"));
+        thread->start();
+    }
+
+    ~AsyncExportWriter()
+    {
+        finish();
+    }
+
+    void write(QByteArray chunk)
+    {
+        QMutexLocker<QMutex> locker{&mutex};
+        while (queue.size() >= maxQueuedChunks && !failed) {
+            chunkTaken.wait(&mutex);
+        }
+        if (failed) {
+            return;
+        }
+        queue.enqueue(std::move(chunk));
+        chunkQueued.wakeOne();
+    }
+
+    /**
+     * @brief Drains the queue and joins the writer thread.
+     * @return True if every chunk was written successfully.
+     */
+    bool finish()
+    {
+        {
+            QMutexLocker<QMutex> locker{&mutex};
+            if (done) {
+                return !failed;
+            }
+            done = true;
+            chunkQueued.wakeOne();
+        }
+        thread->wait();
+        return !failed;
+    }
+
+private:
+    void run()
+    {
+        forever
+        {
+            QByteArray chunk;
+            {
+                QMutexLocker<QMutex> locker{&mutex};
+                while (queue.isEmpty() && !done) {
+                    chunkQueued.wait(&mutex);
+                }
+                if (queue.isEmpty()) {
+                    return;
+                }
+                chunk = queue.dequeue();
+                chunkTaken.wakeOne();
+            }
+
+            if (device.write(chunk) != chunk.size()) {
+                qWarning() << "Chat export write failed:" << device.errorString();
+                QMutexLocker<QMutex> locker{&mutex};
+                failed = true;
+                queue.clear();
+                chunkTaken.wakeAll();
+                return;
+            }
+        }
+    }
+
+    static constexpr qsizetype maxQueuedChunks = 8;
+
+    QIODevice& device;
+    QQueue<QByteArray> queue;
+    QMutex mutex;
+    QWaitCondition chunkQueued;
+    QWaitCondition chunkTaken;
+    bool done = false;
+    bool failed = false;
+    std::unique_ptr<QThread> thread;
+};
+
+QString messageStateName(MessageState state)
+{
+    switch (state) {
+    case MessageState::complete:
+        return QStringLiteral("complete");
+    case MessageState::pending:
+        return QStringLiteral("pending");
+    case MessageState::broken:
+        return QStringLiteral("broken");
+    }
+    assert(false);
+    return {};
+}
+
+QJsonObject exportMessageToJson(const History::HistMessage& message)
+{
+    QJsonObject object;
+    object[QStringLiteral("id")] = static_cast<qint64>(message.id.get());
+    object[QStringLiteral("timestamp")] = message.timestamp.toString(Qt::ISODateWithMs);
+    object[QStringLiteral("state")] = messageStateName(message.state);
+
+    switch (message.content.getType()) {
+    case HistMessageContentType::message:
+        object[QStringLiteral("type")] = QStringLiteral("message");
+        object[QStringLiteral("sender")] = message.sender.toString();
+        object[QStringLiteral("senderName")] = message.dispName;
+        object[QStringLiteral("message")] = message.content.asMessage();
+        break;
+    case HistMessageContentType::file: {
+        const ToxFile& file = message.content.asFile();
+        object[QStringLiteral("type")] = QStringLiteral("file");
+        object[QStringLiteral("sender")] = message.sender.toString();
+        object[QStringLiteral("senderName")] = message.dispName;
+        object[QStringLiteral("fileName")] = file.fileName;
+        object[QStringLiteral("fileSize")] = static_cast<qint64>(file.filesize);
+        object[QStringLiteral("direction")] = file.direction == ToxFile::SENDING
+                                                  ? QStringLiteral("sent")
+                                                  : QStringLiteral("received");
+        break;
+    }
+    case HistMessageContentType::system: {
+        const SystemMessage& systemMessage = message.content.asSystemMessage();
+        object[QStringLiteral("type")] = QStringLiteral("system");
+        object[QStringLiteral("systemMessageType")] = static_cast<int>(systemMessage.messageType);
+        QJsonArray args;
+        for (const QString& arg : systemMessage.args) {
+            args += arg;
+        }
+        object[QStringLiteral("args")] = args;
+        break;
+    }
+    }
+    return object;
+}
+
+QString csvEscape(QString field)
+{
+    if (field.contains(QLatin1Char(',')) || field.contains(QLatin1Char('"'))
+        || field.contains(QLatin1Char('\n'))) {
+        field.replace(QLatin1String("\""), QLatin1String("\"\""));
+        field = QLatin1Char('"') % field % QLatin1Char('"');
+    }
+    return field;
+}
+
+QByteArray exportMessageToCsv(const History::HistMessage& message)
+{
+    QString content;
+    QString type;
+    switch (message.content.getType()) {
+    case HistMessageContentType::message:
+        type = QStringLiteral("message");
+        content = message.content.asMessage();
+        break;
+    case HistMessageContentType::file: {
+        const ToxFile& file = message.content.asFile();
+        type = QStringLiteral("file");
+        content = QStringLiteral("%1 (%2 bytes)").arg(file.fileName).arg(file.filesize);
+        break;
+    }
+    case HistMessageContentType::system:
+        type = QStringLiteral("system");
+        content = message.content.asSystemMessage().toString();
+        break;
+    }
+
+    const QString line = QString::number(message.id.get()) % QLatin1Char(',')
+                         % message.timestamp.toString(Qt::ISODateWithMs) % QLatin1Char(',')
+                         % message.sender.toString() % QLatin1Char(',')
+                         % csvEscape(message.dispName) % QLatin1Char(',')
+                         % messageStateName(message.state) % QLatin1Char(',') % type
+                         % QLatin1Char(',') % csvEscape(content) % QLatin1Char('\n');
+    return line.toUtf8();
+}
+
 RawDatabase::Query generateEnsurePkInChats(const ChatId& id)
 {
     return RawDatabase::Query{
@@ -63,29 +434,40 @@ RawDatabase::Query generateEnsurePkInAuthors(const ToxPk& pk)
     };
 }
 
-RawDatabase::Query generateUpdateAlias(const ToxPk& pk, const QString& dispName)
+RawDatabase::Query generateUpdateAlias(const ToxPk& pk, const QString& dispName,
+                                       const QHash<QByteArray, int64_t>& authorIds)
 {
-    QVector<QByteArray> boundParams;
+    QVector<RawDatabase::BindValue> boundParams;
     QString queryString = QStringLiteral( //
         "INSERT OR IGNORE INTO aliases (owner, display_name) VALUES (");
-    addAuthorIdSubQuery(queryString, boundParams, pk);
+    addAuthorIdSubQuery(queryString, boundParams, pk, authorIds);
     queryString += ", ?);";
     boundParams += dispName.toUtf8();
     return RawDatabase::Query{queryString, boundParams};
 }
 
-RawDatabase::Query generateHistoryTableInsertion(char type, const QDateTime& time, const ChatId& chatId)
+RawDatabase::Query generateHistoryTableInsertion(char type, const QDateTime& time, const ChatId& chatId,
+                                                 const QHash<QByteArray, int64_t>& chatIds)
 {
-    QVector<QByteArray> boundParams;
-    QString queryString = //
-        QStringLiteral(   //
+    // One fixed query text per message type and cache state, with the varying
+    // values as binds: every insert of that shape then hits the same
+    // statement-cache entry instead of compiling fresh text with the
+    // timestamp baked in.
+    assert(type == 'T' || type == 'F' || type == 'S');
+    const auto it = chatIds.constFind(chatId.getByteArray());
+    const bool cached = it != chatIds.constEnd();
+    const QString queryString =
+        QStringLiteral( //
             "INSERT INTO history (message_type, timestamp, chat_id) "
-            "VALUES ('%1', %2, ")
-            .arg(type)
-            .arg(time.toMSecsSinceEpoch());
-    addChatIdSubQuery(queryString, boundParams, chatId);
-    queryString += ");";
-    return RawDatabase::Query(queryString, boundParams);
+            "VALUES ('%1', ?, %2);")
+            .arg(QChar::fromLatin1(type))
+            .arg(cached ? QStringLiteral("?")
+                        : QStringLiteral("(SELECT id FROM chats WHERE uuid = ?)"));
+    if (cached) {
+        return RawDatabase::Query(queryString, {time.toMSecsSinceEpoch(), *it});
+    }
+    return RawDatabase::Query(queryString,
+                              {time.toMSecsSinceEpoch(), chatId.getByteArray()});
 }
 
 /**
@@ -98,29 +480,34 @@ RawDatabase::Query generateHistoryTableInsertion(char type, const QDateTime& tim
  * @param dispName Name, which should be displayed.
  * @param insertIdCallback Function, called after query execution.
  */
-QVector<RawDatabase::Query> generateNewTextMessageQueries(const ChatId& chatId, const QString& message,
-                                                          const ToxPk& sender, const QDateTime& time,
-                                                          bool isDelivered, QString dispName,
-                                                          std::function<void(RowId)> insertIdCallback)
+QVector<RawDatabase::Query> generateNewTextMessageQueries(
+    const ChatId& chatId, const QString& message, const ToxPk& sender, const QDateTime& time,
+    bool isDelivered, QString dispName, const QHash<QByteArray, int64_t>& chatIds,
+    const QHash<QByteArray, int64_t>& authorIds, const QHash<QByteArray, int64_t>& aliasIds,
+    std::function<void(RowId)> insertIdCallback)
 {
     QVector<RawDatabase::Query> queries;
 
-    queries += generateEnsurePkInChats(chatId);
-    queries += generateEnsurePkInAuthors(sender);
-    queries += generateUpdateAlias(sender, dispName);
-    queries += generateHistoryTableInsertion('T', time, chatId);
+    if (!chatIds.contains(chatId.getByteArray())) {
+        queries += generateEnsurePkInChats(chatId);
+    }
+    if (!authorIds.contains(sender.getByteArray())) {
+        queries += generateEnsurePkInAuthors(sender);
+    }
+    if (!aliasIds.contains(aliasCacheKey(sender, dispName))) {
+        queries += generateUpdateAlias(sender, dispName, authorIds);
+    }
+    queries += generateHistoryTableInsertion('T', time, chatId, chatIds);
 
-    QVector<QByteArray> boundParams;
+    QVector<RawDatabase::BindValue> boundParams;
     QString queryString = QStringLiteral( //
         "INSERT INTO text_messages (id, message_type, sender_alias, message) "
         "VALUES ( "
         "    last_insert_rowid(), "
         "    'T', "
-        "    (SELECT id FROM aliases WHERE owner=");
-    addAuthorIdSubQuery(queryString, boundParams, sender);
-    queryString += " and display_name=?";
-    boundParams += dispName.toUtf8();
-    queryString += "), ?";
+        "    ");
+    addAliasIdSubQuery(queryString, boundParams, sender, dispName, authorIds, aliasIds);
+    queryString += ", ?";
     boundParams += message.toUtf8();
     queryString += ");";
     queries += RawDatabase::Query(queryString, boundParams, insertIdCallback);
@@ -138,24 +525,27 @@ QVector<RawDatabase::Query> generateNewTextMessageQueries(const ChatId& chatId,
 }
 
 QVector<RawDatabase::Query> generateNewSystemMessageQueries(const ChatId& chatId,
-                                                            const SystemMessage& systemMessage)
+                                                            const SystemMessage& systemMessage,
+                                                            const QHash<QByteArray, int64_t>& chatIds)
 {
     QVector<RawDatabase::Query> queries;
 
-    queries += generateEnsurePkInChats(chatId);
-    queries += generateHistoryTableInsertion('S', systemMessage.timestamp, chatId);
+    if (!chatIds.contains(chatId.getByteArray())) {
+        queries += generateEnsurePkInChats(chatId);
+    }
+    queries += generateHistoryTableInsertion('S', systemMessage.timestamp, chatId, chatIds);
 
-    QVector<QByteArray> blobs;
-    std::transform(systemMessage.args.begin(), systemMessage.args.end(), std::back_inserter(blobs),
-                   [](const QString& s) { return s.toUtf8(); });
+    QVector<RawDatabase::BindValue> boundParams;
+    boundParams += static_cast<int64_t>(systemMessage.messageType);
+    std::transform(systemMessage.args.begin(), systemMessage.args.end(),
+                   std::back_inserter(boundParams), [](const QString& s) { return s.toUtf8(); });
 
     queries += RawDatabase::Query{
         QStringLiteral( //
             "INSERT INTO system_messages (id, message_type, "
             "system_message_type, arg1, arg2, arg3, arg4)"
-            "VALUES (last_insert_rowid(), 'S', %1, ?, ?, ?, ?)")
-            .arg(static_cast<int>(systemMessage.messageType)),
-        blobs,
+            "VALUES (last_insert_rowid(), 'S', ?, ?, ?, ?, ?)"),
+        boundParams,
     };
 
     return queries;
@@ -195,7 +585,13 @@ History::History(std::shared_ptr<RawDatabase> db_, Settings& settings_,
     // support was added in sqlite 3.6.19, which is qTox's minimum supported version
     db->execNow("PRAGMA foreign_keys = ON;");
 
-    const auto upgradeSucceeded = DbUpgrader::dbSchemaUpgrade(db, messageBoxManager);
+    // No loading screen shows during profile load yet, so upgrade progress
+    // goes to the log; the callback is where a UI would hook in
+    const auto upgradeSucceeded =
+        DbUpgrader::dbSchemaUpgrade(db, messageBoxManager, [](int step, int totalSteps, int percent) {
+            qInfo().nospace() << "Database upgrade step " << step << "/" << totalSteps << ": "
+                              << percent << "%";
+        });
 
     // dbSchemaUpgrade may have put us in an invalid state
     if (!upgradeSucceeded) {
@@ -204,14 +600,32 @@ History::History(std::shared_ptr<RawDatabase> db_, Settings& settings_,
     }
 
     connect(this, &History::fileInserted, this, &History::onFileInserted);
+    connect(this, &History::authorIdResolved, this, &History::onAuthorIdResolved);
+    connect(this, &History::chatIdResolved, this, &History::onChatIdResolved);
+    connect(this, &History::aliasIdResolved, this, &History::onAliasIdResolved);
+
+    loadIdCaches();
+
+    deliveryFlushTimer.setSingleShot(true);
+    connect(&deliveryFlushTimer, &QTimer::timeout, this, &History::flushDeliveryStateCache);
+
+    // sqlite's allocator counter is process-global, but one profile means one
+    // history database, so attributing it here is accurate in practice
+    MemoryUsageTracker::instance().registerSource(
+        this, QStringLiteral("SQLite"), &RawDatabase::sqliteMemoryUsed,
+        [db = db] { db->releaseMemory(); });
 }
 
 History::~History()
 {
+    MemoryUsageTracker::instance().unregisterSource(this);
+
     if (!isValid()) {
         return;
     }
 
+    flushDeliveryStateCache();
+
     // We could have execLater requests pending with a lambda attached,
     // so clear the pending transactions first
     db->sync();
@@ -249,6 +663,11 @@ void History::eraseHistory()
         return;
     }
 
+    // Everything the cache would write is about to be deleted anyway
+    pendingDelivered.clear();
+    pendingBroken.clear();
+    deliveryFlushTimer.stop();
+
     db->execNow( //
         "DELETE FROM faux_offline_pending;"
         "DELETE FROM broken_messages;"
@@ -260,6 +679,10 @@ void History::eraseHistory()
         "DELETE FROM aliases;"
         "DELETE FROM authors;"
         "VACUUM;");
+
+    authorIdCache.clear();
+    chatIdCache.clear();
+    aliasIdCache.clear();
 }
 
 /**
@@ -272,8 +695,11 @@ void History::removeChatHistory(const ChatId& chatId)
         return;
     }
 
+    // Cached flips may belong to other chats, so write them out first
+    flushDeliveryStateCache();
+
     QVector<RawDatabase::Query> queries;
-    QVector<QByteArray> boundParams;
+    QVector<RawDatabase::BindValue> boundParams;
     QString queryString = QStringLiteral( //
         "DELETE FROM faux_offline_pending "
         "WHERE faux_offline_pending.id IN ( "
@@ -351,6 +777,103 @@ void History::removeChatHistory(const ChatId& chatId)
     } else {
         db->execNow(RawDatabase::Query{QStringLiteral("VACUUM")});
     }
+
+    // The chat row and any orphaned authors are gone; drop the cached ids and
+    // let the insert path re-resolve lazily
+    chatIdCache.remove(chatId.getByteArray());
+    authorIdCache.clear();
+    aliasIdCache.clear();
+}
+
+/**
+ * @brief Preloads the author and chat row id caches in one query each.
+ */
+void History::loadIdCaches()
+{
+    auto authorCallback = [this](const RawDatabase::Row& row) {
+        authorIdCache.insert(row.byteArrayValue(0), row.int64Value(1));
+    };
+    auto chatCallback = [this](const RawDatabase::Row& row) {
+        chatIdCache.insert(row.byteArrayValue(0), row.int64Value(1));
+    };
+    auto aliasCallback = [this](const RawDatabase::Row& row) {
+        aliasIdCache.insert(row.byteArrayValue(0) + row.byteArrayValue(1), row.int64Value(2));
+    };
+    db->execNow(RawDatabase::Query(QStringLiteral("SELECT public_key, id FROM authors;"),
+                                   authorCallback));
+    db->execNow(RawDatabase::Query(QStringLiteral("SELECT uuid, id FROM chats;"), chatCallback));
+    db->execNow(RawDatabase::Query(QStringLiteral("SELECT authors.public_key, "
+                                                  "aliases.display_name, aliases.id "
+                                                  "FROM aliases "
+                                                  "JOIN authors ON aliases.owner = authors.id;"),
+                                   aliasCallback));
+}
+
+/**
+ * @brief Queues row id fetches for any ids missing from the caches.
+ *
+ * Must run after the ensure-inserts that create the rows, in the same batch.
+ * The results come back on the database thread and are applied to the caches
+ * through the queued resolved signals, so every later message from the same
+ * sender binds the numeric id directly.
+ */
+void History::appendIdResolutionQueries(QVector<RawDatabase::Query>& queries, const ChatId& chatId,
+                                        const ToxPk* sender, const QString* dispName)
+{
+    std::weak_ptr<History> weakThis = shared_from_this();
+
+    if (!chatIdCache.contains(chatId.getByteArray())) {
+        const QByteArray uuid = chatId.getByteArray();
+        auto rowCallback = [weakThis, uuid](const RawDatabase::Row& row) {
+            auto pThis = weakThis.lock();
+            if (pThis)
+                emit pThis->chatIdResolved(uuid, row.int64Value(0));
+        };
+        queries += RawDatabase::Query(QStringLiteral("SELECT id FROM chats WHERE uuid = ?"), {uuid},
+                                      rowCallback);
+    }
+
+    if (sender != nullptr && !authorIdCache.contains(sender->getByteArray())) {
+        const QByteArray pk = sender->getByteArray();
+        auto rowCallback = [weakThis, pk](const RawDatabase::Row& row) {
+            auto pThis = weakThis.lock();
+            if (pThis)
+                emit pThis->authorIdResolved(pk, row.int64Value(0));
+        };
+        queries += RawDatabase::Query(QStringLiteral("SELECT id FROM authors WHERE public_key = ?"),
+                                      {pk}, rowCallback);
+    }
+
+    if (sender != nullptr && dispName != nullptr
+        && !aliasIdCache.contains(aliasCacheKey(*sender, *dispName))) {
+        const QByteArray key = aliasCacheKey(*sender, *dispName);
+        auto rowCallback = [weakThis, key](const RawDatabase::Row& row) {
+            auto pThis = weakThis.lock();
+            if (pThis)
+                emit pThis->aliasIdResolved(key, row.int64Value(0));
+        };
+        QString queryString = QStringLiteral("SELECT id FROM aliases WHERE owner = ");
+        QVector<RawDatabase::BindValue> boundParams;
+        addAuthorIdSubQuery(queryString, boundParams, *sender, authorIdCache);
+        queryString += QStringLiteral(" AND display_name = ?");
+        boundParams += dispName->toUtf8();
+        queries += RawDatabase::Query(queryString, boundParams, rowCallback);
+    }
+}
+
+void History::onAuthorIdResolved(QByteArray publicKey, int64_t rowId)
+{
+    authorIdCache.insert(publicKey, rowId);
+}
+
+void History::onChatIdResolved(QByteArray uuid, int64_t rowId)
+{
+    chatIdCache.insert(uuid, rowId);
+}
+
+void History::onAliasIdResolved(QByteArray key, int64_t rowId)
+{
+    aliasIdCache.insert(key, rowId);
 }
 
 void History::onFileInserted(RowId dbId, QByteArray fileId)
@@ -373,10 +896,16 @@ History::generateNewFileTransferQueries(const ChatId& chatId, const ToxPk& sende
 {
     QVector<RawDatabase::Query> queries;
 
-    queries += generateEnsurePkInChats(chatId);
-    queries += generateEnsurePkInAuthors(sender);
-    queries += generateUpdateAlias(sender, dispName);
-    queries += generateHistoryTableInsertion('F', time, chatId);
+    if (!chatIdCache.contains(chatId.getByteArray())) {
+        queries += generateEnsurePkInChats(chatId);
+    }
+    if (!authorIdCache.contains(sender.getByteArray())) {
+        queries += generateEnsurePkInAuthors(sender);
+    }
+    if (!aliasIdCache.contains(aliasCacheKey(sender, dispName))) {
+        queries += generateUpdateAlias(sender, dispName, authorIdCache);
+    }
+    queries += generateHistoryTableInsertion('F', time, chatId, chatIdCache);
 
     std::weak_ptr<History> weakThis = shared_from_this();
     auto fileId = insertionData.fileId;
@@ -390,12 +919,10 @@ History::generateNewFileTransferQueries(const ChatId& chatId, const ToxPk& sende
         "VALUES ( "
         "    last_insert_rowid(), "
         "    'F', "
-        "    (SELECT id FROM aliases WHERE owner=");
-    QVector<QByteArray> boundParams;
-    addAuthorIdSubQuery(queryString, boundParams, sender);
-    queryString += " AND display_name=?";
-    boundParams += dispName.toUtf8();
-    queryString += "), ?";
+        "    ");
+    QVector<RawDatabase::BindValue> boundParams;
+    addAliasIdSubQuery(queryString, boundParams, sender, dispName, authorIdCache, aliasIdCache);
+    queryString += ", ?";
     boundParams += insertionData.fileId;
     queryString += ", ?";
     boundParams += insertionData.fileName.toUtf8();
@@ -403,10 +930,10 @@ History::generateNewFileTransferQueries(const ChatId& chatId, const ToxPk& sende
     boundParams += insertionData.filePath.toUtf8();
     queryString += ", ?";
     boundParams += QByteArray();
-    queryString += QStringLiteral(", %1, %2, %3);")
-                       .arg(insertionData.size)
-                       .arg(insertionData.direction)
-                       .arg(ToxFile::CANCELED);
+    queryString += ", ?, ?, ?);";
+    boundParams += insertionData.size;
+    boundParams += static_cast<int64_t>(insertionData.direction);
+    boundParams += static_cast<int64_t>(ToxFile::CANCELED);
     queries += RawDatabase::Query(queryString, boundParams, [weakThis, fileId](RowId id) {
         auto pThis = weakThis.lock();
         if (pThis)
@@ -423,19 +950,16 @@ RawDatabase::Query History::generateFileFinished(RowId id, bool success, const Q
         return RawDatabase::Query( //
             QStringLiteral(        //
                 "UPDATE file_transfers "
-                "SET file_state = %1, file_path = ?, file_hash = ?"
-                "WHERE id = %2")
-                .arg(file_state)
-                .arg(id.get()),
-            {filePath.toUtf8(), fileHash});
+                "SET file_state = ?, file_path = ?, file_hash = ?"
+                "WHERE id = ?"),
+            {static_cast<int64_t>(file_state), filePath.toUtf8(), fileHash, id.get()});
     } else {
         return RawDatabase::Query( //
             QStringLiteral(        //
                 "UPDATE file_transfers "
-                "SET file_state = %1 "
-                "WHERE id = %2")
-                .arg(file_state)
-                .arg(id.get()));
+                "SET file_state = ? "
+                "WHERE id = ?"),
+            {static_cast<int64_t>(file_state), id.get()});
     }
 }
 
@@ -476,6 +1000,7 @@ void History::addNewFileMessage(const ChatId& chatId, const QByteArray& fileId,
     insertionData.direction = direction;
 
     auto queries = generateNewFileTransferQueries(chatId, sender, time, dispName, insertionData);
+    appendIdResolutionQueries(queries, chatId, &sender, &dispName);
 
     db->execLater(queries);
 }
@@ -485,7 +1010,8 @@ void History::addNewSystemMessage(const ChatId& chatId, const SystemMessage& sys
     if (historyAccessBlocked())
         return;
 
-    const auto queries = generateNewSystemMessageQueries(chatId, systemMessage);
+    auto queries = generateNewSystemMessageQueries(chatId, systemMessage, chatIdCache);
+    appendIdResolutionQueries(queries, chatId, nullptr, nullptr);
 
     db->execLater(queries);
 }
@@ -508,8 +1034,12 @@ void History::addNewMessage(const ChatId& chatId, const QString& message, const
         return;
     }
 
-    db->execLater(generateNewTextMessageQueries(chatId, message, sender, time, isDelivered,
-                                                dispName, insertIdCallback));
+    auto queries = generateNewTextMessageQueries(chatId, message, sender, time, isDelivered,
+                                                 dispName, chatIdCache, authorIdCache,
+                                                 aliasIdCache, insertIdCallback);
+    appendIdResolutionQueries(queries, chatId, &sender, &dispName);
+
+    db->execLater(queries);
 }
 
 void History::setFileFinished(const QByteArray& fileId, bool success, const QString& filePath,
@@ -532,6 +1062,64 @@ void History::setFileFinished(const QByteArray& fileId, bool success, const QStr
     fileInfos.remove(fileId);
 }
 
+/**
+ * @brief Persists the unsent input text of a chat, or clears it.
+ * @param chatId Chat whose draft to update.
+ * @param text Draft text; an empty string removes the stored draft.
+ *
+ * Callers are expected to debounce: this queues a write per invocation.
+ */
+void History::setDraft(const ChatId& chatId, const QString& text)
+{
+    if (historyAccessBlocked()) {
+        return;
+    }
+
+    QVector<RawDatabase::Query> queries;
+    QString queryString;
+    QVector<RawDatabase::BindValue> boundParams;
+    if (text.isEmpty()) {
+        queryString = QStringLiteral("DELETE FROM chat_drafts WHERE chat_id = ");
+        addChatIdSubQuery(queryString, boundParams, chatId);
+        queryString += QLatin1Char(';');
+        queries += RawDatabase::Query(queryString, boundParams);
+    } else {
+        if (!chatIdCache.contains(chatId.getByteArray())) {
+            queries += generateEnsurePkInChats(chatId);
+        }
+        queryString = QStringLiteral("INSERT OR REPLACE INTO chat_drafts (chat_id, text) VALUES (");
+        addChatIdSubQuery(queryString, boundParams, chatId);
+        queryString += QStringLiteral(", ?);");
+        boundParams += text.toUtf8();
+        queries += RawDatabase::Query(queryString, boundParams);
+        appendIdResolutionQueries(queries, chatId, nullptr, nullptr);
+    }
+
+    db->execLater(queries);
+}
+
+/**
+ * @brief Reads back the draft a previous session left for a chat.
+ * @return The stored draft text, or an empty string if there is none.
+ */
+QString History::getDraft(const ChatId& chatId)
+{
+    if (historyAccessBlocked()) {
+        return {};
+    }
+
+    QString draft;
+    QString queryString = QStringLiteral("SELECT text FROM chat_drafts WHERE chat_id = ");
+    QVector<RawDatabase::BindValue> boundParams;
+    addChatIdSubQuery(queryString, boundParams, chatId);
+    queryString += QLatin1Char(';');
+    db->execNowReadOnly(RawDatabase::Query(queryString, boundParams,
+                                           [&draft](const RawDatabase::Row& row) {
+                                               draft = row.stringValue(0);
+                                           }));
+    return draft;
+}
+
 size_t History::getNumMessagesForChat(const ChatId& chatId)
 {
     if (historyAccessBlocked()) {
@@ -569,6 +1157,51 @@ size_t History::getNumMessagesForChatBeforeDate(const ChatId& chatId, const QDat
     return numMessages;
 }
 
+/**
+ * @brief Aggregates a chat's text message activity into hourly buckets.
+ *
+ * Runs one GROUP BY over the (chat_id, rowid) index on the read-only
+ * connection, so seeding the debug statistics for a years-old conference
+ * costs a single indexed scan instead of paging every message through the
+ * write connection.
+ *
+ * @param chatId Chat to aggregate activity for
+ * @param before Only count messages strictly older than this
+ * @return Hourly aggregates in ascending hour order
+ */
+QList<History::HourlyChatActivity> History::getChatActivityByHour(const ChatId& chatId,
+                                                                  const QDateTime& before)
+{
+    if (historyAccessBlocked()) {
+        return {};
+    }
+
+    QList<HourlyChatActivity> activity;
+    auto rowCallback = [&activity](const QVector<QVariant>& row) {
+        activity += {row[0].toLongLong(), static_cast<quint32>(row[1].toLongLong()),
+                     static_cast<quint64>(row[2].toLongLong())};
+    };
+
+    QVector<RawDatabase::BindValue> boundParams;
+    QString queryString = QStringLiteral( //
+        "SELECT history.timestamp / 3600000, COUNT(history.id), "
+        "    TOTAL(LENGTH(CAST(text_messages.message AS BLOB))) "
+        "FROM history "
+        "JOIN text_messages ON history.id = text_messages.id "
+        "WHERE history.chat_id = ");
+    addChatIdSubQuery(queryString, boundParams, chatId);
+    queryString += QStringLiteral(" AND history.timestamp < %1 "
+                                  "GROUP BY history.timestamp / 3600000 "
+                                  "ORDER BY 1 ASC;")
+                       .arg(before.toMSecsSinceEpoch());
+
+    if (!db->execNowReadOnly({queryString, boundParams, rowCallback})) {
+        return {};
+    }
+
+    return activity;
+}
+
 QList<History::HistMessage> History::getMessagesForChat(const ChatId& chatId, size_t firstIdx,
                                                         size_t lastIdx)
 {
@@ -576,119 +1209,150 @@ QList<History::HistMessage> History::getMessagesForChat(const ChatId& chatId, si
         return {};
     }
 
+    // Queued delivery state flips must hit the DB before we read it back
+    flushDeliveryStateCache();
+
     QList<HistMessage> messages;
 
-    auto rowCallback = [&chatId, &messages](const QVector<QVariant>& row) {
-        // If the select statement is changed please update these constants
-        constexpr auto messageOffset = 5;
-        constexpr auto fileOffset = 6;
-        constexpr auto senderOffset = 12;
-        constexpr auto systemOffset = 14;
+    auto rowCallback = [this, &chatId, &messages](const RawDatabase::Row& row) {
+        messages += histMessageFromRow(row, chatId, peerNameCache);
+    };
 
-        auto it = row.begin();
+    QVector<RawDatabase::BindValue> boundParams;
+    QString queryString = generateMessageSelectQuery(boundParams, chatId);
+    // Resolve the page's first row id on the bare (chat_id, rowid) index
+    // before running the joins. A plain LIMIT/OFFSET on the joined query makes
+    // SQLite assemble and discard every row before firstIdx, so loading a page
+    // deep in a long chat pays for all the history preceding it; the
+    // index-only skip below walks nothing but the chat's contiguous index
+    // entries, and the joins then run over the requested window alone.
+    queryString += QStringLiteral(" AND history.id >= (SELECT id FROM history WHERE chat_id = ");
+    addChatIdSubQuery(queryString, boundParams, chatId);
+    queryString +=
+        QStringLiteral(" ORDER BY id LIMIT 1 OFFSET %1) ORDER BY history.id ASC LIMIT %2;")
+            .arg(firstIdx)
+            .arg(lastIdx - firstIdx);
+    db->execNow({queryString, boundParams, rowCallback});
 
-        const auto id = RowId{(*it++).toLongLong()};
-        const auto messageType = (*it++).toString();
-        const auto timestamp = QDateTime::fromMSecsSinceEpoch((*it++).toLongLong());
-        const auto isPending = !(*it++).isNull();
-        const auto isBroken = !(*it++).isNull();
-        const auto messageState = getMessageState(isPending, isBroken);
-
-        // Intentionally arrange query so message types are at the end so we don't have to think
-        // about the iterator jumping around after handling the different types.
-        assert(messageType.size() == 1);
-        switch (messageType[0].toLatin1()) {
-        case 'T': {
-            it = std::next(row.begin(), messageOffset);
-            assert(!it->isNull());
-            const auto messageContent = (*it++).toString();
-            it = std::next(row.begin(), senderOffset);
-            const auto senderKey = ToxPk{(*it++).toByteArray()};
-            const auto senderName = QString::fromUtf8((*it++).toByteArray().replace('\0', ""));
-            messages += HistMessage(id, messageState, timestamp, chatId.clone(), senderName,
-                                    senderKey, messageContent);
+    return messages;
+}
+
+/**
+ * @brief Fetches chat messages in fixed-size pages, handing each page to the
+ * caller as soon as it is decoded.
+ *
+ * Unlike getMessagesForChat this never materializes the whole range at once,
+ * so loading years of history stays bounded by the page size. Stops early if
+ * the database runs out of rows before lastIdx.
+ *
+ * @param chatId Chat to load messages for
+ * @param firstIdx Index of the first message to load, inclusive
+ * @param lastIdx Index of the last message to load, exclusive
+ * @param pageCallback Invoked once per page, in order
+ * @param pageSize Number of messages per page, must be > 0
+ */
+void History::streamMessagesForChat(const ChatId& chatId, size_t firstIdx, size_t lastIdx,
+                                    const std::function<void(QList<HistMessage>)>& pageCallback,
+                                    size_t pageSize)
+{
+    if (historyAccessBlocked()) {
+        return;
+    }
+
+    // Queued delivery state flips must hit the DB before we read it back
+    flushDeliveryStateCache();
+
+    assert(pageSize > 0);
+    for (size_t pageStart = firstIdx; pageStart < lastIdx; pageStart += pageSize) {
+        const auto pageEnd = std::min(pageStart + pageSize, lastIdx);
+        auto page = getMessagesForChat(chatId, pageStart, pageEnd);
+        const auto rowCount = static_cast<size_t>(page.size());
+        pageCallback(std::move(page));
+        if (rowCount < pageEnd - pageStart) {
+            // Ran past the end of stored history
             break;
         }
-        case 'F': {
-            it = std::next(row.begin(), fileOffset);
-            assert(!it->isNull());
-            const auto fileKind = TOX_FILE_KIND_DATA;
-            const auto resumeFileId = (*it++).toByteArray();
-            const auto fileName = (*it++).toString();
-            const auto filePath = (*it++).toString();
-            const auto filesize = (*it++).toLongLong();
-            const auto direction = static_cast<ToxFile::FileDirection>((*it++).toLongLong());
-            const auto status = static_cast<ToxFile::FileStatus>((*it++).toLongLong());
-
-            ToxFile file(0, 0, fileName, filePath, filesize, direction);
-            file.fileKind = fileKind;
-            file.resumeFileId = resumeFileId;
-            file.status = status;
-
-            it = std::next(row.begin(), senderOffset);
-            const auto senderKey = ToxPk{(*it++).toByteArray()};
-            const auto senderName = QString::fromUtf8((*it++).toByteArray().replace('\0', ""));
-            messages +=
-                HistMessage(id, messageState, timestamp, chatId.clone(), senderName, senderKey, file);
-            break;
+    }
+}
+
+/**
+ * @brief Exports a chat's entire history to the given device as JSON or CSV.
+ *
+ * Walks rows in RowId order with keyset pagination, so memory stays bounded by
+ * the page size regardless of chat length, and serialized pages are written
+ * through a background writer so database reads overlap with disk I/O. Runs on
+ * the read lane and never touches the UI, making it usable headless.
+ *
+ * @param chatId Chat to export
+ * @param output Device to write to, must be open for writing
+ * @param format Output format
+ * @param pageSize Number of messages fetched and serialized per chunk
+ * @return True if the whole chat was exported successfully.
+ */
+bool History::exportChat(const ChatId& chatId, QIODevice& output, ExportFormat format, size_t pageSize)
+{
+    if (historyAccessBlocked()) {
+        return false;
+    }
+
+    // Queued delivery state flips must hit the DB before we read it back
+    flushDeliveryStateCache();
+
+    assert(pageSize > 0);
+
+    AsyncExportWriter writer{output};
+    if (format == ExportFormat::csv) {
+        writer.write(QByteArrayLiteral("id,timestamp,sender,sender_name,state,type,content\n"));
+    } else {
+        writer.write(QByteArrayLiteral("[\n"));
+    }
+
+    int64_t lastRowId = -1;
+    bool firstEntry = true;
+    forever
+    {
+        QList<HistMessage> page;
+        auto rowCallback = [this, &chatId, &page](const RawDatabase::Row& row) {
+            page += histMessageFromRow(row, chatId, peerNameCache);
+        };
+
+        QVector<RawDatabase::BindValue> boundParams;
+        QString queryString = generateMessageSelectQuery(boundParams, chatId);
+        queryString += QStringLiteral(" AND history.id > %1 ORDER BY history.id ASC LIMIT %2;")
+                           .arg(lastRowId)
+                           .arg(pageSize);
+        if (!db->execNowReadOnly({queryString, boundParams, rowCallback})) {
+            return false;
         }
-        default:
-        case 'S':
-            it = std::next(row.begin(), systemOffset);
-            assert(!it->isNull());
-            SystemMessage systemMessage;
-            systemMessage.messageType = static_cast<SystemMessageType>((*it++).toLongLong());
-            systemMessage.timestamp = timestamp;
-
-            auto argEnd = std::next(it, systemMessage.args.size());
-            std::transform(it, argEnd, systemMessage.args.begin(), [](const QVariant& arg) {
-                return QString::fromUtf8(arg.toByteArray().replace('\0', ""));
-            });
-            it = argEnd;
-
-            messages += HistMessage(id, timestamp, chatId.clone(), systemMessage);
+
+        if (page.isEmpty()) {
             break;
         }
-    };
+        lastRowId = page.last().id.get();
+
+        QByteArray chunk;
+        for (const HistMessage& message : page) {
+            if (format == ExportFormat::csv) {
+                chunk += exportMessageToCsv(message);
+            } else {
+                if (!firstEntry) {
+                    chunk += QByteArrayLiteral(",\n");
+                }
+                chunk += QJsonDocument{exportMessageToJson(message)}.toJson(QJsonDocument::Compact);
+            }
+            firstEntry = false;
+        }
+        writer.write(std::move(chunk));
 
-    // Don't forget to update the rowCallback if you change the selected columns!
-    QString queryString = QStringLiteral( //
-        "SELECT\n"
-        "    history.id,\n"
-        "    history.message_type,\n"
-        "    history.timestamp,\n"
-        "    faux_offline_pending.id,\n"
-        "    broken_messages.id,\n"
-        "    text_messages.message,\n"
-        "    file_transfers.file_restart_id,\n"
-        "    file_transfers.file_name,\n"
-        "    file_transfers.file_path,\n"
-        "    file_transfers.file_size,\n"
-        "    file_transfers.direction,\n"
-        "    file_transfers.file_state,\n"
-        "    authors.public_key as sender_key,\n"
-        "    aliases.display_name,\n"
-        "    system_messages.system_message_type,\n"
-        "    system_messages.arg1,\n"
-        "    system_messages.arg2,\n"
-        "    system_messages.arg3,\n"
-        "    system_messages.arg4\n"
-        "FROM history "
-        "LEFT JOIN text_messages ON history.id = text_messages.id "
-        "LEFT JOIN file_transfers ON history.id = file_transfers.id "
-        "LEFT JOIN system_messages ON system_messages.id == history.id "
-        "LEFT JOIN aliases ON text_messages.sender_alias = aliases.id OR "
-        "file_transfers.sender_alias = aliases.id "
-        "LEFT JOIN authors ON aliases.owner = authors.id "
-        "LEFT JOIN faux_offline_pending ON faux_offline_pending.id = history.id "
-        "LEFT JOIN broken_messages ON broken_messages.id = history.id "
-        "WHERE history.chat_id = ");
-    QVector<QByteArray> boundParams;
-    addChatIdSubQuery(queryString, boundParams, chatId);
-    queryString += QStringLiteral(" LIMIT %1 OFFSET %2;").arg(lastIdx - firstIdx).arg(firstIdx);
-    db->execNow({queryString, boundParams, rowCallback});
+        if (static_cast<size_t>(page.size()) < pageSize) {
+            break;
+        }
+    }
 
-    return messages;
+    if (format == ExportFormat::json) {
+        writer.write(QByteArrayLiteral("\n]\n"));
+    }
+    return writer.finish();
 }
 
 QList<History::HistMessage> History::getUndeliveredMessagesForChat(const ChatId& chatId)
@@ -697,8 +1361,11 @@ QList<History::HistMessage> History::getUndeliveredMessagesForChat(const ChatId&
         return {};
     }
 
+    // Queued delivery state flips must hit the DB before we read it back
+    flushDeliveryStateCache();
+
     QList<History::HistMessage> ret;
-    auto rowCallback = [&chatId, &ret](const QVector<QVariant>& row) {
+    auto rowCallback = [this, &chatId, &ret](const QVector<QVariant>& row) {
         auto it = row.begin();
         // dispName and message could have null bytes, QString::fromUtf8
         // truncates on null bytes so we strip them
@@ -708,7 +1375,9 @@ QList<History::HistMessage> History::getUndeliveredMessagesForChat(const ChatId&
         auto isBroken = !(*it++).isNull();
         auto messageContent = (*it++).toString();
         auto senderKey = ToxPk{(*it++).toByteArray()};
-        auto displayName = QString::fromUtf8((*it++).toByteArray().replace('\0', ""));
+        auto displayName =
+            internDisplayName(peerNameCache, senderKey.getByteArray(),
+                              QString::fromUtf8((*it++).toByteArray().replace('\0', "")));
 
         MessageState messageState = getMessageState(isPending, isBroken);
 
@@ -732,7 +1401,7 @@ QList<History::HistMessage> History::getUndeliveredMessagesForChat(const ChatId&
         "JOIN faux_offline_pending ON faux_offline_pending.id = history.id "
         "LEFT JOIN broken_messages ON broken_messages.id = history.id "
         "WHERE history.chat_id = ");
-    QVector<QByteArray> boundParams;
+    QVector<RawDatabase::BindValue> boundParams;
     addChatIdSubQuery(queryString, boundParams, chatId);
     queryString += QStringLiteral(" AND history.message_type = 'T';");
     db->execNow({queryString, boundParams, rowCallback});
@@ -740,6 +1409,111 @@ QList<History::HistMessage> History::getUndeliveredMessagesForChat(const ChatId&
     return ret;
 }
 
+/**
+ * @brief Reads one page of past file transfers, newest first.
+ * @param direction Whether to list sent or received transfers.
+ * @param before Only rows older than this are returned. Pinning the upper
+ *               bound keeps the offsets stable while new transfers are being
+ *               added on top.
+ * @param offset Number of matching rows to skip.
+ * @param limit Maximum number of rows to return.
+ *
+ * Backs the lazily populated history rows of the Files window; paging keeps
+ * opening the window cheap no matter how many transfers are on record.
+ */
+QList<History::FileHistoryEntry> History::getFileTransferPage(ToxFile::FileDirection direction,
+                                                              const QDateTime& before,
+                                                              size_t offset, size_t limit)
+{
+    if (historyAccessBlocked()) {
+        return {};
+    }
+
+    QList<FileHistoryEntry> ret;
+    auto rowCallback = [&ret](const RawDatabase::Row& row) {
+        FileHistoryEntry entry;
+        entry.timestamp = QDateTime::fromMSecsSinceEpoch(row.int64Value(0));
+        entry.dispName = QString::fromUtf8(row.byteArrayValue(1).replace('\0', ""));
+        entry.fileName = row.stringValue(2);
+        entry.filePath = row.stringValue(3);
+        entry.size = row.int64Value(4);
+        entry.direction = static_cast<ToxFile::FileDirection>(row.int64Value(5));
+        entry.status = static_cast<ToxFile::FileStatus>(row.int64Value(6));
+        ret += entry;
+    };
+
+    db->execNow({QStringLiteral( //
+                     "SELECT\n"
+                     "    history.timestamp,\n"
+                     "    aliases.display_name,\n"
+                     "    file_transfers.file_name,\n"
+                     "    file_transfers.file_path,\n"
+                     "    file_transfers.file_size,\n"
+                     "    file_transfers.direction,\n"
+                     "    file_transfers.file_state\n"
+                     "FROM file_transfers "
+                     "JOIN history ON history.id = file_transfers.id "
+                     "LEFT JOIN aliases ON file_transfers.sender_alias = aliases.id "
+                     "WHERE file_transfers.direction = ? AND history.timestamp < ? "
+                     "ORDER BY file_transfers.id DESC LIMIT ? OFFSET ?;"),
+                 {static_cast<qint64>(direction), before.toMSecsSinceEpoch(),
+                  static_cast<qint64>(limit), static_cast<qint64>(offset)},
+                 rowCallback});
+
+    return ret;
+}
+
+/**
+ * @brief Finds text messages containing a phrase across every chat.
+ * @param phrase Substring to look for, matched case-insensitively.
+ * @param offset Number of matching rows to skip.
+ * @param limit Maximum number of rows to return.
+ *
+ * One batched scan instead of the per-jump queries of in-chat search; the
+ * results panel pages through this as the user scrolls.
+ */
+QList<History::GlobalSearchResult> History::searchAllChats(const QString& phrase, size_t offset,
+                                                           size_t limit)
+{
+    if (historyAccessBlocked()) {
+        return {};
+    }
+
+    QList<GlobalSearchResult> ret;
+    auto rowCallback = [&ret](const RawDatabase::Row& row) {
+        GlobalSearchResult result;
+        result.timestamp = QDateTime::fromMSecsSinceEpoch(row.int64Value(0));
+        result.chatUuid = row.byteArrayValue(1);
+        result.dispName = QString::fromUtf8(row.byteArrayValue(2).replace('\0', ""));
+        result.message = row.stringValue(3);
+        ret += result;
+    };
+
+    // Escape the LIKE wildcards so the phrase is matched literally
+    QString escaped = phrase;
+    escaped.replace(QLatin1Char('\\'), QLatin1String("\\\\"))
+        .replace(QLatin1Char('%'), QLatin1String("\\%"))
+        .replace(QLatin1Char('_'), QLatin1String("\\_"));
+
+    db->execNow({QStringLiteral( //
+                     "SELECT\n"
+                     "    history.timestamp,\n"
+                     "    chats.uuid,\n"
+                     "    aliases.display_name,\n"
+                     "    text_messages.message\n"
+                     "FROM text_messages "
+                     "JOIN history ON history.id = text_messages.id "
+                     "JOIN chats ON chats.id = history.chat_id "
+                     "LEFT JOIN aliases ON text_messages.sender_alias = aliases.id "
+                     "WHERE CAST(text_messages.message AS TEXT) LIKE ? ESCAPE '\\' "
+                     "ORDER BY history.id DESC LIMIT ? OFFSET ?;"),
+                 {(QLatin1Char('%') + escaped + QLatin1Char('%')).toUtf8(),
+                  static_cast<qint64>(limit), static_cast<qint64>(offset)},
+                 rowCallback});
+
+    return ret;
+}
+
 /**
  * @brief Search phrase in chat messages
  * @param chatId Chat ID
@@ -768,10 +1542,17 @@ QDateTime History::getDateWhereFindPhrase(const ChatId& chatId, const QDateTime&
     case FilterSearch::Register:
         message = QStringLiteral("text_messages.message LIKE '%%1%'").arg(phrase);
         break;
-    case FilterSearch::WordsOnly:
-        message = QStringLiteral("text_messages.message REGEXP '%1'")
-                      .arg(SearchExtraFunctions::generateFilterWordsOnly(phrase).toLower());
+    case FilterSearch::WordsOnly: {
+        // Whole-word, case-insensitive search maps directly onto the FTS5
+        // index: unicode61 tokenization is case folding and token-exact, so we
+        // can use an indexed phrase match instead of a full-table REGEXP scan.
+        QString ftsPhrase = phrase;
+        ftsPhrase.replace(QLatin1String("\""), QLatin1String("\"\""));
+        message = QStringLiteral("text_messages.id IN (SELECT rowid FROM text_messages_fts "
+                                 "WHERE text_messages_fts MATCH '\"%1\"')")
+                      .arg(ftsPhrase);
         break;
+    }
     case FilterSearch::RegisterAndWordsOnly:
         message = QStringLiteral("REGEXPSENSITIVE(text_messages.message, '%1')")
                       .arg(SearchExtraFunctions::generateFilterWordsOnly(phrase));
@@ -830,15 +1611,18 @@ QDateTime History::getDateWhereFindPhrase(const ChatId& chatId, const QDateTime&
             .arg(period),
         {chatId.getByteArray()}, rowCallback);
 
-    db->execNow(query);
+    // Search can scan the whole log; run it on the read lane so it doesn't
+    // stall message inserts and delivery updates
+    db->execNowReadOnly(query);
 
     return result;
 }
 
 /**
  * @brief Gets date boundaries in conversation with friendPk. History doesn't model conversation indexes,
- * but we can count messages between us and friendPk to effectively give us an index. This function
- * returns how many messages have happened between us <-> friendPk each time the date changes
+ * but the chat_day_index table records how many messages a chat had before the first message of
+ * each day, which is exactly the 0-indexed position callers treat as an index. This function
+ * returns that count for each date change starting at the given date
  * @param[in] chatId ChatId of conversation to retrieve
  * @param[in] from Start date to look from
  * @param[in] maxNum Maximum number of date boundaries to retrieve
@@ -864,34 +1648,23 @@ QList<History::DateIdx> History::getNumMessagesForChatBeforeDateBoundaries(const
         dateIdxs.append(dateIdx);
     };
 
-    // No guarantee that this is the most efficient way to do this...
-    // We want to count messages that happened for a friend before a
-    // certain date. We do this by re-joining our table a second time
-    // but this time with the only filter being that our id is less than
-    // the ID of the corresponding row in the table that is grouped by day
-    auto countMessagesForFriend = QStringLiteral(
-        "SELECT COUNT(*) - 1 "       // Count - 1 corresponds to 0 indexed message id for friend
-        "FROM history countHistory " // Import unfiltered table as countHistory
-        "JOIN chats ON chat_id = chats.id " // link chat_id to chat.id
-        "WHERE chats.uuid = ?"              // filter this conversation
-        "AND countHistory.id <= history.id" // and filter that our unfiltered table history id only has elements up to history.id
-    );
-
     auto limitString = (maxNum) ? QString("LIMIT %1").arg(maxNum) : QString("");
 
+    // chat_day_index stores the per-chat index of the first message of each
+    // day, maintained by an insert trigger, so this is a plain range scan
+    // over the primary key instead of a count per day boundary
     auto query = RawDatabase::Query( //
         QStringLiteral(              //
-            "SELECT (%1), (timestamp / 1000 / 60 / 60 / 24) AS day "
-            "FROM history "
+            "SELECT message_offset, day "
+            "FROM chat_day_index "
             "JOIN chats ON chat_id = chats.id "
             "WHERE chats.uuid = ? "
-            "AND timestamp >= %2 "
-            "GROUP by day "
-            "%3;")
-            .arg(countMessagesForFriend)
-            .arg(QDateTime(from.startOfDay()).toMSecsSinceEpoch())
+            "AND day >= %1 "
+            "ORDER BY day ASC "
+            "%2;")
+            .arg(QDateTime(from.startOfDay()).toMSecsSinceEpoch() / 1000 / 60 / 60 / 24)
             .arg(limitString),
-        {chatId.getByteArray(), chatId.getByteArray()}, rowCallback);
+        {chatId.getByteArray()}, rowCallback);
 
     db->execNow(query);
 
@@ -902,6 +1675,10 @@ QList<History::DateIdx> History::getNumMessagesForChatBeforeDateBoundaries(const
  * @brief Marks a message as delivered.
  * Removing message from the faux-offline pending messages list.
  *
+ * The removal goes through the write-behind cache, so a receipt storm after
+ * a reconnect costs one batched transaction per flush interval instead of
+ * one queued transaction per receipt.
+ *
  * @param id Message ID.
  */
 void History::markAsDelivered(RowId messageId)
@@ -910,7 +1687,74 @@ void History::markAsDelivered(RowId messageId)
         return;
     }
 
-    db->execLater(QStringLiteral("DELETE FROM faux_offline_pending WHERE id=%1;").arg(messageId.get()));
+    pendingDelivered.append(messageId);
+    scheduleDeliveryStateFlush();
+}
+
+void History::scheduleDeliveryStateFlush()
+{
+    if (!deliveryFlushTimer.isActive()) {
+        // The window is read per flush so tuning it applies hot
+        deliveryFlushTimer.start(settings.getDeliveryBatchWindowMs());
+    }
+}
+
+/**
+ * @brief Writes out all cached delivery/broken state flips in one transaction.
+ *
+ * Delivered ids are sorted and coalesced into BETWEEN ranges; receipts
+ * confirmed in a burst are mostly contiguous history rows, so 5k receipts
+ * typically become a handful of range deletes.
+ */
+void History::flushDeliveryStateCache()
+{
+    deliveryFlushTimer.stop();
+    if (pendingDelivered.isEmpty() && pendingBroken.isEmpty()) {
+        return;
+    }
+
+    QVector<RawDatabase::Query> queries;
+
+    if (!pendingDelivered.isEmpty()) {
+        std::sort(pendingDelivered.begin(), pendingDelivered.end(),
+                  [](RowId a, RowId b) { return a.get() < b.get(); });
+        int64_t rangeStart = pendingDelivered.first().get();
+        int64_t rangeEnd = rangeStart;
+        const auto addRange = [&queries](int64_t start, int64_t end) {
+            if (start == end) {
+                queries += RawDatabase::Query(
+                    QStringLiteral("DELETE FROM faux_offline_pending WHERE id=?;"), {start});
+            } else {
+                queries += RawDatabase::Query(
+                    QStringLiteral("DELETE FROM faux_offline_pending WHERE id BETWEEN ? AND ?;"),
+                    {start, end});
+            }
+        };
+        for (const RowId id : pendingDelivered) {
+            if (id.get() > rangeEnd + 1) {
+                addRange(rangeStart, rangeEnd);
+                rangeStart = id.get();
+            }
+            rangeEnd = id.get();
+        }
+        addRange(rangeStart, rangeEnd);
+        pendingDelivered.clear();
+    }
+
+    for (const PendingBroken& broken : pendingBroken) {
+        queries += RawDatabase::Query( //
+            QStringLiteral(            //
+                "DELETE FROM faux_offline_pending WHERE id=?;"),
+            {broken.id.get()});
+        queries += RawDatabase::Query( //
+            QStringLiteral(            //
+                "INSERT INTO broken_messages (id, reason) "
+                "VALUES (?, ?);"),
+            {broken.id.get(), static_cast<int64_t>(broken.reason)});
+    }
+    pendingBroken.clear();
+
+    db->execLater(queries);
 }
 
 /**
@@ -938,17 +1782,108 @@ void History::markAsBroken(RowId messageId, BrokenMessageReason reason)
         return;
     }
 
-    QVector<RawDatabase::Query> queries;
-    queries += RawDatabase::Query( //
-        QStringLiteral(            //
-            "DELETE FROM faux_offline_pending WHERE id=%1;")
-            .arg(messageId.get()));
-    queries += RawDatabase::Query( //
-        QStringLiteral(            //
-            "INSERT INTO broken_messages (id, reason) "
-            "VALUES (%1, %2);")
-            .arg(messageId.get())
-            .arg(static_cast<int64_t>(reason)));
+    pendingBroken.append({messageId, reason});
+    scheduleDeliveryStateFlush();
+}
 
-    db->execLater(queries);
+/**
+ * @brief Compacts and re-analyzes the database without closing it.
+ *
+ * Runs in slices on the database worker thread, interleaved with regular
+ * history traffic. Progress and completion are reported through
+ * maintenanceProgress and maintenanceFinished; both are emitted from the
+ * worker thread, so cross-thread connections apply.
+ */
+void History::startMaintenance()
+{
+    if (!isValid()) {
+        emit maintenanceFinished(false);
+        return;
+    }
+
+    db->runMaintenance([this](int percent) { emit maintenanceProgress(percent); },
+                       [this](bool success) { emit maintenanceFinished(success); });
+}
+
+/**
+ * @brief Verifies database integrity without closing the client.
+ *
+ * Runs sqlite's integrity_check plus application-level invariant checks
+ * (orphaned aliases, delivery markers pointing at missing messages) on a
+ * background pool thread. Every check goes through the read-only connection,
+ * so chat traffic on the database worker is never blocked; progress and the
+ * list of findings are reported through integrityCheckProgress and
+ * integrityCheckFinished, emitted from the pool thread.
+ */
+void History::startIntegrityCheck()
+{
+    if (!isValid()) {
+        emit integrityCheckFinished(QStringList{QStringLiteral("history database is not open")});
+        return;
+    }
+
+    if (integrityCheckActive.exchange(true)) {
+        qWarning() << "History integrity check is already running";
+        return;
+    }
+
+    // Each entry is one read-lane COUNT query; anything non-zero is a finding
+    struct InvariantCheck
+    {
+        const char* description;
+        const char* sql;
+    };
+    static constexpr InvariantCheck invariantChecks[] = {
+        {"aliases without an author row",
+         "SELECT COUNT(*) FROM aliases LEFT JOIN authors ON aliases.owner = authors.id "
+         "WHERE authors.id IS NULL;"},
+        {"text messages without a history row",
+         "SELECT COUNT(*) FROM text_messages LEFT JOIN history ON text_messages.id = history.id "
+         "WHERE history.id IS NULL;"},
+        {"file transfers without a history row",
+         "SELECT COUNT(*) FROM file_transfers LEFT JOIN history ON file_transfers.id = history.id "
+         "WHERE history.id IS NULL;"},
+        {"history rows missing their text message body",
+         "SELECT COUNT(*) FROM history LEFT JOIN text_messages ON history.id = text_messages.id "
+         "WHERE history.message_type = 'T' AND text_messages.id IS NULL;"},
+        {"pending delivery markers pointing at missing messages",
+         "SELECT COUNT(*) FROM faux_offline_pending LEFT JOIN history "
+         "ON faux_offline_pending.id = history.id WHERE history.id IS NULL;"},
+        {"broken message markers pointing at missing messages",
+         "SELECT COUNT(*) FROM broken_messages LEFT JOIN history "
+         "ON broken_messages.id = history.id WHERE history.id IS NULL;"},
+        // Loading such a message would trip the pending/broken assert in
+        // getMessageState, so catch the contradiction here instead
+        {"messages marked both pending and broken",
+         "SELECT COUNT(*) FROM faux_offline_pending JOIN broken_messages "
+         "ON faux_offline_pending.id = broken_messages.id;"},
+    };
+
+    // Keep the database alive even if the profile unloads mid-scan
+    auto self = shared_from_this();
+    WorkerPool::instance().runBackground([this, self] {
+        constexpr int numSteps = 1 + std::size(invariantChecks);
+        int step = 0;
+        QStringList findings = db->checkIntegrity();
+        emit integrityCheckProgress(100 * ++step / numSteps);
+
+        for (const InvariantCheck& check : invariantChecks) {
+            int64_t count = 0;
+            const bool ok = db->execNowReadOnly(RawDatabase::Query{
+                QString::fromUtf8(check.sql),
+                [&count](const QVector<QVariant>& row) { count = row[0].toLongLong(); }});
+            if (!ok) {
+                findings += QStringLiteral("could not check for %1").arg(check.description);
+            } else if (count > 0) {
+                findings += QStringLiteral("%1 %2").arg(count).arg(check.description);
+            }
+            emit integrityCheckProgress(100 * ++step / numSteps);
+        }
+
+        for (const QString& finding : findings) {
+            qWarning() << "History integrity check:" << finding;
+        }
+        integrityCheckActive.store(false, std::memory_order_release);
+        emit integrityCheckFinished(findings);
+    });
 }
@@ -8,8 +8,10 @@
 #include <QDateTime>
 #include <QHash>
 #include <QPointer>
+#include <QTimer>
 #include <QVector>
 
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <tox/toxencryptsave.h>
@@ -26,6 +28,7 @@ class HistoryKeeper;
 class Settings;
 class ChatId;
 class IMessageBoxManager;
+class QIODevice;
 
 enum class HistMessageContentType
 {
@@ -200,7 +203,49 @@ public:
         size_t numMessagesIn;
     };
 
+    // One text message matching a cross-chat phrase search, newest first;
+    // backs the search results panel
+    struct GlobalSearchResult
+    {
+        QDateTime timestamp;
+        QByteArray chatUuid;
+        QString dispName;
+        QString message;
+    };
+
+    // One finished row of the file_transfers table, as shown by the Files
+    // window when it pages through past transfers
+    struct FileHistoryEntry
+    {
+        QDateTime timestamp;
+        QString dispName;
+        QString fileName;
+        QString filePath;
+        qint64 size;
+        ToxFile::FileDirection direction;
+        ToxFile::FileStatus status;
+    };
+
+    // One hour's worth of text message activity in a chat, aggregated in
+    // SQL; seeds the debug statistics so they cover pre-launch history
+    struct HourlyChatActivity
+    {
+        qint64 hourSinceEpoch;
+        quint32 messageCount;
+        quint64 byteCount;
+    };
+
+    enum class ExportFormat
+    {
+        json,
+        csv,
+    };
+
 public:
+    // Page size used when streaming messages out of the database, chosen so a
+    // page stays comfortably below typical scrollback window sizes
+    static constexpr size_t defaultMessagePageSize = 256;
+
     History(std::shared_ptr<RawDatabase> db, Settings& settings, IMessageBoxManager& messageBoxManager);
     ~History();
 
@@ -222,23 +267,48 @@ public:
 
     void setFileFinished(const QByteArray& fileId, bool success, const QString& filePath,
                          const QByteArray& fileHash);
+    void setDraft(const ChatId& chatId, const QString& text);
+    QString getDraft(const ChatId& chatId);
     size_t getNumMessagesForChat(const ChatId& chatId);
     size_t getNumMessagesForChatBeforeDate(const ChatId& chatId, const QDateTime& date);
     QList<HistMessage> getMessagesForChat(const ChatId& chatId, size_t firstIdx, size_t lastIdx);
+    void streamMessagesForChat(const ChatId& chatId, size_t firstIdx, size_t lastIdx,
+                               const std::function<void(QList<HistMessage>)>& pageCallback,
+                               size_t pageSize = defaultMessagePageSize);
+    bool exportChat(const ChatId& chatId, QIODevice& output, ExportFormat format,
+                    size_t pageSize = defaultMessagePageSize);
     QList<HistMessage> getUndeliveredMessagesForChat(const ChatId& chatId);
+    QList<FileHistoryEntry> getFileTransferPage(ToxFile::FileDirection direction,
+                                                const QDateTime& before, size_t offset,
+                                                size_t limit);
+    QList<GlobalSearchResult> searchAllChats(const QString& phrase, size_t offset, size_t limit);
     QDateTime getDateWhereFindPhrase(const ChatId& chatId, const QDateTime& from, QString phrase,
                                      const ParameterSearch& parameter);
     QList<DateIdx> getNumMessagesForChatBeforeDateBoundaries(const ChatId& chatId,
                                                              const QDate& from, size_t maxNum);
+    QList<HourlyChatActivity> getChatActivityByHour(const ChatId& chatId, const QDateTime& before);
 
     void markAsDelivered(RowId messageId);
     void markAsBroken(RowId messageId, BrokenMessageReason reason);
 
+    void startMaintenance();
+    void startIntegrityCheck();
+
 signals:
     void fileInserted(RowId dbId, QByteArray fileId);
+    void authorIdResolved(QByteArray publicKey, int64_t rowId);
+    void chatIdResolved(QByteArray uuid, int64_t rowId);
+    void aliasIdResolved(QByteArray key, int64_t rowId);
+    void maintenanceProgress(int percent);
+    void maintenanceFinished(bool success);
+    void integrityCheckProgress(int percent);
+    void integrityCheckFinished(QStringList findings);
 
 private slots:
     void onFileInserted(RowId dbId, QByteArray fileId);
+    void onAuthorIdResolved(QByteArray publicKey, int64_t rowId);
+    void onChatIdResolved(QByteArray uuid, int64_t rowId);
+    void onAliasIdResolved(QByteArray key, int64_t rowId);
 
 private:
     QVector<RawDatabase::Query>
@@ -247,6 +317,9 @@ private:
     bool historyAccessBlocked();
     static RawDatabase::Query generateFileFinished(RowId fileId, bool success, const QString& filePath,
                                                    const QByteArray& fileHash);
+    void loadIdCaches();
+    void appendIdResolutionQueries(QVector<RawDatabase::Query>& queries, const ChatId& chatId,
+                                   const ToxPk* sender, const QString* dispName);
 
     std::shared_ptr<RawDatabase> db;
 
@@ -260,7 +333,38 @@ private:
         RowId fileId{-1};
     };
 
+    void scheduleDeliveryStateFlush();
+    void flushDeliveryStateCache();
+
     // This needs to be a shared pointer to avoid callback lifetime issues
     QHash<QByteArray, FileInfo> fileInfos;
+    // Write-behind cache for delivery state flips. A reconnect can confirm
+    // thousands of receipts in one burst; instead of one queued transaction
+    // per receipt, the ids collect here and are flushed as range-coalesced
+    // statements in a single transaction per flush interval.
+    QVector<RowId> pendingDelivered;
+    struct PendingBroken
+    {
+        RowId id;
+        BrokenMessageReason reason;
+    };
+    QVector<PendingBroken> pendingBroken;
+    QTimer deliveryFlushTimer;
+    // Last display name seen per sender public key, used to intern the name
+    // QStrings of loaded messages so repeated rows share one buffer
+    QHash<QByteArray, QString> peerNameCache;
+    // Row ids of the authors and chats tables, preloaded in one query each
+    // and kept write-through, so inserts bind the id directly instead of
+    // running an INSERT OR IGNORE plus subselect per message
+    QHash<QByteArray, int64_t> authorIdCache;
+    QHash<QByteArray, int64_t> chatIdCache;
+    // Alias row ids keyed by sender public key + display name. A conference
+    // rejoin can flood in thousands of messages from a handful of senders;
+    // with the pair cached each message is two plain inserts with integer
+    // binds, with no alias upsert or subselect left on the append path
+    QHash<QByteArray, int64_t> aliasIdCache;
+    // Guards against a second integrity scan being started while one is
+    // still walking the database on a pool thread
+    std::atomic_bool integrityCheckActive{false};
     Settings& settings;
 };
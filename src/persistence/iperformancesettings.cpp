@@ -0,0 +1,7 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "iperformancesettings.h"
+
+IPerformanceSettings::~IPerformanceSettings() = default;
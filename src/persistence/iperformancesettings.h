@@ -0,0 +1,42 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include "util/interface.h"
+
+/**
+ * @brief Runtime knobs for the caches, pools and batching windows.
+ *
+ * Everything here applies hot: consumers either read the current value on
+ * each use or subscribe to the change signals, so deployments can be tuned
+ * from the Advanced settings tab without a restart. A thread count of 0
+ * means "size automatically from the core count".
+ */
+class IPerformanceSettings
+{
+public:
+    virtual ~IPerformanceSettings();
+
+    virtual int getImageCacheBudgetMiB() const = 0;
+    virtual void setImageCacheBudgetMiB(int budgetMiB) = 0;
+
+    virtual int getInteractivePoolThreads() const = 0;
+    virtual void setInteractivePoolThreads(int threads) = 0;
+
+    virtual int getBackgroundPoolThreads() const = 0;
+    virtual void setBackgroundPoolThreads(int threads) = 0;
+
+    virtual int getDeliveryBatchWindowMs() const = 0;
+    virtual void setDeliveryBatchWindowMs(int windowMs) = 0;
+
+    virtual int getScrollbackPrefetchLeadMs() const = 0;
+    virtual void setScrollbackPrefetchLeadMs(int leadMs) = 0;
+
+    DECLARE_SIGNAL(imageCacheBudgetChanged, int budgetMiB);
+    DECLARE_SIGNAL(interactivePoolThreadsChanged, int threads);
+    DECLARE_SIGNAL(backgroundPoolThreadsChanged, int threads);
+    DECLARE_SIGNAL(deliveryBatchWindowChanged, int windowMs);
+    DECLARE_SIGNAL(scrollbackPrefetchLeadChanged, int leadMs);
+};
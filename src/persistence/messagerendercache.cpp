@@ -0,0 +1,105 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "messagerendercache.h"
+
+#include <QDebug>
+
+/**
+ * @class MessageRenderCache
+ * @brief Persistent cache of formatted message HTML, keyed by content hash.
+ *
+ * Reopening a chat used to re-run the whole formatter chain (smiley
+ * substitution, quote detection, URI highlighting, markdown) over the same
+ * unchanged history every session. ChatMessage::createChatMessage now keys
+ * its formatter output by a hash of the message and the settings that feed
+ * the formatting, and parks it here; warm chat opens skip the parsing
+ * entirely.
+ *
+ * The rows live in a render_cache side table in the profile database, so
+ * cached message text is exactly as protected as the history it came from.
+ * Like connection_quality, the table is created on demand and stays outside
+ * the message schema versioning: it is droppable cache data with no
+ * migration path. The whole table is loaded into memory when the profile
+ * opens, so lookups during rendering never touch the database thread.
+ *
+ * All methods must be called from the GUI thread.
+ */
+
+MessageRenderCache& MessageRenderCache::instance()
+{
+    static MessageRenderCache cache;
+    return cache;
+}
+
+/**
+ * @brief Attaches the profile database and loads the cached rows.
+ */
+void MessageRenderCache::setDatabase(std::shared_ptr<RawDatabase> db_)
+{
+    entries.clear();
+    db = db_;
+    if (!db || !db->isOpen()) {
+        db.reset();
+        return;
+    }
+
+    db->execNow(
+        QStringLiteral("CREATE TABLE IF NOT EXISTS render_cache "
+                       "(id INTEGER PRIMARY KEY, key BLOB UNIQUE NOT NULL, html BLOB NOT NULL);"));
+
+    // Newest rows win so a freshly warmed cache survives the trim below
+    db->execNow(RawDatabase::Query(
+        QStringLiteral("SELECT key, html FROM render_cache ORDER BY id DESC LIMIT %1;")
+            .arg(maxEntries),
+        [this](const RawDatabase::Row& row) {
+            entries.insert(row.byteArrayValue(0),
+                           QString::fromUtf8(row.byteArrayValue(1)));
+        }));
+
+    // Drop whatever fell outside the window; the subselect yields NULL (and
+    // the DELETE matches nothing) while the table is still small
+    db->execLater(RawDatabase::Query(
+        QStringLiteral("DELETE FROM render_cache WHERE id <= "
+                       "(SELECT id FROM render_cache ORDER BY id DESC LIMIT 1 OFFSET %1);")
+            .arg(maxEntries)));
+
+    qDebug() << "Loaded" << entries.size() << "pre-rendered messages";
+}
+
+/**
+ * @brief Detaches from the database on profile unload.
+ */
+void MessageRenderCache::clearDatabase()
+{
+    entries.clear();
+    db.reset();
+}
+
+/**
+ * @brief Returns the cached HTML for the key, or a null QString on a miss.
+ */
+QString MessageRenderCache::lookup(const QByteArray& key) const
+{
+    const auto it = entries.constFind(key);
+    return it != entries.constEnd() ? *it : QString();
+}
+
+/**
+ * @brief Caches freshly formatted HTML and queues the write-through.
+ */
+void MessageRenderCache::store(const QByteArray& key, const QString& html)
+{
+    entries.insert(key, html);
+
+    if (!db) {
+        return;
+    }
+
+    // Coalesced with neighbouring inserts into one transaction, so warming a
+    // whole chat window costs one commit instead of one per message
+    db->execLaterCoalesced(RawDatabase::Query(
+        QStringLiteral("INSERT OR REPLACE INTO render_cache (key, html) VALUES (?, ?);"),
+        {key, html.toUtf8()}));
+}
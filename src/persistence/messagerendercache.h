@@ -0,0 +1,35 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include "src/persistence/db/rawdatabase.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+#include <memory>
+
+class MessageRenderCache
+{
+public:
+    // Upper bound on cached rows; at typical message sizes this is a few MB
+    // of HTML, enough to cover the windows of every recently opened chat
+    static constexpr int maxEntries = 8192;
+
+    static MessageRenderCache& instance();
+
+    void setDatabase(std::shared_ptr<RawDatabase> db_);
+    void clearDatabase();
+
+    QString lookup(const QByteArray& key) const;
+    void store(const QByteArray& key, const QString& html);
+
+private:
+    MessageRenderCache() = default;
+
+    QHash<QByteArray, QString> entries;
+    std::shared_ptr<RawDatabase> db;
+};
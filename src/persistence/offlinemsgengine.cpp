@@ -22,8 +22,17 @@
  */
 void OfflineMsgEngine::onReceiptReceived(ReceiptNum receipt)
 {
-    QMutexLocker<QRecursiveMutex> ml(&mutex);
-    receiptResolver.notifyReceiptReceived(receipt);
+    CompletionFn completion;
+    {
+        QMutexLocker<QRecursiveMutex> ml(&mutex);
+        completion = receiptResolver.notifyReceiptReceived(receipt);
+    }
+
+    // Completion callbacks reach into the chat log; run them without holding
+    // the mutex so they can't block message submission
+    if (completion) {
+        completion(true);
+    }
 }
 
 /**
@@ -39,7 +48,7 @@ void OfflineMsgEngine::addUnsentMessage(const Message& message, CompletionFn com
 {
     QMutexLocker<QRecursiveMutex> ml(&mutex);
     unsentMessages.push_back(
-        OfflineMessage{message, std::chrono::steady_clock::now(), completionCallback});
+        OfflineMessage{message, std::chrono::steady_clock::now(), std::move(completionCallback)});
 }
 
 /**
@@ -55,9 +64,17 @@ void OfflineMsgEngine::addUnsentMessage(const Message& message, CompletionFn com
 void OfflineMsgEngine::addSentCoreMessage(ReceiptNum receipt, const Message& message,
                                           CompletionFn completionCallback)
 {
-    QMutexLocker<QRecursiveMutex> ml(&mutex);
-    receiptResolver.notifyMessageSent(receipt, {message, std::chrono::steady_clock::now(),
-                                                completionCallback});
+    CompletionFn completion;
+    {
+        QMutexLocker<QRecursiveMutex> ml(&mutex);
+        completion = receiptResolver.notifyMessageSent(receipt,
+                                                       {message, std::chrono::steady_clock::now(),
+                                                        std::move(completionCallback)});
+    }
+
+    if (completion) {
+        completion(true);
+    }
 }
 
 /**
@@ -80,9 +97,10 @@ std::vector<OfflineMsgEngine::RemovedMessage> OfflineMsgEngine::removeAllMessage
     auto ret = std::vector<RemovedMessage>();
     ret.reserve(messages.size());
 
-    std::transform(messages.begin(), messages.end(), std::back_inserter(ret),
-                   [](const OfflineMessage& msg) {
-                       return RemovedMessage{msg.message, msg.completionFn};
+    std::transform(std::make_move_iterator(messages.begin()),
+                   std::make_move_iterator(messages.end()), std::back_inserter(ret),
+                   [](OfflineMessage&& msg) {
+                       return RemovedMessage{std::move(msg.message), std::move(msg.completionFn)};
                    });
 
     return ret;
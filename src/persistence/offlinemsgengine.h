@@ -11,7 +11,7 @@
 #include "src/persistence/db/rawdatabase.h"
 
 #include <QDateTime>
-#include <QMap>
+#include <QHash>
 #include <QMutex>
 #include <QObject>
 #include <QSet>
@@ -21,6 +21,10 @@ class OfflineMsgEngine : public QObject
 {
     Q_OBJECT
 public:
+    // Kept small on purpose: the dispatcher's callback captures only a pointer
+    // and a message id, which fits std::function's small-object buffer, and the
+    // engine moves rather than copies it, so tracking a sent message allocates
+    // nothing beyond its hash-table slot.
     using CompletionFn = std::function<void(bool)>;
     OfflineMsgEngine() = default;
     void addUnsentMessage(const Message& message, CompletionFn completionCallback);
@@ -47,52 +51,57 @@ private:
 
     QRecursiveMutex mutex;
 
+    /**
+     * Both directions are hash-indexed so matching stays linear when a large
+     * offline queue is flushed on reconnect. Resolved completion callbacks are
+     * returned to the caller instead of being invoked here, so they can run
+     * after the engine's mutex is released and don't block message submission.
+     */
     template <class ReceiptT>
     class ReceiptResolver
     {
     public:
-        void notifyMessageSent(ReceiptT receipt, const OfflineMessage& message)
+        CompletionFn notifyMessageSent(ReceiptT receipt, OfflineMessage message)
         {
-            auto receivedReceiptIt =
-                std::find(receivedReceipts.begin(), receivedReceipts.end(), receipt);
+            const auto receivedReceiptIt = receivedReceipts.constFind(receipt);
 
-            if (receivedReceiptIt != receivedReceipts.end()) {
+            if (receivedReceiptIt != receivedReceipts.constEnd()) {
                 receivedReceipts.erase(receivedReceiptIt);
-                message.completionFn(true);
-                return;
+                return std::move(message.completionFn);
             }
 
-            unAckedMessages[receipt] = message;
+            unAckedMessages.insert(receipt, std::move(message));
+            return {};
         }
 
-        void notifyReceiptReceived(ReceiptT receipt)
+        CompletionFn notifyReceiptReceived(ReceiptT receipt)
         {
-            auto unAckedMessageIt = unAckedMessages.find(receipt);
+            const auto unAckedMessageIt = unAckedMessages.find(receipt);
             if (unAckedMessageIt != unAckedMessages.end()) {
-                unAckedMessageIt->second.completionFn(true);
+                auto completionFn = std::move(unAckedMessageIt->completionFn);
                 unAckedMessages.erase(unAckedMessageIt);
-                return;
+                return completionFn;
             }
 
-            receivedReceipts.push_back(receipt);
+            receivedReceipts.insert(receipt);
+            return {};
         }
 
         std::vector<OfflineMessage> clear()
         {
             auto ret = std::vector<OfflineMessage>();
+            ret.reserve(unAckedMessages.size());
             std::transform(std::make_move_iterator(unAckedMessages.begin()),
                            std::make_move_iterator(unAckedMessages.end()), std::back_inserter(ret),
-                           [](const std::pair<ReceiptT, OfflineMessage>& pair) {
-                               return std::move(pair.second);
-                           });
+                           [](OfflineMessage&& message) { return std::move(message); });
 
             receivedReceipts.clear();
             unAckedMessages.clear();
             return ret;
         }
 
-        std::vector<ReceiptT> receivedReceipts;
-        std::map<ReceiptT, OfflineMessage> unAckedMessages;
+        QSet<ReceiptT> receivedReceipts;
+        QHash<ReceiptT, OfflineMessage> unAckedMessages;
     };
 
     ReceiptResolver<ReceiptNum> receiptResolver;
@@ -369,4 +369,11 @@ QString Paths::getBackupUserNodesFilePath() const
     return dir.filePath(nodesFileName);
 }
 
+QString Paths::getNodesRttFilePath() const
+{
+    QDir dir(getSettingsDirPath());
+    constexpr static char nodesFileName[] = "bootstrapNodes.rtt.json";
+    return dir.filePath(nodesFileName);
+}
+
 #endif // PATHS_VERSION_TCS_COMPLIANT
@@ -41,6 +41,7 @@ public:
     QString getExampleNodesFilePath() const;
     QString getUserNodesFilePath() const;
     QString getBackupUserNodesFilePath() const;
+    QString getNodesRttFilePath() const;
 #endif
 
 private:
@@ -4,12 +4,18 @@
  */
 
 #include <QBuffer>
+#include <QCryptographicHash>
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
+#include <QFuture>
+#include <QImage>
+#include <QMutexLocker>
 #include <QObject>
 #include <QSaveFile>
+#include <QSet>
 #include <QThread>
+#include <QtConcurrent/QtConcurrentMap>
 
 #include <cassert>
 #include <sodium.h>
@@ -23,6 +29,9 @@
 #include "src/net/avatarbroadcaster.h"
 #include "src/net/bootstrapnodeupdater.h"
 #include "src/nexus.h"
+#include "src/persistence/messagerendercache.h"
+#include "src/startuptracer.h"
+#include "src/workerpool.h"
 #include "src/widget/tool/identicon.h"
 #include "src/widget/tool/imessageboxmanager.h"
 #include "src/widget/widget.h"
@@ -215,8 +224,7 @@ bool logCreateToxDataError(const CreateToxDataError& error, const QString& userN
 
 QStringList Profile::profiles;
 
-void Profile::initCore(const QByteArray& toxSave, Settings& s, bool isNewProfile,
-                       CameraSource& cameraSource)
+void Profile::initCore(const QByteArray& toxSave, Settings& s, bool isNewProfile)
 {
     if (toxSave.isEmpty() && !isNewProfile) {
         qCritical() << "Existing toxSave is empty";
@@ -248,7 +256,17 @@ void Profile::initCore(const QByteArray& toxSave, Settings& s, bool isNewProfile
         qDebug() << "Failed to start Toxcore";
         return;
     }
+}
 
+/**
+ * @brief Second half of Core startup: AV setup and Core signal wiring.
+ *
+ * Requires initCore() to have produced a Core. Doesn't touch the database or
+ * the GUI, so loadProfile()/createProfile() run it concurrently with the
+ * history open.
+ */
+void Profile::initCoreAv(Settings& s, bool isNewProfile, CameraSource& cameraSource)
+{
     coreAv = CoreAV::makeCoreAV(core->getTox(), core->getCoreLoopLock(), s, s, cameraSource);
     if (!coreAv) {
         qDebug() << "Failed to start ToxAV";
@@ -286,6 +304,10 @@ Profile::Profile(const QString& name_, std::unique_ptr<ToxEncrypt> passkey_, Pat
     , paths{paths_}
     , settings{settings_}
 {
+    // Empty avatars render as identicons or a placeholder depending on this
+    // setting, so cached pixmaps go stale when it flips
+    connect(&settings, &Settings::showIdenticonsChanged, this,
+            [this] { avatarCache.clear(); });
 }
 
 /**
@@ -300,6 +322,7 @@ Profile* Profile::loadProfile(const QString& name, const QString& password, Sett
                               const QCommandLineParser* parser, CameraSource& cameraSource,
                               IMessageBoxManager& messageBoxManager)
 {
+    StartupTracer::Scope scope{"profileLoad"};
     if (ProfileLocker::hasLock()) {
         qCritical().nospace() << "Tried to load profile " << name
                               << ", but another profile is already locked";
@@ -327,8 +350,19 @@ Profile* Profile::loadProfile(const QString& name, const QString& password, Sett
     constexpr bool isNewProfile = false;
     settings.updateProfileData(p, parser, isNewProfile);
 
-    p->initCore(toxSave, settings, isNewProfile, cameraSource);
-    p->loadDatabase(password, messageBoxManager);
+    p->initCore(toxSave, settings, isNewProfile);
+    if (p->core) {
+        // The database open derives the encryption key (an expensive KDF) and
+        // runs schema upgrades; it only needs the self public key from the
+        // freshly started toxcore, not the AV setup. Run the AV leg on the
+        // pool meanwhile — it never calls back into this thread, so waiting
+        // on it can't deadlock, while history error dialogs still show from
+        // this thread as before.
+        QFuture<void> avFuture = WorkerPool::instance().runInteractive(
+            [p, &settings, &cameraSource] { p->initCoreAv(settings, isNewProfile, cameraSource); });
+        p->loadDatabase(password, messageBoxManager);
+        avFuture.waitForFinished();
+    }
 
     return p;
 }
@@ -360,8 +394,14 @@ Profile* Profile::createProfile(const QString& name, const QString& password, Se
     constexpr bool isNewProfile = true;
     settings.updateProfileData(p, parser, isNewProfile);
 
-    p->initCore(QByteArray(), settings, isNewProfile, cameraSource);
-    p->loadDatabase(password, messageBoxManager);
+    p->initCore(QByteArray(), settings, isNewProfile);
+    if (p->core) {
+        // Same overlap as in loadProfile()
+        QFuture<void> avFuture = WorkerPool::instance().runInteractive(
+            [p, &settings, &cameraSource] { p->initCoreAv(settings, isNewProfile, cameraSource); });
+        p->loadDatabase(password, messageBoxManager);
+        avFuture.waitForFinished();
+    }
     return p;
 }
 
@@ -372,6 +412,7 @@ void Profile::save()
     }
 
     onSaveToxSave();
+    flushToxSave();
     settings.savePersonal();
     settings.sync();
     ProfileLocker::assertLock(paths);
@@ -379,26 +420,14 @@ void Profile::save()
     ProfileLocker::unlock();
 }
 
-Profile::~Profile() = default;
-
 /**
- * @brief Lists all the files in the config dir with a given extension
- * @param extension Raw extension, e.g. "jpeg" not ".jpeg".
- * @return Vector of filenames.
+ * @brief Waits for a tox save write still running on the thread pool; it
+ *        touches members, so it must not outlive the profile.
  */
-QStringList Profile::getFilesByExt(QString extension, Paths& paths)
+Profile::~Profile()
 {
-    QDir dir(paths.getSettingsDirPath());
-    QStringList out;
-    dir.setFilter(QDir::Files | QDir::NoDotAndDotDot);
-    dir.setNameFilters(QStringList("*." + extension));
-    QFileInfoList list = dir.entryInfoList();
-    out.reserve(list.size());
-    for (QFileInfo file : list) {
-        out += file.completeBaseName();
-    }
-
-    return out;
+    MessageRenderCache::instance().clearDatabase();
+    flushToxSave();
 }
 
 /**
@@ -408,7 +437,24 @@ QStringList Profile::getFilesByExt(QString extension, Paths& paths)
 const QStringList Profile::getAllProfileNames(Paths& paths)
 {
     profiles.clear();
-    QStringList toxFiles = getFilesByExt("tox", paths), iniFiles = getFilesByExt("ini", paths);
+
+    // One directory listing covers both extensions; listing the settings dir
+    // separately per extension doubled the stat traffic on the login screen
+    QDir dir(paths.getSettingsDirPath());
+    dir.setFilter(QDir::Files | QDir::NoDotAndDotDot);
+    dir.setNameFilters({QStringLiteral("*.tox"), QStringLiteral("*.ini")});
+
+    QStringList toxFiles;
+    QSet<QString> iniFiles;
+    const QFileInfoList list = dir.entryInfoList();
+    for (const QFileInfo& file : list) {
+        if (file.suffix() == QLatin1String("tox")) {
+            toxFiles += file.completeBaseName();
+        } else {
+            iniFiles += file.completeBaseName();
+        }
+    }
+
     for (const QString& toxFile : toxFiles) {
         if (!iniFiles.contains(toxFile)) {
             Settings::createPersonal(paths, toxFile);
@@ -438,6 +484,11 @@ void Profile::startCore()
 {
     // kriby: code duplication belongs in initCore, but cannot yet due to Core/Profile coupling
     connect(core.get(), &Core::requestSent, this, &Profile::onRequestSent);
+    // Connected here rather than in loadDatabase(), which runs concurrently
+    // with the AV setup and may not see coreAv yet
+    if (coreAv && connectionQualityLog) {
+        connect(coreAv.get(), &CoreAV::callQualitySampled, this, &Profile::onCallQualitySampled);
+    }
     emit coreChanged(*core);
 
     core->start();
@@ -461,7 +512,67 @@ void Profile::onSaveToxSave()
 {
     QByteArray data = core->getToxSaveData();
     assert(data.size());
-    saveToxSave(data);
+    scheduleToxSave(std::move(data));
+}
+
+/**
+ * @brief Hands a savedata snapshot to the async writer.
+ * @param data Plaintext snapshot of the tox save.
+ *
+ * Snapshots identical to the last written one are dropped, so periodic save
+ * requests with no state change cost a hash instead of an encrypt and a write.
+ * If a write is already in flight the snapshot is parked and picked up by the
+ * running task; a newer snapshot simply replaces a parked one.
+ */
+void Profile::scheduleToxSave(QByteArray data)
+{
+    const QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha256);
+    const QMutexLocker<QMutex> locker{&toxSaveMutex};
+    if (hash == lastToxSaveHash) {
+        qDebug() << "Tox save unchanged, skipping write";
+        return;
+    }
+    lastToxSaveHash = hash;
+
+    if (toxSaveInFlight) {
+        pendingToxSave = std::move(data);
+        return;
+    }
+    launchToxSaveWrite(std::move(data));
+}
+
+/**
+ * @brief Starts a thread pool task that writes snapshots until none are parked.
+ * @param data First snapshot to write.
+ * @note The caller must hold toxSaveMutex.
+ */
+void Profile::launchToxSaveWrite(QByteArray data)
+{
+    toxSaveInFlight = true;
+    toxSaveFuture = WorkerPool::instance().runBackground([this, data = std::move(data)]() mutable {
+        forever {
+            saveToxSave(data);
+
+            const QMutexLocker<QMutex> locker{&toxSaveMutex};
+            if (pendingToxSave.isNull()) {
+                toxSaveInFlight = false;
+                return;
+            }
+            data = std::move(pendingToxSave);
+            pendingToxSave = QByteArray{};
+        }
+    });
+}
+
+/**
+ * @brief Blocks until the async writer has drained every queued snapshot.
+ *
+ * Needed before unlocking the profile at shutdown and before swapping the
+ * passkey, both of which would pull state out from under a running write.
+ */
+void Profile::flushToxSave()
+{
+    toxSaveFuture.waitForFinished();
 }
 
 // TODO(sudden6): handle this better maybe?
@@ -478,6 +589,8 @@ void Profile::onAvatarOfferReceived(uint32_t friendId, uint32_t fileId,
  * @param data Byte array of profile save.
  * @return true if successfully saved, false otherwise
  * @warning Invalid on deleted profiles.
+ * @note Runs on the thread pool; QSaveFile commits with an atomic rename, so a
+ *       crash mid-write never clobbers the previous save.
  */
 bool Profile::saveToxSave(QByteArray data)
 {
@@ -560,12 +673,22 @@ QPixmap Profile::loadAvatar()
  */
 QPixmap Profile::loadAvatar(const ToxPk& owner)
 {
+    // Serve repeat lookups from the decoded-pixmap cache: reading, decrypting
+    // and PNG-decoding the file on every call made avatar-heavy paths (friend
+    // list updates, notifications) redo the same work per event. QPixmap is
+    // implicitly shared, so hits are just a refcount bump.
+    const QByteArray ownerBytes = owner.getByteArray();
+    const auto cached = avatarCache.constFind(ownerBytes);
+    if (cached != avatarCache.constEnd()) {
+        return cached.value();
+    }
+
     QPixmap pic;
     if (settings.getShowIdenticons()) {
 
         const QByteArray avatarData = loadAvatarData(owner);
         if (avatarData.isEmpty()) {
-            pic = QPixmap::fromImage(Identicon(owner.getByteArray()).toImage(16));
+            pic = identiconPixmap(owner, 16);
         } else {
             pic.loadFromData(avatarData);
         }
@@ -574,9 +697,87 @@ QPixmap Profile::loadAvatar(const ToxPk& owner)
         pic.loadFromData(loadAvatarData(owner));
     }
 
+    avatarCache.insert(ownerBytes, pic);
     return pic;
 }
 
+/**
+ * @brief Decodes a batch of contact avatars in parallel and commits them to the cache.
+ *
+ * One avatar decodes quickly, but a roster of hundreds decoded one by one on
+ * the GUI thread kept avatars on the startup critical path. The file read,
+ * decryption and PNG decode fan out across the interactive worker pool as
+ * QImage work - QPixmap must stay on the GUI thread - and the results are
+ * converted and committed to the avatar cache in a single pass here. After
+ * this, loadAvatar() for each owner is a cache hit.
+ *
+ * @param owners Contacts to warm the avatar cache for.
+ */
+void Profile::preloadAvatars(const QList<ToxPk>& owners)
+{
+    struct Job
+    {
+        ToxPk owner;
+        QByteArray data;
+        QImage image;
+    };
+
+    std::vector<Job> jobs;
+    for (const ToxPk& owner : owners) {
+        if (!avatarCache.contains(owner.getByteArray())) {
+            jobs.push_back(Job{owner, {}, {}});
+        }
+    }
+
+    if (jobs.empty()) {
+        return;
+    }
+
+    QtConcurrent::blockingMap(&WorkerPool::instance().interactive(), jobs, [this](Job& job) {
+        job.data = loadAvatarData(job.owner);
+        if (!job.data.isEmpty()) {
+            job.image = QImage::fromData(job.data);
+        }
+    });
+
+    // Mirror loadAvatar(): identicons only stand in when no avatar file
+    // exists, not when one fails to decode
+    const bool identicons = settings.getShowIdenticons();
+    for (Job& job : jobs) {
+        QPixmap pic;
+        if (!job.image.isNull()) {
+            pic = QPixmap::fromImage(std::move(job.image));
+        } else if (identicons && job.data.isEmpty()) {
+            pic = identiconPixmap(job.owner, 16);
+        }
+        avatarCache.insert(job.owner.getByteArray(), pic);
+    }
+}
+
+/**
+ * @brief Gets the identicon for a public key, generating it at most once.
+ *
+ * The hash-to-color and hash-to-pixel derivation plus the repaint run only on
+ * the first request per key and scale factor; afterwards hits are a refcount
+ * bump on the implicitly shared QPixmap.
+ *
+ * @param owner Public key to visualize.
+ * @param scaleFactor Forwarded to Identicon::toImage().
+ * @return The identicon as QPixmap.
+ */
+QPixmap Profile::identiconPixmap(const ToxPk& owner, int scaleFactor)
+{
+    const auto key = qMakePair(owner.getByteArray(), scaleFactor);
+    const auto cached = identiconCache.constFind(key);
+    if (cached != identiconCache.constEnd()) {
+        return cached.value();
+    }
+
+    const QPixmap pixmap = QPixmap::fromImage(Identicon(owner.getByteArray()).toImage(scaleFactor));
+    identiconCache.insert(key, pixmap);
+    return pixmap;
+}
+
 /**
  * @brief Get a contact's avatar from cache.
  * @param owner Friend PK to load avatar.
@@ -630,6 +831,8 @@ void Profile::loadDatabase(QString password, IMessageBoxManager& messageBoxManag
     database = std::make_shared<RawDatabase>(getDbPath(name, settings.getPaths()), password, salt);
     if (database && database->isOpen()) {
         history.reset(new History(database, settings, messageBoxManager));
+        connectionQualityLog.reset(new ConnectionQualityLog(database));
+        MessageRenderCache::instance().setDatabase(database);
     } else {
         qWarning() << "Failed to open database for profile" << name;
         messageBoxManager
@@ -652,9 +855,7 @@ void Profile::setAvatar(QByteArray pic)
         avatarData = pic;
     } else {
         if (settings.getShowIdenticons()) {
-            const QImage identicon = Identicon(selfPk.getByteArray()).toImage(32);
-            pixmap = QPixmap::fromImage(identicon);
-
+            pixmap = identiconPixmap(selfPk, 32);
         } else {
             pixmap.load(":/img/contact_dark.svg");
         }
@@ -682,8 +883,7 @@ void Profile::setFriendAvatar(const ToxPk& owner, QByteArray pic)
         avatarData = pic;
         emit friendAvatarSet(owner, pixmap);
     } else if (settings.getShowIdenticons()) {
-        const QImage identicon = Identicon(owner.getByteArray()).toImage(32);
-        pixmap = QPixmap::fromImage(identicon);
+        pixmap = identiconPixmap(owner, 32);
         emit friendAvatarSet(owner, pixmap);
     } else {
         pixmap.load(":/img/contact_dark.svg");
@@ -718,6 +918,10 @@ void Profile::onRequestSent(const ToxPk& friendPk, const QString& message)
  */
 void Profile::saveAvatar(const ToxPk& owner, const QByteArray& avatar)
 {
+    // Every avatar change funnels through here, making it the one
+    // invalidation point for the decoded-pixmap cache
+    avatarCache.remove(owner.getByteArray());
+
     const bool needEncrypt = encrypted && !avatar.isEmpty();
     const QByteArray& pic = needEncrypt ? passkey->encrypt(avatar) : avatar;
 
@@ -785,6 +989,30 @@ History* Profile::getHistory()
     return history.get();
 }
 
+/**
+ * @brief Get the call quality log.
+ * @return May return a nullptr if the database failed to load.
+ */
+ConnectionQualityLog* Profile::getConnectionQualityLog()
+{
+    return connectionQualityLog.get();
+}
+
+/**
+ * @brief Persists a quality sample CoreAV took during a call.
+ */
+void Profile::onCallQualitySampled(uint32_t friendId, quint32 audioBitrate, quint32 videoBitrate,
+                                   quint32 droppedFrames)
+{
+    if (!connectionQualityLog) {
+        return;
+    }
+
+    const ConnectionQualityLog::Sample sample{QDateTime::currentDateTime(), audioBitrate,
+                                              videoBitrate, droppedFrames};
+    connectionQualityLog->addSample(core->getFriendPublicKey(friendId), sample);
+}
+
 /**
  * @brief Removes a cached avatar.
  * @param owner Friend PK whose avatar to delete.
@@ -879,6 +1107,7 @@ QStringList Profile::remove()
         qWarning() << "Could not remove file" << dbPath;
     }
 
+    MessageRenderCache::instance().clearDatabase();
     history.reset();
     database.reset();
 
@@ -929,6 +1158,10 @@ const ToxEncrypt* Profile::getPasskey() const
  */
 QString Profile::setPassword(const QString& newPassword)
 {
+    // An async write may still be using the old passkey; let it finish before
+    // swapping the key out from under it
+    flushToxSave();
+
     if (newPassword.isEmpty()) {
         // remove password
         encrypted = false;
@@ -945,8 +1178,14 @@ QString Profile::setPassword(const QString& newPassword)
         encrypted = true;
     }
 
-    // apply new encryption
+    // apply new encryption; the plaintext is unchanged, so defeat the
+    // change-detection to force a re-encrypted write and wait for it
+    {
+        const QMutexLocker<QMutex> locker{&toxSaveMutex};
+        lastToxSaveHash.clear();
+    }
     onSaveToxSave();
+    flushToxSave();
 
     bool dbSuccess = false;
 
@@ -9,9 +9,14 @@
 #include "src/core/toxencrypt.h"
 #include "src/net/avatarbroadcaster.h"
 #include "src/net/bootstrapnodeupdater.h"
+#include "src/persistence/connectionqualitylog.h"
 #include "src/persistence/history.h"
 
 #include <QByteArray>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
 #include <QObject>
 #include <QPixmap>
 #include <QString>
@@ -50,6 +55,7 @@ public:
 
     QPixmap loadAvatar();
     QPixmap loadAvatar(const ToxPk& owner);
+    void preloadAvatars(const QList<ToxPk>& owners);
     QByteArray loadAvatarData(const ToxPk& owner);
     void setAvatar(QByteArray pic);
     void setFriendAvatar(const ToxPk& owner, QByteArray pic);
@@ -58,6 +64,7 @@ public:
     void removeFriendAvatar(const ToxPk& owner);
     bool isHistoryEnabled();
     History* getHistory();
+    ConnectionQualityLog* getConnectionQualityLog();
 
     QStringList remove();
 
@@ -93,15 +100,20 @@ private slots:
     // TODO(sudden6): use ToxPk instead of friendId
     void onAvatarOfferReceived(uint32_t friendId, uint32_t fileId, const QByteArray& avatarHash,
                                uint64_t filesize);
+    void onCallQualitySampled(uint32_t friendId, quint32 audioBitrate, quint32 videoBitrate,
+                              quint32 droppedFrames);
 
 private:
     Profile(const QString& name_, std::unique_ptr<ToxEncrypt> passkey_, Paths& paths_,
             Settings& settings_);
-    static QStringList getFilesByExt(QString extension, Paths& paths);
     QString avatarPath(const ToxPk& owner, bool forceUnencrypted = false);
+    QPixmap identiconPixmap(const ToxPk& owner, int scaleFactor);
     bool saveToxSave(QByteArray data);
-    void initCore(const QByteArray& toxSave, Settings& s, bool isNewProfile,
-                  CameraSource& cameraSource);
+    void scheduleToxSave(QByteArray data);
+    void launchToxSaveWrite(QByteArray data);
+    void flushToxSave();
+    void initCore(const QByteArray& toxSave, Settings& s, bool isNewProfile);
+    void initCoreAv(Settings& s, bool isNewProfile, CameraSource& cameraSource);
 
 private:
     std::unique_ptr<AvatarBroadcaster> avatarBroadcaster;
@@ -111,6 +123,24 @@ private:
     std::unique_ptr<ToxEncrypt> passkey;
     std::shared_ptr<RawDatabase> database;
     std::shared_ptr<History> history;
+    std::unique_ptr<ConnectionQualityLog> connectionQualityLog;
+    // Decoded avatars keyed by the owner's public key; dropped by saveAvatar()
+    // on change and cleared when the identicon setting flips
+    QHash<QByteArray, QPixmap> avatarCache;
+    // Generated identicons keyed by public key and scale factor. An identicon
+    // only depends on the key, so entries never go stale and survive avatar
+    // changes; this keeps friend list scrolling from redoing the hash
+    // derivation and repaint for every avatar-less contact
+    QHash<QPair<QByteArray, int>, QPixmap> identiconCache;
+    // Async tox save writer state, guarded by toxSaveMutex. Encryption and the
+    // disk write run on the thread pool; if a snapshot arrives while a write is
+    // in flight only the newest one is kept, and snapshots whose plaintext
+    // matches the last write are dropped entirely
+    QMutex toxSaveMutex;
+    QByteArray lastToxSaveHash;
+    QByteArray pendingToxSave;
+    QFuture<void> toxSaveFuture;
+    bool toxSaveInFlight = false;
     bool isRemoved;
     bool encrypted = false;
     static QStringList profiles;
@@ -7,6 +7,7 @@
 #include "settings.h"
 #include "src/core/core.h"
 #include "src/nexus.h"
+#include "src/persistence/friendactivityjournal.h"
 #include "src/persistence/globalsettingsupgrader.h"
 #include "src/persistence/personalsettingsupgrader.h"
 #include "src/persistence/profile.h"
@@ -32,6 +33,7 @@
 #include <QStyleFactory>
 #include <QStyleHints>
 #include <QThread>
+#include <QTimer>
 #include <QtCore/QCommandLineParser>
 
 /**
@@ -58,6 +60,10 @@ Settings::Settings(IMessageBoxManager& messageBoxManager_)
     settingsThread->setObjectName("qTox Settings");
     settingsThread->start(QThread::LowPriority);
     qRegisterMetaType<const ToxEncrypt*>("const ToxEncrypt*");
+    saveDebounceTimer = new QTimer(this);
+    saveDebounceTimer->setSingleShot(true);
+    saveDebounceTimer->setInterval(saveDebounceMs);
+    connect(saveDebounceTimer, &QTimer::timeout, this, &Settings::flushPendingSaves);
     moveToThread(settingsThread);
     loadGlobal();
 }
@@ -91,6 +97,7 @@ void Settings::loadGlobal()
     }
 
     qDebug() << "Loading settings from" << filePath;
+    globalSettingsFilePath = filePath;
 
     QSettings s(filePath, QSettings::IniFormat);
 
@@ -157,6 +164,26 @@ void Settings::loadGlobal()
     }
     s.endGroup();
 
+    s.beginGroup("Performance");
+    {
+        imageCacheBudgetMiB = s.value("imageCacheBudgetMiB", 32).toInt();
+        interactivePoolThreads = s.value("interactivePoolThreads", 0).toInt();
+        backgroundPoolThreads = s.value("backgroundPoolThreads", 0).toInt();
+        deliveryBatchWindowMs = s.value("deliveryBatchWindowMs", 1000).toInt();
+        scrollbackPrefetchLeadMs = s.value("scrollbackPrefetchLeadMs", 400).toInt();
+    }
+    s.endGroup();
+
+    s.beginGroup("Updates");
+    {
+        updateCheckEtag = s.value("etag", QString{}).toString();
+        updateCheckLastModified = s.value("lastModified", QString{}).toString();
+        lastKnownUpdateTag = s.value("lastKnownTag", QString{}).toString();
+        lastKnownUpdateLink = s.value("lastKnownLink", QString{}).toString();
+        lastUpdateCheckTime = s.value("lastCheckTime", QDateTime{}).toDateTime();
+    }
+    s.endGroup();
+
     s.beginGroup("Widgets");
     {
         QList<QString> objectNames = s.childKeys();
@@ -235,6 +262,21 @@ void Settings::loadGlobal()
     }
     s.endGroup();
 
+    // Audio and Video are cold sections: nothing on the startup path reads
+    // device preferences, so their parse is deferred to the first accessor
+    // touching them (ensureAudioVideoLoaded)
+
+    // The assignments above bypass the setters
+    invalidateChatViewSnapshot();
+
+    loaded = true;
+}
+
+/**
+ * @brief Parses the Audio and Video sections of the global settings file.
+ */
+void Settings::loadGlobalAudioVideo(QSettings& s)
+{
     s.beginGroup("Audio");
     {
         inDev = s.value("inDev", "").toString();
@@ -258,8 +300,28 @@ void Settings::loadGlobal()
         camVideoFPS = static_cast<quint16>(s.value("camVideoFPS", 0).toUInt());
     }
     s.endGroup();
+}
 
-    loaded = true;
+/**
+ * @brief Hydrates the deferred Audio and Video sections on first use.
+ *
+ * Every device-preference accessor and the global save path call this before
+ * touching the fields, so the one-time parse happens when the AV settings
+ * form (or a call) first needs the values instead of at startup. Guarded by
+ * bigLock like the accessors themselves; const because getters are.
+ */
+void Settings::ensureAudioVideoLoaded() const
+{
+    QMutexLocker<QRecursiveMutex> locker{&bigLock};
+    if (audioVideoLoaded) {
+        return;
+    }
+
+    auto* mutableThis = const_cast<Settings*>(this);
+    mutableThis->audioVideoLoaded = true;
+
+    QSettings s(globalSettingsFilePath, QSettings::IniFormat);
+    mutableThis->loadGlobalAudioVideo(s);
 }
 
 void Settings::updateProfileData(Profile* profile, const QCommandLineParser* parser, bool newProfile)
@@ -535,6 +597,19 @@ void Settings::loadPersonal(const Profile& profile, bool newProfile)
     }
     ps.endGroup();
 
+    // Replay the activity journal over the snapshot: the journal has every
+    // update since the settings file was last written
+    activityJournal = std::make_unique<FriendActivityJournal>(
+        dir.filePath(profile.getName() + ".activity"), profile.getPasskey());
+    if (getEnableLogging()) {
+        const auto journaled = activityJournal->load();
+        for (auto it = journaled.cbegin(); it != journaled.cend(); ++it) {
+            auto frndIt = friendLst.find(it.key());
+            if (frndIt != friendLst.end() && it.value() > frndIt->activity)
+                frndIt->activity = it.value();
+        }
+    }
+
     ps.beginGroup("Requests");
     {
         int size = ps.beginReadArray("Request");
@@ -600,7 +675,11 @@ void Settings::resetToDefault()
 }
 
 /**
- * @brief Asynchronous, saves the global settings.
+ * @brief Asynchronous, schedules a save of the global settings.
+ *
+ * Repeated requests within the debounce window coalesce into a single write,
+ * so bursts (e.g. every geometry change while the main window is dragged)
+ * don't each rewrite the whole file. sync() flushes anything still pending.
  */
 void Settings::saveGlobal()
 {
@@ -611,6 +690,20 @@ void Settings::saveGlobal()
     if (!loaded)
         return;
 
+    globalSavePending = true;
+    saveDebounceTimer->start();
+}
+
+void Settings::writeGlobalSettings()
+{
+    QMutexLocker<QRecursiveMutex> locker{&bigLock};
+    if (!loaded)
+        return;
+
+    // The save rewrites every section, so the deferred ones must hold real
+    // values and not their defaults
+    ensureAudioVideoLoaded();
+
     QString path = paths.getSettingsDirPath() + globalSettingsFile;
     qDebug() << "Saving global settings at" << path;
 
@@ -654,6 +747,26 @@ void Settings::saveGlobal()
     }
     s.endGroup();
 
+    s.beginGroup("Performance");
+    {
+        s.setValue("imageCacheBudgetMiB", imageCacheBudgetMiB);
+        s.setValue("interactivePoolThreads", interactivePoolThreads);
+        s.setValue("backgroundPoolThreads", backgroundPoolThreads);
+        s.setValue("deliveryBatchWindowMs", deliveryBatchWindowMs);
+        s.setValue("scrollbackPrefetchLeadMs", scrollbackPrefetchLeadMs);
+    }
+    s.endGroup();
+
+    s.beginGroup("Updates");
+    {
+        s.setValue("etag", updateCheckEtag);
+        s.setValue("lastModified", updateCheckLastModified);
+        s.setValue("lastKnownTag", lastKnownUpdateTag);
+        s.setValue("lastKnownLink", lastKnownUpdateLink);
+        s.setValue("lastCheckTime", lastUpdateCheckTime);
+    }
+    s.endGroup();
+
     s.beginGroup("Widgets");
     {
         const QList<QString> widgetNames = widgetSettings.keys();
@@ -742,7 +855,10 @@ void Settings::saveGlobal()
 }
 
 /**
- * @brief Asynchronous, saves the profile.
+ * @brief Asynchronous, schedules a save of the profile.
+ *
+ * Debounced the same way as saveGlobal(); sync() flushes pending writes, and
+ * Profile::save() syncs before the passkey goes away.
  */
 void Settings::savePersonal()
 {
@@ -755,6 +871,35 @@ void Settings::savePersonal()
 }
 
 void Settings::savePersonal(QString profileName, const ToxEncrypt* passkey)
+{
+    QMutexLocker<QRecursiveMutex> locker{&bigLock};
+    if (!loaded)
+        return;
+
+    personalSavePending = true;
+    pendingPersonalProfile = profileName;
+    pendingPersonalPasskey = passkey;
+    saveDebounceTimer->start();
+}
+
+void Settings::flushPendingSaves()
+{
+    QMutexLocker<QRecursiveMutex> locker{&bigLock};
+    saveDebounceTimer->stop();
+
+    if (globalSavePending) {
+        globalSavePending = false;
+        writeGlobalSettings();
+    }
+
+    if (personalSavePending) {
+        personalSavePending = false;
+        writePersonalSettings(pendingPersonalProfile, pendingPersonalPasskey);
+        pendingPersonalPasskey = nullptr;
+    }
+}
+
+void Settings::writePersonalSettings(const QString& profileName, const ToxEncrypt* passkey)
 {
     QMutexLocker<QRecursiveMutex> locker{&bigLock};
     if (!loaded)
@@ -863,12 +1008,14 @@ Paths& Settings::getPaths()
 
 bool Settings::getEnableTestSound() const
 {
+    ensureAudioVideoLoaded();
     QMutexLocker<QRecursiveMutex> locker{&bigLock};
     return enableTestSound;
 }
 
 void Settings::setEnableTestSound(bool newValue)
 {
+    ensureAudioVideoLoaded();
     if (setVal(enableTestSound, newValue)) {
         emit enableTestSoundChanged(newValue);
     }
@@ -968,6 +1115,7 @@ void Settings::setShowSystemTray(bool newValue)
 void Settings::setUseEmoticons(bool newValue)
 {
     if (setVal(useEmoticons, newValue)) {
+        invalidateChatViewSnapshot();
         emit useEmoticonsChanged(newValue);
     }
 }
@@ -1004,6 +1152,71 @@ bool Settings::getEnableDebug() const
     return enableDebug;
 }
 
+int Settings::getImageCacheBudgetMiB() const
+{
+    QMutexLocker<QRecursiveMutex> locker{&bigLock};
+    return imageCacheBudgetMiB;
+}
+
+void Settings::setImageCacheBudgetMiB(int budgetMiB)
+{
+    if (setVal(imageCacheBudgetMiB, budgetMiB)) {
+        emit imageCacheBudgetChanged(budgetMiB);
+    }
+}
+
+int Settings::getInteractivePoolThreads() const
+{
+    QMutexLocker<QRecursiveMutex> locker{&bigLock};
+    return interactivePoolThreads;
+}
+
+void Settings::setInteractivePoolThreads(int threads)
+{
+    if (setVal(interactivePoolThreads, threads)) {
+        emit interactivePoolThreadsChanged(threads);
+    }
+}
+
+int Settings::getBackgroundPoolThreads() const
+{
+    QMutexLocker<QRecursiveMutex> locker{&bigLock};
+    return backgroundPoolThreads;
+}
+
+void Settings::setBackgroundPoolThreads(int threads)
+{
+    if (setVal(backgroundPoolThreads, threads)) {
+        emit backgroundPoolThreadsChanged(threads);
+    }
+}
+
+int Settings::getDeliveryBatchWindowMs() const
+{
+    QMutexLocker<QRecursiveMutex> locker{&bigLock};
+    return deliveryBatchWindowMs;
+}
+
+void Settings::setDeliveryBatchWindowMs(int windowMs)
+{
+    if (setVal(deliveryBatchWindowMs, windowMs)) {
+        emit deliveryBatchWindowChanged(windowMs);
+    }
+}
+
+int Settings::getScrollbackPrefetchLeadMs() const
+{
+    QMutexLocker<QRecursiveMutex> locker{&bigLock};
+    return scrollbackPrefetchLeadMs;
+}
+
+void Settings::setScrollbackPrefetchLeadMs(int leadMs)
+{
+    if (setVal(scrollbackPrefetchLeadMs, leadMs)) {
+        emit scrollbackPrefetchLeadChanged(leadMs);
+    }
+}
+
 void Settings::setAutostartInTray(bool newValue)
 {
     if (setVal(autostartInTray, newValue)) {
@@ -1455,6 +1668,24 @@ void Settings::setMaxAutoAcceptSize(size_t size)
     }
 }
 
+std::shared_ptr<const Settings::ChatViewSnapshot> Settings::getChatViewSnapshot() const
+{
+    if (auto snapshot = chatViewSnapshot.load()) {
+        return snapshot;
+    }
+
+    QMutexLocker<QRecursiveMutex> locker{&bigLock};
+    auto fresh = std::make_shared<const ChatViewSnapshot>(
+        ChatViewSnapshot{chatMessageFont, timestampFormat, dateFormat, stylePreference, useEmoticons});
+    chatViewSnapshot.store(fresh);
+    return fresh;
+}
+
+void Settings::invalidateChatViewSnapshot()
+{
+    chatViewSnapshot.store(nullptr);
+}
+
 const QFont& Settings::getChatMessageFont() const
 {
     QMutexLocker<QRecursiveMutex> locker(&bigLock);
@@ -1464,6 +1695,7 @@ const QFont& Settings::getChatMessageFont() const
 void Settings::setChatMessageFont(const QFont& font)
 {
     if (setVal(chatMessageFont, font)) {
+        invalidateChatViewSnapshot();
         emit chatMessageFontChanged(font);
     }
 }
@@ -1525,6 +1757,7 @@ const QString& Settings::getTimestampFormat() const
 void Settings::setTimestampFormat(const QString& format)
 {
     if (setVal(timestampFormat, format)) {
+        invalidateChatViewSnapshot();
         emit timestampFormatChanged(format);
     }
 }
@@ -1538,6 +1771,7 @@ const QString& Settings::getDateFormat() const
 void Settings::setDateFormat(const QString& format)
 {
     if (setVal(dateFormat, format)) {
+        invalidateChatViewSnapshot();
         emit dateFormatChanged(format);
     }
 }
@@ -1551,6 +1785,7 @@ Settings::StyleType Settings::getStylePreference() const
 void Settings::setStylePreference(StyleType newValue)
 {
     if (setVal(stylePreference, newValue)) {
+        invalidateChatViewSnapshot();
         emit stylePreferenceChanged(newValue);
     }
 }
@@ -1594,6 +1829,61 @@ void Settings::setCheckUpdates(bool newValue)
     }
 }
 
+QString Settings::getUpdateCheckEtag() const
+{
+    QMutexLocker<QRecursiveMutex> locker{&bigLock};
+    return updateCheckEtag;
+}
+
+void Settings::setUpdateCheckEtag(const QString& newValue)
+{
+    setVal(updateCheckEtag, newValue);
+}
+
+QString Settings::getUpdateCheckLastModified() const
+{
+    QMutexLocker<QRecursiveMutex> locker{&bigLock};
+    return updateCheckLastModified;
+}
+
+void Settings::setUpdateCheckLastModified(const QString& newValue)
+{
+    setVal(updateCheckLastModified, newValue);
+}
+
+QString Settings::getLastKnownUpdateTag() const
+{
+    QMutexLocker<QRecursiveMutex> locker{&bigLock};
+    return lastKnownUpdateTag;
+}
+
+void Settings::setLastKnownUpdateTag(const QString& newValue)
+{
+    setVal(lastKnownUpdateTag, newValue);
+}
+
+QString Settings::getLastKnownUpdateLink() const
+{
+    QMutexLocker<QRecursiveMutex> locker{&bigLock};
+    return lastKnownUpdateLink;
+}
+
+void Settings::setLastKnownUpdateLink(const QString& newValue)
+{
+    setVal(lastKnownUpdateLink, newValue);
+}
+
+QDateTime Settings::getLastUpdateCheckTime() const
+{
+    QMutexLocker<QRecursiveMutex> locker{&bigLock};
+    return lastUpdateCheckTime;
+}
+
+void Settings::setLastUpdateCheckTime(const QDateTime& newValue)
+{
+    setVal(lastUpdateCheckTime, newValue);
+}
+
 bool Settings::getNotify() const
 {
     QMutexLocker<QRecursiveMutex> locker{&bigLock};
@@ -1739,12 +2029,14 @@ void Settings::setBlockList(const QStringList& blist)
 
 QString Settings::getInDev() const
 {
+    ensureAudioVideoLoaded();
     QMutexLocker<QRecursiveMutex> locker{&bigLock};
     return inDev;
 }
 
 void Settings::setInDev(const QString& deviceSpecifier)
 {
+    ensureAudioVideoLoaded();
     if (setVal(inDev, deviceSpecifier)) {
         emit inDevChanged(deviceSpecifier);
     }
@@ -1752,12 +2044,14 @@ void Settings::setInDev(const QString& deviceSpecifier)
 
 bool Settings::getAudioInDevEnabled() const
 {
+    ensureAudioVideoLoaded();
     QMutexLocker<QRecursiveMutex> locker(&bigLock);
     return audioInDevEnabled;
 }
 
 void Settings::setAudioInDevEnabled(bool enabled)
 {
+    ensureAudioVideoLoaded();
     if (setVal(audioInDevEnabled, enabled)) {
         emit audioInDevEnabledChanged(enabled);
     }
@@ -1765,12 +2059,14 @@ void Settings::setAudioInDevEnabled(bool enabled)
 
 qreal Settings::getAudioInGainDecibel() const
 {
+    ensureAudioVideoLoaded();
     QMutexLocker<QRecursiveMutex> locker{&bigLock};
     return audioInGainDecibel;
 }
 
 void Settings::setAudioInGainDecibel(qreal dB)
 {
+    ensureAudioVideoLoaded();
     if (setVal(audioInGainDecibel, dB)) {
         emit audioInGainDecibelChanged(audioInGainDecibel);
     }
@@ -1778,12 +2074,14 @@ void Settings::setAudioInGainDecibel(qreal dB)
 
 qreal Settings::getAudioThreshold() const
 {
+    ensureAudioVideoLoaded();
     QMutexLocker<QRecursiveMutex> locker{&bigLock};
     return audioThreshold;
 }
 
 void Settings::setAudioThreshold(qreal percent)
 {
+    ensureAudioVideoLoaded();
     if (setVal(audioThreshold, percent)) {
         emit audioThresholdChanged(percent);
     }
@@ -1791,12 +2089,14 @@ void Settings::setAudioThreshold(qreal percent)
 
 QString Settings::getVideoDev() const
 {
+    ensureAudioVideoLoaded();
     QMutexLocker<QRecursiveMutex> locker{&bigLock};
     return videoDev;
 }
 
 void Settings::setVideoDev(const QString& deviceSpecifier)
 {
+    ensureAudioVideoLoaded();
     if (setVal(videoDev, deviceSpecifier)) {
         emit videoDevChanged(deviceSpecifier);
     }
@@ -1804,12 +2104,14 @@ void Settings::setVideoDev(const QString& deviceSpecifier)
 
 QString Settings::getOutDev() const
 {
+    ensureAudioVideoLoaded();
     QMutexLocker<QRecursiveMutex> locker{&bigLock};
     return outDev;
 }
 
 void Settings::setOutDev(const QString& deviceSpecifier)
 {
+    ensureAudioVideoLoaded();
     if (setVal(outDev, deviceSpecifier)) {
         emit outDevChanged(deviceSpecifier);
     }
@@ -1817,12 +2119,14 @@ void Settings::setOutDev(const QString& deviceSpecifier)
 
 bool Settings::getAudioOutDevEnabled() const
 {
+    ensureAudioVideoLoaded();
     QMutexLocker<QRecursiveMutex> locker(&bigLock);
     return audioOutDevEnabled;
 }
 
 void Settings::setAudioOutDevEnabled(bool enabled)
 {
+    ensureAudioVideoLoaded();
     if (setVal(audioOutDevEnabled, enabled)) {
         emit audioOutDevEnabledChanged(enabled);
     }
@@ -1830,12 +2134,14 @@ void Settings::setAudioOutDevEnabled(bool enabled)
 
 int Settings::getOutVolume() const
 {
+    ensureAudioVideoLoaded();
     QMutexLocker<QRecursiveMutex> locker{&bigLock};
     return outVolume;
 }
 
 void Settings::setOutVolume(int volume)
 {
+    ensureAudioVideoLoaded();
     if (setVal(outVolume, volume)) {
         emit outVolumeChanged(volume);
     }
@@ -1843,12 +2149,14 @@ void Settings::setOutVolume(int volume)
 
 int Settings::getAudioBitrate() const
 {
+    ensureAudioVideoLoaded();
     const QMutexLocker<QRecursiveMutex> locker{&bigLock};
     return audioBitrate;
 }
 
 void Settings::setAudioBitrate(int bitrate)
 {
+    ensureAudioVideoLoaded();
     if (setVal(audioBitrate, bitrate)) {
         emit audioBitrateChanged(bitrate);
     }
@@ -1856,12 +2164,14 @@ void Settings::setAudioBitrate(int bitrate)
 
 QRect Settings::getScreenRegion() const
 {
+    ensureAudioVideoLoaded();
     QMutexLocker<QRecursiveMutex> locker(&bigLock);
     return screenRegion;
 }
 
 void Settings::setScreenRegion(const QRect& value)
 {
+    ensureAudioVideoLoaded();
     if (setVal(screenRegion, value)) {
         emit screenRegionChanged(value);
     }
@@ -1869,12 +2179,14 @@ void Settings::setScreenRegion(const QRect& value)
 
 bool Settings::getScreenGrabbed() const
 {
+    ensureAudioVideoLoaded();
     QMutexLocker<QRecursiveMutex> locker(&bigLock);
     return screenGrabbed;
 }
 
 void Settings::setScreenGrabbed(bool value)
 {
+    ensureAudioVideoLoaded();
     if (setVal(screenGrabbed, value)) {
         emit screenGrabbedChanged(value);
     }
@@ -1882,12 +2194,14 @@ void Settings::setScreenGrabbed(bool value)
 
 QRect Settings::getCamVideoRes() const
 {
+    ensureAudioVideoLoaded();
     QMutexLocker<QRecursiveMutex> locker{&bigLock};
     return camVideoRes;
 }
 
 void Settings::setCamVideoRes(QRect newValue)
 {
+    ensureAudioVideoLoaded();
     if (setVal(camVideoRes, newValue)) {
         emit camVideoResChanged(newValue);
     }
@@ -1895,12 +2209,14 @@ void Settings::setCamVideoRes(QRect newValue)
 
 float Settings::getCamVideoFPS() const
 {
+    ensureAudioVideoLoaded();
     QMutexLocker<QRecursiveMutex> locker{&bigLock};
     return camVideoFPS;
 }
 
 void Settings::setCamVideoFPS(float newValue)
 {
+    ensureAudioVideoLoaded();
     if (setVal(camVideoFPS, newValue)) {
         emit camVideoFPSChanged(newValue);
     }
@@ -1963,6 +2279,12 @@ void Settings::setFriendActivity(const ToxPk& id, const QDateTime& activity)
     QMutexLocker<QRecursiveMutex> locker{&bigLock};
     auto& frnd = getOrInsertFriendPropRef(id);
     frnd.activity = activity;
+
+    // One small append instead of a personal settings rewrite; this runs for
+    // every sent and received message
+    if (activityJournal && getEnableLogging()) {
+        activityJournal->append(id, activity);
+    }
 }
 
 void Settings::saveFriendSettings(const ToxPk& id)
@@ -2262,7 +2584,10 @@ void Settings::sync()
     }
 
     QMutexLocker<QRecursiveMutex> locker{&bigLock};
+    // Deliver any queued save requests first, then write out whatever the
+    // debounce timer is still holding back
     qApp->processEvents();
+    flushPendingSaves();
 }
 
 Settings::friendProp& Settings::getOrInsertFriendPropRef(const ToxPk& id)
@@ -14,6 +14,7 @@
 #include "src/persistence/iconferencesettings.h"
 #include "src/persistence/ifriendsettings.h"
 #include "src/persistence/inotificationsettings.h"
+#include "src/persistence/iperformancesettings.h"
 #include "src/persistence/ismileysettings.h"
 #include "src/persistence/paths.h"
 #include "src/video/ivideosettings.h"
@@ -27,8 +28,14 @@
 #include <QObject>
 #include <QPixmap>
 
+#include <atomic>
+#include <memory>
+
+class FriendActivityJournal;
 class Profile;
 class QCommandLineParser;
+class QSettings;
+class QTimer;
 class IMessageBoxManager;
 
 namespace Db {
@@ -43,6 +50,7 @@ class Settings : public QObject,
                  public IAudioSettings,
                  public IVideoSettings,
                  public INotificationSettings,
+                 public IPerformanceSettings,
                  public ISmileySettings
 {
     Q_OBJECT
@@ -146,6 +154,8 @@ public:
     void savePersonal();
 
     void loadGlobal();
+    void loadGlobalAudioVideo(QSettings& s);
+    void ensureAudioVideoLoaded() const;
     void loadPersonal(const Profile& profile, bool newProfile);
 
     void resetToDefault();
@@ -269,6 +279,28 @@ public:
     void setEnableDebug(bool newValue) override;
     bool getEnableDebug() const override;
 
+    // IPerformanceSettings
+    int getImageCacheBudgetMiB() const override;
+    void setImageCacheBudgetMiB(int budgetMiB) override;
+
+    int getInteractivePoolThreads() const override;
+    void setInteractivePoolThreads(int threads) override;
+
+    int getBackgroundPoolThreads() const override;
+    void setBackgroundPoolThreads(int threads) override;
+
+    int getDeliveryBatchWindowMs() const override;
+    void setDeliveryBatchWindowMs(int windowMs) override;
+
+    int getScrollbackPrefetchLeadMs() const override;
+    void setScrollbackPrefetchLeadMs(int leadMs) override;
+
+    SIGNAL_IMPL(Settings, imageCacheBudgetChanged, int budgetMiB)
+    SIGNAL_IMPL(Settings, interactivePoolThreadsChanged, int threads)
+    SIGNAL_IMPL(Settings, backgroundPoolThreadsChanged, int threads)
+    SIGNAL_IMPL(Settings, deliveryBatchWindowChanged, int windowMs)
+    SIGNAL_IMPL(Settings, scrollbackPrefetchLeadChanged, int leadMs)
+
     // ICoreSettings
     bool getEnableIPv6() const override;
     void setEnableIPv6(bool enabled) override;
@@ -309,6 +341,21 @@ public:
     bool getCheckUpdates() const;
     void setCheckUpdates(bool newValue);
 
+    QString getUpdateCheckEtag() const;
+    void setUpdateCheckEtag(const QString& newValue);
+
+    QString getUpdateCheckLastModified() const;
+    void setUpdateCheckLastModified(const QString& newValue);
+
+    QString getLastKnownUpdateTag() const;
+    void setLastKnownUpdateTag(const QString& newValue);
+
+    QString getLastKnownUpdateLink() const;
+    void setLastKnownUpdateLink(const QString& newValue);
+
+    QDateTime getLastUpdateCheckTime() const;
+    void setLastUpdateCheckTime(const QDateTime& newValue);
+
     bool getNotify() const override;
     void setNotify(bool newValue) override;
 
@@ -436,6 +483,23 @@ public:
     void setAutoConferenceInvite(const ToxPk& id, bool accept) override;
 
     // ChatView
+    /**
+     * Immutable copy of the settings the chat render path reads for every
+     * message. Each getter below takes bigLock, and building a single message
+     * row calls half a dozen of them, serializing the GUI thread against the
+     * settings-save thread. Hot readers grab one snapshot per batch instead;
+     * reading it takes no lock, and the setters publish a fresh copy on change.
+     */
+    struct ChatViewSnapshot
+    {
+        QFont chatMessageFont;
+        QString timestampFormat;
+        QString dateFormat;
+        StyleType stylePreference;
+        bool useEmoticons;
+    };
+    std::shared_ptr<const ChatViewSnapshot> getChatViewSnapshot() const;
+
     const QFont& getChatMessageFont() const;
     void setChatMessageFont(const QFont& font);
 
@@ -571,12 +635,34 @@ private:
     template <typename T>
     bool setVal(T& savedVal, T newVal);
 
+    void invalidateChatViewSnapshot();
+    void writeGlobalSettings();
+    void writePersonalSettings(const QString& profileName, const ToxEncrypt* passkey);
+
 private slots:
     void savePersonal(QString profileName, const ToxEncrypt* passkey);
+    void flushPendingSaves();
 
 private:
     bool loaded;
 
+    // The Audio and Video sections are cold: nothing on the startup path
+    // reads them, so loadGlobal() leaves them unparsed and the first accessor
+    // touching them hydrates from this path (see ensureAudioVideoLoaded)
+    QString globalSettingsFilePath;
+    bool audioVideoLoaded = false;
+
+    // Debounced persistence: save requests mark a file pending and (re)start
+    // the timer; the write happens once the burst settles or sync() flushes.
+    // The passkey is only held between a request and the flush, and
+    // Profile::save() syncs before it is destroyed.
+    static constexpr int saveDebounceMs = 1000;
+    QTimer* saveDebounceTimer = nullptr;
+    bool globalSavePending = false;
+    bool personalSavePending = false;
+    QString pendingPersonalProfile;
+    const ToxEncrypt* pendingPersonalPasskey = nullptr;
+
     bool useCustomDhtList;
     int dhtServerId;
     bool dontShowDhtDialog;
@@ -596,6 +682,13 @@ private:
     bool lightTrayIcon;
     bool useEmoticons;
     bool checkUpdates;
+    // Cached state of the last update check, so startup can reuse the previous
+    // verdict without touching the network
+    QString updateCheckEtag;
+    QString updateCheckLastModified;
+    QString lastKnownUpdateTag;
+    QString lastKnownUpdateLink;
+    QDateTime lastUpdateCheckTime;
     bool notify;
     bool desktopNotify;
     bool notifySystemBackend;
@@ -622,6 +715,13 @@ private:
 
     bool enableDebug;
 
+    // Performance tuning; thread counts of 0 mean automatic sizing
+    int imageCacheBudgetMiB;
+    int interactivePoolThreads;
+    int backgroundPoolThreads;
+    int deliveryBatchWindowMs;
+    int scrollbackPrefetchLeadMs;
+
     QHash<QString, QByteArray> widgetSettings;
     QHash<QString, QString> autoAccept;
     bool autoSaveEnabled;
@@ -644,6 +744,8 @@ private:
     bool showSystemTray;
 
     // ChatView
+    // Rebuilt lazily by getChatViewSnapshot() after a setter drops it
+    mutable std::atomic<std::shared_ptr<const ChatViewSnapshot>> chatViewSnapshot;
     QFont chatMessageFont;
     StyleType stylePreference;
     int firstColumnHandlePos;
@@ -702,6 +804,11 @@ private:
 
     QHash<QByteArray, friendProp> friendLst;
 
+    // Activity timestamps change for every message, so they persist through
+    // an append-only journal instead of triggering personal settings saves;
+    // the settings file keeps a snapshot written on its regular saves
+    std::unique_ptr<FriendActivityJournal> activityJournal;
+
     QVector<circleProp> circleLst;
 
     int themeColor;
@@ -81,6 +81,25 @@ QDataStream& readStream(QDataStream& dataStream, QByteArray& data)
     dataStream.readRawData(data.data(), num);
     return dataStream;
 }
+
+/**
+ * @brief Builds the valueIndex key for a value's resolution scope.
+ *
+ * Group and array index are separated from the key text by a unit separator,
+ * which cannot occur in settings key names. Values outside arrays ignore the
+ * current array index, mirroring findValue()'s two search modes.
+ */
+QString lookupKey(qint64 group, bool inArray, int arrayIndex, const QString& key)
+{
+    QString composed = QString::number(group);
+    composed += QLatin1Char('\x1f');
+    if (inArray) {
+        composed += QString::number(arrayIndex);
+    }
+    composed += QLatin1Char('\x1f');
+    composed += key;
+    return composed;
+}
 } // namespace
 
 SettingsSerializer::SettingsSerializer(QString filePath_, const ToxEncrypt* passKey_)
@@ -165,6 +184,7 @@ void SettingsSerializer::setValue(const QString& key, const QVariant& value)
         Value nv{group, array, arrayIndex, key, value};
         if (array >= 0)
             arrays[array].values.append(values.size());
+        valueIndex.insert(lookupKey(group, array >= 0, arrayIndex, key), values.size());
         values.append(nv);
     }
 }
@@ -180,23 +200,12 @@ QVariant SettingsSerializer::value(const QString& key, const QVariant& defaultVa
 
 const SettingsSerializer::Value* SettingsSerializer::findValue(const QString& key) const
 {
-    if (array != -1) {
-        for (const Array& a : arrays) {
-            if (a.group != group)
-                continue;
-
-            for (int vi : a.values) {
-                const Value& v = values[vi];
-                if (v.arrayIndex == arrayIndex && v.key == key)
-                    return &v;
-            }
-        }
-    } else {
-        for (const Value& v : values)
-            if (v.group == group && v.array == -1 && v.key == key)
-                return &v;
-    }
-    return nullptr;
+    // setValue() never creates two values with the same scope and key, so
+    // the index resolves exactly what the old linear scan over `values` did
+    const auto it = valueIndex.constFind(lookupKey(group, array != -1, arrayIndex, key));
+    if (it == valueIndex.constEnd())
+        return nullptr;
+    return &values[*it];
 }
 
 SettingsSerializer::Value* SettingsSerializer::findValue(const QString& key)
@@ -204,6 +213,19 @@ SettingsSerializer::Value* SettingsSerializer::findValue(const QString& key)
     return const_cast<Value*>(const_cast<const SettingsSerializer*>(this)->findValue(key));
 }
 
+/**
+ * @brief Recomputes valueIndex from scratch after bulk changes to `values`.
+ */
+void SettingsSerializer::rebuildIndex()
+{
+    valueIndex.clear();
+    valueIndex.reserve(values.size());
+    for (int i = 0; i < values.size(); ++i) {
+        const Value& v = values[i];
+        valueIndex.insert(lookupKey(v.group, v.array != -1, v.arrayIndex, v.key), i);
+    }
+}
+
 /**
  * @brief Checks if the file is serialized settings.
  * @param filePath Path to file to check.
@@ -308,8 +330,20 @@ void SettingsSerializer::readSerialized()
         qWarning() << "Couldn't open file";
         return;
     }
-    QByteArray data = f.readAll();
-    f.close();
+
+    // Map the file instead of reading it into a heap buffer: in the common
+    // unencrypted case the parse below then works straight out of the page
+    // cache with no up-front allocation. The mapping lives until `f` is
+    // destroyed, which outlasts every use of `data`; encrypted files get
+    // copied through the decryption step regardless.
+    QByteArray data;
+    const uchar* mapped = f.map(0, f.size());
+    if (mapped != nullptr) {
+        data = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), f.size());
+    } else {
+        data = f.readAll();
+        f.close();
+    }
 
     // Decrypt
     if (ToxEncrypt::isEncrypted(data)) {
@@ -332,10 +366,12 @@ void SettingsSerializer::readSerialized()
         qWarning() << "Bad magic!";
         return;
     }
-    data = data.mid(4);
 
-    QDataStream stream(&data, QIODevice::ReadOnly);
+    // Read-only stream over the (possibly mapped) buffer; skipping the magic
+    // in place avoids mid()'s deep copy of everything after it
+    QDataStream stream(data);
     stream.setVersion(QDataStream::Qt_5_0);
+    stream.skipRawData(4);
 
     while (!stream.atEnd()) {
         RecordTag tag;
@@ -509,6 +545,10 @@ void SettingsSerializer::readIni()
         removeGroup(g);
     }
 
+    // The array conversion above moved and removed values directly, so the
+    // incremental index no longer matches
+    rebuildIndex();
+
     group = array = -1;
 }
 
@@ -531,6 +571,7 @@ void SettingsSerializer::removeGroup(int group_)
             v.group--;
     }
     groups.removeAt(group_);
+    rebuildIndex();
 }
 
 void SettingsSerializer::writePackedVariant(QDataStream& stream, const QVariant& v)
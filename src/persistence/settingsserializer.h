@@ -8,6 +8,7 @@
 #include "src/core/toxencrypt.h"
 
 #include <QDataStream>
+#include <QHash>
 #include <QSettings>
 #include <QString>
 #include <QVector>
@@ -78,6 +79,7 @@ private:
 private:
     const Value* findValue(const QString& key) const;
     Value* findValue(const QString& key);
+    void rebuildIndex();
     void readSerialized();
     void readIni();
     void removeValue(const QString& key);
@@ -91,5 +93,11 @@ private:
     QStringList groups;
     QVector<Array> arrays;
     QVector<Value> values;
+    // Resolves (group, array index, key) to a position in `values`. Loading
+    // calls setValue once per record and every call used to scan all existing
+    // values, making load quadratic in the number of settings; with the index
+    // each resolution is one hash lookup. Kept in sync by setValue and
+    // rebuilt after the surgery readIni() and removeGroup() perform.
+    QHash<QString, int> valueIndex;
     static const char magic[];
 };
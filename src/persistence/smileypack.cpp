@@ -5,14 +5,12 @@
 
 #include "smileypack.h"
 #include "src/persistence/settings.h"
+#include "src/workerpool.h"
 
 #include <QDir>
 #include <QDomElement>
-#include <QRegularExpression>
 #include <QStandardPaths>
-#include <QStringBuilder>
 #include <QTimer>
-#include <QtConcurrent/QtConcurrentRun>
 
 #if defined(Q_OS_FREEBSD)
 #include <locale.h>
@@ -39,10 +37,6 @@
  */
 
 namespace {
-QStringList loadDefaultPaths();
-
-const QStringList DEFAULT_PATHS = loadDefaultPaths();
-
 const QString RICH_TEXT_PATTERN = QStringLiteral("<img title=\"%1\" src=\"key:%1\"\\>");
 
 const QString EMOTICONS_FILE_NAME = QStringLiteral("emoticons.xml");
@@ -82,6 +76,19 @@ QStringList loadDefaultPaths()
     return paths;
 }
 
+/**
+ * @brief Returns the default emoticons directories, built on first use.
+ *
+ * Probing QStandardPaths (and the FreeBSD locale workaround) used to run as a
+ * static initializer before main(); only the smiley settings page needs the
+ * list at all.
+ */
+const QStringList& defaultPaths()
+{
+    static const QStringList paths = loadDefaultPaths();
+    return paths;
+}
+
 bool isAscii(const QString& string)
 {
     constexpr auto asciiExtMask = 0x80;
@@ -95,14 +102,24 @@ SmileyPack::SmileyPack(ISmileySettings& settings_)
     : cleanupTimer{new QTimer(this)}
     , settings{settings_}
 {
-    load(settings.getSmileyPack());
-
-    settings.connectTo_smileyPackChanged(this, [this](const QString& filename) { load(filename); });
+    // Parsing the pack and building the matcher takes a while for the big
+    // unicode packs, so it runs off the GUI thread; icons themselves are
+    // decoded lazily on first display
+    loadFuture = WorkerPool::instance().runBackground(
+        [this, filename = settings.getSmileyPack()] { load(filename); });
+
+    settings.connectTo_smileyPackChanged(this, [this](const QString& filename) {
+        loadFuture.waitForFinished();
+        loadFuture = WorkerPool::instance().runBackground([this, filename] { load(filename); });
+    });
     connect(cleanupTimer, &QTimer::timeout, this, &SmileyPack::cleanupIconsCache);
     cleanupTimer->start(CLEANUP_TIMEOUT);
 }
 
-SmileyPack::~SmileyPack() = default;
+SmileyPack::~SmileyPack()
+{
+    loadFuture.waitForFinished();
+}
 
 /**
  * @brief Wraps passed string into smiley HTML image reference
@@ -132,7 +149,7 @@ void SmileyPack::cleanupIconsCache()
  */
 QList<QPair<QString, QString>> SmileyPack::listSmileyPacks()
 {
-    return listSmileyPacks(DEFAULT_PATHS);
+    return listSmileyPacks(defaultPaths());
 }
 
 /**
@@ -230,44 +247,75 @@ void SmileyPack::load(const QString& filename)
         emoticons.append(emoticonList);
     }
 
-    constructRegex();
+    constructMatcher();
+}
+
+/**
+ * @brief Waits for a pack load still in flight, so accessors see a fully
+ * parsed pack rather than whatever the loader got to. Free once the load
+ * has landed.
+ */
+void SmileyPack::ensureLoaded() const
+{
+    loadFuture.waitForFinished();
 }
 
 /**
- * @brief Creates the regex for replacing emoticons with the path to their pictures
+ * @brief Compiles the emoticon table into a trie for matching messages against
  */
-void SmileyPack::constructRegex()
+void SmileyPack::constructMatcher()
 {
-    QString allPattern = QStringLiteral("(");
-    QString regularPatterns;
-    QString multiCharacterEmojiPatterns;
-
-    // construct one big regex that matches on every emoticon
-    for (const QString& emote : emoticonToPath.keys()) {
-        if (!isAscii(emote)) {
-            if (emote.toUcs4().length() == 1) {
-                regularPatterns.append(emote);
-                regularPatterns.append(QStringLiteral("|"));
+    matcher.clear();
+    matcher.emplace_back();
+
+    for (auto it = emoticonToPath.cbegin(); it != emoticonToPath.cend(); ++it) {
+        const QString& emote = it.key();
+        int node = 0;
+        for (const QChar c : emote) {
+            const auto nextIt = matcher[node].next.constFind(c);
+            if (nextIt != matcher[node].next.constEnd()) {
+                node = nextIt.value();
             } else {
-                multiCharacterEmojiPatterns.append(emote);
-                multiCharacterEmojiPatterns.append(QStringLiteral("|"));
+                matcher.emplace_back();
+                matcher[node].next.insert(c, matcher.size() - 1);
+                node = matcher.size() - 1;
             }
-        } else {
-            // patterns like ":)" or ":smile:", don't match inside a word or else will hit punctuation and html tags
-            regularPatterns.append(QStringLiteral(R"((?<=^|\s))") % QRegularExpression::escape(emote)
-                                   % QStringLiteral(R"((?=$|\s))"));
-            regularPatterns.append(QStringLiteral("|"));
         }
+        matcher[node].emoticonLength = emote.size();
+        matcher[node].requiresBoundary = isAscii(emote);
     }
+}
 
-    // Regexps are evaluated from left to right, insert multichar emojis first so they are evaluated first
-    allPattern.append(multiCharacterEmojiPatterns);
-    allPattern.append(regularPatterns);
-    allPattern[allPattern.size() - 1] = QChar(')');
+/**
+ * @brief Finds the longest emoticon starting at the given message position
+ * @return Length of the matched emoticon, 0 if none matches there
+ */
+int SmileyPack::matchAt(const QString& msg, int pos) const
+{
+    if (matcher.empty()) {
+        return 0;
+    }
+
+    const bool boundaryBefore = pos == 0 || msg[pos - 1].isSpace();
+
+    int node = 0;
+    int longestMatch = 0;
+    for (int i = pos; i < msg.size(); ++i) {
+        const auto nextIt = matcher[node].next.constFind(msg[i]);
+        if (nextIt == matcher[node].next.constEnd()) {
+            break;
+        }
+        node = nextIt.value();
+
+        if (matcher[node].emoticonLength > 0) {
+            const bool boundaryAfter = i + 1 == msg.size() || msg[i + 1].isSpace();
+            if (!matcher[node].requiresBoundary || (boundaryBefore && boundaryAfter)) {
+                longestMatch = matcher[node].emoticonLength;
+            }
+        }
+    }
 
-    // compile and optimize regex
-    smilify.setPattern(allPattern);
-    smilify.optimize();
+    return longestMatch;
 }
 
 /**
@@ -277,18 +325,21 @@ void SmileyPack::constructRegex()
  */
 QString SmileyPack::smileyfied(const QString& msg)
 {
+    ensureLoaded();
     QMutexLocker<QMutex> locker(&loadingMutex);
-    QString result(msg);
-
-    int replaceDiff = 0;
-    QRegularExpressionMatchIterator iter = smilify.globalMatch(result);
-    while (iter.hasNext()) {
-        QRegularExpressionMatch match = iter.next();
-        int startPos = match.capturedStart();
-        int keyLength = match.capturedLength();
-        QString imgRichText = SmileyPack::getAsRichText(match.captured());
-        result.replace(startPos + replaceDiff, keyLength, imgRichText);
-        replaceDiff += imgRichText.length() - keyLength;
+    QString result;
+    result.reserve(msg.size());
+
+    int pos = 0;
+    while (pos < msg.size()) {
+        const int matchLength = matchAt(msg, pos);
+        if (matchLength > 0) {
+            result += getAsRichText(msg.mid(pos, matchLength));
+            pos += matchLength;
+        } else {
+            result += msg[pos];
+            ++pos;
+        }
     }
 
     return result;
@@ -299,10 +350,25 @@ QString SmileyPack::smileyfied(const QString& msg)
  */
 QList<QStringList> SmileyPack::getEmoticons() const
 {
+    ensureLoaded();
     QMutexLocker<QMutex> locker(&loadingMutex);
     return emoticons;
 }
 
+/**
+ * @brief Gets the image file path mapped to the passed emoticon
+ * @return Path of the smiley image, empty if no image is mapped to this emoticon
+ *
+ * Lets renderers share pixmaps through PixmapCache instead of each holding a
+ * QIcon per emoticon occurrence.
+ */
+QString SmileyPack::getIconPath(const QString& emoticon) const
+{
+    ensureLoaded();
+    QMutexLocker<QMutex> locker(&loadingMutex);
+    return emoticonToPath.value(emoticon);
+}
+
 /**
  * @brief Gets icon according to passed emoticon
  * @param emoticon Passed emoticon
@@ -310,6 +376,7 @@ QList<QStringList> SmileyPack::getEmoticons() const
  */
 std::shared_ptr<QIcon> SmileyPack::getAsIcon(const QString& emoticon) const
 {
+    ensureLoaded();
     QMutexLocker<QMutex> locker(&loadingMutex);
     if (cachedIcon.find(emoticon) != cachedIcon.end()) {
         return cachedIcon[emoticon];
@@ -5,12 +5,14 @@
 
 #pragma once
 
+#include <QFuture>
+#include <QHash>
 #include <QIcon>
 #include <QMap>
 #include <QMutex>
-#include <QRegularExpression>
 
 #include <memory>
+#include <vector>
 
 class QTimer;
 class ISmileySettings;
@@ -31,6 +33,7 @@ public:
     QString smileyfied(const QString& msg);
     QList<QStringList> getEmoticons() const;
     std::shared_ptr<QIcon> getAsIcon(const QString& emoticon) const;
+    QString getIconPath(const QString& emoticon) const;
     static QString getAsRichText(const QString& key);
 
 private slots:
@@ -38,14 +41,34 @@ private slots:
     void cleanupIconsCache();
 
 private:
-    void constructRegex();
+    /**
+     * One node of the emoticon matcher trie. The trie is compiled once per
+     * pack load; matching a message then walks it per start position instead
+     * of evaluating a regex alternation over the whole emoticon table.
+     */
+    struct MatcherNode
+    {
+        QHash<QChar, int> next;
+        // Length of the emoticon ending at this node, 0 if none
+        int emoticonLength = 0;
+        // ASCII emoticons like ":)" only match between whitespace/ends, so
+        // they don't hit punctuation or html tags
+        bool requiresBoundary = false;
+    };
+
+    void constructMatcher();
+    int matchAt(const QString& msg, int pos) const;
+    void ensureLoaded() const;
 
     mutable std::map<QString, std::shared_ptr<QIcon>> cachedIcon;
     QHash<QString, QString> emoticonToPath;
     QList<QStringList> emoticons;
     QString path;
     QTimer* cleanupTimer;
-    QRegularExpression smilify;
+    std::vector<MatcherNode> matcher;
+    // Pack parsing runs on the thread pool; every accessor grabs loadingMutex,
+    // so readers just see the old (or empty) tables until the load lands
+    QFuture<void> loadFuture;
     mutable QMutex loadingMutex;
     ISmileySettings& settings;
 };
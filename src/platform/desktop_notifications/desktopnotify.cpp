@@ -8,26 +8,44 @@
 #include "src/persistence/inotificationsettings.h"
 
 #include <QSystemTrayIcon>
+#include <QTimer>
+
+namespace {
+// Minimum time between two notifications pushed to the desktop. Bursts within
+// the window collapse into one update, since the generator's aggregated
+// counts make the latest NotificationData supersede the earlier ones.
+const int DISPATCH_INTERVAL_MS = 1000;
+} // namespace
 
 struct DesktopNotify::Private
 {
+    // The QTimer makes Private non-copyable, so it's built in place
+    explicit Private(INotificationSettings& settings_)
+        : settings{settings_}
+    {
+    }
+
     INotificationSettings& settings;
-    QSystemTrayIcon* icon;
-    DesktopNotifyBackend* dbus;
+    QSystemTrayIcon* icon = nullptr;
+    DesktopNotifyBackend* dbus = nullptr;
+    QTimer dispatchTimer;
+    NotificationData pending;
+    bool hasPending = false;
 };
 
 DesktopNotify::DesktopNotify(INotificationSettings& settings, QObject* parent)
     : QObject(parent)
-    , d{std::make_unique<Private>(Private{
-          settings,
-          nullptr,
-          new DesktopNotifyBackend(this),
-      })}
+    , d{std::make_unique<Private>(settings)}
 {
+    d->dbus = new DesktopNotifyBackend(this);
     connect(d->dbus, &DesktopNotifyBackend::messageClicked, this, &DesktopNotify::notificationClosed);
     if (d->icon) {
         connect(d->icon, &QSystemTrayIcon::messageClicked, this, &DesktopNotify::notificationClosed);
     }
+
+    d->dispatchTimer.setSingleShot(true);
+    d->dispatchTimer.setInterval(DISPATCH_INTERVAL_MS);
+    connect(&d->dispatchTimer, &QTimer::timeout, this, &DesktopNotify::dispatchPending);
 }
 
 DesktopNotify::~DesktopNotify() = default;
@@ -43,6 +61,38 @@ void DesktopNotify::notifyMessage(const NotificationData& notificationData)
         return;
     }
 
+    // The generator aggregates per chat ("37 message(s) from Ops"), so the
+    // newest data replaces whatever is still waiting rather than queueing
+    // behind it
+    d->pending = notificationData;
+    d->hasPending = true;
+
+    if (d->dispatchTimer.isActive()) {
+        // Rate cap: within the window we only coalesce; the timer will push
+        // the latest state when it fires
+        return;
+    }
+
+    dispatchPending();
+}
+
+/**
+ * @brief Pushes the latest pending notification to the desktop, if any.
+ *
+ * Arms the rate cap timer after every push, so a message storm costs one
+ * desktop notification per window instead of one per message.
+ */
+void DesktopNotify::dispatchPending()
+{
+    if (!d->hasPending) {
+        return;
+    }
+
+    const NotificationData notificationData = std::move(d->pending);
+    d->pending = {};
+    d->hasPending = false;
+    d->dispatchTimer.start();
+
     // Try system-backends first.
     if (d->settings.getNotifySystemBackend()) {
         if (d->dbus->showMessage(notificationData.title, notificationData.message,
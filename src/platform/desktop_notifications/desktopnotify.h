@@ -39,6 +39,9 @@ public slots:
 signals:
     void notificationClosed();
 
+private:
+    void dispatchPending();
+
 private:
     struct Private;
     const std::unique_ptr<Private> d;
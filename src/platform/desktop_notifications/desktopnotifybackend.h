@@ -25,6 +25,11 @@ private slots:
     void notificationActionInvoked(QString actionKey, QString actionValue);
     void notificationActionInvoked(uint actionKey, QString actionValue);
 
+private:
+    // Only used by the D-Bus backend implementation
+    void sendNotification(const QString& title, const QString& message, const QPixmap& pixmap);
+    void flushQueued();
+
 private:
     struct Private;
     const std::unique_ptr<Private> d;
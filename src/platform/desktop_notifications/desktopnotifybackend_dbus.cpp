@@ -14,7 +14,8 @@
 #include <QDBusConnection>
 #include <QDBusInterface>
 #include <QDBusMetaType>
-#include <QDBusReply>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
 #include <QDBusVariant>
 #include <QDir>
 #include <QFile>
@@ -37,6 +38,10 @@ const QString NOTIFY_PORTAL_DBUS_CORE_INTERFACE =
     QStringLiteral("org.freedesktop.portal.Notification");
 const QString NOTIFY_PORTAL_DBUS_CORE_OBJECT = QStringLiteral("/org/freedesktop/portal/desktop");
 
+// Give up on D-Bus and fall back to the tray icon after this many failed
+// calls in a row; a slow daemon shouldn't cost us a warning per message.
+constexpr int MAX_CONSECUTIVE_FAILURES = 3;
+
 struct NotificationSpecVersion
 {
     int major;
@@ -55,65 +60,40 @@ QDebug& operator<<(QDebug& dbg, const NotificationSpecVersion& version)
 }
 
 /**
- * Almost certainly returns 1.2, but we can support old systems here, too.
+ * Almost certainly 1.2, but we can support old systems here, too.
  *
  * https://specifications.freedesktop.org/notification-spec/1.2/protocol.html#command-get-server-information
  */
-NotificationSpecVersion getSpecVersion(QDBusInterface& notifyInterface)
+NotificationSpecVersion parseSpecVersion(const QString& versionString)
 {
-    if (!notifyInterface.isValid()) {
-        return {0, 0};
-    }
-
-    const auto res = notifyInterface.call(QStringLiteral("GetServerInformation"));
-    if (!res.errorMessage().isEmpty()) {
-        qWarning() << "Failed to get notification server information:" << res.errorMessage();
-        return {0, 0};
-    }
-
-    // QList(QVariant(QString, "gnome-shell"), QVariant(QString, "GNOME"), QVariant(QString, "46.3.1"), QVariant(QString, "1.2"))
-    const auto version = res.arguments().value(3).toString().split(QLatin1Char('.'));
+    // "GetServerInformation" -> ("gnome-shell", "GNOME", "46.3.1", "1.2")
+    const auto version = versionString.split(QLatin1Char('.'));
     return {version.value(0).toInt(), version.value(1).toInt()};
 }
 
-QStringList getCapabilities(QDBusInterface& notifyInterface)
-{
-    if (!notifyInterface.isValid()) {
-        return {};
-    }
-
-    const auto res = notifyInterface.call(QStringLiteral("GetCapabilities"));
-    if (!res.errorMessage().isEmpty()) {
-        qWarning() << "Failed to get notification capabilities:" << res.errorMessage();
-        return {};
-    }
-
-    // QList(QVariant(QStringList, QList("actions", "body", "body-markup", "icon-static", "persistence", "sound")))
-    return res.arguments().value(0).toStringList();
-}
-
 // https://flatpak.github.io/xdg-desktop-portal/docs/doc-org.freedesktop.portal.Notification.html#org-freedesktop-portal-notification-addnotification
 //
-// Implements the "bytes" (ay) variant of "icon" (v).
+// Implements the "bytes" (ay) variant of "icon" (v). Holds the already
+// encoded PNG, so encoding happens once per avatar rather than per call.
 struct DBusPortalImage
 {
-    QByteArray data() const
-    {
-        QBuffer buffer;
-        buffer.open(QIODevice::WriteOnly);
-        image.save(&buffer, "PNG");
-        return buffer.data();
-    }
-
-    QImage image;
+    QByteArray pngData;
 };
 
+DBusPortalImage encodePortalImage(const QImage& image)
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "PNG");
+    return DBusPortalImage{buffer.data()};
+}
+
 QDBusArgument& operator<<(QDBusArgument& argument, const DBusPortalImage& image)
 {
     argument.beginStructure();
     argument << QStringLiteral("bytes");
     // Must be QDBusVariant because the signature is "v" (variant).
-    argument << QDBusVariant(image.data());
+    argument << QDBusVariant(image.pngData);
     argument.endStructure();
     return argument;
 }
@@ -127,8 +107,7 @@ const QDBusArgument& operator>>(const QDBusArgument& argument, DBusPortalImage&
         // Unpack the DBus variant.
         QDBusVariant variant;
         argument >> variant;
-        const QByteArray data = variant.variant().value<QByteArray>();
-        image = DBusPortalImage{QImage::fromData(data, "PNG")};
+        image = DBusPortalImage{variant.variant().value<QByteArray>()};
     }
     argument.endStructure();
     return argument;
@@ -136,15 +115,21 @@ const QDBusArgument& operator>>(const QDBusArgument& argument, DBusPortalImage&
 
 // https://specifications.freedesktop.org/notification-spec/latest/icons-and-images.html#icons-and-images-formats
 //
-// image-data (iiibiiay)
+// image-data (iiibiiay). Holds an image already converted to RGBA8888, so
+// the conversion happens once per avatar rather than per call.
 struct DBusNotifyImage
 {
-    QImage image;
+    QImage rgba;
 };
 
+DBusNotifyImage makeNotifyImage(const QImage& image)
+{
+    return DBusNotifyImage{image.convertToFormat(QImage::Format_RGBA8888)};
+}
+
 QDBusArgument& operator<<(QDBusArgument& argument, const DBusNotifyImage& image)
 {
-    const QImage rgba = image.image.convertToFormat(QImage::Format_RGBA8888);
+    const QImage& rgba = image.rgba;
     argument.beginStructure();
     argument << rgba.width();
     argument << rgba.height();
@@ -263,7 +248,7 @@ QVariantMap getIconHint(const QPixmap& pixmap, const NotificationSpecVersion& sp
                       "in-memory image sending";
     }
 
-    return {{imageDataFieldName(specVersion), QVariant::fromValue(DBusNotifyImage{pixmap.toImage()})}};
+    return {{imageDataFieldName(specVersion), QVariant::fromValue(makeNotifyImage(pixmap.toImage()))}};
 }
 } // namespace
 
@@ -274,22 +259,38 @@ struct DesktopNotifyBackend::Private
 {
     QDBusInterface notifyInterface;
     QDBusInterface notifyPortalInterface;
-    const NotificationSpecVersion specVersion;
-    const QStringList capabilities;
+    NotificationSpecVersion specVersion{0, 0};
+    QStringList capabilities;
     QMutex iconMutex;
     std::unique_ptr<QTemporaryFile> iconFile;
     uint id = 0;
 
+    // Spec version and capabilities are fetched asynchronously at startup;
+    // notifications arriving before the answers are queued
+    int pendingIntrospections = 2;
+    // At most one call is in flight; the newest waiting notification
+    // supersedes older ones since replaces_id collapses them anyway
+    bool callInFlight = false;
+    bool hasQueued = false;
+    QString queuedTitle;
+    QString queuedMessage;
+    QPixmap queuedPixmap;
+    int consecutiveFailures = 0;
+
+    // Marshalled icon data keyed by QPixmap::cacheKey(), i.e. per avatar
+    // revision, so format conversion and PNG encoding run once per avatar
+    qint64 iconHintKey = -1;
+    QVariantMap iconHintCache;
+    qint64 portalIconKey = -1;
+    QVariant portalIconCache;
+
     explicit Private(QObject* parent)
         : notifyInterface(NOTIFY_DBUS_NAME, NOTIFY_DBUS_CORE_OBJECT, NOTIFY_DBUS_CORE_INTERFACE,
                           QDBusConnection::sessionBus(), parent)
         , notifyPortalInterface(NOTIFY_PORTAL_DBUS_NAME, NOTIFY_PORTAL_DBUS_CORE_OBJECT,
                                 NOTIFY_PORTAL_DBUS_CORE_INTERFACE, QDBusConnection::sessionBus(),
                                 parent)
-        , specVersion(getSpecVersion(notifyInterface))
-        , capabilities(getCapabilities(notifyInterface))
     {
-        qDebug() << "Notification spec version:" << specVersion << "capabilities:" << capabilities;
         qDBusRegisterMetaType<DBusPortalImage>();
         qDBusRegisterMetaType<DBusNotifyImage>();
         // Set a 1 second timeout for all DBus calls. In case these calls freeze
@@ -297,12 +298,74 @@ struct DesktopNotifyBackend::Private
         notifyInterface.setTimeout(1000);
         notifyPortalInterface.setTimeout(1000);
     }
+
+    QVariantMap cachedIconHint(const QPixmap& pixmap)
+    {
+        const qint64 key = pixmap.cacheKey();
+        if (key != iconHintKey) {
+            iconHintCache =
+                getIconHint(pixmap, specVersion, capabilities, iconMutex, iconFile, QTOX_NOTIFY_TEMP_FILE);
+            iconHintKey = key;
+        }
+        return iconHintCache;
+    }
+
+    QVariant cachedPortalIcon(const QPixmap& pixmap)
+    {
+        const qint64 key = pixmap.cacheKey();
+        if (key != portalIconKey) {
+            portalIconCache = QVariant::fromValue(encodePortalImage(pixmap.toImage()));
+            portalIconKey = key;
+        }
+        return portalIconCache;
+    }
 };
 
 DesktopNotifyBackend::DesktopNotifyBackend(QObject* parent)
     : QObject(parent)
     , d{std::make_unique<Private>(this)}
 {
+    if (d->notifyInterface.isValid()) {
+        // Query the server once, asynchronously: a slow daemon (e.g. behind a
+        // flatpak portal) must not block the GUI thread at startup, and
+        // per-call introspection would be wasted work
+        auto* versionWatcher = new QDBusPendingCallWatcher(
+            d->notifyInterface.asyncCall(QStringLiteral("GetServerInformation")), this);
+        connect(versionWatcher, &QDBusPendingCallWatcher::finished, this,
+                [this](QDBusPendingCallWatcher* watcher) {
+                    watcher->deleteLater();
+                    const QDBusPendingReply<QString, QString, QString, QString> reply = *watcher;
+                    if (reply.isError()) {
+                        qWarning() << "Failed to get notification server information:"
+                                   << reply.error().message();
+                    } else {
+                        d->specVersion = parseSpecVersion(reply.argumentAt<3>());
+                        qDebug() << "Notification spec version:" << d->specVersion;
+                    }
+                    --d->pendingIntrospections;
+                    flushQueued();
+                });
+
+        auto* capabilitiesWatcher = new QDBusPendingCallWatcher(
+            d->notifyInterface.asyncCall(QStringLiteral("GetCapabilities")), this);
+        connect(capabilitiesWatcher, &QDBusPendingCallWatcher::finished, this,
+                [this](QDBusPendingCallWatcher* watcher) {
+                    watcher->deleteLater();
+                    const QDBusPendingReply<QStringList> reply = *watcher;
+                    if (reply.isError()) {
+                        qWarning() << "Failed to get notification capabilities:"
+                                   << reply.error().message();
+                    } else {
+                        d->capabilities = reply.value();
+                        qDebug() << "Notification capabilities:" << d->capabilities;
+                    }
+                    --d->pendingIntrospections;
+                    flushQueued();
+                });
+    } else {
+        d->pendingIntrospections = 0;
+    }
+
     if (d->notifyPortalInterface.isValid()) {
         QDBusConnection::sessionBus().connect(
             // org.freedesktop.portal.Notification::ActionInvoked
@@ -322,18 +385,52 @@ DesktopNotifyBackend::~DesktopNotifyBackend() = default;
 bool DesktopNotifyBackend::showMessage(const QString& title, const QString& message,
                                        const QPixmap& pixmap)
 {
-    // Try Notify first.
-    if (d->notifyInterface.isValid()) {
+    if (!d->notifyInterface.isValid() && !d->notifyPortalInterface.isValid()) {
+        return false;
+    }
+
+    if (d->consecutiveFailures >= MAX_CONSECUTIVE_FAILURES) {
+        // The server keeps erroring out; let the caller use its fallback
+        return false;
+    }
+
+    if (d->pendingIntrospections > 0 || d->callInFlight) {
+        // Replace rather than queue: the aggregated counts in the newest
+        // notification supersede older ones, like replaces_id does on screen
+        d->queuedTitle = title;
+        d->queuedMessage = message;
+        d->queuedPixmap = pixmap;
+        d->hasQueued = true;
+        return true;
+    }
+
+    sendNotification(title, message, pixmap);
+    return true;
+}
+
+/**
+ * @brief Dispatches one notification asynchronously.
+ *
+ * The GUI thread never waits on the daemon: the reply (and the notification
+ * id used for replacement) is handled by a pending call watcher, which also
+ * sends whatever got queued while the call was in flight.
+ */
+void DesktopNotifyBackend::sendNotification(const QString& title, const QString& message,
+                                            const QPixmap& pixmap)
+{
+    QDBusPendingCall call = QDBusPendingCall::fromError({});
+    const bool viaPortal = !d->notifyInterface.isValid();
+
+    if (!viaPortal) {
         QVariantMap hints{
             {QStringLiteral("action-icons"), true},
             {QStringLiteral("category"), QStringLiteral("im.received")},
             {QStringLiteral("sender-pid"),
              QVariant::fromValue<quint64>(QCoreApplication::applicationPid())},
         };
-        hints.insert(getIconHint(pixmap, d->specVersion, d->capabilities, d->iconMutex, d->iconFile,
-                                 QTOX_NOTIFY_TEMP_FILE));
+        hints.insert(d->cachedIconHint(pixmap));
         // https://specifications.freedesktop.org/notification-spec/1.2/protocol.html#command-notify
-        const auto res = d->notifyInterface.call( //
+        call = d->notifyInterface.asyncCall( //
             QStringLiteral("Notify"),
             // app_name
             QApplication::applicationName(),
@@ -351,20 +448,11 @@ bool DesktopNotifyBackend::showMessage(const QString& title, const QString& mess
             hints,
             // expire_timeout
             -1);
-        if (!res.errorMessage().isEmpty()) {
-            qWarning() << "Notification could not be shown via Notifications:" << res.errorMessage();
-            return false;
-        }
-        d->id = res.arguments().value(0).toUInt();
-        return true;
-    }
-
-    // Otherwise, try the Portal.
-    if (d->notifyPortalInterface.isValid()) {
+    } else {
         const QString notificationId = QStringLiteral("qtox-notification-%1").arg(d->id);
 
         // https://flatpak.github.io/xdg-desktop-portal/docs/doc-org.freedesktop.portal.Notification.html#org-freedesktop-portal-notification-addnotification
-        const auto res = d->notifyPortalInterface.call( //
+        call = d->notifyPortalInterface.asyncCall( //
             QStringLiteral("AddNotification"),
             // IN id s
             notificationId,
@@ -375,17 +463,50 @@ bool DesktopNotifyBackend::showMessage(const QString& title, const QString& mess
                 // body (s)
                 {QStringLiteral("body"), message},
                 // icon (v)
-                {QStringLiteral("icon"), QVariant::fromValue(DBusPortalImage{pixmap.toImage()})},
+                {QStringLiteral("icon"), d->cachedPortalIcon(pixmap)},
                 // default-action (s)
                 {QStringLiteral("default-action"), QStringLiteral("default")},
             });
-        if (res.errorMessage().isEmpty()) {
-            return true;
-        }
-        qWarning() << "Notification could not be shown via Portal:" << res.errorMessage();
     }
 
-    return false;
+    d->callInFlight = true;
+    auto* watcher = new QDBusPendingCallWatcher(call, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this,
+            [this, viaPortal](QDBusPendingCallWatcher* finished) {
+                finished->deleteLater();
+                d->callInFlight = false;
+                if (finished->isError()) {
+                    qWarning() << "Notification could not be shown via"
+                               << (viaPortal ? "Portal:" : "Notifications:")
+                               << finished->error().message();
+                    ++d->consecutiveFailures;
+                } else {
+                    d->consecutiveFailures = 0;
+                    if (!viaPortal) {
+                        const QDBusPendingReply<uint> reply = *finished;
+                        d->id = reply.value();
+                    }
+                }
+                flushQueued();
+            });
+}
+
+/**
+ * @brief Sends the queued notification once introspection and the previous
+ * call have both finished.
+ */
+void DesktopNotifyBackend::flushQueued()
+{
+    if (d->pendingIntrospections > 0 || d->callInFlight || !d->hasQueued) {
+        return;
+    }
+
+    d->hasQueued = false;
+    const QString title = d->queuedTitle;
+    const QString message = d->queuedMessage;
+    const QPixmap pixmap = d->queuedPixmap;
+    d->queuedPixmap = {};
+    sendNotification(title, message, pixmap);
 }
 #endif // QT_CONFIG(dbus)
 
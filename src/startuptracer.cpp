@@ -0,0 +1,84 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "startuptracer.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+
+StartupTracer::Scope::Scope(const char* name_)
+    : name{name_}
+    , startUs{StartupTracer::instance().nowUs()}
+{
+}
+
+StartupTracer::Scope::~Scope()
+{
+    auto& tracer = StartupTracer::instance();
+    tracer.record(name, startUs, tracer.nowUs() - startUs);
+}
+
+StartupTracer::StartupTracer()
+{
+    clock.start();
+}
+
+StartupTracer& StartupTracer::instance()
+{
+    // The clock anchors at the first use, so instance() should be called as
+    // early in main() as possible
+    static StartupTracer tracer;
+    return tracer;
+}
+
+qint64 StartupTracer::nowUs() const
+{
+    return clock.nsecsElapsed() / 1000;
+}
+
+void StartupTracer::record(const char* name, qint64 startUs, qint64 durationUs)
+{
+    // One greppable line per phase so CI can diff runs without the JSON
+    qDebug().nospace() << "Startup phase " << name << " took " << durationUs / 1000.0 << " ms";
+
+    QMutexLocker locker{&mutex};
+    phases.append(Phase{QString::fromUtf8(name), startUs, durationUs});
+}
+
+void StartupTracer::flush(const QString& filePath)
+{
+    qDebug().nospace() << "Startup took " << nowUs() / 1000.0 << " ms";
+
+    QJsonArray events;
+    {
+        QMutexLocker locker{&mutex};
+        for (const Phase& phase : phases) {
+            QJsonObject event;
+            event["name"] = phase.name;
+            event["ph"] = QStringLiteral("X");
+            event["ts"] = phase.startUs;
+            event["dur"] = phase.durationUs;
+            event["pid"] = QCoreApplication::applicationPid();
+            event["tid"] = 1;
+            events.append(event);
+        }
+    }
+
+    QJsonObject trace;
+    trace["traceEvents"] = events;
+    trace["displayTimeUnit"] = QStringLiteral("ms");
+
+    QFile file{filePath};
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Unable to write startup trace to" << filePath;
+        return;
+    }
+    file.write(QJsonDocument{trace}.toJson());
+    qDebug() << "Startup trace written to" << filePath;
+}
@@ -0,0 +1,55 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Records how long each startup phase takes.
+ *
+ * Phases are marked with RAII Scope objects through AppManager::run,
+ * Nexus::start and Profile::loadProfile. Each phase is logged as it
+ * completes so CI can compare runs from the log alone, and flush() writes
+ * all phases as a chrome://tracing compatible JSON file for local digging.
+ */
+class StartupTracer
+{
+public:
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name_);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* name;
+        qint64 startUs;
+    };
+
+    static StartupTracer& instance();
+
+    qint64 nowUs() const;
+    void record(const char* name, qint64 startUs, qint64 durationUs);
+    void flush(const QString& filePath);
+
+private:
+    StartupTracer();
+
+    struct Phase
+    {
+        QString name;
+        qint64 startUs;
+        qint64 durationUs;
+    };
+
+    QElapsedTimer clock;
+    QVector<Phase> phases;
+    QMutex mutex;
+};
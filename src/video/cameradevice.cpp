@@ -103,6 +103,10 @@ struct AVFormatContextDeleter
 
 QHash<QString, CameraDevice*> CameraDevice::openDevices;
 QMutex CameraDevice::openDeviceLock, CameraDevice::iformatLock;
+QMutex CameraDevice::deviceCacheLock;
+bool CameraDevice::deviceListCached = false;
+QVector<QPair<QString, QString>> CameraDevice::cachedDeviceList;
+QHash<QString, QVector<VideoMode>> CameraDevice::cachedVideoModes;
 
 CameraDevice::CameraDevice(const QString& devName_, AVFormatContext* context_)
     : devName{devName_}
@@ -368,8 +372,29 @@ QVector<QPair<QString, QString>> CameraDevice::getRawDeviceListGeneric()
  * @brief Get device list with description
  * @return A list of device names and descriptions.
  * The names are the first part of the pair and can be passed to open(QString).
+ *
+ * The scan opens every capture device it finds and can take seconds with
+ * several cameras plugged in, so the result is cached until
+ * invalidateDeviceCaches() is called. Safe to call from a worker thread.
  */
 QVector<QPair<QString, QString>> CameraDevice::getDeviceList()
+{
+    {
+        QMutexLocker locker{&deviceCacheLock};
+        if (deviceListCached) {
+            return cachedDeviceList;
+        }
+    }
+
+    QVector<QPair<QString, QString>> devices = scanDeviceList();
+
+    QMutexLocker locker{&deviceCacheLock};
+    cachedDeviceList = devices;
+    deviceListCached = true;
+    return devices;
+}
+
+QVector<QPair<QString, QString>> CameraDevice::scanDeviceList()
 {
     QVector<QPair<QString, QString>> devices{{"none", QObject::tr("None", "No camera device set")}};
 
@@ -474,15 +499,38 @@ QVector<VideoMode> CameraDevice::getScreenModes()
  * @brief Get the list of video modes for a device.
  * @param devName Device name to get nodes from.
  * @return Vector of available modes for the device.
+ *
+ * Probing opens the device, so camera results are cached until
+ * invalidateDeviceCaches() is called. Screen modes only depend on the
+ * current monitor geometry and are always computed fresh.
  */
 QVector<VideoMode> CameraDevice::getVideoModes(QString devName)
+{
+    if (isScreen(devName)) {
+        return getScreenModes();
+    }
+
+    {
+        QMutexLocker locker{&deviceCacheLock};
+        const auto it = cachedVideoModes.constFind(devName);
+        if (it != cachedVideoModes.constEnd()) {
+            return *it;
+        }
+    }
+
+    QVector<VideoMode> modes = scanVideoModes(devName);
+
+    QMutexLocker locker{&deviceCacheLock};
+    cachedVideoModes.insert(devName, modes);
+    return modes;
+}
+
+QVector<VideoMode> CameraDevice::scanVideoModes(QString devName)
 {
     std::ignore = devName;
 
     if (!iformat)
         ;
-    else if (isScreen(devName))
-        return getScreenModes();
 #if defined(USING_V4L)
     else if (QString::fromUtf8(iformat->name) == QStringLiteral("video4linux2,v4l2"))
         return v4l2::getDeviceModes(devName);
@@ -501,6 +549,20 @@ QVector<VideoMode> CameraDevice::getVideoModes(QString devName)
     return {};
 }
 
+/**
+ * @brief Drops the cached device and mode lists.
+ *
+ * Called when the user asks for a rescan or a hotplug is suspected; the next
+ * getDeviceList()/getVideoModes() call probes the hardware again.
+ */
+void CameraDevice::invalidateDeviceCaches()
+{
+    QMutexLocker locker{&deviceCacheLock};
+    deviceListCached = false;
+    cachedDeviceList.clear();
+    cachedVideoModes.clear();
+}
+
 /**
  * @brief Get the name of the pixel format of a video mode.
  * @param pixel_format Pixel format to get the name from.
@@ -29,6 +29,7 @@ public:
     static QVector<QPair<QString, QString>> getDeviceList();
 
     static QVector<VideoMode> getVideoModes(QString devName);
+    static void invalidateDeviceCaches();
     static QString getPixelFormatString(uint32_t pixel_format);
     static bool betterPixelFormat(uint32_t a, uint32_t b);
 
@@ -41,6 +42,8 @@ private:
     static CameraDevice* open(QString devName, AVDictionary** options);
     static bool getDefaultInputFormat();
     static QVector<QPair<QString, QString>> getRawDeviceListGeneric();
+    static QVector<QPair<QString, QString>> scanDeviceList();
+    static QVector<VideoMode> scanVideoModes(QString devName);
     static QVector<VideoMode> getScreenModes();
 
 public:
@@ -51,4 +54,11 @@ private:
     std::atomic_int refcount;
     static QHash<QString, CameraDevice*> openDevices;
     static QMutex openDeviceLock, iformatLock;
+    // Enumerating devices and probing their modes opens the hardware; the
+    // results are cached here so the AV settings page doesn't pay that cost
+    // on every show. Guarded by deviceCacheLock.
+    static QMutex deviceCacheLock;
+    static bool deviceListCached;
+    static QVector<QPair<QString, QString>> cachedDeviceList;
+    static QHash<QString, QVector<VideoMode>> cachedVideoModes;
 };
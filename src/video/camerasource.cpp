@@ -10,6 +10,8 @@ extern "C"
 #include <libavcodec/avcodec.h>
 #include <libavdevice/avdevice.h>
 #include <libavformat/avformat.h>
+#include <libavutil/hwcontext.h>
+#include <libavutil/imgutils.h>
 #include <libswscale/swscale.h>
 #pragma GCC diagnostic pop
 }
@@ -17,11 +19,13 @@ extern "C"
 #include "camerasource.h"
 #include "videoframe.h"
 #include "src/persistence/settings.h"
+#include "util/threadplacement.h"
 #include <QDebug>
 #include <QLoggingCategory>
 #include <QReadLocker>
 #include <QWriteLocker>
 #include <QtConcurrent/QtConcurrentRun>
+#include <cstring>
 
 /**
  * @class CameraSource
@@ -77,6 +81,40 @@ extern "C"
  */
 
 namespace {
+// How often an unchanged screen still emits a frame, so consumers keep
+// refreshing; this is the effective frame interval of a static screen share
+constexpr int screenKeepaliveIntervalMs = 500;
+
+/**
+ * @brief Whether two decoded frames show different content.
+ *
+ * Compares plane 0 row by row with an early exit on the first difference.
+ * Plane 0 is the whole image for the packed RGB formats the screen grabbers
+ * produce, and the luma plane for planar formats, where luma-only comparison
+ * is enough to detect on-screen motion. memcmp leaves the heavy lifting to
+ * the libc vectorized implementation.
+ */
+bool framesDiffer(const AVFrame* a, const AVFrame* b)
+{
+    if (a->format != b->format || a->width != b->width || a->height != b->height) {
+        return true;
+    }
+
+    const int rowBytes = av_image_get_linesize(static_cast<AVPixelFormat>(a->format), a->width, 0);
+    if (rowBytes <= 0) {
+        return true;
+    }
+
+    for (int y = 0; y < a->height; ++y) {
+        if (memcmp(a->data[0] + y * static_cast<ptrdiff_t>(a->linesize[0]),
+                   b->data[0] + y * static_cast<ptrdiff_t>(b->linesize[0]), rowBytes)
+            != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 namespace logcat {
 Q_LOGGING_CATEGORY(ffmpeg, "ffmpeg")
 Q_LOGGING_CATEGORY(ffmpegInput, "ffmpeg.input")
@@ -196,6 +234,28 @@ void avLogCallback(void* obj, int level, const char* fmt, va_list args)
 #endif
     }
 } // namespace logcat
+
+/**
+ * @brief get_format callback selecting the negotiated hardware pixel format.
+ *
+ * The decoder offers its supported output formats here; we pick the hardware
+ * format chosen during setupHwDecoder() if it is offered and otherwise fall
+ * back to the first (software) format, which keeps decoding working when the
+ * hardware path fails mid-stream.
+ */
+AVPixelFormat getHwFormat(AVCodecContext* ctx, const AVPixelFormat* formats)
+{
+    const auto* source = static_cast<const CameraSource*>(ctx->opaque);
+
+    for (const AVPixelFormat* fmt = formats; *fmt != AV_PIX_FMT_NONE; ++fmt) {
+        if (*fmt == source->getHwPixelFormat()) {
+            return *fmt;
+        }
+    }
+
+    qWarning() << "Hardware pixel format not offered by decoder, using software decoding";
+    return formats[0];
+}
 } // namespace
 
 CameraSource::CameraSource(Settings& settings_)
@@ -208,6 +268,7 @@ CameraSource::CameraSource(Settings& settings_)
     , cctxOrig{nullptr}
 #endif
     , videoStreamIndex{-1}
+    , hwPixelFormat{AV_PIX_FMT_NONE}
     , isNone_{true}
     , subscriptions{0}
     , settings{settings_}
@@ -216,8 +277,11 @@ CameraSource::CameraSource(Settings& settings_)
 
     qRegisterMetaType<VideoMode>("VideoMode");
     deviceThread->setObjectName("Device thread");
-    deviceThread->start();
+    connect(deviceThread, &QThread::started, this,
+            [] { ThreadPlacement::registerCurrentThread(QStringLiteral("Camera device")); });
     moveToThread(deviceThread);
+    // Elevated so frame capture keeps pace during calls while the GUI is busy
+    deviceThread->start(QThread::HighPriority);
 
     subscriptions = 0;
 
@@ -305,6 +369,7 @@ CameraSource::~CameraSource()
     if (cctx) {
         avcodec_free_context(&cctx);
     }
+    av_frame_free(&lastScreenFrame);
 #if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(57, 48, 101)
     if (cctxOrig) {
         avcodec_close(cctxOrig);
@@ -347,6 +412,64 @@ void CameraSource::unsubscribe()
  * @brief Opens the video device and starts streaming.
  * @note Callers must own the biglock.
  */
+/**
+ * @brief Probes for a usable hardware decoding device for the given codec.
+ *
+ * Walks the hardware device types compiled into ffmpeg (VAAPI, VideoToolbox,
+ * D3D11VA, ...) in their registration order and keeps the first one that both
+ * supports the codec and can actually be opened on this machine. Purely
+ * best-effort: when nothing sticks we decode in software exactly as before.
+ */
+void CameraSource::setupHwDecoder(const AVCodec* codec)
+{
+    for (AVHWDeviceType type = av_hwdevice_iterate_types(AV_HWDEVICE_TYPE_NONE);
+         type != AV_HWDEVICE_TYPE_NONE; type = av_hwdevice_iterate_types(type)) {
+        for (int i = 0;; ++i) {
+            const AVCodecHWConfig* config = avcodec_get_hw_config(codec, i);
+            if (!config) {
+                break;
+            }
+
+            if (!(config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX)
+                || config->device_type != type) {
+                continue;
+            }
+
+            AVBufferRef* deviceCtx = nullptr;
+            if (av_hwdevice_ctx_create(&deviceCtx, type, nullptr, nullptr, 0) < 0) {
+                // Supported in theory but not openable on this machine
+                break;
+            }
+
+            hwDeviceCtx = deviceCtx;
+            hwPixelFormat = config->pix_fmt;
+            hwDeviceName = QString::fromUtf8(av_hwdevice_get_type_name(type));
+            qDebug() << "Using hardware decoder" << hwDeviceName << "for" << codec->name;
+            return;
+        }
+    }
+
+    qDebug() << "No hardware decoder available for" << codec->name << ", decoding in software";
+}
+
+/**
+ * @brief Name of the active hardware decoding backend.
+ * @return the backend name (e.g. "vaapi"), or an empty string when decoding
+ * in software.
+ */
+QString CameraSource::getHwDecoderName() const
+{
+    return hwDeviceName;
+}
+
+/**
+ * @brief The negotiated hardware pixel format, AV_PIX_FMT_NONE for software.
+ */
+int CameraSource::getHwPixelFormat() const
+{
+    return hwPixelFormat;
+}
+
 void CameraSource::openDevice()
 {
     if (QThread::currentThread() != deviceThread) {
@@ -370,6 +493,7 @@ void CameraSource::openDevice()
 
     // We need to create a new CameraDevice
     device = CameraDevice::open(deviceName, mode);
+    screenGrab = CameraDevice::isScreen(deviceName);
 
     if (!device) {
         qWarning() << "Failed to open device" << deviceName;
@@ -437,14 +561,44 @@ void CameraSource::openDevice()
         emit openFailed();
         return;
     }
+
+    // Try to negotiate a hardware decoding path; harmless when none is found
+    setupHwDecoder(codec);
+    if (hwDeviceCtx) {
+        cctx->hw_device_ctx = av_buffer_ref(hwDeviceCtx);
+        cctx->opaque = this;
+        cctx->get_format = getHwFormat;
+    }
 #endif
 
     // Open codec
     if (avcodec_open2(cctx, codec, nullptr) < 0) {
-        qWarning() << "Can't open codec" << codec->name;
-        avcodec_free_context(&cctx);
-        emit openFailed();
-        return;
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 48, 101)
+        if (hwDeviceCtx) {
+            // Transparent fallback: retry the open in software
+            qWarning() << "Can't open codec" << codec->name << "with" << hwDeviceName
+                       << "hardware decoding, falling back to software";
+            avcodec_free_context(&cctx);
+            av_buffer_unref(&hwDeviceCtx);
+            hwPixelFormat = AV_PIX_FMT_NONE;
+            hwDeviceName.clear();
+
+            cctx = avcodec_alloc_context3(codec);
+            if (!cctx || avcodec_parameters_to_context(cctx, cparams) < 0
+                || avcodec_open2(cctx, codec, nullptr) < 0) {
+                qWarning() << "Can't open codec" << codec->name;
+                avcodec_free_context(&cctx);
+                emit openFailed();
+                return;
+            }
+        } else
+#endif
+        {
+            qWarning() << "Can't open codec" << codec->name;
+            avcodec_free_context(&cctx);
+            emit openFailed();
+            return;
+        }
     }
 
     if (streamFuture.isRunning()) {
@@ -485,6 +639,9 @@ void CameraSource::closeDevice()
     // Free our resources and close the device
     videoStreamIndex = -1;
     avcodec_free_context(&cctx);
+    av_buffer_unref(&hwDeviceCtx);
+    hwPixelFormat = AV_PIX_FMT_NONE;
+    hwDeviceName.clear();
 #if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(57, 48, 101)
     avcodec_close(cctxOrig);
     cctxOrig = nullptr;
@@ -492,6 +649,39 @@ void CameraSource::closeDevice()
     while (device && !device->close()) {
     }
     device = nullptr;
+
+    if (droppedStaticFrames > 0) {
+        qDebug() << "Dropped" << droppedStaticFrames << "unchanged screen frames";
+        droppedStaticFrames = 0;
+    }
+    av_frame_free(&lastScreenFrame);
+    lastScreenFrameTimer.invalidate();
+    screenGrab = false;
+}
+
+/**
+ * @brief Damage check for screen sharing: whether a frame is worth emitting.
+ *
+ * The grabbers capture the full screen at the configured rate even when
+ * nothing on it changed, and every emitted frame goes through scaling and
+ * encoding. Frames identical to the last emitted one are dropped, throttling
+ * a static screen share down to the keepalive interval; the first changed
+ * frame goes out immediately, so motion keeps the full frame rate.
+ */
+bool CameraSource::shouldEmitScreenFrame(const AVFrame* frame)
+{
+    if (lastScreenFrame && lastScreenFrameTimer.isValid()
+        && !lastScreenFrameTimer.hasExpired(screenKeepaliveIntervalMs)
+        && !framesDiffer(frame, lastScreenFrame)) {
+        ++droppedStaticFrames;
+        return false;
+    }
+
+    // av_frame_clone only refs the decoder's buffer, it doesn't copy pixels
+    av_frame_free(&lastScreenFrame);
+    lastScreenFrame = av_frame_clone(frame);
+    lastScreenFrameTimer.start();
+    return true;
 }
 
 /**
@@ -532,7 +722,23 @@ void CameraSource::stream()
         if (readyToReceive) {
             AVFrame* frame = av_frame_alloc();
             if (frame && !avcodec_receive_frame(cctx, frame)) {
-                emit frameAvailable(VideoFrame::fromAVFrame(id, frame));
+                if (hwPixelFormat != AV_PIX_FMT_NONE && frame->format == hwPixelFormat) {
+                    // Frame lives in GPU memory, download it before handing
+                    // it to the consumers
+                    AVFrame* swFrame = av_frame_alloc();
+                    if (swFrame && av_hwframe_transfer_data(swFrame, frame, 0) == 0) {
+                        av_frame_free(&frame);
+                        emit frameAvailable(VideoFrame::fromAVFrame(id, swFrame));
+                    } else {
+                        qWarning() << "Failed to download hardware decoded frame";
+                        av_frame_free(&swFrame);
+                        av_frame_free(&frame);
+                    }
+                } else if (!screenGrab || shouldEmitScreenFrame(frame)) {
+                    emit frameAvailable(VideoFrame::fromAVFrame(id, frame));
+                } else {
+                    av_frame_free(&frame);
+                }
             } else {
                 av_frame_free(&frame);
             }
@@ -7,15 +7,20 @@
 
 #include "src/video/videomode.h"
 #include "src/video/videosource.h"
+#include <QElapsedTimer>
 #include <QFuture>
 #include <QHash>
 #include <QReadWriteLock>
 #include <QString>
 #include <QVector>
 #include <atomic>
+#include <cstdint>
 
 class CameraDevice;
+struct AVBufferRef;
+struct AVCodec;
 struct AVCodecContext;
+struct AVFrame;
 class Settings;
 
 class CameraSource : public VideoSource
@@ -27,6 +32,8 @@ public:
     ~CameraSource();
     void setupDefault();
     bool isNone() const;
+    QString getHwDecoderName() const;
+    int getHwPixelFormat() const;
 
     // VideoSource interface
     void subscribe() override;
@@ -41,6 +48,8 @@ signals:
 
 private:
     void stream();
+    void setupHwDecoder(const AVCodec* codec);
+    bool shouldEmitScreenFrame(const AVFrame* frame);
 
 private slots:
     void openDevice();
@@ -58,6 +67,19 @@ private:
     AVCodecContext* cctxOrig;
     int videoStreamIndex;
 
+    // Hardware decoding state; hwPixelFormat is AV_PIX_FMT_NONE and
+    // hwDeviceCtx is null when decoding in software
+    AVBufferRef* hwDeviceCtx = nullptr;
+    std::atomic_int hwPixelFormat;
+    QString hwDeviceName;
+
+    // Screen-share damage tracking; only used while the open device is a
+    // screen grabber. Guarded by streamMutex like the rest of the stream state.
+    bool screenGrab = false;
+    AVFrame* lastScreenFrame = nullptr;
+    QElapsedTimer lastScreenFrameTimer;
+    uint64_t droppedStaticFrames = 0;
+
     QReadWriteLock deviceMutex;
     QReadWriteLock streamMutex;
 
@@ -38,43 +38,38 @@ CoreVideoSource::CoreVideoSource()
     , deleteOnClose{false}
     , stopped{false}
 {
+    // The doorbell hops from the decoder thread onto this object's thread,
+    // where the newest frame is taken out of the mailbox and published
+    connect(this, &CoreVideoSource::frameQueued, this, &CoreVideoSource::deliverFrame,
+            Qt::QueuedConnection);
 }
 
 /**
- * @brief Makes a copy of the vpx_image_t and emits it as a new VideoFrame.
+ * @brief Makes a copy of the vpx_image_t and publishes it as a new VideoFrame.
  * @param vpxFrame Frame to copy.
+ *
+ * Called on the decoder thread. The frame goes into a single-slot mailbox
+ * keeping only the newest frame; if the previous occupant was never picked up
+ * it is dropped here, before any conversion was spent on it. No lock is taken,
+ * so the decoder never waits on the rendering side.
  */
 void CoreVideoSource::pushFrame(const vpx_image_t* vpxFrame)
 {
     if (stopped)
         return;
 
-    QMutexLocker<QMutex> locker(&biglock);
-
-    std::shared_ptr<VideoFrame> vframe;
     int width = vpxFrame->d_w;
     int height = vpxFrame->d_h;
 
     if (subscribers <= 0)
         return;
 
-    AVFrame* avFrame = av_frame_alloc();
+    // Draws from the shared buffer pool, so the copy below reuses the buffers
+    // of frames that finished their round trip through the renderers
+    AVFrame* avFrame = VideoFrame::allocFrameBuffer(QSize(width, height), AV_PIX_FMT_YUV420P, false);
     if (!avFrame)
         return;
 
-    avFrame->width = width;
-    avFrame->height = height;
-    avFrame->format = AV_PIX_FMT_YUV420P;
-
-    int bufSize =
-        av_image_alloc(avFrame->data, avFrame->linesize, width, height,
-                       static_cast<AVPixelFormat>(AV_PIX_FMT_YUV420P), VideoFrame::dataAlignment);
-
-    if (bufSize < 0) {
-        av_frame_free(&avFrame);
-        return;
-    }
-
     for (int i = 0; i < 3; ++i) {
         int dstStride = avFrame->linesize[i];
         int srcStride = vpxFrame->stride[i];
@@ -88,7 +83,45 @@ void CoreVideoSource::pushFrame(const vpx_image_t* vpxFrame)
         }
     }
 
-    emit frameAvailable(VideoFrame::fromAVFrameUntracked(id, avFrame, true));
+    const auto previous =
+        pendingFrame.exchange(VideoFrame::fromAVFrameUntracked(id, avFrame, true));
+
+    if (previous != nullptr) {
+        // The consumer is lagging; the replaced frame is stale and never
+        // reached a renderer
+        ++droppedFrames;
+    }
+
+    // Ring the doorbell only if no delivery is already on its way, so a slow
+    // consumer cannot pile up queued events holding frame buffers alive
+    if (!deliveryPending.exchange(true)) {
+        emit frameQueued();
+    }
+}
+
+/**
+ * @brief Takes the newest frame out of the mailbox and publishes it.
+ *
+ * Runs on this object's thread via the queued frameQueued connection.
+ */
+void CoreVideoSource::deliverFrame()
+{
+    // Clear the flag before emptying the mailbox: a frame pushed in between
+    // rings the doorbell again and at worst finds an empty mailbox
+    deliveryPending = false;
+
+    if (auto frame = pendingFrame.exchange(nullptr)) {
+        emit frameAvailable(std::move(frame));
+    }
+}
+
+/**
+ * @brief Number of frames dropped because they were replaced by a newer one
+ * before any renderer picked them up.
+ */
+std::uint64_t CoreVideoSource::getDroppedFrames() const
+{
+    return droppedFrames;
 }
 
 void CoreVideoSource::subscribe()
@@ -131,6 +164,9 @@ void CoreVideoSource::stopSource()
 {
     QMutexLocker<QMutex> locker(&biglock);
     stopped = true;
+    // Drop anything still waiting so a held call does not deliver a stale
+    // frame when the doorbell fires
+    pendingFrame.exchange(nullptr);
     emit sourceStopped();
 }
 
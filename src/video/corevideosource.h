@@ -9,8 +9,12 @@
 #include "videosource.h"
 #include <QMutex>
 #include <atomic>
+#include <cstdint>
+#include <memory>
 #include <vpx/vpx_image.h>
 
+class VideoFrame;
+
 class CoreVideoSource : public VideoSource
 {
     Q_OBJECT
@@ -19,6 +23,16 @@ public:
     void subscribe() override;
     void unsubscribe() override;
 
+    std::uint64_t getDroppedFrames() const;
+
+signals:
+    // Internal doorbell from the decoder thread to this object's thread.
+    // At most one is in flight at any time; see pushFrame()
+    void frameQueued();
+
+private slots:
+    void deliverFrame();
+
 private:
     CoreVideoSource();
 
@@ -34,6 +48,13 @@ private:
     QMutex biglock;
     std::atomic_bool stopped;
 
+    // Mailbox holding the newest undelivered frame. The decoder thread swaps
+    // new frames in without taking a lock and older frames that were never
+    // picked up are dropped before any conversion happened
+    std::atomic<std::shared_ptr<VideoFrame>> pendingFrame;
+    std::atomic_bool deliveryPending{false};
+    std::atomic<std::uint64_t> droppedFrames{0};
+
     friend class CoreAV;
     friend class ToxFriendCall;
 };
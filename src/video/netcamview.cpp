@@ -327,6 +327,11 @@ void NetCamView::keyPressEvent(QKeyEvent* event)
     int key = event->key();
     if (key == Qt::Key_Escape && isFullScreen()) {
         exitFullScreen();
+    } else if (key == Qt::Key_D && event->modifiers().testFlag(Qt::ControlModifier)) {
+        // Debug overlay with frame pacing numbers on both surfaces
+        const bool enable = !videoSurface->isDebugOverlayEnabled();
+        videoSurface->setDebugOverlayEnabled(enable);
+        selfVideoSurface->setDebugOverlayEnabled(enable);
     }
 }
 
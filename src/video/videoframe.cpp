@@ -5,13 +5,21 @@
 
 #include "videoframe.h"
 
+#include "src/allocationtracker.h"
+#include "util/perfzone.h"
+
 #include <QList>
 
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
 extern "C"
 {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wold-style-cast"
 #include <libavutil/imgutils.h>
+#include <libavutil/opt.h>
 #include <libswscale/swscale.h>
 #pragma GCC diagnostic pop
 }
@@ -64,6 +72,150 @@ extern "C"
  * value for a std::unordered_map.
  */
 
+namespace {
+/**
+ * @brief Thread-local pool of swscale contexts keyed by their conversion tuple.
+ *
+ * Setting up an SwsContext involves allocating filter tables and probing for
+ * the best SIMD code path, which used to happen for every single converted
+ * frame. A single cached context covers a steady call, where every frame has
+ * the same dimensions and formats, but degenerates back to a rebuild per
+ * frame the moment two conversions alternate on one thread - a camera
+ * flapping between resolutions, or the same source converted for preview and
+ * encode at different sizes. Keeping a few contexts keyed by the full
+ * (srcW, srcH, srcFmt, dstW, dstH, dstFmt, flags) tuple rides out the
+ * alternation; the least recently used one retires when the pool is full.
+ * SwsContext is not thread safe, so the pool is per-thread rather than
+ * process-wide.
+ */
+constexpr size_t maxPooledSwsContexts = 4;
+
+struct PooledSwsContext
+{
+    int srcW;
+    int srcH;
+    int srcFormat;
+    int dstW;
+    int dstH;
+    int dstFormat;
+    int flags;
+    bool threaded;
+    SwsContext* context;
+    uint64_t lastUse;
+};
+
+struct SwsContextPool
+{
+    std::vector<PooledSwsContext> entries;
+    uint64_t useCounter = 0;
+
+    ~SwsContextPool()
+    {
+        for (const PooledSwsContext& entry : entries) {
+            sws_freeContext(entry.context);
+        }
+    }
+};
+
+thread_local SwsContextPool swsPool;
+
+SwsContext* buildSwsContext(int srcW, int srcH, int srcFormat, int dstW, int dstH, int dstFormat,
+                            int flags, bool threaded)
+{
+#if LIBSWSCALE_VERSION_INT >= AV_VERSION_INT(6, 0, 100)
+    if (threaded) {
+        SwsContext* context = sws_alloc_context();
+
+        if (!context) {
+            return nullptr;
+        }
+
+        av_opt_set_int(context, "srcw", srcW, 0);
+        av_opt_set_int(context, "srch", srcH, 0);
+        av_opt_set_pixel_fmt(context, "src_format", static_cast<AVPixelFormat>(srcFormat), 0);
+        av_opt_set_int(context, "dstw", dstW, 0);
+        av_opt_set_int(context, "dsth", dstH, 0);
+        av_opt_set_pixel_fmt(context, "dst_format", static_cast<AVPixelFormat>(dstFormat), 0);
+        av_opt_set_int(context, "sws_flags", flags, 0);
+        // 0 selects one slice per available core
+        av_opt_set_int(context, "threads", 0, 0);
+
+        if (sws_init_context(context, nullptr, nullptr) < 0) {
+            sws_freeContext(context);
+            return nullptr;
+        }
+
+        return context;
+    }
+#else
+    std::ignore = threaded;
+#endif
+
+    return sws_getContext(srcW, srcH, static_cast<AVPixelFormat>(srcFormat), dstW, dstH,
+                          static_cast<AVPixelFormat>(dstFormat), flags, nullptr, nullptr, nullptr);
+}
+
+/**
+ * @brief Returns this thread's conversion context for the given parameters.
+ *
+ * On libswscale 6 and later, frames of full HD size and above get a
+ * slice-threaded context, which spreads the scale/convert of a single frame
+ * across cores; a 4K screen-share frame converted on one core would otherwise
+ * take longer than its frame interval. Smaller frames keep the plain context,
+ * where the per-slice overhead outweighs the parallelism.
+ */
+SwsContext* getThreadLocalSwsContext(int srcW, int srcH, int srcFormat, int dstW, int dstH,
+                                     int dstFormat, int flags)
+{
+#if LIBSWSCALE_VERSION_INT >= AV_VERSION_INT(6, 0, 100)
+    bool wantThreads = static_cast<int64_t>(srcW) * srcH >= 1920 * 1080;
+#else
+    bool wantThreads = false;
+#endif
+
+    for (PooledSwsContext& entry : swsPool.entries) {
+        if (entry.srcW == srcW && entry.srcH == srcH && entry.srcFormat == srcFormat
+            && entry.dstW == dstW && entry.dstH == dstH && entry.dstFormat == dstFormat
+            && entry.flags == flags && entry.threaded == wantThreads) {
+            entry.lastUse = ++swsPool.useCounter;
+            return entry.context;
+        }
+    }
+
+    SwsContext* context =
+        buildSwsContext(srcW, srcH, srcFormat, dstW, dstH, dstFormat, flags, wantThreads);
+
+    if (!context && wantThreads) {
+        // Fall back to the single-threaded setup if the threaded one failed
+        wantThreads = false;
+        context = buildSwsContext(srcW, srcH, srcFormat, dstW, dstH, dstFormat, flags, wantThreads);
+    }
+
+    if (!context) {
+        return nullptr;
+    }
+
+    if (swsPool.entries.size() >= maxPooledSwsContexts) {
+        const auto oldest =
+            std::min_element(swsPool.entries.begin(), swsPool.entries.end(),
+                             [](const PooledSwsContext& a, const PooledSwsContext& b) {
+                                 return a.lastUse < b.lastUse;
+                             });
+        sws_freeContext(oldest->context);
+        swsPool.entries.erase(oldest);
+    }
+
+    swsPool.entries.push_back({srcW, srcH, srcFormat, dstW, dstH, dstFormat, flags, wantThreads,
+                               context, ++swsPool.useCounter});
+
+    return context;
+}
+
+// Upper bound of buffers kept per frame geometry in the shared pool. A call
+// has only a handful of frames of one geometry alive at a time
+constexpr size_t maxPooledFramesPerKey = 8;
+} // namespace
+
 // Initialize static fields
 VideoFrame::AtomicIDType VideoFrame::frameIDs{0};
 
@@ -73,6 +225,10 @@ std::unordered_map<VideoFrame::IDType, std::unordered_map<VideoFrame::IDType, st
 
 QReadWriteLock VideoFrame::refsLock{};
 
+std::unordered_map<VideoFrame::FrameBufferKey, std::vector<AVFrame*>, VideoFrame::FrameBufferKeyHash>
+    VideoFrame::framePool{};
+QMutex VideoFrame::framePoolLock{};
+
 /**
  * @brief Constructs a new instance of a VideoFrame, sourced by a given AVFrame pointer.
  *
@@ -269,8 +425,9 @@ void VideoFrame::releaseFrame()
 /**
  * @brief Converts this VideoFrame to a QImage that shares this VideoFrame's buffer.
  *
- * The VideoFrame will be scaled into the RGB24 pixel format along with the given
- * dimension.
+ * The VideoFrame will be scaled into the RGB32 pixel format along with the given
+ * dimension. RGB32 matches the raster backing store, so painting the returned
+ * image is a plain blit without a per-pixel format conversion.
  *
  * @param frameSize the given frame size of QImage to generate. Defaults to source frame size if
  * frameSize is invalid.
@@ -279,24 +436,97 @@ void VideoFrame::releaseFrame()
  */
 QImage VideoFrame::toQImage(QSize frameSize)
 {
+    AllocationTracker::Scope allocScope{AllocationTracker::Subsystem::VideoConvert};
+
     if (!frameSize.isValid()) {
         frameSize = sourceDimensions.size();
     }
 
-    // Returns an empty constructed QImage in case of invalid generation
-    auto [image, frameLocker] =
-        toGenericObject(frameSize, AV_PIX_FMT_RGB24, false, [frameSize](AVFrame* const frame) {
-            // Converter function (constructs QImage out of AVFrame*)
-            return QImage{
-                *frame->data,     frameSize.width(),     frameSize.height(),
-                *frame->linesize, QImage::Format_RGB888,
-            };
-        });
+    AVFrame* frame;
+    bool generated = false;
+    {
+        ReadWriteLocker frameReadLock(&frameLock, ReadWriteLocker::ReadLock);
+
+        // We return empty if the VideoFrame is no longer valid
+        if (frameBuffer.empty()) {
+            return {};
+        }
+
+        // Serve repeat conversions from the published handle; all surfaces
+        // displaying this frame share one converted buffer this way
+        const QImage cached = retrieveQImage(frameSize, AV_PIX_FMT_RGB32);
+        if (!cached.isNull()) {
+            return cached;
+        }
+
+        frame = retrieveAVFrame(frameSize, AV_PIX_FMT_RGB32, false);
+        if (frame == nullptr) {
+            // VideoFrame does not contain an AVFrame to spec, generate one here
+            frame = generateAVFrame(frameSize, AV_PIX_FMT_RGB32, false);
+            generated = true;
+        }
+    }
+
+    if (frame == nullptr) {
+        return {};
+    }
+
+    /*
+     * Upgrade to a write lock to publish the handle. As in toGenericObject(),
+     * a concurrent generation at worst performs the conversion twice and one
+     * of the results is discarded.
+     */
+    ReadWriteLocker frameWriteLock(&frameLock, ReadWriteLocker::WriteLock);
+
+    if (generated) {
+        frame = storeAVFrame(frame, frameSize, AV_PIX_FMT_RGB32);
+    }
+
+    const QImage image{
+        *frame->data,     frameSize.width(),    frameSize.height(),
+        *frame->linesize, QImage::Format_RGB32,
+    };
+    imageBuffer.emplace(getFrameKey(frameSize, AV_PIX_FMT_RGB32, frame->linesize[0]), image);
 
-    // No need to return the frame buffer lock since we are returning a QImage which owns the data.
     return image;
 }
 
+/**
+ * @brief Maps a requested preview size onto a small set of shared scale classes.
+ *
+ * Every preview consumer converting at its exact widget size would run one
+ * swscale pass per distinct size per frame. Snapping requests to the source
+ * size and its half, quarter and eighth downscales means all surfaces showing
+ * this frame share one cached scaled buffer, and widget resizes stop
+ * producing a new conversion size every frame. The returned size always
+ * covers the target, so painting only ever downscales slightly.
+ *
+ * @param targetSize the size the caller will display the frame at.
+ * @return the smallest scale class covering targetSize, at most source size.
+ */
+QSize VideoFrame::previewSize(QSize targetSize) const
+{
+    const QSize source = sourceDimensions.size();
+    if (!targetSize.isValid() || targetSize.isEmpty()) {
+        return source;
+    }
+
+    // Walk from the smallest class up and keep the first one that covers the
+    // requested size
+    for (const int divisor : {8, 4, 2}) {
+        const QSize classSize{(source.width() / divisor) & ~1, (source.height() / divisor) & ~1};
+        if (classSize.isEmpty()) {
+            continue;
+        }
+
+        if (classSize.width() >= targetSize.width() && classSize.height() >= targetSize.height()) {
+            return classSize;
+        }
+    }
+
+    return source;
+}
+
 /**
  * @brief Converts this VideoFrame to a ToxAVFrame that shares this VideoFrame's buffer.
  *
@@ -499,19 +729,62 @@ AVFrame* VideoFrame::retrieveAVFrame(const QSize& dimensions, const int pixelFor
 }
 
 /**
- * @brief Generates an AVFrame based on the given specifications.
+ * @brief Retrieves the published QImage handle for the given parameters without obtaining a lock.
  *
  * This function is not thread-safe and must be called from a thread-safe context.
  *
+ * @param dimensions the dimensions of the image, must be valid.
+ * @param pixelFormat the pixel format of the underlying frame.
+ * @return a shallow copy of the cached QImage, or a null image if none was published yet.
+ */
+QImage VideoFrame::retrieveQImage(const QSize& dimensions, const int pixelFormat)
+{
+    // Mirror retrieveAVFrame()'s probing order of unaligned before aligned
+    for (const bool aligned : {false, true}) {
+        const auto it = imageBuffer.find(getFrameKey(dimensions, pixelFormat, aligned));
+        if (it != imageBuffer.end()) {
+            return it->second;
+        }
+    }
+
+    return {};
+}
+
+/**
+ * @brief Obtains a frame buffer with the given specifications, preferring the shared pool.
+ *
+ * The returned frame's buffers are owned by the caller and are expected to
+ * eventually flow back into the pool through releasePooledFrame(), which
+ * deleteFrameBuffer() does for every frame whose buffers a VideoFrame owns.
+ *
  * @param dimensions the required dimensions for the frame, must be valid.
  * @param pixelFormat the required pixel format for the frame.
- * @param requireAligned true if the generated frame needs to be frame aligned, false otherwise.
- * @return an AVFrame with the given specifications.
+ * @param requireAligned true if the frame needs to be frame aligned, false otherwise.
+ * @return an AVFrame with the given specifications or nullptr on allocation failure.
  */
-AVFrame* VideoFrame::generateAVFrame(const QSize& dimensions, const int pixelFormat,
-                                     const bool requireAligned)
+AVFrame* VideoFrame::allocFrameBuffer(const QSize& dimensions, const int pixelFormat,
+                                      const bool requireAligned)
 {
-    AVFrame* ret = av_frame_alloc();
+    AVFrame* ret = nullptr;
+
+    /*
+     * Mirror retrieveAVFrame()'s preference: an unaligned-linesize frame
+     * corresponds to a data aligned frame, so try that first when the caller
+     * doesn't insist on frame alignment
+     */
+    if (!requireAligned) {
+        ret = acquirePooledFrame(getFrameKey(dimensions, pixelFormat, false));
+    }
+
+    if (ret == nullptr) {
+        ret = acquirePooledFrame(getFrameKey(dimensions, pixelFormat, true));
+    }
+
+    if (ret != nullptr) {
+        return ret;
+    }
+
+    ret = av_frame_alloc();
 
     if (!ret) {
         return nullptr;
@@ -545,29 +818,48 @@ AVFrame* VideoFrame::generateAVFrame(const QSize& dimensions, const int pixelFor
         return nullptr;
     }
 
+    return ret;
+}
+
+/**
+ * @brief Generates an AVFrame based on the given specifications.
+ *
+ * This function is not thread-safe and must be called from a thread-safe context.
+ *
+ * @param dimensions the required dimensions for the frame, must be valid.
+ * @param pixelFormat the required pixel format for the frame.
+ * @param requireAligned true if the generated frame needs to be frame aligned, false otherwise.
+ * @return an AVFrame with the given specifications.
+ */
+AVFrame* VideoFrame::generateAVFrame(const QSize& dimensions, const int pixelFormat,
+                                     const bool requireAligned)
+{
+    PERF_ZONE(videoframe_convert);
+    AllocationTracker::Scope allocScope{AllocationTracker::Subsystem::VideoConvert};
+
+    AVFrame* ret = allocFrameBuffer(dimensions, pixelFormat, requireAligned);
+
+    if (!ret) {
+        return nullptr;
+    }
+
     // Bilinear is better for shrinking, bicubic better for upscaling
     int resizeAlgo = sourceDimensions.width() > dimensions.width() ? SWS_BILINEAR : SWS_BICUBIC;
 
-    SwsContext* swsCtx =
-        sws_getContext(sourceDimensions.width(), sourceDimensions.height(),
-                       static_cast<AVPixelFormat>(sourcePixelFormat), dimensions.width(),
-                       dimensions.height(), static_cast<AVPixelFormat>(pixelFormat), resizeAlgo,
-                       nullptr, nullptr, nullptr);
+    SwsContext* swsContext =
+        getThreadLocalSwsContext(sourceDimensions.width(), sourceDimensions.height(),
+                                 sourcePixelFormat, dimensions.width(), dimensions.height(),
+                                 pixelFormat, resizeAlgo);
 
-    if (!swsCtx) {
-        av_freep(&ret->data[0]);
-#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(57, 48, 101)
-        av_frame_unref(ret);
-#endif
-        av_frame_free(&ret);
+    if (!swsContext) {
+        releasePooledFrame(getFrameKey(dimensions, pixelFormat, ret->linesize[0]), ret);
         return nullptr;
     }
 
     AVFrame* source = frameBuffer[sourceFrameKey];
 
-    sws_scale(swsCtx, source->data, source->linesize, 0, sourceDimensions.height(), ret->data,
+    sws_scale(swsContext, source->data, source->linesize, 0, sourceDimensions.height(), ret->data,
               ret->linesize);
-    sws_freeContext(swsCtx);
 
     return ret;
 }
@@ -602,12 +894,8 @@ AVFrame* VideoFrame::storeAVFrame(AVFrame* frame, const QSize& dimensions, const
     if (frameBuffer.count(frameKey) > 0) {
         AVFrame* old_ret = frameBuffer[frameKey];
 
-        // Free new frame
-        av_freep(&frame->data[0]);
-#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(57, 48, 101)
-        av_frame_unref(frame);
-#endif
-        av_frame_free(&frame);
+        // Hand the duplicate frame back to the pool
+        releasePooledFrame(frameKey, frame);
 
         return old_ret;
     } else {
@@ -629,28 +917,123 @@ void VideoFrame::deleteFrameBuffer()
         return;
     }
 
+    // Drop the published handles along with the buffers they wrap; as
+    // documented on the class, all references to frame data become invalid
+    // once the VideoFrame is released
+    imageBuffer.clear();
+
     for (const auto& frameIterator : frameBuffer) {
         AVFrame* frame = frameIterator.second;
 
-        // Treat source frame and derived frames separately
-        if (sourceFrameKey == frameIterator.first) {
-            if (freeSourceFrame) {
-                av_freep(&frame->data[0]);
-            }
+        // Buffers of the source frame may be owned elsewhere, in which case
+        // only the frame wrapper may be dropped. Every buffer we own goes
+        // back to the pool for reuse
+        if (sourceFrameKey == frameIterator.first && !freeSourceFrame) {
 #if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(57, 48, 101)
             av_frame_unref(frame);
 #endif
             av_frame_free(&frame);
         } else {
+            releasePooledFrame(frameIterator.first, frame);
+        }
+    }
+
+    frameBuffer.clear();
+}
+
+/**
+ * @brief Takes a reusable frame of the given geometry out of the shared pool.
+ *
+ * @param key the geometry of the requested frame.
+ * @return a pooled AVFrame or nullptr if the pool holds none of this geometry.
+ */
+AVFrame* VideoFrame::acquirePooledFrame(const FrameBufferKey& key)
+{
+    QMutexLocker<QMutex> locker(&framePoolLock);
+
+    auto poolIt = framePool.find(key);
+    if (poolIt == framePool.end() || poolIt->second.empty()) {
+        return nullptr;
+    }
+
+    AVFrame* frame = poolIt->second.back();
+    poolIt->second.pop_back();
+
+    return frame;
+}
+
+/**
+ * @brief Returns a frame whose buffers we own to the shared pool.
+ *
+ * Frees the frame outright once the pool already holds enough buffers of
+ * this geometry.
+ *
+ * @param key the geometry of the frame.
+ * @param frame the frame to return, must own its buffers.
+ */
+void VideoFrame::releasePooledFrame(const FrameBufferKey& key, AVFrame* frame)
+{
+    {
+        QMutexLocker<QMutex> locker(&framePoolLock);
+
+        auto& pool = framePool[key];
+        if (pool.size() < maxPooledFramesPerKey) {
+            pool.push_back(frame);
+            return;
+        }
+    }
+
+    av_freep(&frame->data[0]);
+#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(57, 48, 101)
+    av_frame_unref(frame);
+#endif
+    av_frame_free(&frame);
+}
+
+/**
+ * @brief Bytes of image data currently parked in the shared frame pool.
+ *
+ * Computed from each pool entry's geometry, so the figure matches what
+ * av_image_alloc handed out up to allocator rounding.
+ */
+quint64 VideoFrame::pooledBufferBytes()
+{
+    QMutexLocker<QMutex> locker(&framePoolLock);
+
+    quint64 bytes = 0;
+    for (const auto& poolEntry : framePool) {
+        const FrameBufferKey& key = poolEntry.first;
+        const int frameSize =
+            av_image_get_buffer_size(static_cast<AVPixelFormat>(key.pixelFormat), key.frameWidth,
+                                     key.frameHeight, key.linesizeAligned ? dataAlignment : 1);
+        if (frameSize > 0) {
+            bytes += quint64(frameSize) * poolEntry.second.size();
+        }
+    }
+
+    return bytes;
+}
+
+/**
+ * @brief Frees every pooled frame buffer.
+ *
+ * Only idle spares live in the pool, so this is safe at any time; an
+ * ongoing call simply reallocates its buffers on the next frames.
+ */
+void VideoFrame::trimFramePool()
+{
+    QMutexLocker<QMutex> locker(&framePoolLock);
+
+    for (auto& poolEntry : framePool) {
+        for (AVFrame* frame : poolEntry.second) {
             av_freep(&frame->data[0]);
 #if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(57, 48, 101)
             av_frame_unref(frame);
 #endif
             av_frame_free(&frame);
         }
+        poolEntry.second.clear();
     }
-
-    frameBuffer.clear();
 }
 
 /**
@@ -23,6 +23,7 @@ extern "C"
 #include <cstdint>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 /**
  * @brief A combination of QReadLocker and QWriteLocker that unlocks the lock when destroyed.
@@ -121,9 +122,13 @@ public:
     static std::shared_ptr<VideoFrame> fromAVFrame(IDType sourceID, AVFrame* sourceFrame);
     static void untrackFrames(const IDType& sourceID, bool releaseFrames = false);
 
+    static quint64 pooledBufferBytes();
+    static void trimFramePool();
+
     void releaseFrame();
 
     QImage toQImage(QSize frameSize = {});
+    QSize previewSize(QSize targetSize) const;
     std::pair<ToxYUVFrame, ReadWriteLocker> toToxYUVFrame();
 
     IDType getFrameID() const;
@@ -131,6 +136,8 @@ public:
     QRect getSourceDimensions() const;
     int getSourcePixelFormat() const;
 
+    static AVFrame* allocFrameBuffer(const QSize& dimensions, int pixelFormat, bool requireAligned);
+
     static constexpr int dataAlignment = 32;
 
 private:
@@ -180,9 +187,13 @@ private:
                                       const bool frameAligned);
 
     AVFrame* retrieveAVFrame(const QSize& dimensions, const int pixelFormat, const bool requireAligned);
+    QImage retrieveQImage(const QSize& dimensions, const int pixelFormat);
     AVFrame* generateAVFrame(const QSize& dimensions, const int pixelFormat, const bool requireAligned);
     AVFrame* storeAVFrame(AVFrame* frame, const QSize& dimensions, const int pixelFormat);
 
+    static AVFrame* acquirePooledFrame(const FrameBufferKey& key);
+    static void releasePooledFrame(const FrameBufferKey& key, AVFrame* frame);
+
     void deleteFrameBuffer();
 
     template <typename F>
@@ -198,6 +209,12 @@ private:
     // Main framebuffer store
     std::unordered_map<FrameBufferKey, AVFrame*, FrameBufferKeyHash> frameBuffer{3};
 
+    // Ready-made QImage handles onto converted buffers. QImage is implicitly
+    // shared, so every surface displaying this frame receives a refcounted
+    // view of the same converted buffer instead of re-running the lookup and
+    // wrapper construction per paint
+    std::unordered_map<FrameBufferKey, QImage, FrameBufferKeyHash> imageBuffer{3};
+
     // Source frame
     const QRect sourceDimensions;
     int sourcePixelFormat;
@@ -210,6 +227,13 @@ private:
     static std::unordered_map<IDType, QMutex> mutexMap;
     static std::unordered_map<IDType, std::unordered_map<IDType, std::weak_ptr<VideoFrame>>> refsMap;
 
+    // Pool of reusable frame buffers shared by all VideoFrame instances, so
+    // the steady state of a call recycles buffers instead of allocating and
+    // freeing multi-megabyte images per frame. Buffers live until process
+    // exit once pooled
+    static std::unordered_map<FrameBufferKey, std::vector<AVFrame*>, FrameBufferKeyHash> framePool;
+    static QMutex framePoolLock;
+
     // Concurrency
     QReadWriteLock frameLock{};
     static QReadWriteLock refsLock;
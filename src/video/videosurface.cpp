@@ -9,18 +9,25 @@
 #include "src/model/friend.h"
 #include "src/persistence/settings.h"
 #include "src/video/videoframe.h"
+#include "src/widget/framegovernor.h"
 #include "src/widget/friendwidget.h"
 #include "src/widget/style.h"
 
 #include <QDebug>
+#include <QFontMetrics>
 #include <QLabel>
 #include <QPainter>
+#include <QStringList>
 
 namespace {
 float getSizeRatio(const QSize size)
 {
     return size.width() / static_cast<float>(size.height());
 }
+
+// A frame painted later than this after arrival counts as a late paint;
+// beyond roughly two 30fps intervals the delay is visible as judder
+constexpr qint64 latePaintThresholdMs = 66;
 } // namespace
 
 /**
@@ -37,6 +44,10 @@ VideoSurface::VideoSurface(const QPixmap& avatar_, QWidget* parent, bool expandi
     , expanding{expanding_}
 {
     recalculateBounds();
+
+    // Stop pulling (and converting) frames while no qTox window is on screen
+    connect(&FrameGovernor::getInstance(), &FrameGovernor::appVisibleChanged, this,
+            &VideoSurface::onAppVisibleChanged);
 }
 
 VideoSurface::VideoSurface(const QPixmap& avatar_, VideoSource* source_, QWidget* parent)
@@ -68,6 +79,9 @@ void VideoSurface::setSource(VideoSource* src)
         return;
 
     unsubscribe();
+    // The new source gets a live subscription below regardless of visibility,
+    // so a pending governor resume must not stack another one on top
+    pausedSubscriptions = 0;
     source = src;
     subscribe();
 }
@@ -87,6 +101,7 @@ float VideoSurface::getRatio() const
 void VideoSurface::setAvatar(const QPixmap& pixmap)
 {
     avatar = pixmap;
+    scaledAvatar = QPixmap();
     update();
 }
 
@@ -95,9 +110,24 @@ QPixmap VideoSurface::getAvatar() const
     return avatar;
 }
 
+void VideoSurface::setDebugOverlayEnabled(bool enabled)
+{
+    debugOverlayEnabled = enabled;
+    update();
+}
+
+bool VideoSurface::isDebugOverlayEnabled() const
+{
+    return debugOverlayEnabled;
+}
+
 void VideoSurface::subscribe()
 {
     if (source && hasSubscribed++ == 0) {
+        // Each source gets a fresh pacing record, so the overlay numbers can
+        // be attributed to the stream currently shown
+        pacingStats = {};
+        frameDeltaTimer.invalidate();
         source->subscribe();
         connect(source, &VideoSource::frameAvailable, this, &VideoSurface::onNewFrameAvailable);
         connect(source, &VideoSource::sourceStopped, this, &VideoSurface::onSourceStopped);
@@ -135,6 +165,14 @@ void VideoSurface::onNewFrameAvailable(const std::shared_ptr<VideoFrame>& newFra
     newSize = lastFrame->getSourceDimensions().size();
     unlock();
 
+    if (frameDeltaTimer.isValid()) {
+        pacingStats.recordDelta(frameDeltaTimer.restart());
+    } else {
+        frameDeltaTimer.start();
+    }
+    frameArrivalTimer.start();
+    framePainted = false;
+
     float newRatio = getSizeRatio(newSize);
 
     if (!qFuzzyCompare(newRatio, ratio) && isVisible()) {
@@ -154,6 +192,99 @@ void VideoSurface::onSourceStopped()
     update();
 }
 
+void VideoSurface::onAppVisibleChanged(bool visible)
+{
+    if (!visible) {
+        // Full-screen video windows don't report to the governor; keep
+        // streaming as long as our own window is still on screen
+        if (window()->isVisible() && !window()->isMinimized()) {
+            return;
+        }
+
+        if (hasSubscribed == 0 || pausedSubscriptions != 0) {
+            return;
+        }
+
+        pausedSubscriptions = hasSubscribed;
+        while (hasSubscribed != 0) {
+            unsubscribe();
+        }
+    } else if (pausedSubscriptions != 0) {
+        const uint8_t count = pausedSubscriptions;
+        pausedSubscriptions = 0;
+        for (uint8_t i = 0; i < count; ++i) {
+            subscribe();
+        }
+    }
+}
+
+void VideoSurface::PacingStats::recordDelta(qint64 deltaMs)
+{
+    size_t bucket = 0;
+    while (bucket < bucketBoundsMs.size() && deltaMs > bucketBoundsMs[bucket]) {
+        ++bucket;
+    }
+    ++deltaBuckets[bucket];
+
+    ++frames;
+    deltaSumMs += deltaMs;
+    worstDeltaMs = qMax(worstDeltaMs, deltaMs);
+}
+
+/**
+ * @brief Paints the pacing numbers into the corner of the surface.
+ *
+ * Three lines, one per pipeline stage: the inter-frame delta histogram shows
+ * the cadence frames arrive at from decode, the convert times what the scaler
+ * costs, and the paint delays how long frames wait for the event loop. A
+ * judder report can then be pinned on the stage whose numbers are off.
+ */
+void VideoSurface::drawDebugOverlay(QPainter& painter)
+{
+    const PacingStats& s = pacingStats;
+
+    QStringList histogram;
+    for (size_t i = 0; i < s.deltaBuckets.size(); ++i) {
+        const QString bound = i < PacingStats::bucketBoundsMs.size()
+                                  ? QStringLiteral("<=%1").arg(PacingStats::bucketBoundsMs[i])
+                                  : QStringLiteral(">%1").arg(PacingStats::bucketBoundsMs.back());
+        histogram += QStringLiteral("%1: %2").arg(bound).arg(s.deltaBuckets[i]);
+    }
+
+    QStringList lines;
+    lines += QStringLiteral("delta ms %1 (avg %2, worst %3)")
+                 .arg(histogram.join(QStringLiteral(", ")))
+                 .arg(s.frames != 0 ? s.deltaSumMs / static_cast<qint64>(s.frames) : 0)
+                 .arg(s.worstDeltaMs);
+    lines += QStringLiteral("convert avg %1ms, worst %2ms")
+                 .arg(s.paints != 0 ? s.convertSumMs / static_cast<qint64>(s.paints) : 0)
+                 .arg(s.worstConvertMs);
+    lines += QStringLiteral("paints %1, late %2, worst delay %3ms")
+                 .arg(s.paints)
+                 .arg(s.latePaints)
+                 .arg(s.worstPaintDelayMs);
+
+    QFont font = painter.font();
+    font.setPointSize(8);
+    painter.setFont(font);
+
+    const QFontMetrics metrics{font};
+    const int lineHeight = metrics.height();
+    const QPoint origin = boundingRect.topLeft() + QPoint(4, 4);
+
+    int maxWidth = 0;
+    for (const QString& line : lines) {
+        maxWidth = qMax(maxWidth, metrics.horizontalAdvance(line));
+    }
+
+    painter.fillRect(QRect(origin, QSize(maxWidth + 8, lineHeight * lines.size() + 8)),
+                     QColor(0, 0, 0, 160));
+    painter.setPen(Qt::green);
+    for (int i = 0; i < lines.size(); ++i) {
+        painter.drawText(origin + QPoint(4, lineHeight * (i + 1)), lines[i]);
+    }
+}
+
 void VideoSurface::paintEvent(QPaintEvent* event)
 {
     std::ignore = event;
@@ -162,19 +293,55 @@ void VideoSurface::paintEvent(QPaintEvent* event)
     QPainter painter(this);
     painter.fillRect(painter.viewport(), Qt::black);
     if (lastFrame) {
-        QImage frame = lastFrame->toQImage(rect().size());
+        // Convert at the shared preview class covering the displayed size.
+        // Every surface showing this frame reuses one scaled buffer and the
+        // draw below does at most a minor final scale
+        const QSize displaySize = boundingRect.isEmpty() ? rect().size() : boundingRect.size();
+        QElapsedTimer convertTimer;
+        convertTimer.start();
+        QImage frame = lastFrame->toQImage(lastFrame->previewSize(displaySize));
+        const qint64 convertMs = convertTimer.elapsed();
         if (frame.isNull())
             lastFrame.reset();
         painter.drawImage(boundingRect, frame, frame.rect(), Qt::NoFormatConversion);
+
+        // Repaints of an already shown frame hit the conversion cache and say
+        // nothing about pacing; only each frame's first paint is recorded
+        if (!framePainted) {
+            framePainted = true;
+            ++pacingStats.paints;
+            pacingStats.convertSumMs += convertMs;
+            pacingStats.worstConvertMs = qMax(pacingStats.worstConvertMs, convertMs);
+
+            const qint64 paintDelayMs = frameArrivalTimer.elapsed();
+            pacingStats.worstPaintDelayMs = qMax(pacingStats.worstPaintDelayMs, paintDelayMs);
+            if (paintDelayMs > latePaintThresholdMs) {
+                ++pacingStats.latePaints;
+            }
+        }
+
+        if (debugOverlayEnabled) {
+            drawDebugOverlay(painter);
+        }
     } else {
         painter.fillRect(boundingRect, Qt::white);
-        QPixmap drawnAvatar = avatar;
-
-        if (drawnAvatar.isNull())
-            drawnAvatar = Style::scaleSvgImage(":/img/contact_dark.svg", boundingRect.width(),
-                                               boundingRect.height());
 
-        painter.drawPixmap(boundingRect, drawnAvatar, drawnAvatar.rect());
+        // Scale once per avatar/size change instead of on every repaint; the
+        // SVG fallback in particular was re-rendered per paint. Rendering at
+        // the device pixel ratio keeps the result sharp on HiDPI screens.
+        const qreal pixelRatio = devicePixelRatioF();
+        const QSize targetSize = boundingRect.size() * pixelRatio;
+        if (scaledAvatar.size() != targetSize) {
+            if (avatar.isNull()) {
+                scaledAvatar = Style::scaleSvgImage(":/img/contact_dark.svg", targetSize.width(),
+                                                    targetSize.height());
+            } else {
+                scaledAvatar = avatar.scaled(targetSize, Qt::IgnoreAspectRatio,
+                                             Qt::SmoothTransformation);
+            }
+            scaledAvatar.setDevicePixelRatio(pixelRatio);
+        }
+        painter.drawPixmap(boundingRect.topLeft(), scaledAvatar);
     }
 
     unlock();
@@ -6,10 +6,14 @@
 #pragma once
 
 #include "src/video/videosource.h"
+#include <QElapsedTimer>
 #include <QWidget>
+#include <array>
 #include <atomic>
 #include <memory>
 
+class QPainter;
+
 class VideoSurface : public QWidget
 {
     Q_OBJECT
@@ -25,6 +29,8 @@ public:
     float getRatio() const;
     void setAvatar(const QPixmap& pixmap);
     QPixmap getAvatar() const;
+    void setDebugOverlayEnabled(bool enabled);
+    bool isDebugOverlayEnabled() const;
 
 signals:
     void ratioChanged();
@@ -41,9 +47,34 @@ protected:
 private slots:
     void onNewFrameAvailable(const std::shared_ptr<VideoFrame>& newFrame);
     void onSourceStopped();
+    void onAppVisibleChanged(bool visible);
 
 private:
+    // Frame pacing statistics for the debug overlay, kept per source while
+    // subscribed. Everything here is touched on the GUI thread only: frames
+    // arrive through the queued frameAvailable connection and paints happen
+    // in paintEvent. The delta histogram attributes judder to the decode
+    // cadence, the convert times to the scaler and the paint delays to event
+    // loop scheduling.
+    struct PacingStats
+    {
+        static constexpr std::array<qint64, 5> bucketBoundsMs{17, 25, 34, 50, 100};
+
+        std::array<quint64, bucketBoundsMs.size() + 1> deltaBuckets{};
+        quint64 frames = 0;
+        qint64 deltaSumMs = 0;
+        qint64 worstDeltaMs = 0;
+        quint64 paints = 0;
+        quint64 latePaints = 0;
+        qint64 worstPaintDelayMs = 0;
+        qint64 convertSumMs = 0;
+        qint64 worstConvertMs = 0;
+
+        void recordDelta(qint64 deltaMs);
+    };
+
     void recalculateBounds();
+    void drawDebugOverlay(QPainter& painter);
     void lock();
     void unlock();
 
@@ -52,7 +83,17 @@ private:
     std::shared_ptr<VideoFrame> lastFrame;
     std::atomic_bool frameLock;
     uint8_t hasSubscribed;
+    uint8_t pausedSubscriptions = 0;
     QPixmap avatar;
+    // The avatar (or fallback icon) pre-scaled to the bounding rect at the
+    // device pixel ratio, so idle repaints blit 1:1 instead of rescaling
+    QPixmap scaledAvatar;
     float ratio;
     bool expanding;
+
+    PacingStats pacingStats;
+    QElapsedTimer frameDeltaTimer;
+    QElapsedTimer frameArrivalTimer;
+    bool framePainted = true;
+    bool debugOverlayEnabled = false;
 };
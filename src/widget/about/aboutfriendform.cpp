@@ -69,6 +69,7 @@ AboutFriendForm::AboutFriendForm(std::unique_ptr<IAboutFriend> about_, Settings&
     ui->note->setPlainText(about->getNote());
     ui->statusMessage->setText(about->getStatusMessage());
     ui->avatar->setPixmap(about->getAvatar());
+    ui->qualityGraph->setSamples(about->getConnectionQuality());
 
     connect(&style, &Style::themeReload, this, &AboutFriendForm::reloadTheme);
 
@@ -90,7 +91,7 @@ void AboutFriendForm::onAutoAcceptDirClicked()
 
 void AboutFriendForm::reloadTheme()
 {
-    setStyleSheet(style.getStylesheet("window/general.qss", settings));
+    style.setStylesheet(this, "window/general.qss", settings);
 }
 
 void AboutFriendForm::onAutoAcceptDirChanged(const QString& path)
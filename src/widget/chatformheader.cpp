@@ -281,11 +281,11 @@ QSize ChatFormHeader::getAvatarSize() const
 
 void ChatFormHeader::reloadTheme()
 {
-    setStyleSheet(style.getStylesheet("chatArea/chatHead.qss", settings));
-    callButton->setStyleSheet(style.getStylesheet(STYLE_PATH, settings));
-    videoButton->setStyleSheet(style.getStylesheet(STYLE_PATH, settings));
-    volButton->setStyleSheet(style.getStylesheet(STYLE_PATH, settings));
-    micButton->setStyleSheet(style.getStylesheet(STYLE_PATH, settings));
+    style.setStylesheet(this, "chatArea/chatHead.qss", settings);
+    style.setStylesheet(callButton, STYLE_PATH, settings);
+    style.setStylesheet(videoButton, STYLE_PATH, settings);
+    style.setStylesheet(volButton, STYLE_PATH, settings);
+    style.setStylesheet(micButton, STYLE_PATH, settings);
 }
 
 void ChatFormHeader::addWidget(QWidget* widget, int stretch, Qt::Alignment alignment)
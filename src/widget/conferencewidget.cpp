@@ -34,7 +34,7 @@ ConferenceWidget::ConferenceWidget(std::shared_ptr<ConferenceRoom> chatroom_, bo
     , chatroom{chatroom_}
 {
     avatar->setPixmap(Style::scaleSvgImage(":img/conference.svg", avatar->width(), avatar->height()));
-    statusPic.setPixmap(QPixmap(Status::getIconPath(Status::Status::Online)));
+    statusPic.setPixmap(Status::getIconPixmap(Status::Status::Online));
     statusPic.setMargin(3);
 
     Conference* c = chatroom->getConference();
@@ -159,7 +159,7 @@ void ConferenceWidget::updateStatusLight()
     Conference* c = chatroom->getConference();
 
     const bool event = c->getEventFlag();
-    statusPic.setPixmap(QPixmap(Status::getIconPath(Status::Status::Online, event)));
+    statusPic.setPixmap(Status::getIconPixmap(Status::Status::Online, event));
     statusPic.setMargin(event ? 1 : 3);
 }
 
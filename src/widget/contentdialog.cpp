@@ -25,6 +25,7 @@
 #include "src/widget/conferencewidget.h"
 #include "src/widget/contentlayout.h"
 #include "src/widget/form/chatform.h"
+#include "src/widget/framegovernor.h"
 #include "src/widget/friendlistlayout.h"
 #include "src/widget/friendwidget.h"
 #include "src/widget/style.h"
@@ -428,8 +429,8 @@ void ContentDialog::setUsername(const QString& newName)
 
 void ContentDialog::reloadTheme()
 {
-    setStyleSheet(style.getStylesheet("contentDialog/contentDialog.qss", settings));
-    friendScroll->setStyleSheet(style.getStylesheet("friendList/friendList.qss", settings));
+    style.setStylesheet(this, "contentDialog/contentDialog.qss", settings);
+    style.setStylesheet(friendScroll, "friendList/friendList.qss", settings);
 }
 
 bool ContentDialog::event(QEvent* event)
@@ -528,9 +529,25 @@ void ContentDialog::changeEvent(QEvent* event)
         if (isActiveWindow()) {
             emit activated();
         }
+    } else if (event->type() == QEvent::WindowStateChange) {
+        // Minimizing doesn't produce a hide event, but per-frame work should
+        // idle all the same
+        FrameGovernor::getInstance().setWindowVisible(this, isVisible() && !isMinimized());
     }
 }
 
+void ContentDialog::showEvent(QShowEvent* event)
+{
+    FrameGovernor::getInstance().setWindowVisible(this, !isMinimized());
+    QDialog::showEvent(event);
+}
+
+void ContentDialog::hideEvent(QHideEvent* event)
+{
+    FrameGovernor::getInstance().setWindowVisible(this, false);
+    QDialog::hideEvent(event);
+}
+
 void ContentDialog::resizeEvent(QResizeEvent* event)
 {
     saveDialogGeometry();
@@ -578,7 +595,11 @@ void ContentDialog::activate(GenericChatroomWidget* widget)
         return;
     }
 
-    contentLayout->clear();
+    // Hide instead of detaching: detaching reparents the form, which throws
+    // away its scene state and forces a full relayout plus visibility
+    // recomputation when switching back. Hidden forms keep everything and
+    // make the switch a show/hide plus incremental update.
+    contentLayout->deactivate();
 
     if (activeChatroomWidget) {
         activeChatroomWidget->setAsInactiveChatroom();
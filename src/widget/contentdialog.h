@@ -92,6 +92,8 @@ protected:
     void dragEnterEvent(QDragEnterEvent* event) final;
     void dropEvent(QDropEvent* event) final;
     void changeEvent(QEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
     void resizeEvent(QResizeEvent* event) override;
     void moveEvent(QMoveEvent* event) override;
     void keyPressEvent(QKeyEvent* event) override;
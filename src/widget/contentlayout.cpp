@@ -60,8 +60,8 @@ ContentLayout::~ContentLayout()
 void ContentLayout::reloadTheme()
 {
 #ifndef Q_OS_MAC
-    mainHead->setStyleSheet(style.getStylesheet("settings/mainHead.qss", settings));
-    mainContent->setStyleSheet(style.getStylesheet("window/general.qss", settings));
+    style.setStylesheet(mainHead, "settings/mainHead.qss", settings);
+    style.setStylesheet(mainContent, "window/general.qss", settings);
 #endif
 }
 
@@ -81,6 +81,24 @@ void ContentLayout::clear()
     }
 }
 
+/**
+ * @brief Hides the currently shown widgets without detaching them.
+ *
+ * Unlike clear(), the widgets keep their parent, so their render state -
+ * laid-out chat lines, scroll position - survives and showing them again is
+ * cheap. Hidden widgets take no space in the layout.
+ */
+void ContentLayout::deactivate()
+{
+    for (int i = 0; i < mainHead->layout()->count(); ++i) {
+        mainHead->layout()->itemAt(i)->widget()->hide();
+    }
+
+    for (int i = 0; i < mainContent->layout()->count(); ++i) {
+        mainContent->layout()->itemAt(i)->widget()->hide();
+    }
+}
+
 void ContentLayout::init()
 {
     setContentsMargins(0, 0, 0, 0);
@@ -19,6 +19,7 @@ public:
     ~ContentLayout();
 
     void clear();
+    void deactivate();
 
     QFrame mainHLine;
     QHBoxLayout mainHLineLayout;
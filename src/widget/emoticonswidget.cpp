@@ -17,9 +17,18 @@
 
 #include <math.h>
 
-EmoticonsWidget::EmoticonsWidget(SmileyPack& smileyPack, Settings& settings, Style& style,
+namespace {
+const int maxCols = 8;
+const int maxRows = 8;
+const int itemsPerPage = maxRows * maxCols;
+} // namespace
+
+EmoticonsWidget::EmoticonsWidget(SmileyPack& smileyPack_, Settings& settings_, Style& style,
                                  QWidget* parent)
     : QMenu(parent)
+    , smileyPack(smileyPack_)
+    , settings(settings_)
+    , emoticons(smileyPack_.getEmoticons())
 {
     setStyleSheet(style.getStylesheet("emoticonWidget/emoticonWidget.qss", settings));
     setLayout(&layout);
@@ -31,23 +40,11 @@ EmoticonsWidget::EmoticonsWidget(SmileyPack& smileyPack, Settings& settings, Sty
 
     layout.addWidget(pageButtonsContainer);
 
-    const int maxCols = 8;
-    const int maxRows = 8;
-    const int itemsPerPage = maxRows * maxCols;
-
-    const QList<QStringList>& emoticons = smileyPack.getEmoticons();
     int itemCount = emoticons.size();
     int pageCount = ceil(float(itemCount) / float(itemsPerPage));
-    int currPage = 0;
-    int currItem = 0;
-    int row = 0;
-    int col = 0;
+    builtPages = QVector<bool>(pageCount, false);
 
-    // respect configured emoticon size
-    const int px = settings.getEmojiFontPointSize();
-    const QSize size(px, px);
-
-    // create pages
+    // create empty pages; their buttons are added on first visit
     buttonLayout->addStretch();
     for (int i = 0; i < pageCount; ++i) {
         QGridLayout* pageLayout = new QGridLayout;
@@ -73,7 +70,40 @@ EmoticonsWidget::EmoticonsWidget(SmileyPack& smileyPack, Settings& settings, Sty
     }
     buttonLayout->addStretch();
 
-    for (const QStringList& set : emoticons) {
+    connect(&stack, &QStackedWidget::currentChanged, this, &EmoticonsWidget::onPageChanged);
+    if (pageCount > 0) {
+        buildPage(0);
+    }
+
+    // calculates sizeHint
+    layout.activate();
+}
+
+/**
+ * @brief Instantiates the emoticon buttons of a page on its first visit.
+ *
+ * Only the visible page costs anything: with the big unicode packs, building
+ * every page up front meant thousands of buttons per picker open.
+ */
+void EmoticonsWidget::buildPage(int index)
+{
+    if (index < 0 || index >= builtPages.size() || builtPages[index]) {
+        return;
+    }
+    builtPages[index] = true;
+
+    // respect configured emoticon size
+    const int px = settings.getEmojiFontPointSize();
+    const QSize size(px, px);
+
+    QGridLayout* pageLayout = qobject_cast<QGridLayout*>(stack.widget(index)->layout());
+    const int firstItem = index * itemsPerPage;
+    const int lastItem = qMin<int>(emoticons.size(), firstItem + itemsPerPage);
+    int row = 0;
+    int col = 0;
+
+    for (int i = firstItem; i < lastItem; ++i) {
+        const QStringList& set = emoticons[i];
         QPushButton* button = new QPushButton;
         std::shared_ptr<QIcon> icon = smileyPack.getAsIcon(set[0]);
         emoticonsIcons.append(icon);
@@ -87,27 +117,14 @@ EmoticonsWidget::EmoticonsWidget(SmileyPack& smileyPack, Settings& settings, Sty
 
         connect(button, &QPushButton::clicked, this, &EmoticonsWidget::onSmileyClicked);
 
-        qobject_cast<QGridLayout*>(stack.widget(currPage)->layout())->addWidget(button, row, col);
+        pageLayout->addWidget(button, row, col);
 
         ++col;
-        ++currItem;
-
-        // next row
         if (col >= maxCols) {
             col = 0;
             ++row;
         }
-
-        // next page
-        if (currItem >= itemsPerPage) {
-            row = 0;
-            currItem = 0;
-            ++currPage;
-        }
     }
-
-    // calculates sizeHint
-    layout.activate();
 }
 
 void EmoticonsWidget::onSmileyClicked()
@@ -130,6 +147,11 @@ void EmoticonsWidget::onPageButtonClicked()
     }
 }
 
+void EmoticonsWidget::onPageChanged(int index)
+{
+    buildPage(index);
+}
+
 QSize EmoticonsWidget::sizeHint() const
 {
     return layout.sizeHint();
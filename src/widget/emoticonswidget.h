@@ -30,6 +30,7 @@ signals:
 private slots:
     void onSmileyClicked();
     void onPageButtonClicked();
+    void onPageChanged(int index);
     void PageButtonsUpdate();
 
 protected:
@@ -39,6 +40,14 @@ protected:
     void keyPressEvent(QKeyEvent* e) final;
 
 private:
+    void buildPage(int index);
+
+    SmileyPack& smileyPack;
+    Settings& settings;
+    QList<QStringList> emoticons;
+    // Pages that already have their buttons; the picker only instantiates
+    // buttons for pages the user actually visits
+    QVector<bool> builtPages;
     QStackedWidget stack;
     QVBoxLayout layout;
     QList<std::shared_ptr<QIcon>> emoticonsIcons;
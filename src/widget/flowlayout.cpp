@@ -35,6 +35,13 @@ void FlowLayout::addItem(QLayoutItem* item)
 {
     itemList.append(item);
 }
+
+void FlowLayout::insertWidget(int index, QWidget* widget)
+{
+    addChildWidget(widget);
+    itemList.insert(qBound(0, index, itemList.size()), new QWidgetItem(widget));
+    invalidate();
+}
 //! [3]
 
 //! [4]
@@ -33,11 +33,13 @@
 #include "src/widget/tool/screenshotgrabber.h"
 #include "src/widget/translator.h"
 #include "src/widget/widget.h"
+#include "src/workerpool.h"
 
 #include <QApplication>
 #include <QClipboard>
 #include <QFileDialog>
 #include <QFileInfo>
+#include <QFutureWatcher>
 #include <QMessageBox>
 #include <QMimeData>
 #include <QPushButton>
@@ -59,6 +61,9 @@ namespace {
 constexpr int CHAT_WIDGET_MIN_HEIGHT = 50;
 constexpr int SCREENSHOT_GRABBER_OPENING_DELAY = 500;
 constexpr int TYPING_NOTIFICATION_DURATION = 3000;
+// How long typing has to pause before the draft is persisted; long enough to
+// sit out a burst of keystrokes, short enough that a crash loses little
+constexpr int DRAFT_SAVE_DELAY = 1000;
 } // namespace
 
 const QString ChatForm::ACTION_PREFIX = QStringLiteral("/me ");
@@ -121,9 +126,24 @@ ChatForm::ChatForm(Profile& profile_, Friend* chatFriend, IChatLog& chatLog_,
     statusMessageLabel->setMinimumHeight(Style::getFont(Style::Font::Medium).pixelSize());
     statusMessageLabel->setTextFormat(Qt::PlainText);
     statusMessageLabel->setContextMenuPolicy(Qt::CustomContextMenu);
+    // The form may be created long after the friend's status message arrived
+    setStatusMessage(f->getStatusMessage());
 
     typingTimer.setSingleShot(true);
 
+    // Restore whatever the last session left unsent, before the textChanged
+    // connections below start observing edits
+    if (History* history = profile_.getHistory()) {
+        lastSavedDraft = history->getDraft(f->getPublicKey());
+        if (!lastSavedDraft.isEmpty()) {
+            msgEdit->setPlainText(lastSavedDraft);
+            msgEdit->moveCursor(QTextCursor::End);
+        }
+    }
+    draftSaveTimer.setSingleShot(true);
+    draftSaveTimer.setInterval(DRAFT_SAVE_DELAY);
+    connect(&draftSaveTimer, &QTimer::timeout, this, &ChatForm::saveDraft);
+
     callDurationTimer = nullptr;
 
     chatWidget->setMinimumHeight(CHAT_WIDGET_MIN_HEIGHT);
@@ -157,7 +177,7 @@ ChatForm::ChatForm(Profile& profile_, Friend* chatFriend, IChatLog& chatLog_,
     connect(&profile, &Profile::friendAvatarChanged, this, &ChatForm::onAvatarChanged);
     connect(coreFile, &CoreFile::fileReceiveRequested, this, &ChatForm::updateFriendActivityForFile);
     connect(coreFile, &CoreFile::fileSendStarted, this, &ChatForm::updateFriendActivityForFile);
-    connect(&core, &Core::friendTypingChanged, this, &ChatForm::onFriendTypingChanged);
+    connect(&core, &Core::friendTypingStatesChanged, this, &ChatForm::onFriendTypingStatesChanged);
     connect(coreFile, &CoreFile::fileNameChanged, this, &ChatForm::onFileNameChanged);
 
     connect(chatFriend, &Friend::statusChanged, this, &ChatForm::onFriendStatusChanged);
@@ -209,6 +229,11 @@ ChatForm::ChatForm(Profile& profile_, Friend* chatFriend, IChatLog& chatLog_,
 
 ChatForm::~ChatForm()
 {
+    // Don't lose the tail of a draft the debounce hasn't flushed yet
+    if (draftSaveTimer.isActive()) {
+        draftSaveTimer.stop();
+        saveDraft();
+    }
     Translator::unregister(this);
 }
 
@@ -243,8 +268,30 @@ void ChatForm::onFileNameChanged(const ToxPk& friendPk)
                             "so you can save the file on Windows."));
 }
 
+/**
+ * @brief Writes the current input text to the draft table if it changed.
+ *
+ * Runs from the debounce timer and on teardown; an emptied input deletes the
+ * stored draft so sent messages don't reappear as drafts.
+ */
+void ChatForm::saveDraft()
+{
+    const QString draft = msgEdit->toPlainText();
+    if (draft == lastSavedDraft) {
+        return;
+    }
+
+    if (History* history = profile.getHistory()) {
+        history->setDraft(f->getPublicKey(), draft);
+        lastSavedDraft = draft;
+    }
+}
+
 void ChatForm::onTextEditChanged()
 {
+    // Drafts survive restarts; debounced so typing doesn't write per keystroke
+    draftSaveTimer.start();
+
     if (!settings.getTypingNotification()) {
         if (isTyping) {
             isTyping = false;
@@ -471,6 +518,14 @@ void ChatForm::onFriendTypingChanged(quint32 friendId, bool isTyping_)
     }
 }
 
+void ChatForm::onFriendTypingStatesChanged(const QHash<uint32_t, bool>& typingStates)
+{
+    const auto it = typingStates.constFind(f->getId());
+    if (it != typingStates.cend()) {
+        setFriendTyping(it.value());
+    }
+}
+
 void ChatForm::onFriendNameChanged(const QString& name)
 {
     if (sender() == f) {
@@ -603,22 +658,35 @@ void ChatForm::sendImageFromPreview()
                            .arg(settings.getPaths().getAppDataDirPath())
                            .arg(QDir::separator())
                            .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH-mm-ss.zzz"));
-    QFile file(filepath);
 
-    if (file.open(QFile::ReadWrite)) {
-        imagePreviewSource.save(&file, "PNG");
-        qint64 filesize = file.size();
-        imagePreview->hide();
-        imagePreviewSource = QPixmap();
-        file.close();
-        QFileInfo fi(file);
+    // PNG-encoding a 4K capture takes seconds; do it on a worker so the input
+    // box is usable again immediately. QPixmap may only be touched on the GUI
+    // thread, so the conversion to QImage happens here before dispatch.
+    const QImage image = imagePreviewSource.toImage();
+    imagePreview->hide();
+    imagePreviewSource = QPixmap();
+
+    auto* watcher = new QFutureWatcher<qint64>(this);
+    connect(watcher, &QFutureWatcher<qint64>::finished, this, [this, watcher, filepath] {
+        watcher->deleteLater();
+        const qint64 filesize = watcher->result();
+        if (filesize < 0) {
+            QMessageBox::warning(this,
+                                 tr("Failed to open temporary file", "Temporary file for screenshot"),
+                                 tr("qTox wasn't able to save the screenshot"));
+            return;
+        }
+        QFileInfo fi(filepath);
         CoreFile* coreFile = core.getCoreFile();
         coreFile->sendFile(f->getId(), fi.fileName(), fi.filePath(), filesize);
-    } else {
-        QMessageBox::warning(this,
-                             tr("Failed to open temporary file", "Temporary file for screenshot"),
-                             tr("qTox wasn't able to save the screenshot"));
-    }
+    });
+    watcher->setFuture(WorkerPool::instance().runInteractive([image, filepath]() -> qint64 {
+        QFile file(filepath);
+        if (!file.open(QFile::ReadWrite) || !image.save(&file, "PNG")) {
+            return -1;
+        }
+        return file.size();
+    }));
 }
 
 void ChatForm::onCopyStatusMessage()
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <QElapsedTimer>
+#include <QHash>
 #include <QLabel>
 #include <QSet>
 #include <QTimer>
@@ -82,6 +83,7 @@ private slots:
     void onScreenshotClicked() override;
 
     void onTextEditChanged();
+    void saveDraft();
     void onCallTriggered();
     void onVideoCallTriggered();
     void onAnswerCallTriggered(bool video);
@@ -91,6 +93,7 @@ private slots:
 
     void onFriendStatusChanged(const ToxPk& friendPk, Status::Status status);
     void onFriendTypingChanged(quint32 friendId, bool isTyping_);
+    void onFriendTypingStatesChanged(const QHash<uint32_t, bool>& typingStates);
     void onFriendNameChanged(const QString& name);
     void onStatusMessage(const QString& message);
     void onUpdateTime();
@@ -128,6 +131,9 @@ private:
     QLabel* callDuration;
     QTimer* callDurationTimer;
     QTimer typingTimer;
+    // Debounces persisting the message input into the draft table
+    QTimer draftSaveTimer;
+    QString lastSavedDraft;
     QElapsedTimer timeElapsed;
     QAction* copyStatusAction;
     QPixmap imagePreviewSource;
@@ -39,6 +39,11 @@ const auto LABEL_PEER_PLAYING_AUDIO = QVariant(QStringLiteral("true"));
 const auto LABEL_PEER_NOT_PLAYING_AUDIO = QVariant(QStringLiteral("false"));
 const auto PEER_LABEL_STYLE_SHEET_PATH = QStringLiteral("chatArea/chatHead.qss");
 
+// Cadence of draining the speaking levels CoreAV accumulates on the audio
+// path, and the RMS (linear full-scale) above which a peer counts as speaking
+constexpr int AUDIO_LEVEL_POLL_INTERVAL_MS = 100;
+constexpr float SPEAKING_RMS_THRESHOLD = 0.01f;
+
 /**
  * @brief Edit name for correct representation if it is needed
  * @param name Editing string
@@ -127,6 +132,13 @@ ConferenceForm::ConferenceForm(Core& core_, Conference* chatConference, IChatLog
     connect(conference, &Conference::numPeersChanged, this, &ConferenceForm::updateUserCount);
     settings.connectTo_blockListChanged(this, [this](const QStringList&) { updateUserNames(); });
 
+    // Speaking indicators are driven by polling the levels CoreAV records on
+    // the audio path, rather than by a queued signal per decoded frame
+    audioLevelPollTimer = new QTimer(this);
+    audioLevelPollTimer->setInterval(AUDIO_LEVEL_POLL_INTERVAL_MS);
+    connect(audioLevelPollTimer, &QTimer::timeout, this, &ConferenceForm::pollPeerAudioLevels);
+    audioLevelPollTimer->start();
+
     if (settings.getShowConferenceJoinLeaveMessages()) {
         addSystemInfoMessage(QDateTime::currentDateTime(), SystemMessageType::selfJoinedConference, {});
     }
@@ -165,7 +177,10 @@ void ConferenceForm::onAttachClicked()
 }
 
 /**
- * @brief Updates user names' labels at the top of conference
+ * @brief Rebuilds all user name labels at the top of the conference.
+ *
+ * Only needed for whole-list invalidations like a block list change; join,
+ * part and rename events go through the incremental label handlers instead.
  */
 void ConferenceForm::updateUserNames()
 {
@@ -187,30 +202,8 @@ void ConferenceForm::updateUserNames()
     /* we store the peer labels by their ToxPk, but the namelist layout
      * needs it in alphabetical order, so we first create and store the labels
      * and then sort them by their text and add them to the layout in that order */
-    const auto selfPk = core.getSelfPublicKey();
     for (const auto& peerPk : peers.keys()) {
-        const QString peerName = peers.value(peerPk);
-        const QString editedName = editName(peerName);
-        QLabel* const label = new QLabel(editedName + QLatin1String(", "));
-        if (editedName != peerName) {
-            label->setToolTip(peerName + " (" + peerPk.toString() + ")");
-        } else if (peerName != peerPk.toString()) {
-            label->setToolTip(peerPk.toString());
-        } // else their name is just their Pk, no tooltip needed
-        label->setTextFormat(Qt::PlainText);
-        label->setContextMenuPolicy(Qt::CustomContextMenu);
-
-        connect(label, &QLabel::customContextMenuRequested, this,
-                &ConferenceForm::onLabelContextMenuRequested);
-
-        if (peerPk == selfPk) {
-            label->setProperty("peerType", LABEL_PEER_TYPE_OUR);
-        } else if (settings.getBlockList().contains(peerPk.toString())) {
-            label->setProperty("peerType", LABEL_PEER_TYPE_MUTED);
-        }
-
-        label->setStyleSheet(style.getStylesheet(PEER_LABEL_STYLE_SHEET_PATH, settings));
-        peerLabels.insert(peerPk, label);
+        peerLabels.insert(peerPk, createPeerLabel(peerPk, peers.value(peerPk)));
     }
 
     // add the labels in alphabetical order into the layout
@@ -220,46 +213,180 @@ void ConferenceForm::updateUserNames()
         return a->text().toLower() < b->text().toLower();
     });
 
-    // remove comma from last sorted label
-    QLabel* const lastLabel = nickLabelList.last();
-    QString labelText = lastLabel->text();
-    labelText.chop(2);
-    lastLabel->setText(labelText);
     for (QLabel* l : nickLabelList) {
         namesListLayout->addWidget(l);
     }
+    fixupLabelCommas();
+}
+
+/**
+ * @brief Creates a fully styled name label for one peer, with trailing comma
+ */
+QLabel* ConferenceForm::createPeerLabel(const ToxPk& peerPk, const QString& peerName)
+{
+    QLabel* const label = new QLabel();
+    setPeerLabelText(label, peerPk, peerName);
+    label->setTextFormat(Qt::PlainText);
+    label->setContextMenuPolicy(Qt::CustomContextMenu);
+
+    connect(label, &QLabel::customContextMenuRequested, this,
+            &ConferenceForm::onLabelContextMenuRequested);
+
+    if (peerPk == core.getSelfPublicKey()) {
+        label->setProperty("peerType", LABEL_PEER_TYPE_OUR);
+    } else if (settings.getBlockList().contains(peerPk.toString())) {
+        label->setProperty("peerType", LABEL_PEER_TYPE_MUTED);
+    }
+
+    label->setStyleSheet(style.getStylesheet(PEER_LABEL_STYLE_SHEET_PATH, settings));
+    return label;
+}
+
+void ConferenceForm::setPeerLabelText(QLabel* label, const ToxPk& peerPk, const QString& peerName)
+{
+    const QString editedName = editName(peerName);
+    label->setText(editedName + QLatin1String(", "));
+    if (editedName != peerName) {
+        label->setToolTip(peerName + " (" + peerPk.toString() + ")");
+    } else if (peerName != peerPk.toString()) {
+        label->setToolTip(peerPk.toString());
+    } else {
+        // their name is just their Pk, no tooltip needed
+        label->setToolTip(QString());
+    }
+}
+
+/**
+ * @brief Places a label at its alphabetical position in the name list layout
+ */
+void ConferenceForm::insertPeerLabel(QLabel* label)
+{
+    // The last label has its comma chopped, which doesn't affect ordering
+    // since ", " sorts before any name character that may follow it
+    const QString key = label->text().toLower();
+    int index = 0;
+    while (index < namesListLayout->count()) {
+        const auto other = qobject_cast<QLabel*>(namesListLayout->itemAt(index)->widget());
+        if (other != nullptr && key < other->text().toLower()) {
+            break;
+        }
+        ++index;
+    }
+    namesListLayout->insertWidget(index, label);
+    fixupLabelCommas();
+}
+
+/**
+ * @brief Takes a label out of the name list layout without deleting it
+ */
+void ConferenceForm::detachPeerLabel(QLabel* label)
+{
+    const int index = namesListLayout->indexOf(label);
+    if (index >= 0) {
+        delete namesListLayout->takeAt(index);
+    }
+    fixupLabelCommas();
+}
+
+/**
+ * @brief Restores the "comma after every name but the last" invariant after an
+ *        incremental insert or removal; touches at most two labels
+ */
+void ConferenceForm::fixupLabelCommas()
+{
+    const int count = namesListLayout->count();
+    for (int i = 0; i < count; ++i) {
+        const auto label = qobject_cast<QLabel*>(namesListLayout->itemAt(i)->widget());
+        if (label == nullptr) {
+            continue;
+        }
+        const bool hasComma = label->text().endsWith(QLatin1String(", "));
+        if (i == count - 1 && hasComma) {
+            QString text = label->text();
+            text.chop(2);
+            label->setText(text);
+        } else if (i != count - 1 && !hasComma) {
+            label->setText(label->text() + QLatin1String(", "));
+        }
+    }
 }
 
 void ConferenceForm::onUserJoined(const ToxPk& user, const QString& name)
 {
-    std::ignore = user;
     if (settings.getShowConferenceJoinLeaveMessages()) {
         addSystemInfoMessage(QDateTime::currentDateTime(), SystemMessageType::userJoinedConference,
                              {name});
     }
-    updateUserNames();
+
+    if (peerLabels.contains(user)) {
+        // Shouldn't happen; resynchronize with the model
+        updateUserNames();
+        return;
+    }
+
+    QLabel* const label = createPeerLabel(user, name);
+    peerLabels.insert(user, label);
+    insertPeerLabel(label);
 }
 
 void ConferenceForm::onUserLeft(const ToxPk& user, const QString& name)
 {
-    std::ignore = user;
     if (settings.getShowConferenceJoinLeaveMessages()) {
         addSystemInfoMessage(QDateTime::currentDateTime(), SystemMessageType::userLeftConference,
                              {name});
     }
-    updateUserNames();
+
+    QLabel* const label = peerLabels.take(user);
+    if (label == nullptr) {
+        // Shouldn't happen; resynchronize with the model
+        updateUserNames();
+        return;
+    }
+
+    detachPeerLabel(label);
+    label->hide();
+    label->deleteLater();
 }
 
 void ConferenceForm::onPeerNameChanged(const ToxPk& peer, const QString& oldName, const QString& newName)
 {
-    std::ignore = peer;
     addSystemInfoMessage(QDateTime::currentDateTime(), SystemMessageType::peerNameChanged,
                          {oldName, newName});
-    updateUserNames();
+
+    QLabel* const label = peerLabels.value(peer, nullptr);
+    if (label == nullptr) {
+        // Shouldn't happen; resynchronize with the model
+        updateUserNames();
+        return;
+    }
+
+    // Reposition since the alphabetical order may have changed
+    detachPeerLabel(label);
+    setPeerLabelText(label, peer, newName);
+    insertPeerLabel(label);
+}
+
+/**
+ * @brief Drains the speaking levels recorded since the last poll and flashes
+ * the labels of peers whose audio rose above the speaking threshold.
+ */
+void ConferenceForm::pollPeerAudioLevels()
+{
+    const auto levels = core.getAv()->takeConferenceAudioLevels(conference->getId());
+    for (auto it = levels.cbegin(); it != levels.cend(); ++it) {
+        if (it.value().rms >= SPEAKING_RMS_THRESHOLD) {
+            peerAudioPlaying(it.key());
+        }
+    }
 }
 
-void ConferenceForm::peerAudioPlaying(ToxPk peerPk)
+void ConferenceForm::peerAudioPlaying(const ToxPk& peerPk)
 {
+    // Levels can arrive for a peer whose label the model hasn't produced yet
+    if (peerLabels.value(peerPk, nullptr) == nullptr) {
+        return;
+    }
+
     peerLabels[peerPk]->setProperty("playingAudio", LABEL_PEER_PLAYING_AUDIO);
     peerLabels[peerPk]->style()->unpolish(peerLabels[peerPk]);
     peerLabels[peerPk]->style()->polish(peerLabels[peerPk]);
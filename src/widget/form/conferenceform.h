@@ -39,9 +39,8 @@ public:
                    ConferenceList& conferenceList);
     ~ConferenceForm();
 
-    void peerAudioPlaying(ToxPk peerPk);
-
 private slots:
+    void pollPeerAudioLevels();
     void onScreenshotClicked() override;
     void onAttachClicked() override;
     void onMicMuteToggle();
@@ -64,14 +63,21 @@ private:
     void retranslateUi();
     void updateUserCount(int numPeers);
     void updateUserNames();
+    QLabel* createPeerLabel(const ToxPk& peerPk, const QString& peerName);
+    void setPeerLabelText(QLabel* label, const ToxPk& peerPk, const QString& peerName);
+    void insertPeerLabel(QLabel* label);
+    void detachPeerLabel(QLabel* label);
+    void fixupLabelCommas();
     void joinConferenceCall();
     void leaveConferenceCall();
+    void peerAudioPlaying(const ToxPk& peerPk);
 
 private:
     Core& core;
     Conference* conference;
     QMap<ToxPk, QLabel*> peerLabels;
     QMap<ToxPk, QTimer*> peerAudioTimers;
+    QTimer* audioLevelPollTimer;
     FlowLayout* namesListLayout;
     QLabel* nusersLabel;
     TabCompleter* tabber;
@@ -0,0 +1,72 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "debugallocations.h"
+#include "ui_debugallocations.h"
+
+#include "src/allocationtracker.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileDialog>
+#include <QPushButton>
+#include <QScrollBar>
+#include <QTimer>
+
+#include <memory>
+
+DebugAllocations::DebugAllocations(Style& style, QWidget* parent)
+    : GenericForm{QPixmap(":/img/settings/general.png"), style, parent}
+    , ui_{std::make_unique<Ui::DebugAllocations>()}
+    , refreshTimer_{std::make_unique<QTimer>(this)}
+{
+    ui_->setupUi(this);
+
+    // Refresh the counters every second while the tab is visible
+    refreshTimer_->start(1000);
+    connect(refreshTimer_.get(), &QTimer::timeout, this, [this] {
+        if (isVisible() && ui_->cbAutoRefresh->isChecked()) {
+            refresh();
+        }
+    });
+
+    connect(ui_->btnSave, &QPushButton::clicked, this, &DebugAllocations::saveToFile);
+    connect(ui_->btnReset, &QPushButton::clicked, this, [this] {
+        AllocationTracker::reset();
+        refresh();
+    });
+}
+
+DebugAllocations::~DebugAllocations() {}
+
+void DebugAllocations::showEvent(QShowEvent* event)
+{
+    refresh();
+
+    GenericForm::showEvent(event);
+}
+
+void DebugAllocations::refresh()
+{
+    // Keep the reading position stable across refreshes
+    const auto scrollPos = ui_->statsText->verticalScrollBar()->value();
+    ui_->statsText->setPlainText(AllocationTracker::snapshot().toString());
+    ui_->statsText->verticalScrollBar()->setValue(scrollPos);
+}
+
+void DebugAllocations::saveToFile()
+{
+    const QString path = QFileDialog::getSaveFileName(this, QStringLiteral("Save allocation stats"),
+                                                      QStringLiteral("qtox-allocation-stats.txt"));
+    if (path.isEmpty()) {
+        return;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "Unable to open file" << path;
+        return;
+    }
+    file.write(AllocationTracker::snapshot().toString().toUtf8());
+}
@@ -0,0 +1,40 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include "src/widget/form/settings/genericsettings.h"
+
+#include <memory>
+
+class QTimer;
+class Style;
+
+namespace Ui {
+class DebugAllocations;
+}
+
+class DebugAllocations final : public GenericForm
+{
+    Q_OBJECT
+public:
+    DebugAllocations(Style& style, QWidget* parent);
+    ~DebugAllocations();
+    QString getFormName() final
+    {
+        // Not translated (for now). Debugging only.
+        return QStringLiteral("Allocations");
+    }
+
+protected:
+    void showEvent(QShowEvent* event) final;
+
+private:
+    void refresh();
+    void saveToFile();
+
+private:
+    std::unique_ptr<Ui::DebugAllocations> ui_;
+    std::unique_ptr<QTimer> refreshTimer_;
+};
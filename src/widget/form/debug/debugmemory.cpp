@@ -0,0 +1,74 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "debugmemory.h"
+#include "ui_debugmemory.h"
+
+#include "src/memoryusagetracker.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileDialog>
+#include <QPushButton>
+#include <QScrollBar>
+#include <QTimer>
+
+#include <memory>
+
+DebugMemory::DebugMemory(Style& style, QWidget* parent)
+    : GenericForm{QPixmap(":/img/settings/general.png"), style, parent}
+    , ui_{std::make_unique<Ui::DebugMemory>()}
+    , refreshTimer_{std::make_unique<QTimer>(this)}
+{
+    ui_->setupUi(this);
+
+    // Refresh the counters every second while the tab is visible; the
+    // sampling is also what advances the high-water marks
+    refreshTimer_->start(1000);
+    connect(refreshTimer_.get(), &QTimer::timeout, this, [this] {
+        if (isVisible() && ui_->cbAutoRefresh->isChecked()) {
+            refresh();
+        }
+    });
+
+    connect(ui_->btnSave, &QPushButton::clicked, this, &DebugMemory::saveToFile);
+    connect(ui_->btnTrim, &QPushButton::clicked, this, [this] {
+        MemoryUsageTracker::instance().trimAll();
+        refresh();
+    });
+}
+
+DebugMemory::~DebugMemory() {}
+
+void DebugMemory::showEvent(QShowEvent* event)
+{
+    refresh();
+
+    GenericForm::showEvent(event);
+}
+
+void DebugMemory::refresh()
+{
+    // Keep the reading position stable across refreshes
+    const auto scrollPos = ui_->statsText->verticalScrollBar()->value();
+    ui_->statsText->setPlainText(
+        MemoryUsageTracker::toString(MemoryUsageTracker::instance().sample()));
+    ui_->statsText->verticalScrollBar()->setValue(scrollPos);
+}
+
+void DebugMemory::saveToFile()
+{
+    const QString path = QFileDialog::getSaveFileName(this, QStringLiteral("Save memory stats"),
+                                                      QStringLiteral("qtox-memory-stats.txt"));
+    if (path.isEmpty()) {
+        return;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "Unable to open file" << path;
+        return;
+    }
+    file.write(MemoryUsageTracker::toString(MemoryUsageTracker::instance().sample()).toUtf8());
+}
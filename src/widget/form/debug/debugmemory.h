@@ -0,0 +1,40 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include "src/widget/form/settings/genericsettings.h"
+
+#include <memory>
+
+class QTimer;
+class Style;
+
+namespace Ui {
+class DebugMemory;
+}
+
+class DebugMemory final : public GenericForm
+{
+    Q_OBJECT
+public:
+    DebugMemory(Style& style, QWidget* parent);
+    ~DebugMemory();
+    QString getFormName() final
+    {
+        // Not translated (for now). Debugging only.
+        return QStringLiteral("Memory");
+    }
+
+protected:
+    void showEvent(QShowEvent* event) final;
+
+private:
+    void refresh();
+    void saveToFile();
+
+private:
+    std::unique_ptr<Ui::DebugMemory> ui_;
+    std::unique_ptr<QTimer> refreshTimer_;
+};
@@ -0,0 +1,91 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "debugmetrics.h"
+#include "ui_debugmetrics.h"
+
+#include "src/core/coremetrics.h"
+#include "src/core/toxstring.h"
+#include "src/eventqueuemonitor.h"
+#include "src/model/conferencemessagedispatcher.h"
+#include "src/model/friendmessagedispatcher.h"
+#include "src/model/sendlatencymetrics.h"
+#include "util/threadplacement.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileDialog>
+#include <QPushButton>
+#include <QScrollBar>
+#include <QTimer>
+
+#include <memory>
+
+DebugMetrics::DebugMetrics(const CoreMetrics& metrics, Style& style, QWidget* parent)
+    : GenericForm{QPixmap(":/img/settings/general.png"), style, parent}
+    , metrics_{metrics}
+    , ui_{std::make_unique<Ui::DebugMetrics>()}
+    , refreshTimer_{std::make_unique<QTimer>(this)}
+{
+    ui_->setupUi(this);
+
+    // Refresh the counters every second while the tab is visible
+    refreshTimer_->start(1000);
+    connect(refreshTimer_.get(), &QTimer::timeout, this, [this] {
+        if (isVisible() && ui_->cbAutoRefresh->isChecked()) {
+            refresh();
+        }
+    });
+
+    connect(ui_->btnSave, &QPushButton::clicked, this, &DebugMetrics::saveToFile);
+}
+
+DebugMetrics::~DebugMetrics() {}
+
+void DebugMetrics::showEvent(QShowEvent* event)
+{
+    refresh();
+
+    GenericForm::showEvent(event);
+}
+
+void DebugMetrics::refresh()
+{
+    // Keep the reading position stable across refreshes
+    const auto scrollPos = ui_->statsText->verticalScrollBar()->value();
+    ui_->statsText->setPlainText(statsText());
+    ui_->statsText->verticalScrollBar()->setValue(scrollPos);
+}
+
+QString DebugMetrics::statsText() const
+{
+    return metrics_.snapshot().toString()
+           + QStringLiteral("\nSend queues: %1 interactive, %2 resend\n")
+                 .arg(FriendMessageDispatcher::totalInteractiveQueueDepth())
+                 .arg(FriendMessageDispatcher::totalResendQueueDepth())
+           + QStringLiteral("Conference dispatch: %1 messages in %2 parts\n")
+                 .arg(ConferenceMessageDispatcher::totalDispatchedMessages())
+                 .arg(ConferenceMessageDispatcher::totalDispatchedParts())
+           + QStringLiteral("String sanitation: %1 strings cleaned, %2 code points stripped\n")
+                 .arg(ToxString::totalSanitizedStrings())
+                 .arg(ToxString::totalStrippedCodepoints())
+           + SendLatencyMetrics::summary() + EventQueueMonitor::summary()
+           + ThreadPlacement::summary();
+}
+
+void DebugMetrics::saveToFile()
+{
+    const QString path = QFileDialog::getSaveFileName(this, QStringLiteral("Save core stats"),
+                                                      QStringLiteral("qtox-core-stats.txt"));
+    if (path.isEmpty()) {
+        return;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "Unable to open file" << path;
+        return;
+    }
+    file.write(statsText().toUtf8());
+}
@@ -0,0 +1,43 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include "src/widget/form/settings/genericsettings.h"
+
+#include <memory>
+
+class CoreMetrics;
+class QTimer;
+class Style;
+
+namespace Ui {
+class DebugMetrics;
+}
+
+class DebugMetrics final : public GenericForm
+{
+    Q_OBJECT
+public:
+    DebugMetrics(const CoreMetrics& metrics, Style& style, QWidget* parent);
+    ~DebugMetrics();
+    QString getFormName() final
+    {
+        // Not translated (for now). Debugging only.
+        return QStringLiteral("Core Stats");
+    }
+
+protected:
+    void showEvent(QShowEvent* event) final;
+
+private:
+    void refresh();
+    QString statsText() const;
+    void saveToFile();
+
+private:
+    const CoreMetrics& metrics_;
+    std::unique_ptr<Ui::DebugMetrics> ui_;
+    std::unique_ptr<QTimer> refreshTimer_;
+};
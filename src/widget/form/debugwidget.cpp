@@ -5,7 +5,10 @@
 #include "debugwidget.h"
 
 #include "src/widget/contentlayout.h"
+#include "src/widget/form/debug/debugallocations.h"
 #include "src/widget/form/debug/debuglog.h"
+#include "src/widget/form/debug/debugmemory.h"
+#include "src/widget/form/debug/debugmetrics.h"
 #include "src/widget/form/debug/debugobjecttree.h"
 #include "src/widget/translator.h"
 #include "src/widget/widget.h"
@@ -17,7 +20,7 @@
 
 #include <memory>
 
-DebugWidget::DebugWidget(Paths& paths, Style& style, Widget* parent)
+DebugWidget::DebugWidget(Paths& paths, Style& style, const CoreMetrics& metrics, Widget* parent)
     : QWidget(parent, Qt::Window)
 {
     setAttribute(Qt::WA_DeleteOnClose);
@@ -31,6 +34,9 @@ DebugWidget::DebugWidget(Paths& paths, Style& style, Widget* parent)
     dbgForms = {
         new DebugLogForm(paths, style, this),
         new DebugObjectTree(style, this),
+        new DebugMetrics(metrics, style, this),
+        new DebugAllocations(style, this),
+        new DebugMemory(style, this),
     };
 
     for (auto* dbgForm : dbgForms)
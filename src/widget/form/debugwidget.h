@@ -9,6 +9,7 @@
 #include <array>
 
 class ContentLayout;
+class CoreMetrics;
 class GenericForm;
 class Paths;
 class QTabWidget;
@@ -20,7 +21,7 @@ class DebugWidget : public QWidget
 {
     Q_OBJECT
 public:
-    DebugWidget(Paths& paths, Style& style, Widget* parent = nullptr);
+    DebugWidget(Paths& paths, Style& style, const CoreMetrics& metrics, Widget* parent = nullptr);
     ~DebugWidget();
 
     bool isShown() const;
@@ -36,6 +37,6 @@ private:
 private:
     QVBoxLayout* bodyLayout;
     QTabWidget* debugWidgets;
-    std::array<GenericForm*, 2> dbgForms;
+    std::array<GenericForm*, 5> dbgForms;
     int currentIndex;
 };
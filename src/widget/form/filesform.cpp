@@ -159,9 +159,13 @@ EditorAction toEditorAction(int in)
     return static_cast<EditorAction>(in);
 }
 
-Model::Model(FriendList& friendList_, QObject* parent)
+Model::Model(FriendList& friendList_, ToxFile::FileDirection direction_, History* history_,
+             QObject* parent)
     : QAbstractTableModel(parent)
     , friendList{friendList_}
+    , direction{direction_}
+    , history{history_}
+    , sessionStart{QDateTime::currentDateTime()}
 {
 }
 
@@ -228,7 +232,7 @@ void Model::onFileUpdated(const ToxFile& file)
 int Model::rowCount(const QModelIndex& parent) const
 {
     std::ignore = parent;
-    return files.size();
+    return static_cast<int>(files.size()) + static_cast<int>(pastTransfers.size());
 }
 
 int Model::columnCount(const QModelIndex& parent) const
@@ -240,11 +244,47 @@ int Model::columnCount(const QModelIndex& parent) const
 QVariant Model::data(const QModelIndex& index, int role) const
 {
     const auto row = index.row();
-    if (row < 0 || static_cast<size_t>(row) > files.size()) {
+    const auto liveCount = static_cast<int>(files.size());
+    if (row < 0 || row >= liveCount + static_cast<int>(pastTransfers.size())) {
         qWarning("Invalid file transfer row %d (files: %zu)", row, files.size());
         return QVariant();
     }
 
+    if (row >= liveCount) {
+        const auto& past = pastTransfers[row - liveCount];
+
+        if (role == Qt::UserRole) {
+            return past.filePath;
+        }
+
+        if (role != Qt::DisplayRole) {
+            return QVariant();
+        }
+
+        switch (toFileTransferListColumn(index.column())) {
+        case Column::fileName:
+            return past.fileName;
+        case Column::contact:
+            return past.dispName.isEmpty() ? QStringLiteral("Unknown") : past.dispName;
+        case Column::progress:
+            return past.status == ToxFile::FINISHED ? 100.0 : 0.0;
+        case Column::size:
+            return getHumanReadableSize(past.size);
+        case Column::speed:
+            return QString();
+        case Column::status: {
+            ToxFile file;
+            file.status = past.status;
+            return fileStatusString(file);
+        }
+        case Column::control:
+        case Column::invalid:
+            break;
+        }
+
+        return QVariant();
+    }
+
     if (role == Qt::UserRole) {
         return files[row].filePath;
     }
@@ -293,6 +333,11 @@ bool Model::setData(const QModelIndex& index, const QVariant& value, int role)
         return false;
     }
 
+    // Past transfers have no running transfer to pause or cancel
+    if (index.row() >= static_cast<int>(files.size())) {
+        return false;
+    }
+
     if (!value.canConvert<int>()) {
         qWarning("Unexpected model data");
         return false;
@@ -314,6 +359,42 @@ bool Model::setData(const QModelIndex& index, const QVariant& value, int role)
     return true;
 }
 
+bool Model::canFetchMore(const QModelIndex& parent) const
+{
+    std::ignore = parent;
+    return history != nullptr && !historyExhausted;
+}
+
+/**
+ * @brief Appends the next page of past transfers from history.
+ *
+ * Driven by the view as the user scrolls, so opening the window only ever
+ * pays for the rows that fit on screen, regardless of how many transfers are
+ * on record.
+ */
+void Model::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+
+    constexpr size_t pageSize = 100;
+    const auto page =
+        history->getFileTransferPage(direction, sessionStart, pastTransfers.size(), pageSize);
+    if (static_cast<size_t>(page.size()) < pageSize) {
+        historyExhausted = true;
+    }
+
+    if (page.isEmpty()) {
+        return;
+    }
+
+    const int first = rowCount();
+    beginInsertRows(QModelIndex(), first, first + page.size() - 1);
+    pastTransfers += page;
+    endInsertRows();
+}
+
 Delegate::Delegate(Settings& settings_, Style& style_, QWidget* parent)
     : QStyledItemDelegate(parent)
     , settings{settings_}
@@ -341,6 +422,10 @@ void Delegate::paint(QPainter* painter, const QStyleOptionViewItem& option, cons
     }
     case Column::control: {
         const auto data = index.data();
+        if (!data.isValid()) {
+            // Past transfers have no controls
+            return;
+        }
         if (!data.canConvert<bool>()) {
             qWarning("Unexpected control type, not rendering controls");
             return;
@@ -413,7 +498,8 @@ View::~View() = default;
 } // namespace FileTransferList
 
 FilesForm::FilesForm(CoreFile& coreFile, Settings& settings, Style& style,
-                     IMessageBoxManager& messageBoxManager_, FriendList& friendList)
+                     IMessageBoxManager& messageBoxManager_, FriendList& friendList,
+                     History* history)
     : QObject()
     , messageBoxManager{messageBoxManager_}
 {
@@ -424,8 +510,8 @@ FilesForm::FilesForm(CoreFile& coreFile, Settings& settings, Style& style,
     head->setLayout(&headLayout);
     headLayout.addWidget(&headLabel);
 
-    recvdModel = new FileTransferList::Model(friendList, this);
-    sentModel = new FileTransferList::Model(friendList, this);
+    recvdModel = new FileTransferList::Model(friendList, ToxFile::RECEIVING, history, this);
+    sentModel = new FileTransferList::Model(friendList, ToxFile::SENDING, history, this);
 
     auto pauseFile = [&coreFile](ToxFile file) {
         coreFile.pauseResumeFile(file.friendId, file.fileNum);
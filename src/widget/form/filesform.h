@@ -21,6 +21,7 @@
 class ContentLayout;
 class CoreFile;
 class FriendList;
+class History;
 class IMessageBoxManager;
 class QFileInfo;
 class QTableView;
@@ -33,7 +34,7 @@ class FilesForm : public QObject
 
 public:
     FilesForm(CoreFile& coreFile, Settings& settings, Style& style,
-              IMessageBoxManager& messageBoxManager, FriendList& friendList);
+              IMessageBoxManager& messageBoxManager, FriendList& friendList, History* history);
     ~FilesForm();
 
     bool isShown() const;
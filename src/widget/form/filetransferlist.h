@@ -1,6 +1,7 @@
 #pragma once
 
 #include "src/core/toxfile.h"
+#include "src/persistence/history.h"
 
 #include <QAbstractTableModel>
 #include <QStyledItemDelegate>
@@ -41,7 +42,8 @@ class Model : public QAbstractTableModel
 {
     Q_OBJECT
 public:
-    Model(FriendList& friendList, QObject* parent = nullptr);
+    Model(FriendList& friendList, ToxFile::FileDirection direction, History* history,
+          QObject* parent = nullptr);
     ~Model() = default;
 
     void onFileUpdated(const ToxFile& file);
@@ -52,6 +54,8 @@ public:
     int columnCount(const QModelIndex& parent = QModelIndex()) const override;
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
     bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
 
 signals:
     void togglePause(ToxFile file);
@@ -59,8 +63,17 @@ signals:
 
 private:
     QHash<QByteArray /*file id*/, int /*row index*/> idToRow;
+    // Live transfers of this session come first; rows past them are pages of
+    // past transfers fetched from history as the view scrolls
     std::vector<ToxFile> files;
+    QList<History::FileHistoryEntry> pastTransfers;
+    bool historyExhausted = false;
     FriendList& friendList;
+    const ToxFile::FileDirection direction;
+    History* const history;
+    // Upper bound for history pages; transfers from this session are already
+    // shown live, and a pinned bound keeps page offsets stable
+    const QDateTime sessionStart;
 };
 
 class Delegate : public QStyledItemDelegate
@@ -14,6 +14,7 @@
 #include "src/friendlist.h"
 #include "src/model/conference.h"
 #include "src/model/friend.h"
+#include "src/model/sendlatencymetrics.h"
 #include "src/persistence/settings.h"
 #include "src/persistence/smileypack.h"
 #include "src/widget/chatformheader.h"
@@ -268,6 +269,7 @@ GenericChatForm::GenericChatForm(const Core& core_, const Chat* chat, IChatLog&
     connect(searchForm, &SearchForm::searchInBegin, chatWidget, &ChatWidget::startSearch);
     connect(searchForm, &SearchForm::searchUp, chatWidget, &ChatWidget::onSearchUp);
     connect(searchForm, &SearchForm::searchDown, chatWidget, &ChatWidget::onSearchDown);
+    connect(searchForm, &SearchForm::searchAll, this, &GenericChatForm::searchAllRequested);
     connect(searchForm, &SearchForm::visibleChanged, chatWidget, &ChatWidget::removeSearchPhrase);
     connect(chatWidget, &ChatWidget::messageNotFoundShow, searchForm, &SearchForm::showMessageNotFound);
 
@@ -320,12 +322,12 @@ void GenericChatForm::hideFileMenu()
         fileFlyout->animateHide();
 }
 
-QDateTime GenericChatForm::getLatestTime() const
+QDateTime GenericChatForm::getLatestTime(const IChatLog& chatLog)
 {
     if (chatLog.getFirstIdx() == chatLog.getNextIdx())
         return QDateTime();
 
-    const auto shouldUseTimestamp = [this](ChatLogIdx idx) {
+    const auto shouldUseTimestamp = [&chatLog](ChatLogIdx idx) {
         if (chatLog.at(idx).getContentType() != ChatLogItem::ContentType::systemMessage) {
             return true;
         }
@@ -367,14 +369,17 @@ QDateTime GenericChatForm::getLatestTime() const
 
 void GenericChatForm::reloadTheme()
 {
-    setStyleSheet(style.getStylesheet("genericChatForm/genericChatForm.qss", settings));
-    msgEdit->setStyleSheet(style.getStylesheet("msgEdit/msgEdit.qss", settings)
-                           + fontToCss(settings.getChatMessageFont(), "QTextEdit"));
+    style.setStylesheet(this, "genericChatForm/genericChatForm.qss", settings);
+    const QString msgEditStyle = style.getStylesheet("msgEdit/msgEdit.qss", settings)
+                                 + fontToCss(settings.getChatMessageFont(), "QTextEdit");
+    if (msgEdit->styleSheet() != msgEditStyle) {
+        msgEdit->setStyleSheet(msgEditStyle);
+    }
 
-    emoteButton->setStyleSheet(style.getStylesheet(STYLE_PATH, settings));
-    fileButton->setStyleSheet(style.getStylesheet(STYLE_PATH, settings));
-    screenshotButton->setStyleSheet(style.getStylesheet(STYLE_PATH, settings));
-    sendButton->setStyleSheet(style.getStylesheet(STYLE_PATH, settings));
+    style.setStylesheet(emoteButton, STYLE_PATH, settings);
+    style.setStylesheet(fileButton, STYLE_PATH, settings);
+    style.setStylesheet(screenshotButton, STYLE_PATH, settings);
+    style.setStylesheet(sendButton, STYLE_PATH, settings);
 }
 
 void GenericChatForm::setName(const QString& newName)
@@ -384,10 +389,17 @@ void GenericChatForm::setName(const QString& newName)
 
 void GenericChatForm::show(ContentLayout* contentLayout_)
 {
-    contentLayout_->mainHead->layout()->addWidget(headWidget);
+    // Re-adding is only needed when moving to a different window. Within one
+    // ContentLayout a deactivated form stays parented, so showing it again
+    // reuses its laid-out chat lines and scroll position as they were.
+    if (headWidget->parentWidget() != contentLayout_->mainHead) {
+        contentLayout_->mainHead->layout()->addWidget(headWidget);
+    }
     headWidget->show();
 
-    contentLayout_->mainContent->layout()->addWidget(this);
+    if (parentWidget() != contentLayout_->mainContent) {
+        contentLayout_->mainContent->layout()->addWidget(this);
+    }
     QWidget::show();
 }
 
@@ -454,7 +466,9 @@ void GenericChatForm::onSendTriggered()
     msgEdit->setLastMessage(msg);
     msgEdit->clear();
 
-    messageDispatcher.sendMessage(isAction, msg);
+    const auto dispatchedIds = messageDispatcher.sendMessage(isAction, msg);
+    // measured until the last split part of the message hits the screen
+    SendLatencyMetrics::recordDispatch(dispatchedIds.second);
 }
 
 
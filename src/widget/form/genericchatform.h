@@ -73,10 +73,12 @@ public:
     void addSystemInfoMessage(const QDateTime& datetime, SystemMessageType messageType,
                               SystemMessage::Args messageArgs);
     QString resolveToxPk(const ToxPk& pk);
-    QDateTime getLatestTime() const;
+    // Static so callers can query chats whose form hasn't been created yet
+    static QDateTime getLatestTime(const IChatLog& chatLog);
 
 signals:
     void messageInserted();
+    void searchAllRequested(const QString& phrase);
 
 public slots:
     void clearChatArea();
@@ -16,9 +16,11 @@
 #include "src/widget/maskablepixmapwidget.h"
 #include "src/widget/style.h"
 #include "src/widget/tool/croppinglabel.h"
+#include "src/widget/qrwidget.h"
 #include "src/widget/tool/imessageboxmanager.h"
 #include "src/widget/translator.h"
 #include "src/widget/widget.h"
+#include "src/workerpool.h"
 #include <QApplication>
 #include <QBuffer>
 #include <QClipboard>
@@ -33,6 +35,7 @@
 #include <QMenu>
 #include <QMessageBox>
 #include <QMouseEvent>
+#include <QPointer>
 #include <QWindow>
 
 namespace {
@@ -79,7 +82,6 @@ const QPair<QString, QString> CAN_NOT_CHANGE_PASSWORD =
 ProfileForm::ProfileForm(IProfileInfo* profileInfo_, Settings& settings_, Style& style,
                          IMessageBoxManager& messageBoxManager_, QWidget* parent)
     : QWidget{parent}
-    , qr{nullptr}
     , profileInfo{profileInfo_}
     , settings{settings_}
     , messageBoxManager{messageBoxManager_}
@@ -171,7 +173,6 @@ void ProfileForm::prFileLabelUpdate()
 ProfileForm::~ProfileForm()
 {
     Translator::unregister(this);
-    delete qr;
     delete bodyUI;
 }
 
@@ -265,10 +266,31 @@ void ProfileForm::setToxId(const ToxId& id)
     toxId->setText(
         ToxIdColor.arg(idString.mid(0, 64)).arg(idString.mid(64, 8)).arg(idString.mid(72, 4)));
 
-    delete qr;
-    qr = new QRWidget();
-    qr->setQRData("tox:" + idString);
-    bodyUI->qrCode->setPixmap(QPixmap::fromImage(qr->getImage()->scaledToWidth(150)));
+    const QString data = "tox:" + idString;
+    if (data == qrData && !qrImage.isNull()) {
+        // Same ID as last time, the cached rendering is still right
+        return;
+    }
+    qrData = data;
+
+    // Encoding and rasterizing the code takes long enough to stutter the
+    // profile page, so do it on the pool and only set the pixmap (GUI thread
+    // only) once the result is queued back here. The QPointer drops the
+    // update if the form is gone by then.
+    QPointer<ProfileForm> self{this};
+    std::ignore = WorkerPool::instance().runInteractive([self, data] {
+        const QImage image = QRWidget::render(data, QSize(480, 480));
+        const QImage scaled = image.scaledToWidth(150);
+        QMetaObject::invokeMethod(
+            QApplication::instance(),
+            [self, data, image, scaled] {
+                if (self && self->qrData == data) {
+                    self->qrImage = image;
+                    self->bodyUI->qrCode->setPixmap(QPixmap::fromImage(scaled));
+                }
+            },
+            Qt::QueuedConnection);
+    });
 }
 
 QString ProfileForm::getSupportedImageFilter()
@@ -382,11 +404,19 @@ void ProfileForm::setPasswordButtonsText()
 
 void ProfileForm::onCopyQrClicked()
 {
-    profileInfo->copyQr(*qr->getImage());
+    if (qrImage.isNull()) {
+        return;
+    }
+
+    profileInfo->copyQr(qrImage);
 }
 
 void ProfileForm::onSaveQrClicked()
 {
+    if (qrImage.isNull()) {
+        return;
+    }
+
     const QString current = profileInfo->getProfileName() + ".png";
     const QString path =
         QFileDialog::getSaveFileName(Q_NULLPTR, tr("Save", "save qr image"), current,
@@ -395,7 +425,7 @@ void ProfileForm::onSaveQrClicked()
         return;
     }
 
-    const IProfileInfo::SaveResult result = profileInfo->saveQr(*qr->getImage(), path);
+    const IProfileInfo::SaveResult result = profileInfo->saveQr(qrImage, path);
     if (result == IProfileInfo::SaveResult::OK) {
         return;
     }
@@ -5,7 +5,7 @@
 
 #pragma once
 
-#include "src/widget/qrwidget.h"
+#include <QImage>
 #include <QLabel>
 #include <QLineEdit>
 #include <QTimer>
@@ -80,7 +80,10 @@ private:
     MaskablePixmapWidget* profilePicture;
     QTimer timer;
     bool hasCheck = false;
-    QRWidget* qr;
+    // Rendered off the GUI thread and kept per ID; repeated opens and the
+    // copy/save buttons reuse it instead of re-encoding
+    QImage qrImage;
+    QString qrData;
     ClickableTE* toxId;
     IProfileInfo* profileInfo;
     Settings& settings;
@@ -0,0 +1,167 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "searchresultsdialog.h"
+
+#include "src/conferencelist.h"
+#include "src/core/conferenceid.h"
+#include "src/core/toxpk.h"
+#include "src/friendlist.h"
+#include "src/model/conference.h"
+#include "src/model/friend.h"
+
+#include <QHeaderView>
+#include <QTableView>
+#include <QVBoxLayout>
+
+#include <tuple>
+
+namespace SearchResults {
+namespace {
+// One history query per scroll-to-bottom; small enough to keep the dialog
+// responsive while a large profile is scanned
+constexpr size_t pageSize = 100;
+
+Column toColumn(int in)
+{
+    if (in >= 0 && in < static_cast<int>(Column::invalid)) {
+        return static_cast<Column>(in);
+    }
+    return Column::invalid;
+}
+} // namespace
+
+Model::Model(History* history_, const QString& phrase_, FriendList& friendList_,
+             ConferenceList& conferenceList_, QObject* parent)
+    : QAbstractTableModel(parent)
+    , history{history_}
+    , phrase{phrase_}
+    , friendList{friendList_}
+    , conferenceList{conferenceList_}
+{
+}
+
+QVariant Model::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return {};
+    }
+
+    switch (toColumn(section)) {
+    case Column::date:
+        return tr("Date");
+    case Column::chat:
+        return tr("Chat");
+    case Column::author:
+        return tr("Author");
+    case Column::message:
+        return tr("Message");
+    case Column::invalid:
+        break;
+    }
+
+    return {};
+}
+
+int Model::rowCount(const QModelIndex& parent) const
+{
+    std::ignore = parent;
+    return static_cast<int>(results.size());
+}
+
+int Model::columnCount(const QModelIndex& parent) const
+{
+    std::ignore = parent;
+    return static_cast<int>(Column::invalid);
+}
+
+QVariant Model::data(const QModelIndex& index, int role) const
+{
+    if (role != Qt::DisplayRole || index.row() >= results.size()) {
+        return {};
+    }
+
+    const auto& result = results[index.row()];
+    switch (toColumn(index.column())) {
+    case Column::date:
+        return result.timestamp.toString(QStringLiteral("yyyy-MM-dd hh:mm"));
+    case Column::chat:
+        return chatName(result.chatUuid);
+    case Column::author:
+        return result.dispName.isEmpty() ? tr("Unknown") : result.dispName;
+    case Column::message:
+        return result.message;
+    case Column::invalid:
+        break;
+    }
+
+    return {};
+}
+
+bool Model::canFetchMore(const QModelIndex& parent) const
+{
+    std::ignore = parent;
+    return history != nullptr && !historyExhausted;
+}
+
+void Model::fetchMore(const QModelIndex& parent)
+{
+    std::ignore = parent;
+
+    const auto page = history->searchAllChats(phrase, results.size(), pageSize);
+    if (static_cast<size_t>(page.size()) < pageSize) {
+        historyExhausted = true;
+    }
+
+    if (page.isEmpty()) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), static_cast<int>(results.size()),
+                    static_cast<int>(results.size() + page.size()) - 1);
+    results += page;
+    endInsertRows();
+}
+
+/**
+ * @brief Maps a chat uuid from the database to the name shown in the chat list.
+ *
+ * Friend and conference ids share one uuid column, so both lists are probed.
+ */
+QString Model::chatName(const QByteArray& chatUuid) const
+{
+    if (const Friend* f = friendList.findFriend(ToxPk{chatUuid})) {
+        return f->getDisplayedName();
+    }
+
+    if (const Conference* c = conferenceList.findConference(ConferenceId{chatUuid})) {
+        return c->getDisplayedName();
+    }
+
+    return tr("Unknown");
+}
+} // namespace SearchResults
+
+SearchResultsDialog::SearchResultsDialog(History* history, const QString& phrase,
+                                         FriendList& friendList, ConferenceList& conferenceList,
+                                         QWidget* parent)
+    : QDialog(parent)
+{
+    setAttribute(Qt::WA_DeleteOnClose);
+    setWindowTitle(tr("Search results for \"%1\"").arg(phrase));
+    resize(720, 400);
+
+    auto* model =
+        new SearchResults::Model(history, phrase, friendList, conferenceList, this);
+    auto* view = new QTableView(this);
+    view->setModel(model);
+    view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    view->setWordWrap(false);
+    view->verticalHeader()->hide();
+    view->horizontalHeader()->setStretchLastSection(true);
+
+    auto* layout = new QVBoxLayout(this);
+    layout->addWidget(view);
+}
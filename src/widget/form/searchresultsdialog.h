@@ -0,0 +1,62 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include "src/persistence/history.h"
+
+#include <QAbstractTableModel>
+#include <QDialog>
+
+class ConferenceList;
+class FriendList;
+class QTableView;
+
+namespace SearchResults {
+
+enum class Column : int
+{
+    // NOTE: Order defines order in UI
+    date,
+    chat,
+    author,
+    message,
+    invalid
+};
+
+class Model : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    Model(History* history, const QString& phrase, FriendList& friendList,
+          ConferenceList& conferenceList, QObject* parent = nullptr);
+    ~Model() = default;
+
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+private:
+    QString chatName(const QByteArray& chatUuid) const;
+
+    QList<History::GlobalSearchResult> results;
+    bool historyExhausted = false;
+    History* const history;
+    const QString phrase;
+    FriendList& friendList;
+    ConferenceList& conferenceList;
+};
+} // namespace SearchResults
+
+class SearchResultsDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    SearchResultsDialog(History* history, const QString& phrase, FriendList& friendList,
+                        ConferenceList& conferenceList, QWidget* parent = nullptr);
+};
@@ -84,10 +84,8 @@ ParameterSearch SearchSettingsForm::getParameterSearch()
 
 void SearchSettingsForm::reloadTheme()
 {
-    ui->choiceDateButton->setStyleSheet(
-        style.getStylesheet(QStringLiteral("chatForm/buttons.qss"), settings));
-    ui->startDateLabel->setStyleSheet(
-        style.getStylesheet(QStringLiteral("chatForm/labels.qss"), settings));
+    style.setStylesheet(ui->choiceDateButton, QStringLiteral("chatForm/buttons.qss"), settings);
+    style.setStylesheet(ui->startDateLabel, QStringLiteral("chatForm/labels.qss"), settings);
 }
 
 void SearchSettingsForm::updateStartDateLabel()
@@ -27,11 +27,13 @@
  * Is also contains "Reset settings" button and "Make portable" checkbox.
  */
 
-AdvancedForm::AdvancedForm(Settings& settings_, Style& style, IMessageBoxManager& messageBoxManager_)
+AdvancedForm::AdvancedForm(Settings& settings_, Style& style, IMessageBoxManager& messageBoxManager_,
+                           Profile& profile_)
     : GenericForm(QPixmap(":/img/settings/general.png"), style)
     , bodyUI(new Ui::AdvancedSettings)
     , settings{settings_}
     , messageBoxManager{messageBoxManager_}
+    , profile{profile_}
 {
     bodyUI->setupUi(this);
 
@@ -40,6 +42,25 @@ AdvancedForm::AdvancedForm(Settings& settings_, Style& style, IMessageBoxManager
 
     bodyUI->cbEnableDebug->setChecked(settings.getEnableDebug());
 
+    bodyUI->dbMaintenanceProgress->hide();
+    if (History* history = profile.getHistory()) {
+        connect(history, &History::maintenanceProgress, this, &AdvancedForm::onMaintenanceProgress);
+        connect(history, &History::maintenanceFinished, this, &AdvancedForm::onMaintenanceFinished);
+        connect(history, &History::integrityCheckProgress, this,
+                &AdvancedForm::onMaintenanceProgress);
+        connect(history, &History::integrityCheckFinished, this,
+                &AdvancedForm::onIntegrityCheckFinished);
+    } else {
+        bodyUI->btnCompactDb->setEnabled(false);
+        bodyUI->btnVerifyDb->setEnabled(false);
+    }
+
+    bodyUI->sbImageCacheBudget->setValue(settings.getImageCacheBudgetMiB());
+    bodyUI->sbInteractiveThreads->setValue(settings.getInteractivePoolThreads());
+    bodyUI->sbBackgroundThreads->setValue(settings.getBackgroundPoolThreads());
+    bodyUI->sbDeliveryBatchWindow->setValue(settings.getDeliveryBatchWindowMs());
+    bodyUI->sbPrefetchLead->setValue(settings.getScrollbackPrefetchLeadMs());
+
     bodyUI->cbEnableIPv6->setChecked(settings.getEnableIPv6());
     bodyUI->cbMakeToxPortable->setChecked(settings.getMakeToxPortable());
     bodyUI->proxyAddr->setText(settings.getProxyAddr());
@@ -145,6 +166,89 @@ void AdvancedForm::on_btnCopyDebug_clicked()
     }
 }
 
+void AdvancedForm::on_btnCompactDb_clicked()
+{
+    History* history = profile.getHistory();
+    if (!history) {
+        return;
+    }
+
+    bodyUI->btnCompactDb->setEnabled(false);
+    bodyUI->dbMaintenanceProgress->setValue(0);
+    bodyUI->dbMaintenanceProgress->show();
+    history->startMaintenance();
+}
+
+void AdvancedForm::on_btnVerifyDb_clicked()
+{
+    History* history = profile.getHistory();
+    if (!history) {
+        return;
+    }
+
+    bodyUI->btnVerifyDb->setEnabled(false);
+    bodyUI->dbMaintenanceProgress->setValue(0);
+    bodyUI->dbMaintenanceProgress->show();
+    history->startIntegrityCheck();
+}
+
+void AdvancedForm::onMaintenanceProgress(int percent)
+{
+    bodyUI->dbMaintenanceProgress->setValue(percent);
+}
+
+void AdvancedForm::onMaintenanceFinished(bool success)
+{
+    bodyUI->btnCompactDb->setEnabled(true);
+    bodyUI->dbMaintenanceProgress->hide();
+    if (!success) {
+        messageBoxManager.showError(tr("Database maintenance"),
+                                    tr("Compacting the database failed. See the debug log for "
+                                       "details."));
+    }
+}
+
+void AdvancedForm::onIntegrityCheckFinished(QStringList findings)
+{
+    bodyUI->btnVerifyDb->setEnabled(true);
+    bodyUI->dbMaintenanceProgress->hide();
+    if (findings.isEmpty()) {
+        messageBoxManager.showInfo(tr("Database verification"),
+                                   tr("No problems were found in the history database."));
+    } else {
+        // Findings are diagnostics and already in the debug log; show them verbatim
+        messageBoxManager.showError(tr("Database verification"),
+                                    tr("The history database has problems:\n%1\n"
+                                       "Consider restoring a backup of your profile.")
+                                        .arg(findings.join(QLatin1Char('\n'))));
+    }
+}
+
+void AdvancedForm::on_sbImageCacheBudget_valueChanged(int budgetMiB)
+{
+    settings.setImageCacheBudgetMiB(budgetMiB);
+}
+
+void AdvancedForm::on_sbInteractiveThreads_valueChanged(int threads)
+{
+    settings.setInteractivePoolThreads(threads);
+}
+
+void AdvancedForm::on_sbBackgroundThreads_valueChanged(int threads)
+{
+    settings.setBackgroundPoolThreads(threads);
+}
+
+void AdvancedForm::on_sbDeliveryBatchWindow_valueChanged(int windowMs)
+{
+    settings.setDeliveryBatchWindowMs(windowMs);
+}
+
+void AdvancedForm::on_sbPrefetchLead_valueChanged(int leadMs)
+{
+    settings.setScrollbackPrefetchLeadMs(leadMs);
+}
+
 void AdvancedForm::on_resetButton_clicked()
 {
     const QString title = tr("Reset settings");
@@ -7,7 +7,10 @@
 
 #include "genericsettings.h"
 
+#include <QStringList>
+
 class Core;
+class Profile;
 class Settings;
 class Style;
 class IMessageBoxManager;
@@ -20,7 +23,8 @@ class AdvancedForm : public GenericForm
 {
     Q_OBJECT
 public:
-    AdvancedForm(Settings& settings, Style& style, IMessageBoxManager& messageBoxManager);
+    AdvancedForm(Settings& settings, Style& style, IMessageBoxManager& messageBoxManager,
+                 Profile& profile);
     ~AdvancedForm();
     QString getFormName() final
     {
@@ -35,6 +39,18 @@ private slots:
     void on_btnCopyDebug_clicked();
     void on_btnExportLog_clicked();
     void on_cbEnableDebug_stateChanged();
+    // Database
+    void on_btnCompactDb_clicked();
+    void on_btnVerifyDb_clicked();
+    void onMaintenanceProgress(int percent);
+    void onMaintenanceFinished(bool success);
+    void onIntegrityCheckFinished(QStringList findings);
+    // Performance
+    void on_sbImageCacheBudget_valueChanged(int budgetMiB);
+    void on_sbInteractiveThreads_valueChanged(int threads);
+    void on_sbBackgroundThreads_valueChanged(int threads);
+    void on_sbDeliveryBatchWindow_valueChanged(int windowMs);
+    void on_sbPrefetchLead_valueChanged(int leadMs);
     // Connection
     void on_cbEnableIPv6_stateChanged();
     void on_cbEnableUDP_stateChanged();
@@ -50,4 +66,5 @@ private:
     Ui::AdvancedSettings* bodyUI;
     Settings& settings;
     IMessageBoxManager& messageBoxManager;
+    Profile& profile;
 };
@@ -9,6 +9,7 @@
 #include <map>
 
 #include <QDebug>
+#include <QFutureWatcher>
 #include <QScreen>
 #include <QShowEvent>
 
@@ -21,6 +22,7 @@
 #include "src/video/camerasource.h"
 #include "src/video/ivideosettings.h"
 #include "src/video/videosurface.h"
+#include "src/workerpool.h"
 #include "src/widget/tool/recursivesignalblocker.h"
 #include "src/widget/tool/screenshotgrabber.h"
 #include "src/widget/translator.h"
@@ -50,6 +52,24 @@ AVForm::AVForm(IAudioControl& audio_, CoreAV* coreAV_, CameraSource& camera_,
 
     connect(rescanButton, &QPushButton::clicked, this, &AVForm::rescanDevices);
 
+    // Refresh the audio combo boxes when the backend notices a hotplug
+    connect(&audio_, &IAudioControl::deviceListsChanged, this, [this] {
+        if (isVisible()) {
+            getAudioOutDevices();
+            getAudioInDevices();
+        }
+    });
+
+    connect(&audio_, &IAudioControl::latencyProbeResult, this, &AVForm::onLatencyProbeResult);
+
+    // Surface which decoding path the camera ended up on once the device is up
+    connect(&camera_, &CameraSource::deviceOpened, this, [this] {
+        const QString backend = camera.getHwDecoderName();
+        videoDevCombobox->setToolTip(backend.isEmpty()
+                                         ? tr("Video decoding: software")
+                                         : tr("Video decoding: %1 (hardware)").arg(backend));
+    });
+
     playbackSlider->setTracking(false);
     playbackSlider->setMaximum(totalSliderSteps);
     playbackSlider->setValue(getStepsFromValue(audioSettings_->getOutVolume(),
@@ -152,6 +172,9 @@ void AVForm::trackNewScreenGeometry(QScreen* qScreen)
 
 void AVForm::rescanDevices()
 {
+    // A rescan is the user telling us the hardware changed; drop the caches
+    // so the worker probes the devices again
+    CameraDevice::invalidateDeviceCaches();
     getAudioInDevices();
     getAudioOutDevices();
     getVideoDevices();
@@ -451,22 +474,58 @@ void AVForm::on_audioQualityComboBox_currentIndexChanged(int index)
     audioSettings->setAudioBitrate(audioQualityComboBox->currentData().toInt());
 }
 
-void AVForm::getVideoDevices()
+void AVForm::on_latencyProbeButton_clicked()
 {
-    QString settingsInDev = videoSettings->getVideoDev();
-    int videoDevIndex = 0;
-    videoDeviceList = CameraDevice::getDeviceList();
-    // prevent currentIndexChanged to be fired while adding items
-    videoDevCombobox->blockSignals(true);
-    videoDevCombobox->clear();
-    for (QPair<QString, QString> device : videoDeviceList) {
-        videoDevCombobox->addItem(device.second);
-        if (device.first == settingsInDev)
-            videoDevIndex = videoDevCombobox->count() - 1;
+    latencyProbeButton->setEnabled(false);
+    latencyResultLabel->setText(tr("Measuring…"));
+    audio.startLatencyProbe();
+}
+
+void AVForm::onLatencyProbeResult(qreal roundTripMs, qreal jitterMs)
+{
+    latencyProbeButton->setEnabled(true);
+    if (roundTripMs < 0) {
+        latencyResultLabel->setText(
+            tr("Measurement failed. The microphone must be able to hear the speakers."));
+        return;
     }
-    videoDevCombobox->setCurrentIndex(videoDevIndex);
-    videoDevCombobox->blockSignals(false);
-    updateVideoModes(videoDevIndex);
+
+    latencyResultLabel->setText(tr("%1 ms round trip, %2 ms jitter")
+                                    .arg(roundTripMs, 0, 'f', 1)
+                                    .arg(jitterMs, 0, 'f', 1));
+}
+
+void AVForm::getVideoDevices()
+{
+    // Enumerating capture devices opens each one and can take seconds on a
+    // cold cache; do it on a worker so the settings page shows immediately,
+    // and fill the combo box once the list is back
+    using DeviceList = QVector<QPair<QString, QString>>;
+    auto* watcher = new QFutureWatcher<DeviceList>(this);
+    connect(watcher, &QFutureWatcher<DeviceList>::finished, this, [this, watcher] {
+        watcher->deleteLater();
+        if (!isVisible()) {
+            // hideEvent already tore the video state down
+            return;
+        }
+
+        QString settingsInDev = videoSettings->getVideoDev();
+        int videoDevIndex = 0;
+        videoDeviceList = watcher->result();
+        // prevent currentIndexChanged to be fired while adding items
+        videoDevCombobox->blockSignals(true);
+        videoDevCombobox->clear();
+        for (QPair<QString, QString> device : videoDeviceList) {
+            videoDevCombobox->addItem(device.second);
+            if (device.first == settingsInDev)
+                videoDevIndex = videoDevCombobox->count() - 1;
+        }
+        videoDevCombobox->setCurrentIndex(videoDevIndex);
+        videoDevCombobox->blockSignals(false);
+        updateVideoModes(videoDevIndex);
+    });
+    watcher->setFuture(
+        WorkerPool::instance().runInteractive([] { return CameraDevice::getDeviceList(); }));
 }
 
 int AVForm::getModeSize(VideoMode mode)
@@ -62,6 +62,8 @@ private slots:
     void on_microphoneSlider_valueChanged(int sliderSteps);
     void on_audioThresholdSlider_valueChanged(int sliderSteps);
     void on_audioQualityComboBox_currentIndexChanged(int index);
+    void on_latencyProbeButton_clicked();
+    void onLatencyProbeResult(qreal roundTripMs, qreal jitterMs);
 
     // camera
     void on_videoDevCombobox_currentIndexChanged(int index);
@@ -45,25 +45,47 @@ SettingsWidget::SettingsWidget(UpdateCheck& updateCheck, IAudioControl& audio, C
     settingsWidgets->setTabPosition(QTabWidget::North);
     bodyLayout->addWidget(settingsWidgets.get());
 
-    std::unique_ptr<GeneralForm> gfrm(new GeneralForm(settings, style));
-    connect(gfrm.get(), &GeneralForm::updateIcons, parent, &Widget::updateIcons);
-
-    std::unique_ptr<UserInterfaceForm> uifrm(new UserInterfaceForm(smileyPack, settings, style, this));
-    std::unique_ptr<PrivacyForm> pfrm(new PrivacyForm(core, settings, style, profile));
-    connect(pfrm.get(), &PrivacyForm::clearAllReceipts, parent, &Widget::clearAllReceipts);
-
-    AVForm* rawAvfrm = new AVForm(audio, coreAV, cameraSource, audioSettings, videoSettings, style);
-    std::unique_ptr<AVForm> avfrm(rawAvfrm);
-    std::unique_ptr<AdvancedForm> expfrm(new AdvancedForm(settings, style, messageBoxManager));
-    std::unique_ptr<AboutForm> abtfrm(new AboutForm(updateCheck, core->getSelfId().toString(), style));
+    // Forms are expensive to construct (AVForm probes devices on show,
+    // AboutForm renders the license text), so every tab starts out as an
+    // empty placeholder and the real form is built the first time its tab
+    // is activated. Opening Settings only pays for the tab being looked at.
+    tabs = {{
+        {[&settings = settings, &style = style, parent]() -> GenericForm* {
+             auto* form = new GeneralForm(settings, style);
+             connect(form, &GeneralForm::updateIcons, parent, &Widget::updateIcons);
+             return form;
+         },
+         [] { return GeneralForm::tr("General"); }, ":/img/settings/general.png"},
+        {[&smileyPack = smileyPack, &settings = settings, &style = style, this]() -> GenericForm* {
+             return new UserInterfaceForm(smileyPack, settings, style, this);
+         },
+         [] { return UserInterfaceForm::tr("User Interface"); }, ":/img/settings/general.png"},
+        {[core, &settings = settings, &style = style, &profile = profile, parent]() -> GenericForm* {
+             auto* form = new PrivacyForm(core, settings, style, profile);
+             connect(form, &PrivacyForm::clearAllReceipts, parent, &Widget::clearAllReceipts);
+             return form;
+         },
+         [] { return PrivacyForm::tr("Privacy"); }, ":/img/settings/privacy.png"},
+        {[&audio = audio, coreAV, &cameraSource = cameraSource, audioSettings, videoSettings,
+          &style = style]() -> GenericForm* {
+             return new AVForm(audio, coreAV, cameraSource, audioSettings, videoSettings, style);
+         },
+         [] { return AVForm::tr("Audio/Video"); }, ":/img/settings/av.png"},
+        {[&settings = settings, &style = style, &messageBoxManager = messageBoxManager,
+          &profile = profile]() -> GenericForm* {
+             return new AdvancedForm(settings, style, messageBoxManager, profile);
+         },
+         [] { return AdvancedForm::tr("Advanced"); }, ":/img/settings/general.png"},
+        {[&updateCheck = updateCheck, core, &style = style]() -> GenericForm* {
+             return new AboutForm(updateCheck, core->getSelfId().toString(), style);
+         },
+         [] { return AboutForm::tr("About"); }, ":/img/settings/general.png"},
+    }};
+
+    for (const LazyTab& tab : tabs)
+        settingsWidgets->addTab(new QWidget(this), QPixmap(tab.iconPath), tab.name());
 
     connect(&updateCheck, &UpdateCheck::updateAvailable, this, &SettingsWidget::onUpdateAvailable);
-
-    cfgForms = {{std::move(gfrm), std::move(uifrm), std::move(pfrm), std::move(avfrm),
-                 std::move(expfrm), std::move(abtfrm)}};
-    for (auto& cfgForm : cfgForms)
-        settingsWidgets->addTab(cfgForm.get(), cfgForm->getFormIcon(), cfgForm->getFormName());
-
     connect(settingsWidgets.get(), &QTabWidget::currentChanged, this, &SettingsWidget::onTabChanged);
 
     Translator::registerHandler(std::bind(&SettingsWidget::retranslateUi, this), this);
@@ -103,9 +125,31 @@ void SettingsWidget::show(ContentLayout* contentLayout)
 
 void SettingsWidget::onTabChanged(int index)
 {
+    ensureTabAt(index);
     settingsWidgets->setCurrentIndex(index);
 }
 
+/**
+ * @brief Builds the form behind a tab on first activation.
+ *
+ * Swaps the placeholder page for the freshly constructed form. Signals are
+ * blocked during the swap, since removing the current tab would otherwise
+ * re-enter onTabChanged for a neighbouring placeholder and build it too.
+ */
+GenericForm* SettingsWidget::ensureTabAt(int index)
+{
+    auto& form = cfgForms[index];
+    if (!form) {
+        form.reset(tabs[index].factory());
+        const QSignalBlocker blocker{settingsWidgets.get()};
+        QWidget* placeholder = settingsWidgets->widget(index);
+        settingsWidgets->removeTab(index);
+        settingsWidgets->insertTab(index, form.get(), form->getFormIcon(), form->getFormName());
+        delete placeholder;
+    }
+    return form.get();
+}
+
 void SettingsWidget::onUpdateAvailable(void)
 {
     settingsWidgets->tabBar()->setProperty("update-available", true);
@@ -115,6 +159,8 @@ void SettingsWidget::onUpdateAvailable(void)
 
 void SettingsWidget::retranslateUi()
 {
-    for (size_t i = 0; i < cfgForms.size(); ++i)
-        settingsWidgets->setTabText(i, cfgForms[i]->getFormName());
+    // Placeholder tabs have no form to ask, so the names come from the
+    // per-tab name functions; they use the form classes' translation context
+    for (size_t i = 0; i < tabs.size(); ++i)
+        settingsWidgets->setTabText(i, tabs[i].name());
 }
@@ -10,6 +10,7 @@
 #include <QStyleFactory>
 
 #include <array>
+#include <functional>
 #include <memory>
 
 class Camera;
@@ -54,10 +55,22 @@ private slots:
 
 private:
     void retranslateUi();
+    GenericForm* ensureTabAt(int index);
 
 private:
+    // Everything needed to populate one tab without constructing its form:
+    // a factory run on first activation, plus the name and icon shown on the
+    // placeholder tab until then
+    struct LazyTab
+    {
+        std::function<GenericForm*()> factory;
+        QString (*name)();
+        const char* iconPath;
+    };
+
     std::unique_ptr<QVBoxLayout> bodyLayout;
     std::unique_ptr<QTabWidget> settingsWidgets;
+    std::array<LazyTab, 6> tabs;
     std::array<std::unique_ptr<GenericForm>, 6> cfgForms;
     int currentIndex;
 };
@@ -0,0 +1,61 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "framegovernor.h"
+
+#include <QWidget>
+
+/**
+ * @class FrameGovernor
+ * @brief Tracks whether any qTox window is actually on screen.
+ *
+ * Top-level windows (the main window and content dialogs) report their
+ * visibility here as they show, hide and minimize. Consumers that do
+ * per-frame work — video surfaces, the chat animation ticker, the chat
+ * layout worker — listen to appVisibleChanged() and idle themselves while
+ * nothing is visible, so a minimized qTox stops converting preview frames
+ * and animating scenes nobody can see.
+ */
+
+/**
+ * @brief Reports a window's visibility; emits appVisibleChanged on the edge.
+ */
+void FrameGovernor::setWindowVisible(QWidget* window, bool visible)
+{
+    const bool wasVisible = appVisible();
+
+    if (visible) {
+        if (!visibleWindows.contains(window)) {
+            visibleWindows.insert(window);
+            // A window destroyed while still visible must not keep the app
+            // counted as visible
+            destroyedConnections[window] = connect(window, &QObject::destroyed, this, [this, window] {
+                setWindowVisible(window, false);
+            });
+        }
+    } else if (visibleWindows.remove(window)) {
+        disconnect(destroyedConnections.take(window));
+    }
+
+    if (appVisible() != wasVisible) {
+        emit appVisibleChanged(!wasVisible);
+    }
+}
+
+/**
+ * @brief Whether at least one reporting window is visible and not minimized.
+ */
+bool FrameGovernor::appVisible() const
+{
+    return !visibleWindows.isEmpty();
+}
+
+/**
+ * @brief Returns the singleton instance.
+ */
+FrameGovernor& FrameGovernor::getInstance()
+{
+    static FrameGovernor instance;
+    return instance;
+}
@@ -0,0 +1,32 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+
+class QWidget;
+
+class FrameGovernor : public QObject
+{
+    Q_OBJECT
+public:
+    static FrameGovernor& getInstance();
+
+    void setWindowVisible(QWidget* window, bool visible);
+    bool appVisible() const;
+
+signals:
+    void appVisibleChanged(bool visible);
+
+private:
+    FrameGovernor() = default;
+    FrameGovernor(FrameGovernor&) = delete;
+    FrameGovernor& operator=(const FrameGovernor&) = delete;
+
+    QSet<QWidget*> visibleWindows;
+    QHash<QWidget*, QMetaObject::Connection> destroyedConnections;
+};
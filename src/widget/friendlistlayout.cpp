@@ -40,15 +40,22 @@ void FriendListLayout::init()
 
 void FriendListLayout::addFriendWidget(FriendWidget* w, Status::Status s)
 {
-    friendOfflineLayout.removeSortedWidget(w);
-    friendOnlineLayout.removeSortedWidget(w);
-
-    if (s == Status::Status::Offline) {
-        friendOfflineLayout.addSortedWidget(w);
+    GenericChatItemLayout& target =
+        s == Status::Status::Offline ? friendOfflineLayout : friendOnlineLayout;
+    GenericChatItemLayout& other =
+        s == Status::Status::Offline ? friendOnlineLayout : friendOfflineLayout;
+
+    // Status flips within a section (online <-> away/busy) used to remove and
+    // re-insert the widget, invalidating the layout of the whole column below
+    // it. The sort order only depends on the name, so if the widget already
+    // sits in the right section nothing has to move: the status icon repaints
+    // its own rect and every other row is left alone.
+    if (target.existsSortedWidget(w)) {
         return;
     }
 
-    friendOnlineLayout.addSortedWidget(w);
+    other.removeSortedWidget(w);
+    target.addSortedWidget(w);
 }
 
 void FriendListLayout::removeFriendWidget(FriendWidget* widget, Status::Status s)
@@ -72,9 +72,9 @@ Time getTimeBucket(const QDateTime& date)
     return Time::LongAgo;
 }
 
-QDateTime getActiveTimeFriend(const Friend* contact, Settings& settings)
+QDateTime getActiveTimeFriend(const Friend* contact)
 {
-    return settings.getFriendActivity(contact->getPublicKey());
+    return contact->getLastActivity();
 }
 
 qint64 timeUntilTomorrow()
@@ -332,7 +332,7 @@ QVector<std::shared_ptr<IFriendListItem>> FriendListWidget::getItemsFromCircle(C
 
 CategoryWidget* FriendListWidget::getTimeCategoryWidget(const Friend* frd) const
 {
-    const auto activityTime = getActiveTimeFriend(frd, settings);
+    const auto activityTime = getActiveTimeFriend(frd);
     int timeIndex = static_cast<int>(getTimeBucket(activityTime));
     QWidget* widget = activityLayout->itemAt(timeIndex)->widget();
     return qobject_cast<CategoryWidget*>(widget);
@@ -451,7 +451,7 @@ void FriendListWidget::cycleChats(GenericChatroomWidget* activeChatroomWidget, b
             return;
         }
 
-        const auto activityTime = getActiveTimeFriend(friendWidget->getFriend(), settings);
+        const auto activityTime = getActiveTimeFriend(friendWidget->getFriend());
         index = static_cast<int>(getTimeBucket(activityTime));
         QWidget* widget_ = activityLayout->itemAt(index)->widget();
         CategoryWidget* categoryWidget = qobject_cast<CategoryWidget*>(widget_);
@@ -558,7 +558,22 @@ void FriendListWidget::dayTimeout()
 
 void FriendListWidget::itemsChanged()
 {
-    sortByMode();
+    // Status and activity changes arrive in bursts, e.g. when connecting and
+    // dozens of friends come online at once. Coalesce everything from one
+    // event-loop turn into a single resort and relayout.
+    if (sortPending) {
+        return;
+    }
+    sortPending = true;
+
+    QTimer::singleShot(0, this, [this]() {
+        sortPending = false;
+        // suppress repaints of the intermediate states while the list is
+        // torn down and rebuilt
+        setUpdatesEnabled(false);
+        sortByMode();
+        setUpdatesEnabled(true);
+    });
 }
 
 void FriendListWidget::moveWidget(FriendWidget* widget, Status::Status s, bool add)
@@ -85,6 +85,8 @@ private:
     QVector<std::shared_ptr<IFriendListItem>> getItemsFromCircle(CircleWidget* circle) const;
 
     SortingMode mode;
+    // true while a coalesced resort is scheduled on the event loop
+    bool sortPending = false;
     QVBoxLayout* listLayout = nullptr;
     QVBoxLayout* activityLayout = nullptr;
     QTimer* dayTimer;
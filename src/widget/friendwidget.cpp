@@ -54,7 +54,7 @@ FriendWidget::FriendWidget(std::shared_ptr<FriendChatroom> chatroom_, bool compa
     , profile{profile_}
 {
     avatar->setPixmap(QPixmap(":/img/contact.svg"));
-    statusPic.setPixmap(QPixmap(Status::getIconPath(Status::Status::Offline)));
+    statusPic.setPixmap(Status::getIconPixmap(Status::Status::Offline));
     statusPic.setMargin(3);
 
     auto frnd = chatroom->getFriend();
@@ -308,7 +308,7 @@ void FriendWidget::updateStatusLight()
 {
     const auto frnd = chatroom->getFriend();
     const bool event = frnd->getEventFlag();
-    statusPic.setPixmap(QPixmap(Status::getIconPath(frnd->getStatus(), event)));
+    statusPic.setPixmap(Status::getIconPixmap(frnd->getStatus(), event));
 
     if (event) {
         const Settings& s = settings;
@@ -375,8 +375,7 @@ QString FriendWidget::getNameItem() const
 
 QDateTime FriendWidget::getLastActivity() const
 {
-    const auto frnd = chatroom->getFriend();
-    return settings.getFriendActivity(frnd->getPublicKey());
+    return chatroom->getFriend()->getLastActivity();
 }
 
 QWidget* FriendWidget::getWidget()
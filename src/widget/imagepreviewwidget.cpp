@@ -5,27 +5,31 @@
 
 #include "imagepreviewwidget.h"
 #include "src/model/exiftransform.h"
+#include "src/workerpool.h"
 
 #include <QApplication>
 #include <QBuffer>
 #include <QFile>
 #include <QFileInfo>
+#include <QPointer>
 #include <QScreen>
 #include <QString>
 
+#include <tuple>
+
 namespace {
-QPixmap pixmapFromFile(const QString& filename)
+QImage imageFromFile(const QString& filename)
 {
     static const QStringList previewExtensions = {"png", "jpeg", "jpg", "gif", "svg",
                                                   "PNG", "JPEG", "JPG", "GIF", "SVG"};
 
     if (!previewExtensions.contains(QFileInfo(filename).suffix())) {
-        return QPixmap();
+        return QImage();
     }
 
     QFile imageFile(filename);
     if (!imageFile.open(QIODevice::ReadOnly)) {
-        return QPixmap();
+        return QImage();
     }
 
     const QByteArray imageFileData = imageFile.readAll();
@@ -33,7 +37,7 @@ QPixmap pixmapFromFile(const QString& filename)
     auto orientation = ExifTransform::getOrientation(imageFileData);
     image = ExifTransform::applyTransformation(image, orientation);
 
-    return QPixmap::fromImage(image);
+    return image;
 }
 
 QPixmap scaleCropIntoSquare(const QPixmap& source, const int targetSize)
@@ -103,7 +107,21 @@ void ImagePreviewButton::initialize(const QPixmap& image)
 
 void ImagePreviewButton::setIconFromFile(const QString& filename)
 {
-    initialize(pixmapFromFile(filename));
+    // Decoding and EXIF-rotating a phone photo can take hundreds of ms, so
+    // run all of it on the thread pool; only the QPixmap conversion (GUI
+    // thread only) happens once the result is queued back here. The QPointer
+    // drops the update on the floor if the transfer widget is gone by then.
+    QPointer<ImagePreviewButton> self{this};
+    std::ignore = WorkerPool::instance().runInteractive([self, filename] {
+        const QImage image = imageFromFile(filename);
+        QMetaObject::invokeMethod(
+            QApplication::instance(),
+            [self, image] {
+                if (self)
+                    self->initialize(QPixmap::fromImage(image));
+            },
+            Qt::QueuedConnection);
+    });
 }
 
 void ImagePreviewButton::setIconFromPixmap(const QPixmap& pixmap)
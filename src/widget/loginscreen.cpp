@@ -15,7 +15,9 @@
 #include "src/widget/translator.h"
 #include <QDebug>
 #include <QDialog>
+#include <QFileInfo>
 #include <QMessageBox>
+#include <QSettings>
 #include <QToolButton>
 
 LoginScreen::LoginScreen(Paths& paths_, Style& style, int themeColor,
@@ -75,6 +77,7 @@ void LoginScreen::reset(const QString& initialProfileName)
     ui->newPassConfirm->clear();
     ui->loginPassword->clear();
     ui->loginUsernames->clear();
+    encryptedCache.clear();
 
     QStringList allProfileNames = Profile::getAllProfileNames(paths);
 
@@ -174,7 +177,13 @@ void LoginScreen::onLoginUsernameSelected(const QString& name)
         return;
 
     ui->loginPassword->clear();
-    if (Profile::isEncrypted(name, paths)) {
+
+    auto encryptedIt = encryptedCache.constFind(name);
+    if (encryptedIt == encryptedCache.constEnd()) {
+        encryptedIt = encryptedCache.insert(name, isEncryptedCached(name));
+    }
+
+    if (*encryptedIt) {
         ui->loginPasswordLabel->show();
         ui->loginPassword->show();
         // there is no way to do autologin if profile is encrypted, and
@@ -190,6 +199,37 @@ void LoginScreen::onLoginUsernameSelected(const QString& name)
     }
 }
 
+/**
+ * @brief Like Profile::isEncrypted, but backed by a cache file so unchanged
+ * profiles don't get their tox save re-opened on every qTox start.
+ *
+ * Entries are validated against the save file's mtime and size, so a profile
+ * modified by another client gets re-probed. Only the encrypted flag lives
+ * here; nothing sensitive ends up in the cache directory.
+ */
+bool LoginScreen::isEncryptedCached(const QString& name)
+{
+    const QFileInfo toxSave(paths.getSettingsDirPath() + name + ".tox");
+    const QDateTime mtime = toxSave.lastModified();
+    const qint64 size = toxSave.size();
+
+    QSettings cache(paths.getAppCacheDirPath() + QStringLiteral("profilemeta.ini"),
+                    QSettings::IniFormat);
+    cache.beginGroup(name);
+
+    if (cache.value(QStringLiteral("mtime")).toDateTime() == mtime
+        && cache.value(QStringLiteral("size")).toLongLong() == size
+        && cache.contains(QStringLiteral("encrypted"))) {
+        return cache.value(QStringLiteral("encrypted")).toBool();
+    }
+
+    const bool encrypted = Profile::isEncrypted(name, paths);
+    cache.setValue(QStringLiteral("mtime"), mtime);
+    cache.setValue(QStringLiteral("size"), size);
+    cache.setValue(QStringLiteral("encrypted"), encrypted);
+    return encrypted;
+}
+
 void LoginScreen::onLogin()
 {
     QString name = ui->loginUsernames->currentText();
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <QDialog>
+#include <QHash>
 #include <QShortcut>
 #include <QToolButton>
 
@@ -56,6 +57,7 @@ private slots:
 
 private:
     void reset(const QString& initialProfileName = QString());
+    bool isEncryptedCached(const QString& name);
     void retranslateUi();
     void showCapsIndicator();
     void hideCapsIndicator();
@@ -65,4 +67,7 @@ private:
     Ui::LoginScreen* ui;
     QShortcut quitShortcut;
     Paths& paths;
+    // Encryption probes open the tox save; remember the verdicts so flipping
+    // through the profile combo box doesn't re-read each file
+    QHash<QString, bool> encryptedCache;
 };
@@ -66,6 +66,11 @@ void NotificationScrollArea::updateVisualTracking()
  */
 void NotificationScrollArea::updateTracking(GenericChatroomWidget* widget)
 {
+    // Called from every main-window paint event; with no unread chats being
+    // tracked there is nothing to recount, so don't touch widget geometry
+    if (trackedWidgets.isEmpty())
+        return;
+
     QHash<GenericChatroomWidget*, Visibility>::iterator i = trackedWidgets.begin();
     while (i != trackedWidgets.end()) {
         if (i.key() == widget || widgetVisible(i.key()) == Visible) {
@@ -58,9 +58,16 @@ bool QRWidget::saveImage(QString path)
 }
 
 // http://stackoverflow.com/questions/21400254/how-to-draw-a-qr-code-with-qt-in-native-c-c
-void QRWidget::paintImage()
+/**
+ * @brief Rasterizes a QR code into an image, without touching any widget.
+ *
+ * Everything here (libqrencode and QPainter on a QImage) is safe to run off
+ * the GUI thread, which is where callers with large codes should run it.
+ */
+QImage QRWidget::render(const QString& data, const QSize& size)
 {
-    QPainter painter(image);
+    QImage image(size, QImage::Format_RGB32);
+    QPainter painter(&image);
     // NOTE: I have hardcoded some parameters here that would make more sense as variables.
     // ECLEVEL_M is much faster recognizable by barcodescanner any any other type
     // https://fukuchi.org/works/qrencode/manual/qrencode_8h.html#a4cebc3c670efe1b8866b14c42737fc8f
@@ -79,8 +86,8 @@ void QRWidget::paintImage()
         painter.scale(0.96, 0.96);
         painter.translate(size.width() * 0.02, size.height() * 0.02);
         const int s = qr->width > 0 ? qr->width : 1;
-        const double w = width();
-        const double h = height();
+        const double w = size.width();
+        const double h = size.height();
         const double aspect = w / h;
         const double scale = ((aspect > 1.0) ? h : w) / s;
 
@@ -100,9 +107,14 @@ void QRWidget::paintImage()
     } else {
         QColor error("red");
         painter.setBrush(error);
-        painter.drawRect(0, 0, width(), height());
+        painter.drawRect(0, 0, size.width(), size.height());
         qDebug() << "QR FAIL:" << strerror(errno);
     }
 
-    qr = nullptr;
+    return image;
+}
+
+void QRWidget::paintImage()
+{
+    *image = render(data, size);
 }
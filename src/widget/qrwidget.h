@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <QImage>
 #include <QWidget>
 
 class QRWidget : public QWidget
@@ -19,6 +20,8 @@ public:
     QImage* getImage();
     bool saveImage(QString path);
 
+    static QImage render(const QString& data, const QSize& size);
+
 private:
     QString data;
     void paintImage();
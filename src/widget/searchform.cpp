@@ -47,6 +47,8 @@ SearchForm::SearchForm(Settings& settings_, Style& style_, QWidget* parent)
     hideButton = createButton("searchHideButton", "red");
     startButton = createButton("startButton", "green");
     startButton->setText(tr("Start"));
+    allButton = createButton("startButton", "green");
+    allButton->setText(tr("All"));
 
     layoutNavigation->setContentsMargins(0, 0, 0, 0);
     layoutNavigation->addWidget(settingsButton);
@@ -54,6 +56,7 @@ SearchForm::SearchForm(Settings& settings_, Style& style_, QWidget* parent)
     layoutNavigation->addWidget(startButton);
     layoutNavigation->addWidget(upButton);
     layoutNavigation->addWidget(downButton);
+    layoutNavigation->addWidget(allButton);
     layoutNavigation->addWidget(hideButton);
 
     layout->addLayout(layoutNavigation);
@@ -77,6 +80,7 @@ SearchForm::SearchForm(Settings& settings_, Style& style_, QWidget* parent)
     connect(downButton, &QPushButton::clicked, this, &SearchForm::clickedDown);
     connect(hideButton, &QPushButton::clicked, this, &SearchForm::clickedHide);
     connect(startButton, &QPushButton::clicked, this, &SearchForm::clickedStart);
+    connect(allButton, &QPushButton::clicked, this, &SearchForm::clickedAll);
     connect(settingsButton, &QPushButton::clicked, this, &SearchForm::clickedSearch);
 
     connect(searchSettingsForm, &SearchSettingsForm::updateSettings, this, &SearchForm::changedState);
@@ -111,11 +115,12 @@ void SearchForm::insertEditor(const QString& text)
 
 void SearchForm::reloadTheme()
 {
-    settingsButton->setStyleSheet(style.getStylesheet(QStringLiteral("chatForm/buttons.qss"), settings));
-    upButton->setStyleSheet(style.getStylesheet(QStringLiteral("chatForm/buttons.qss"), settings));
-    downButton->setStyleSheet(style.getStylesheet(QStringLiteral("chatForm/buttons.qss"), settings));
-    hideButton->setStyleSheet(style.getStylesheet(QStringLiteral("chatForm/buttons.qss"), settings));
-    startButton->setStyleSheet(style.getStylesheet(QStringLiteral("chatForm/buttons.qss"), settings));
+    style.setStylesheet(settingsButton, QStringLiteral("chatForm/buttons.qss"), settings);
+    style.setStylesheet(upButton, QStringLiteral("chatForm/buttons.qss"), settings);
+    style.setStylesheet(downButton, QStringLiteral("chatForm/buttons.qss"), settings);
+    style.setStylesheet(hideButton, QStringLiteral("chatForm/buttons.qss"), settings);
+    style.setStylesheet(startButton, QStringLiteral("chatForm/buttons.qss"), settings);
+    style.setStylesheet(allButton, QStringLiteral("chatForm/buttons.qss"), settings);
 
     searchSettingsForm->reloadTheme();
 }
@@ -245,6 +250,13 @@ void SearchForm::clickedStart()
     emit searchInBegin(searchPhrase, getAndCheckParameterSearch());
 }
 
+void SearchForm::clickedAll()
+{
+    if (!searchPhrase.isEmpty()) {
+        emit searchAll(searchPhrase);
+    }
+}
+
 void SearchForm::clickedSearch()
 {
     isActiveSettings = !isActiveSettings;
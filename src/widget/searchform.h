@@ -49,6 +49,7 @@ private:
     QPushButton* downButton;
     QPushButton* hideButton;
     QPushButton* startButton;
+    QPushButton* allButton;
     LineEdit* searchLine;
     SearchSettingsForm* searchSettingsForm;
     QLabel* messageLabel;
@@ -69,6 +70,7 @@ private slots:
     void clickedDown();
     void clickedHide();
     void clickedStart();
+    void clickedAll();
     void clickedSearch();
     void changedState(bool isUpdate);
 
@@ -80,6 +82,7 @@ signals:
     void searchInBegin(const QString& phrase, const ParameterSearch& parameter);
     void searchUp(const QString& phrase, const ParameterSearch& parameter);
     void searchDown(const QString& phrase, const ParameterSearch& parameter);
+    void searchAll(const QString& phrase);
     void visibleChanged();
 };
 
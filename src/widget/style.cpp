@@ -51,6 +51,11 @@
  */
 
 namespace {
+constexpr size_t idx(Style::ColorPalette entry)
+{
+    return static_cast<size_t>(entry);
+}
+
 const QLatin1String ThemeSubFolder{"themes/"};
 const QLatin1String BuiltinThemeDefaultPath{":themes/default/"};
 const QLatin1String BuiltinThemeDarkPath{":themes/dark/"};
@@ -177,6 +182,24 @@ const QString Style::getStylesheet(const QString& filename, int themeColor, cons
     return newStylesheet;
 }
 
+/**
+ * @brief Applies a stylesheet to a widget, skipping the re-polish if the
+ * resolved stylesheet is the one the widget already has.
+ *
+ * setStyleSheet() re-parses and re-polishes unconditionally, so theme reload
+ * cascades should go through here: widgets whose effective stylesheet didn't
+ * change then cost a cache lookup and a string compare instead of a style
+ * rebuild.
+ */
+void Style::setStylesheet(QWidget* widget, const QString& filename, const Settings& settings,
+                          const QFont& baseFont)
+{
+    const QString stylesheet = getStylesheet(filename, settings, baseFont);
+    if (widget->styleSheet() != stylesheet) {
+        widget->setStyleSheet(stylesheet);
+    }
+}
+
 const QString Style::getImagePath(const QString& filename, const Settings& settings)
 {
     return getImagePath(filename, settings.getThemeColor());
@@ -211,7 +234,7 @@ const QString Style::getImagePath(const QString& filename, int themeColor)
 
 QColor Style::getColor(ColorPalette entry)
 {
-    return palette[entry];
+    return palette[idx(entry)];
 }
 
 QFont Style::getFont(Font font)
@@ -221,17 +244,18 @@ QFont Style::getFont(Font font)
 
     static const int defSize = QFontInfo(QFont()).pixelSize();
 
-    static const std::map<Font, QFont> fonts = {
-        {Font::ExtraBig, appFont(defSize + 3, QFont::Bold)},
-        {Font::Big, appFont(defSize + 1, QFont::Normal)},
-        {Font::BigBold, appFont(defSize + 1, QFont::Bold)},
-        {Font::Medium, appFont(defSize, QFont::Normal)},
-        {Font::MediumBold, appFont(defSize, QFont::Bold)},
-        {Font::Small, appFont(defSize - 1, QFont::Normal)},
-        {Font::SmallLight, appFont(defSize - 1, QFont::Light)},
+    // Indexed by Font; resolved once, then every later call is an array load
+    static const std::array<QFont, 7> fonts = {
+        appFont(defSize + 3, QFont::Bold),    // Font::ExtraBig
+        appFont(defSize + 1, QFont::Normal),  // Font::Big
+        appFont(defSize + 1, QFont::Bold),    // Font::BigBold
+        appFont(defSize, QFont::Normal),      // Font::Medium
+        appFont(defSize, QFont::Bold),        // Font::MediumBold
+        appFont(defSize - 1, QFont::Normal),  // Font::Small
+        appFont(defSize - 1, QFont::Light),   // Font::SmallLight
     };
 
-    return fonts.at(font);
+    return fonts[static_cast<size_t>(font)];
 }
 
 const QString Style::resolve(const QString& filename, int themeColor, const QFont& baseFont)
@@ -257,7 +281,7 @@ const QString Style::resolve(const QString& filename, int themeColor, const QFon
         }
     }
 
-    if (palette.isEmpty()) {
+    if (!paletteInitialized) {
         initPalette(themeColor);
     }
 
@@ -279,45 +303,93 @@ const QString Style::resolve(const QString& filename, int themeColor, const QFon
         };
     }
 
-    for (const QString& key : dictColor.keys()) {
-        qss.replace(QRegularExpression(key % QLatin1String{"\\b"}), dictColor[key]);
-    }
+    QString resolved;
+    resolved.reserve(qss.size());
 
-    for (const QString& key : dictFont.keys()) {
-        qss.replace(QRegularExpression(key % QLatin1String{"\\b"}), dictFont[key]);
+    for (const QssToken& token : compiledTemplate(fullPath, qss)) {
+        switch (token.kind) {
+        case QssToken::Kind::Literal:
+            resolved += token.text;
+            break;
+        case QssToken::Kind::Placeholder: {
+            const auto colorIt = dictColor.constFind(token.text);
+            if (colorIt != dictColor.constEnd()) {
+                resolved += colorIt.value();
+                break;
+            }
+            const auto fontIt = dictFont.constFind(token.text);
+            if (fontIt != dictFont.constEnd()) {
+                resolved += fontIt.value();
+                break;
+            }
+            const auto themeIt = dictTheme.constFind(token.text);
+            if (themeIt != dictTheme.constEnd()) {
+                resolved += themeIt.value();
+                break;
+            }
+            // Unknown key, leave it as written just like the old regex passes did
+            resolved += token.text;
+            break;
+        }
+        case QssToken::Kind::ImagePath: {
+            QString fullImagePath = getThemeFolder(themeColor) + token.text;
+            if (!existingImagesCache.contains(fullImagePath)) {
+                if (QFileInfo::exists(fullImagePath)) {
+                    existingImagesCache << fullImagePath;
+                } else {
+                    qWarning() << "Failed to open file (using defaults):" << fullImagePath;
+                    fullImagePath = getThemePath(themeColor) % token.text;
+                }
+            }
+            resolved += fullImagePath;
+            break;
+        }
+        }
     }
 
-    for (const QString& key : dictTheme.keys()) {
-        qss.replace(QRegularExpression(key % QLatin1String{"\\b"}), dictTheme[key]);
+    return resolved;
+}
+
+/**
+ * @brief Returns the parsed template for a QSS file, tokenizing it on first use.
+ * @param fullPath Resolved path of the stylesheet, used as the cache key.
+ * @param qss Raw contents of the stylesheet.
+ */
+const std::vector<Style::QssToken>& Style::compiledTemplate(const QString& fullPath, const QString& qss)
+{
+    const auto cached = templateCache.find(fullPath);
+    if (cached != templateCache.end()) {
+        return cached->second;
     }
 
-    // "@getImagePath()" function
-    const QRegularExpression re{QStringLiteral(R"(@getImagePath\([^)\s]*\))")};
-    QRegularExpressionMatchIterator i = re.globalMatch(qss);
+    // Maximal @word runs substitute for the old per-key \b anchors: a longer
+    // identifier never matches a shorter dictionary key
+    static const QRegularExpression placeholderRe{
+        QStringLiteral(R"(@getImagePath\(([^)\s]*)\)|@[A-Za-z][A-Za-z0-9_]*)")};
 
+    std::vector<QssToken> tokens;
+    qsizetype pos = 0;
+    QRegularExpressionMatchIterator i = placeholderRe.globalMatch(qss);
     while (i.hasNext()) {
-        QRegularExpressionMatch match = i.next();
-        QString path = match.captured(0);
-        const QString phrase = path;
-
-        path.remove(QStringLiteral("@getImagePath("));
-        path.chop(1);
-
-        QString fullImagePath = getThemeFolder(themeColor) + path;
-        // image not in cache
-        if (!existingImagesCache.contains(fullPath)) {
-            if (QFileInfo::exists(fullImagePath)) {
-                existingImagesCache << fullImagePath;
-            } else {
-                qWarning() << "Failed to open file (using defaults):" << fullImagePath;
-                fullImagePath = getThemePath(themeColor) % path;
-            }
+        const QRegularExpressionMatch match = i.next();
+        if (match.capturedStart(0) > pos) {
+            tokens.push_back({QssToken::Kind::Literal,
+                              qss.mid(pos, match.capturedStart(0) - pos)});
+        }
+
+        if (match.capturedStart(1) != -1) {
+            tokens.push_back({QssToken::Kind::ImagePath, match.captured(1)});
+        } else {
+            tokens.push_back({QssToken::Kind::Placeholder, match.captured(0)});
         }
+        pos = match.capturedEnd(0);
+    }
 
-        qss.replace(phrase, fullImagePath);
+    if (pos < qss.size()) {
+        tokens.push_back({QssToken::Kind::Literal, qss.mid(pos)});
     }
 
-    return qss;
+    return templateCache.emplace(fullPath, std::move(tokens)).first->second;
 }
 
 void Style::repolish(QWidget* w)
@@ -337,7 +409,7 @@ void Style::repolish(QWidget* w)
 void Style::setThemeColor(int themeColor, int color)
 {
     stylesheetsCache.clear(); // clear stylesheet cache which includes color info
-    palette.clear();
+    palette.fill(QColor());
     dictColor.clear();
     initPalette(themeColor);
     initDictColor();
@@ -371,15 +443,15 @@ void Style::setThemeColor(const QColor& color)
 {
     if (!color.isValid()) {
         // Reset to default
-        palette[ColorPalette::ThemeDark] = getColor(ColorPalette::ThemeDark);
-        palette[ColorPalette::ThemeMediumDark] = getColor(ColorPalette::ThemeMediumDark);
-        palette[ColorPalette::ThemeMedium] = getColor(ColorPalette::ThemeMedium);
-        palette[ColorPalette::ThemeLight] = getColor(ColorPalette::ThemeLight);
+        palette[idx(ColorPalette::ThemeDark)] = getColor(ColorPalette::ThemeDark);
+        palette[idx(ColorPalette::ThemeMediumDark)] = getColor(ColorPalette::ThemeMediumDark);
+        palette[idx(ColorPalette::ThemeMedium)] = getColor(ColorPalette::ThemeMedium);
+        palette[idx(ColorPalette::ThemeLight)] = getColor(ColorPalette::ThemeLight);
     } else {
-        palette[ColorPalette::ThemeDark] = color.darker(155);
-        palette[ColorPalette::ThemeMediumDark] = color.darker(135);
-        palette[ColorPalette::ThemeMedium] = color.darker(120);
-        palette[ColorPalette::ThemeLight] = color.lighter(110);
+        palette[idx(ColorPalette::ThemeDark)] = color.darker(155);
+        palette[idx(ColorPalette::ThemeMediumDark)] = color.darker(135);
+        palette[idx(ColorPalette::ThemeMedium)] = color.darker(120);
+        palette[idx(ColorPalette::ThemeLight)] = color.lighter(110);
     }
 
     dictTheme["@themeDark"] = getColor(ColorPalette::ThemeDark).name();
@@ -393,10 +465,25 @@ void Style::setThemeColor(const QColor& color)
  *
  * For reload theme need connect signal themeReload() to function for reload
  * For example: connect(&style, &Style::themeReload, this, &SomeClass::reloadTheme);
+ *
+ * The reload is deferred to the next event loop turn so repeated calls (e.g.
+ * theme color plus font change in one settings apply) collapse into a single
+ * cascade, and pending input/paint events get serviced first.
  */
 void Style::applyTheme()
 {
-    emit themeReload();
+    if (themeReloadPending) {
+        return;
+    }
+
+    themeReloadPending = true;
+    QMetaObject::invokeMethod(
+        this,
+        [this] {
+            themeReloadPending = false;
+            emit themeReload();
+        },
+        Qt::QueuedConnection);
 }
 
 QPixmap Style::scaleSvgImage(const QString& path, uint32_t width, uint32_t height)
@@ -416,13 +503,11 @@ void Style::initPalette(int themeColor)
     auto keys = aliasColors.keys();
 
     colourSettings.beginGroup("colors");
-    QMap<ColorPalette, QString> c;
     for (auto k : keys) {
-        c[k] = colourSettings.value(aliasColors[k], "#000").toString();
-        palette[k] = QColor(colourSettings.value(aliasColors[k], "#000").toString());
+        palette[idx(k)] = QColor(colourSettings.value(aliasColors[k], "#000").toString());
     }
-    auto p = palette;
     colourSettings.endGroup();
+    paletteInitialized = true;
 }
 
 void Style::initDictColor()
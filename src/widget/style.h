@@ -10,6 +10,10 @@
 #include <QMap>
 #include <QObject>
 
+#include <array>
+#include <map>
+#include <vector>
+
 class QString;
 class QWidget;
 class Settings;
@@ -38,7 +42,7 @@ public:
         Action,
         Link,
         SearchHighlighted,
-        SelectText
+        SelectText // must stay last; used to size the resolved palette array
     };
 
     enum class Font
@@ -76,6 +80,8 @@ public:
                                 const QFont& baseFont = QFont());
     const QString getImagePath(const QString& filename, const Settings& settings);
     const QString getImagePath(const QString& filename, int themeColor);
+    void setStylesheet(QWidget* widget, const QString& filename, const Settings& settings,
+                       const QFont& baseFont = QFont());
     QColor getColor(ColorPalette entry);
     const QString resolve(const QString& filename, int themeColor, const QFont& baseFont = QFont());
     void setThemeColor(int themeColor, int color);
@@ -88,12 +94,43 @@ signals:
     void themeReload();
 
 private:
-    QMap<ColorPalette, QColor> palette;
+    /**
+     * A QSS file parsed once into literal runs and placeholders. Resolving a
+     * stylesheet against the current palette then only joins the pieces,
+     * instead of re-running a regex substitution per dictionary entry on
+     * every theme switch.
+     */
+    struct QssToken
+    {
+        enum class Kind
+        {
+            Literal,
+            Placeholder,
+            ImagePath,
+        };
+
+        Kind kind;
+        // Literal text, the @key to substitute, or the @getImagePath() argument
+        QString text;
+    };
+
+    const std::vector<QssToken>& compiledTemplate(const QString& fullPath, const QString& qss);
+
+private:
+    // Indexed by ColorPalette. getColor is hit from paint paths (e.g. text
+    // selection), so the resolved colors live in a flat array that indexes in
+    // O(1) instead of a map that has to be searched on every call.
+    std::array<QColor, static_cast<size_t>(ColorPalette::SelectText) + 1> palette;
+    bool paletteInitialized = false;
     QMap<QString, QString> dictColor;
     QMap<QString, QString> dictFont;
     QMap<QString, QString> dictTheme;
     // stylesheet filename, font -> stylesheet
     // QString implicit sharing deduplicates stylesheets rather than constructing a new one each time
     std::map<std::pair<const QString, const QFont>, const QString> stylesheetsCache;
+    // stylesheet filename -> parsed template; file contents don't change with
+    // the palette, so this survives theme switches
+    std::map<QString, std::vector<QssToken>> templateCache;
     QStringList existingImagesCache;
+    bool themeReloadPending = false;
 };
@@ -0,0 +1,100 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "connectionqualitygraph.h"
+
+#include <QPainter>
+#include <QPaintEvent>
+
+#include <algorithm>
+
+/**
+ * @class ConnectionQualityGraph
+ * @brief Plots the recorded call quality samples of one friend.
+ *
+ * Bitrates are drawn as lines scaled to the largest recorded value, and
+ * samples with dropped video frames get a tick along the bottom edge. Samples
+ * are plotted by index rather than wall clock, so calls weeks apart still
+ * fill the width instead of degenerating into two distant dots.
+ */
+
+namespace {
+constexpr int graphHeight = 120;
+constexpr int graphMargin = 4;
+} // namespace
+
+ConnectionQualityGraph::ConnectionQualityGraph(QWidget* parent)
+    : QWidget(parent)
+{
+}
+
+void ConnectionQualityGraph::setSamples(QList<ConnectionQualityLog::Sample> samples_)
+{
+    samples = std::move(samples_);
+    update();
+}
+
+QSize ConnectionQualityGraph::minimumSizeHint() const
+{
+    return QSize(200, graphHeight);
+}
+
+void ConnectionQualityGraph::paintEvent(QPaintEvent* event)
+{
+    std::ignore = event;
+
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+
+    if (samples.size() < 2) {
+        painter.setPen(palette().color(QPalette::PlaceholderText));
+        painter.drawText(rect(), Qt::AlignCenter, tr("No call quality data recorded yet"));
+        return;
+    }
+
+    quint32 maxBitrate = 1;
+    for (const ConnectionQualityLog::Sample& sample : samples) {
+        maxBitrate = std::max({maxBitrate, sample.audioBitrate, sample.videoBitrate});
+    }
+
+    const QRectF plot = QRectF(rect()).adjusted(graphMargin, graphMargin, -graphMargin, -graphMargin);
+    const qreal xStep = plot.width() / (samples.size() - 1);
+    const auto yFor = [&plot, maxBitrate](quint32 bitrate) {
+        return plot.bottom() - plot.height() * bitrate / maxBitrate;
+    };
+
+    QPolygonF audioLine;
+    QPolygonF videoLine;
+    audioLine.reserve(samples.size());
+    videoLine.reserve(samples.size());
+    for (int i = 0; i < samples.size(); ++i) {
+        const qreal x = plot.left() + i * xStep;
+        audioLine << QPointF(x, yFor(samples[i].audioBitrate));
+        videoLine << QPointF(x, yFor(samples[i].videoBitrate));
+    }
+
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    QPen videoPen(palette().color(QPalette::Highlight), 1.5);
+    painter.setPen(videoPen);
+    painter.drawPolyline(videoLine);
+
+    QPen audioPen(palette().color(QPalette::Text), 1.0, Qt::DashLine);
+    painter.setPen(audioPen);
+    painter.drawPolyline(audioLine);
+
+    // dropped-frame ticks along the bottom edge
+    QPen dropPen(QColor(Qt::red), 2.0);
+    painter.setPen(dropPen);
+    for (int i = 0; i < samples.size(); ++i) {
+        if (samples[i].droppedFrames > 0) {
+            const qreal x = plot.left() + i * xStep;
+            painter.drawLine(QPointF(x, plot.bottom() - 4), QPointF(x, plot.bottom()));
+        }
+    }
+
+    painter.setPen(palette().color(QPalette::PlaceholderText));
+    painter.drawText(plot, Qt::AlignTop | Qt::AlignRight,
+                     tr("%1 kbit/s peak").arg(maxBitrate));
+}
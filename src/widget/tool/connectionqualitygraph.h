@@ -0,0 +1,27 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include "src/persistence/connectionqualitylog.h"
+
+#include <QList>
+#include <QWidget>
+
+class ConnectionQualityGraph : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit ConnectionQualityGraph(QWidget* parent = nullptr);
+
+    void setSamples(QList<ConnectionQualityLog::Sample> samples_);
+
+    QSize minimumSizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    QList<ConnectionQualityLog::Sample> samples;
+};
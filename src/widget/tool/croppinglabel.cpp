@@ -4,6 +4,7 @@
  */
 
 #include "croppinglabel.h"
+#include <QEvent>
 #include <QKeyEvent>
 #include <QLineEdit>
 #include <QRegularExpression>
@@ -64,6 +65,7 @@ void CroppingLabel::setEditable(bool editable_)
 void CroppingLabel::setElideMode(Qt::TextElideMode elide)
 {
     elideMode = elide;
+    invalidateElideCache();
 }
 
 void CroppingLabel::setText(const QString& text)
@@ -75,6 +77,8 @@ void CroppingLabel::setText(const QString& text)
 void CroppingLabel::setPlaceholderText(const QString& text)
 {
     textEdit->setPlaceholderText(text);
+    // the placeholder shows whenever the elided text comes out empty
+    invalidateElideCache();
     setElidedText();
 }
 
@@ -115,8 +119,33 @@ void CroppingLabel::paintEvent(QPaintEvent* paintEvent)
     QLabel::paintEvent(paintEvent);
 }
 
+void CroppingLabel::changeEvent(QEvent* event)
+{
+    // Font changes come in through the style system without a resize, so
+    // they have to re-elide here or the stale metrics stick until the next
+    // layout pass
+    if (event->type() == QEvent::FontChange) {
+        setElidedText();
+    }
+
+    QLabel::changeEvent(event);
+}
+
 void CroppingLabel::setElidedText()
 {
+    // Text elision lays the string out from scratch, and the friend list has
+    // two of these labels per row; layout churn during scrolling delivers
+    // batches of resize events where neither the text, the width nor the
+    // font changed, so skip both the elision and the QLabel::setText()
+    // relayout when the inputs of the last run still hold
+    if (width() == lastElideWidth && origText == lastElideSource && font() == lastElideFont) {
+        return;
+    }
+
+    lastElideWidth = width();
+    lastElideSource = origText;
+    lastElideFont = font();
+
     QString elidedText = fontMetrics().elidedText(origText, elideMode, width());
     if (elidedText != origText)
         setToolTip(Qt::convertFromPlainText(origText, Qt::WhiteSpaceNormal));
@@ -161,6 +190,11 @@ void CroppingLabel::minimizeMaximumWidth()
     setMaximumWidth(fontMetrics().horizontalAdvance(origText) + fontMetrics().horizontalAdvance("..."));
 }
 
+void CroppingLabel::invalidateElideCache()
+{
+    lastElideWidth = -1;
+}
+
 void CroppingLabel::editingFinished()
 {
     hideTextEdit();
@@ -34,6 +34,7 @@ signals:
 
 protected:
     void paintEvent(QPaintEvent* paintEvent) override;
+    void changeEvent(QEvent* event) override;
     void setElidedText();
     void hideTextEdit();
     void showTextEdit();
@@ -45,10 +46,19 @@ protected:
 private slots:
     void editingFinished();
 
+private:
+    void invalidateElideCache();
+
 private:
     QString origText;
     QLineEdit* textEdit;
     bool blockPaintEvents;
     bool editable;
     Qt::TextElideMode elideMode;
+    // Inputs of the last elision, so setElidedText() can skip the text layout
+    // and the QLabel::setText() relayout when nothing changed; a width of -1
+    // marks the memo invalid
+    QString lastElideSource;
+    QFont lastElideFont;
+    int lastElideWidth = -1;
 };
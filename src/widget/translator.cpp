@@ -20,42 +20,80 @@ QVector<Translator::Callback> Translator::callbacks;
 QMutex Translator::lock;
 
 /**
- * @brief Loads the translations according to the settings or locale.
+ * @brief Loads the translation files for a locale without installing them.
+ *
+ * Thread-safe: the .qm lookup and parse - the expensive part, Qt maps the
+ * file data and keeps it - can run off the GUI thread, overlapped with other
+ * startup work. Install the result with apply() on the GUI thread.
  */
-void Translator::translate(const QString& localeName)
+Translator::Preload Translator::load(const QString& localeName)
 {
-    QMutexLocker<QMutex> locker{&lock};
-
-    if (!core_translator)
-        core_translator = new QTranslator();
+    Preload result;
 
-    if (!app_translator)
-        app_translator = new QTranslator();
-
-    // Remove old translations
-    QCoreApplication::removeTranslator(core_translator);
-    QApplication::removeTranslator(app_translator);
+    const QString locale =
+        localeName.isEmpty() ? QLocale::system().name().section('_', 0, 0) : localeName;
 
-    // Load translations
-    QString locale = localeName.isEmpty() ? QLocale::system().name().section('_', 0, 0) : localeName;
-
-    if (core_translator->load(locale, ":translations/")) {
+    auto* core = new QTranslator();
+    if (core->load(locale, ":translations/")) {
         qDebug() << "Loaded translation" << locale;
+        result.core = core;
 
         // System menu translation
-        QString s_locale = "qt_" + locale;
-        QString location = QLibraryInfo::path(QLibraryInfo::TranslationsPath);
-        if (app_translator->load(s_locale, location)) {
-            QApplication::installTranslator(app_translator);
+        auto* app = new QTranslator();
+        const QString location = QLibraryInfo::path(QLibraryInfo::TranslationsPath);
+        if (app->load("qt_" + locale, location)) {
             qDebug() << "System translation loaded" << locale;
+            result.app = app;
         } else {
             qDebug() << "System translation not loaded" << locale;
+            delete app;
         }
-
-        // Application translation
-        QCoreApplication::installTranslator(core_translator);
     } else {
         qDebug() << "Error loading translation" << locale;
+        delete core;
+    }
+
+    // Installation and deletion happen on the GUI thread
+    const auto guiThread = QCoreApplication::instance()->thread();
+    if (result.core != nullptr) {
+        result.core->moveToThread(guiThread);
+    }
+    if (result.app != nullptr) {
+        result.app->moveToThread(guiThread);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Installs preloaded translations, replacing the current ones.
+ *
+ * Must run on the GUI thread; takes ownership of the preloaded translators.
+ */
+void Translator::apply(const Preload& preloaded)
+{
+    QMutexLocker<QMutex> locker{&lock};
+
+    // Remove old translations
+    if (core_translator != nullptr) {
+        QCoreApplication::removeTranslator(core_translator);
+        core_translator->deleteLater();
+    }
+    if (app_translator != nullptr) {
+        QApplication::removeTranslator(app_translator);
+        app_translator->deleteLater();
+    }
+
+    core_translator = preloaded.core;
+    app_translator = preloaded.app;
+
+    if (app_translator != nullptr) {
+        QApplication::installTranslator(app_translator);
+    }
+
+    // Application translation
+    if (core_translator != nullptr) {
+        QCoreApplication::installTranslator(core_translator);
     }
 
     // After the language is changed from RTL to LTR, the layout direction isn't
@@ -71,6 +109,14 @@ void Translator::translate(const QString& localeName)
         pair.second();
 }
 
+/**
+ * @brief Loads and installs the translations according to the settings or locale.
+ */
+void Translator::translate(const QString& localeName)
+{
+    apply(load(localeName));
+}
+
 /**
  * @brief Register a function to be called when the UI needs to be retranslated.
  * @param f Function, which will called.
@@ -16,6 +16,14 @@ class QTranslator;
 class Translator
 {
 public:
+    struct Preload
+    {
+        QTranslator* core = nullptr;
+        QTranslator* app = nullptr;
+    };
+
+    static Preload load(const QString& localeName);
+    static void apply(const Preload& preloaded);
     static void translate(const QString& localeName);
     static void registerHandler(const std::function<void()>& f, void* owner);
     static void unregister(void* owner);
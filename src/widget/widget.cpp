@@ -6,11 +6,13 @@
 #include "widget.h"
 
 #include <cassert>
+#include <utility>
 
 #include <QActionGroup>
 #include <QClipboard>
 #include <QDebug>
 #include <QDesktopServices>
+#include <QDir>
 #include <QMessageBox>
 #include <QMouseEvent>
 #include <QPainter>
@@ -28,6 +30,7 @@
 #include "conferencewidget.h"
 #include "contentdialog.h"
 #include "contentlayout.h"
+#include "framegovernor.h"
 #include "friendlistwidget.h"
 #include "friendwidget.h"
 #include "maskablepixmapwidget.h"
@@ -52,6 +55,7 @@
 #include "src/model/status.h"
 #include "src/net/updatecheck.h"
 #include "src/nexus.h"
+#include "src/persistence/conferencestatecache.h"
 #include "src/persistence/offlinemsgengine.h"
 #include "src/persistence/profile.h"
 #include "src/persistence/settings.h"
@@ -64,6 +68,7 @@
 #include "src/widget/form/conferenceinviteform.h"
 #include "src/widget/form/filesform.h"
 #include "src/widget/form/profileform.h"
+#include "src/widget/form/searchresultsdialog.h"
 #include "src/widget/form/settingswidget.h"
 #include "src/widget/style.h"
 #include "src/widget/tool/messageboxmanager.h"
@@ -258,6 +263,22 @@ void Widget::init()
 
     core = &profile.getCore();
 
+    // Load the last-known conference state before any conference is created,
+    // so restored windows open with the peers they had before the restart
+    conferenceStateCache = std::make_unique<ConferenceStateCache>(
+        QDir(settings.getPaths().getSettingsDirPath()).filePath(profile.getName() + ".conferences"),
+        profile.getPasskey());
+    conferenceStateCache->load();
+
+    // An incoming call must ring even if the chat form was never created or
+    // was reclaimed; build it on demand and hand it the invite it missed
+    connect(core->getAv(), &CoreAV::avInvite, this, [this](uint32_t friendNumber, bool video) {
+        const auto& friendPk = friendList->id2Key(friendNumber);
+        if (!chatForms.contains(friendPk)) {
+            getOrCreateChatForm(friendPk)->onAvInvite(friendNumber, video);
+        }
+    });
+
     sharedMessageProcessorParams.reset(new MessageProcessor::SharedParams(core->getMaxMessageSize()));
 
     chatListWidget =
@@ -290,7 +311,8 @@ void Widget::init()
     const QString getImagePath(const QString& filename, const Settings& settings);
 
     CoreFile* coreFile = core->getCoreFile();
-    filesForm = new FilesForm(*coreFile, settings, style, *messageBoxManager, *friendList);
+    filesForm = new FilesForm(*coreFile, settings, style, *messageBoxManager, *friendList,
+                              profile.getHistory());
     addFriendForm = new AddFriendForm(core->getSelfId(), settings, style, *messageBoxManager, *core);
     conferenceInviteForm = new ConferenceInviteForm(settings, *core);
 
@@ -300,7 +322,7 @@ void Widget::init()
                                         settings, style, *messageBoxManager, profile, this);
     updateCheck->checkForUpdate();
 
-    debugWidget = new DebugWidget(settings.getPaths(), style, this);
+    debugWidget = new DebugWidget(settings.getPaths(), style, core->getMetrics(), this);
 
     profileInfo = new ProfileInfo(core, &profile, settings, nexus);
     profileForm = new ProfileForm(profileInfo, settings, style, *messageBoxManager);
@@ -328,6 +350,7 @@ void Widget::init()
     connect(timer, &QTimer::timeout, this, &Widget::onUserAwayCheck);
     connect(timer, &QTimer::timeout, this, &Widget::onEventIconTick);
     connect(timer, &QTimer::timeout, this, &Widget::onTryCreateTrayIcon);
+    connect(timer, &QTimer::timeout, this, &Widget::reclaimInactiveChatForms);
     connect(ui->searchContactText, &QLineEdit::textChanged, this, &Widget::searchChats);
     connect(filterGroup, &QActionGroup::triggered, this, &Widget::searchChats);
     connect(filterDisplayGroup, &QActionGroup::triggered, this, &Widget::changeDisplayMode);
@@ -623,11 +646,15 @@ Widget::~Widget()
         icon->hide();
     }
 
-    for (Conference* c : conferenceList->getAllConferences()) {
+    // removeConference() mutates the list, so iterate over a copy
+    const QList<Conference*> conferences = conferenceList->getAllConferences();
+    for (Conference* c : conferences) {
         removeConference(c, true);
     }
 
-    for (Friend* f : friendList->getAllFriends()) {
+    // removeFriend() mutates the roster, so iterate over a copy
+    const QList<Friend*> friends = friendList->getAllFriends();
+    for (Friend* f : friends) {
         removeFriend(f, true);
     }
 
@@ -690,12 +717,28 @@ void Widget::closeEvent(QCloseEvent* event)
 void Widget::changeEvent(QEvent* event)
 {
     if (event->type() == QEvent::WindowStateChange) {
+        // Minimizing doesn't produce a hide event, but per-frame work should
+        // idle all the same
+        FrameGovernor::getInstance().setWindowVisible(this, isVisible() && !isMinimized());
+
         if (isMinimized() && settings.getShowSystemTray() && settings.getMinimizeToTray()) {
             hide();
         }
     }
 }
 
+void Widget::showEvent(QShowEvent* event)
+{
+    FrameGovernor::getInstance().setWindowVisible(this, !isMinimized());
+    QMainWindow::showEvent(event);
+}
+
+void Widget::hideEvent(QHideEvent* event)
+{
+    FrameGovernor::getInstance().setWindowVisible(this, false);
+    QMainWindow::hideEvent(event);
+}
+
 void Widget::resizeEvent(QResizeEvent* event)
 {
     saveWindowGeometry();
@@ -723,20 +766,19 @@ void Widget::onCoreChanged(Core& core_)
     connect(core, &Core::friendAdded, this, &Widget::addFriend);
     connect(core, &Core::failedToAddFriend, this, &Widget::addFriendFailed);
     connect(core, &Core::friendUsernameChanged, this, &Widget::onFriendUsernameChanged);
-    connect(core, &Core::friendStatusChanged, this, &Widget::onCoreFriendStatusChanged);
+    connect(core, &Core::friendStatusesChanged, this, &Widget::onCoreFriendStatusesChanged);
     connect(core, &Core::friendStatusMessageChanged, this, &Widget::onFriendStatusMessageChanged);
     connect(core, &Core::friendRequestReceived, this, &Widget::onFriendRequestReceived);
     connect(core, &Core::friendMessageReceived, this, &Widget::onFriendMessageReceived);
-    connect(core, &Core::receiptReceived, this, &Widget::onReceiptReceived);
+    connect(core, &Core::receiptsReceived, this, &Widget::onReceiptsReceived);
     connect(core, &Core::conferenceInviteReceived, this, &Widget::onConferenceInviteReceived);
     connect(core, &Core::conferenceMessageReceived, this, &Widget::onConferenceMessageReceived);
     connect(core, &Core::conferencePeerlistChanged, this, &Widget::onConferencePeerlistChanged);
     connect(core, &Core::conferencePeerNameChanged, this, &Widget::onConferencePeerNameChanged);
     connect(core, &Core::conferenceTitleChanged, this, &Widget::onConferenceTitleChanged);
-    connect(core, &Core::conferencePeerAudioPlaying, this, &Widget::onConferencePeerAudioPlaying);
     connect(core, &Core::emptyConferenceCreated, this, &Widget::onEmptyConferenceCreated);
     connect(core, &Core::conferenceJoined, this, &Widget::onConferenceJoined);
-    connect(core, &Core::friendTypingChanged, this, &Widget::onFriendTypingChanged);
+    connect(core, &Core::friendTypingStatesChanged, this, &Widget::onFriendTypingStatesChanged);
     connect(core, &Core::conferenceSentFailed, this, &Widget::onConferenceSendFailed);
     connect(core, &Core::usernameSet, this, &Widget::refreshPeerListsLocal);
 
@@ -1101,10 +1143,20 @@ void Widget::onStopNotification()
     audioNotification.reset();
 }
 
+/**
+ * @brief Opens the cross-chat search results panel for a phrase.
+ */
+void Widget::onSearchAllRequested(const QString& phrase)
+{
+    auto* dialog =
+        new SearchResultsDialog(profile.getHistory(), phrase, *friendList, *conferenceList, this);
+    dialog->show();
+}
+
 /**
  * @brief Dispatches file to the appropriate chat log and accepts the transfer if necessary
  */
-void Widget::dispatchFile(ToxFile file)
+void Widget::dispatchFile(const ToxFile& file)
 {
     const auto& friendId = friendList->id2Key(file.friendId);
     Friend* f = friendList->findFriend(friendId);
@@ -1138,7 +1190,7 @@ void Widget::dispatchFile(ToxFile file)
     filesForm->onFileUpdated(file);
 }
 
-void Widget::dispatchFileWithBool(ToxFile file, bool pausedOrBroken)
+void Widget::dispatchFileWithBool(const ToxFile& file, bool pausedOrBroken)
 {
     std::ignore = pausedOrBroken;
     dispatchFile(file);
@@ -1148,13 +1200,17 @@ void Widget::dispatchFileSendFailed(uint32_t friendId, const QString& fileName)
 {
     const auto& friendPk = friendList->id2Key(friendId);
 
-    auto chatForm = chatForms.find(friendPk);
-    if (chatForm == chatForms.end()) {
+    auto chatLog = friendChatLogs.find(friendPk);
+    if (chatLog == friendChatLogs.end()) {
         return;
     }
 
-    chatForm.value()->addSystemInfoMessage(QDateTime::currentDateTime(),
-                                           SystemMessageType::fileSendFailed, {fileName});
+    // Straight into the chat log; the chat form may not have been created yet
+    SystemMessage systemMessage;
+    systemMessage.messageType = SystemMessageType::fileSendFailed;
+    systemMessage.timestamp = QDateTime::currentDateTime();
+    systemMessage.args = {fileName};
+    chatLog.value()->addSystemMessage(systemMessage);
 }
 
 void Widget::onRejectCall(uint32_t friendId)
@@ -1186,23 +1242,21 @@ void Widget::addFriend(uint32_t friendId, const ToxPk& friendPk)
     auto chatHistory =
         std::make_shared<ChatHistory>(*newFriend, history, *core, settings,
                                       *friendMessageDispatcher, *friendList, *conferenceList);
-    auto friendForm =
-        new ChatForm(profile, newFriend, *chatHistory, *friendMessageDispatcher, *documentCache,
-                     *smileyPack, cameraSource, settings, style, *messageBoxManager,
-                     *contentDialogManager, *friendList, *conferenceList, this);
-    connect(friendForm, &ChatForm::updateFriendActivity, this, &Widget::updateFriendActivity);
 
+    // The ChatForm itself is built lazily by getOrCreateChatForm on first
+    // activation, so an idle roster entry only costs its history and widget
     friendMessageDispatchers[friendPk] = friendMessageDispatcher;
     friendChatLogs[friendPk] = chatHistory;
     friendChatRooms[friendPk] = chatroom;
     friendWidgets[friendPk] = widget;
-    chatForms[friendPk] = friendForm;
 
     const auto activityTime = settings.getFriendActivity(friendPk);
-    const auto chatTime = friendForm->getLatestTime();
+    const auto chatTime = GenericChatForm::getLatestTime(*chatHistory);
     if (chatTime > activityTime && chatTime.isValid()) {
         settings.setFriendActivity(friendPk, chatTime);
     }
+    // Seed the in-memory copy that the roster's activity sort reads
+    newFriend->setLastActivity(qMax(activityTime, chatTime));
 
     chatListWidget->addFriendWidget(widget);
 
@@ -1218,29 +1272,111 @@ void Widget::addFriend(uint32_t friendId, const ToxPk& friendPk)
     connect(newFriend, &Friend::displayedNameChanged, this, &Widget::onFriendDisplayedNameChanged);
     connect(newFriend, &Friend::statusChanged, this, &Widget::onFriendStatusChanged);
 
+    connect(widget, &FriendWidget::newWindowOpened, this, &Widget::openNewDialog);
+    connect(widget, &FriendWidget::chatroomWidgetClicked, this, &Widget::onChatroomWidgetClicked);
+    connect(widget, &FriendWidget::copyFriendIdToClipboard, this, &Widget::copyFriendIdToClipboard);
+    connect(widget, &FriendWidget::contextMenuCalled, widget, &FriendWidget::onContextMenuCalled);
+    connect(widget, &FriendWidget::removeFriend, this, qOverload<const ToxPk&>(&Widget::removeFriend));
+
+    connect(&profile, &Profile::friendAvatarSet, widget, &FriendWidget::onAvatarSet);
+    connect(&profile, &Profile::friendAvatarRemoved, widget, &FriendWidget::onAvatarRemoved);
+
+    // Loading the avatar hits the disk or renders an identicon, and doing
+    // that for the whole roster before first paint is what made startup feel
+    // slow. Queue the load and flush once per event loop pass: the list
+    // paints with placeholders right away, the whole batch then decodes in
+    // parallel on the worker pool, and the repaints land together.
+    if (pendingAvatarLoads.isEmpty()) {
+        QTimer::singleShot(0, this, &Widget::flushPendingAvatarLoads);
+    }
+    pendingAvatarLoads.append(friendPk);
+}
+
+void Widget::flushPendingAvatarLoads()
+{
+    const QList<ToxPk> batch = std::exchange(pendingAvatarLoads, {});
+    profile.preloadAvatars(batch);
+
+    for (const ToxPk& friendPk : batch) {
+        FriendWidget* friendWidget = friendWidgets.value(friendPk);
+        if (friendWidget == nullptr) {
+            // Removed before we got around to it
+            continue;
+        }
+        const QPixmap avatar = profile.loadAvatar(friendPk);
+        if (!avatar.isNull()) {
+            friendWidget->onAvatarSet(friendPk, avatar);
+        }
+    }
+}
+
+ChatForm* Widget::getOrCreateChatForm(const ToxPk& friendPk)
+{
+    chatFormLastActivated[friendPk] = QDateTime::currentDateTime();
+
+    const auto existing = chatForms.find(friendPk);
+    if (existing != chatForms.end()) {
+        return existing.value();
+    }
+
+    Friend* frnd = friendList->findFriend(friendPk);
+    assert(frnd != nullptr);
+    auto friendMessageDispatcher = friendMessageDispatchers[friendPk];
+    auto chatHistory = friendChatLogs[friendPk];
+    auto friendForm =
+        new ChatForm(profile, frnd, *chatHistory, *friendMessageDispatcher, *documentCache,
+                     *smileyPack, cameraSource, settings, style, *messageBoxManager,
+                     *contentDialogManager, *friendList, *conferenceList, this);
+
+    connect(friendForm, &ChatForm::updateFriendActivity, this, &Widget::updateFriendActivity);
     connect(friendForm, &ChatForm::incomingNotification, this, &Widget::incomingNotification);
     connect(friendForm, &ChatForm::outgoingNotification, this, &Widget::outgoingNotification);
     connect(friendForm, &ChatForm::stopNotification, this, &Widget::onStopNotification);
     connect(friendForm, &ChatForm::endCallNotification, this, &Widget::onCallEnd);
     connect(friendForm, &ChatForm::rejectCall, this, &Widget::onRejectCall);
+    connect(friendForm, &GenericChatForm::searchAllRequested, this, &Widget::onSearchAllRequested);
 
-    connect(widget, &FriendWidget::newWindowOpened, this, &Widget::openNewDialog);
-    connect(widget, &FriendWidget::chatroomWidgetClicked, this, &Widget::onChatroomWidgetClicked);
+    FriendWidget* widget = friendWidgets[friendPk];
     connect(widget, &FriendWidget::chatroomWidgetClicked, friendForm, &GenericChatForm::focusInput);
     connect(widget, &FriendWidget::friendHistoryRemoved, friendForm,
             qOverload<>(&GenericChatForm::clearChatArea));
-    connect(widget, &FriendWidget::copyFriendIdToClipboard, this, &Widget::copyFriendIdToClipboard);
-    connect(widget, &FriendWidget::contextMenuCalled, widget, &FriendWidget::onContextMenuCalled);
-    connect(widget, &FriendWidget::removeFriend, this, qOverload<const ToxPk&>(&Widget::removeFriend));
 
-    connect(&profile, &Profile::friendAvatarSet, widget, &FriendWidget::onAvatarSet);
-    connect(&profile, &Profile::friendAvatarRemoved, widget, &FriendWidget::onAvatarRemoved);
-
-    // Try to get the avatar from the cache
     QPixmap avatar = profile.loadAvatar(friendPk);
     if (!avatar.isNull()) {
         friendForm->onAvatarChanged(friendPk, avatar);
-        widget->onAvatarSet(friendPk, avatar);
+    }
+
+    chatForms[friendPk] = friendForm;
+    return friendForm;
+}
+
+void Widget::reclaimInactiveChatForms()
+{
+    // Tear down chat scenes that haven't been looked at in a while; the
+    // conversation itself lives in friendChatLogs and is re-rendered by
+    // getOrCreateChatForm on the next activation
+    constexpr int reclaimAfterSecs = 10 * 60;
+    const auto now = QDateTime::currentDateTime();
+
+    for (auto it = chatForms.begin(); it != chatForms.end();) {
+        const auto& friendPk = it.key();
+        ChatForm* form = it.value();
+
+        const Friend* frnd = friendList->findFriend(friendPk);
+        const bool inDialog =
+            frnd != nullptr && contentDialogManager->chatWidgetExists(frnd->getPersistentId());
+        const bool inCall = frnd != nullptr && core != nullptr && core->getAv() != nullptr
+                            && core->getAv()->isCallStarted(frnd);
+        const auto lastActivated = chatFormLastActivated.value(friendPk);
+        if (form->isVisible() || inDialog || inCall
+            || lastActivated.secsTo(now) < reclaimAfterSecs) {
+            ++it;
+            continue;
+        }
+
+        qDebug() << "Reclaiming inactive chat form of" << friendPk.toString();
+        it = chatForms.erase(it);
+        delete form;
     }
 }
 
@@ -1269,6 +1405,13 @@ void Widget::onCoreFriendStatusChanged(uint32_t friendId, Status::Status status)
     // transformations done by the Friend class
 }
 
+void Widget::onCoreFriendStatusesChanged(const QHash<uint32_t, Status::Status>& statuses)
+{
+    for (auto it = statuses.cbegin(); it != statuses.cend(); ++it) {
+        onCoreFriendStatusChanged(it.key(), it.value());
+    }
+}
+
 void Widget::onFriendStatusChanged(const ToxPk& friendPk, Status::Status status)
 {
     FriendWidget* widget = friendWidgets[friendPk];
@@ -1300,7 +1443,9 @@ void Widget::onFriendStatusMessageChanged(uint32_t friendId, const QString& mess
     f->setStatusMessage(str);
 
     friendWidgets[friendPk]->setStatusMsg(str);
-    chatForms[friendPk]->setStatusMessage(str);
+    if (auto* chatForm = chatForms.value(friendPk)) {
+        chatForm->setStatusMessage(str);
+    }
 }
 
 void Widget::onFriendDisplayedNameChanged(const QString& displayed)
@@ -1360,7 +1505,7 @@ void Widget::openDialog(GenericChatroomWidget* widget, bool newWindow)
     const Conference* conference = widget->getConference();
     bool chatFormIsSet;
     if (frnd) {
-        form = chatForms[frnd->getPublicKey()];
+        form = getOrCreateChatForm(frnd->getPublicKey());
         contentDialogManager->focusChat(frnd->getPersistentId());
         chatFormIsSet = contentDialogManager->chatWidgetExists(frnd->getPersistentId());
     } else {
@@ -1397,7 +1542,7 @@ void Widget::openDialog(GenericChatroomWidget* widget, bool newWindow)
     } else {
         hideMainForms(widget);
         if (frnd) {
-            chatForms[frnd->getPublicKey()]->show(contentLayout);
+            getOrCreateChatForm(frnd->getPublicKey())->show(contentLayout);
         } else {
             conferenceForms[conference->getPersistentId()]->show(contentLayout);
         }
@@ -1417,15 +1562,20 @@ void Widget::onFriendMessageReceived(uint32_t friendNumber, const QString& messa
     friendMessageDispatchers[f->getPublicKey()]->onMessageReceived(isAction, message);
 }
 
-void Widget::onReceiptReceived(uint32_t friendId, ReceiptNum receipt)
+void Widget::onReceiptsReceived(const QHash<uint32_t, QList<ReceiptNum>>& receipts)
 {
-    const auto& friendKey = friendList->id2Key(friendId);
-    Friend* f = friendList->findFriend(friendKey);
-    if (!f) {
-        return;
-    }
+    for (auto it = receipts.cbegin(); it != receipts.cend(); ++it) {
+        const auto& friendKey = friendList->id2Key(it.key());
+        Friend* f = friendList->findFriend(friendKey);
+        if (!f) {
+            continue;
+        }
 
-    friendMessageDispatchers[f->getPublicKey()]->onReceiptReceived(receipt);
+        const auto& dispatcher = friendMessageDispatchers[f->getPublicKey()];
+        for (const ReceiptNum receipt : it.value()) {
+            dispatcher->onReceiptReceived(receipt);
+        }
+    }
 }
 
 void Widget::addFriendDialog(const Friend* frnd, ContentDialog* dialog)
@@ -1439,7 +1589,7 @@ void Widget::addFriendDialog(const Friend* frnd, ContentDialog* dialog)
         onAddClicked();
     }
 
-    auto form = chatForms[friendPk];
+    auto form = getOrCreateChatForm(friendPk);
     auto chatroom = friendChatRooms[friendPk];
     FriendWidget* friendWidget = contentDialogManager->addFriendToDialog(dialog, chatroom, form);
 
@@ -1700,9 +1850,12 @@ void Widget::onFileReceiveRequested(const ToxFile& file)
 void Widget::updateFriendActivity(const Friend& frnd)
 {
     const ToxPk& pk = frnd.getPublicKey();
-    const auto oldTime = settings.getFriendActivity(pk);
+    const auto oldTime = frnd.getLastActivity();
     const auto newTime = QDateTime::currentDateTime();
     settings.setFriendActivity(pk, newTime);
+    if (Friend* indexed = friendList->findFriend(pk)) {
+        indexed->setLastActivity(newTime);
+    }
     FriendWidget* widget = friendWidgets[frnd.getPublicKey()];
     chatListWidget->moveWidget(widget, frnd.getStatus());
     chatListWidget->updateActivityTime(oldTime); // update old category widget
@@ -1754,8 +1907,9 @@ void Widget::removeFriend(Friend* f, bool fake)
 
     friendWidgets.remove(friendPk);
 
-    auto chatForm = chatForms[friendPk];
+    auto chatForm = chatForms.value(friendPk);
     chatForms.remove(friendPk);
+    chatFormLastActivated.remove(friendPk);
     delete chatForm;
 
     delete f;
@@ -1983,7 +2137,7 @@ void Widget::onConferencePeerlistChanged(uint32_t conferencenumber)
     const ConferenceId& conferenceId = conferenceList->id2Key(conferencenumber);
     Conference* c = conferenceList->findConference(conferenceId);
     assert(c);
-    c->regeneratePeerList();
+    c->schedulePeerListRegeneration();
 }
 
 void Widget::onConferencePeerNameChanged(uint32_t conferencenumber, const ToxPk& peerPk,
@@ -2020,15 +2174,6 @@ void Widget::titleChangedByUser(const QString& title)
     emit changeConferenceTitle(conference->getId(), title);
 }
 
-void Widget::onConferencePeerAudioPlaying(uint32_t conferencenumber, ToxPk peerPk)
-{
-    const ConferenceId& conferenceId = conferenceList->id2Key(conferencenumber);
-    assert(conferenceList->findConference(conferenceId));
-
-    auto form = conferenceForms[conferenceId].data();
-    form->peerAudioPlaying(peerPk);
-}
-
 void Widget::removeConference(Conference* c, bool fake)
 {
     assert(c);
@@ -2068,6 +2213,7 @@ void Widget::removeConference(Conference* c, bool fake)
 
     if (!fake) {
         core->removeConference(conferencenumber);
+        conferenceStateCache->remove(conferenceId);
     }
     chatListWidget->removeConferenceWidget(widget); // deletes widget
 
@@ -2116,6 +2262,17 @@ Conference* Widget::createConference(uint32_t conferencenumber, const Conference
             av->invalidateConferenceCallPeerSource(*newConference, user);
         });
     }
+
+    // Restore the last-known state before any UI is built on top of the
+    // conference, so restored windows are usable while toxcore still syncs
+    const auto cachedState = conferenceStateCache->get(conferenceId);
+    if (!cachedState.title.isEmpty()) {
+        newConference->setTitle(QString(), cachedState.title);
+    }
+    if (!cachedState.peers.isEmpty()) {
+        newConference->seedCachedPeers(cachedState.peers);
+    }
+
     auto rawChatroom =
         new ConferenceRoom(newConference, contentDialogManager.get(), *core, *friendList);
     std::shared_ptr<ConferenceRoom> chatroom(rawChatroom);
@@ -2150,6 +2307,7 @@ Conference* Widget::createConference(uint32_t conferencenumber, const Conference
                                    *documentCache, *smileyPack, style, *messageBoxManager,
                                    *friendList, *conferenceList);
     connect(&settings, &Settings::nameColorsChanged, form, &GenericChatForm::setColorizedNames);
+    connect(form, &GenericChatForm::searchAllRequested, this, &Widget::onSearchAllRequested);
     form->setColorizedNames(settings.getEnableConferencesColor());
     conferenceMessageDispatchers[conferenceId] = messageDispatcher;
     conferenceLogs[conferenceId] = chatHistory;
@@ -2171,6 +2329,15 @@ Conference* Widget::createConference(uint32_t conferencenumber, const Conference
     connect(newConference, &Conference::titleChangedByUser, this, &Widget::titleChangedByUser);
     connect(core, &Core::usernameSet, newConference, &Conference::setSelfName);
 
+    const auto updateStateCache = [this, conferenceId, newConference] {
+        conferenceStateCache->update(conferenceId, newConference->getName(),
+                                     newConference->getPeerList());
+    };
+    connect(newConference, &Conference::userJoined, this, updateStateCache);
+    connect(newConference, &Conference::userLeft, this, updateStateCache);
+    connect(newConference, &Conference::peerNameChanged, this, updateStateCache);
+    connect(newConference, &Conference::titleChanged, this, updateStateCache);
+
     return newConference;
 }
 
@@ -2186,7 +2353,9 @@ void Widget::onEmptyConferenceCreated(uint32_t conferencenumber, const Conferenc
         if (conferencesVisible()) {
             conferenceWidgets[conferenceId]->editName();
         }
-    } else {
+    } else if (conferenceStateCache->get(conferenceId).title.isEmpty()) {
+        // A cached title survives the placeholder name this is called with at
+        // startup; the real title still lands through conferenceTitleChanged
         conference->setTitle(QString(), title);
     }
 }
@@ -2362,7 +2531,16 @@ void Widget::onFriendTypingChanged(uint32_t friendNumber, bool isTyping)
         return;
     }
 
-    chatForms[f->getPublicKey()]->setFriendTyping(isTyping);
+    if (auto* chatForm = chatForms.value(f->getPublicKey())) {
+        chatForm->setFriendTyping(isTyping);
+    }
+}
+
+void Widget::onFriendTypingStatesChanged(const QHash<uint32_t, bool>& typingStates)
+{
+    for (auto it = typingStates.cbegin(); it != typingStates.cend(); ++it) {
+        onFriendTypingChanged(it.key(), it.value());
+    }
 }
 
 void Widget::onEnableDebugChanged(bool newValue)
@@ -2445,21 +2623,16 @@ void Widget::clearAllReceipts()
 
 void Widget::reloadTheme()
 {
-    setStyleSheet("");
-    QWidgetList wgts = findChildren<QWidget*>();
-    for (auto x : wgts) {
-        x->setStyleSheet("");
-    }
-
-    setStyleSheet(style.getStylesheet("window/general.qss", settings));
-    QString statusPanelStyle = style.getStylesheet("window/statusPanel.qss", settings);
-    ui->tooliconsZone->setStyleSheet(style.getStylesheet("tooliconsZone/tooliconsZone.qss", settings));
-    ui->statusPanel->setStyleSheet(statusPanelStyle);
-    ui->statusHead->setStyleSheet(statusPanelStyle);
-    ui->friendList->setStyleSheet(style.getStylesheet("friendList/friendList.qss", settings));
-    ui->statusButton->setStyleSheet(style.getStylesheet("statusButton/statusButton.qss", settings));
-
-    profilePicture->setStyleSheet(style.getStylesheet("window/profile.qss", settings));
+    // Themed children re-apply their own stylesheets via their themeReload
+    // connections; blanking every child here first just forced a second
+    // re-polish of the whole widget tree
+    style.setStylesheet(this, "window/general.qss", settings);
+    style.setStylesheet(ui->tooliconsZone, "tooliconsZone/tooliconsZone.qss", settings);
+    style.setStylesheet(ui->statusPanel, "window/statusPanel.qss", settings);
+    style.setStylesheet(ui->statusHead, "window/statusPanel.qss", settings);
+    style.setStylesheet(ui->friendList, "friendList/friendList.qss", settings);
+    style.setStylesheet(ui->statusButton, "statusButton/statusButton.qss", settings);
+    style.setStylesheet(profilePicture, "window/profile.qss", settings);
 }
 
 void Widget::nextChat()
@@ -2695,7 +2868,7 @@ void Widget::focusChatInput()
 {
     if (activeChatroomWidget) {
         if (const Friend* f = activeChatroomWidget->getFriend()) {
-            chatForms[f->getPublicKey()]->focusInput();
+            getOrCreateChatForm(f->getPublicKey())->focusInput();
         } else if (Conference* c = activeChatroomWidget->getConference()) {
             conferenceForms[c->getPersistentId()]->focusInput();
         }
@@ -8,6 +8,7 @@
 #include "ui_mainwindow.h"
 
 #include <QFileInfo>
+#include <QHash>
 #include <QMainWindow>
 #include <QPointer>
 #include <QSystemTrayIcon>
@@ -52,6 +53,7 @@ class ConferenceForm;
 class ConferenceRoom;
 class ConferenceInvite;
 class ConferenceInviteForm;
+class ConferenceStateCache;
 class ConferenceWidget;
 class MaskablePixmapWidget;
 class ProfileForm;
@@ -166,13 +168,14 @@ public slots:
     void addFriend(uint32_t friendId, const ToxPk& friendPk);
     void addFriendFailed(const ToxPk& userId, const QString& errorInfo = QString());
     void onCoreFriendStatusChanged(uint32_t friendId, Status::Status status);
+    void onCoreFriendStatusesChanged(const QHash<uint32_t, Status::Status>& statuses);
     void onFriendStatusChanged(const ToxPk& friendPk, Status::Status status);
     void onFriendStatusMessageChanged(uint32_t friendId, const QString& message);
     void onFriendDisplayedNameChanged(const QString& displayed);
     void onFriendUsernameChanged(uint32_t friendId, const QString& username);
     void onFriendAliasChanged(const ToxPk& friendId, const QString& alias);
     void onFriendMessageReceived(uint32_t friendNumber, const QString& message, bool isAction);
-    void onReceiptReceived(uint32_t friendId, ReceiptNum receipt);
+    void onReceiptsReceived(const QHash<uint32_t, QList<ReceiptNum>>& receipts);
     void onFriendRequestReceived(const ToxPk& friendPk, const QString& message);
     void onFileReceiveRequested(const ToxFile& file);
     void onEmptyConferenceCreated(uint32_t conferencenumber, const ConferenceId& conferenceId,
@@ -188,9 +191,9 @@ public slots:
     void onConferenceTitleChanged(uint32_t conferencenumber, const QString& author,
                                   const QString& title);
     void titleChangedByUser(const QString& title);
-    void onConferencePeerAudioPlaying(uint32_t conferencenumber, ToxPk peerPk);
     void onConferenceSendFailed(uint32_t conferencenumber);
     void onFriendTypingChanged(uint32_t friendNumber, bool isTyping);
+    void onFriendTypingStatesChanged(const QHash<uint32_t, bool>& typingStates);
     void nextChat();
     void previousChat();
     void onFriendDialogShown(const Friend* f);
@@ -229,6 +232,8 @@ private slots:
     void onUserAwayCheck();
     void onEventIconTick();
     void onTryCreateTrayIcon();
+    void reclaimInactiveChatForms();
+    void flushPendingAvatarLoads();
     void onEnableDebugChanged(bool newValue);
     void onSetShowSystemTray(bool newValue);
     void onSplitterMoved(int pos, int index);
@@ -242,8 +247,9 @@ private slots:
     void incomingNotification(uint32_t friendNum);
     void onRejectCall(uint32_t friendId);
     void onStopNotification();
-    void dispatchFile(ToxFile file);
-    void dispatchFileWithBool(ToxFile file, bool pausedOrBroken);
+    void onSearchAllRequested(const QString& phrase);
+    void dispatchFile(const ToxFile& file);
+    void dispatchFileWithBool(const ToxFile& file, bool pausedOrBroken);
     void dispatchFileSendFailed(uint32_t friendId, const QString& fileName);
     void connectCircleWidget(CircleWidget& circleWidget);
     void connectFriendWidget(FriendWidget& friendWidget);
@@ -257,6 +263,8 @@ private:
     bool event(QEvent* e) final;
     void closeEvent(QCloseEvent* event) final;
     void changeEvent(QEvent* event) final;
+    void showEvent(QShowEvent* event) final;
+    void hideEvent(QHideEvent* event) final;
     void resizeEvent(QResizeEvent* event) final;
     void moveEvent(QMoveEvent* event) final;
 
@@ -278,6 +286,7 @@ private:
     static bool filterOffline(FilterCriteria index);
     void retranslateUi();
     void focusChatInput();
+    ChatForm* getOrCreateChatForm(const ToxPk& friendPk);
     void openDialog(GenericChatroomWidget* widget, bool newWindow);
     void playNotificationSound(IAudioSink::Sound sound, bool loop = false);
     void cleanupNotificationSound();
@@ -342,6 +351,9 @@ private:
     Settings& settings;
 
     QMap<ToxPk, FriendWidget*> friendWidgets;
+    // Avatar loads queued by addFriend, decoded as one parallel batch per
+    // event loop pass
+    QList<ToxPk> pendingAvatarLoads;
     // Shared pointer because QMap copies stuff all over the place
     QMap<ToxPk, std::shared_ptr<FriendMessageDispatcher>> friendMessageDispatchers;
     // Stop gap method of linking our friend messages back to a conference id.
@@ -351,7 +363,10 @@ private:
     QMap<ToxPk, QMetaObject::Connection> friendAlertConnections;
     QMap<ToxPk, std::shared_ptr<ChatHistory>> friendChatLogs;
     QMap<ToxPk, std::shared_ptr<FriendChatroom>> friendChatRooms;
+    // Chat forms are created on first activation and reclaimed after a period
+    // of inactivity; chat state survives in friendChatLogs
     QMap<ToxPk, ChatForm*> chatForms;
+    QMap<ToxPk, QDateTime> chatFormLastActivated;
 
     QMap<ConferenceId, ConferenceWidget*> conferenceWidgets;
     QMap<ConferenceId, std::shared_ptr<ConferenceMessageDispatcher>> conferenceMessageDispatchers;
@@ -389,6 +404,7 @@ private:
     IMessageBoxManager* messageBoxManager = nullptr; // freed by Qt on destruction
     std::unique_ptr<FriendList> friendList;
     std::unique_ptr<ConferenceList> conferenceList;
+    std::unique_ptr<ConferenceStateCache> conferenceStateCache;
     std::unique_ptr<ContentDialogManager> contentDialogManager;
     IPC& ipc;
     std::unique_ptr<ToxSave> toxSave;
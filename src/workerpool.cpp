@@ -0,0 +1,63 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "workerpool.h"
+
+#include <QThread>
+
+WorkerPool::WorkerPool()
+{
+    setInteractiveThreadCount(0);
+    setBackgroundThreadCount(0);
+    backgroundPool.setThreadPriority(QThread::LowPriority);
+    // Workers are let go after a quiet period instead of idling forever
+    backgroundPool.setExpiryTimeout(30 * 1000);
+}
+
+/**
+ * @brief Resizes the interactive pool; 0 restores the automatic size.
+ *
+ * Applies hot: QThreadPool lets running workers finish and only changes how
+ * many may be active at once from here on.
+ */
+void WorkerPool::setInteractiveThreadCount(int threads)
+{
+    // Leave two cores of headroom so an interactive burst cannot starve the
+    // Core, CoreAV and camera threads in the middle of a call
+    const int cores = QThread::idealThreadCount();
+    interactivePool.setMaxThreadCount(threads > 0 ? threads : qMax(2, cores - 2));
+}
+
+/**
+ * @brief Resizes the background pool; 0 restores the automatic size.
+ */
+void WorkerPool::setBackgroundThreadCount(int threads)
+{
+    // Background work trades latency for staying out of the way: a quarter
+    // of the cores at most by default
+    const int cores = QThread::idealThreadCount();
+    backgroundPool.setMaxThreadCount(threads > 0 ? threads : qBound(1, cores / 4, 4));
+}
+
+WorkerPool& WorkerPool::instance()
+{
+    static WorkerPool pool;
+    return pool;
+}
+
+/**
+ * @brief Pool for work a user is actively waiting on.
+ */
+QThreadPool& WorkerPool::interactive()
+{
+    return interactivePool;
+}
+
+/**
+ * @brief Pool for deferrable work nobody is watching.
+ */
+QThreadPool& WorkerPool::background()
+{
+    return backgroundPool;
+}
@@ -0,0 +1,57 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+
+/**
+ * @brief Shared worker pools with latency classes for bursty work.
+ *
+ * Subsystems used to throw one-shot work (image decode, file hashing, layout
+ * warm-up, profile saves) at the global QThreadPool, which sizes itself to
+ * every core and happily oversubscribes the CPU while the Core, CoreAV and
+ * camera threads are busy with a call. The two pools here give that work a
+ * home with a deliberate size and priority instead:
+ *
+ * - interactive: work a user is waiting on right now (decoding an image
+ *   preview, laying out a freshly opened chat). Sized to leave headroom for
+ *   the real-time threads.
+ * - background: work nobody is watching (hashing transfers, saving profile
+ *   data, parsing smiley packs). Few threads, low scheduling priority.
+ *
+ * Qt offers no core pinning, so the affinity hint is the size cap plus the
+ * worker thread priority. Long-running loops (the camera stream, database
+ * worker) keep their dedicated threads; pools are for work that finishes.
+ */
+class WorkerPool
+{
+public:
+    static WorkerPool& instance();
+
+    QThreadPool& interactive();
+    QThreadPool& background();
+
+    void setInteractiveThreadCount(int threads);
+    void setBackgroundThreadCount(int threads);
+
+    template <typename F>
+    auto runInteractive(F&& task)
+    {
+        return QtConcurrent::run(&interactivePool, std::forward<F>(task));
+    }
+
+    template <typename F>
+    auto runBackground(F&& task)
+    {
+        return QtConcurrent::run(&backgroundPool, std::forward<F>(task));
+    }
+
+private:
+    WorkerPool();
+
+    QThreadPool interactivePool;
+    QThreadPool backgroundPool;
+};
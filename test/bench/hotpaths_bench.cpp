@@ -0,0 +1,236 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "src/chatlog/chatline.h"
+#include "src/chatlog/chatlinestorage.h"
+#include "src/chatlog/textformatter.h"
+#include "src/core/toxpk.h"
+#include "src/persistence/db/rawdatabase.h"
+#include "src/persistence/history.h"
+#include "src/persistence/settings.h"
+#include "src/video/videoframe.h"
+#include "src/widget/tool/imessageboxmanager.h"
+
+extern "C"
+{
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+#pragma GCC diagnostic pop
+}
+
+#include <QDateTime>
+#include <QStandardPaths>
+#include <QTemporaryFile>
+#include <QTest>
+
+#include <cstring>
+#include <memory>
+#include <tuple>
+
+/**
+ * Benchmarks for the hot paths that show up in profiles of large chats:
+ * message insertion into history, markdown/URI formatting, chat line storage
+ * insertion and video frame conversion. Not run by ctest; run the binary
+ * manually (pass -csv for machine-readable output to diff across releases).
+ */
+
+namespace {
+class SilentMessageBoxManager : public IMessageBoxManager
+{
+public:
+    void showInfo(const QString& title, const QString& msg) override
+    {
+        std::ignore = title;
+        std::ignore = msg;
+    }
+    void showWarning(const QString& title, const QString& msg) override
+    {
+        std::ignore = title;
+        std::ignore = msg;
+    }
+    void showError(const QString& title, const QString& msg) override
+    {
+        std::ignore = title;
+        std::ignore = msg;
+    }
+    bool askQuestion(const QString& title, const QString& msg, bool defaultAns, bool warning,
+                     bool yesno) override
+    {
+        std::ignore = title;
+        std::ignore = msg;
+        std::ignore = warning;
+        std::ignore = yesno;
+        return defaultAns;
+    }
+    bool askQuestion(const QString& title, const QString& msg, const QString& button1,
+                     const QString& button2, bool defaultAns, bool warning) override
+    {
+        std::ignore = title;
+        std::ignore = msg;
+        std::ignore = button1;
+        std::ignore = button2;
+        std::ignore = warning;
+        return defaultAns;
+    }
+    void confirmExecutableOpen(const QFileInfo& file) override
+    {
+        std::ignore = file;
+    }
+};
+
+ToxPk benchPk(uint8_t fill)
+{
+    return ToxPk{QByteArray(32, static_cast<char>(fill))};
+}
+
+/**
+ * @brief Generates chat messages shaped like real traffic: a mix of plain
+ * text, markdown and URIs, so the formatter benchmarks hit all branches.
+ */
+QStringList generateMessages(int count)
+{
+    QStringList messages;
+    messages.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        switch (i % 4) {
+        case 0:
+            messages += QStringLiteral("plain message number %1 with nothing special in it").arg(i);
+            break;
+        case 1:
+            messages += QStringLiteral("message %1 with *bold*, /italic/ and `code` spans").arg(i);
+            break;
+        case 2:
+            messages += QStringLiteral("see https://example.com/page/%1 and tox:abcdef%1").arg(i);
+            break;
+        default:
+            messages += QStringLiteral("**%1** mixed __markdown__ and https://example.org/%1").arg(i);
+            break;
+        }
+    }
+    return messages;
+}
+
+/**
+ * @brief Fills a history with @a count delivered messages, so insertion
+ * benchmarks run against realistically sized tables rather than empty ones.
+ */
+void populateHistory(History& history, const ToxPk& chatId, const ToxPk& sender, int count)
+{
+    const QStringList messages = generateMessages(count);
+    const QDateTime base = QDate(2024, 1, 1).startOfDay();
+    for (int i = 0; i < count; ++i) {
+        history.addNewMessage(chatId, messages[i % messages.size()], sender,
+                              base.addSecs(i), true, QStringLiteral("bench peer"));
+    }
+}
+} // namespace
+
+class BenchHotPaths : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void benchHistoryAddNewMessage();
+    void benchTextFormatter();
+    void benchChatLineStorageInsertion();
+    void benchVideoFrameConversion();
+};
+
+void BenchHotPaths::initTestCase()
+{
+    // Keep benchmark runs from reading or writing the user's real settings
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void BenchHotPaths::benchHistoryAddNewMessage()
+{
+    QTemporaryFile databaseFile;
+    // fileName is only defined once the file is opened. Since RawDatabase
+    // will open it itself, open and close the file to generate the name.
+    databaseFile.open();
+    databaseFile.close();
+
+    auto db = std::make_shared<RawDatabase>(databaseFile.fileName(), QString{}, QByteArray{});
+    QVERIFY(db->isOpen());
+
+    SilentMessageBoxManager messageBoxManager;
+    Settings settings{messageBoxManager};
+    History history{db, settings, messageBoxManager};
+    QVERIFY(history.isValid());
+
+    const ToxPk chatId = benchPk(0xab);
+    const ToxPk sender = benchPk(0xcd);
+
+    // Insert against a table that already holds a large history
+    populateHistory(history, chatId, sender, 5000);
+    db->sync();
+
+    const QStringList messages = generateMessages(100);
+    const QDateTime base = QDate(2024, 6, 1).startOfDay();
+    int offset = 0;
+    QBENCHMARK
+    {
+        for (const QString& message : messages) {
+            history.addNewMessage(chatId, message, sender, base.addSecs(offset), true,
+                                  QStringLiteral("bench peer"));
+            ++offset;
+        }
+        // Wait for the worker thread, so we time the writes rather than the enqueue
+        db->sync();
+    }
+}
+
+void BenchHotPaths::benchTextFormatter()
+{
+    const QStringList messages = generateMessages(100);
+
+    QBENCHMARK
+    {
+        for (const QString& message : messages) {
+            std::ignore = TextFormatter::highlightURI(TextFormatter::applyMarkdown(message, false));
+        }
+    }
+}
+
+void BenchHotPaths::benchChatLineStorageInsertion()
+{
+    const QDateTime base = QDate(2024, 1, 1).startOfDay();
+
+    QBENCHMARK
+    {
+        ChatLineStorage storage;
+        for (size_t i = 0; i < 1000; ++i) {
+            // Spread the timestamps over several days to exercise date line insertion
+            storage.insertChatMessage(ChatLogIdx(i), base.addSecs(i * 90),
+                                      std::make_shared<ChatLine>());
+        }
+    }
+}
+
+void BenchHotPaths::benchVideoFrameConversion()
+{
+    const QSize dimensions{1280, 720};
+
+    QBENCHMARK
+    {
+        AVFrame* sourceFrame =
+            VideoFrame::allocFrameBuffer(dimensions, AV_PIX_FMT_YUV420P, false);
+        QVERIFY(sourceFrame != nullptr);
+
+        std::memset(sourceFrame->data[0], 128, sourceFrame->linesize[0] * dimensions.height());
+        std::memset(sourceFrame->data[1], 128, sourceFrame->linesize[1] * dimensions.height() / 2);
+        std::memset(sourceFrame->data[2], 128, sourceFrame->linesize[2] * dimensions.height() / 2);
+
+        // A fresh VideoFrame per iteration, since conversions are cached per frame
+        auto frame = VideoFrame::fromAVFrameUntracked(1, sourceFrame, true);
+        const QImage image = frame->toQImage(dimensions);
+        QVERIFY(!image.isNull());
+    }
+}
+
+QTEST_GUILESS_MAIN(BenchHotPaths)
+#include "hotpaths_bench.moc"
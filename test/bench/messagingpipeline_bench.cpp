@@ -0,0 +1,336 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "src/conferencelist.h"
+#include "src/core/icorefriendmessagesender.h"
+#include "src/core/icoreidhandler.h"
+#include "src/friendlist.h"
+#include "src/model/chathistory.h"
+#include "src/model/friend.h"
+#include "src/model/friendmessagedispatcher.h"
+#include "src/model/message.h"
+#include "src/model/status.h"
+#include "src/persistence/db/rawdatabase.h"
+#include "src/persistence/history.h"
+#include "src/persistence/settings.h"
+#include "src/widget/tool/imessageboxmanager.h"
+
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QTemporaryFile>
+#include <QtTest/QtTest>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <tox/tox.h> // tox_max_message_length
+
+/**
+ * End-to-end throughput benchmark for the outgoing message path: mock
+ * ICoreFriendMessageSender -> FriendMessageDispatcher -> ChatHistory ->
+ * History/RawDatabase on a temporary database, with the SessionChatLog
+ * inside ChatHistory absorbing every event. Reproduces the message-storm
+ * load we cannot generate in CI against real toxcore.
+ *
+ * Not run by ctest; run the binary manually. The latencyPercentiles slot
+ * honours two environment variables:
+ *   QTOX_BENCH_MESSAGES - messages to push through (default 2000)
+ *   QTOX_BENCH_RATE     - send rate in messages/second, 0 = unthrottled
+ */
+
+namespace {
+class SilentMessageBoxManager : public IMessageBoxManager
+{
+public:
+    void showInfo(const QString& title, const QString& msg) override
+    {
+        std::ignore = title;
+        std::ignore = msg;
+    }
+    void showWarning(const QString& title, const QString& msg) override
+    {
+        std::ignore = title;
+        std::ignore = msg;
+    }
+    void showError(const QString& title, const QString& msg) override
+    {
+        std::ignore = title;
+        std::ignore = msg;
+    }
+    bool askQuestion(const QString& title, const QString& msg, bool defaultAns, bool warning,
+                     bool yesno) override
+    {
+        std::ignore = title;
+        std::ignore = msg;
+        std::ignore = warning;
+        std::ignore = yesno;
+        return defaultAns;
+    }
+    bool askQuestion(const QString& title, const QString& msg, const QString& button1,
+                     const QString& button2, bool defaultAns, bool warning) override
+    {
+        std::ignore = title;
+        std::ignore = msg;
+        std::ignore = button1;
+        std::ignore = button2;
+        std::ignore = warning;
+        return defaultAns;
+    }
+    void confirmExecutableOpen(const QFileInfo& file) override
+    {
+        std::ignore = file;
+    }
+};
+
+class MockCoreIdHandler : public ICoreIdHandler
+{
+public:
+    ToxId getSelfId() const override
+    {
+        std::terminate();
+    }
+
+    ToxPk getSelfPublicKey() const override
+    {
+        static uint8_t id[ToxPk::size] = {5};
+        return ToxPk(id);
+    }
+
+    QString getUsername() const override
+    {
+        return QStringLiteral("qTox bench");
+    }
+};
+
+class MockFriendMessageSender : public ICoreFriendMessageSender
+{
+public:
+    bool sendAction(uint32_t friendId, const QString& action, ReceiptNum& receipt) override
+    {
+        return sendMessage(friendId, action, receipt);
+    }
+
+    bool sendMessage(uint32_t friendId, const QString& message, ReceiptNum& receipt) override
+    {
+        std::ignore = friendId;
+        std::ignore = message;
+        receipt = receiptNum;
+        receiptNum.get() += 1;
+        return true;
+    }
+
+    ReceiptNum receiptNum{0};
+};
+
+/**
+ * @brief Owns one full instance of the outgoing message pipeline, wired the
+ * way Widget wires it in production, against a throwaway database.
+ */
+struct Pipeline
+{
+    Pipeline()
+    {
+        // fileName is only defined once the file is opened. Since
+        // RawDatabase will open it itself, open and close the file to
+        // generate the name.
+        databaseFile.open();
+        databaseFile.close();
+
+        db = std::make_shared<RawDatabase>(databaseFile.fileName(), QString{}, QByteArray{});
+        settings = std::make_unique<Settings>(messageBoxManager);
+        history = std::make_unique<History>(db, *settings, messageBoxManager);
+
+        f = std::make_unique<Friend>(0, ToxPk{});
+        f->setStatus(Status::Status::Online);
+
+        sharedParams = std::make_unique<MessageProcessor::SharedParams>(tox_max_message_length());
+        processor = std::make_unique<MessageProcessor>(*sharedParams);
+        dispatcher = std::make_unique<FriendMessageDispatcher>(*f, *processor, sender);
+
+        chatHistory = std::make_unique<ChatHistory>(*f, history.get(), idHandler, *settings,
+                                                    *dispatcher, friendList, conferenceList);
+
+        QObject::connect(dispatcher.get(), &IMessageDispatcher::messageComplete,
+                         [this](DispatchedMessageId id) {
+                             std::ignore = id;
+                             ++completedCount;
+                         });
+    }
+
+    /**
+     * @brief Acks every receipt the mock sender has issued so far, which is
+     * what drives messageComplete through ChatHistory and the database.
+     */
+    void drainReceipts()
+    {
+        while (nextAcked.get() < sender.receiptNum.get()) {
+            dispatcher->onReceiptReceived(nextAcked);
+            nextAcked.get() += 1;
+        }
+    }
+
+    /**
+     * @brief Pumps the event loop until @a expected sends have completed.
+     *
+     * The dispatcher hands messages to the sender on event-loop turns, so
+     * receipts have to be drained between pumps.
+     */
+    bool pumpUntilComplete(size_t expected, int timeoutMs = 30000)
+    {
+        QElapsedTimer deadline;
+        deadline.start();
+        while (completedCount < expected) {
+            if (deadline.elapsed() > timeoutMs) {
+                return false;
+            }
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+            drainReceipts();
+        }
+        return true;
+    }
+
+    QTemporaryFile databaseFile;
+    SilentMessageBoxManager messageBoxManager;
+    std::shared_ptr<RawDatabase> db;
+    std::unique_ptr<Settings> settings;
+    std::unique_ptr<History> history;
+    MockCoreIdHandler idHandler;
+    MockFriendMessageSender sender;
+    std::unique_ptr<Friend> f;
+    std::unique_ptr<MessageProcessor::SharedParams> sharedParams;
+    std::unique_ptr<MessageProcessor> processor;
+    std::unique_ptr<FriendMessageDispatcher> dispatcher;
+    FriendList friendList;
+    ConferenceList conferenceList;
+    std::unique_ptr<ChatHistory> chatHistory;
+    ReceiptNum nextAcked{0};
+    size_t completedCount = 0;
+};
+
+qint64 percentileNs(const std::vector<qint64>& sorted, int percentile)
+{
+    if (sorted.empty()) {
+        return 0;
+    }
+    const size_t index = (sorted.size() - 1) * percentile / 100;
+    return sorted[index];
+}
+} // namespace
+
+class BenchMessagingPipeline : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void benchThroughput();
+    void latencyPercentiles();
+};
+
+void BenchMessagingPipeline::initTestCase()
+{
+    // Keep benchmark runs from reading or writing the user's real settings
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+/**
+ * @brief Times a 500-message burst through the whole pipeline, including
+ * the database writes, so the headline number is storm throughput.
+ */
+void BenchMessagingPipeline::benchThroughput()
+{
+    Pipeline pipeline;
+    QVERIFY(pipeline.db->isOpen());
+    QVERIFY(pipeline.history->isValid());
+
+    constexpr size_t batchSize = 500;
+    size_t sent = 0;
+    QBENCHMARK
+    {
+        for (size_t i = 0; i < batchSize; ++i) {
+            pipeline.dispatcher->sendMessage(
+                false, QStringLiteral("storm message %1 with some typical length").arg(sent + i));
+        }
+        sent += batchSize;
+        QVERIFY(pipeline.pumpUntilComplete(sent));
+        // Wait for the DB worker, so queued inserts are part of the timing
+        pipeline.db->sync();
+    }
+}
+
+/**
+ * @brief Pushes a configurable load through the pipeline and prints
+ * send-to-complete latency percentiles.
+ *
+ * Completion covers the dispatcher hand-off, the receipt ack and the
+ * ChatHistory bookkeeping; the final db->sync() is reported separately as
+ * drain time since database writes complete asynchronously.
+ */
+void BenchMessagingPipeline::latencyPercentiles()
+{
+    Pipeline pipeline;
+    QVERIFY(pipeline.db->isOpen());
+    QVERIFY(pipeline.history->isValid());
+
+    int messageCount = qEnvironmentVariableIntValue("QTOX_BENCH_MESSAGES");
+    if (messageCount <= 0) {
+        messageCount = 2000;
+    }
+    const int ratePerSecond = qEnvironmentVariableIntValue("QTOX_BENCH_RATE");
+
+    std::map<DispatchedMessageId, qint64> sendTimesNs;
+    std::vector<qint64> latenciesNs;
+    latenciesNs.reserve(messageCount);
+
+    QElapsedTimer clock;
+    clock.start();
+    connect(pipeline.dispatcher.get(), &IMessageDispatcher::messageComplete, this,
+            [&](DispatchedMessageId id) {
+                const auto it = sendTimesNs.find(id);
+                if (it != sendTimesNs.end()) {
+                    latenciesNs.push_back(clock.nsecsElapsed() - it->second);
+                    sendTimesNs.erase(it);
+                }
+            });
+
+    for (int i = 0; i < messageCount; ++i) {
+        if (ratePerSecond > 0) {
+            // Hold each message back until its paced slot while keeping the
+            // pipeline serviced, so a low rate measures idle-path latency
+            const qint64 dueNs = qint64(i) * 1000000000 / ratePerSecond;
+            while (clock.nsecsElapsed() < dueNs) {
+                QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+                pipeline.drainReceipts();
+            }
+        }
+
+        const auto sentIds = pipeline.dispatcher->sendMessage(
+            false, QStringLiteral("paced message %1 with some typical length").arg(i));
+        sendTimesNs[sentIds.first] = clock.nsecsElapsed();
+    }
+
+    QVERIFY(pipeline.pumpUntilComplete(size_t(messageCount)));
+    const qint64 completedAtNs = clock.nsecsElapsed();
+    pipeline.db->sync();
+    const qint64 drainedAtNs = clock.nsecsElapsed();
+
+    std::sort(latenciesNs.begin(), latenciesNs.end());
+    const double seconds = double(completedAtNs) / 1e9;
+    qInfo().nospace() << "messages: " << messageCount
+                      << " rate limit: " << (ratePerSecond > 0 ? ratePerSecond : 0)
+                      << "/s achieved: " << qint64(messageCount / seconds) << "/s";
+    qInfo().nospace() << "send-to-complete latency (us): p50 "
+                      << percentileNs(latenciesNs, 50) / 1000 << " p90 "
+                      << percentileNs(latenciesNs, 90) / 1000 << " p99 "
+                      << percentileNs(latenciesNs, 99) / 1000 << " max "
+                      << (latenciesNs.empty() ? 0 : latenciesNs.back() / 1000);
+    qInfo().nospace() << "db drain after last completion: " << (drainedAtNs - completedAtNs) / 1000000
+                      << " ms";
+}
+
+QTEST_GUILESS_MAIN(BenchMessagingPipeline)
+#include "messagingpipeline_bench.moc"
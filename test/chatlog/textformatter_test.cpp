@@ -410,6 +410,7 @@ private slots:
     void singleAndDoubleMarkdownExceptionsHideSymbols();
     void mixedFormattingSpecialCases();
     void urlTest();
+    void extractHttpUrisTest();
 
 private:
     const MarkdownFunction markdownFunction = TextFormatter::applyMarkdown;
@@ -506,5 +507,21 @@ void TestTextFormatter::urlTest()
     urlHighlightTest(urlHighlightFunction, URL_CASES);
 }
 
+void TestTextFormatter::extractHttpUrisTest()
+{
+    // Web links come back stripped of surrounding characters, deduplicated,
+    // in order; non-web schemes are skipped
+    QCOMPARE(TextFormatter::extractHttpUris(
+                 "see (https://example.com/page) and http://other.example/, "
+                 "again https://example.com/page"),
+             QStringList({"https://example.com/page", "http://other.example/"}));
+    QCOMPARE(TextFormatter::extractHttpUris("bare www.example.com link"),
+             QStringList({"http://www.example.com"}));
+    QCOMPARE(TextFormatter::extractHttpUris(
+                 "mailto:user@example.com ftp://example.com/file no previews here"),
+             QStringList{});
+    QCOMPARE(TextFormatter::extractHttpUris("no links at all"), QStringList{});
+}
+
 QTEST_GUILESS_MAIN(TestTextFormatter)
 #include "textformatter_test.moc"
@@ -0,0 +1,84 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "src/core/coremetrics.h"
+
+#include <QtTest/QtTest>
+
+class TestCoreMetrics : public QObject
+{
+    Q_OBJECT
+private slots:
+    void emptySnapshotTest();
+    void iterationPercentileTest();
+    void callbackCountTest();
+    void connectionChangeTest();
+};
+
+void TestCoreMetrics::emptySnapshotTest()
+{
+    CoreMetrics metrics;
+    const auto snap = metrics.snapshot();
+    QCOMPARE(snap.iterations, uint64_t{0});
+    QCOMPARE(snap.iterationPercentileUs(50), int64_t{-1});
+    QVERIFY(!snap.toString().isEmpty());
+}
+
+void TestCoreMetrics::iterationPercentileTest()
+{
+    CoreMetrics metrics;
+    // 90 fast iterations, 10 slow ones
+    for (int i = 0; i < 90; ++i) {
+        metrics.recordIteration(40);
+    }
+    for (int i = 0; i < 10; ++i) {
+        metrics.recordIteration(4000);
+    }
+
+    const auto snap = metrics.snapshot();
+    QCOMPARE(snap.iterations, uint64_t{100});
+    QCOMPARE(snap.iterationPercentileUs(50), int64_t{50});
+    QCOMPARE(snap.iterationPercentileUs(90), int64_t{50});
+    QCOMPARE(snap.iterationPercentileUs(99), int64_t{5000});
+
+    // Durations past the largest bound land in the overflow bucket
+    metrics.recordIteration(1000000);
+    QCOMPARE(metrics.snapshot().iterationBuckets.back(), uint64_t{1});
+}
+
+void TestCoreMetrics::callbackCountTest()
+{
+    CoreMetrics metrics;
+    metrics.countCallback(CoreMetrics::Callback::FriendMessage);
+    metrics.countCallback(CoreMetrics::Callback::FriendMessage);
+    metrics.countCallback(CoreMetrics::Callback::ReadReceipt);
+
+    const auto snap = metrics.snapshot();
+    QCOMPARE(snap.callbackCounts[static_cast<size_t>(CoreMetrics::Callback::FriendMessage)],
+             uint64_t{2});
+    QCOMPARE(snap.callbackCounts[static_cast<size_t>(CoreMetrics::Callback::ReadReceipt)],
+             uint64_t{1});
+    QCOMPARE(snap.callbackCounts[static_cast<size_t>(CoreMetrics::Callback::FriendRequest)],
+             uint64_t{0});
+}
+
+void TestCoreMetrics::connectionChangeTest()
+{
+    CoreMetrics metrics;
+    metrics.countConnectionChange(CoreMetrics::ConnectionMode::Udp);
+    metrics.countConnectionChange(CoreMetrics::ConnectionMode::None);
+    metrics.countConnectionChange(CoreMetrics::ConnectionMode::Tcp);
+    metrics.countConnectionChange(CoreMetrics::ConnectionMode::Udp);
+
+    const auto snap = metrics.snapshot();
+    QCOMPARE(snap.connectionChanges[static_cast<size_t>(CoreMetrics::ConnectionMode::Udp)],
+             uint64_t{2});
+    QCOMPARE(snap.connectionChanges[static_cast<size_t>(CoreMetrics::ConnectionMode::Tcp)],
+             uint64_t{1});
+    QCOMPARE(snap.connectionChanges[static_cast<size_t>(CoreMetrics::ConnectionMode::None)],
+             uint64_t{1});
+}
+
+QTEST_GUILESS_MAIN(TestCoreMetrics)
+#include "coremetrics_test.moc"
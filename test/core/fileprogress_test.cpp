@@ -26,6 +26,8 @@ private slots:
     void testFinishedSpeed();
     void testSamplePeriod();
     void testInvalidSamplePeriod();
+    void testUpdateRateCap();
+    void testUpdateTimeChange();
 };
 
 /**
@@ -323,5 +325,38 @@ void TestFileProgress::testInvalidSamplePeriod()
     QCOMPARE(progress.getSpeed(), 60.0);
 }
 
+/**
+ * @brief Test that updates are granted at most once per update interval, no
+ * matter how fast samples come in
+ */
+void TestFileProgress::testUpdateRateCap()
+{
+    auto progress = ToxFileProgress(100, 1000, 100);
+
+    auto now = QTime(1, 0, 0);
+    // The first claim is always granted
+    QVERIFY(progress.claimUpdate(now));
+
+    // Chunks arriving within the interval should be coalesced
+    QVERIFY(!progress.claimUpdate(now.addMSecs(50)));
+    QVERIFY(!progress.claimUpdate(now.addMSecs(99)));
+
+    now = now.addMSecs(100);
+    QVERIFY(progress.claimUpdate(now));
+    QVERIFY(!progress.claimUpdate(now.addMSecs(99)));
+}
+
+/**
+ * @brief Test that a clock jump backwards grants an update instead of
+ * suppressing them until the clock catches up
+ */
+void TestFileProgress::testUpdateTimeChange()
+{
+    auto progress = ToxFileProgress(100, 1000, 100);
+
+    QVERIFY(progress.claimUpdate(QTime(1, 0, 0)));
+    QVERIFY(progress.claimUpdate(QTime(0, 0, 0)));
+}
+
 QTEST_GUILESS_MAIN(TestFileProgress)
 #include "fileprogress_test.moc"
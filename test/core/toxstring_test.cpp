@@ -9,6 +9,8 @@
 #include <QString>
 #include <QtTest/QtTest>
 
+#include <utility>
+
 #include "src/widget/form/settings/generalform.h" // getLocales
 
 class TestToxString : public QObject
@@ -17,6 +19,7 @@ class TestToxString : public QObject
 private slots:
     void QStringTest();
     void QByteArrayTest();
+    void movedQByteArrayTest();
     void uint8_tTest();
     void emptyQStrTest();
     void emptyQByteTest();
@@ -24,6 +27,7 @@ private slots:
     void nullptrUINT8Test();
     void localesTest();
     void filterTest();
+    void sanitationStatsTest();
     void emojiTest();
     void handshakeEmojiTest();
     void coloredEmojiTest();
@@ -110,6 +114,33 @@ void TestToxString::QByteArrayTest()
     }
 }
 
+/**
+ * @brief Use a moved-from QByteArray as input data, check output: QString, QByteArray, size_t and
+ *        uint8_t QVERIFY(expected == result);
+ */
+void TestToxString::movedQByteArrayTest()
+{
+    // Create Test Object with QByteArray move constructor
+    QByteArray source = testByte;
+    ToxString test(std::move(source));
+
+    // Check QString
+    QString test_string = test.getQString();
+    QVERIFY(testStr == test_string);
+
+    // Check QByteArray
+    QByteArray test_byte = test.getBytes();
+    QVERIFY(testByte == test_byte);
+
+    // Check uint8_t pointer
+    const uint8_t* test_int = test.data();
+    size_t test_size = test.size();
+    QVERIFY(lengthUINT8 == test_size);
+    for (int i = 0; i <= lengthUINT8; i++) {
+        QVERIFY(testUINT8[i] == test_int[i]);
+    }
+}
+
 /**
  * @brief Use uint8t* and size_t as input data, check output: QString, QByteArray, size_t and
  * uint8_t QVERIFY(expected == result);
@@ -278,6 +309,24 @@ void TestToxString::filterTest()
     }
 }
 
+/**
+ * @brief Check that the sanitation counters only tick when something is stripped.
+ */
+void TestToxString::sanitationStatsTest()
+{
+    const auto stringsBefore = ToxString::totalSanitizedStrings();
+    const auto codepointsBefore = ToxString::totalStrippedCodepoints();
+
+    // Clean strings take the fast path and leave the counters alone
+    ToxString(QStringLiteral("Hello, World!")).getQString();
+    QCOMPARE(ToxString::totalSanitizedStrings(), stringsBefore);
+    QCOMPARE(ToxString::totalStrippedCodepoints(), codepointsBefore);
+
+    ToxString(QStringLiteral("Hello, \x01\x02World!")).getQString();
+    QCOMPARE(ToxString::totalSanitizedStrings(), stringsBefore + 1);
+    QCOMPARE(ToxString::totalStrippedCodepoints(), codepointsBefore + 2);
+}
+
 /**
  * @brief Check that we can encode and decode emojis.
  *
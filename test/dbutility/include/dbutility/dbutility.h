@@ -33,6 +33,9 @@ extern const std::vector<SqliteMasterEntry> schema7;
 extern const std::vector<SqliteMasterEntry> schema9;
 extern const std::vector<SqliteMasterEntry> schema10;
 extern const std::vector<SqliteMasterEntry> schema11;
+extern const std::vector<SqliteMasterEntry> schema12;
+extern const std::vector<SqliteMasterEntry> schema13;
+extern const std::vector<SqliteMasterEntry> schema14;
 
 void createSchemaAtVersion(std::shared_ptr<RawDatabase> db,
                            const std::vector<DbUtility::SqliteMasterEntry>& schema);
@@ -182,6 +182,70 @@ const std::vector<DbUtility::SqliteMasterEntry> DbUtility::schema11{
      "FOREIGN KEY (id, message_type) REFERENCES history(id, message_type))"},
     {"chat_id_idx", "CREATE INDEX chat_id_idx on history (chat_id)"}};
 
+// added full-text index over text message content
+const std::vector<DbUtility::SqliteMasterEntry> DbUtility::schema12 = [] {
+    std::vector<DbUtility::SqliteMasterEntry> schema = DbUtility::schema11;
+    schema.push_back({"text_messages_fts",
+                      "CREATE VIRTUAL TABLE text_messages_fts USING fts5(message, "
+                      "content='text_messages', content_rowid='id')"});
+    schema.push_back({"text_messages_fts_insert",
+                      "CREATE TRIGGER text_messages_fts_insert AFTER INSERT ON text_messages "
+                      "BEGIN "
+                      "INSERT INTO text_messages_fts(rowid, message) "
+                      "VALUES (new.id, new.message); "
+                      "END"});
+    schema.push_back({"text_messages_fts_delete",
+                      "CREATE TRIGGER text_messages_fts_delete AFTER DELETE ON text_messages "
+                      "BEGIN "
+                      "INSERT INTO text_messages_fts(text_messages_fts, rowid, message) "
+                      "VALUES ('delete', old.id, old.message); "
+                      "END"});
+    schema.push_back({"text_messages_fts_update",
+                      "CREATE TRIGGER text_messages_fts_update AFTER UPDATE ON text_messages "
+                      "BEGIN "
+                      "INSERT INTO text_messages_fts(text_messages_fts, rowid, message) "
+                      "VALUES ('delete', old.id, old.message); "
+                      "INSERT INTO text_messages_fts(rowid, message) "
+                      "VALUES (new.id, new.message); "
+                      "END"});
+    return schema;
+}();
+
+// added day-boundary index for date navigation
+const std::vector<DbUtility::SqliteMasterEntry> DbUtility::schema13 = [] {
+    std::vector<DbUtility::SqliteMasterEntry> schema = DbUtility::schema12;
+    schema.push_back({"chat_day_index",
+                      "CREATE TABLE chat_day_index (chat_id INTEGER NOT NULL, "
+                      "day INTEGER NOT NULL, "
+                      "first_id INTEGER NOT NULL, "
+                      "message_offset INTEGER NOT NULL, "
+                      "PRIMARY KEY (chat_id, day), "
+                      "FOREIGN KEY (chat_id) REFERENCES chats(id), "
+                      "FOREIGN KEY (first_id) REFERENCES history(id) ON DELETE CASCADE)"});
+    schema.push_back({"chat_day_index_insert",
+                      "CREATE TRIGGER chat_day_index_insert AFTER INSERT ON history "
+                      "WHEN NOT EXISTS (SELECT 1 FROM chat_day_index "
+                      "WHERE chat_id = new.chat_id "
+                      "AND day = new.timestamp / 1000 / 60 / 60 / 24) "
+                      "BEGIN "
+                      "INSERT INTO chat_day_index (chat_id, day, first_id, message_offset) "
+                      "VALUES (new.chat_id, new.timestamp / 1000 / 60 / 60 / 24, new.id, "
+                      "(SELECT COUNT(*) FROM history "
+                      "WHERE chat_id = new.chat_id AND id < new.id)); "
+                      "END"});
+    return schema;
+}();
+
+// added per-chat input drafts
+const std::vector<DbUtility::SqliteMasterEntry> DbUtility::schema14 = [] {
+    std::vector<DbUtility::SqliteMasterEntry> schema = DbUtility::schema13;
+    schema.push_back({"chat_drafts",
+                      "CREATE TABLE chat_drafts (chat_id INTEGER PRIMARY KEY, "
+                      "text BLOB NOT NULL, "
+                      "FOREIGN KEY (chat_id) REFERENCES chats(id))"});
+    return schema;
+}();
+
 void DbUtility::createSchemaAtVersion(std::shared_ptr<RawDatabase> db,
                                       const std::vector<DbUtility::SqliteMasterEntry>& schema)
 {
@@ -200,6 +264,13 @@ bool DbUtility::SqliteMasterEntry::operator==(const DbUtility::SqliteMasterEntry
 void DbUtility::verifyDb(std::shared_ptr<RawDatabase> db,
                          const std::vector<DbUtility::SqliteMasterEntry>& expectedSql)
 {
+    // fts5 maintains internal shadow tables behind the virtual table. Their
+    // schema is an sqlite implementation detail, so don't pin it in our
+    // expected schemas.
+    const std::vector<QString> ftsShadowTables = {"text_messages_fts_data",
+                                                  "text_messages_fts_idx",
+                                                  "text_messages_fts_docsize",
+                                                  "text_messages_fts_config"};
     QVERIFY(db->execNow(RawDatabase::Query(QStringLiteral("SELECT name, sql FROM sqlite_master;"),
                                            [&](const QVector<QVariant>& row) {
                                                const QString tableName = row[0].toString();
@@ -208,6 +279,11 @@ void DbUtility::verifyDb(std::shared_ptr<RawDatabase> db,
                                                    // so their existence is already covered by the table creation SQL
                                                    return;
                                                }
+                                               if (std::find(ftsShadowTables.begin(),
+                                                             ftsShadowTables.end(), tableName)
+                                                   != ftsShadowTables.end()) {
+                                                   return;
+                                               }
                                                QString tableSql = row[1].toString();
                                                // table and column names can be quoted. UPDATE
                                                // TABLE automatically quotes the new names, but
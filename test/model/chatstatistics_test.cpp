@@ -0,0 +1,110 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "src/model/chatstatistics.h"
+
+#include <QtTest/QtTest>
+
+namespace {
+QDateTime atHour(qint64 hourSinceEpoch)
+{
+    return QDateTime::fromSecsSinceEpoch(hourSinceEpoch * 3600);
+}
+} // namespace
+
+class TestChatStatistics : public QObject
+{
+    Q_OBJECT
+private slots:
+    void testRecordAccumulates();
+    void testRingRollover();
+    void testSeedMergesWithoutClobberingNewerHours();
+    void testPeakHourOfDay();
+    void testMessagesPerHour();
+};
+
+void TestChatStatistics::testRecordAccumulates()
+{
+    ChatStatistics stats;
+    const qint64 hour = 500000;
+
+    stats.recordMessage(atHour(hour), 10);
+    stats.recordMessage(atHour(hour), 20);
+
+    QCOMPARE(stats.totalMessages(), quint64{2});
+    QCOMPARE(stats.totalBytes(), quint64{30});
+
+    const auto bucket = stats.hourBucket(hour);
+    QCOMPARE(bucket.hourSinceEpoch, hour);
+    QCOMPARE(bucket.messages, quint32{2});
+    QCOMPARE(bucket.bytes, quint64{30});
+}
+
+void TestChatStatistics::testRingRollover()
+{
+    ChatStatistics stats;
+    const qint64 hour = 500000;
+
+    stats.recordMessage(atHour(hour), 5);
+    // Lands in the same ring slot and must evict the older bucket
+    stats.recordMessage(atHour(hour + ChatStatistics::ringHours), 7);
+
+    QCOMPARE(stats.hourBucket(hour).messages, quint32{0});
+    QCOMPARE(stats.hourBucket(hour + ChatStatistics::ringHours).messages, quint32{1});
+    // Totals survive the rollover even though the bucket is gone
+    QCOMPARE(stats.totalMessages(), quint64{2});
+    QCOMPARE(stats.totalBytes(), quint64{12});
+}
+
+void TestChatStatistics::testSeedMergesWithoutClobberingNewerHours()
+{
+    ChatStatistics stats;
+    const qint64 hour = 500000;
+
+    stats.recordMessage(atHour(hour), 5);
+    // Seeding an older hour that shares the live hour's ring slot must not
+    // overwrite the newer bucket, but still count towards the totals
+    stats.seedHour(hour - ChatStatistics::ringHours, 100, 1000);
+    QCOMPARE(stats.hourBucket(hour).messages, quint32{1});
+    QCOMPARE(stats.totalMessages(), quint64{101});
+    QCOMPARE(stats.totalBytes(), quint64{1005});
+
+    // Seeding the same hour merges into the existing bucket
+    stats.seedHour(hour, 3, 30);
+    QCOMPARE(stats.hourBucket(hour).messages, quint32{4});
+    QCOMPARE(stats.hourBucket(hour).bytes, quint64{35});
+}
+
+void TestChatStatistics::testPeakHourOfDay()
+{
+    ChatStatistics stats;
+    // Hour 0 of the epoch is midnight UTC, so hourSinceEpoch % 24 is the
+    // UTC hour of day
+    const qint64 baseDay = 500016; // divisible by 24
+
+    stats.recordMessage(atHour(baseDay + 9), 1);
+    stats.recordMessage(atHour(baseDay + 14), 1);
+    stats.recordMessage(atHour(baseDay + 24 + 14), 1);
+
+    QCOMPARE(stats.peakHourOfDay(), 14);
+    QCOMPARE(stats.messagesByHourOfDay()[9], quint32{1});
+    QCOMPARE(stats.messagesByHourOfDay()[14], quint32{2});
+}
+
+void TestChatStatistics::testMessagesPerHour()
+{
+    ChatStatistics stats;
+    const qint64 nowHour = 500000;
+
+    // 96 messages inside the 48h window, plus one too old to count
+    for (int i = 0; i < 4; ++i) {
+        stats.seedHour(nowHour - i, 24, 0);
+    }
+    stats.seedHour(nowHour - ChatStatistics::ringHours, 1000, 0);
+
+    QCOMPARE(stats.messagesPerHour(atHour(nowHour)), 2.0);
+}
+
+QTEST_GUILESS_MAIN(TestChatStatistics)
+#include "chatstatistics_test.moc"
@@ -30,8 +30,12 @@ public:
 
     void sendConferenceMessage(int conferenceId, const QString& message) override;
 
+    void sendConferenceMessageBatch(int conferenceId, bool isAction,
+                                    const QStringList& parts) override;
+
     size_t numSentActions = 0;
     size_t numSentMessages = 0;
+    size_t numBatches = 0;
 };
 
 void MockConferenceMessageSender::sendConferenceAction(int conferenceId, const QString& action)
@@ -48,6 +52,14 @@ void MockConferenceMessageSender::sendConferenceMessage(int conferenceId, const
     numSentMessages++;
 }
 
+void MockConferenceMessageSender::sendConferenceMessageBatch(int conferenceId, bool isAction,
+                                                             const QStringList& parts)
+{
+    numBatches++;
+    // Delegate to the base implementation so the per-part counters still track
+    ICoreConferenceMessageSender::sendConferenceMessageBatch(conferenceId, isAction, parts);
+}
+
 class MockConferenceSettings : public QObject, public IConferenceSettings
 {
     Q_OBJECT
@@ -92,6 +104,7 @@ private slots:
     void init();
     void testSignals();
     void testMessageSending();
+    void testMessageBatching();
     void testEmptyConference();
     void testSelfReceive();
     void testBlockList();
@@ -204,6 +217,19 @@ void TestConferenceMessageDispatcher::testMessageSending()
     QVERIFY(messageSender->numSentActions == 1);
 }
 
+/**
+ * @brief Tests that a message split into multiple parts goes to core as one batch
+ */
+void TestConferenceMessageDispatcher::testMessageBatching()
+{
+    conferenceMessageDispatcher->sendMessage(false, QString(tox_max_message_length() + 1, 'a'));
+
+    QVERIFY(messageSender->numBatches == 1);
+    QVERIFY(messageSender->numSentMessages == 2);
+    QVERIFY(sentMessages.size() == 2);
+    QVERIFY(outgoingMessages.size() == 0);
+}
+
 /**
  * @brief Tests that if we are the only member in a conference we do _not_ send messages to core.
  * Toxcore isn't too happy if we send messages and we're the only one in the conference
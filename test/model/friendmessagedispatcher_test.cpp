@@ -65,6 +65,8 @@ private slots:
     void testSignals();
     void testMessageSending();
     void testOfflineMessages();
+    void testPacedResend();
+    void testInteractiveSendPacing();
     void testFailedMessage();
 
     void onMessageSent(DispatchedMessageId id, Message message)
@@ -143,14 +145,17 @@ void TestFriendMessageDispatcher::testSignals()
 {
     auto startReceiptNum = messageSender->receiptNum;
     auto sentIds = friendMessageDispatcher->sendMessage(false, "test");
-    auto endReceiptNum = messageSender->receiptNum;
 
-    // We should have received some message ids in our callbacks
+    // We should have received some message ids in our callbacks before core
+    // was involved at all; the hand-off happens on the next event-loop turn
     QVERIFY(sentIds.first == sentIds.second);
     QVERIFY(outgoingMessages.find(sentIds.first) != outgoingMessages.end());
-    QVERIFY(startReceiptNum.get() != endReceiptNum.get());
+    QVERIFY(startReceiptNum.get() == messageSender->receiptNum.get());
     QVERIFY(outgoingMessages.size() == 1);
 
+    QTRY_VERIFY(startReceiptNum.get() != messageSender->receiptNum.get());
+    auto endReceiptNum = messageSender->receiptNum;
+
     QVERIFY(outgoingMessages.begin()->second.isAction == false);
     QVERIFY(outgoingMessages.begin()->second.content == "test");
 
@@ -177,13 +182,13 @@ void TestFriendMessageDispatcher::testMessageSending()
 {
     friendMessageDispatcher->sendMessage(false, "Test");
 
-    QVERIFY(messageSender->numSentMessages == 1);
-    QVERIFY(messageSender->numSentActions == 0);
+    QTRY_COMPARE(messageSender->numSentMessages, static_cast<size_t>(1));
+    QCOMPARE(messageSender->numSentActions, static_cast<size_t>(0));
 
     friendMessageDispatcher->sendMessage(true, "Test");
 
-    QVERIFY(messageSender->numSentMessages == 1);
-    QVERIFY(messageSender->numSentActions == 1);
+    QTRY_COMPARE(messageSender->numSentActions, static_cast<size_t>(1));
+    QCOMPARE(messageSender->numSentMessages, static_cast<size_t>(1));
 }
 
 /**
@@ -218,6 +223,48 @@ void TestFriendMessageDispatcher::testOfflineMessages()
     QVERIFY(outgoingMessages.size() == 0);
 }
 
+/**
+ * @brief Tests that a large offline backlog is resent in rate-limited bursts
+ */
+void TestFriendMessageDispatcher::testPacedResend()
+{
+    f->setStatus(Status::Status::Offline);
+
+    const auto backlog = FriendMessageDispatcher::resendBatchSize + 10;
+    for (size_t i = 0; i < backlog; ++i) {
+        friendMessageDispatcher->sendMessage(false, QString::number(i));
+    }
+
+    QVERIFY(messageSender->numSentMessages == 0);
+
+    f->setStatus(Status::Status::Online);
+
+    // Only the first burst goes out on the online transition
+    QCOMPARE(messageSender->numSentMessages, FriendMessageDispatcher::resendBatchSize);
+
+    // The resend timer drains the rest
+    QTRY_COMPARE(messageSender->numSentMessages, backlog);
+}
+
+/**
+ * @brief Tests that sending hands nothing to core before returning to the event loop
+ */
+void TestFriendMessageDispatcher::testInteractiveSendPacing()
+{
+    const auto chunks = FriendMessageDispatcher::resendBatchSize + 4;
+    const QString hugePaste(static_cast<int>(chunks * tox_max_message_length()), 'a');
+
+    friendMessageDispatcher->sendMessage(false, hugePaste);
+
+    // The local echo is emitted without a single core call having been made
+    QCOMPARE(messageSender->numSentMessages, static_cast<size_t>(0));
+
+    // The first burst goes out on the next event-loop turn, then the send
+    // timer drains the queued remainder
+    QTRY_COMPARE(messageSender->numSentMessages, FriendMessageDispatcher::resendBatchSize);
+    QTRY_COMPARE(messageSender->numSentMessages, chunks);
+}
+
 /**
  * @brief Tests that messages that failed to send due to toxcore are resent later
  */
@@ -227,6 +274,9 @@ void TestFriendMessageDispatcher::testFailedMessage()
 
     friendMessageDispatcher->sendMessage(false, "test");
 
+    // Let the deferred hand-off run and fail so the message lands in the
+    // offline engine
+    QCoreApplication::processEvents();
     QVERIFY(messageSender->numSentMessages == 0);
 
     messageSender->canSend = true;
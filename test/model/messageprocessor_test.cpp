@@ -124,6 +124,23 @@ void TestMessageProcessor::testOutgoingMessage()
 
     // The message processor should split our messages
     QCOMPARE(messages.size(), 2);
+
+    // Nothing may be lost or reordered across the split, including multibyte
+    // characters pushed off a chunk boundary
+    testStr.clear();
+    for (size_t i = 0; i < tox_max_message_length(); ++i) {
+        testStr += QString::fromUtf8("\xc3\xa9");
+    }
+
+    messages = messageProcessor.processOutgoingMessage(false, testStr);
+    QVERIFY(messages.size() > 1);
+
+    QString recombined;
+    for (const auto& message : messages) {
+        QVERIFY(static_cast<size_t>(message.content.toUtf8().size()) <= tox_max_message_length());
+        recombined += message.content;
+    }
+    QCOMPARE(recombined, testStr);
 }
 
 /**
@@ -258,6 +258,21 @@ void TestNotificationGenerator::testMixedSourceMessages()
     notificationData = notificationGenerator->fileTransferNotification(&f, "file", 0);
     QCOMPARE("3 message(s) from 2 chats", notificationData.title);
     QCOMPARE("conference, friend", notificationData.message);
+
+    // A chat joining mid-burst must show up in the (cached) name list
+    Friend f2(1, ToxPk());
+    f2.setName("friend2");
+
+    notificationData = notificationGenerator->friendMessageNotification(&f2, "test3");
+    QCOMPARE("4 message(s) from 3 chats", notificationData.title);
+    QCOMPARE("conference, friend, friend2", notificationData.message);
+
+    // And activation must drop the cached list along with the counts
+    notificationGenerator->onNotificationActivated();
+
+    notificationData = notificationGenerator->friendMessageNotification(&f, "test4");
+    QCOMPARE("friend", notificationData.title);
+    QCOMPARE("test4", notificationData.message);
 }
 
 void TestNotificationGenerator::testFileTransfer()
@@ -53,6 +53,7 @@ private slots:
     void init();
 
     void testSanity();
+    void testTrimOldestItems();
 
 private:
     MockCoreIdHandler idHandler;
@@ -124,5 +125,35 @@ void TestSessionChatLog::testSanity()
     QVERIFY(searchResult.start == 5);
 }
 
+/**
+ * @brief Tests that trimming evicts a contiguous prefix and stops at
+ * undelivered messages
+ */
+void TestSessionChatLog::testTrimOldestItems()
+{
+    /* ChatLogIdx(0) */ chatLog->onMessageSent(DispatchedMessageId(0), createMessage("a"));
+    chatLog->onMessageComplete(DispatchedMessageId(0));
+    /* ChatLogIdx(1) */ chatLog->onMessageReceived(ToxPk(), createMessage("b"));
+    /* ChatLogIdx(2) */ chatLog->onMessageSent(DispatchedMessageId(1), createMessage("c"));
+    /* ChatLogIdx(3) */ chatLog->onMessageReceived(ToxPk(), createMessage("d"));
+
+    chatLog->trimOldestItems(3);
+
+    QVERIFY(chatLog->getFirstIdx() == ChatLogIdx(1));
+    QVERIFY(chatLog->getNextIdx() == ChatLogIdx(4));
+
+    // The message at ChatLogIdx(2) is still pending, so it pins the window
+    // even though the budget would allow further eviction
+    chatLog->trimOldestItems(1);
+
+    QVERIFY(chatLog->getFirstIdx() == ChatLogIdx(2));
+
+    chatLog->onMessageComplete(DispatchedMessageId(1));
+    chatLog->trimOldestItems(1);
+
+    QVERIFY(chatLog->getFirstIdx() == ChatLogIdx(3));
+    QVERIFY(chatLog->at(ChatLogIdx(3)).getContentType() == ChatLogItem::ContentType::message);
+}
+
 QTEST_GUILESS_MAIN(TestSessionChatLog)
 #include "sessionchatlog_test.moc"
@@ -22,6 +22,7 @@ public:
 private slots:
     void testOnline();
     void testLocal();
+    void testRttRanking();
 };
 
 TestBootstrapNodesUpdater::TestBootstrapNodesUpdater()
@@ -57,5 +58,30 @@ void TestBootstrapNodesUpdater::testLocal()
     QVERIFY(defaultNodes.size() > 0);
 }
 
+void TestBootstrapNodesUpdater::testRttRanking()
+{
+    QNetworkProxy proxy{QNetworkProxy::ProxyType::NoProxy};
+    Paths paths{Paths::Portable::NonPortable};
+
+    BootstrapNodeUpdater updater{proxy, paths};
+
+    QList<DhtServer> defaultNodes = BootstrapNodeUpdater::loadDefaultBootstrapNodes();
+    QVERIFY(defaultNodes.size() > 1);
+
+    // a node reported as fast must lead the shuffled list
+    const auto fastNode = defaultNodes.last().publicKey;
+    updater.reportBootstrapSuccess({fastNode}, 1);
+
+    QList<DhtServer> ranked = updater.getBootstrapNodes();
+    QVERIFY(ranked.size() > 1);
+    QCOMPARE(ranked.first().publicKey, fastNode);
+
+    // the persisted measurement must survive into a new instance
+    BootstrapNodeUpdater restarted{proxy, paths};
+    ranked = restarted.getBootstrapNodes();
+    QVERIFY(ranked.size() > 1);
+    QCOMPARE(ranked.first().publicKey, fastNode);
+}
+
 QTEST_MAIN(TestBootstrapNodesUpdater)
 #include "bsu_test.moc"
@@ -131,6 +131,9 @@ private slots:
     // test8to9 omitted, data corruption correction upgrade with no schema change
     void test9to10();
     // test10to11 handled in dbTo11_test
+    void test11to12();
+    void test12to13();
+    void test13to14();
     // test suite
 
 private:
@@ -156,7 +159,7 @@ void TestDbSchema::testCreation()
     QVector<RawDatabase::Query> queries;
     auto db = std::shared_ptr<RawDatabase>{new RawDatabase{testDatabaseFile->fileName(), {}, {}}};
     QVERIFY(DbUpgrader::createCurrentSchema(*db));
-    DbUtility::verifyDb(db, DbUtility::schema11);
+    DbUtility::verifyDb(db, DbUtility::schema14);
 }
 
 void TestDbSchema::testIsNewDb()
@@ -420,5 +423,131 @@ void TestDbSchema::test9to10()
     verifyDb(db, DbUtility::schema10);
 }
 
+void TestDbSchema::test11to12()
+{
+    auto db = std::shared_ptr<RawDatabase>{new RawDatabase{testDatabaseFile->fileName(), {}, {}}};
+    createSchemaAtVersion(db, DbUtility::schema11);
+
+    // pre-existing messages should end up in the index through the 'rebuild'
+    QVector<RawDatabase::Query> queries;
+    queries += RawDatabase::Query{"INSERT INTO history (id, message_type, timestamp, chat_id) "
+                                  "VALUES (1, 'T', 1, 0);"};
+    queries += RawDatabase::Query{"INSERT INTO text_messages (id, message_type, sender_alias, "
+                                  "message) VALUES (1, 'T', 0, ?);",
+                                  {"an indexed needle message"}};
+    QVERIFY(db->execNow(queries));
+
+    QVERIFY(DbUpgrader::dbSchema11to12(*db));
+    DbUtility::verifyDb(db, DbUtility::schema12);
+
+    int matches = 0;
+    QVERIFY(db->execNow(RawDatabase::Query("SELECT COUNT(*) FROM text_messages_fts "
+                                           "WHERE text_messages_fts MATCH 'needle';",
+                                           [&](const QVector<QVariant>& row) {
+                                               matches = row[0].toLongLong();
+                                           })));
+    QVERIFY(matches == 1);
+
+    // new messages should be indexed through the insert trigger
+    QVERIFY(db->execNow(QVector<RawDatabase::Query>{
+        RawDatabase::Query{"INSERT INTO history (id, message_type, timestamp, chat_id) "
+                           "VALUES (2, 'T', 2, 0);"},
+        RawDatabase::Query{"INSERT INTO text_messages (id, message_type, sender_alias, message) "
+                           "VALUES (2, 'T', 0, ?);",
+                           {"another needle"}}}));
+    QVERIFY(db->execNow(RawDatabase::Query("SELECT COUNT(*) FROM text_messages_fts "
+                                           "WHERE text_messages_fts MATCH 'needle';",
+                                           [&](const QVector<QVariant>& row) {
+                                               matches = row[0].toLongLong();
+                                           })));
+    QVERIFY(matches == 2);
+}
+
+void TestDbSchema::test12to13()
+{
+    auto db = std::shared_ptr<RawDatabase>{new RawDatabase{testDatabaseFile->fileName(), {}, {}}};
+    createSchemaAtVersion(db, DbUtility::schema12);
+
+    // two chats, chat 0 spanning two days, timestamps in ms
+    constexpr int64_t dayMs = 24 * 60 * 60 * 1000;
+    QVector<RawDatabase::Query> queries;
+    queries += RawDatabase::Query{"INSERT INTO history (id, message_type, timestamp, chat_id) "
+                                  "VALUES (1, 'S', 1, 0);"};
+    queries += RawDatabase::Query{"INSERT INTO history (id, message_type, timestamp, chat_id) "
+                                  "VALUES (2, 'S', 2, 0);"};
+    queries += RawDatabase::Query{QString("INSERT INTO history (id, message_type, timestamp, "
+                                          "chat_id) VALUES (3, 'S', %1, 0);")
+                                      .arg(dayMs + 5)};
+    queries += RawDatabase::Query{QString("INSERT INTO history (id, message_type, timestamp, "
+                                          "chat_id) VALUES (4, 'S', %1, 1);")
+                                      .arg(dayMs + 6)};
+    QVERIFY(db->execNow(queries));
+
+    QVERIFY(DbUpgrader::dbSchema12to13(*db));
+    DbUtility::verifyDb(db, DbUtility::schema13);
+
+    // pre-existing history gets backfilled, new inserts go through the trigger
+    QVERIFY(db->execNow(QString("INSERT INTO history (id, message_type, timestamp, chat_id) "
+                                "VALUES (5, 'S', %1, 0);")
+                            .arg(2 * dayMs + 1)));
+
+    struct DayEntry
+    {
+        int64_t chatId;
+        int64_t day;
+        int64_t firstId;
+        int64_t messageOffset;
+    };
+    std::vector<DayEntry> entries;
+    QVERIFY(db->execNow(
+        RawDatabase::Query("SELECT chat_id, day, first_id, message_offset FROM chat_day_index "
+                           "ORDER BY chat_id, day;",
+                           [&](const QVector<QVariant>& row) {
+                               entries.push_back({row[0].toLongLong(), row[1].toLongLong(),
+                                                  row[2].toLongLong(), row[3].toLongLong()});
+                           })));
+
+    QVERIFY(entries.size() == 4);
+    // chat 0, day 0: messages 1 and 2, first message is index 0
+    QVERIFY(entries[0].chatId == 0 && entries[0].day == 0 && entries[0].firstId == 1
+            && entries[0].messageOffset == 0);
+    // chat 0, day 1: message 3, two messages before it
+    QVERIFY(entries[1].chatId == 0 && entries[1].day == 1 && entries[1].firstId == 3
+            && entries[1].messageOffset == 2);
+    // chat 0, day 2: message 5, inserted after the upgrade
+    QVERIFY(entries[2].chatId == 0 && entries[2].day == 2 && entries[2].firstId == 5
+            && entries[2].messageOffset == 3);
+    // chat 1, day 1: message 4, nothing before it in its own chat
+    QVERIFY(entries[3].chatId == 1 && entries[3].day == 1 && entries[3].firstId == 4
+            && entries[3].messageOffset == 0);
+}
+
+void TestDbSchema::test13to14()
+{
+    auto db = std::shared_ptr<RawDatabase>{new RawDatabase{testDatabaseFile->fileName(), {}, {}}};
+    createSchemaAtVersion(db, DbUtility::schema13);
+
+    QVERIFY(DbUpgrader::dbSchema13to14(*db));
+    DbUtility::verifyDb(db, DbUtility::schema14);
+
+    // a draft is one row per chat, replaced on rewrite
+    QVERIFY(db->execNow(RawDatabase::Query{"INSERT INTO chats (id, uuid) VALUES (0, ?);",
+                                           {QByteArray{32, 0x42}}}));
+    QVERIFY(db->execNow(RawDatabase::Query{
+        "INSERT OR REPLACE INTO chat_drafts (chat_id, text) VALUES (0, ?);", {"first"}}));
+    QVERIFY(db->execNow(RawDatabase::Query{
+        "INSERT OR REPLACE INTO chat_drafts (chat_id, text) VALUES (0, ?);", {"second"}}));
+
+    int drafts = 0;
+    QString text;
+    QVERIFY(db->execNow(RawDatabase::Query("SELECT text FROM chat_drafts;",
+                                           [&](const QVector<QVariant>& row) {
+                                               ++drafts;
+                                               text = row[0].toString();
+                                           })));
+    QVERIFY(drafts == 1);
+    QVERIFY(text == QStringLiteral("second"));
+}
+
 QTEST_GUILESS_MAIN(TestDbSchema)
 #include "dbschema_test.moc"
@@ -0,0 +1,151 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "src/persistence/db/rawdatabase.h"
+
+#include <QString>
+#include <QTemporaryFile>
+#include <QtTest/QtTest>
+
+#include <memory>
+
+class TestRawDatabase : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init();
+    void cleanup();
+    void typedRowCallbackTest();
+    void typedRowNullTest();
+    void genericRowCallbackTest();
+    void readOnlyLaneTest();
+    void queryStatsTest();
+    void checkIntegrityTest();
+
+private:
+    std::unique_ptr<QTemporaryFile> testDatabaseFile;
+};
+
+void TestRawDatabase::init()
+{
+    testDatabaseFile = std::unique_ptr<QTemporaryFile>(new QTemporaryFile());
+    // fileName is only defined once the file is opened. Since RawDatabase
+    // will be opening the file itself not using QFile, open and close it now.
+    QVERIFY(testDatabaseFile->open());
+    testDatabaseFile->close();
+}
+
+void TestRawDatabase::cleanup()
+{
+    testDatabaseFile.reset();
+}
+
+void TestRawDatabase::typedRowCallbackTest()
+{
+    RawDatabase db{testDatabaseFile->fileName(), {}, {}};
+    QVERIFY(db.execNow(QStringLiteral("CREATE TABLE rows (num INTEGER, txt TEXT, data BLOB);")));
+    QVERIFY(db.execNow(RawDatabase::Query(QStringLiteral("INSERT INTO rows VALUES (42, 'hello', ?);"),
+                                          {QByteArray("\x00\x01\x02", 3)})));
+
+    int rowsSeen = 0;
+    int64_t num = 0;
+    QString txt;
+    QByteArray data;
+    auto rowCallback = [&](const RawDatabase::Row& row) {
+        ++rowsSeen;
+        num = row.int64Value(0);
+        txt = row.stringValue(1);
+        data = row.byteArrayValue(2);
+    };
+    QVERIFY(db.execNow({QStringLiteral("SELECT num, txt, data FROM rows;"), rowCallback}));
+
+    QCOMPARE(rowsSeen, 1);
+    QCOMPARE(num, int64_t{42});
+    QCOMPARE(txt, QStringLiteral("hello"));
+    QCOMPARE(data, QByteArray("\x00\x01\x02", 3));
+}
+
+void TestRawDatabase::typedRowNullTest()
+{
+    RawDatabase db{testDatabaseFile->fileName(), {}, {}};
+    QVERIFY(db.execNow(QStringLiteral("CREATE TABLE rows (num INTEGER, txt TEXT);")));
+    QVERIFY(db.execNow(QStringLiteral("INSERT INTO rows VALUES (NULL, 'set');")));
+
+    bool numNull = false;
+    bool txtNull = true;
+    auto rowCallback = [&](const RawDatabase::Row& row) {
+        numNull = row.isNull(0);
+        txtNull = row.isNull(1);
+    };
+    QVERIFY(db.execNow({QStringLiteral("SELECT num, txt FROM rows;"), rowCallback}));
+
+    QVERIFY(numNull);
+    QVERIFY(!txtNull);
+}
+
+void TestRawDatabase::genericRowCallbackTest()
+{
+    // The QVariant path must keep working alongside the typed one
+    RawDatabase db{testDatabaseFile->fileName(), {}, {}};
+    QVERIFY(db.execNow(QStringLiteral("CREATE TABLE rows (num INTEGER);")));
+    QVERIFY(db.execNow(QStringLiteral("INSERT INTO rows VALUES (7);")));
+
+    int64_t num = 0;
+    auto rowCallback = [&](const QVector<QVariant>& row) { num = row[0].toLongLong(); };
+    QVERIFY(db.execNow({QStringLiteral("SELECT num FROM rows;"), rowCallback}));
+
+    QCOMPARE(num, int64_t{7});
+}
+
+void TestRawDatabase::readOnlyLaneTest()
+{
+    RawDatabase db{testDatabaseFile->fileName(), {}, {}};
+    QVERIFY(db.execNow(QStringLiteral("CREATE TABLE rows (num INTEGER);")));
+    QVERIFY(db.execNow(QStringLiteral("INSERT INTO rows VALUES (1), (2), (3);")));
+
+    // The read lane must see committed writes from the write connection
+    int64_t sum = 0;
+    auto rowCallback = [&](const RawDatabase::Row& row) { sum += row.int64Value(0); };
+    QVERIFY(db.execNowReadOnly(RawDatabase::Query{QStringLiteral("SELECT num FROM rows;"), rowCallback}));
+    QCOMPARE(sum, int64_t{6});
+
+    // And writes landing after the lazily opened read connection exists
+    QVERIFY(db.execNow(QStringLiteral("INSERT INTO rows VALUES (4);")));
+    sum = 0;
+    QVERIFY(db.execNowReadOnly(RawDatabase::Query{QStringLiteral("SELECT num FROM rows;"), rowCallback}));
+    QCOMPARE(sum, int64_t{10});
+}
+
+void TestRawDatabase::queryStatsTest()
+{
+    RawDatabase db{testDatabaseFile->fileName(), {}, {}};
+    QVERIFY(db.execNow(QStringLiteral("CREATE TABLE rows (num INTEGER);")));
+    QVERIFY(db.execNow(
+        RawDatabase::Query(QStringLiteral("INSERT INTO rows VALUES (?);"), {int64_t{1}})));
+    QVERIFY(db.execNow(
+        RawDatabase::Query(QStringLiteral("INSERT INTO rows VALUES (?);"), {int64_t{2}})));
+
+    const QString stats = db.queryStatsToString();
+    // Stats are keyed by the statement text, so both parameterized inserts
+    // fold into one entry with count 2
+    QVERIFY(stats.contains(QStringLiteral("CREATE TABLE rows (num INTEGER);")));
+    QVERIFY(stats.contains(QStringLiteral("INSERT INTO rows VALUES (?);")));
+    QVERIFY(stats.contains(QStringLiteral("count 2")));
+    // The BEGIN/COMMIT wrappers around multi-query transactions are not
+    // interesting and must not show up
+    QVERIFY(!stats.contains(QStringLiteral("BEGIN;")));
+}
+
+void TestRawDatabase::checkIntegrityTest()
+{
+    RawDatabase db{testDatabaseFile->fileName(), {}, {}};
+    QVERIFY(db.execNow(QStringLiteral("CREATE TABLE rows (num INTEGER);")));
+    QVERIFY(db.execNow(QStringLiteral("INSERT INTO rows VALUES (1), (2), (3);")));
+
+    // A freshly written database must verify clean
+    QVERIFY(db.checkIntegrity().isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestRawDatabase)
+#include "rawdatabase_test.moc"
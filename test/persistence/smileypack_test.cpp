@@ -37,6 +37,7 @@ private slots:
     void testSmilifySingleCharEmoji();
     void testSmilifyMultiCharEmoji();
     void testSmilifyAsciiEmoticon();
+    void testSmilifyMixedMessage();
 
 private:
     std::unique_ptr<QGuiApplication> app;
@@ -101,5 +102,18 @@ void TestSmileyPack::testSmilifyAsciiEmoticon()
 }
 
 
+/**
+ * @brief Test that ascii and emoji smileys mixed with plain text are all
+ *  replaced in a single pass
+ */
+void TestSmileyPack::testSmilifyMixedMessage()
+{
+    SmileyPack smileyPack{*settings};
+
+    const auto result = smileyPack.smileyfied("Hi :-) 😊");
+    QVERIFY(result
+            == "Hi " + SmileyPack::getAsRichText(":-)") + " " + SmileyPack::getAsRichText("😊"));
+}
+
 QTEST_MAIN(TestSmileyPack)
 #include "smileypack_test.moc"
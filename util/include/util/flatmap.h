@@ -0,0 +1,146 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+/**
+ * Ordered map over a sorted contiguous vector, exposing the subset of the
+ * std::map interface we actually use. Lookups binary search one allocation
+ * instead of chasing tree nodes, so iteration and repeated finds over small
+ * dense integer keys stay in cache.
+ *
+ * Insertion and erasure shift the tail of the vector, so this is only a good
+ * fit for maps that stay small or change rarely; bulk prepends in particular
+ * degrade to quadratic time.
+ *
+ * Unlike std::map the key of a value_type is mutable; don't modify it through
+ * iterators or lookups will break.
+ */
+template <typename Key, typename T>
+class FlatMap
+{
+public:
+    using value_type = std::pair<Key, T>;
+    using storage_type = std::vector<value_type>;
+    using size_type = typename storage_type::size_type;
+    using iterator = typename storage_type::iterator;
+    using const_iterator = typename storage_type::const_iterator;
+    using reverse_iterator = typename storage_type::reverse_iterator;
+    using const_reverse_iterator = typename storage_type::const_reverse_iterator;
+
+    iterator begin()
+    {
+        return data.begin();
+    }
+    const_iterator begin() const
+    {
+        return data.begin();
+    }
+    iterator end()
+    {
+        return data.end();
+    }
+    const_iterator end() const
+    {
+        return data.end();
+    }
+    reverse_iterator rbegin()
+    {
+        return data.rbegin();
+    }
+    const_reverse_iterator rbegin() const
+    {
+        return data.rbegin();
+    }
+    reverse_iterator rend()
+    {
+        return data.rend();
+    }
+    const_reverse_iterator rend() const
+    {
+        return data.rend();
+    }
+
+    bool empty() const
+    {
+        return data.empty();
+    }
+    size_type size() const
+    {
+        return data.size();
+    }
+    void clear()
+    {
+        data.clear();
+    }
+
+    iterator lower_bound(const Key& key)
+    {
+        return std::lower_bound(data.begin(), data.end(), key,
+                                [](const value_type& v, const Key& k) { return v.first < k; });
+    }
+
+    const_iterator lower_bound(const Key& key) const
+    {
+        return std::lower_bound(data.begin(), data.end(), key,
+                                [](const value_type& v, const Key& k) { return v.first < k; });
+    }
+
+    iterator find(const Key& key)
+    {
+        auto it = lower_bound(key);
+        if (it != data.end() && it->first == key) {
+            return it;
+        }
+        return data.end();
+    }
+
+    const_iterator find(const Key& key) const
+    {
+        auto it = lower_bound(key);
+        if (it != data.end() && it->first == key) {
+            return it;
+        }
+        return data.end();
+    }
+
+    T& operator[](const Key& key)
+    {
+        auto it = lower_bound(key);
+        if (it == data.end() || !(it->first == key)) {
+            it = data.insert(it, value_type(key, T()));
+        }
+        return it->second;
+    }
+
+    const T& at(const Key& key) const
+    {
+        auto it = find(key);
+        assert(it != data.end());
+        return it->second;
+    }
+
+    iterator erase(iterator it)
+    {
+        return data.erase(it);
+    }
+
+    size_type erase(const Key& key)
+    {
+        auto it = find(key);
+        if (it == data.end()) {
+            return 0;
+        }
+        data.erase(it);
+        return 1;
+    }
+
+private:
+    storage_type data;
+};
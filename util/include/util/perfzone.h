@@ -0,0 +1,48 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+/**
+ * @brief Opt-in static tracepoints for attributing profiler samples.
+ *
+ * When built with -DPERF_ZONES=ON on a system that ships <sys/sdt.h>
+ * (systemtap-sdt-dev), PERF_ZONE(name) emits a qtox:name_begin and
+ * qtox:name_end USDT probe pair bracketing the enclosing scope. perf and
+ * bpftrace can attach to the probes, so flamegraph samples map to logical
+ * operations (one tox iteration, one database batch, one chat relayout)
+ * instead of bare call stacks. Zones sit at the subsystem boundaries: core
+ * iteration, database transaction processing, chat log layout, video frame
+ * conversion and the audio capture tick.
+ *
+ * Without the build flag, or on systems without <sys/sdt.h>, the macro
+ * expands to nothing — release builds carry no trace code at all.
+ */
+
+#if defined(PERF_ZONES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define PERF_ZONES_AVAILABLE 1
+#endif
+#endif
+
+#ifdef PERF_ZONES_AVAILABLE
+// The probe name must be an identifier, so the exit probe is emitted from a
+// local struct's destructor rather than a shared RAII class
+#define PERF_ZONE(name)                                                \
+    DTRACE_PROBE(qtox, name##_begin);                                  \
+    const struct PerfZoneExit_##name                                   \
+    {                                                                  \
+        ~PerfZoneExit_##name()                                         \
+        {                                                              \
+            DTRACE_PROBE(qtox, name##_end);                            \
+        }                                                              \
+    } perfZoneExit_##name                                              \
+    {                                                                  \
+    }
+#else
+#define PERF_ZONE(name)                                                \
+    do {                                                               \
+    } while (0)
+#endif
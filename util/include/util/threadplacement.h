@@ -0,0 +1,24 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#pragma once
+
+#include <QString>
+
+/**
+ * @brief Registry of latency-sensitive threads for the debug pane.
+ *
+ * The AV threads (CoreAV iteration, camera device loop, audio capture)
+ * register themselves on start; summary() reports where the scheduler last
+ * ran each of them, so "audio jitter because the thread bounces between
+ * sockets" is an observable fact instead of a hunch. Placement is read from
+ * /proc on Linux; elsewhere only the thread names and priorities are listed.
+ */
+namespace ThreadPlacement
+{
+// Must be called from the thread being registered
+void registerCurrentThread(const QString& name);
+
+QString summary();
+} // namespace ThreadPlacement
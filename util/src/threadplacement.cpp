@@ -0,0 +1,123 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2024-2025 The TokTok team.
+ */
+
+#include "util/threadplacement.h"
+
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+
+#include <tuple>
+
+#ifdef Q_OS_LINUX
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+struct Entry
+{
+    QString name;
+    QThread::Priority priority;
+    qint64 tid;
+};
+
+QMutex entriesMutex;
+QVector<Entry>& entries()
+{
+    static QVector<Entry> list;
+    return list;
+}
+
+QString priorityName(QThread::Priority priority)
+{
+    switch (priority) {
+    case QThread::IdlePriority:
+        return QStringLiteral("idle");
+    case QThread::LowestPriority:
+        return QStringLiteral("lowest");
+    case QThread::LowPriority:
+        return QStringLiteral("low");
+    case QThread::NormalPriority:
+        return QStringLiteral("normal");
+    case QThread::HighPriority:
+        return QStringLiteral("high");
+    case QThread::HighestPriority:
+        return QStringLiteral("highest");
+    case QThread::TimeCriticalPriority:
+        return QStringLiteral("time-critical");
+    case QThread::InheritPriority:
+        break;
+    }
+    return QStringLiteral("inherited");
+}
+
+/**
+ * @brief Last CPU the kernel ran the thread on, or -1 when unknown.
+ */
+int lastCpuOf(qint64 tid)
+{
+#ifdef Q_OS_LINUX
+    QFile stat(QStringLiteral("/proc/self/task/%1/stat").arg(tid));
+    if (!stat.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+
+    // The comm field may contain spaces, so fields are only well-delimited
+    // after the closing parenthesis; "processor" is field 39 overall, which
+    // is the 37th space-separated token after it
+    const QByteArray contents = stat.readAll();
+    const int commEnd = contents.lastIndexOf(')');
+    if (commEnd < 0) {
+        return -1;
+    }
+
+    const QList<QByteArray> fields = contents.mid(commEnd + 2).split(' ');
+    constexpr int processorField = 39 - 3;
+    if (fields.size() <= processorField) {
+        return -1;
+    }
+
+    bool ok = false;
+    const int cpu = fields[processorField].toInt(&ok);
+    return ok ? cpu : -1;
+#else
+    std::ignore = tid;
+    return -1;
+#endif
+}
+} // namespace
+
+namespace ThreadPlacement
+{
+void registerCurrentThread(const QString& name)
+{
+    qint64 tid = -1;
+#ifdef Q_OS_LINUX
+    tid = static_cast<qint64>(syscall(SYS_gettid));
+#endif
+
+    const QMutexLocker<QMutex> locker{&entriesMutex};
+    entries().append(Entry{name, QThread::currentThread()->priority(), tid});
+}
+
+QString summary()
+{
+    const QMutexLocker<QMutex> locker{&entriesMutex};
+    if (entries().isEmpty()) {
+        return {};
+    }
+
+    QString out = QStringLiteral("AV thread placement:\n");
+    for (const Entry& entry : entries()) {
+        const int cpu = lastCpuOf(entry.tid);
+        out += QStringLiteral("  %1: %2 priority, last on %3\n")
+                   .arg(entry.name, priorityName(entry.priority),
+                        cpu >= 0 ? QStringLiteral("cpu %1").arg(cpu) : QStringLiteral("cpu n/a"));
+    }
+    return out;
+}
+} // namespace ThreadPlacement